@@ -0,0 +1,151 @@
+#include "bench.h"
+
+#include <io/async_file_io.h>
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <mutex>
+#include <random>
+#include <string>
+#include <vector>
+
+#if defined(__linux__)
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+using namespace gomarky;
+
+namespace
+{
+
+constexpr size_t   kFileBytes  = size_t(256) << 20;
+constexpr unsigned kQueueDepth = 32;
+
+// Keeps kQueueDepth requests in flight until `count` have completed, each completion issuing the next
+// request with the buffer it got back; this is the sustained rate, not the latency of one request.
+class Pump
+{
+public:
+    Pump(AsyncFileIo& io, int fd, bool write, size_t block, std::function<uint64_t(size_t)> offset)
+        : m_io(io), m_fd(fd), m_write(write), m_block(block), m_offset(std::move(offset))
+    {
+    }
+
+    void Run(size_t count)
+    {
+        m_issued    = 0;
+        m_completed = 0;
+        m_count     = count;
+        {
+            AsyncFileIo::Batch batch(m_io);
+            for (unsigned i = 0; i < kQueueDepth && i < count; ++i)
+            {
+                AsyncFileIo::IoBuffer buffer = m_io.AcquireBuffer();
+                std::memset(buffer.Data(), 0x5a, m_block);
+                Issue(std::move(buffer), m_issued++);
+            }
+        }
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_finished.wait(lock, [this] { return m_completed == m_count; });
+    }
+
+private:
+    void Issue(AsyncFileIo::IoBuffer buffer, size_t index)
+    {
+        const uint64_t offset = m_offset(index);
+        auto           done   = [this](IoResult result, AsyncFileIo::IoBuffer buffer) {
+            if (!result.Ok()) std::fprintf(stderr, "I/O error %d\n", result.error);
+            const size_t next = m_issued++;
+            if (next < m_count) Issue(std::move(buffer), next);
+            std::lock_guard<std::mutex> lock(m_mutex);
+            if (++m_completed == m_count) m_finished.notify_one();
+        };
+        if (m_write) m_io.Write(m_fd, offset, std::move(buffer), m_block, done);
+        else m_io.Read(m_fd, offset, std::move(buffer), m_block, done);
+    }
+
+    AsyncFileIo&                    m_io;
+    const int                       m_fd;
+    const bool                      m_write;
+    const size_t                    m_block;
+    std::function<uint64_t(size_t)> m_offset;
+    std::atomic<size_t>             m_issued{0};
+    size_t                          m_completed = 0;
+    size_t                          m_count     = 0;
+    std::mutex                      m_mutex;
+    std::condition_variable         m_finished;
+};
+
+} // namespace
+
+int main(int argc, char** argv)
+{
+#if defined(__linux__)
+    bench::Runner runner(argc, argv);
+
+    // The file goes to $TMPDIR; O_DIRECT keeps the page cache out of it where supported.
+    const char* directory = std::getenv("TMPDIR");
+    std::string path      = std::string(directory ? directory : "/tmp") + "/gomarky-async-io-bench";
+    bool        direct    = true;
+    int         fd        = open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC | O_DIRECT, 0600);
+    if (fd < 0)
+    {
+        direct = false;
+        fd     = open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0600);
+    }
+    if (fd < 0)
+    {
+        std::perror(path.c_str());
+        return 1;
+    }
+    unlink(path.c_str());
+    std::printf("%s, %zu MB, %s\n", path.c_str(), kFileBytes >> 20, direct ? "O_DIRECT" : "page cache");
+
+    for (bool thread_pool : {false, true})
+    {
+        AsyncFileIo::Options options;
+        options.queue_depth       = kQueueDepth;
+        options.buffer_count      = kQueueDepth;
+        options.buffer_size       = size_t(128) << 10;
+        options.force_thread_pool = thread_pool;
+        AsyncFileIo io(options);
+        std::printf("backend: %s%s\n", io.BackendName(), io.RegisteredBuffers() ? ", registered buffers" : "");
+        const std::string prefix = thread_pool ? "thread_pool/" : "io_uring/";
+
+        for (size_t block : {size_t(4) << 10, size_t(128) << 10})
+        {
+            const size_t      blocks = kFileBytes / block;
+            const size_t      count  = block < (size_t(64) << 10) ? 65536 : blocks;
+            const std::string suffix = "/" + std::to_string(block >> 10) + "k";
+
+            std::mt19937_64       rng(7);
+            std::vector<uint64_t> random(count);
+            for (auto& offset : random) offset = (rng() % blocks) * block;
+
+            Pump sequential_write(io, fd, true, block, [block](size_t i) { return i * block; });
+            Pump sequential_read(io, fd, false, block, [block](size_t i) { return i * block; });
+            Pump random_read(io, fd, false, block, [&random](size_t i) { return random[i]; });
+            Pump random_write(io, fd, true, block, [&random](size_t i) { return random[i]; });
+
+            // Bytes per second; the first write also lays the file out for the reads.
+            runner.Run(prefix + "sequential_write" + suffix, double(count * block), [&] { sequential_write.Run(count); });
+            runner.Run(prefix + "sequential_read" + suffix, double(count * block), [&] { sequential_read.Run(count); });
+            runner.Run(prefix + "random_read" + suffix, double(count * block), [&] { random_read.Run(count); });
+            runner.Run(prefix + "random_write" + suffix, double(count * block), [&] { random_write.Run(count); });
+        }
+    }
+    close(fd);
+    return runner.Finish();
+#else
+    (void)argc;
+    (void)argv;
+    std::printf("this benchmark needs Linux\n");
+    return 0;
+#endif
+}
@@ -0,0 +1,117 @@
+#pragma once
+
+// Minimal benchmark harness shared by the executables in this folder.
+//
+// Each executable builds its fixtures in main() and hands closures to a Runner, which times a
+// number of repetitions and prints the median, the best run and the throughput. Where hardware
+// counters are available it also prints IPC and cache/branch misses per item, counted on the
+// thread running the benchmark (work handed to other threads is not included).
+// Command line: --filter=<substring> --repetitions=<n> --csv
+
+#include <metrics/perf_counters.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+namespace bench
+{
+
+/// Keep the compiler from optimizing away a computed value.
+template<typename T>
+inline void DoNotOptimize(const T& value)
+{
+#if defined(__GNUC__)
+    asm volatile("" : : "g"(&value) : "memory");
+#else
+    static volatile const void* sink;
+    sink = &value;
+#endif
+}
+
+class Runner
+{
+public:
+    Runner(int argc, char** argv)
+    {
+        for (int i = 1; i < argc; ++i)
+        {
+            if (std::strncmp(argv[i], "--filter=", 9) == 0) m_filter = argv[i] + 9;
+            else if (std::strncmp(argv[i], "--repetitions=", 14) == 0) m_repetitions = std::max(1, std::atoi(argv[i] + 14));
+            else if (std::strcmp(argv[i], "--csv") == 0) m_csv = true;
+        }
+        if (m_csv) std::printf("name,median_ms,min_ms,items_per_second,ipc,cache_misses_per_item,branch_misses_per_item\n");
+        const auto& counters = gomarky::PerfCounters::ThisThread();
+        if (!counters.Available()) std::fprintf(stderr, "hardware counters unavailable: %s\n", counters.Error().c_str());
+    }
+
+    /// Time `fn` over the configured repetitions after one warm-up call.
+    /// `items` is the amount of work done per call, used for the throughput column.
+    template<typename F>
+    void Run(const std::string& name, double items, F&& fn)
+    {
+        RunWithSetup(name, items, [] {}, fn);
+    }
+
+    /// Same as Run, but calls `setup` untimed before every repetition (e.g. to reshuffle input).
+    template<typename Setup, typename F>
+    void RunWithSetup(const std::string& name, double items, Setup&& setup, F&& fn)
+    {
+        if (!m_filter.empty() && name.find(m_filter) == std::string::npos) return;
+
+        setup();
+        fn();
+        std::vector<double> seconds;
+        gomarky::PerfSample counts;
+        for (int i = 0; i < m_repetitions; ++i)
+        {
+            setup();
+            gomarky::PerfScope scope(counts);
+            const auto         start = std::chrono::steady_clock::now();
+            fn();
+            seconds.push_back(std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count());
+        }
+        Report(name, items, seconds, counts);
+    }
+
+    int Finish() const { return 0; }
+
+private:
+    void Report(const std::string& name, double items, std::vector<double>& seconds,
+                const gomarky::PerfSample& counts) const
+    {
+        std::sort(seconds.begin(), seconds.end());
+        const double median = seconds[seconds.size() / 2];
+        const double best   = seconds.front();
+        const double rate   = median > 0 ? items / median : 0;
+        if (m_csv) std::printf("%s,%.6f,%.6f,%.6e", name.c_str(), median * 1e3, best * 1e3, rate);
+        else std::printf("%-48s %12.3f ms %12.3f ms %14.4g items/s", name.c_str(), median * 1e3, best * 1e3, rate);
+
+        // Counters are summed over all timed repetitions.
+        const double total = items * seconds.size();
+        if (counts.cycles && total > 0)
+        {
+            const double cache_misses  = double(counts.cache_misses) / total;
+            const double branch_misses = double(counts.branch_misses) / total;
+            if (m_csv) std::printf(",%.3f,%.4g,%.4g", counts.Ipc(), cache_misses, branch_misses);
+            else std::printf("  IPC %5.2f %10.4g cache-miss/item %10.4g branch-miss/item", counts.Ipc(), cache_misses,
+                             branch_misses);
+        }
+        else if (m_csv)
+        {
+            std::printf(",,,");
+        }
+        std::printf("\n");
+        std::fflush(stdout);
+    }
+
+    std::string m_filter;
+    int         m_repetitions = 5;
+    bool        m_csv         = false;
+};
+
+} // namespace bench
@@ -0,0 +1,58 @@
+#include "bench.h"
+
+#include <calc/big_integer.h>
+
+#include <random>
+#include <string>
+
+using namespace gomarky;
+
+using Algorithm = BigInteger::MultiplyAlgorithm;
+
+namespace
+{
+
+std::string RandomDigits(std::mt19937& rng, size_t count)
+{
+    std::string digits(1, char('1' + rng() % 9));
+    while (digits.size() < count) digits += char('0' + rng() % 10);
+    return digits;
+}
+
+std::string Label(size_t digits)
+{
+    return digits >= 1000000 ? std::to_string(digits / 1000000) + "M" : std::to_string(digits / 1000) + "k";
+}
+
+} // namespace
+
+int main(int argc, char** argv)
+{
+    bench::Runner runner(argc, argv);
+    std::mt19937  rng(42);
+
+    for (size_t digits : {size_t(1000), size_t(10000), size_t(100000), size_t(1000000)})
+    {
+        const std::string suffix = "/" + Label(digits) + "_digits";
+        const BigInteger  a      = BigInteger::FromString(RandomDigits(rng, digits));
+        const BigInteger  b      = BigInteger::FromString(RandomDigits(rng, digits));
+
+        // Schoolbook and Karatsuba only where they finish in reasonable time, to show the crossovers.
+        if (digits <= 100000)
+        {
+            runner.Run("multiply/schoolbook" + suffix, 1,
+                       [&] { bench::DoNotOptimize(BigInteger::Multiply(a, b, Algorithm::Schoolbook)); });
+            runner.Run("multiply/karatsuba" + suffix, 1,
+                       [&] { bench::DoNotOptimize(BigInteger::Multiply(a, b, Algorithm::Karatsuba)); });
+        }
+        runner.Run("multiply/ntt" + suffix, 1, [&] { bench::DoNotOptimize(BigInteger::Multiply(a, b, Algorithm::Ntt)); });
+        runner.Run("multiply/auto" + suffix, 1, [&] { bench::DoNotOptimize(a * b); });
+
+        const BigInteger product = a * b;
+        runner.Run("divide" + suffix, 1, [&] { bench::DoNotOptimize(product / b); });
+        runner.Run("to_string" + suffix, 1, [&] { bench::DoNotOptimize(product.ToString()); });
+        const std::string text = product.ToString();
+        runner.Run("from_string" + suffix, 1, [&] { bench::DoNotOptimize(BigInteger::FromString(text)); });
+    }
+    return runner.Finish();
+}
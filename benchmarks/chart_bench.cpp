@@ -0,0 +1,34 @@
+#include "bench.h"
+
+#include <chart/downsample.h>
+#include <chart/minmax_pyramid.h>
+
+#include <cmath>
+#include <random>
+
+using namespace gomarky;
+
+int main(int argc, char** argv)
+{
+    bench::Runner runner(argc, argv);
+
+    const size_t  samples = 10000000;
+    MinMaxPyramid series;
+    runner.Run("append/10M", double(samples), [&] {
+        series.Clear();
+        series.Reserve(samples);
+        std::mt19937 rng(1);
+        for (size_t i = 0; i < samples; ++i) series.Append(double(i), std::sin(i * 1e-4) + double(rng() % 100) / 1e3);
+    });
+
+    // One frame of a 1920 px wide chart at various zoom levels; each must stay well under 16 ms.
+    const size_t pixels = 1920;
+    for (double visible : {1e7, 1e6, 1e5, 1e4, 1e3})
+    {
+        const double x0 = 4e6;
+        runner.Run("downsample/visible=" + std::to_string(size_t(visible)), 1, [&] {
+            bench::DoNotOptimize(Downsample(series, x0, x0 + visible - 1, pixels));
+        });
+    }
+    return runner.Finish();
+}
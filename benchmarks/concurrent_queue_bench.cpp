@@ -0,0 +1,187 @@
+#include "bench.h"
+
+#include <concurrent/blocking_queue.h>
+#include <concurrent/mpmc_ring.h>
+#include <concurrent/mpsc_queue.h>
+#include <concurrent/spsc_ring.h>
+
+#include <atomic>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace gomarky;
+
+namespace
+{
+
+constexpr uint64_t kItems    = 1 << 19;
+constexpr size_t   kCapacity = 1024;
+
+template<size_t kBytes>
+struct Payload
+{
+    uint64_t words[kBytes / sizeof(uint64_t)];
+};
+
+/// Baseline: what the project would write without these queues.
+template<typename T>
+class LockedQueue
+{
+public:
+    using ValueType = T;
+
+    explicit LockedQueue(size_t) {}
+
+    bool TryPush(const T& value)
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_items.push_back(value);
+        return true;
+    }
+
+    bool TryPop(T& out)
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (m_items.empty()) return false;
+        out = m_items.front();
+        m_items.pop_front();
+        return true;
+    }
+
+private:
+    std::mutex    m_mutex;
+    std::deque<T> m_items;
+};
+
+// Move kItems through `queue` with the given thread counts, spinning with a yield on full/empty.
+template<typename Queue>
+void Transfer(Queue& queue, int producers, int consumers)
+{
+    using T = typename Queue::ValueType;
+    std::atomic<uint64_t>    remaining{kItems};
+    std::vector<std::thread> threads;
+    for (int p = 0; p < producers; ++p)
+    {
+        threads.emplace_back([&queue, producers] {
+            T item{};
+            for (uint64_t i = 0; i < kItems / producers; ++i)
+            {
+                item.words[0] = i;
+                while (!queue.TryPush(item)) std::this_thread::yield();
+            }
+        });
+    }
+    for (int c = 0; c < consumers; ++c)
+    {
+        threads.emplace_back([&queue, &remaining] {
+            T item;
+            while (remaining.load(std::memory_order_relaxed) > 0)
+            {
+                if (queue.TryPop(item))
+                {
+                    bench::DoNotOptimize(item);
+                    remaining.fetch_sub(1, std::memory_order_relaxed);
+                }
+                else
+                {
+                    std::this_thread::yield();
+                }
+            }
+        });
+    }
+    for (auto& thread : threads) thread.join();
+}
+
+// Same with the blocking wrapper; each consumer takes an exact share since Pop cannot give up.
+template<typename Queue>
+void TransferBlocking(BlockingQueue<Queue>& queue, int producers, int consumers)
+{
+    using T = typename Queue::ValueType;
+    std::vector<std::thread> threads;
+    for (int p = 0; p < producers; ++p)
+    {
+        threads.emplace_back([&queue, producers] {
+            T item{};
+            for (uint64_t i = 0; i < kItems / producers; ++i)
+            {
+                item.words[0] = i;
+                queue.Push(item);
+            }
+        });
+    }
+    for (int c = 0; c < consumers; ++c)
+    {
+        threads.emplace_back([&queue, consumers] {
+            T item;
+            for (uint64_t i = 0; i < kItems / consumers; ++i)
+            {
+                queue.Pop(item);
+                bench::DoNotOptimize(item);
+            }
+        });
+    }
+    for (auto& thread : threads) thread.join();
+}
+
+std::string Name(const char* queue, int producers, int consumers, size_t bytes)
+{
+    return std::string(queue) + "/" + std::to_string(producers) + "p" + std::to_string(consumers) + "c/" +
+           std::to_string(bytes) + "B";
+}
+
+template<template<typename> class Queue, size_t kBytes>
+void Measure(bench::Runner& runner, const char* name, int producers, int consumers)
+{
+    runner.Run(Name(name, producers, consumers, kBytes), kItems, [&] {
+        Queue<Payload<kBytes>> queue(kCapacity);
+        Transfer(queue, producers, consumers);
+    });
+}
+
+template<template<typename> class Queue, size_t kBytes>
+void MeasureBlocking(bench::Runner& runner, const char* name, int producers, int consumers)
+{
+    runner.Run(Name(name, producers, consumers, kBytes), kItems, [&] {
+        BlockingQueue<Queue<Payload<kBytes>>> queue(kCapacity);
+        TransferBlocking(queue, producers, consumers);
+    });
+}
+
+template<typename T>
+struct UnboundedMpsc : MpscQueue<T>
+{
+    explicit UnboundedMpsc(size_t) {}
+};
+
+template<size_t kBytes>
+void Matrix(bench::Runner& runner)
+{
+    Measure<SpscRing, kBytes>(runner, "spsc_ring", 1, 1);
+    for (int producers : {1, 2, 4})
+    {
+        Measure<MpscRing, kBytes>(runner, "mpsc_ring", producers, 1);
+        Measure<UnboundedMpsc, kBytes>(runner, "mpsc_queue", producers, 1);
+    }
+    for (int threads : {1, 2, 4})
+    {
+        Measure<MpmcRing, kBytes>(runner, "mpmc_ring", threads, threads);
+        Measure<LockedQueue, kBytes>(runner, "mutex_deque", threads, threads);
+    }
+    MeasureBlocking<SpscRing, kBytes>(runner, "blocking_spsc_ring", 1, 1);
+    MeasureBlocking<MpmcRing, kBytes>(runner, "blocking_mpmc_ring", 2, 2);
+}
+
+} // namespace
+
+int main(int argc, char** argv)
+{
+    bench::Runner runner(argc, argv);
+    Matrix<8>(runner);
+    Matrix<64>(runner);
+    Matrix<256>(runner);
+    return runner.Finish();
+}
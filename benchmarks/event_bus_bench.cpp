@@ -0,0 +1,156 @@
+#include "bench.h"
+
+#include <events/event_bus.h>
+#include <events/qt_event_bus.h>
+
+#include <chrono>
+#include <cstdint>
+#include <ctime>
+#include <thread>
+#include <vector>
+
+#include <QCoreApplication>
+#include <QObject>
+
+using namespace gomarky;
+
+struct Sample
+{
+    uint64_t sequence;
+    double   value;
+};
+Q_DECLARE_METATYPE(Sample)
+
+// Queued-signal baseline; moc needs it outside the anonymous namespace.
+class Emitter : public QObject
+{
+    Q_OBJECT
+
+signals:
+    void Sampled(Sample sample);
+};
+
+namespace
+{
+
+constexpr uint64_t kMessages  = 1000000;
+constexpr int      kProducers = 4;
+
+// Run the event loop on this thread until `done` says everything arrived.
+template<typename F>
+void SpinUntil(F done)
+{
+    while (!done()) QCoreApplication::processEvents(QEventLoop::WaitForMoreEvents);
+}
+
+// Split kMessages over `producers` threads; `publish(sequence)` returns false to ask for a retry.
+// With `paced` set the messages go out at 1M/s in 1 ms bursts instead of as fast as possible.
+template<typename Publish>
+std::vector<std::thread> StartProducers(int producers, bool paced, Publish publish)
+{
+    std::vector<std::thread> threads;
+    for (int p = 0; p < producers; ++p)
+    {
+        threads.emplace_back([=] {
+            const uint64_t count = kMessages / producers;
+            const uint64_t burst = 1000 / producers;
+            auto           due   = std::chrono::steady_clock::now();
+            for (uint64_t i = 0; i < count;)
+            {
+                if (paced && i % burst == 0)
+                {
+                    due += std::chrono::milliseconds(1);
+                    while (std::chrono::steady_clock::now() < due) std::this_thread::yield();
+                }
+                if (publish(p * count + i)) ++i;
+                else std::this_thread::yield();
+            }
+        });
+    }
+    return threads;
+}
+
+double ThreadCpuMilliseconds()
+{
+    timespec now;
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &now);
+    return now.tv_sec * 1e3 + now.tv_nsec / 1e6;
+}
+
+} // namespace
+
+int main(int argc, char** argv)
+{
+    QCoreApplication app(argc, argv);
+    bench::Runner    runner(argc, argv);
+    qRegisterMetaType<Sample>();
+
+    uint64_t received = 0;
+    auto     all_in   = [&received] { return received == kMessages; };
+
+    // One Runner entry per transport and producer count, plus a paced run at 1M messages/s that
+    // reports how much of the consumer thread each transport burns at that rate.
+    auto measure = [&](const char* name, int producers, auto publish) {
+        runner.Run(name, kMessages, [&] {
+            received     = 0;
+            auto threads = StartProducers(producers, false, publish);
+            SpinUntil(all_in);
+            for (auto& thread : threads) thread.join();
+        });
+
+        received           = 0;
+        const double start = ThreadCpuMilliseconds();
+        auto threads       = StartProducers(producers, true, publish);
+        SpinUntil(all_in);
+        for (auto& thread : threads) thread.join();
+        std::printf("%s: consumer cpu at 1M msg/s: %.1f ms per second\n", name, ThreadCpuMilliseconds() - start);
+    };
+
+    {
+        EventBus bus;
+        DrainOnEventLoop(bus);
+        auto sub = bus.Subscribe<Sample>(
+            [&received](const Sample& sample) {
+                bench::DoNotOptimize(sample);
+                ++received;
+            },
+            EventBus::Producers::Single, 1 << 16);
+        measure("1_producer/event_bus_spsc", 1, [&bus](uint64_t i) { return bus.Publish(Sample{i, double(i)}); });
+        std::printf("event_bus_spsc: %llu wakeups, %llu retries\n", (unsigned long long)bus.Wakeups(),
+                    (unsigned long long)bus.Dropped());
+    }
+    {
+        EventBus bus;
+        DrainOnEventLoop(bus);
+        auto sub = bus.Subscribe<Sample>(
+            [&received](const Sample& sample) {
+                bench::DoNotOptimize(sample);
+                ++received;
+            },
+            EventBus::Producers::Multiple, 1 << 16);
+        measure("4_producers/event_bus_mpsc", kProducers,
+                [&bus](uint64_t i) { return bus.Publish(Sample{i, double(i)}); });
+        std::printf("event_bus_mpsc: %llu wakeups, %llu retries\n", (unsigned long long)bus.Wakeups(),
+                    (unsigned long long)bus.Dropped());
+    }
+    {
+        Emitter emitter;
+        QObject receiver;
+        QObject::connect(
+            &emitter, &Emitter::Sampled, &receiver,
+            [&received](Sample sample) {
+                bench::DoNotOptimize(sample);
+                ++received;
+            },
+            Qt::QueuedConnection);
+        auto emit_sample = [&emitter](uint64_t i) {
+            emit emitter.Sampled(Sample{i, double(i)});
+            return true;
+        };
+        measure("1_producer/queued_signal", 1, emit_sample);
+        measure("4_producers/queued_signal", kProducers, emit_sample);
+    }
+    return runner.Finish();
+}
+
+#include "event_bus_bench.moc"
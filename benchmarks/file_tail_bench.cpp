@@ -0,0 +1,75 @@
+#include "bench.h"
+
+#include <table/column_table.h>
+#include <watch/table_tail.h>
+
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+
+using namespace gomarky;
+
+namespace
+{
+
+std::string Lines(size_t first, size_t count)
+{
+    std::string text;
+    for (size_t i = first; i < first + count; ++i)
+    {
+        text += std::to_string(1600000000 + i) + "," + std::to_string(i % 1000) + ".25,host" +
+                std::to_string(i % 16) + ",GET /index.html\n";
+    }
+    return text;
+}
+
+void Append(const std::string& path, const std::string& text)
+{
+    FILE* file = std::fopen(path.c_str(), "ab");
+    std::fwrite(text.data(), 1, text.size(), file);
+    std::fclose(file);
+}
+
+} // namespace
+
+int main(int argc, char** argv)
+{
+    bench::Runner runner(argc, argv);
+
+    // A log of a million lines in $TMPDIR that keeps growing by a thousand lines at a time.
+    const char*       directory = std::getenv("TMPDIR");
+    const std::string path      = std::string(directory ? directory : "/tmp") + "/gomarky-file-tail-bench.csv";
+    constexpr size_t  kLines    = 1000000;
+    constexpr size_t  kAppended = 1000;
+
+    std::remove(path.c_str());
+    Append(path, "time,latency,host,request\n");
+    for (size_t i = 0; i < kLines; i += 100000) Append(path, Lines(i, 100000));
+
+    const std::string more = Lines(kLines, kAppended);
+
+    // Bytes per second. Re-reading everything is what each change cost before; following the
+    // file only pays for the appended lines, however large the file already is.
+    TableTail first(path);
+    auto      initial = first.Poll();
+    std::printf("%zu rows, %.1f MB\n", initial.rows->RowCount(), double(initial.bytes) / (1 << 20));
+
+    runner.Run("full_reload", double(initial.bytes), [&] {
+        TableTail reload(path);
+        bench::DoNotOptimize(reload.Poll().rows->RowCount());
+    });
+
+    ColumnTable table;
+    table.AppendRows(*initial.rows);
+    runner.RunWithSetup("append_tail/1000_lines", double(more.size()),
+                        [&] { Append(path, more); },
+                        [&] {
+                            auto update = first.Poll();
+                            table.AppendRows(*update.rows);
+                            bench::DoNotOptimize(table.RowCount());
+                        });
+    std::printf("%zu rows followed\n", table.RowCount());
+
+    std::remove(path.c_str());
+    return runner.Finish();
+}
@@ -0,0 +1,69 @@
+#include "bench.h"
+
+#include <metrics/hdr_histogram.h>
+
+#include <cmath>
+#include <cstdio>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace gomarky;
+
+namespace
+{
+
+constexpr size_t   kValues  = 1 << 20;
+constexpr uint64_t kHighest = uint64_t(3600) * 1000000000; // an hour in nanoseconds
+
+// Log-uniform latencies between 100 ns and 10 ms.
+std::vector<uint64_t> MakeLatencies()
+{
+    std::vector<uint64_t>                  values(kValues);
+    std::mt19937_64                        random(11);
+    std::uniform_real_distribution<double> exponent(2, 7);
+    for (auto& value : values) value = static_cast<uint64_t>(std::pow(10.0, exponent(random)));
+    return values;
+}
+
+} // namespace
+
+int main(int argc, char** argv)
+{
+    bench::Runner               runner(argc, argv);
+    const std::vector<uint64_t> values = MakeLatencies();
+
+    for (int digits : {2, 3})
+    {
+        const std::string suffix = "/digits_" + std::to_string(digits);
+        HdrHistogram      histogram(1, kHighest, digits);
+        runner.Run("record_1m" + suffix, kValues, [&] {
+            for (uint64_t value : values) histogram.Record(value);
+        });
+
+        HdrRecorder recorder(1, kHighest, digits);
+        runner.Run("recorder_record_1m" + suffix, kValues, [&] {
+            for (uint64_t value : values) recorder.Record(value);
+        });
+
+        // Four threads' worth of shards, merged the way a reporter would.
+        std::vector<std::thread> threads;
+        for (int t = 0; t < 4; ++t)
+        {
+            threads.emplace_back([&] {
+                for (size_t i = 0; i < kValues; i += 16) recorder.Record(values[i]);
+            });
+        }
+        for (auto& thread : threads) thread.join();
+        runner.Run("snapshot_5_shards" + suffix, 5, [&] { bench::DoNotOptimize(recorder.Snapshot()); });
+
+        std::string data;
+        runner.Run("serialize" + suffix, 1, [&] { data = histogram.Serialize(); });
+        runner.Run("deserialize" + suffix, 1, [&] { bench::DoNotOptimize(HdrHistogram::Deserialize(data)); });
+        runner.Run("p99" + suffix, 1, [&] { bench::DoNotOptimize(histogram.ValueAtPercentile(99)); });
+        std::printf("digits %d: %zu bytes of counts, %zu bytes serialized, %s\n", digits, histogram.Footprint(),
+                    data.size(), FormatSummary(histogram).c_str());
+    }
+    return runner.Finish();
+}
@@ -0,0 +1,82 @@
+#include "bench.h"
+
+#include <concurrency/worker_pool.h>
+#include <image/image_kernels.h>
+#include <image/image_reference.h>
+#include <image/qimage_kernels.h>
+
+#include <random>
+
+#include <QGuiApplication>
+
+using namespace gomarky;
+
+namespace
+{
+
+const char* LevelName(SimdLevel level)
+{
+    switch (level)
+    {
+    case SimdLevel::Scalar: return "scalar";
+    case SimdLevel::Sse2: return "sse2";
+    case SimdLevel::Avx2: return "avx2";
+    }
+    return "?";
+}
+
+} // namespace
+
+int main(int argc, char** argv)
+{
+    qputenv("QT_QPA_PLATFORM", "offscreen");
+    QGuiApplication app(argc, argv);
+    bench::Runner   runner(argc, argv);
+    WorkerPool&     pool = WorkerPool::Global();
+
+    QImage       photo(3840, 2160, QImage::Format_ARGB32_Premultiplied);
+    std::mt19937 rng(9);
+    for (int y = 0; y < photo.height(); ++y)
+    {
+        auto* row = reinterpret_cast<uint32_t*>(photo.scanLine(y));
+        for (int x = 0; x < photo.width(); ++x) row[x] = 0xff000000u | (rng() & 0x00ffffffu);
+    }
+    const double pixels = double(photo.width()) * photo.height();
+    const QSize  thumbnail(480, 270);
+
+    // Qt's own path, for comparison.
+    runner.Run("qt/scaled_smooth", pixels, [&] {
+        bench::DoNotOptimize(photo.scaled(thumbnail, Qt::IgnoreAspectRatio, Qt::SmoothTransformation));
+    });
+
+    QImage work;
+    auto   reset = [&] { work = photo.copy(); };
+    for (SimdLevel level : {SimdLevel::Scalar, SimdLevel::Sse2, SimdLevel::Avx2})
+    {
+        SetMaxSimdLevel(level);
+        if (ActiveSimdLevel() != level) continue; // not supported on this CPU
+        const std::string suffix = std::string("/") + LevelName(level);
+
+        runner.RunWithSetup("premultiply" + suffix, pixels, reset, [&] { Premultiply(PremultipliedView(work, pool), pool); });
+        runner.RunWithSetup("unpremultiply" + suffix, pixels, reset, [&] { Unpremultiply(PremultipliedView(work, pool), pool); });
+        runner.RunWithSetup("box_blur/r=8" + suffix, pixels, reset, [&] { BoxBlur(PremultipliedView(work, pool), 8, pool); });
+        runner.RunWithSetup("gaussian_blur/sigma=4" + suffix, pixels, reset, [&] { BlurImage(work, 4.0, pool); });
+        for (auto filter : {ResizeFilter::Box, ResizeFilter::Triangle, ResizeFilter::Lanczos3})
+        {
+            const char* name = filter == ResizeFilter::Box ? "box" : filter == ResizeFilter::Triangle ? "triangle" : "lanczos3";
+            runner.Run(std::string("resize/thumbnail/") + name + suffix, pixels,
+                       [&] { bench::DoNotOptimize(ScaleImage(photo, thumbnail, filter, pool)); });
+        }
+        runner.Run("resize/upscale2x/triangle" + suffix, pixels * 4,
+                   [&] { bench::DoNotOptimize(ScaleImage(photo, photo.size() * 2, ResizeFilter::Triangle, pool)); });
+    }
+    SetMaxSimdLevel(SimdLevel::Avx2);
+
+    // The reference kernels are deliberately naive; one blur shows how far off they are.
+    runner.RunWithSetup("reference/box_blur/r=8", pixels, reset, [&] {
+        QImage&   image = work;
+        ImageView view{image.bits(), image.width(), image.height(), static_cast<ptrdiff_t>(image.bytesPerLine())};
+        reference::BoxBlur(view, 8);
+    });
+    return runner.Finish();
+}
@@ -0,0 +1,68 @@
+#include "bench.h"
+
+#include <concurrency/instrumented_mutex.h>
+
+#include <cstdio>
+#include <mutex>
+#include <shared_mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace gomarky;
+
+namespace
+{
+
+constexpr int kIterations = 1000000;
+
+template<typename Mutex>
+void LockUnlock(Mutex& mutex, int iterations, int& value)
+{
+    for (int i = 0; i < iterations; ++i)
+    {
+        std::lock_guard<Mutex> lock(mutex);
+        ++value;
+    }
+}
+
+// `threads` threads sharing one lock for kIterations acquisitions in total.
+template<typename Mutex>
+void Contended(Mutex& mutex, int threads, int& value)
+{
+    std::vector<std::thread> workers;
+    for (int t = 0; t < threads; ++t) workers.emplace_back([&] { LockUnlock(mutex, kIterations / threads, value); });
+    for (auto& worker : workers) worker.join();
+}
+
+} // namespace
+
+int main(int argc, char** argv)
+{
+    bench::Runner runner(argc, argv);
+    int           value = 0;
+
+    std::mutex              plain;
+    InstrumentedMutex       instrumented(GM_LOCK_SITE("bench.instrumented"));
+    std::shared_timed_mutex plain_shared;
+    InstrumentedSharedMutex instrumented_shared(GM_LOCK_SITE("bench.instrumented_shared"));
+
+    runner.Run("uncontended_1m/std_mutex", kIterations, [&] { LockUnlock(plain, kIterations, value); });
+    runner.Run("uncontended_1m/instrumented_mutex", kIterations, [&] { LockUnlock(instrumented, kIterations, value); });
+    runner.Run("uncontended_1m/std_shared_timed_mutex", kIterations,
+               [&] { LockUnlock(plain_shared, kIterations, value); });
+    runner.Run("uncontended_1m/instrumented_shared_mutex", kIterations,
+               [&] { LockUnlock(instrumented_shared, kIterations, value); });
+
+    for (int threads : {2, 4})
+    {
+        const std::string suffix = "/threads_" + std::to_string(threads);
+        runner.Run("contended_1m/std_mutex" + suffix, kIterations, [&] { Contended(plain, threads, value); });
+        runner.Run("contended_1m/instrumented_mutex" + suffix, kIterations,
+                   [&] { Contended(instrumented, threads, value); });
+    }
+    bench::DoNotOptimize(value);
+
+    std::printf("%s", LockProfiler::Format().c_str());
+    return runner.Finish();
+}
@@ -0,0 +1,96 @@
+#include "bench.h"
+
+#include <layout/layout_host.h>
+#include <text/static_text_label.h>
+
+#include <memory>
+#include <vector>
+
+#include <QApplication>
+#include <QGridLayout>
+
+using namespace gomarky;
+
+namespace
+{
+
+constexpr int kRows    = 100;
+constexpr int kColumns = 50;
+
+QString CellText(int row, int column) { return QStringLiteral("%1:%2").arg(row).arg(column); }
+
+// Let the pending LayoutRequest run, the way the event loop would before the next paint.
+void ProcessLayout() { QCoreApplication::sendPostedEvents(nullptr, QEvent::LayoutRequest); }
+
+} // namespace
+
+int main(int argc, char** argv)
+{
+    qputenv("QT_QPA_PLATFORM", "offscreen");
+    QApplication  app(argc, argv);
+    bench::Runner runner(argc, argv);
+
+    int tick = 0;
+    // Same width as the cell text, so only the changed label itself needs any work.
+    auto next_text = [&tick] {
+        const int n = ++tick;
+        return QStringLiteral("%1:%2").arg(10 + n % 80).arg(10 + n % 40);
+    };
+
+    {
+        QWidget                       window;
+        auto*                         grid = new QGridLayout(&window);
+        std::vector<StaticTextLabel*> labels;
+        for (int row = 0; row < kRows; ++row)
+        {
+            for (int column = 0; column < kColumns; ++column)
+            {
+                labels.push_back(new StaticTextLabel(CellText(row, column)));
+                grid->addWidget(labels.back(), row, column);
+            }
+        }
+        window.setAttribute(Qt::WA_DontShowOnScreen);
+        window.show();
+        ProcessLayout();
+
+        runner.Run("one_cell_update/qgridlayout", 1, [&] {
+            labels[42 * kColumns + 7]->SetText(next_text());
+            ProcessLayout();
+        });
+        runner.Run("frame_of_100_updates/qgridlayout", 100, [&] {
+            for (int i = 0; i < 100; ++i) labels[(i * 37) % labels.size()]->SetText(next_text());
+            ProcessLayout();
+        });
+    }
+
+    {
+        QWidget                       window;
+        auto*                         host = new LayoutHost(&window, LayoutTree::Kind::Column);
+        const auto                    grid = host->AddContainer(LayoutTree::kRoot, LayoutTree::Kind::Grid);
+        std::vector<StaticTextLabel*> labels;
+        host->SetSpacing(grid, 6, 9);
+        for (int row = 0; row < kRows; ++row)
+        {
+            for (int column = 0; column < kColumns; ++column)
+            {
+                labels.push_back(new StaticTextLabel(CellText(row, column)));
+                host->AddWidget(grid, labels.back(), LayoutTree::Slot{0, row, column});
+            }
+        }
+        window.setAttribute(Qt::WA_DontShowOnScreen);
+        window.show();
+        ProcessLayout();
+
+        runner.Run("one_cell_update/layout_host", 1, [&] {
+            labels[42 * kColumns + 7]->SetText(next_text());
+            ProcessLayout();
+        });
+        runner.Run("frame_of_100_updates/layout_host", 100, [&] {
+            for (int i = 0; i < 100; ++i) labels[(i * 37) % labels.size()]->SetText(next_text());
+            ProcessLayout();
+        });
+        std::printf("layout_host: last pass moved %d widgets, visited %zu nodes\n", host->LastPassChanges(),
+                    host->Tree().LastArrangeVisits());
+    }
+    return runner.Finish();
+}
@@ -0,0 +1,77 @@
+#include "bench.h"
+
+#include <concurrency/parallel_sort.h>
+#include <concurrency/worker_pool.h>
+#include <table/row_order.h>
+
+#include <algorithm>
+#include <random>
+
+using namespace gomarky;
+
+namespace
+{
+
+void FillTable(ColumnTable& table, size_t rows)
+{
+    auto& ints    = table.AddInt64Column("ints");
+    auto& doubles = table.AddDoubleColumn("doubles");
+    auto& strings = table.AddStringColumn("strings");
+    table.Reserve(rows);
+
+    std::mt19937_64 rng(42);
+    for (size_t i = 0; i < rows; ++i)
+    {
+        ints.Append(static_cast<int64_t>(rng() % 1000000));
+        doubles.Append(static_cast<double>(rng() % 1000000) / 7.0);
+        strings.Append("name-" + std::to_string(rng() % 50000));
+    }
+}
+
+RowPredicate IntsBelow(int64_t limit)
+{
+    return [limit](const ColumnTable& table, uint32_t row) {
+        return static_cast<const Int64Column&>(table.At(0)).Value(row) < limit;
+    };
+}
+
+} // namespace
+
+int main(int argc, char** argv)
+{
+    bench::Runner runner(argc, argv);
+    WorkerPool&   pool = WorkerPool::Global();
+
+    for (size_t rows : {size_t(1000000), size_t(10000000)})
+    {
+        const std::string suffix = rows == 1000000 ? "/1M" : "/10M";
+        ColumnTable       table;
+        FillTable(table, rows);
+        RowIds shuffled = AllRows(table);
+        RowIds work;
+
+        auto reset = [&] { work = shuffled; };
+        for (int column = 0; column < 3; ++column)
+        {
+            const std::string name = table.At(size_t(column)).Name();
+            runner.RunWithSetup("sort/parallel/" + name + suffix, double(rows), reset,
+                                [&] { SortRows(table, {column, true}, work, pool); });
+        }
+
+        // Baseline: what a single-threaded stable sort of the same rows costs.
+        const int64_t* ints = static_cast<const Int64Column&>(table.At(0)).Data();
+        runner.RunWithSetup("sort/std_stable_sort/ints" + suffix, double(rows), reset, [&] {
+            std::stable_sort(work.begin(), work.end(), [ints](uint32_t a, uint32_t b) { return ints[a] < ints[b]; });
+        });
+
+        const RowIds all  = AllRows(table);
+        const RowIds half = FilterRows(table, IntsBelow(500000), all, pool);
+        runner.Run("filter/full_rescan" + suffix, double(rows), [&] {
+            bench::DoNotOptimize(FilterRows(table, IntsBelow(250000), all, pool));
+        });
+        runner.Run("filter/narrowing" + suffix, double(rows), [&] {
+            bench::DoNotOptimize(FilterRows(table, IntsBelow(250000), half, pool));
+        });
+    }
+    return runner.Finish();
+}
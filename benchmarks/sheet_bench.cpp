@@ -0,0 +1,74 @@
+#include "bench.h"
+
+#include <calc/sheet.h>
+#include <concurrency/worker_pool.h>
+
+#include <memory>
+#include <string>
+
+using namespace gomarky;
+
+namespace
+{
+
+constexpr int kChains      = 1000;
+constexpr int kChainLength = 90;
+constexpr int kWide        = 10000; // cells reading one shared input
+
+// 1000 independent chains of 90 cells plus 10k cells fanning out of "rate": about 100k cells.
+std::unique_ptr<Sheet> BuildSheet()
+{
+    std::unique_ptr<Sheet> sheet(new Sheet);
+    sheet->SetNumber("rate", 1.5);
+    for (int chain = 0; chain < kChains; ++chain)
+    {
+        const std::string prefix = "c" + std::to_string(chain) + "_";
+        sheet->SetNumber(prefix + "0", chain);
+        for (int i = 1; i < kChainLength; ++i)
+        {
+            sheet->SetFormula(prefix + std::to_string(i), prefix + std::to_string(i - 1) + " * 1.01 + 1");
+        }
+    }
+    for (int i = 0; i < kWide; ++i) sheet->SetFormula("w" + std::to_string(i), "rate * " + std::to_string(i) + " + 1");
+    return sheet;
+}
+
+} // namespace
+
+int main(int argc, char** argv)
+{
+    bench::Runner runner(argc, argv);
+    WorkerPool&   pool = WorkerPool::Global();
+    WorkerPool    single(1);
+
+    std::unique_ptr<Sheet> sheet;
+    auto                   build = [&] { sheet = BuildSheet(); };
+    const double           cells = kChains * kChainLength + kWide + 1;
+    runner.RunWithSetup("full_recalc/100k/pool", cells, build, [&] { bench::DoNotOptimize(sheet->Recalculate(pool)); });
+    runner.RunWithSetup("full_recalc/100k/single", cells, build,
+                        [&] { bench::DoNotOptimize(sheet->Recalculate(single)); });
+
+    // The cost of an edit should follow the number of dependents, not the 100k cells around them.
+    sheet = BuildSheet();
+    sheet->Recalculate(pool);
+    int tick = 0;
+    runner.Run("edit_chain_input/90_dependents", kChainLength, [&] {
+        const int n = ++tick;
+        sheet->SetNumber("c" + std::to_string(n % kChains) + "_0", n);
+        bench::DoNotOptimize(sheet->Recalculate(pool));
+    });
+    runner.Run("edit_chain_tail/1_dependent", 1, [&] {
+        const int n = ++tick;
+        sheet->SetNumber("c" + std::to_string(n % kChains) + "_" + std::to_string(kChainLength - 1), n);
+        bench::DoNotOptimize(sheet->Recalculate(pool));
+    });
+    runner.Run("edit_shared_input/10k_dependents/pool", kWide, [&] {
+        sheet->SetNumber("rate", ++tick);
+        bench::DoNotOptimize(sheet->Recalculate(pool));
+    });
+    runner.Run("edit_shared_input/10k_dependents/single", kWide, [&] {
+        sheet->SetNumber("rate", ++tick);
+        bench::DoNotOptimize(sheet->Recalculate(single));
+    });
+    return runner.Finish();
+}
@@ -0,0 +1,56 @@
+#include "bench.h"
+
+#include <QCoreApplication>
+#include <QDir>
+#include <QProcess>
+#include <QTemporaryDir>
+
+#include <cstdio>
+
+// Time from launching gomarky to its first painted frame, as whole separate processes.
+// Every run starts a fresh process, so the font database scan and glyph rasterization are paid
+// each time, as they are by users. The glyph atlas cache is isolated in a temporary directory:
+// the "cold" runs empty it first, the "warm" runs reuse what the previous run wrote.
+
+namespace
+{
+
+bool Launch(const QStringList& arguments, const QString& cache_home)
+{
+    QProcess            process;
+    QProcessEnvironment environment = QProcessEnvironment::systemEnvironment();
+    environment.insert(QStringLiteral("XDG_CACHE_HOME"), cache_home);
+    if (!environment.contains(QStringLiteral("QT_QPA_PLATFORM")))
+    {
+        environment.insert(QStringLiteral("QT_QPA_PLATFORM"), QStringLiteral("offscreen"));
+    }
+    process.setProcessEnvironment(environment);
+    process.start(QStringLiteral(GM_APP_PATH), QStringList{QStringLiteral("--quit-after-first-paint")} + arguments);
+    return process.waitForFinished(60000) && process.exitStatus() == QProcess::NormalExit;
+}
+
+} // namespace
+
+int main(int argc, char** argv)
+{
+    QCoreApplication app(argc, argv);
+    bench::Runner    runner(argc, argv);
+
+    QTemporaryDir cache_home;
+    if (!cache_home.isValid() || !Launch({}, cache_home.path()))
+    {
+        std::fprintf(stderr, "could not run %s\n", GM_APP_PATH);
+        return 1;
+    }
+    auto clear_cache = [&] {
+        QDir(cache_home.path()).removeRecursively();
+        QDir().mkpath(cache_home.path());
+    };
+
+    runner.Run("startup/first_paint/default", 1, [&] { Launch({}, cache_home.path()); });
+    runner.RunWithSetup("startup/first_paint/prewarm/cold_cache", 1, clear_cache,
+                        [&] { Launch({QStringLiteral("--prewarm-fonts")}, cache_home.path()); });
+    runner.Run("startup/first_paint/prewarm/warm_cache", 1,
+               [&] { Launch({QStringLiteral("--prewarm-fonts")}, cache_home.path()); });
+    return runner.Finish();
+}
@@ -0,0 +1,122 @@
+#include "bench.h"
+
+#include <concurrency/task_graph.h>
+#include <concurrency/worker_pool.h>
+
+#include <chrono>
+#include <cstdio>
+#include <memory>
+#include <random>
+#include <vector>
+
+using namespace gomarky;
+
+namespace
+{
+
+constexpr int kLayers = 50;
+constexpr int kWidth  = 100;
+
+// Uneven work so that a barrier per layer waits for its slowest task.
+void Work(int units)
+{
+    double x = 1;
+    for (int i = 0; i < units * 200; ++i) x = x * 1.0000001 + 1e-9;
+    bench::DoNotOptimize(x);
+}
+
+int Units(int layer, int column) { return 1 + (layer * 31 + column * 17) % 20; }
+
+// Each task depends on three tasks of the previous layer.
+std::unique_ptr<TaskGraph> BuildLayered(WorkerPool& pool)
+{
+    std::unique_ptr<TaskGraph>     graph(new TaskGraph(pool));
+    std::mt19937                   random(3);
+    std::vector<TaskGraph::TaskId> previous;
+    std::vector<TaskGraph::TaskId> current;
+    for (int layer = 0; layer < kLayers; ++layer)
+    {
+        current.clear();
+        for (int column = 0; column < kWidth; ++column)
+        {
+            const int units = Units(layer, column);
+            current.push_back(graph->Add("work", [units](TaskGraph::Context&) { Work(units); }));
+            for (int d = 0; d < 3 && !previous.empty(); ++d)
+            {
+                graph->Precede(previous[random() % previous.size()], current.back());
+            }
+        }
+        previous.swap(current);
+    }
+    return graph;
+}
+
+} // namespace
+
+int main(int argc, char** argv)
+{
+    bench::Runner runner(argc, argv);
+    WorkerPool&   pool  = WorkerPool::Global();
+    const double  tasks = kLayers * kWidth;
+
+    // The same work run layer by layer with a barrier in between, the way hand-chained
+    // callbacks usually end up being written.
+    runner.Run("layered_5000/parallel_for_per_layer", tasks, [&] {
+        for (int layer = 0; layer < kLayers; ++layer)
+        {
+            pool.ParallelFor(kWidth, 1, [layer](size_t begin, size_t end) {
+                for (size_t column = begin; column < end; ++column) Work(Units(layer, int(column)));
+            });
+        }
+    });
+
+    std::unique_ptr<TaskGraph> graph;
+    runner.RunWithSetup("layered_5000/task_graph", tasks, [&] { graph = BuildLayered(pool); }, [&] {
+        graph->Run();
+        graph->Wait();
+    });
+    runner.Run("build_layered_5000/task_graph", tasks, [&] { graph = BuildLayered(pool); });
+
+    // Scheduling overhead alone: empty tasks in a wide fan-out/fan-in and in one long chain.
+    runner.RunWithSetup("fan_out_10000_empty/task_graph", 10000,
+                        [&] {
+                            graph.reset(new TaskGraph(pool));
+                            const auto source = graph->Add("source", [](TaskGraph::Context&) {});
+                            const auto sink   = graph->Add("sink", [](TaskGraph::Context&) {});
+                            for (int i = 0; i < 10000; ++i)
+                            {
+                                const auto task = graph->Add("leaf", [](TaskGraph::Context&) {});
+                                graph->Precede(source, task);
+                                graph->Precede(task, sink);
+                            }
+                        },
+                        [&] {
+                            graph->Run();
+                            graph->Wait();
+                        });
+    runner.RunWithSetup("chain_10000_empty/task_graph", 10000,
+                        [&] {
+                            graph.reset(new TaskGraph(pool));
+                            TaskGraph::TaskId previous = graph->Add("link", [](TaskGraph::Context&) {});
+                            for (int i = 1; i < 10000; ++i)
+                            {
+                                const auto task = graph->Add("link", [](TaskGraph::Context&) {});
+                                graph->Precede(previous, task);
+                                previous = task;
+                            }
+                        },
+                        [&] {
+                            graph->Run();
+                            graph->Wait();
+                        });
+
+    graph = BuildLayered(pool);
+    graph->Run();
+    graph->Wait();
+    const auto stats = graph->Stats();
+    std::printf("layered_5000: wall %.2f ms, busy %.2f ms, critical path %zu tasks running %.2f ms\n",
+                std::chrono::duration<double, std::milli>(stats.wall).count(),
+                std::chrono::duration<double, std::milli>(stats.busy).count(), stats.critical_path.size(),
+                std::chrono::duration<double, std::milli>(stats.CriticalPathRunning()).count());
+    return runner.Finish();
+}
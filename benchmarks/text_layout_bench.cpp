@@ -0,0 +1,80 @@
+#include "bench.h"
+
+#include <text/static_text_label.h>
+#include <text/text_layout_cache.h>
+
+#include <functional>
+#include <memory>
+
+#include <QApplication>
+#include <QGridLayout>
+#include <QLabel>
+#include <QPainter>
+
+using namespace gomarky;
+
+namespace
+{
+
+constexpr int kRows    = 100;
+constexpr int kColumns = 50;
+
+// Dashboard-like content: a few recurring captions and many distinct values.
+QString CellText(int row, int column)
+{
+    static const char* const kCaptions[] = {"CPU", "Memory", "Disk I/O", "Network", "Latency p99", "Errors"};
+    if (column % 2 == 0) return QString::fromLatin1(kCaptions[(row + column) % 6]);
+    return QStringLiteral("%1.%2 ms").arg(row * 7 + column).arg(column % 10);
+}
+
+std::unique_ptr<QWidget> BuildGrid(const std::function<QWidget*(const QString&)>& make_label)
+{
+    auto  grid   = std::make_unique<QWidget>();
+    auto* layout = new QGridLayout(grid.get());
+    layout->setSpacing(2);
+    for (int row = 0; row < kRows; ++row)
+    {
+        for (int column = 0; column < kColumns; ++column) layout->addWidget(make_label(CellText(row, column)), row, column);
+    }
+    grid->resize(grid->sizeHint());
+    grid->setAttribute(Qt::WA_DontShowOnScreen);
+    grid->show();
+    return grid;
+}
+
+} // namespace
+
+int main(int argc, char** argv)
+{
+    qputenv("QT_QPA_PLATFORM", "offscreen");
+    QApplication  app(argc, argv);
+    bench::Runner runner(argc, argv);
+
+    const double labels = kRows * kColumns;
+
+    auto qlabels = BuildGrid([](const QString& text) { return new QLabel(text); });
+    QImage target(qlabels->size(), QImage::Format_ARGB32_Premultiplied);
+    runner.Run("repaint_grid/qlabel", labels, [&] { qlabels->render(&target); });
+    qlabels.reset();
+
+    TextLayoutCache cache;
+    auto            static_labels = BuildGrid([&cache](const QString& text) { return new StaticTextLabel(text, cache); });
+    target = QImage(static_labels->size(), QImage::Format_ARGB32_Premultiplied);
+    runner.Run("repaint_grid/static_text_label", labels, [&] { static_labels->render(&target); });
+
+    // Every label has to shape its text again, e.g. right after a font change.
+    runner.RunWithSetup("repaint_grid/static_text_label/cold_cache", labels,
+                        [&] {
+                            cache.Clear();
+                            QEvent font_change(QEvent::FontChange);
+                            for (auto* label : static_labels->findChildren<StaticTextLabel*>())
+                            {
+                                QApplication::sendEvent(label, &font_change);
+                            }
+                        },
+                        [&] { static_labels->render(&target); });
+
+    std::printf("layout cache: %zu layouts, %zu bytes, %llu hits, %llu misses\n", cache.Size(), cache.UsedBytes(),
+                static_cast<unsigned long long>(cache.Hits()), static_cast<unsigned long long>(cache.Misses()));
+    return runner.Finish();
+}
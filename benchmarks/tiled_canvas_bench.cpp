@@ -0,0 +1,77 @@
+#include "bench.h"
+
+#include <concurrency/worker_pool.h>
+#include <render/tiled_canvas.h>
+
+#include <algorithm>
+#include <random>
+#include <thread>
+#include <vector>
+
+#include <QGuiApplication>
+#include <QPainter>
+
+using namespace gomarky;
+
+namespace
+{
+
+struct Shape
+{
+    QRectF rect;
+    QColor color;
+};
+
+} // namespace
+
+int main(int argc, char** argv)
+{
+    // Raster painting only, no need for a display.
+    qputenv("QT_QPA_PLATFORM", "offscreen");
+    QGuiApplication app(argc, argv);
+    bench::Runner   runner(argc, argv);
+
+    const QSize        size(3840, 2160);
+    std::vector<Shape> shapes;
+    std::mt19937       rng(5);
+    for (int i = 0; i < 20000; ++i)
+    {
+        const double x = rng() % size.width(), y = rng() % size.height(), r = 5 + rng() % 60;
+        shapes.push_back({QRectF(x - r, y - r, 2 * r, 2 * r), QColor::fromHsv(int(rng() % 360), 200, 230, 160)});
+    }
+
+    TiledCanvas canvas(size);
+    canvas.SetPaintFunction([&shapes](QPainter& painter, const QRect& clip) {
+        painter.setRenderHint(QPainter::Antialiasing);
+        painter.setPen(Qt::NoPen);
+        for (const auto& shape : shapes)
+        {
+            if (!shape.rect.intersects(clip)) continue;
+            painter.setBrush(shape.color);
+            painter.drawEllipse(shape.rect);
+        }
+    });
+
+    const size_t max_threads = std::max(1u, std::thread::hardware_concurrency());
+    for (size_t threads = 1;; threads = std::min(threads * 2, max_threads))
+    {
+        WorkerPool pool(threads);
+        runner.Run("render/full_frame/threads=" + std::to_string(threads), double(canvas.TileCount()), [&] {
+            canvas.InvalidateAll();
+            canvas.Render(pool);
+        });
+        runner.Run("render/one_tile_dirty/threads=" + std::to_string(threads), 1, [&] {
+            canvas.Invalidate(QRect(1000, 1000, 1, 1));
+            canvas.Render(pool);
+        });
+        if (threads == max_threads) break;
+    }
+
+    // Cost of putting the cached tiles on screen, the part that stays on the GUI thread.
+    QImage target(size, QImage::Format_ARGB32_Premultiplied);
+    runner.Run("composite/full_frame", double(canvas.TileCount()), [&] {
+        QPainter painter(&target);
+        canvas.Composite(painter, QRect(QPoint(0, 0), size));
+    });
+    return runner.Finish();
+}
@@ -0,0 +1,120 @@
+#include "bench.h"
+
+#include <timers/qt_timer_wheel.h>
+#include <timers/timer_wheel.h>
+
+#include <cstdint>
+#include <memory>
+#include <random>
+#include <vector>
+
+#include <QCoreApplication>
+#include <QTimer>
+
+using namespace gomarky;
+
+namespace
+{
+
+constexpr size_t kTimers = 100000;
+
+// Timeouts between 10 ms and 60 s, like a mix of debounces, refreshes and network timeouts.
+std::vector<uint64_t> MakeDelays()
+{
+    std::mt19937_64       random(7);
+    std::vector<uint64_t> delays(kTimers);
+    for (auto& delay : delays) delay = 10 + random() % 60000;
+    return delays;
+}
+
+} // namespace
+
+int main(int argc, char** argv)
+{
+    QCoreApplication app(argc, argv);
+    bench::Runner    runner(argc, argv);
+
+    const std::vector<uint64_t> delays = MakeDelays();
+    uint64_t                    fired  = 0;
+
+    {
+        std::unique_ptr<TimerWheel>      wheel;
+        std::vector<TimerWheel::TimerId> ids(kTimers);
+        auto fresh = [&] { wheel.reset(new TimerWheel(1)); };
+        auto fill  = [&] {
+            fresh();
+            for (size_t i = 0; i < kTimers; ++i) ids[i] = wheel->Schedule(delays[i], [&fired] { ++fired; });
+        };
+
+        runner.RunWithSetup("arm_100k/timer_wheel", kTimers, fresh, [&] {
+            for (size_t i = 0; i < kTimers; ++i) ids[i] = wheel->Schedule(delays[i], [&fired] { ++fired; });
+        });
+        runner.RunWithSetup("restart_100k/timer_wheel", kTimers, fill, [&] {
+            for (size_t i = 0; i < kTimers; ++i) wheel->Restart(ids[i], delays[kTimers - 1 - i]);
+        });
+        runner.RunWithSetup("cancel_100k/timer_wheel", kTimers, fill, [&] {
+            for (size_t i = 0; i < kTimers; ++i) wheel->Cancel(ids[i]);
+        });
+        // Every timer fires at its deadline, in 1 ms steps, the way the event loop would drive it.
+        runner.RunWithSetup("expire_100k_in_1ms_steps/timer_wheel", kTimers, fill, [&] {
+            for (uint64_t now = 1; now <= 60010; ++now) wheel->Advance(now);
+        });
+
+        auto repeating = [&] {
+            fresh();
+            for (size_t i = 0; i < kTimers; ++i) wheel->ScheduleRepeating(16 + delays[i] % 1000, [&fired] { ++fired; });
+        };
+        runner.RunWithSetup("10s_of_100k_repeating/timer_wheel", 10000, repeating, [&] {
+            for (uint64_t now = 1; now <= 10000; ++now) wheel->Advance(now);
+        });
+    }
+
+    {
+        std::unique_ptr<QtTimerWheel>      wheel;
+        std::vector<QtTimerWheel::TimerId> ids(kTimers);
+        auto fresh = [&] { wheel.reset(new QtTimerWheel(1)); };
+
+        runner.RunWithSetup("arm_100k/qt_timer_wheel", kTimers, fresh, [&] {
+            for (size_t i = 0; i < kTimers; ++i) ids[i] = wheel->Schedule(delays[i], [&fired] { ++fired; });
+        });
+        runner.Run("cancel_and_rearm_100k/qt_timer_wheel", kTimers, [&] {
+            for (size_t i = 0; i < kTimers; ++i)
+            {
+                wheel->Cancel(ids[i]);
+                ids[i] = wheel->Schedule(delays[kTimers - 1 - i], [&fired] { ++fired; });
+            }
+        });
+    }
+
+    {
+        // The per-object baseline: every timer registers with the event dispatcher.
+        std::vector<std::unique_ptr<QTimer>> timers;
+        auto fresh = [&] {
+            timers.clear();
+            for (size_t i = 0; i < kTimers; ++i)
+            {
+                timers.emplace_back(new QTimer);
+                timers.back()->setSingleShot(true);
+                QObject::connect(timers.back().get(), &QTimer::timeout, [&fired] { ++fired; });
+            }
+        };
+        auto armed = [&] {
+            fresh();
+            for (size_t i = 0; i < kTimers; ++i) timers[i]->start(int(delays[i]));
+        };
+
+        runner.RunWithSetup("arm_100k/qtimer", kTimers, fresh, [&] {
+            for (size_t i = 0; i < kTimers; ++i) timers[i]->start(int(delays[i]));
+        });
+        runner.RunWithSetup("restart_100k/qtimer", kTimers, armed, [&] {
+            for (size_t i = 0; i < kTimers; ++i) timers[i]->start(int(delays[kTimers - 1 - i]));
+        });
+        runner.RunWithSetup("cancel_100k/qtimer", kTimers, armed, [&] {
+            for (size_t i = 0; i < kTimers; ++i) timers[i]->stop();
+        });
+        timers.clear();
+    }
+
+    bench::DoNotOptimize(fired);
+    return runner.Finish();
+}
@@ -0,0 +1,95 @@
+#include "bench.h"
+
+#include <concurrency/worker_pool.h>
+#include <system/cpu_topology.h>
+
+#include <algorithm>
+#include <cstdio>
+#include <vector>
+
+using namespace gomarky;
+
+namespace
+{
+
+constexpr size_t kValues = size_t(32) << 20; // 256 MB of doubles, well past any L3
+
+// One slice of the input per worker, as a column store splits a table into row groups.
+struct Slices
+{
+    std::vector<double*> data;
+    size_t               length = 0;
+};
+
+double SumSlice(const double* values, size_t length)
+{
+    double acc[4] = {};
+    for (size_t i = 0; i + 4 <= length; i += 4)
+    {
+        acc[0] += values[i];
+        acc[1] += values[i + 1];
+        acc[2] += values[i + 2];
+        acc[3] += values[i + 3];
+    }
+    return (acc[0] + acc[1]) + (acc[2] + acc[3]);
+}
+
+// Every worker sums its own slice; this is the part placement is supposed to speed up.
+double Aggregate(WorkerPool& pool, const Slices& slices)
+{
+    std::vector<double> partial(pool.Size() * 8); // a cache line apart
+    pool.RunOnEachWorker(
+        [&](size_t worker) { partial[worker * 8] = SumSlice(slices.data[worker], slices.length); });
+    double total = 0;
+    for (size_t worker = 0; worker < pool.Size(); ++worker) total += partial[worker * 8];
+    return total;
+}
+
+} // namespace
+
+int main(int argc, char** argv)
+{
+    bench::Runner     runner(argc, argv);
+    const CpuTopology topology = CpuTopology::Discover();
+    const size_t      workers  = AllowedCpus(topology).size();
+    std::printf("topology: %s, %zu workers\n", topology.Describe().c_str(), workers);
+
+    WorkerPool unpinned(workers);
+    WorkerPool pinned(workers, topology);
+
+    // Baseline: one buffer written by the main thread, so its pages sit on the main thread's node.
+    std::vector<double> shared(kValues, 1.0);
+    Slices              from_main;
+    from_main.length = kValues / workers;
+    for (size_t worker = 0; worker < workers; ++worker) from_main.data.push_back(&shared[worker * from_main.length]);
+
+    // Per-worker buffers bound to the worker's node and first touched by the worker itself.
+    Slices local;
+    local.length = from_main.length;
+    local.data.resize(workers);
+    pinned.RunOnEachWorker([&](size_t worker) {
+        auto* values = static_cast<double*>(AllocateOnNode(local.length * sizeof(double), pinned.WorkerNode(worker)));
+        std::fill(values, values + local.length, 1.0);
+        local.data[worker] = values;
+    });
+
+    const double items = double(from_main.length * workers);
+    runner.Run("sum_256mb/unpinned_main_allocated", items,
+               [&] { bench::DoNotOptimize(Aggregate(unpinned, from_main)); });
+    runner.Run("sum_256mb/pinned_main_allocated", items,
+               [&] { bench::DoNotOptimize(Aggregate(pinned, from_main)); });
+    runner.Run("sum_256mb/pinned_node_local", items, [&] { bench::DoNotOptimize(Aggregate(pinned, local)); });
+
+    // Fine-grained chunks posted from outside the pool land round robin on the domain queues;
+    // workers drain their own L3's queue before stealing.
+    const size_t steals_before = pinned.Steals();
+    runner.Run("sum_256mb/pinned_parallel_for_64k_chunks", double(kValues), [&] {
+        pinned.ParallelFor(kValues, 1 << 16, [&](size_t begin, size_t end) {
+            bench::DoNotOptimize(SumSlice(shared.data() + begin, end - begin));
+        });
+    });
+    std::printf("parallel_for: %zu cross-domain steals\n", pinned.Steals() - steals_before);
+
+    for (double* values : local.data) FreeOnNode(values, local.length * sizeof(double));
+    return runner.Finish();
+}
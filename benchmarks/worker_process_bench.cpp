@@ -0,0 +1,147 @@
+#include "bench.h"
+
+#include <metrics/hdr_histogram.h>
+#include <process/worker_main.h>
+#include <process/worker_process.h>
+
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#if defined(__linux__)
+#include <unistd.h>
+#endif
+
+using namespace gomarky;
+
+namespace
+{
+
+// Stand-ins for plugin work: a digest of the request (small response) and a transformed copy
+// of it (response as large as the request). The first byte picks which.
+uint64_t Digest(const unsigned char* data, size_t size)
+{
+    uint64_t hash = 1469598103934665603ull;
+    for (size_t i = 0; i < size; ++i) hash = (hash ^ data[i]) * 1099511628211ull;
+    return hash;
+}
+
+void Transform(const unsigned char* data, size_t size, unsigned char* out)
+{
+    for (size_t i = 0; i < size; ++i) out[i] = static_cast<unsigned char>(data[i] ^ 0x5a);
+}
+
+void Handle(const void* request, size_t size, WorkerReply& reply)
+{
+    const auto* bytes = static_cast<const unsigned char*>(request);
+    if (size && bytes[0] == 't')
+    {
+        Transform(bytes, size, static_cast<unsigned char*>(reply.Allocate(size)));
+        return;
+    }
+    const uint64_t hash = Digest(bytes, size);
+    std::memcpy(reply.Allocate(sizeof(hash)), &hash, sizeof(hash));
+}
+
+void Fill(void* request, size_t size, char op)
+{
+    std::memset(request, 0x11, size);
+    static_cast<char*>(request)[0] = op;
+}
+
+// The same work without a process boundary: the caller fills a buffer and runs the handler.
+struct InProcess
+{
+    std::vector<unsigned char> request;
+    std::vector<unsigned char> response;
+
+    void Call(size_t size, char op)
+    {
+        request.resize(size);
+        Fill(request.data(), size, op);
+        if (op == 't')
+        {
+            response.resize(size);
+            Transform(request.data(), size, response.data());
+            bench::DoNotOptimize(response[size - 1]);
+        }
+        else
+        {
+            bench::DoNotOptimize(Digest(request.data(), size));
+        }
+    }
+};
+
+bool CallWorker(WorkerProcess& worker, size_t size, char op)
+{
+    unsigned char last = 0;
+    const WorkerStatus status = worker.Call(
+        size, [&](void* request) { Fill(request, size, op); },
+        [&](const void* response, size_t bytes) { last = static_cast<const unsigned char*>(response)[bytes - 1]; });
+    bench::DoNotOptimize(last);
+    return status == WorkerStatus::Ok;
+}
+
+template<typename F>
+std::string Latency(size_t calls, F&& call)
+{
+    HdrHistogram histogram(1, uint64_t(10) * 1000 * 1000 * 1000, 3);
+    for (size_t i = 0; i < calls; ++i)
+    {
+        const auto start = std::chrono::steady_clock::now();
+        call();
+        histogram.Record(static_cast<uint64_t>(
+            std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count()));
+    }
+    return FormatSummary(histogram, 1000.0);
+}
+
+} // namespace
+
+int main(int argc, char** argv)
+{
+    if (argc > 1 && std::strcmp(argv[1], "--worker") == 0) return RunWorker(Handle);
+
+#if defined(__linux__)
+    bench::Runner runner(argc, argv);
+
+    char          path[4096];
+    const ssize_t length = readlink("/proc/self/exe", path, sizeof(path) - 1);
+    if (length <= 0) return 1;
+
+    WorkerProcess::Options options;
+    options.command    = {std::string(path, static_cast<size_t>(length)), "--worker"};
+    options.ring_bytes = size_t(8) << 20;
+    WorkerProcess worker(options);
+    InProcess     local;
+
+    // Throughput in bytes per second; latency in microseconds per call.
+    for (size_t size : {size_t(64), size_t(64) << 10, size_t(1) << 20})
+    {
+        for (char op : {'d', 't'})
+        {
+            const std::string suffix = std::string(op == 't' ? "/transform/" : "/digest/") + std::to_string(size);
+            const size_t      calls  = size <= 4096 ? 10000 : 200;
+
+            runner.Run("in_process" + suffix, double(size * calls), [&] {
+                for (size_t i = 0; i < calls; ++i) local.Call(size, op);
+            });
+            runner.Run("worker" + suffix, double(size * calls), [&] {
+                for (size_t i = 0; i < calls; ++i) CallWorker(worker, size, op);
+            });
+
+            std::printf("  latency in_process%s: %s us\n", suffix.c_str(),
+                        Latency(calls, [&] { local.Call(size, op); }).c_str());
+            std::printf("  latency worker%s: %s us\n", suffix.c_str(),
+                        Latency(calls, [&] { CallWorker(worker, size, op); }).c_str());
+        }
+    }
+    return runner.Finish();
+#else
+    std::printf("worker processes are only implemented on Linux\n");
+    return 0;
+#endif
+}
@@ -0,0 +1,92 @@
+#pragma once
+
+#include <thread>
+#include <utility>
+
+#include "concurrent/common.h"
+#include "concurrent/futex.h"
+
+namespace gomarky
+{
+
+/// Adds blocking Push and Pop to any of the queues in this folder. The non-blocking paths cost one
+/// fence and one load more than the bare queue; threads only sleep after a short spin finds
+/// nothing to do, and are woken through a futex rather than a mutex and condition variable.
+///
+///     BlockingQueue<MpmcRing<Job>> jobs(1024);
+template<typename Queue>
+class BlockingQueue
+{
+public:
+    using ValueType = typename Queue::ValueType;
+
+    template<typename... Args>
+    explicit BlockingQueue(Args&&... args) : m_queue(std::forward<Args>(args)...)
+    {
+    }
+
+    /// Like the queue's own, a failed push leaves its argument alone.
+    bool TryPush(const ValueType& value) { return Pushed(m_queue.TryPush(value)); }
+    bool TryPush(ValueType&& value) { return Pushed(m_queue.TryPush(std::move(value))); }
+
+    bool TryPop(ValueType& out)
+    {
+        if (!m_queue.TryPop(out)) return false;
+        m_not_full.NotifyAll();
+        return true;
+    }
+
+    /// Wait for room, then push.
+    void Push(ValueType value)
+    {
+        Await(m_not_full, [&] { return m_queue.TryPush(std::move(value)); });
+        m_not_empty.NotifyAll();
+    }
+
+    /// Wait for an item, then pop it.
+    void Pop(ValueType& out)
+    {
+        Await(m_not_empty, [&] { return m_queue.TryPop(out); });
+        m_not_full.NotifyAll();
+    }
+
+    Queue& Underlying() { return m_queue; }
+
+private:
+    static constexpr int kSpins = 64;
+
+    bool Pushed(bool pushed)
+    {
+        if (pushed) m_not_empty.NotifyAll();
+        return pushed;
+    }
+
+    template<typename F>
+    static void Await(EventCount& event, F&& attempt)
+    {
+        for (int i = 0; i < kSpins; ++i)
+        {
+            if (attempt()) return;
+            std::this_thread::yield();
+        }
+        for (;;)
+        {
+            const EventCount::Key key = event.PrepareWait();
+            if (attempt())
+            {
+                event.CancelWait();
+                return;
+            }
+            event.Wait(key);
+            if (attempt()) return;
+        }
+    }
+
+    Queue      m_queue;
+    char       m_pad0[kCacheLineSize];
+    EventCount m_not_empty;
+    char       m_pad1[kCacheLineSize];
+    EventCount m_not_full;
+};
+
+} // namespace gomarky
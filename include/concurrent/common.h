@@ -0,0 +1,25 @@
+#pragma once
+
+// Shared pieces of the header-only queues in this folder.
+
+#include <cstddef>
+
+namespace gomarky
+{
+
+/// Padding unit that keeps indices written by different threads on different cache lines.
+constexpr size_t kCacheLineSize = 64;
+
+namespace detail
+{
+
+inline size_t RoundUpToPowerOfTwo(size_t value, size_t minimum = 1)
+{
+    size_t size = minimum;
+    while (size < value) size <<= 1;
+    return size;
+}
+
+} // namespace detail
+
+} // namespace gomarky
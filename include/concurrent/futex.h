@@ -0,0 +1,113 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+
+#if defined(__linux__)
+#include <climits>
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#else
+#include <condition_variable>
+#include <cstddef>
+#include <mutex>
+#endif
+
+namespace gomarky
+{
+
+#if defined(__linux__)
+
+/// Sleep while `word` still holds `expected`. Wakeups may be spurious, so callers re-check their
+/// condition in a loop.
+inline void FutexWait(std::atomic<uint32_t>& word, uint32_t expected)
+{
+    static_assert(sizeof(std::atomic<uint32_t>) == sizeof(uint32_t), "futex words must be plain 32-bit integers");
+    syscall(SYS_futex, reinterpret_cast<uint32_t*>(&word), FUTEX_WAIT_PRIVATE, expected, nullptr, nullptr, 0);
+}
+
+/// Wake the threads sleeping on `word`. Change the word before calling this.
+inline void FutexWakeAll(std::atomic<uint32_t>& word)
+{
+    syscall(SYS_futex, reinterpret_cast<uint32_t*>(&word), FUTEX_WAKE_PRIVATE, INT_MAX, nullptr, nullptr, 0);
+}
+
+#else
+
+namespace detail
+{
+
+// Elsewhere, sleepers park on one of a fixed set of condition variables picked by address. Wakers
+// take the same lock after changing the word, so a sleeper cannot miss the change.
+struct ParkingBucket
+{
+    std::mutex              mutex;
+    std::condition_variable changed;
+};
+
+inline ParkingBucket& BucketFor(const void* address)
+{
+    static ParkingBucket buckets[64];
+    return buckets[(reinterpret_cast<uintptr_t>(address) / sizeof(uint32_t)) % 64];
+}
+
+} // namespace detail
+
+inline void FutexWait(std::atomic<uint32_t>& word, uint32_t expected)
+{
+    auto&                        bucket = detail::BucketFor(&word);
+    std::unique_lock<std::mutex> lock(bucket.mutex);
+    if (word.load(std::memory_order_acquire) == expected) bucket.changed.wait(lock);
+}
+
+inline void FutexWakeAll(std::atomic<uint32_t>& word)
+{
+    auto& bucket = detail::BucketFor(&word);
+    {
+        std::lock_guard<std::mutex> lock(bucket.mutex);
+    }
+    bucket.changed.notify_all();
+}
+
+#endif
+
+/// Lets threads sleep until a condition they polled may have changed, without a mutex on the
+/// notifying side. A waiter announces itself, re-checks its condition and only then sleeps; a
+/// notifier pays a fence and a load, and a syscall only when somebody is actually asleep.
+class EventCount
+{
+public:
+    using Key = uint32_t;
+
+    /// Announce a wait. Re-check the condition afterwards, then call Wait() or CancelWait().
+    Key PrepareWait()
+    {
+        m_waiters.fetch_add(1, std::memory_order_seq_cst);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        return m_epoch.load(std::memory_order_acquire);
+    }
+
+    void CancelWait() { m_waiters.fetch_sub(1, std::memory_order_relaxed); }
+
+    void Wait(Key key)
+    {
+        while (m_epoch.load(std::memory_order_acquire) == key) FutexWait(m_epoch, key);
+        m_waiters.fetch_sub(1, std::memory_order_relaxed);
+    }
+
+    /// Call after making the condition true.
+    void NotifyAll()
+    {
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (m_waiters.load(std::memory_order_relaxed) == 0) return;
+        m_epoch.fetch_add(1, std::memory_order_release);
+        FutexWakeAll(m_epoch);
+    }
+
+private:
+    std::atomic<uint32_t> m_epoch{0};
+    std::atomic<uint32_t> m_waiters{0};
+};
+
+} // namespace gomarky
@@ -0,0 +1,193 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+#include "concurrent/common.h"
+
+namespace gomarky
+{
+
+namespace detail
+{
+
+/// Producer half of Dmitry Vyukov's bounded queue, shared by the MPMC and MPSC rings.
+///
+/// Every slot carries a sequence number telling whether it is free for the producer claiming
+/// index i (sequence == i) or holds the item for the consumer reading index i (sequence == i + 1).
+/// Producers claim indices with one CAS on the tail.
+template<typename T>
+class SequenceRing
+{
+public:
+    using ValueType = T;
+
+    SequenceRing(const SequenceRing&) = delete;
+    SequenceRing& operator=(const SequenceRing&) = delete;
+
+    /// Any thread. False when the ring is full; the arguments are left untouched in that case.
+    template<typename... Args>
+    bool TryEmplace(Args&&... args)
+    {
+        size_t position = m_tail.load(std::memory_order_relaxed);
+        Cell*  cell;
+        for (;;)
+        {
+            cell                    = &m_cells[position & m_mask];
+            const size_t   sequence = cell->sequence.load(std::memory_order_acquire);
+            const intptr_t diff     = static_cast<intptr_t>(sequence) - static_cast<intptr_t>(position);
+            if (diff == 0)
+            {
+                if (m_tail.compare_exchange_weak(position, position + 1, std::memory_order_relaxed)) break;
+            }
+            else if (diff < 0)
+            {
+                return false; // a consumer has not freed this slot yet
+            }
+            else
+            {
+                position = m_tail.load(std::memory_order_relaxed);
+            }
+        }
+        new (&cell->storage) T(std::forward<Args>(args)...);
+        cell->sequence.store(position + 1, std::memory_order_release);
+        return true;
+    }
+
+    bool TryPush(const T& value) { return TryEmplace(value); }
+    bool TryPush(T&& value) { return TryEmplace(std::move(value)); }
+
+    size_t Capacity() const { return m_mask + 1; }
+
+protected:
+    struct Cell
+    {
+        std::atomic<size_t>                                        sequence;
+        typename std::aligned_storage<sizeof(T), alignof(T)>::type storage;
+    };
+
+    explicit SequenceRing(size_t capacity)
+        : m_mask(RoundUpToPowerOfTwo(capacity, 2) - 1), m_cells(new Cell[m_mask + 1])
+    {
+        for (size_t i = 0; i <= m_mask; ++i) m_cells[i].sequence.store(i, std::memory_order_relaxed);
+    }
+    ~SequenceRing() = default;
+
+    /// Move the item out of a cell a consumer claimed at `position` and hand the slot back.
+    template<typename F>
+    void Release(Cell& cell, size_t position, F&& consume)
+    {
+        T* item = reinterpret_cast<T*>(&cell.storage);
+        consume(*item);
+        item->~T();
+        cell.sequence.store(position + m_mask + 1, std::memory_order_release);
+    }
+
+    const size_t            m_mask;
+    std::unique_ptr<Cell[]> m_cells;
+
+    char                m_pad0[kCacheLineSize];
+    std::atomic<size_t> m_tail{0}; ///< claimed by producers
+    char                m_pad1[kCacheLineSize];
+};
+
+} // namespace detail
+
+/// Bounded multi-producer multi-consumer ring. Consumers claim slots with a CAS on the head, the
+/// mirror image of the producer side. Capacity is rounded up to a power of two.
+template<typename T>
+class MpmcRing : public detail::SequenceRing<T>
+{
+    using Base = detail::SequenceRing<T>;
+
+public:
+    explicit MpmcRing(size_t capacity) : Base(capacity) {}
+
+    ~MpmcRing()
+    {
+        const size_t tail = this->m_tail.load(std::memory_order_relaxed);
+        for (size_t position = m_head.load(std::memory_order_relaxed); position != tail; ++position)
+        {
+            this->Release(this->m_cells[position & this->m_mask], position, [](T&) {});
+        }
+    }
+
+    /// Any thread. False when the ring is empty.
+    bool TryPop(T& out)
+    {
+        size_t               position = m_head.load(std::memory_order_relaxed);
+        typename Base::Cell* cell;
+        for (;;)
+        {
+            cell                    = &this->m_cells[position & this->m_mask];
+            const size_t   sequence = cell->sequence.load(std::memory_order_acquire);
+            const intptr_t diff     = static_cast<intptr_t>(sequence) - static_cast<intptr_t>(position + 1);
+            if (diff == 0)
+            {
+                if (m_head.compare_exchange_weak(position, position + 1, std::memory_order_relaxed)) break;
+            }
+            else if (diff < 0)
+            {
+                return false; // nothing published at this index yet
+            }
+            else
+            {
+                position = m_head.load(std::memory_order_relaxed);
+            }
+        }
+        this->Release(*cell, position, [&out](T& item) { out = std::move(item); });
+        return true;
+    }
+
+private:
+    std::atomic<size_t> m_head{0}; ///< claimed by consumers
+    char                m_pad2[kCacheLineSize];
+};
+
+/// Bounded multi-producer single-consumer ring. The consumer owns the head outright, so it can
+/// hand out whole batches without any read-modify-write.
+template<typename T>
+class MpscRing : public detail::SequenceRing<T>
+{
+    using Base = detail::SequenceRing<T>;
+
+public:
+    explicit MpscRing(size_t capacity) : Base(capacity) {}
+
+    ~MpscRing()
+    {
+        ConsumeBatch([](T&) {});
+    }
+
+    /// Consumer side. Hands up to `max` items to `consume(T&)`, stopping at the first slot that is
+    /// claimed but not yet written so items always come out in index order. `consume` must not throw.
+    template<typename F>
+    size_t ConsumeBatch(F&& consume, size_t max = static_cast<size_t>(-1))
+    {
+        size_t count = 0;
+        for (; count < max; ++count)
+        {
+            auto& cell = this->m_cells[m_head & this->m_mask];
+            if (cell.sequence.load(std::memory_order_acquire) != m_head + 1) break;
+            this->Release(cell, m_head, consume);
+            ++m_head;
+        }
+        return count;
+    }
+
+    bool TryPop(T& out)
+    {
+        return ConsumeBatch([&out](T& item) { out = std::move(item); }, 1) == 1;
+    }
+
+private:
+    size_t m_head = 0; ///< consumer only
+    char   m_pad2[kCacheLineSize];
+};
+
+} // namespace gomarky
@@ -0,0 +1,92 @@
+#pragma once
+
+#include <atomic>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+#include "concurrent/common.h"
+
+namespace gomarky
+{
+
+/// Unbounded multi-producer single-consumer queue after Dmitry Vyukov's intrusive MPSC list.
+///
+/// A push is one allocation, one exchange and one store, with no retry loop however many producers
+/// compete. The price is that the queue is not linearizable: a producer preempted between its
+/// exchange and its store hides everything pushed after it until it resumes, so TryPop can report
+/// empty while later items are already in.
+template<typename T>
+class MpscQueue
+{
+public:
+    using ValueType = T;
+
+    MpscQueue() : m_head(&m_stub), m_tail(&m_stub) {}
+
+    ~MpscQueue()
+    {
+        while (Node* next = m_tail->next.load(std::memory_order_relaxed))
+        {
+            next->Value()->~T();
+            if (m_tail != &m_stub) delete m_tail;
+            m_tail = next;
+        }
+        if (m_tail != &m_stub) delete m_tail;
+    }
+
+    MpscQueue(const MpscQueue&) = delete;
+    MpscQueue& operator=(const MpscQueue&) = delete;
+
+    /// Any thread. Never fails short of running out of memory.
+    template<typename... Args>
+    bool TryEmplace(Args&&... args)
+    {
+        Node* node = new Node;
+        try
+        {
+            new (&node->storage) T(std::forward<Args>(args)...);
+        }
+        catch (...)
+        {
+            delete node;
+            throw;
+        }
+        Node* previous = m_head.exchange(node, std::memory_order_acq_rel);
+        previous->next.store(node, std::memory_order_release);
+        return true;
+    }
+
+    bool TryPush(const T& value) { return TryEmplace(value); }
+    bool TryPush(T&& value) { return TryEmplace(std::move(value)); }
+
+    /// Consumer only. False when empty or when the next item's producer has not finished linking it.
+    bool TryPop(T& out)
+    {
+        Node* next = m_tail->next.load(std::memory_order_acquire);
+        if (!next) return false;
+        T* value = next->Value();
+        out      = std::move(*value);
+        value->~T();
+        // The popped node becomes the new sentinel; the old one is no longer reachable.
+        if (m_tail != &m_stub) delete m_tail;
+        m_tail = next;
+        return true;
+    }
+
+private:
+    struct Node
+    {
+        std::atomic<Node*>                                         next{nullptr};
+        typename std::aligned_storage<sizeof(T), alignof(T)>::type storage;
+
+        T* Value() { return reinterpret_cast<T*>(&storage); }
+    };
+
+    std::atomic<Node*> m_head; ///< last pushed node, swapped by producers
+    char               m_pad0[kCacheLineSize];
+    Node*              m_tail; ///< current sentinel, consumer only
+    Node               m_stub;
+};
+
+} // namespace gomarky
@@ -0,0 +1,108 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+#include "concurrent/common.h"
+
+namespace gomarky
+{
+
+/// Bounded single-producer single-consumer ring.
+///
+/// Each side keeps a private copy of the other side's index and only reloads the shared one when
+/// the ring looks full (producer) or empty (consumer), so in steady state a push or a pop touches
+/// no cache line the other thread writes. Capacity is rounded up to a power of two.
+template<typename T>
+class SpscRing
+{
+public:
+    using ValueType = T;
+
+    explicit SpscRing(size_t capacity)
+        : m_mask(detail::RoundUpToPowerOfTwo(capacity) - 1), m_slots(new Slot[m_mask + 1])
+    {
+    }
+
+    ~SpscRing()
+    {
+        for (size_t i = m_head.load(std::memory_order_relaxed); i != m_tail.load(std::memory_order_relaxed); ++i)
+        {
+            At(i)->~T();
+        }
+    }
+
+    SpscRing(const SpscRing&) = delete;
+    SpscRing& operator=(const SpscRing&) = delete;
+
+    /// Producer side. False when the ring is full.
+    template<typename... Args>
+    bool TryEmplace(Args&&... args)
+    {
+        const size_t tail = m_tail.load(std::memory_order_relaxed);
+        if (tail - m_cached_head > m_mask)
+        {
+            m_cached_head = m_head.load(std::memory_order_acquire);
+            if (tail - m_cached_head > m_mask) return false;
+        }
+        new (At(tail)) T(std::forward<Args>(args)...);
+        m_tail.store(tail + 1, std::memory_order_release);
+        return true;
+    }
+
+    bool TryPush(const T& value) { return TryEmplace(value); }
+    bool TryPush(T&& value) { return TryEmplace(std::move(value)); }
+
+    /// Consumer side. Hands up to `max` items to `consume(T&)` in order, then frees all of their
+    /// slots with a single store. `consume` must not throw.
+    template<typename F>
+    size_t ConsumeBatch(F&& consume, size_t max = static_cast<size_t>(-1))
+    {
+        const size_t head = m_head.load(std::memory_order_relaxed);
+        if (m_cached_tail == head) m_cached_tail = m_tail.load(std::memory_order_acquire);
+        const size_t count = std::min(m_cached_tail - head, max);
+        for (size_t i = 0; i < count; ++i)
+        {
+            T* item = At(head + i);
+            consume(*item);
+            item->~T();
+        }
+        if (count) m_head.store(head + count, std::memory_order_release);
+        return count;
+    }
+
+    bool TryPop(T& out)
+    {
+        return ConsumeBatch([&out](T& item) { out = std::move(item); }, 1) == 1;
+    }
+
+    /// Exact only on the consumer thread while the producer is idle.
+    size_t SizeApprox() const
+    {
+        return m_tail.load(std::memory_order_acquire) - m_head.load(std::memory_order_acquire);
+    }
+    size_t Capacity() const { return m_mask + 1; }
+
+private:
+    using Slot = typename std::aligned_storage<sizeof(T), alignof(T)>::type;
+
+    T* At(size_t index) { return reinterpret_cast<T*>(&m_slots[index & m_mask]); }
+
+    const size_t            m_mask;
+    std::unique_ptr<Slot[]> m_slots;
+
+    char                m_pad0[kCacheLineSize];
+    std::atomic<size_t> m_head{0};        ///< written by the consumer
+    size_t              m_cached_tail = 0; ///< consumer's last view of m_tail
+    char                m_pad1[kCacheLineSize];
+    std::atomic<size_t> m_tail{0};        ///< written by the producer
+    size_t              m_cached_head = 0; ///< producer's last view of m_head
+    char                m_pad2[kCacheLineSize];
+};
+
+} // namespace gomarky
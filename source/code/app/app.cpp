@@ -4,6 +4,14 @@
 
 #include "QtWidgets"
 
+#include <spdlog/spdlog.h>
+
+#include "concurrency/instrumented_mutex.h"
+#include "layout/layout_host.h"
+#include "metrics/metrics_registry.h"
+#include "text/font_prewarm.h"
+#include "text/glyph_atlas_label.h"
+
 class MainApplication : public QObject
 {
 public:
@@ -11,18 +19,72 @@ public:
     int Run(int argc, char** argv);
 };
 
+namespace
+{
+
+// Quits the application once the watched widget was painted, for startup measurements.
+class FirstPaintQuitter : public QObject
+{
+public:
+    using QObject::QObject;
+
+    bool eventFilter(QObject* watched, QEvent* event) override
+    {
+        if (event->type() == QEvent::Paint) QTimer::singleShot(0, qApp, &QCoreApplication::quit);
+        return QObject::eventFilter(watched, event);
+    }
+};
+
+} // namespace
+
 MainApplication::MainApplication() {}
 
 int MainApplication::Run(int argc, char** argv) {
     QApplication app(argc, argv);
+    const QStringList arguments = app.arguments();
+
+    // --prewarm-fonts: resolve the UI font and load its glyph atlas while the widgets are built.
+    gomarky::FontPrewarm font_prewarm;
+    if (arguments.contains(QStringLiteral("--prewarm-fonts")))
+    {
+        font_prewarm.Start({app.font()}, gomarky::FontPrewarm::DefaultCharacters());
+    }
+
+    QWidget window;
+    auto*   horizontal_layout = new gomarky::LayoutHost(&window, gomarky::LayoutTree::Kind::Row);
+
+    auto* welcome_label = new gomarky::GlyphAtlasLabel("Hello my litta GoMarky. For you its just a beginning");
+
+    welcome_label->setMargin(20);
+
+    horizontal_layout->AddWidget(gomarky::LayoutTree::kRoot, welcome_label, gomarky::LayoutTree::Slot{1, 0, 0});
+
+    // Attached once loaded rather than waited for here; the label paints like a QLabel until then.
+    if (font_prewarm.IsStarted())
+    {
+        font_prewarm.WhenReady(welcome_label, [&font_prewarm, welcome_label] {
+            welcome_label->SetAtlas(font_prewarm.Atlas(welcome_label->font()));
+        });
+    }
+
+    FirstPaintQuitter first_paint_quitter;
+    if (arguments.contains(QStringLiteral("--quit-after-first-paint")))
+    {
+        welcome_label->installEventFilter(&first_paint_quitter);
+    }
 
-    QLabel welcome_label("Hello my litta GoMarky. For you its just a beginning");
+    window.resize(horizontal_layout->SizeHint());
+    window.show();
 
-    welcome_label.setMargin(20);
+    const int exit_code = app.exec();
 
-    QHBoxLayout horizontal_layout;
+    // Locks that made threads wait, worst first. Nothing is logged when no lock was contended.
+    const std::string contention = gomarky::LockProfiler::Format();
+    if (!contention.empty()) spdlog::info("Most contended locks:\n{}", contention);
 
-    welcome_label.show();
+    // Every metric of the run, lock statistics included, for debug logs.
+    gomarky::LockProfiler::Publish(gomarky::MetricsRegistry::Global());
+    spdlog::debug("Metrics:\n{}", gomarky::MetricsRegistry::Global().Format());
 
-    return app.exec();
+    return exit_code;
 }
@@ -0,0 +1,196 @@
+#include "assets/asset_service.h"
+
+#include <QCoreApplication>
+#include <QImageReader>
+#include <QLabel>
+#include <QPainter>
+#include <QPointer>
+
+#include <memory>
+
+#include "concurrency/worker_pool.h"
+#include "image/qimage_kernels.h"
+
+namespace gomarky
+{
+
+namespace
+{
+
+// Prefetches are posted to the same FIFO pool as explicit requests, so only a couple are allowed
+// in flight; a request made later can then never queue behind a long prefetch list.
+constexpr int kMaxPrefetchRunning = 2;
+
+const QSize kDefaultPlaceholderSize(32, 32);
+
+const char* const kBoundKeyProperty = "gomarkyAssetKey";
+
+size_t PixmapBytes(const QPixmap& pixmap)
+{
+    return static_cast<size_t>(pixmap.width()) * static_cast<size_t>(pixmap.height()) *
+           static_cast<size_t>(pixmap.depth()) / 8;
+}
+
+QImage DecodeImage(const QString& path, const QSize& size, WorkerPool& pool)
+{
+    QImageReader reader(path);
+    reader.setAutoTransform(true);
+    // Formats like JPEG can decode straight to a smaller size, which is much cheaper than scaling.
+    if (size.isValid()) reader.setScaledSize(size);
+
+    QImage image = reader.read();
+    if (image.isNull()) return image;
+
+    // Convert here so QPixmap::fromImage on the GUI thread does not have to.
+    image = image.convertToFormat(image.hasAlphaChannel() ? QImage::Format_ARGB32_Premultiplied
+                                                          : QImage::Format_RGB32);
+    if (size.isValid() && image.size() != size) image = ScaleImage(image, size, ResizeFilter::Triangle, pool);
+    return image;
+}
+
+} // namespace
+
+AssetService::AssetService(QObject* parent) : AssetService(WorkerPool::Global(), kDefaultBudget, parent) {}
+
+AssetService::AssetService(WorkerPool& pool, size_t budget_bytes, QObject* parent)
+    : QObject(parent), m_pool(pool), m_cache(budget_bytes)
+{
+}
+
+QString AssetService::Key(const QString& path, const QSize& size)
+{
+    if (!size.isValid()) return path;
+    return QStringLiteral("%1@%2x%3").arg(path).arg(size.width()).arg(size.height());
+}
+
+QPixmap AssetService::Pixmap(const QString& path, const QSize& size)
+{
+    const QString key = Key(path, size);
+    if (QPixmap* cached = m_cache.Find(key)) return *cached;
+
+    if (!m_failed.contains(key) && !m_uncacheable.contains(key) && !m_in_flight.contains(key))
+    {
+        // Assets still waiting in the prefetch queue are now wanted right away.
+        for (auto queued = m_prefetch_queue.begin(); queued != m_prefetch_queue.end(); ++queued)
+        {
+            if (queued->key == key)
+            {
+                m_prefetch_queue.erase(queued);
+                break;
+            }
+        }
+        Decode({key, path, size}, false);
+    }
+    return Placeholder(size.isValid() ? size : kDefaultPlaceholderSize);
+}
+
+bool AssetService::IsReady(const QString& path, const QSize& size) const
+{
+    return m_cache.Contains(Key(path, size));
+}
+
+void AssetService::Prefetch(const QStringList& paths, const QSize& size)
+{
+    for (const QString& path : paths)
+    {
+        const QString key = Key(path, size);
+        if (m_cache.Contains(key) || m_in_flight.contains(key) || m_failed.contains(key) ||
+            m_uncacheable.contains(key))
+        {
+            continue;
+        }
+        m_prefetch_queue.push_back({key, path, size});
+    }
+    PumpPrefetch();
+}
+
+void AssetService::Bind(QLabel* label, const QString& path, const QSize& size)
+{
+    const QString key = Key(path, size);
+    label->setProperty(kBoundKeyProperty, key);
+    label->setPixmap(Pixmap(path, size));
+    if (m_cache.Contains(key) || m_failed.contains(key)) return;
+    // Assets too large to cache are decoded again for every label they are bound to.
+    if (m_uncacheable.contains(key) && !m_in_flight.contains(key)) Decode({key, path, size}, false);
+
+    // One-shot connection, dropped with the label or once the asset arrived. Rebinding the label
+    // to another asset in the meantime makes this one a no-op.
+    auto connection = std::make_shared<QMetaObject::Connection>();
+    *connection     = connect(this, &AssetService::AssetFinished, label,
+                          [label, key, connection](const QString& ready_path, const QSize& ready_size, bool ok,
+                                                   const QPixmap& pixmap) {
+                              if (Key(ready_path, ready_size) != key) return;
+                              disconnect(*connection);
+                              if (ok && label->property(kBoundKeyProperty).toString() == key)
+                              {
+                                  label->setPixmap(pixmap);
+                              }
+                          });
+}
+
+void AssetService::Decode(const Request& request, bool prefetch)
+{
+    m_in_flight.insert(request.key);
+    if (prefetch) ++m_prefetch_running;
+
+    QPointer<AssetService> guard(this);
+    WorkerPool&            pool = m_pool;
+    m_pool.Post([guard, request, prefetch, &pool] {
+        QImage image = DecodeImage(request.path, request.size, pool);
+        QMetaObject::invokeMethod(QCoreApplication::instance(),
+                                  [guard, request, image, prefetch] {
+                                      if (guard) guard->Deliver(request, image, prefetch);
+                                  },
+                                  Qt::QueuedConnection);
+    });
+}
+
+void AssetService::Deliver(const Request& request, const QImage& image, bool prefetch)
+{
+    m_in_flight.remove(request.key);
+    if (prefetch) --m_prefetch_running;
+
+    const bool ok = !image.isNull();
+    QPixmap    pixmap;
+    if (ok)
+    {
+        pixmap = QPixmap::fromImage(image);
+        // Larger than the whole budget: the waiters get it below, but it is not decoded again
+        // for every Pixmap() call that misses the cache.
+        if (!m_cache.Insert(request.key, pixmap, PixmapBytes(pixmap))) m_uncacheable.insert(request.key);
+    }
+    else
+    {
+        m_failed.insert(request.key);
+    }
+    emit AssetFinished(request.path, request.size, ok, pixmap);
+    PumpPrefetch();
+}
+
+void AssetService::PumpPrefetch()
+{
+    while (m_prefetch_running < kMaxPrefetchRunning && !m_prefetch_queue.empty())
+    {
+        Request request = std::move(m_prefetch_queue.front());
+        m_prefetch_queue.pop_front();
+        if (m_cache.Contains(request.key) || m_in_flight.contains(request.key)) continue;
+        Decode(request, true);
+    }
+}
+
+QPixmap AssetService::Placeholder(const QSize& size)
+{
+    const quint64 key = (quint64(quint32(size.width())) << 32) | quint32(size.height());
+    auto          it  = m_placeholders.find(key);
+    if (it != m_placeholders.end()) return *it;
+
+    QPixmap placeholder(size);
+    placeholder.fill(QColor(128, 128, 128, 40));
+    QPainter painter(&placeholder);
+    painter.setPen(QColor(128, 128, 128, 90));
+    painter.drawRect(placeholder.rect().adjusted(0, 0, -1, -1));
+    painter.end();
+    return *m_placeholders.insert(key, placeholder);
+}
+
+} // namespace gomarky
@@ -0,0 +1,99 @@
+#pragma once
+
+#include <cstddef>
+#include <deque>
+
+#include <QHash>
+#include <QObject>
+#include <QPixmap>
+#include <QSet>
+#include <QSize>
+#include <QString>
+#include <QStringList>
+
+#include "assets/byte_lru_cache.h"
+
+class QLabel;
+
+namespace gomarky
+{
+
+class WorkerPool;
+
+/// Loads images without blocking the GUI thread.
+///
+/// Files are decoded (and scaled, when a size is given) on a WorkerPool. The GUI thread only
+/// turns the finished QImage into a QPixmap, which goes into an LRU cache bounded by bytes.
+/// Until then callers get a placeholder of the requested size, so layouts do not jump.
+/// Prefetched assets are decoded a few at a time behind explicit requests.
+/// All methods must be called on the GUI thread.
+class AssetService : public QObject
+{
+    Q_OBJECT
+
+public:
+    static constexpr size_t kDefaultBudget = size_t(64) << 20;
+
+    explicit AssetService(QObject* parent = nullptr);
+    AssetService(WorkerPool& pool, size_t budget_bytes, QObject* parent = nullptr);
+
+    /// The decoded asset, or a placeholder while it is being decoded (or could not be, or is too
+    /// large for the budget).
+    /// An invalid `size` keeps the image's own size.
+    QPixmap Pixmap(const QString& path, const QSize& size = QSize());
+
+    bool IsReady(const QString& path, const QSize& size = QSize()) const;
+
+    /// Decode assets a view is likely to need soon. They do not delay explicit requests.
+    void Prefetch(const QStringList& paths, const QSize& size = QSize());
+
+    /// Show the asset in `label`: the placeholder now, the real pixmap once it is decoded.
+    void Bind(QLabel* label, const QString& path, const QSize& size = QSize());
+
+    void SetBudget(size_t budget_bytes)
+    {
+        m_cache.SetBudget(budget_bytes);
+        m_uncacheable.clear();
+    }
+    size_t UsedBytes() const { return m_cache.UsedBytes(); }
+
+    /// Decodes requested or queued but not delivered yet.
+    int PendingCount() const { return m_in_flight.size() + static_cast<int>(m_prefetch_queue.size()); }
+
+signals:
+    /// Emitted when a decode finished; `ok` is false when the file could not be read. An asset
+    /// larger than the whole budget is not cached, so `pixmap` is the only way to get it: Pixmap()
+    /// keeps returning the placeholder, and only Bind() decodes it again.
+    void AssetFinished(const QString& path, const QSize& size, bool ok, const QPixmap& pixmap);
+
+private:
+    struct QStringHash
+    {
+        size_t operator()(const QString& key) const { return qHash(key); }
+    };
+
+    struct Request
+    {
+        QString key;
+        QString path;
+        QSize   size;
+    };
+
+    static QString Key(const QString& path, const QSize& size);
+
+    void    Decode(const Request& request, bool prefetch);
+    void    Deliver(const Request& request, const QImage& image, bool prefetch);
+    void    PumpPrefetch();
+    QPixmap Placeholder(const QSize& size);
+
+    WorkerPool&                                 m_pool;
+    ByteLruCache<QString, QPixmap, QStringHash> m_cache;
+    QSet<QString>                               m_in_flight;
+    std::deque<Request>                         m_prefetch_queue;
+    int                                         m_prefetch_running = 0;
+    QSet<QString>                               m_failed;
+    QSet<QString>                               m_uncacheable;  ///< decoded fine but over the budget
+    QHash<quint64, QPixmap>                     m_placeholders; ///< by packed width and height
+};
+
+} // namespace gomarky
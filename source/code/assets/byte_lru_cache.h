@@ -0,0 +1,123 @@
+#pragma once
+
+#include <cstddef>
+#include <functional>
+#include <list>
+#include <unordered_map>
+#include <utility>
+
+namespace gomarky
+{
+
+/// LRU cache bounded by the total cost of its entries (typically bytes) instead of their count.
+/// Not thread-safe; owners that share it across threads must lock around it.
+template<typename Key, typename Value, typename Hash = std::hash<Key>>
+class ByteLruCache
+{
+public:
+    explicit ByteLruCache(size_t budget) : m_budget(budget) {}
+
+    /// Insert or replace `key`, then evict least recently used entries until the total fits.
+    /// Entries costing more than the whole budget are not stored and false is returned.
+    bool Insert(const Key& key, Value value, size_t cost)
+    {
+        Remove(key);
+        if (cost > m_budget) return false;
+
+        m_entries.emplace_front(Entry{key, std::move(value), cost});
+        m_index.emplace(key, m_entries.begin());
+        m_used += cost;
+        EvictTo(m_budget);
+        return true;
+    }
+
+    /// The cached value, marked as most recently used, or nullptr.
+    /// The pointer stays valid until the entry is evicted or replaced.
+    Value* Find(const Key& key)
+    {
+        auto it = m_index.find(key);
+        if (it == m_index.end()) return nullptr;
+        m_entries.splice(m_entries.begin(), m_entries, it->second);
+        return &it->second->value;
+    }
+
+    bool Contains(const Key& key) const { return m_index.count(key) != 0; }
+
+    bool Remove(const Key& key)
+    {
+        auto it = m_index.find(key);
+        if (it == m_index.end()) return false;
+        m_used -= it->second->cost;
+        m_entries.erase(it->second);
+        m_index.erase(it);
+        return true;
+    }
+
+    /// Remove every entry for which `predicate(key, value)` holds. Returns how many went.
+    template<typename Predicate>
+    size_t RemoveIf(Predicate predicate)
+    {
+        size_t removed = 0;
+        for (auto it = m_entries.begin(); it != m_entries.end();)
+        {
+            if (!predicate(static_cast<const Key&>(it->key), static_cast<const Value&>(it->value)))
+            {
+                ++it;
+                continue;
+            }
+            m_used -= it->cost;
+            m_index.erase(it->key);
+            it = m_entries.erase(it);
+            ++removed;
+        }
+        return removed;
+    }
+
+    void Clear()
+    {
+        m_entries.clear();
+        m_index.clear();
+        m_used = 0;
+    }
+
+    void SetBudget(size_t budget)
+    {
+        m_budget = budget;
+        EvictTo(m_budget);
+    }
+
+    size_t Budget() const { return m_budget; }
+    size_t UsedBytes() const { return m_used; }
+    size_t Size() const { return m_index.size(); }
+    /// Entries pushed out to make room since construction.
+    size_t Evictions() const { return m_evictions; }
+
+private:
+    struct Entry
+    {
+        Key    key;
+        Value  value;
+        size_t cost;
+    };
+    using Iterator = typename std::list<Entry>::iterator;
+
+    void EvictTo(size_t budget)
+    {
+        while (m_used > budget)
+        {
+            Entry& oldest = m_entries.back();
+            m_used -= oldest.cost;
+            m_index.erase(oldest.key);
+            m_entries.pop_back();
+            ++m_evictions;
+        }
+    }
+
+    std::list<Entry>                         m_entries; // most recently used first
+    std::unordered_map<Key, Iterator, Hash> m_index;
+    size_t                                   m_budget;
+    size_t                                   m_used      = 0;
+    size_t                                   m_evictions = 0;
+};
+
+} // namespace gomarky
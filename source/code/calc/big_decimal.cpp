@@ -0,0 +1,202 @@
+#include "calc/big_decimal.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+#include <utility>
+
+namespace gomarky
+{
+
+namespace
+{
+
+BigInteger Pow10(int64_t exponent)
+{
+    if (exponent < 0 || exponent > std::numeric_limits<uint32_t>::max())
+    {
+        throw std::overflow_error("decimal exponent out of range");
+    }
+    return BigInteger::Pow10(static_cast<uint32_t>(exponent));
+}
+
+/// Unscaled values of `a` and `b` at their common (larger) scale.
+void Align(const BigDecimal& a, const BigDecimal& b, BigInteger& ua, BigInteger& ub, int32_t& scale)
+{
+    scale = std::max(a.Scale(), b.Scale());
+    ua    = a.Scale() == scale ? a.Unscaled() : a.Unscaled() * Pow10(int64_t(scale) - a.Scale());
+    ub    = b.Scale() == scale ? b.Unscaled() : b.Unscaled() * Pow10(int64_t(scale) - b.Scale());
+}
+
+/// numerator / denominator rounded half away from zero.
+BigInteger DivideRounded(const BigInteger& numerator, const BigInteger& denominator)
+{
+    BigInteger quotient;
+    BigInteger remainder;
+    BigInteger::DivMod(numerator, denominator, quotient, remainder);
+    if (!remainder.IsZero() && (remainder.Abs() << 1) >= denominator.Abs())
+    {
+        quotient += numerator.Sign() == denominator.Sign() ? 1 : -1;
+    }
+    return quotient;
+}
+
+int32_t CheckedScale(int64_t scale)
+{
+    if (scale < std::numeric_limits<int32_t>::min() || scale > std::numeric_limits<int32_t>::max())
+    {
+        throw std::overflow_error("decimal scale out of range");
+    }
+    return static_cast<int32_t>(scale);
+}
+
+} // namespace
+
+BigDecimal BigDecimal::FromString(const std::string& text)
+{
+    size_t     i        = 0;
+    const bool negative = i < text.size() && text[i] == '-';
+    if (i < text.size() && (text[i] == '-' || text[i] == '+')) ++i;
+
+    std::string digits;
+    int64_t     scale = 0;
+    bool        point = false;
+    for (; i < text.size(); ++i)
+    {
+        const char c = text[i];
+        if (c >= '0' && c <= '9')
+        {
+            digits += c;
+            if (point) ++scale;
+        }
+        else if (c == '.' && !point) point = true;
+        else break;
+    }
+    if (digits.empty()) throw std::invalid_argument("not a decimal number: '" + text + "'");
+
+    if (i < text.size() && (text[i] == 'e' || text[i] == 'E'))
+    {
+        ++i;
+        const bool exponent_negative = i < text.size() && text[i] == '-';
+        if (i < text.size() && (text[i] == '-' || text[i] == '+')) ++i;
+        if (i == text.size()) throw std::invalid_argument("missing exponent in '" + text + "'");
+        int64_t exponent = 0;
+        for (; i < text.size() && text[i] >= '0' && text[i] <= '9'; ++i)
+        {
+            exponent = exponent * 10 + (text[i] - '0');
+            if (exponent > std::numeric_limits<int32_t>::max()) throw std::overflow_error("exponent out of range");
+        }
+        scale -= exponent_negative ? -exponent : exponent;
+    }
+    if (i != text.size()) throw std::invalid_argument("not a decimal number: '" + text + "'");
+
+    const BigInteger unscaled = BigInteger::FromString(digits);
+    return BigDecimal(negative ? -unscaled : unscaled, CheckedScale(scale));
+}
+
+std::string BigDecimal::ToString() const
+{
+    if (m_scale <= 0) return (m_unscaled * Pow10(-int64_t(m_scale))).ToString();
+
+    std::string  digits = m_unscaled.Abs().ToString();
+    const size_t scale  = static_cast<size_t>(m_scale);
+    if (digits.size() <= scale) digits.insert(0, scale + 1 - digits.size(), '0');
+    digits.insert(digits.size() - scale, 1, '.');
+    return m_unscaled.IsNegative() ? "-" + digits : digits;
+}
+
+double BigDecimal::ToDouble() const { return m_unscaled.ToDouble() * std::pow(10.0, -double(m_scale)); }
+
+bool BigDecimal::IsInteger() const { return m_scale <= 0 || (m_unscaled % Pow10(m_scale)).IsZero(); }
+
+BigDecimal BigDecimal::Rescale(int32_t scale) const
+{
+    if (scale >= m_scale) return BigDecimal(m_unscaled * Pow10(int64_t(scale) - m_scale), scale);
+    return BigDecimal(DivideRounded(m_unscaled, Pow10(int64_t(m_scale) - scale)), scale);
+}
+
+BigDecimal BigDecimal::Normalized() const
+{
+    if (m_scale < 0) return Rescale(0);
+    if (m_unscaled.IsZero()) return BigDecimal();
+
+    BigInteger unscaled = m_unscaled;
+    int32_t    scale    = m_scale;
+    BigInteger quotient;
+    BigInteger remainder;
+    while (scale > 0)
+    {
+        BigInteger::DivMod(unscaled, 10, quotient, remainder);
+        if (!remainder.IsZero()) break;
+        unscaled = std::move(quotient);
+        --scale;
+    }
+    return BigDecimal(std::move(unscaled), scale);
+}
+
+BigInteger BigDecimal::Truncated() const
+{
+    return m_scale <= 0 ? m_unscaled * Pow10(-int64_t(m_scale)) : m_unscaled / Pow10(m_scale);
+}
+
+BigDecimal BigDecimal::Divide(const BigDecimal& a, const BigDecimal& b, size_t digits)
+{
+    if (b.IsZero()) throw std::domain_error("division by zero");
+
+    // a / b * 10^digits = (ua / ub) * 10^(digits + sb - sa)
+    const int64_t exponent    = int64_t(digits) + b.m_scale - a.m_scale;
+    BigInteger    numerator   = exponent >= 0 ? a.m_unscaled * Pow10(exponent) : a.m_unscaled;
+    BigInteger    denominator = exponent >= 0 ? b.m_unscaled : b.m_unscaled * Pow10(-exponent);
+    return BigDecimal(DivideRounded(numerator, denominator), CheckedScale(int64_t(digits)));
+}
+
+BigDecimal BigDecimal::Sqrt(const BigDecimal& value, size_t digits)
+{
+    if (value.Sign() < 0) throw std::domain_error("square root of a negative number");
+
+    // floor(sqrt(u * 10^-s) * 10^(digits + 1)), then round the extra digit away.
+    const int64_t exponent = 2 * (int64_t(digits) + 1) - value.m_scale;
+    BigInteger    radicand = exponent >= 0 ? value.m_unscaled * Pow10(exponent) : value.m_unscaled / Pow10(-exponent);
+    BigInteger    root     = BigInteger::Sqrt(radicand);
+    BigInteger    quotient;
+    BigInteger    last;
+    BigInteger::DivMod(root, 10, quotient, last);
+    if (last >= 5) quotient += 1;
+    return BigDecimal(std::move(quotient), CheckedScale(int64_t(digits)));
+}
+
+BigDecimal operator+(const BigDecimal& a, const BigDecimal& b)
+{
+    BigInteger ua;
+    BigInteger ub;
+    int32_t    scale;
+    Align(a, b, ua, ub, scale);
+    return BigDecimal(ua + ub, scale);
+}
+
+BigDecimal operator-(const BigDecimal& a, const BigDecimal& b)
+{
+    BigInteger ua;
+    BigInteger ub;
+    int32_t    scale;
+    Align(a, b, ua, ub, scale);
+    return BigDecimal(ua - ub, scale);
+}
+
+BigDecimal operator*(const BigDecimal& a, const BigDecimal& b)
+{
+    return BigDecimal(a.m_unscaled * b.m_unscaled, CheckedScale(int64_t(a.m_scale) + b.m_scale));
+}
+
+int BigDecimal::Compare(const BigDecimal& a, const BigDecimal& b)
+{
+    if (a.Sign() != b.Sign()) return a.Sign() < b.Sign() ? -1 : 1;
+    BigInteger ua;
+    BigInteger ub;
+    int32_t    scale;
+    Align(a, b, ua, ub, scale);
+    return BigInteger::Compare(ua, ub);
+}
+
+} // namespace gomarky
@@ -0,0 +1,70 @@
+#pragma once
+
+#include "calc/big_integer.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <utility>
+
+namespace gomarky
+{
+
+/// Exact decimal number: Unscaled() * 10^-Scale().
+///
+/// Addition, subtraction and multiplication are exact. Operations that cannot be, like division
+/// and square roots, take the number of fractional digits to keep and round half away from zero.
+class BigDecimal
+{
+public:
+    BigDecimal() = default;
+    BigDecimal(int64_t value) : m_unscaled(value) {}
+    BigDecimal(BigInteger unscaled, int32_t scale) : m_unscaled(std::move(unscaled)), m_scale(scale) {}
+
+    /// Decimal literal such as "-12.50" or "1.5e-3". Throws std::invalid_argument.
+    static BigDecimal FromString(const std::string& text);
+    /// Plain notation with exactly Scale() fractional digits (none for negative scales).
+    std::string ToString() const;
+
+    const BigInteger& Unscaled() const { return m_unscaled; }
+    int32_t           Scale() const { return m_scale; }
+    bool              IsZero() const { return m_unscaled.IsZero(); }
+    int               Sign() const { return m_unscaled.Sign(); }
+    double            ToDouble() const;
+    /// True when there is no fractional part.
+    bool IsInteger() const;
+
+    /// Same value with `scale` fractional digits, rounding when digits are dropped.
+    BigDecimal Rescale(int32_t scale) const;
+    /// Smallest non-negative scale that represents the same value, so 1.500 becomes 1.5.
+    BigDecimal Normalized() const;
+    /// Integer part, truncated toward zero.
+    BigInteger Truncated() const;
+
+    /// Throws std::domain_error when `b` is zero.
+    static BigDecimal Divide(const BigDecimal& a, const BigDecimal& b, size_t digits);
+    /// Throws std::domain_error for negative values.
+    static BigDecimal Sqrt(const BigDecimal& value, size_t digits);
+
+    BigDecimal operator-() const { return BigDecimal(-m_unscaled, m_scale); }
+    BigDecimal Abs() const { return BigDecimal(m_unscaled.Abs(), m_scale); }
+
+    friend BigDecimal operator+(const BigDecimal& a, const BigDecimal& b);
+    friend BigDecimal operator-(const BigDecimal& a, const BigDecimal& b);
+    friend BigDecimal operator*(const BigDecimal& a, const BigDecimal& b);
+
+    static int Compare(const BigDecimal& a, const BigDecimal& b);
+
+    friend bool operator==(const BigDecimal& a, const BigDecimal& b) { return Compare(a, b) == 0; }
+    friend bool operator!=(const BigDecimal& a, const BigDecimal& b) { return Compare(a, b) != 0; }
+    friend bool operator<(const BigDecimal& a, const BigDecimal& b) { return Compare(a, b) < 0; }
+    friend bool operator<=(const BigDecimal& a, const BigDecimal& b) { return Compare(a, b) <= 0; }
+    friend bool operator>(const BigDecimal& a, const BigDecimal& b) { return Compare(a, b) > 0; }
+    friend bool operator>=(const BigDecimal& a, const BigDecimal& b) { return Compare(a, b) >= 0; }
+
+private:
+    BigInteger m_unscaled;
+    int32_t    m_scale = 0;
+};
+
+} // namespace gomarky
@@ -0,0 +1,873 @@
+#include "calc/big_integer.h"
+
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+#include <utility>
+
+namespace gomarky
+{
+
+namespace
+{
+
+using Limb  = BigInteger::Limb;
+using LimbVector = std::vector<Limb>;
+
+// Crossover points in limbs of the smaller operand, measured with big_integer_bench.
+constexpr size_t kKaratsubaThreshold = 40;
+constexpr size_t kNttThreshold       = 4000;
+// Divisions whose divisor and quotient both exceed this go through the Newton reciprocal.
+constexpr size_t kNewtonThreshold = 96;
+// Reciprocals of at most this many bits are computed directly by long division.
+constexpr size_t kNewtonBaseBits = 2048;
+// Extra bits carried through each Newton step so truncation errors stay in the last few units.
+constexpr size_t kGuardBits = 32;
+// Numbers of up to this many limbs convert to and from decimal digit by digit.
+constexpr size_t kConversionBaseLimbs = 48;
+
+constexpr uint32_t kChunk       = 1000000000; // 10^9, the largest power of ten in a limb
+constexpr size_t   kChunkDigits = 9;
+
+int CountLeadingZeros(Limb value)
+{
+#if defined(__GNUC__)
+    return __builtin_clz(value);
+#else
+    int count = 0;
+    for (Limb bit = 0x80000000u; !(value & bit); bit >>= 1) ++count;
+    return count;
+#endif
+}
+
+void Trim(LimbVector& a)
+{
+    while (!a.empty() && a.back() == 0) a.pop_back();
+}
+
+size_t TrimmedSize(const Limb* a, size_t size)
+{
+    while (size > 0 && a[size - 1] == 0) --size;
+    return size;
+}
+
+int CompareMagnitude(const LimbVector& a, const LimbVector& b)
+{
+    if (a.size() != b.size()) return a.size() < b.size() ? -1 : 1;
+    for (size_t i = a.size(); i-- > 0;)
+    {
+        if (a[i] != b[i]) return a[i] < b[i] ? -1 : 1;
+    }
+    return 0;
+}
+
+LimbVector AddMagnitude(const Limb* a, size_t na, const Limb* b, size_t nb)
+{
+    if (na < nb)
+    {
+        std::swap(a, b);
+        std::swap(na, nb);
+    }
+    LimbVector result(na + 1);
+    uint64_t   carry = 0;
+    for (size_t i = 0; i < na; ++i)
+    {
+        carry += uint64_t(a[i]) + (i < nb ? b[i] : 0);
+        result[i] = static_cast<Limb>(carry);
+        carry >>= 32;
+    }
+    result[na] = static_cast<Limb>(carry);
+    Trim(result);
+    return result;
+}
+
+/// a -= b, requires a >= b.
+void SubtractInPlace(LimbVector& a, const Limb* b, size_t nb)
+{
+    int64_t borrow = 0;
+    for (size_t i = 0; i < a.size() && (i < nb || borrow); ++i)
+    {
+        int64_t t = int64_t(a[i]) - borrow - (i < nb ? int64_t(b[i]) : 0);
+        borrow    = t < 0;
+        a[i]      = static_cast<Limb>(t + (borrow << 32));
+    }
+    Trim(a);
+}
+
+/// acc += b << (32 * offset), growing acc as needed.
+void AddAt(LimbVector& acc, const LimbVector& b, size_t offset)
+{
+    if (acc.size() < offset + b.size() + 1) acc.resize(offset + b.size() + 1, 0);
+    uint64_t carry = 0;
+    size_t   i     = 0;
+    for (; i < b.size(); ++i)
+    {
+        carry += uint64_t(acc[offset + i]) + b[i];
+        acc[offset + i] = static_cast<Limb>(carry);
+        carry >>= 32;
+    }
+    for (size_t j = offset + i; carry; ++j)
+    {
+        if (j == acc.size()) acc.push_back(0);
+        carry += acc[j];
+        acc[j] = static_cast<Limb>(carry);
+        carry >>= 32;
+    }
+}
+
+/// a = a * factor + addend
+void MulAddSmall(LimbVector& a, uint32_t factor, uint32_t addend)
+{
+    uint64_t carry = addend;
+    for (Limb& limb : a)
+    {
+        carry += uint64_t(limb) * factor;
+        limb = static_cast<Limb>(carry);
+        carry >>= 32;
+    }
+    if (carry) a.push_back(static_cast<Limb>(carry));
+}
+
+/// a /= divisor, returns the remainder.
+uint32_t DivSmall(LimbVector& a, uint32_t divisor)
+{
+    uint64_t remainder = 0;
+    for (size_t i = a.size(); i-- > 0;)
+    {
+        const uint64_t current = (remainder << 32) | a[i];
+        a[i]                   = static_cast<Limb>(current / divisor);
+        remainder              = current % divisor;
+    }
+    Trim(a);
+    return static_cast<uint32_t>(remainder);
+}
+
+LimbVector MulSchoolbook(const Limb* a, size_t na, const Limb* b, size_t nb)
+{
+    LimbVector result(na + nb, 0);
+    for (size_t i = 0; i < na; ++i)
+    {
+        uint64_t       carry = 0;
+        const uint64_t ai    = a[i];
+        if (ai == 0) continue;
+        for (size_t j = 0; j < nb; ++j)
+        {
+            carry += ai * b[j] + result[i + j];
+            result[i + j] = static_cast<Limb>(carry);
+            carry >>= 32;
+        }
+        result[i + nb] = static_cast<Limb>(carry);
+    }
+    Trim(result);
+    return result;
+}
+
+LimbVector MulKaratsuba(const Limb* a, size_t na, const Limb* b, size_t nb)
+{
+    na = TrimmedSize(a, na);
+    nb = TrimmedSize(b, nb);
+    if (na < nb)
+    {
+        std::swap(a, b);
+        std::swap(na, nb);
+    }
+    if (nb == 0) return LimbVector();
+    if (nb < kKaratsubaThreshold) return MulSchoolbook(a, na, b, nb);
+
+    // Very unbalanced operands: multiply b by slices of a its own size.
+    if (na >= 2 * nb)
+    {
+        LimbVector result;
+        for (size_t offset = 0; offset < na; offset += nb)
+        {
+            AddAt(result, MulKaratsuba(a + offset, std::min(nb, na - offset), b, nb), offset);
+        }
+        Trim(result);
+        return result;
+    }
+
+    // a = a1 * B^h + a0, b = b1 * B^h + b0. With na < 2 * nb, h <= nb and b1 may be empty.
+    const size_t h  = (na + 1) / 2;
+    const Limb*  a0 = a;
+    const Limb*  a1 = a + h;
+    const Limb*  b0 = b;
+    const Limb*  b1 = b + h;
+    const size_t n1 = na - h;
+    const size_t m1 = nb - h;
+
+    LimbVector z0 = MulKaratsuba(a0, h, b0, h);
+    LimbVector z2 = MulKaratsuba(a1, n1, b1, m1);
+
+    const LimbVector sa = AddMagnitude(a0, TrimmedSize(a0, h), a1, n1);
+    const LimbVector sb = AddMagnitude(b0, TrimmedSize(b0, h), b1, m1);
+    LimbVector       z1 = MulKaratsuba(sa.data(), sa.size(), sb.data(), sb.size());
+    SubtractInPlace(z1, z0.data(), z0.size());
+    SubtractInPlace(z1, z2.data(), z2.size());
+
+    LimbVector result = std::move(z0);
+    AddAt(result, z1, h);
+    AddAt(result, z2, 2 * h);
+    Trim(result);
+    return result;
+}
+
+#if defined(__SIZEOF_INT128__)
+
+// Number-theoretic transform over the prime p = 2^64 - 2^32 + 1. Its special form makes the
+// reduction of a 128-bit product a handful of adds, and 2^32 divides p - 1, so transforms of any
+// length we could allocate exist. Operands are cut into 16-bit digits, which keeps every
+// convolution term below 2^32 * n < p and the result exact.
+constexpr uint64_t kPrime     = 0xFFFFFFFF00000001ull;
+constexpr uint64_t kEpsilon   = 0xFFFFFFFFull; // 2^64 mod p
+constexpr uint64_t kGenerator = 7;
+
+// The butterflies feed these effectively random values, so every conditional below is written as a
+// mask instead of a branch the predictor would miss half of the time.
+uint64_t Mask(bool condition) { return uint64_t(0) - uint64_t(condition); }
+
+uint64_t Reduce(unsigned __int128 x)
+{
+    const uint64_t lo    = static_cast<uint64_t>(x);
+    const uint64_t hi    = static_cast<uint64_t>(x >> 64);
+    const uint64_t hi_hi = hi >> 32;
+    const uint64_t hi_lo = hi & kEpsilon;
+
+    // x = lo + hi_lo * 2^64 + hi_hi * 2^96, with 2^64 = epsilon and 2^96 = -1 (mod p).
+    uint64_t t0 = lo - hi_hi;
+    t0 -= Mask(lo < hi_hi) & kEpsilon;
+    const uint64_t t1  = hi_lo * kEpsilon;
+    uint64_t       sum = t0 + t1;
+    sum += Mask(sum < t1) & kEpsilon;
+    return sum - (Mask(sum >= kPrime) & kPrime);
+}
+
+uint64_t MulMod(uint64_t a, uint64_t b) { return Reduce(static_cast<unsigned __int128>(a) * b); }
+
+uint64_t AddMod(uint64_t a, uint64_t b)
+{
+    const uint64_t sum = a + b;
+    return sum - (Mask(sum < a || sum >= kPrime) & kPrime);
+}
+
+uint64_t SubMod(uint64_t a, uint64_t b) { return a - b + (Mask(a < b) & kPrime); }
+
+uint64_t PowMod(uint64_t base, uint64_t exponent)
+{
+    uint64_t result = 1;
+    for (; exponent; exponent >>= 1)
+    {
+        if (exponent & 1) result = MulMod(result, base);
+        base = MulMod(base, base);
+    }
+    return result;
+}
+
+/// roots[len + j] = w^j for the primitive (2 * len)-th root w, for every power of two len < n.
+std::vector<uint64_t> Twiddles(size_t n, bool inverse)
+{
+    std::vector<uint64_t> roots(std::max<size_t>(n, 2));
+    for (size_t len = 1; len < n; len <<= 1)
+    {
+        uint64_t w = PowMod(kGenerator, (kPrime - 1) / (2 * len));
+        if (inverse) w = PowMod(w, kPrime - 2);
+        uint64_t power = 1;
+        for (size_t j = 0; j < len; ++j)
+        {
+            roots[len + j] = power;
+            power          = MulMod(power, w);
+        }
+    }
+    return roots;
+}
+
+// Decimation in frequency, leaving the output in bit-reversed order. The inverse below takes that
+// order as input, so the pointwise product never needs a permutation pass.
+void ForwardNtt(std::vector<uint64_t>& a, const std::vector<uint64_t>& roots)
+{
+    const size_t n = a.size();
+    for (size_t len = n / 2; len >= 1; len >>= 1)
+    {
+        const uint64_t* w = roots.data() + len;
+        for (size_t i = 0; i < n; i += 2 * len)
+        {
+            for (size_t j = 0; j < len; ++j)
+            {
+                const uint64_t u = a[i + j];
+                const uint64_t v = a[i + j + len];
+                a[i + j]         = AddMod(u, v);
+                a[i + j + len]   = MulMod(SubMod(u, v), w[j]);
+            }
+        }
+    }
+}
+
+void InverseNtt(std::vector<uint64_t>& a, const std::vector<uint64_t>& roots)
+{
+    const size_t n = a.size();
+    for (size_t len = 1; len < n; len <<= 1)
+    {
+        const uint64_t* w = roots.data() + len;
+        for (size_t i = 0; i < n; i += 2 * len)
+        {
+            for (size_t j = 0; j < len; ++j)
+            {
+                const uint64_t u = a[i + j];
+                const uint64_t v = MulMod(a[i + j + len], w[j]);
+                a[i + j]         = AddMod(u, v);
+                a[i + j + len]   = SubMod(u, v);
+            }
+        }
+    }
+    const uint64_t scale = PowMod(n, kPrime - 2);
+    for (uint64_t& value : a) value = MulMod(value, scale);
+}
+
+std::vector<uint64_t> SplitDigits(const Limb* a, size_t na, size_t n)
+{
+    std::vector<uint64_t> digits(n, 0);
+    for (size_t i = 0; i < na; ++i)
+    {
+        digits[2 * i]     = a[i] & 0xFFFF;
+        digits[2 * i + 1] = a[i] >> 16;
+    }
+    return digits;
+}
+
+LimbVector MulNtt(const Limb* a, size_t na, const Limb* b, size_t nb)
+{
+    na = TrimmedSize(a, na);
+    nb = TrimmedSize(b, nb);
+    if (na == 0 || nb == 0) return LimbVector();
+
+    const size_t digits = 2 * (na + nb);
+    size_t       n      = 1;
+    while (n < digits) n <<= 1;
+
+    const auto forward = Twiddles(n, false);
+    auto       fa      = SplitDigits(a, na, n);
+    ForwardNtt(fa, forward);
+    if (a == b && na == nb)
+    {
+        for (uint64_t& value : fa) value = MulMod(value, value);
+    }
+    else
+    {
+        auto fb = SplitDigits(b, nb, n);
+        ForwardNtt(fb, forward);
+        for (size_t i = 0; i < n; ++i) fa[i] = MulMod(fa[i], fb[i]);
+    }
+    InverseNtt(fa, Twiddles(n, true));
+
+    LimbVector result(na + nb, 0);
+    uint64_t   carry = 0;
+    for (size_t i = 0; i < result.size(); ++i)
+    {
+        carry += fa[2 * i];
+        const uint64_t low = carry & 0xFFFF;
+        carry >>= 16;
+        carry += fa[2 * i + 1];
+        result[i] = static_cast<Limb>(low | ((carry & 0xFFFF) << 16));
+        carry >>= 16;
+    }
+    Trim(result);
+    return result;
+}
+
+#else
+
+LimbVector MulNtt(const Limb* a, size_t na, const Limb* b, size_t nb) { return MulKaratsuba(a, na, b, nb); }
+
+#endif
+
+LimbVector MultiplyMagnitude(const LimbVector& a, const LimbVector& b, BigInteger::MultiplyAlgorithm algorithm)
+{
+    using Algorithm = BigInteger::MultiplyAlgorithm;
+    if (a.empty() || b.empty()) return LimbVector();
+    if (algorithm == Algorithm::Auto)
+    {
+        const size_t smaller = std::min(a.size(), b.size());
+        algorithm            = smaller < kKaratsubaThreshold ? Algorithm::Schoolbook
+                               : smaller < kNttThreshold     ? Algorithm::Karatsuba
+                                                             : Algorithm::Ntt;
+    }
+    switch (algorithm)
+    {
+    case Algorithm::Schoolbook: return MulSchoolbook(a.data(), a.size(), b.data(), b.size());
+    case Algorithm::Karatsuba: return MulKaratsuba(a.data(), a.size(), b.data(), b.size());
+    case Algorithm::Ntt:
+    case Algorithm::Auto: break;
+    }
+    return MulNtt(a.data(), a.size(), b.data(), b.size());
+}
+
+/// Knuth's algorithm D, for divisors of at least two limbs.
+void DivideKnuth(const LimbVector& dividend, const LimbVector& divisor, LimbVector& quotient, LimbVector& remainder)
+{
+    const size_t n = divisor.size();
+    const size_t m = dividend.size() - n;
+
+    // Normalize so the top divisor limb has its high bit set, which keeps qhat within 2 of q.
+    const int  shift = CountLeadingZeros(divisor.back());
+    LimbVector v(n);
+    LimbVector u(dividend.size() + 1);
+    for (size_t i = n - 1; i > 0; --i)
+    {
+        v[i] = shift ? (divisor[i] << shift) | (divisor[i - 1] >> (32 - shift)) : divisor[i];
+    }
+    v[0]               = divisor[0] << shift;
+    u[dividend.size()] = shift ? dividend.back() >> (32 - shift) : 0;
+    for (size_t i = dividend.size() - 1; i > 0; --i)
+    {
+        u[i] = shift ? (dividend[i] << shift) | (dividend[i - 1] >> (32 - shift)) : dividend[i];
+    }
+    u[0] = dividend[0] << shift;
+
+    quotient.assign(m + 1, 0);
+    for (size_t j = m + 1; j-- > 0;)
+    {
+        const uint64_t numerator = (uint64_t(u[j + n]) << 32) | u[j + n - 1];
+        uint64_t       qhat      = numerator / v[n - 1];
+        uint64_t       rhat      = numerator % v[n - 1];
+        while (qhat >> 32 || qhat * v[n - 2] > ((rhat << 32) | u[j + n - 2]))
+        {
+            --qhat;
+            rhat += v[n - 1];
+            if (rhat >> 32) break;
+        }
+
+        int64_t borrow = 0;
+        for (size_t i = 0; i < n; ++i)
+        {
+            const uint64_t product = qhat * v[i];
+            const int64_t  t       = int64_t(u[i + j]) - borrow - int64_t(product & 0xFFFFFFFF);
+            u[i + j]               = static_cast<Limb>(t);
+            borrow                 = int64_t(product >> 32) - (t >> 32);
+        }
+        const int64_t t = int64_t(u[j + n]) - borrow;
+        u[j + n]        = static_cast<Limb>(t);
+
+        if (t < 0)
+        {
+            // qhat was one too large, add the divisor back.
+            --qhat;
+            uint64_t carry = 0;
+            for (size_t i = 0; i < n; ++i)
+            {
+                carry += uint64_t(u[i + j]) + v[i];
+                u[i + j] = static_cast<Limb>(carry);
+                carry >>= 32;
+            }
+            u[j + n] += static_cast<Limb>(carry);
+        }
+        quotient[j] = static_cast<Limb>(qhat);
+    }
+    Trim(quotient);
+
+    remainder.assign(n, 0);
+    for (size_t i = 0; i < n; ++i)
+    {
+        remainder[i] = shift ? (u[i] >> shift) | (u[i + 1] << (32 - shift)) : u[i];
+    }
+    Trim(remainder);
+}
+
+/// Approximately 2^(BitLength(d) + precision) / d for d > 0, within a few units.
+BigInteger Reciprocal(const BigInteger& d, size_t precision)
+{
+    const size_t length    = d.BitLength();
+    const size_t truncated = std::min(length, precision + kGuardBits);
+    // Bits of d below the precision we are after cannot change the result.
+    const BigInteger dt = d >> (length - truncated);
+    if (precision <= kNewtonBaseBits)
+    {
+        BigInteger quotient;
+        BigInteger remainder;
+        BigInteger::DivMod(BigInteger(1) << (truncated + precision), dt, quotient, remainder);
+        return quotient;
+    }
+
+    // One Newton step x = y + y * (1 - dt * y) doubles the correct bits of y.
+    const size_t     half  = precision / 2 + kGuardBits;
+    const BigInteger y     = Reciprocal(dt, half);
+    const BigInteger error = (BigInteger(1) << (truncated + half)) - dt * y;
+    return (y << (precision - half)) + ((y * error) >> (truncated + 2 * half - precision));
+}
+
+/// Divide non-negative `dividend` by positive `divisor` given Reciprocal(divisor, precision), where
+/// precision covers the quotient bits plus kGuardBits.
+void DivideByReciprocal(const BigInteger& dividend, const BigInteger& divisor, const BigInteger& reciprocal,
+                        size_t precision, BigInteger& quotient, BigInteger& remainder)
+{
+    // q ~ a * (2^k / b) / 2^k. Only as many bits of the reciprocal and of the dividend as the
+    // quotient needs take part, which keeps the product balanced.
+    const size_t la      = dividend.BitLength();
+    const size_t lb      = divisor.BitLength();
+    const size_t needed  = (la > lb ? la - lb : 0) + kGuardBits;
+    const size_t dropped = la > needed + kGuardBits ? la - needed - kGuardBits : 0;
+    quotient  = ((dividend >> dropped) * (reciprocal >> (precision - needed))) >> (lb + needed - dropped);
+    remainder = dividend - quotient * divisor;
+
+    // The estimate is off by a few units at most.
+    while (remainder.IsNegative())
+    {
+        quotient -= 1;
+        remainder += divisor;
+    }
+    while (remainder >= divisor)
+    {
+        quotient += 1;
+        remainder -= divisor;
+    }
+}
+
+} // namespace
+
+BigInteger::BigInteger(int64_t value) : m_negative(value < 0)
+{
+    uint64_t magnitude = value < 0 ? uint64_t(0) - uint64_t(value) : uint64_t(value);
+    while (magnitude)
+    {
+        m_limbs.push_back(static_cast<Limb>(magnitude));
+        magnitude >>= 32;
+    }
+}
+
+BigInteger::BigInteger(std::vector<Limb> limbs, bool negative) : m_limbs(std::move(limbs))
+{
+    Trim(m_limbs);
+    m_negative = negative && !m_limbs.empty();
+}
+
+BigInteger BigInteger::FromLimbs(std::vector<Limb> limbs, bool negative)
+{
+    return BigInteger(std::move(limbs), negative);
+}
+
+size_t BigInteger::BitLength() const
+{
+    if (m_limbs.empty()) return 0;
+    return 32 * m_limbs.size() - static_cast<size_t>(CountLeadingZeros(m_limbs.back()));
+}
+
+double BigInteger::ToDouble() const
+{
+    double result = 0;
+    // The top three limbs carry more bits than a double keeps.
+    const size_t skip = m_limbs.size() > 3 ? m_limbs.size() - 3 : 0;
+    for (size_t i = m_limbs.size(); i-- > skip;) result = result * 4294967296.0 + m_limbs[i];
+    result = std::ldexp(result, static_cast<int>(std::min<size_t>(32 * skip, 1 << 20)));
+    return m_negative ? -result : result;
+}
+
+int BigInteger::Compare(const BigInteger& a, const BigInteger& b)
+{
+    if (a.m_negative != b.m_negative) return a.m_negative ? -1 : 1;
+    const int magnitude = CompareMagnitude(a.m_limbs, b.m_limbs);
+    return a.m_negative ? -magnitude : magnitude;
+}
+
+BigInteger BigInteger::operator-() const { return BigInteger(m_limbs, !m_negative); }
+
+BigInteger BigInteger::Abs() const { return BigInteger(m_limbs, false); }
+
+void BigInteger::AddSigned(const BigInteger& other, bool negate)
+{
+    const bool other_negative = other.m_negative != negate;
+    if (m_negative == other_negative)
+    {
+        m_limbs = AddMagnitude(m_limbs.data(), m_limbs.size(), other.m_limbs.data(), other.m_limbs.size());
+        return;
+    }
+    if (CompareMagnitude(m_limbs, other.m_limbs) >= 0)
+    {
+        SubtractInPlace(m_limbs, other.m_limbs.data(), other.m_limbs.size());
+    }
+    else
+    {
+        LimbVector result = other.m_limbs;
+        SubtractInPlace(result, m_limbs.data(), m_limbs.size());
+        m_limbs    = std::move(result);
+        m_negative = other_negative;
+    }
+    if (m_limbs.empty()) m_negative = false;
+}
+
+BigInteger& BigInteger::operator+=(const BigInteger& other)
+{
+    AddSigned(other, false);
+    return *this;
+}
+
+BigInteger& BigInteger::operator-=(const BigInteger& other)
+{
+    AddSigned(other, true);
+    return *this;
+}
+
+BigInteger BigInteger::Multiply(const BigInteger& a, const BigInteger& b, MultiplyAlgorithm algorithm)
+{
+    return BigInteger(MultiplyMagnitude(a.m_limbs, b.m_limbs, algorithm), a.m_negative != b.m_negative);
+}
+
+BigInteger& BigInteger::operator*=(const BigInteger& other) { return *this = *this * other; }
+
+BigInteger& BigInteger::operator<<=(size_t bits)
+{
+    if (m_limbs.empty() || bits == 0) return *this;
+    const size_t limbs = bits / 32;
+    const int    shift = static_cast<int>(bits % 32);
+    LimbVector   result(m_limbs.size() + limbs + 1, 0);
+    for (size_t i = 0; i < m_limbs.size(); ++i)
+    {
+        result[i + limbs] |= m_limbs[i] << shift;
+        if (shift) result[i + limbs + 1] = m_limbs[i] >> (32 - shift);
+    }
+    Trim(result);
+    m_limbs = std::move(result);
+    return *this;
+}
+
+BigInteger& BigInteger::operator>>=(size_t bits)
+{
+    const size_t limbs = bits / 32;
+    const int    shift = static_cast<int>(bits % 32);
+    if (limbs >= m_limbs.size())
+    {
+        *this = BigInteger();
+        return *this;
+    }
+    LimbVector result(m_limbs.size() - limbs);
+    for (size_t i = 0; i < result.size(); ++i)
+    {
+        result[i] = m_limbs[i + limbs] >> shift;
+        if (shift && i + limbs + 1 < m_limbs.size()) result[i] |= m_limbs[i + limbs + 1] << (32 - shift);
+    }
+    *this = BigInteger(std::move(result), m_negative);
+    return *this;
+}
+
+void BigInteger::DivMod(const BigInteger& a, const BigInteger& b, BigInteger& quotient, BigInteger& remainder)
+{
+    if (b.IsZero()) throw std::domain_error("division by zero");
+
+    const bool quotient_negative  = a.m_negative != b.m_negative;
+    const bool remainder_negative = a.m_negative;
+    if (CompareMagnitude(a.m_limbs, b.m_limbs) < 0)
+    {
+        remainder = a;
+        quotient  = BigInteger();
+        return;
+    }
+
+    const size_t na = a.m_limbs.size();
+    const size_t nb = b.m_limbs.size();
+    if (nb == 1)
+    {
+        LimbVector     q = a.m_limbs;
+        const uint32_t r = DivSmall(q, b.m_limbs[0]);
+        quotient         = BigInteger(std::move(q), quotient_negative);
+        remainder        = BigInteger(LimbVector{r}, remainder_negative);
+        return;
+    }
+    if (nb < kNewtonThreshold || na - nb < kNewtonThreshold)
+    {
+        LimbVector q;
+        LimbVector r;
+        DivideKnuth(a.m_limbs, b.m_limbs, q, r);
+        quotient  = BigInteger(std::move(q), quotient_negative);
+        remainder = BigInteger(std::move(r), remainder_negative);
+        return;
+    }
+
+    const BigInteger dividend  = a.Abs();
+    const BigInteger divisor   = b.Abs();
+    const size_t     precision = dividend.BitLength() - divisor.BitLength() + kGuardBits;
+    BigInteger       q;
+    BigInteger       r;
+    DivideByReciprocal(dividend, divisor, Reciprocal(divisor, precision), precision, q, r);
+    quotient  = BigInteger(std::move(q.m_limbs), quotient_negative);
+    remainder = BigInteger(std::move(r.m_limbs), remainder_negative);
+}
+
+BigInteger& BigInteger::operator/=(const BigInteger& other)
+{
+    BigInteger remainder;
+    DivMod(*this, other, *this, remainder);
+    return *this;
+}
+
+BigInteger& BigInteger::operator%=(const BigInteger& other)
+{
+    BigInteger quotient;
+    DivMod(*this, other, quotient, *this);
+    return *this;
+}
+
+BigInteger BigInteger::Pow(const BigInteger& base, uint32_t exponent)
+{
+    BigInteger result(1);
+    BigInteger square = base;
+    for (; exponent; exponent >>= 1)
+    {
+        if (exponent & 1) result *= square;
+        if (exponent > 1) square = square * square;
+    }
+    return result;
+}
+
+BigInteger BigInteger::Sqrt(const BigInteger& value)
+{
+    if (value.IsNegative()) throw std::domain_error("square root of a negative number");
+    if (value.IsZero()) return BigInteger();
+
+    // Start above the root and let Newton's iteration descend onto floor(sqrt(value)).
+    BigInteger x = BigInteger(1) << ((value.BitLength() + 1) / 2);
+    for (;;)
+    {
+        BigInteger y = (x + value / x) >> 1;
+        if (y >= x) return x;
+        x = std::move(y);
+    }
+}
+
+namespace
+{
+
+/// 10^(9 * 2^k), with its reciprocal once a split needed one.
+struct DecimalPower
+{
+    BigInteger value;
+    BigInteger reciprocal;
+    size_t     precision = 0;
+};
+
+/// powers[k] = 10^(9 * 2^k), grown until it reaches half of `limbs`.
+std::vector<DecimalPower> DecimalPowers(size_t limbs)
+{
+    std::vector<DecimalPower> powers(1);
+    powers[0].value = BigInteger(kChunk);
+    while (powers.back().value.Limbs().size() * 2 < limbs)
+    {
+        powers.emplace_back();
+        powers.back().value = powers[powers.size() - 2].value * powers[powers.size() - 2].value;
+    }
+    return powers;
+}
+
+void AppendDecimal(const BigInteger& value, std::vector<DecimalPower>& powers, size_t width, std::string& out)
+{
+    if (value.Limbs().size() <= kConversionBaseLimbs)
+    {
+        LimbVector            limbs = value.Limbs();
+        std::vector<uint32_t> chunks;
+        while (!limbs.empty()) chunks.push_back(DivSmall(limbs, kChunk));
+
+        std::string digits;
+        for (size_t i = chunks.size(); i-- > 0;)
+        {
+            const std::string chunk = std::to_string(chunks[i]);
+            if (i + 1 != chunks.size()) digits.append(kChunkDigits - chunk.size(), '0');
+            digits += chunk;
+        }
+        if (width > digits.size()) out.append(width - digits.size(), '0');
+        out += digits;
+        return;
+    }
+
+    // Split around the largest power not bigger than roughly half of the value, so both halves are
+    // converted with the same recursion.
+    size_t level = 0;
+    while (level + 1 < powers.size() && powers[level + 1].value.Limbs().size() * 2 <= value.Limbs().size() + 1)
+    {
+        ++level;
+    }
+    const size_t  low_digits = kChunkDigits << level;
+    DecimalPower& power      = powers[level];
+
+    // Every split at a level divides by the same power, so its reciprocal is worth keeping.
+    BigInteger   high;
+    BigInteger   low;
+    const size_t quotient_bits = value.BitLength() - std::min(value.BitLength(), power.value.BitLength());
+    if (power.value.Limbs().size() < kNewtonThreshold || quotient_bits < 32 * kNewtonThreshold)
+    {
+        BigInteger::DivMod(value, power.value, high, low);
+    }
+    else
+    {
+        if (power.precision < quotient_bits + kGuardBits)
+        {
+            power.precision  = quotient_bits + quotient_bits / 4 + kGuardBits;
+            power.reciprocal = Reciprocal(power.value, power.precision);
+        }
+        DivideByReciprocal(value, power.value, power.reciprocal, power.precision, high, low);
+    }
+
+    if (high.IsZero())
+    {
+        AppendDecimal(low, powers, width, out);
+        return;
+    }
+    AppendDecimal(high, powers, width > low_digits ? width - low_digits : 0, out);
+    AppendDecimal(low, powers, low_digits, out);
+}
+
+BigInteger ParseDecimal(const char* digits, size_t count, std::vector<BigInteger>& powers)
+{
+    if (count <= kConversionBaseLimbs * kChunkDigits)
+    {
+        LimbVector limbs;
+        size_t     i = 0;
+        // Leading partial chunk, then whole chunks of nine digits.
+        size_t first = count % kChunkDigits;
+        if (first == 0) first = kChunkDigits;
+        while (i < count)
+        {
+            uint32_t chunk = 0;
+            uint32_t scale = 1;
+            for (size_t end = i + first; i < end; ++i)
+            {
+                chunk = chunk * 10 + static_cast<uint32_t>(digits[i] - '0');
+                scale *= 10;
+            }
+            MulAddSmall(limbs, scale, chunk);
+            first = kChunkDigits;
+        }
+        return BigInteger::FromLimbs(std::move(limbs));
+    }
+
+    size_t level = 0;
+    while ((kChunkDigits << (level + 1)) < count) ++level;
+    while (powers.size() <= level) powers.push_back(powers.back() * powers.back());
+    const size_t low_digits = kChunkDigits << level;
+    return ParseDecimal(digits, count - low_digits, powers) * powers[level] +
+           ParseDecimal(digits + count - low_digits, low_digits, powers);
+}
+
+} // namespace
+
+BigInteger BigInteger::FromString(const std::string& text)
+{
+    size_t     start    = 0;
+    const bool negative = !text.empty() && text[0] == '-';
+    if (!text.empty() && (text[0] == '-' || text[0] == '+')) start = 1;
+    if (start == text.size()) throw std::invalid_argument("no digits in '" + text + "'");
+    for (size_t i = start; i < text.size(); ++i)
+    {
+        if (text[i] < '0' || text[i] > '9') throw std::invalid_argument("not an integer: '" + text + "'");
+    }
+
+    std::vector<BigInteger> powers{BigInteger(kChunk)};
+    BigInteger              result = ParseDecimal(text.data() + start, text.size() - start, powers);
+    return negative ? -result : result;
+}
+
+std::string BigInteger::ToString() const
+{
+    if (IsZero()) return "0";
+    std::string out = m_negative ? "-" : "";
+    auto        powers = DecimalPowers(m_limbs.size());
+    AppendDecimal(Abs(), powers, 0, out);
+    return out;
+}
+
+} // namespace gomarky
@@ -0,0 +1,97 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace gomarky
+{
+
+/// Arbitrary-precision signed integer stored as base 2^32 limbs, least significant first.
+///
+/// Multiplication switches from schoolbook to Karatsuba to a number-theoretic transform as the
+/// smaller operand grows. Large divisions multiply by a reciprocal found with Newton iteration, and
+/// decimal conversion splits the number around powers of ten, so both ride on the fast multiply.
+class BigInteger
+{
+public:
+    using Limb = uint32_t;
+
+    enum class MultiplyAlgorithm
+    {
+        Auto,
+        Schoolbook,
+        Karatsuba,
+        Ntt,
+    };
+
+    BigInteger() = default;
+    /// Implicit, like conversions between the built-in integers.
+    BigInteger(int64_t value);
+
+    /// Optional sign followed by decimal digits. Throws std::invalid_argument.
+    static BigInteger FromString(const std::string& text);
+    std::string       ToString() const;
+    /// Magnitude from base 2^32 limbs, least significant first.
+    static BigInteger FromLimbs(std::vector<Limb> limbs, bool negative = false);
+
+    bool   IsZero() const { return m_limbs.empty(); }
+    bool   IsNegative() const { return m_negative; }
+    int    Sign() const { return IsZero() ? 0 : (m_negative ? -1 : 1); }
+    size_t BitLength() const;
+    double ToDouble() const;
+
+    const std::vector<Limb>& Limbs() const { return m_limbs; }
+
+    static BigInteger Multiply(const BigInteger& a, const BigInteger& b, MultiplyAlgorithm algorithm);
+    /// Truncating division like the built-in operators, so `remainder` takes the sign of `a`.
+    /// Throws std::domain_error when `b` is zero.
+    static void       DivMod(const BigInteger& a, const BigInteger& b, BigInteger& quotient, BigInteger& remainder);
+    static BigInteger Pow(const BigInteger& base, uint32_t exponent);
+    static BigInteger Pow10(uint32_t exponent) { return Pow(BigInteger(10), exponent); }
+    /// floor(sqrt(value)). Throws std::domain_error for negative values.
+    static BigInteger Sqrt(const BigInteger& value);
+
+    BigInteger operator-() const;
+    BigInteger Abs() const;
+
+    BigInteger& operator+=(const BigInteger& other);
+    BigInteger& operator-=(const BigInteger& other);
+    BigInteger& operator*=(const BigInteger& other);
+    BigInteger& operator/=(const BigInteger& other);
+    BigInteger& operator%=(const BigInteger& other);
+    /// Shifts move the magnitude and keep the sign.
+    BigInteger& operator<<=(size_t bits);
+    BigInteger& operator>>=(size_t bits);
+
+    friend BigInteger operator+(BigInteger a, const BigInteger& b) { return a += b; }
+    friend BigInteger operator-(BigInteger a, const BigInteger& b) { return a -= b; }
+    friend BigInteger operator*(const BigInteger& a, const BigInteger& b)
+    {
+        return Multiply(a, b, MultiplyAlgorithm::Auto);
+    }
+    friend BigInteger operator/(BigInteger a, const BigInteger& b) { return a /= b; }
+    friend BigInteger operator%(BigInteger a, const BigInteger& b) { return a %= b; }
+    friend BigInteger operator<<(BigInteger a, size_t bits) { return a <<= bits; }
+    friend BigInteger operator>>(BigInteger a, size_t bits) { return a >>= bits; }
+
+    static int Compare(const BigInteger& a, const BigInteger& b);
+
+    friend bool operator==(const BigInteger& a, const BigInteger& b) { return Compare(a, b) == 0; }
+    friend bool operator!=(const BigInteger& a, const BigInteger& b) { return Compare(a, b) != 0; }
+    friend bool operator<(const BigInteger& a, const BigInteger& b) { return Compare(a, b) < 0; }
+    friend bool operator<=(const BigInteger& a, const BigInteger& b) { return Compare(a, b) <= 0; }
+    friend bool operator>(const BigInteger& a, const BigInteger& b) { return Compare(a, b) > 0; }
+    friend bool operator>=(const BigInteger& a, const BigInteger& b) { return Compare(a, b) >= 0; }
+
+private:
+    BigInteger(std::vector<Limb> limbs, bool negative);
+
+    void AddSigned(const BigInteger& other, bool negate);
+
+    std::vector<Limb> m_limbs;            ///< no trailing zero limbs, empty for zero
+    bool              m_negative = false; ///< never set for zero
+};
+
+} // namespace gomarky
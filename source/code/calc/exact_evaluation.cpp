@@ -0,0 +1,85 @@
+#include "calc/exact_evaluation.h"
+
+#include <algorithm>
+#include <limits>
+#include <stdexcept>
+#include <utility>
+
+namespace gomarky
+{
+
+namespace
+{
+
+using Node = Expression::Node;
+using Op   = Expression::Op;
+
+// Beyond this the result would not fit in memory anyway.
+constexpr uint32_t kMaxExponent = 1u << 24;
+
+BigDecimal Modulo(const BigDecimal& a, const BigDecimal& b)
+{
+    if (b.IsZero()) throw std::domain_error("modulo by zero");
+    // Same sign convention as fmod: the result takes the sign of a.
+    const int32_t scale = std::max(a.Scale(), b.Scale());
+    return BigDecimal(a.Rescale(scale).Unscaled() % b.Rescale(scale).Unscaled(), scale);
+}
+
+BigDecimal Power(const BigDecimal& base, const BigDecimal& exponent, size_t digits)
+{
+    if (!exponent.IsInteger()) throw std::domain_error("exact power needs an integer exponent");
+    const BigInteger whole = exponent.Truncated();
+    if (whole.Abs() > BigInteger(kMaxExponent)) throw std::domain_error("exponent too large");
+
+    const auto    count = static_cast<uint32_t>(whole.Abs().ToDouble());
+    const int64_t scale = int64_t(base.Scale()) * count;
+    if (scale > std::numeric_limits<int32_t>::max() || scale < std::numeric_limits<int32_t>::min())
+    {
+        throw std::domain_error("power out of range");
+    }
+    const BigDecimal power(BigInteger::Pow(base.Unscaled(), count), static_cast<int32_t>(scale));
+    return whole.IsNegative() ? BigDecimal::Divide(1, power, digits) : power;
+}
+
+BigDecimal EvaluateNode(const Node& node, const BigDecimal* values, size_t digits)
+{
+    auto arg = [&](size_t i) { return EvaluateNode(*node.children[i], values, digits); };
+    switch (node.op)
+    {
+    case Op::Number: return BigDecimal::FromString(node.literal);
+    case Op::Reference: return values[node.reference];
+    case Op::Negate: return -arg(0);
+    case Op::Add: return arg(0) + arg(1);
+    case Op::Subtract: return arg(0) - arg(1);
+    case Op::Multiply: return arg(0) * arg(1);
+    case Op::Divide: return BigDecimal::Divide(arg(0), arg(1), digits);
+    case Op::Modulo: return Modulo(arg(0), arg(1));
+    case Op::Power: return Power(arg(0), arg(1), digits);
+    case Op::Abs: return arg(0).Abs();
+    case Op::Sqrt: return BigDecimal::Sqrt(arg(0), digits);
+    case Op::Round: return arg(0).Rescale(0);
+    case Op::Min:
+    case Op::Max:
+    case Op::Sum:
+    {
+        BigDecimal result = arg(0);
+        for (size_t i = 1; i < node.children.size(); ++i)
+        {
+            BigDecimal value = arg(i);
+            if (node.op == Op::Sum) result = result + value;
+            else if (node.op == Op::Min ? value < result : value > result) result = std::move(value);
+        }
+        return result;
+    }
+    }
+    return BigDecimal();
+}
+
+} // namespace
+
+BigDecimal EvaluateExact(const Expression& expression, const BigDecimal* values, size_t digits)
+{
+    return EvaluateNode(expression.Root(), values, digits);
+}
+
+} // namespace gomarky
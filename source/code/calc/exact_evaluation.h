@@ -0,0 +1,25 @@
+#pragma once
+
+#include "calc/big_decimal.h"
+#include "calc/expression.h"
+
+#include <cstddef>
+#include <vector>
+
+namespace gomarky
+{
+
+/// Evaluate `expression` in exact decimal arithmetic, taking literals from their source text.
+///
+/// + - * and % are exact. Division and sqrt keep `digits` fractional digits, and ^ needs an integer
+/// exponent. `values[i]` is the value of expression.References()[i]. Throws std::domain_error for
+/// division by zero and other operations without an exact result.
+BigDecimal EvaluateExact(const Expression& expression, const BigDecimal* values, size_t digits = 32);
+
+inline BigDecimal EvaluateExact(const Expression& expression, const std::vector<BigDecimal>& values,
+                                size_t digits = 32)
+{
+    return EvaluateExact(expression, values.data(), digits);
+}
+
+} // namespace gomarky
@@ -0,0 +1,329 @@
+#include "calc/expression.h"
+
+#include <algorithm>
+#include <cctype>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <unordered_map>
+#include <utility>
+
+namespace gomarky
+{
+
+namespace
+{
+
+using Node = Expression::Node;
+using Op   = Expression::Op;
+
+std::unique_ptr<Node> MakeNode(Op op)
+{
+    std::unique_ptr<Node> node(new Node);
+    node->op = op;
+    return node;
+}
+
+class Parser
+{
+public:
+    Parser(const std::string& text, std::vector<std::string>& references) : m_text(text), m_references(references) {}
+
+    std::unique_ptr<Node> ParseAll()
+    {
+        auto root = ParseSum();
+        SkipSpace();
+        if (m_pos != m_text.size()) Fail("unexpected '" + std::string(1, m_text[m_pos]) + "'");
+        return root;
+    }
+
+private:
+    std::unique_ptr<Node> ParseSum()
+    {
+        auto left = ParseProduct();
+        for (;;)
+        {
+            Op op;
+            if (Accept('+')) op = Op::Add;
+            else if (Accept('-')) op = Op::Subtract;
+            else return left;
+            left = Binary(op, std::move(left), ParseProduct());
+        }
+    }
+
+    std::unique_ptr<Node> ParseProduct()
+    {
+        auto left = ParseUnary();
+        for (;;)
+        {
+            Op op;
+            if (Accept('*')) op = Op::Multiply;
+            else if (Accept('/')) op = Op::Divide;
+            else if (Accept('%')) op = Op::Modulo;
+            else return left;
+            left = Binary(op, std::move(left), ParseUnary());
+        }
+    }
+
+    std::unique_ptr<Node> ParseUnary()
+    {
+        if (Accept('-'))
+        {
+            auto node = MakeNode(Op::Negate);
+            node->children.push_back(ParseUnary());
+            return node;
+        }
+        if (Accept('+')) return ParseUnary();
+        return ParsePower();
+    }
+
+    std::unique_ptr<Node> ParsePower()
+    {
+        auto base = ParsePrimary();
+        if (!Accept('^')) return base;
+        return Binary(Op::Power, std::move(base), ParseUnary()); // right-associative, 2^-1 allowed
+    }
+
+    std::unique_ptr<Node> ParsePrimary()
+    {
+        SkipSpace();
+        if (m_pos >= m_text.size()) Fail("unexpected end of expression");
+
+        const char c = m_text[m_pos];
+        if (Accept('('))
+        {
+            auto inner = ParseSum();
+            Expect(')');
+            return inner;
+        }
+        if (std::isdigit(static_cast<unsigned char>(c)) || c == '.') return ParseNumber();
+        if (std::isalpha(static_cast<unsigned char>(c)) || c == '_') return ParseName();
+        Fail("unexpected '" + std::string(1, c) + "'");
+        return nullptr;
+    }
+
+    std::unique_ptr<Node> ParseNumber()
+    {
+        // digits [. digits] [e [+-] digits], scanned here so that strtod never sees hex or inf.
+        const size_t start  = m_pos;
+        auto         digits = [this] {
+            const size_t begin = m_pos;
+            while (m_pos < m_text.size() && std::isdigit(static_cast<unsigned char>(m_text[m_pos]))) ++m_pos;
+            return m_pos - begin;
+        };
+        size_t count = digits();
+        if (m_pos < m_text.size() && m_text[m_pos] == '.')
+        {
+            ++m_pos;
+            count += digits();
+        }
+        if (count == 0) Fail("malformed number", start);
+        if (m_pos < m_text.size() && (m_text[m_pos] == 'e' || m_text[m_pos] == 'E'))
+        {
+            ++m_pos;
+            if (m_pos < m_text.size() && (m_text[m_pos] == '+' || m_text[m_pos] == '-')) ++m_pos;
+            if (digits() == 0) Fail("malformed exponent", start);
+        }
+
+        auto node     = MakeNode(Op::Number);
+        node->literal = m_text.substr(start, m_pos - start);
+        node->number  = std::strtod(node->literal.c_str(), nullptr);
+        return node;
+    }
+
+    std::unique_ptr<Node> ParseName()
+    {
+        const size_t start = m_pos;
+        while (m_pos < m_text.size() &&
+               (std::isalnum(static_cast<unsigned char>(m_text[m_pos])) || m_text[m_pos] == '_' || m_text[m_pos] == '.'))
+        {
+            ++m_pos;
+        }
+        const std::string name = m_text.substr(start, m_pos - start);
+
+        if (!Accept('('))
+        {
+            auto node = MakeNode(Op::Reference);
+            auto it   = m_reference_index.find(name);
+            if (it == m_reference_index.end())
+            {
+                it = m_reference_index.emplace(name, static_cast<uint32_t>(m_references.size())).first;
+                m_references.push_back(name);
+            }
+            node->reference = it->second;
+            return node;
+        }
+
+        static const std::unordered_map<std::string, Op> kFunctions = {
+            {"abs", Op::Abs}, {"sqrt", Op::Sqrt}, {"round", Op::Round},
+            {"min", Op::Min}, {"max", Op::Max},   {"sum", Op::Sum},
+        };
+        auto function = kFunctions.find(name);
+        if (function == kFunctions.end()) Fail("unknown function '" + name + "'", start);
+
+        auto node = MakeNode(function->second);
+        if (!Accept(')'))
+        {
+            do node->children.push_back(ParseSum());
+            while (Accept(','));
+            Expect(')');
+        }
+        const bool unary = node->op == Op::Abs || node->op == Op::Sqrt || node->op == Op::Round;
+        if (unary ? node->children.size() != 1 : node->children.empty())
+        {
+            Fail("wrong number of arguments for '" + name + "'", start);
+        }
+        return node;
+    }
+
+    static std::unique_ptr<Node> Binary(Op op, std::unique_ptr<Node> left, std::unique_ptr<Node> right)
+    {
+        auto node = MakeNode(op);
+        node->children.push_back(std::move(left));
+        node->children.push_back(std::move(right));
+        return node;
+    }
+
+    void SkipSpace()
+    {
+        while (m_pos < m_text.size() && std::isspace(static_cast<unsigned char>(m_text[m_pos]))) ++m_pos;
+    }
+
+    bool Accept(char c)
+    {
+        SkipSpace();
+        if (m_pos < m_text.size() && m_text[m_pos] == c)
+        {
+            ++m_pos;
+            return true;
+        }
+        return false;
+    }
+
+    void Expect(char c)
+    {
+        if (!Accept(c)) Fail(std::string("expected '") + c + "'");
+    }
+
+    [[noreturn]] void Fail(const std::string& message) { Fail(message, m_pos); }
+    [[noreturn]] void Fail(const std::string& message, size_t position)
+    {
+        throw ExpressionError(message + " at position " + std::to_string(position), position);
+    }
+
+    const std::string&                        m_text;
+    std::vector<std::string>&                 m_references;
+    std::unordered_map<std::string, uint32_t> m_reference_index;
+    size_t                                    m_pos = 0;
+};
+
+double EvaluateNode(const Node& node, const double* values)
+{
+    auto arg = [&](size_t i) { return EvaluateNode(*node.children[i], values); };
+    switch (node.op)
+    {
+    case Op::Number: return node.number;
+    case Op::Reference: return values[node.reference];
+    case Op::Negate: return -arg(0);
+    case Op::Add: return arg(0) + arg(1);
+    case Op::Subtract: return arg(0) - arg(1);
+    case Op::Multiply: return arg(0) * arg(1);
+    case Op::Divide: return arg(0) / arg(1);
+    case Op::Modulo: return std::fmod(arg(0), arg(1));
+    case Op::Power: return std::pow(arg(0), arg(1));
+    case Op::Abs: return std::fabs(arg(0));
+    case Op::Sqrt: return std::sqrt(arg(0));
+    case Op::Round: return std::round(arg(0));
+    case Op::Min:
+    case Op::Max:
+    case Op::Sum:
+    {
+        double result = arg(0);
+        for (size_t i = 1; i < node.children.size(); ++i)
+        {
+            const double value = arg(i);
+            if (node.op == Op::Min) result = std::min(result, value);
+            else if (node.op == Op::Max) result = std::max(result, value);
+            else result += value;
+        }
+        return result;
+    }
+    }
+    return 0;
+}
+
+std::string CanonicalText(const Node& node, const std::vector<std::string>& references)
+{
+    auto child = [&](size_t i) { return CanonicalText(*node.children[i], references); };
+    auto call  = [&](const char* name) {
+        std::string text = name;
+        for (size_t i = 0; i < node.children.size(); ++i) text += (i ? "," : "(") + child(i);
+        return text + ")";
+    };
+    auto binary = [&](const char* op, bool commutative) {
+        std::string left  = child(0);
+        std::string right = child(1);
+        if (commutative && right < left) std::swap(left, right);
+        return "(" + left + op + right + ")";
+    };
+
+    switch (node.op)
+    {
+    case Op::Number:
+    {
+        // "inf" and "nan" would read as references; '#' cannot start a token.
+        if (std::isnan(node.number)) return "#nan";
+        if (std::isinf(node.number)) return node.number > 0 ? "#inf" : "#-inf";
+        char buffer[32];
+        std::snprintf(buffer, sizeof(buffer), "%.17g", node.number);
+        return buffer;
+    }
+    case Op::Reference: return references[node.reference];
+    case Op::Negate: return "(-" + child(0) + ")";
+    case Op::Add: return binary("+", true);
+    case Op::Subtract: return binary("-", false);
+    case Op::Multiply: return binary("*", true);
+    case Op::Divide: return binary("/", false);
+    case Op::Modulo: return binary("%", false);
+    case Op::Power: return binary("^", false);
+    case Op::Abs: return call("abs");
+    case Op::Sqrt: return call("sqrt");
+    case Op::Round: return call("round");
+    case Op::Min: return call("min");
+    case Op::Max: return call("max");
+    case Op::Sum: return call("sum");
+    }
+    return std::string();
+}
+
+uint64_t Fnv1a(const std::string& text)
+{
+    uint64_t hash = 14695981039346656037ull;
+    for (unsigned char c : text) hash = (hash ^ c) * 1099511628211ull;
+    return hash;
+}
+
+} // namespace
+
+Expression Expression::Parse(const std::string& text)
+{
+    Expression expression;
+    Parser     parser(text, expression.m_references);
+    expression.m_root = parser.ParseAll();
+
+    const auto& references = expression.m_references;
+    auto        canonical  = std::make_shared<Canonical>();
+    canonical->text        = CanonicalText(*expression.m_root, references);
+    canonical->hash        = Fnv1a(canonical->text);
+    canonical->order.resize(references.size());
+    for (uint32_t i = 0; i < references.size(); ++i) canonical->order[i] = i;
+    std::sort(canonical->order.begin(), canonical->order.end(),
+              [&references](uint32_t a, uint32_t b) { return references[a] < references[b]; });
+    for (uint32_t index : canonical->order) canonical->names.push_back(references[index]);
+    expression.m_canonical = std::move(canonical);
+    return expression;
+}
+
+double Expression::Evaluate(const double* values) const { return EvaluateNode(*m_root, values); }
+
+} // namespace gomarky
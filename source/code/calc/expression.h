@@ -0,0 +1,96 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace gomarky
+{
+
+/// Thrown for malformed expression text.
+class ExpressionError : public std::runtime_error
+{
+public:
+    ExpressionError(const std::string& message, size_t position)
+        : std::runtime_error(message), m_position(position)
+    {
+    }
+
+    /// Offset in the source text where parsing failed.
+    size_t Position() const { return m_position; }
+
+private:
+    size_t m_position;
+};
+
+/// Parsed arithmetic expression over numbers and named references.
+///
+/// Grammar: + - * / % with the usual precedence, right-associative ^, unary minus, parentheses,
+/// and the functions abs, sqrt, round, min, max and sum. References are identifiers
+/// ([A-Za-z_][A-Za-z0-9_.]*); each distinct name is numbered in order of first appearance and
+/// evaluation takes their values in that order, so callers can resolve names once, up front.
+class Expression
+{
+public:
+    enum class Op : uint8_t
+    {
+        Number,
+        Reference,
+        Negate,
+        Add,
+        Subtract,
+        Multiply,
+        Divide,
+        Modulo,
+        Power,
+        Abs,
+        Sqrt,
+        Round,
+        Min,
+        Max,
+        Sum,
+    };
+
+    struct Node
+    {
+        Op                                 op;
+        double                             number    = 0; ///< for Number
+        std::string                        literal;       ///< source text, for Number
+        uint32_t                           reference = 0; ///< index into References(), for Reference
+        std::vector<std::unique_ptr<Node>> children;
+    };
+
+    /// Spelling-independent identity of an expression. Operands of + and * are put in a fixed
+    /// order and numbers are printed in round-trip form, so "b*a + 1" and "1 + a * b" share it.
+    /// Both operators are exactly commutative in floating point, so equal canonical text and equal
+    /// bindings always give equal results.
+    struct Canonical
+    {
+        std::string              text;
+        uint64_t                 hash = 0;
+        std::vector<uint32_t>    order; ///< indices into References(), by name
+        std::vector<std::string> names; ///< References() sorted
+    };
+
+    /// Throws ExpressionError.
+    static Expression Parse(const std::string& text);
+
+    const Node&                     Root() const { return *m_root; }
+    const std::vector<std::string>& References() const { return m_references; }
+    /// Shared so that caches can key on it without copying.
+    const std::shared_ptr<const Canonical>& CanonicalForm() const { return m_canonical; }
+
+    /// `values[i]` is the value of References()[i].
+    double Evaluate(const double* values) const;
+    double Evaluate(const std::vector<double>& values) const { return Evaluate(values.data()); }
+
+private:
+    std::unique_ptr<Node>            m_root;
+    std::vector<std::string>         m_references;
+    std::shared_ptr<const Canonical> m_canonical;
+};
+
+} // namespace gomarky
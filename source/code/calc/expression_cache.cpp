@@ -0,0 +1,158 @@
+#include "calc/expression_cache.h"
+
+#include "metrics/metrics_registry.h"
+
+#include <algorithm>
+#include <cstring>
+
+namespace gomarky
+{
+
+namespace
+{
+
+uint64_t Mix(uint64_t hash, uint64_t value)
+{
+    // Combine, then finish with splitmix64 so that nearby doubles land in different shards.
+    hash ^= value + 0x9e3779b97f4a7c15ull + (hash << 6) + (hash >> 2);
+    hash ^= hash >> 30;
+    hash *= 0xbf58476d1ce4e5b9ull;
+    hash ^= hash >> 27;
+    hash *= 0x94d049bb133111ebull;
+    return hash ^ (hash >> 31);
+}
+
+uint64_t Bits(double value)
+{
+    uint64_t bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+    return bits;
+}
+
+// Bookkeeping of one entry besides the values themselves: list and hash nodes, key and value.
+constexpr size_t kEntryOverhead = 96;
+
+} // namespace
+
+bool ExpressionCache::Key::operator==(const Key& other) const
+{
+    if (hash != other.hash || values.size() != other.values.size()) return false;
+    if (canonical != other.canonical && canonical->text != other.canonical->text) return false;
+    // Bitwise, so that NaN bindings can hit and 0.0 and -0.0 stay apart.
+    return values.empty() || std::memcmp(values.data(), other.values.data(), values.size() * sizeof(double)) == 0;
+}
+
+ExpressionCache::ExpressionCache(size_t budget)
+    : ExpressionCache(MetricsRegistry::Global(), "calc.expression_cache", budget, kDefaultShards)
+{
+}
+
+ExpressionCache::ExpressionCache(MetricsRegistry& metrics, const std::string& name, size_t budget, size_t shards)
+    : m_hits(metrics.GetCounter(name + ".hits")),
+      m_misses(metrics.GetCounter(name + ".misses")),
+      m_evictions(metrics.GetCounter(name + ".evictions")),
+      m_invalidations(metrics.GetCounter(name + ".invalidations")),
+      m_bytes(metrics.GetGauge(name + ".bytes"))
+{
+    shards = std::max<size_t>(shards, 1);
+    for (size_t i = 0; i < shards; ++i) m_shards.emplace_back(new Shard(budget / shards));
+}
+
+ExpressionCache::~ExpressionCache() { Clear(); }
+
+double ExpressionCache::Evaluate(const Expression& expression, const double* values)
+{
+    const auto& canonical = expression.CanonicalForm();
+    Key         key{canonical->hash, canonical, {}};
+    key.values.reserve(canonical->order.size());
+    for (uint32_t index : canonical->order)
+    {
+        key.values.push_back(values[index]);
+        key.hash = Mix(key.hash, Bits(values[index]));
+    }
+
+    Shard& shard = ShardFor(key.hash);
+    {
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        if (const double* cached = shard.entries.Find(key))
+        {
+            m_hit_count.fetch_add(1, std::memory_order_relaxed);
+            m_hits.Add();
+            return *cached;
+        }
+    }
+    m_miss_count.fetch_add(1, std::memory_order_relaxed);
+    m_misses.Add();
+
+    // Evaluate unlocked; a concurrent miss on the same key just computes the same value twice.
+    const double result = expression.Evaluate(values);
+    const size_t cost   = kEntryOverhead + key.values.size() * sizeof(double);
+
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    const size_t                used_before      = shard.entries.UsedBytes();
+    const size_t                evictions_before = shard.entries.Evictions();
+    shard.entries.Insert(key, result, cost);
+    Publish(shard, used_before, evictions_before);
+    return result;
+}
+
+size_t ExpressionCache::Invalidate(const std::string& variable)
+{
+    size_t removed = 0;
+    for (auto& shard : m_shards)
+    {
+        std::lock_guard<std::mutex> lock(shard->mutex);
+        const size_t                used_before = shard->entries.UsedBytes();
+        removed += shard->entries.RemoveIf([&variable](const Key& key, double) {
+            const auto& names = key.canonical->names;
+            return std::binary_search(names.begin(), names.end(), variable);
+        });
+        Publish(*shard, used_before, shard->entries.Evictions());
+    }
+    m_invalidations.Add(removed);
+    return removed;
+}
+
+void ExpressionCache::Clear()
+{
+    for (auto& shard : m_shards)
+    {
+        std::lock_guard<std::mutex> lock(shard->mutex);
+        const size_t                used_before = shard->entries.UsedBytes();
+        shard->entries.Clear();
+        Publish(*shard, used_before, shard->entries.Evictions());
+    }
+}
+
+void ExpressionCache::Publish(const Shard& shard, size_t used_before, size_t evictions_before)
+{
+    m_bytes.Add(static_cast<int64_t>(shard.entries.UsedBytes()) - static_cast<int64_t>(used_before));
+    m_evictions.Add(shard.entries.Evictions() - evictions_before);
+}
+
+size_t ExpressionCache::Size() const
+{
+    size_t size = 0;
+    for (const auto& shard : m_shards)
+    {
+        std::lock_guard<std::mutex> lock(shard->mutex);
+        size += shard->entries.Size();
+    }
+    return size;
+}
+
+size_t ExpressionCache::UsedBytes() const
+{
+    size_t used = 0;
+    for (const auto& shard : m_shards)
+    {
+        std::lock_guard<std::mutex> lock(shard->mutex);
+        used += shard->entries.UsedBytes();
+    }
+    return used;
+}
+
+uint64_t ExpressionCache::Hits() const { return m_hit_count.load(std::memory_order_relaxed); }
+uint64_t ExpressionCache::Misses() const { return m_miss_count.load(std::memory_order_relaxed); }
+
+} // namespace gomarky
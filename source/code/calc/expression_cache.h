@@ -0,0 +1,96 @@
+#pragma once
+
+#include "assets/byte_lru_cache.h"
+#include "calc/expression.h"
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace gomarky
+{
+
+class Counter;
+class Gauge;
+class MetricsRegistry;
+
+/// Memoized results of Expression::Evaluate(), keyed by the canonical form of the expression plus
+/// the values bound to its references.
+///
+/// Entries are spread over independently locked shards by key hash, each a byte-bounded LRU, so
+/// threads evaluating different expressions rarely contend. Hits, misses, evictions, invalidations
+/// and the bytes held are published to a MetricsRegistry under `<name>.*`; caches sharing a name
+/// add to the same metrics, while Hits() and Misses() count this cache only.
+class ExpressionCache
+{
+public:
+    static constexpr size_t kDefaultBudget = 8 * 1024 * 1024;
+    static constexpr size_t kDefaultShards = 16;
+
+    explicit ExpressionCache(size_t budget = kDefaultBudget);
+    ExpressionCache(MetricsRegistry& metrics, const std::string& name, size_t budget = kDefaultBudget,
+                    size_t shards = kDefaultShards);
+    ~ExpressionCache();
+
+    ExpressionCache(const ExpressionCache&) = delete;
+    ExpressionCache& operator=(const ExpressionCache&) = delete;
+
+    /// Same contract as Expression::Evaluate(). Safe to call from several threads.
+    double Evaluate(const Expression& expression, const double* values);
+    double Evaluate(const Expression& expression, const std::vector<double>& values)
+    {
+        return Evaluate(expression, values.data());
+    }
+
+    /// Drop every entry of an expression reading `variable`, for when its value changed and the
+    /// old bindings will not come back. Returns the number of entries dropped.
+    size_t Invalidate(const std::string& variable);
+    void   Clear();
+
+    size_t   Size() const;
+    size_t   UsedBytes() const;
+    uint64_t Hits() const;
+    uint64_t Misses() const;
+
+private:
+    struct Key
+    {
+        uint64_t                                     hash;
+        std::shared_ptr<const Expression::Canonical> canonical;
+        std::vector<double>                          values; ///< in canonical order
+
+        bool operator==(const Key& other) const;
+    };
+
+    struct KeyHash
+    {
+        size_t operator()(const Key& key) const { return static_cast<size_t>(key.hash); }
+    };
+
+    struct Shard
+    {
+        explicit Shard(size_t budget) : entries(budget) {}
+
+        std::mutex                         mutex;
+        ByteLruCache<Key, double, KeyHash> entries;
+    };
+
+    Shard& ShardFor(uint64_t hash) const { return *m_shards[(hash >> 32) % m_shards.size()]; }
+    /// Reflect a change of `shard` in the gauges and eviction counter; called under its lock.
+    void Publish(const Shard& shard, size_t used_before, size_t evictions_before);
+
+    std::vector<std::unique_ptr<Shard>> m_shards;
+    Counter&                            m_hits;
+    Counter&                            m_misses;
+    Counter&                            m_evictions;
+    Counter&                            m_invalidations;
+    Gauge&                              m_bytes;
+    std::atomic<uint64_t>               m_hit_count{0};
+    std::atomic<uint64_t>               m_miss_count{0};
+};
+
+} // namespace gomarky
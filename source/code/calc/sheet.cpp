@@ -0,0 +1,218 @@
+#include "calc/sheet.h"
+
+#include "concurrency/worker_pool.h"
+
+#include <algorithm>
+
+namespace gomarky
+{
+
+namespace
+{
+
+// Levels smaller than this are cheaper to evaluate inline than to hand to the pool.
+constexpr size_t kParallelThreshold = 512;
+constexpr size_t kGrain             = 128;
+
+} // namespace
+
+Sheet::Sheet()  = default;
+Sheet::~Sheet() = default;
+
+Sheet::CellId Sheet::Intern(const std::string& name)
+{
+    auto it = m_ids.find(name);
+    if (it != m_ids.end()) return it->second;
+
+    const auto id = static_cast<CellId>(m_cells.size());
+    m_cells.emplace_back();
+    m_cells.back().name = name;
+    m_values.push_back(CellValue{0, CellError::Reference});
+    m_ids.emplace(name, id);
+    return id;
+}
+
+void Sheet::Unlink(CellId id)
+{
+    Cell& cell = m_cells[id];
+    for (CellId precedent : cell.precedents)
+    {
+        auto& dependents = m_cells[precedent].dependents;
+        auto  it         = std::find(dependents.begin(), dependents.end(), id);
+        if (it != dependents.end())
+        {
+            *it = dependents.back();
+            dependents.pop_back();
+        }
+    }
+    cell.precedents.clear();
+    cell.formula.reset();
+    cell.parse_message.clear();
+}
+
+void Sheet::MarkChanged(CellId id)
+{
+    if (m_cells[id].changed) return;
+    m_cells[id].changed = true;
+    m_changed.push_back(id);
+}
+
+void Sheet::SetFormula(const std::string& name, const std::string& formula)
+{
+    const CellId id = Intern(name);
+    Unlink(id);
+
+    Cell& cell   = m_cells[id];
+    cell.defined = true;
+    try
+    {
+        std::unique_ptr<Expression> expression(new Expression(Expression::Parse(formula)));
+        // Interning may grow m_cells, so do not hold on to `cell` across it.
+        std::vector<CellId> precedents;
+        precedents.reserve(expression->References().size());
+        for (const auto& reference : expression->References()) precedents.push_back(Intern(reference));
+
+        Cell& target = m_cells[id];
+        for (CellId precedent : precedents) m_cells[precedent].dependents.push_back(id);
+        target.precedents = std::move(precedents);
+        target.formula    = std::move(expression);
+    }
+    catch (const ExpressionError& error)
+    {
+        m_cells[id].parse_message = error.what();
+    }
+    MarkChanged(id);
+}
+
+void Sheet::SetNumber(const std::string& name, double value)
+{
+    const CellId id = Intern(name);
+    Unlink(id);
+    m_cells[id].defined = true;
+    m_cells[id].number  = value;
+    MarkChanged(id);
+}
+
+void Sheet::Remove(const std::string& name)
+{
+    auto it = m_ids.find(name);
+    if (it == m_ids.end()) return;
+    // The cell stays as a placeholder so that dependents keep their edges to it.
+    Unlink(it->second);
+    m_cells[it->second].defined = false;
+    MarkChanged(it->second);
+}
+
+CellValue Sheet::Value(const std::string& name) const
+{
+    auto it = m_ids.find(name);
+    return it == m_ids.end() ? CellValue{0, CellError::Reference} : m_values[it->second];
+}
+
+std::string Sheet::ParseMessage(const std::string& name) const
+{
+    auto it = m_ids.find(name);
+    return it == m_ids.end() ? std::string() : m_cells[it->second].parse_message;
+}
+
+CellValue Sheet::Evaluate(CellId id) const
+{
+    const Cell& cell = m_cells[id];
+    if (!cell.defined) return CellValue{0, CellError::Reference};
+    if (!cell.parse_message.empty()) return CellValue{0, CellError::Parse};
+    if (!cell.formula) return CellValue{cell.number, CellError::None};
+
+    // Small formulas are the common case, keep their arguments off the heap.
+    double              inline_values[8];
+    std::vector<double> heap_values;
+    double*             values = inline_values;
+    if (cell.precedents.size() > 8)
+    {
+        heap_values.resize(cell.precedents.size());
+        values = heap_values.data();
+    }
+    for (size_t i = 0; i < cell.precedents.size(); ++i)
+    {
+        const CellValue& input = m_values[cell.precedents[i]];
+        if (!input.Ok()) return CellValue{0, input.error};
+        values[i] = input.number;
+    }
+    return CellValue{cell.formula->Evaluate(values), CellError::None};
+}
+
+size_t Sheet::Recalculate() { return Recalculate(WorkerPool::Global()); }
+
+size_t Sheet::Recalculate(WorkerPool& pool)
+{
+    if (m_changed.empty()) return 0;
+    const uint32_t epoch = ++m_epoch;
+
+    // Everything reachable from the edits, and only that.
+    std::vector<CellId> affected;
+    affected.reserve(m_changed.size());
+    for (CellId id : m_changed)
+    {
+        m_cells[id].changed = false;
+        if (m_cells[id].epoch == epoch) continue;
+        m_cells[id].epoch = epoch;
+        affected.push_back(id);
+    }
+    m_changed.clear();
+    for (size_t i = 0; i < affected.size(); ++i)
+    {
+        for (CellId dependent : m_cells[affected[i]].dependents)
+        {
+            if (m_cells[dependent].epoch == epoch) continue;
+            m_cells[dependent].epoch = epoch;
+            affected.push_back(dependent);
+        }
+    }
+
+    // Kahn's algorithm restricted to the affected set. Precedents outside of it already hold
+    // their final values, so only edges inside the set count.
+    std::vector<CellId> level;
+    for (CellId id : affected)
+    {
+        uint32_t pending = 0;
+        for (CellId precedent : m_cells[id].precedents) pending += m_cells[precedent].epoch == epoch;
+        m_cells[id].pending = pending;
+        if (pending == 0) level.push_back(id);
+    }
+
+    size_t              evaluated = 0;
+    std::vector<CellId> next;
+    while (!level.empty())
+    {
+        // Cells within a level never depend on each other, so they can be written concurrently.
+        auto evaluate = [this, &level](size_t begin, size_t end) {
+            for (size_t i = begin; i < end; ++i) m_values[level[i]] = Evaluate(level[i]);
+        };
+        if (level.size() >= kParallelThreshold && pool.Size() > 1) pool.ParallelFor(level.size(), kGrain, evaluate);
+        else evaluate(0, level.size());
+        evaluated += level.size();
+
+        next.clear();
+        for (CellId id : level)
+        {
+            for (CellId dependent : m_cells[id].dependents)
+            {
+                // A formula may name the same precedent more than once only via one edge, see
+                // Expression::References(), so each edge is released exactly once.
+                if (m_cells[dependent].epoch == epoch && --m_cells[dependent].pending == 0) next.push_back(dependent);
+            }
+        }
+        level.swap(next);
+    }
+
+    // Whatever is still waiting sits on a cycle or downstream of one.
+    if (evaluated != affected.size())
+    {
+        for (CellId id : affected)
+        {
+            if (m_cells[id].pending != 0) m_values[id] = CellValue{0, CellError::Cycle};
+        }
+    }
+    return evaluated;
+}
+
+} // namespace gomarky
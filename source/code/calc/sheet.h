@@ -0,0 +1,92 @@
+#pragma once
+
+#include "calc/expression.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace gomarky
+{
+
+class WorkerPool;
+
+enum class CellError : uint8_t
+{
+    None,
+    Parse,     ///< the formula did not parse
+    Reference, ///< the cell, or one it depends on, is not defined
+    Cycle,     ///< the cell is part of, or depends on, a reference cycle
+};
+
+struct CellValue
+{
+    double    number = 0;
+    CellError error  = CellError::None;
+
+    bool Ok() const { return error == CellError::None; }
+};
+
+/// Sheet of named cells holding numbers or formulas over other cells.
+///
+/// Edits only record which cells changed; Recalculate() then visits the transitive dependents of
+/// those cells and nothing else, so its cost follows the size of the change rather than the sheet.
+/// Within that set cells are evaluated in dependency levels, each level fanned out over the
+/// worker pool. Referencing a name that has no cell yet creates an undefined placeholder.
+class Sheet
+{
+public:
+    using CellId = uint32_t;
+
+    Sheet();
+    ~Sheet();
+
+    /// Parse errors are not thrown, the cell reports CellError::Parse and ParseMessage().
+    void SetFormula(const std::string& name, const std::string& formula);
+    void SetNumber(const std::string& name, double value);
+    /// Back to undefined; dependents report CellError::Reference.
+    void Remove(const std::string& name);
+
+    /// Value as of the last Recalculate(). Unknown names are CellError::Reference.
+    CellValue   Value(const std::string& name) const;
+    std::string ParseMessage(const std::string& name) const;
+
+    /// Recompute everything affected by edits since the last call. Returns the number of cells
+    /// evaluated.
+    size_t Recalculate();
+    size_t Recalculate(WorkerPool& pool);
+
+    size_t CellCount() const { return m_cells.size(); }
+    size_t PendingChanges() const { return m_changed.size(); }
+
+private:
+    struct Cell
+    {
+        std::string                 name;
+        std::unique_ptr<Expression> formula; ///< null for plain numbers and undefined cells
+        std::string                 parse_message;
+        double                      number  = 0;
+        bool                        defined = false;
+        std::vector<CellId>         precedents; ///< parallel to formula->References()
+        std::vector<CellId>         dependents;
+        uint32_t                    epoch    = 0; ///< last Recalculate() that visited this cell
+        uint32_t                    pending  = 0; ///< unresolved precedents during Recalculate()
+        bool                        changed  = false;
+    };
+
+    CellId    Intern(const std::string& name);
+    void      Unlink(CellId id);
+    void      MarkChanged(CellId id);
+    CellValue Evaluate(CellId id) const;
+
+    std::vector<Cell>                       m_cells;
+    std::vector<CellValue>                  m_values; ///< kept apart so evaluation writes do not share lines with graph data
+    std::unordered_map<std::string, CellId> m_ids;
+    std::vector<CellId>                     m_changed;
+    uint32_t                                m_epoch = 0;
+};
+
+} // namespace gomarky
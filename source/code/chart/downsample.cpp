@@ -0,0 +1,77 @@
+#include "chart/downsample.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace gomarky
+{
+
+namespace
+{
+
+double TriangleArea(const ChartPoint& a, const ChartPoint& b, const ChartPoint& c)
+{
+    return std::abs((a.x - c.x) * (b.y - a.y) - (a.x - b.x) * (c.y - a.y));
+}
+
+} // namespace
+
+DownsampledSeries Downsample(const MinMaxPyramid& series, double x0, double x1, size_t buckets)
+{
+    DownsampledSeries result;
+    if (series.Size() == 0 || buckets == 0 || !(x1 > x0)) return result;
+
+    const size_t first = series.LowerBound(x0);
+    const size_t last  = series.LowerBound(std::nextafter(x1, HUGE_VAL)); // one past the last sample <= x1
+    const size_t begin = first > 0 ? first - 1 : first;
+    const size_t end   = std::min(series.Size(), last + 1);
+
+    if (last - first <= 2 * buckets)
+    {
+        for (size_t i = begin; i < end; ++i) result.line.push_back({series.X(i), series.Y(i)});
+        return result;
+    }
+
+    // Bucket index ranges, from the bucket edges in x.
+    std::vector<size_t> edges(buckets + 1);
+    edges[0]       = first;
+    edges[buckets] = last;
+    const double width = (x1 - x0) / static_cast<double>(buckets);
+    for (size_t b = 1; b < buckets; ++b) edges[b] = series.LowerBound(x0 + width * static_cast<double>(b));
+
+    std::vector<MinMaxPyramid::Summary> summaries(buckets);
+    for (size_t b = 0; b < buckets; ++b) summaries[b] = series.Summarize(edges[b], edges[b + 1]);
+
+    result.bands.reserve(buckets);
+    result.line.reserve(buckets + 2);
+    if (begin < first) result.line.push_back({series.X(begin), series.Y(begin)});
+
+    ChartPoint previous = {series.X(first), series.Y(first)};
+    result.line.push_back(previous);
+    for (size_t b = 0; b < buckets; ++b)
+    {
+        const auto& summary = summaries[b];
+        if (summary.count == 0) continue;
+        result.bands.push_back({x0 + width * (static_cast<double>(b) + 0.5), summary.min, summary.max});
+
+        // LTTB's third vertex is the average of the next non-empty bucket.
+        ChartPoint next = {series.X(last - 1), series.Y(last - 1)};
+        for (size_t n = b + 1; n < buckets; ++n)
+        {
+            if (summaries[n].count == 0) continue;
+            const size_t mid = (edges[n] + edges[n + 1]) / 2;
+            next             = {series.X(mid), summaries[n].sum / static_cast<double>(summaries[n].count)};
+            break;
+        }
+
+        const ChartPoint low  = {series.X(summary.argmin), summary.min};
+        const ChartPoint high = {series.X(summary.argmax), summary.max};
+        previous = TriangleArea(previous, low, next) >= TriangleArea(previous, high, next) ? low : high;
+        result.line.push_back(previous);
+    }
+    result.line.push_back({series.X(last - 1), series.Y(last - 1)});
+    if (end > last) result.line.push_back({series.X(last), series.Y(last)});
+    return result;
+}
+
+} // namespace gomarky
@@ -0,0 +1,40 @@
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+#include "chart/minmax_pyramid.h"
+
+namespace gomarky
+{
+
+struct ChartPoint
+{
+    double x;
+    double y;
+};
+
+/// Vertical extent of the samples falling into one output bucket (one pixel column).
+struct ChartBand
+{
+    double x;
+    double min;
+    double max;
+};
+
+struct DownsampledSeries
+{
+    std::vector<ChartPoint> line;  ///< points to connect, in x order
+    std::vector<ChartBand>  bands; ///< per-bucket extents, empty when `line` holds raw samples
+};
+
+/// Reduce the samples with x in [x0, x1] to about `buckets` points.
+///
+/// When the range holds few enough samples they are returned as-is (plus one neighbour on each
+/// side so the line leaves the viewport correctly). Otherwise the range is cut into `buckets`
+/// equal-width buckets and Largest-Triangle-Three-Buckets picks one point per bucket, choosing
+/// between the bucket's min and max sample so spikes survive. Bucket extremes and averages come
+/// from the pyramid, so the cost depends on `buckets`, not on how many samples are visible.
+DownsampledSeries Downsample(const MinMaxPyramid& series, double x0, double x1, size_t buckets);
+
+} // namespace gomarky
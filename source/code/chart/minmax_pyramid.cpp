@@ -0,0 +1,128 @@
+#include "chart/minmax_pyramid.h"
+
+#include <algorithm>
+
+namespace gomarky
+{
+
+constexpr size_t MinMaxPyramid::kFanout;
+
+void MinMaxPyramid::Fold(Summary& node, double y, size_t index)
+{
+    if (node.count == 0 || y < node.min)
+    {
+        node.min    = y;
+        node.argmin = index;
+    }
+    if (node.count == 0 || y > node.max)
+    {
+        node.max    = y;
+        node.argmax = index;
+    }
+    node.sum += y;
+    ++node.count;
+}
+
+void MinMaxPyramid::Merge(Summary& into, const Summary& from)
+{
+    if (from.count == 0) return;
+    if (into.count == 0)
+    {
+        into = from;
+        return;
+    }
+    if (from.min < into.min)
+    {
+        into.min    = from.min;
+        into.argmin = from.argmin;
+    }
+    if (from.max > into.max)
+    {
+        into.max    = from.max;
+        into.argmax = from.argmax;
+    }
+    into.sum += from.sum;
+    into.count += from.count;
+}
+
+void MinMaxPyramid::Append(double x, double y)
+{
+    const size_t index = m_x.size();
+    m_x.push_back(x);
+    m_y.push_back(y);
+
+    // Level L exists once level L-1 has more than one node; `span` is the size of a level L-1 node.
+    size_t span = 1;
+    for (size_t level = 1; index >= span; ++level, span *= kFanout)
+    {
+        if (level > m_levels.size())
+        {
+            // The new level's first node starts out covering everything before this sample, which
+            // is exactly the first node one level down.
+            m_levels.emplace_back(1);
+            Summary& first = m_levels.back()[0];
+            if (level == 1) Fold(first, m_y[0], 0);
+            else first = m_levels[level - 2][0];
+        }
+        auto&        nodes = m_levels[level - 1];
+        const size_t node  = index / (span * kFanout);
+        if (node == nodes.size()) nodes.emplace_back();
+        Fold(nodes[node], y, index);
+    }
+}
+
+void MinMaxPyramid::Reserve(size_t samples)
+{
+    m_x.reserve(samples);
+    m_y.reserve(samples);
+}
+
+void MinMaxPyramid::Clear()
+{
+    m_x.clear();
+    m_y.clear();
+    m_levels.clear();
+}
+
+size_t MinMaxPyramid::LowerBound(double x) const
+{
+    return static_cast<size_t>(std::lower_bound(m_x.begin(), m_x.end(), x) - m_x.begin());
+}
+
+MinMaxPyramid::Summary MinMaxPyramid::Summarize(size_t begin, size_t end) const
+{
+    Summary result;
+    end = std::min(end, m_x.size());
+    if (begin >= end) return result;
+
+    // Peel the unaligned edges at each level and climb with what is left, like a segment tree.
+    size_t lo = begin, hi = end;
+    for (size_t level = 0;; ++level)
+    {
+        auto visit = [&](size_t i) {
+            if (level == 0) Fold(result, m_y[i], i);
+            else Merge(result, m_levels[level - 1][i]);
+        };
+        const bool top = level == m_levels.size();
+        if (top || hi - lo < 2 * kFanout)
+        {
+            for (size_t i = lo; i < hi; ++i) visit(i);
+            break;
+        }
+        while (lo < hi && lo % kFanout != 0) visit(lo++);
+        while (lo < hi && hi % kFanout != 0) visit(--hi);
+        if (lo == hi) break;
+        lo /= kFanout;
+        hi /= kFanout;
+    }
+    return result;
+}
+
+size_t MinMaxPyramid::MemoryUsage() const
+{
+    size_t bytes = (m_x.capacity() + m_y.capacity()) * sizeof(double);
+    for (const auto& level : m_levels) bytes += level.capacity() * sizeof(Summary);
+    return bytes;
+}
+
+} // namespace gomarky
@@ -0,0 +1,55 @@
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+namespace gomarky
+{
+
+/// Append-only time series with a multi-resolution min/max/sum summary.
+///
+/// Level 0 is the raw samples, every node of level L+1 summarizes kFanout nodes of level L.
+/// Appending folds the new sample into one node per level, so it costs O(levels), and any index
+/// range can be summarized in O(kFanout * levels) regardless of its length.
+class MinMaxPyramid
+{
+public:
+    static constexpr size_t kFanout = 8;
+
+    struct Summary
+    {
+        double min    = 0;
+        double max    = 0;
+        double sum    = 0;
+        size_t count  = 0;
+        size_t argmin = 0; ///< sample index of `min`
+        size_t argmax = 0; ///< sample index of `max`
+    };
+
+    /// `x` must not decrease from one sample to the next.
+    void Append(double x, double y);
+    void Reserve(size_t samples);
+    void Clear();
+
+    size_t Size() const { return m_x.size(); }
+    double X(size_t index) const { return m_x[index]; }
+    double Y(size_t index) const { return m_y[index]; }
+
+    /// First sample index with X >= x.
+    size_t LowerBound(double x) const;
+
+    /// Summary of samples [begin, end). `count` is 0 for an empty range.
+    Summary Summarize(size_t begin, size_t end) const;
+
+    size_t MemoryUsage() const;
+
+private:
+    static void Fold(Summary& node, double y, size_t index);
+    static void Merge(Summary& into, const Summary& from);
+
+    std::vector<double>               m_x;
+    std::vector<double>               m_y;
+    std::vector<std::vector<Summary>> m_levels; ///< m_levels[0] is level 1
+};
+
+} // namespace gomarky
@@ -0,0 +1,250 @@
+#include "chart/time_series_chart.h"
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+#include <QElapsedTimer>
+#include <QMouseEvent>
+#include <QPaintEvent>
+#include <QPainter>
+#include <QResizeEvent>
+#include <QWheelEvent>
+
+#include "chart/downsample.h"
+
+namespace gomarky
+{
+
+namespace
+{
+
+// Appends are painted at most this often.
+constexpr int kFrameMilliseconds = 16;
+
+QPointF EventPosition(const QWheelEvent* event)
+{
+#if QT_VERSION >= QT_VERSION_CHECK(5, 14, 0)
+    return event->position();
+#else
+    return event->posF();
+#endif
+}
+
+QPointF EventPosition(const QMouseEvent* event)
+{
+#if QT_VERSION >= QT_VERSION_CHECK(6, 0, 0)
+    return event->position();
+#else
+    return event->localPos();
+#endif
+}
+
+} // namespace
+
+TimeSeriesChart::TimeSeriesChart(QWidget* parent) : QWidget(parent)
+{
+    // We paint every pixel of the dirty region ourselves.
+    setAttribute(Qt::WA_OpaquePaintEvent);
+    setMinimumSize(200, 100);
+
+    m_frame.setSingleShot(true);
+    m_frame.setInterval(kFrameMilliseconds);
+    QObject::connect(&m_frame, &QTimer::timeout, [this] { Flush(); });
+}
+
+void TimeSeriesChart::Append(double x, double y)
+{
+    const bool   first    = m_series.Size() == 0;
+    const double previous = first ? x : m_series.X(m_series.Size() - 1);
+    m_series.Append(x, y);
+
+    if (m_follow_tail && first)
+    {
+        m_x1 = x;
+        m_x0 = x - 1.0;
+        UpdateVerticalRange();
+        RepaintAll();
+        return;
+    }
+    if (m_follow_tail && x > m_x1)
+    {
+        // Advance by whole pixel columns: the bucket edges stay where they were on screen, so the
+        // columns already painted are still right after a scroll.
+        const double column  = (m_x1 - m_x0) / std::max(1, width());
+        const double columns = std::ceil((x - m_x1) / column);
+        m_x0 += columns * column;
+        m_x1 += columns * column;
+        m_frame_scroll = static_cast<int>(std::min<double>(m_frame_scroll + columns, width()));
+    }
+    else if (x < m_x0 || previous > m_x1)
+    {
+        return;
+    }
+
+    // Only the columns between the previous last sample and this one changed.
+    m_frame_all     = UpdateVerticalRange() || m_frame_all;
+    m_frame_dirty_0 = std::min(m_frame_dirty_0, previous);
+    m_frame_dirty_1 = std::max(m_frame_dirty_1, x);
+    if (!m_frame.isActive()) m_frame.start();
+}
+
+void TimeSeriesChart::Flush()
+{
+    if (m_frame_all || m_frame_scroll >= width())
+    {
+        RepaintAll();
+        return;
+    }
+    if (m_frame_scroll > 0) scroll(-m_frame_scroll, 0);
+    if (m_frame_dirty_0 <= m_frame_dirty_1)
+    {
+        const int left  = static_cast<int>(std::floor(XToPixel(m_frame_dirty_0))) - 1;
+        const int right = static_cast<int>(std::ceil(XToPixel(m_frame_dirty_1))) + 1;
+        update(QRect(left, 0, right - left + 1, height()));
+    }
+    m_frame_scroll  = 0;
+    m_frame_dirty_0 = HUGE_VAL;
+    m_frame_dirty_1 = -HUGE_VAL;
+}
+
+void TimeSeriesChart::RepaintAll()
+{
+    m_frame.stop();
+    m_frame_all     = false;
+    m_frame_scroll  = 0;
+    m_frame_dirty_0 = HUGE_VAL;
+    m_frame_dirty_1 = -HUGE_VAL;
+    update();
+}
+
+void TimeSeriesChart::SetVisibleRange(double x0, double x1)
+{
+    if (!(x1 > x0)) return;
+    m_x0 = x0;
+    m_x1 = x1;
+    UpdateVerticalRange();
+    RepaintAll();
+}
+
+void TimeSeriesChart::SetFollowTail(bool follow)
+{
+    m_follow_tail = follow;
+    if (follow && m_series.Size() > 0)
+    {
+        const double last = m_series.X(m_series.Size() - 1);
+        SetVisibleRange(last - (m_x1 - m_x0), last);
+    }
+}
+
+bool TimeSeriesChart::UpdateVerticalRange()
+{
+    const size_t begin   = m_series.LowerBound(m_x0);
+    const size_t end     = m_series.LowerBound(std::nextafter(m_x1, HUGE_VAL));
+    const auto   summary = m_series.Summarize(begin > 0 ? begin - 1 : 0, std::min(m_series.Size(), end + 1));
+    if (summary.count == 0) return false;
+
+    double y_min = summary.min, y_max = summary.max;
+    if (y_max - y_min < 1e-12)
+    {
+        y_min -= 0.5;
+        y_max += 0.5;
+    }
+    const double margin = (y_max - y_min) * 0.05;
+    y_min -= margin;
+    y_max += margin;
+
+    // Hysteresis: only rescale when the data leaves the current range or uses less than half of it,
+    // so a live stream does not force full repaints on every sample.
+    const bool outside = y_min < m_y_min || y_max > m_y_max;
+    const bool loose   = (y_max - y_min) < 0.5 * (m_y_max - m_y_min);
+    if (!outside && !loose) return false;
+    m_y_min = y_min;
+    m_y_max = y_max;
+    return true;
+}
+
+double TimeSeriesChart::XToPixel(double x) const { return (x - m_x0) / (m_x1 - m_x0) * width(); }
+
+double TimeSeriesChart::PixelToX(double pixel) const { return m_x0 + pixel / width() * (m_x1 - m_x0); }
+
+double TimeSeriesChart::YToPixel(double y) const
+{
+    return (m_y_max - y) / (m_y_max - m_y_min) * (height() - 1);
+}
+
+void TimeSeriesChart::paintEvent(QPaintEvent* event)
+{
+    QElapsedTimer timer;
+    timer.start();
+
+    const QRect dirty = event->rect();
+    QPainter    painter(this);
+    painter.fillRect(dirty, palette().base());
+    painter.setClipRect(dirty);
+
+    // Downsample exactly the dirty columns, with bucket edges on pixel boundaries so a partial
+    // repaint produces the same pixels as a full one.
+    const int left    = std::max(0, dirty.left() - 1);
+    const int right   = std::min(width(), dirty.right() + 2);
+    const auto series = Downsample(m_series, PixelToX(left), PixelToX(right), static_cast<size_t>(right - left));
+
+    painter.setPen(QPen(palette().color(QPalette::Highlight).lighter(150), 1));
+    std::vector<QLineF> bands;
+    bands.reserve(series.bands.size());
+    for (const auto& band : series.bands)
+    {
+        const double x = XToPixel(band.x);
+        bands.emplace_back(x, YToPixel(band.min), x, YToPixel(band.max));
+    }
+    painter.drawLines(bands.data(), static_cast<int>(bands.size()));
+
+    painter.setPen(QPen(palette().color(QPalette::Highlight), 1));
+    std::vector<QPointF> line;
+    line.reserve(series.line.size());
+    for (const auto& point : series.line) line.emplace_back(XToPixel(point.x), YToPixel(point.y));
+    painter.drawPolyline(line.data(), static_cast<int>(line.size()));
+
+    m_last_paint_ms = timer.nsecsElapsed() / 1e6;
+}
+
+void TimeSeriesChart::wheelEvent(QWheelEvent* event)
+{
+    const double factor = std::pow(0.999, event->angleDelta().y());
+    const double anchor = PixelToX(EventPosition(event).x());
+    m_follow_tail       = false;
+    SetVisibleRange(anchor - (anchor - m_x0) * factor, anchor + (m_x1 - anchor) * factor);
+    event->accept();
+}
+
+void TimeSeriesChart::mousePressEvent(QMouseEvent* event)
+{
+    if (event->button() != Qt::LeftButton) return QWidget::mousePressEvent(event);
+    m_dragging    = true;
+    m_drag_origin = EventPosition(event);
+}
+
+void TimeSeriesChart::mouseMoveEvent(QMouseEvent* event)
+{
+    if (!m_dragging) return QWidget::mouseMoveEvent(event);
+    const QPointF position = EventPosition(event);
+    const double  shift    = (position.x() - m_drag_origin.x()) / double(width()) * (m_x1 - m_x0);
+    m_drag_origin          = position;
+    m_follow_tail          = false;
+    SetVisibleRange(m_x0 - shift, m_x1 - shift);
+}
+
+void TimeSeriesChart::mouseReleaseEvent(QMouseEvent* event)
+{
+    if (event->button() != Qt::LeftButton) return QWidget::mouseReleaseEvent(event);
+    m_dragging = false;
+}
+
+void TimeSeriesChart::resizeEvent(QResizeEvent* event)
+{
+    // Columns collected for the next frame were measured at the old width.
+    RepaintAll();
+    QWidget::resizeEvent(event);
+}
+
+} // namespace gomarky
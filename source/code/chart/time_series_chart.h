@@ -0,0 +1,81 @@
+#pragma once
+
+#include <cmath>
+#include <cstddef>
+
+#include <QPointF>
+#include <QTimer>
+#include <QWidget>
+
+#include "chart/minmax_pyramid.h"
+
+namespace gomarky
+{
+
+/// Line chart for long metric streams.
+///
+/// Samples are kept in a MinMaxPyramid and every paint downsamples the visible range to one
+/// bucket per pixel column, so zooming and panning cost the same at any level. Appends are painted
+/// at most once per frame and only repaint the columns they touch; following the tail advances the
+/// view by whole pixel columns, so the pixels already on screen are scrolled rather than repainted.
+/// Mouse wheel zooms around the cursor, dragging pans; panning or zooming stops following the tail.
+class TimeSeriesChart : public QWidget
+{
+    Q_OBJECT
+
+public:
+    explicit TimeSeriesChart(QWidget* parent = nullptr);
+
+    /// `x` must not decrease between calls.
+    void Append(double x, double y);
+
+    void SetVisibleRange(double x0, double x1);
+
+    /// Keep the newest sample at the right edge, with the current visible width.
+    void SetFollowTail(bool follow);
+
+    const MinMaxPyramid& Series() const { return m_series; }
+
+    /// Wall time of the last paintEvent, for frame budget checks.
+    double LastPaintMilliseconds() const { return m_last_paint_ms; }
+
+protected:
+    void paintEvent(QPaintEvent* event) override;
+    void wheelEvent(QWheelEvent* event) override;
+    void mousePressEvent(QMouseEvent* event) override;
+    void mouseMoveEvent(QMouseEvent* event) override;
+    void mouseReleaseEvent(QMouseEvent* event) override;
+    void resizeEvent(QResizeEvent* event) override;
+
+private:
+    double XToPixel(double x) const;
+    double PixelToX(double pixel) const;
+    double YToPixel(double y) const;
+
+    /// Fit the vertical scale to the visible samples; returns true when it changed.
+    bool UpdateVerticalRange();
+
+    /// Repaint everything now and drop what was collected for the next frame.
+    void RepaintAll();
+    /// Paint what the appends since the last frame changed.
+    void Flush();
+
+    MinMaxPyramid m_series;
+    double        m_x0            = 0;
+    double        m_x1            = 1;
+    double        m_y_min         = 0;
+    double        m_y_max         = 1;
+    bool          m_follow_tail   = true;
+    bool          m_dragging      = false;
+    QPointF       m_drag_origin;
+    double        m_last_paint_ms = 0;
+
+    // Changes collected for the next frame.
+    QTimer m_frame;
+    bool   m_frame_all     = false;    ///< everything must be repainted
+    int    m_frame_scroll  = 0;        ///< pixel columns the view advanced by
+    double m_frame_dirty_0 = HUGE_VAL; ///< x range whose columns must be repainted
+    double m_frame_dirty_1 = -HUGE_VAL;
+};
+
+} // namespace gomarky
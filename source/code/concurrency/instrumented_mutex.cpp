@@ -0,0 +1,178 @@
+#include "concurrency/instrumented_mutex.h"
+
+#include "metrics/metrics_registry.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <map>
+
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+#include <intrin.h>
+#define GM_LOCK_TSC 1
+#elif defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#include <x86intrin.h>
+#define GM_LOCK_TSC 1
+#else
+#define GM_LOCK_TSC 0
+#endif
+
+namespace gomarky
+{
+
+constexpr uint64_t LockSite::kHoldSampleInterval;
+
+namespace
+{
+
+std::atomic<LockSite*> g_sites{nullptr};
+
+using Clock = std::chrono::steady_clock;
+
+// The tick rate is measured against the steady clock between the first site registration and
+// the first report, which is long enough apart in practice; short runs spin up to 10 ms.
+struct Calibration
+{
+    Clock::time_point time  = Clock::now();
+    uint64_t          ticks = LockProfiler::Ticks();
+};
+
+const Calibration& Anchor()
+{
+    static const Calibration anchor;
+    return anchor;
+}
+
+double NanosecondsPerTick()
+{
+#if GM_LOCK_TSC
+    const Calibration& anchor = Anchor();
+    Clock::time_point  now    = Clock::now();
+    while (now - anchor.time < std::chrono::milliseconds(10)) now = Clock::now();
+    const uint64_t ticks = LockProfiler::Ticks() - anchor.ticks;
+    const double   ns    = std::chrono::duration<double, std::nano>(now - anchor.time).count();
+    return ticks ? ns / double(ticks) : 1.0;
+#else
+    return 1.0;
+#endif
+}
+
+} // namespace
+
+LockSite::LockSite(const char* name, const char* file, int line)
+    : m_name(name), m_file(file), m_line(line)
+{
+    LockProfiler::Register(*this);
+}
+
+LockSite& LockSite::Unattributed()
+{
+    static LockSite site("unattributed", "", 0);
+    return site;
+}
+
+uint64_t LockProfiler::Ticks()
+{
+#if GM_LOCK_TSC
+    return __rdtsc();
+#else
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now().time_since_epoch()).count());
+#endif
+}
+
+void LockProfiler::Register(LockSite& site)
+{
+    Anchor();
+    LockSite* head = g_sites.load(std::memory_order_relaxed);
+    do
+    {
+        site.m_next = head;
+    } while (!g_sites.compare_exchange_weak(head, &site, std::memory_order_release, std::memory_order_relaxed));
+}
+
+std::vector<LockProfiler::SiteReport> LockProfiler::Report()
+{
+    const double            ns_per_tick = NanosecondsPerTick();
+    std::vector<SiteReport> reports;
+    for (LockSite* site = g_sites.load(std::memory_order_acquire); site; site = site->m_next)
+    {
+        const uint64_t acquisitions = site->m_acquisitions.load(std::memory_order_relaxed);
+        if (!acquisitions) continue;
+        const uint64_t samples = site->m_hold_samples.load(std::memory_order_relaxed);
+        SiteReport     report;
+        report.name         = site->m_name;
+        report.file         = site->m_file;
+        report.line         = site->m_line;
+        report.acquisitions = acquisitions;
+        report.contended    = site->m_contended.load(std::memory_order_relaxed);
+        report.wait_ns      = double(site->m_wait_ticks.load(std::memory_order_relaxed)) * ns_per_tick;
+        report.mean_hold_ns = samples ? double(site->m_hold_ticks.load(std::memory_order_relaxed)) * ns_per_tick /
+                                            double(samples)
+                                      : 0.0;
+        reports.push_back(report);
+    }
+    std::stable_sort(reports.begin(), reports.end(), [](const SiteReport& a, const SiteReport& b) {
+        return a.wait_ns != b.wait_ns ? a.wait_ns > b.wait_ns : a.contended > b.contended;
+    });
+    return reports;
+}
+
+std::string LockProfiler::Format(size_t top)
+{
+    std::string out;
+    char        line[512];
+    for (const auto& report : Report())
+    {
+        if (top-- == 0 || !report.contended) break;
+        std::snprintf(line, sizeof(line),
+                      "%s (%s:%d): %llu of %llu acquisitions contended, %.3f ms waited, %.0f ns mean hold\n",
+                      report.name.c_str(), report.file.c_str(), report.line,
+                      static_cast<unsigned long long>(report.contended),
+                      static_cast<unsigned long long>(report.acquisitions), report.wait_ns / 1e6, report.mean_hold_ns);
+        out += line;
+    }
+    return out;
+}
+
+void LockProfiler::Publish(MetricsRegistry& registry)
+{
+    struct Totals
+    {
+        uint64_t acquisitions = 0;
+        uint64_t contended    = 0;
+        double   wait_ns      = 0;
+        double   hold_ns      = 0; ///< mean hold weighted by acquisitions
+    };
+    std::map<std::string, Totals> totals;
+    for (const auto& report : Report())
+    {
+        Totals& total = totals[report.name];
+        total.acquisitions += report.acquisitions;
+        total.contended += report.contended;
+        total.wait_ns += report.wait_ns;
+        total.hold_ns += report.mean_hold_ns * double(report.acquisitions);
+    }
+    for (const auto& entry : totals)
+    {
+        const std::string prefix = "lock." + entry.first;
+        const Totals&     total  = entry.second;
+        registry.GetGauge(prefix + ".acquisitions").Set(static_cast<int64_t>(total.acquisitions));
+        registry.GetGauge(prefix + ".contended").Set(static_cast<int64_t>(total.contended));
+        registry.GetGauge(prefix + ".wait_ns").Set(static_cast<int64_t>(total.wait_ns));
+        registry.GetGauge(prefix + ".mean_hold_ns").Set(static_cast<int64_t>(total.hold_ns / double(total.acquisitions)));
+    }
+}
+
+void LockProfiler::Reset()
+{
+    for (LockSite* site = g_sites.load(std::memory_order_acquire); site; site = site->m_next)
+    {
+        site->m_acquisitions.store(0, std::memory_order_relaxed);
+        site->m_contended.store(0, std::memory_order_relaxed);
+        site->m_wait_ticks.store(0, std::memory_order_relaxed);
+        site->m_hold_ticks.store(0, std::memory_order_relaxed);
+        site->m_hold_samples.store(0, std::memory_order_relaxed);
+    }
+}
+
+} // namespace gomarky
@@ -0,0 +1,227 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <shared_mutex>
+#include <string>
+#include <vector>
+
+namespace gomarky
+{
+
+class MetricsRegistry;
+
+/// Contention statistics of one place locks are taken from. Sites live in static storage (see
+/// GM_LOCK_SITE) and register themselves in a process-wide list the first time they are used.
+class LockSite
+{
+public:
+    /// Every 64th acquisition of a site also measures how long the lock is held.
+    static constexpr uint64_t kHoldSampleInterval = 64;
+
+    LockSite(const char* name, const char* file, int line);
+
+    LockSite(const LockSite&) = delete;
+    LockSite& operator=(const LockSite&) = delete;
+
+    /// Where plain lock() calls on a mutex constructed without a site are counted.
+    static LockSite& Unattributed();
+
+    const char* Name() const { return m_name; }
+    const char* File() const { return m_file; }
+    int         Line() const { return m_line; }
+
+private:
+    friend class LockProfiler;
+
+    const char* m_name;
+    const char* m_file;
+    int         m_line;
+    LockSite*   m_next = nullptr;
+
+    std::atomic<uint64_t> m_acquisitions{0};
+    std::atomic<uint64_t> m_contended{0};
+    std::atomic<uint64_t> m_wait_ticks{0};
+    std::atomic<uint64_t> m_hold_ticks{0};
+    std::atomic<uint64_t> m_hold_samples{0};
+};
+
+/// A static LockSite for this line, e.g. `GM_LOCK_SITE("sheet.cells")`.
+#define GM_LOCK_SITE(name)                                                                        \
+    ([]() -> ::gomarky::LockSite& {                                                               \
+        static ::gomarky::LockSite gm_lock_site(name, __FILE__, __LINE__);                        \
+        return gm_lock_site;                                                                      \
+    }())
+
+/// Reads and reports the statistics of every LockSite.
+class LockProfiler
+{
+public:
+    struct SiteReport
+    {
+        std::string name;
+        std::string file;
+        int         line;
+        uint64_t    acquisitions;
+        uint64_t    contended;
+        double      wait_ns;      ///< total over all contended acquisitions
+        double      mean_hold_ns; ///< from the sampled acquisitions, 0 if none was sampled
+    };
+
+    /// Sites that were acquired at least once, most total wait first.
+    static std::vector<SiteReport> Report();
+
+    /// One line per site for the `top` sites with the most wait, "" when none was contended.
+    static std::string Format(size_t top = 10);
+
+    /// Gauges "lock.<name>.acquisitions", ".contended", ".wait_ns" and ".mean_hold_ns".
+    /// Sites sharing a name are summed.
+    static void Publish(MetricsRegistry& registry);
+
+    /// Zero every site's statistics.
+    static void Reset();
+
+    // Used by the mutex wrappers.
+    static uint64_t Ticks();
+    static void     Register(LockSite& site);
+
+    /// Count an acquisition of `site` that waited `wait_ticks` (0 when it did not wait).
+    /// Returns true when the hold time of this acquisition should be measured.
+    static bool Acquired(LockSite& site, bool contended, uint64_t wait_ticks)
+    {
+        const uint64_t count = site.m_acquisitions.fetch_add(1, std::memory_order_relaxed);
+        if (contended)
+        {
+            site.m_contended.fetch_add(1, std::memory_order_relaxed);
+            site.m_wait_ticks.fetch_add(wait_ticks, std::memory_order_relaxed);
+        }
+        return count % LockSite::kHoldSampleInterval == 0;
+    }
+
+    static void Held(LockSite& site, uint64_t hold_ticks)
+    {
+        site.m_hold_ticks.fetch_add(hold_ticks, std::memory_order_relaxed);
+        site.m_hold_samples.fetch_add(1, std::memory_order_relaxed);
+    }
+};
+
+/// Exclusive locking of `Mutex` that counts acquisitions, contended acquisitions, the time spent
+/// waiting and (sampled) the time the lock is held.
+///
+/// Uncontended acquisitions cost a try_lock and one relaxed increment; only acquisitions that
+/// have to wait read the time stamp counter. Statistics go to the site given to lock(), or to the
+/// mutex's own site for plain lock() calls such as those made by std::lock_guard.
+template<typename Mutex>
+class BasicInstrumentedMutex
+{
+public:
+    BasicInstrumentedMutex()
+        : m_site(LockSite::Unattributed())
+    {
+    }
+    explicit BasicInstrumentedMutex(LockSite& site)
+        : m_site(site)
+    {
+    }
+
+    BasicInstrumentedMutex(const BasicInstrumentedMutex&) = delete;
+    BasicInstrumentedMutex& operator=(const BasicInstrumentedMutex&) = delete;
+
+    void lock() { lock(m_site); }
+    void lock(LockSite& site)
+    {
+        uint64_t   wait      = 0;
+        const bool contended = !m_mutex.try_lock();
+        if (contended)
+        {
+            const uint64_t start = LockProfiler::Ticks();
+            m_mutex.lock();
+            wait = LockProfiler::Ticks() - start;
+        }
+        Hold(site, contended, wait);
+    }
+
+    bool try_lock()
+    {
+        if (!m_mutex.try_lock()) return false;
+        Hold(m_site, false, 0);
+        return true;
+    }
+
+    void unlock()
+    {
+        if (m_hold_start) LockProfiler::Held(*m_holder, LockProfiler::Ticks() - m_hold_start);
+        m_mutex.unlock();
+    }
+
+protected:
+    Mutex     m_mutex;
+    LockSite& m_site;
+
+private:
+    void Hold(LockSite& site, bool contended, uint64_t wait)
+    {
+        m_holder     = &site;
+        m_hold_start = LockProfiler::Acquired(site, contended, wait) ? LockProfiler::Ticks() : 0;
+    }
+
+    LockSite* m_holder     = nullptr; ///< written and read only by the thread holding m_mutex
+    uint64_t  m_hold_start = 0;
+};
+
+/// Drop-in replacement for std::mutex.
+using InstrumentedMutex = BasicInstrumentedMutex<std::mutex>;
+
+/// Drop-in replacement for std::shared_timed_mutex, the shared mutex of C++14. Shared holds are
+/// not timed since many threads hold them at once, but their waits are counted.
+class InstrumentedSharedMutex : public BasicInstrumentedMutex<std::shared_timed_mutex>
+{
+public:
+    using BasicInstrumentedMutex::BasicInstrumentedMutex;
+
+    void lock_shared() { lock_shared(m_site); }
+    void lock_shared(LockSite& site)
+    {
+        uint64_t   wait      = 0;
+        const bool contended = !m_mutex.try_lock_shared();
+        if (contended)
+        {
+            const uint64_t start = LockProfiler::Ticks();
+            m_mutex.lock_shared();
+            wait = LockProfiler::Ticks() - start;
+        }
+        LockProfiler::Acquired(site, contended, wait);
+    }
+
+    bool try_lock_shared()
+    {
+        if (!m_mutex.try_lock_shared()) return false;
+        LockProfiler::Acquired(m_site, false, 0);
+        return true;
+    }
+
+    void unlock_shared() { m_mutex.unlock_shared(); }
+};
+
+/// std::lock_guard that attributes the acquisition to `site`:
+/// `SiteLockGuard<InstrumentedMutex> lock(m_mutex, GM_LOCK_SITE("pool.post"));`
+template<typename Mutex>
+class SiteLockGuard
+{
+public:
+    SiteLockGuard(Mutex& mutex, LockSite& site)
+        : m_mutex(mutex)
+    {
+        m_mutex.lock(site);
+    }
+    ~SiteLockGuard() { m_mutex.unlock(); }
+
+    SiteLockGuard(const SiteLockGuard&) = delete;
+    SiteLockGuard& operator=(const SiteLockGuard&) = delete;
+
+private:
+    Mutex& m_mutex;
+};
+
+} // namespace gomarky
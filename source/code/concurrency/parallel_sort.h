@@ -0,0 +1,107 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <vector>
+
+#include "concurrency/worker_pool.h"
+
+namespace gomarky
+{
+
+namespace detail
+{
+
+// One independent slice of a merge pass: merge [a, a_end) with [b, b_end) into `out`.
+template<typename T>
+struct MergeSlice
+{
+    const T* a;
+    const T* a_end;
+    const T* b;
+    const T* b_end;
+    T*       out;
+};
+
+// Split the merge of two sorted runs into `pieces` slices that can be merged independently.
+// Split points are taken evenly in the left run and located in the right run with lower_bound,
+// which keeps equal elements from the left run first and the result stable.
+template<typename T, typename Compare>
+void SplitMerge(const T* a, const T* a_end, const T* b, const T* b_end, T* out, size_t pieces,
+                Compare& comp, std::vector<MergeSlice<T>>& slices)
+{
+    const size_t a_size = static_cast<size_t>(a_end - a);
+    pieces              = std::max<size_t>(1, std::min(pieces, a_size));
+    const T* prev_a     = a;
+    const T* prev_b     = b;
+    for (size_t k = 1; k <= pieces; ++k)
+    {
+        const T* next_a = k == pieces ? a_end : a + a_size * k / pieces;
+        const T* next_b = k == pieces ? b_end : std::lower_bound(prev_b, b_end, *next_a, comp);
+        slices.push_back({prev_a, next_a, prev_b, next_b, out + (prev_a - a) + (prev_b - b)});
+        prev_a = next_a;
+        prev_b = next_b;
+    }
+}
+
+} // namespace detail
+
+/// Stable merge sort that sorts runs on the pool and then merges them pairwise, splitting the
+/// last few (large) merges into independent slices so that every worker stays busy.
+/// Falls back to std::stable_sort with a single worker or fewer than 2 * `min_run` items.
+/// `comp` runs on several threads at once, so it must be safe to call concurrently, and it must
+/// be a strict weak ordering or the merges lose their guarantees.
+template<typename T, typename Compare>
+void ParallelStableSort(std::vector<T>& data, Compare comp, WorkerPool& pool, size_t min_run = 1 << 14)
+{
+    const size_t size    = data.size();
+    const size_t workers = pool.Size();
+    if (workers <= 1 || size < 2 * min_run)
+    {
+        std::stable_sort(data.begin(), data.end(), comp);
+        return;
+    }
+
+    size_t runs = 1;
+    while (runs < 2 * workers && size / (runs * 2) >= min_run) runs *= 2;
+
+    std::vector<size_t> bounds(runs + 1);
+    for (size_t r = 0; r <= runs; ++r) bounds[r] = size * r / runs;
+
+    pool.ParallelFor(runs, 1, [&](size_t begin, size_t end) {
+        for (size_t r = begin; r < end; ++r)
+        {
+            std::stable_sort(data.begin() + bounds[r], data.begin() + bounds[r + 1], comp);
+        }
+    });
+
+    std::vector<T> buffer(size);
+    T*             src = data.data();
+    T*             dst = buffer.data();
+    std::vector<detail::MergeSlice<T>> slices;
+    while (runs > 1)
+    {
+        const size_t pairs  = runs / 2;
+        const size_t pieces = std::max<size_t>(1, workers / pairs);
+        slices.clear();
+        for (size_t p = 0; p < pairs; ++p)
+        {
+            const size_t lo = bounds[2 * p], mid = bounds[2 * p + 1], hi = bounds[2 * p + 2];
+            detail::SplitMerge<T>(src + lo, src + mid, src + mid, src + hi, dst + lo, pieces, comp,
+                                  slices);
+        }
+        pool.ParallelFor(slices.size(), 1, [&](size_t begin, size_t end) {
+            for (size_t s = begin; s < end; ++s)
+            {
+                const auto& slice = slices[s];
+                std::merge(slice.a, slice.a_end, slice.b, slice.b_end, slice.out, comp);
+            }
+        });
+        for (size_t p = 0; p <= pairs; ++p) bounds[p] = bounds[2 * p];
+        runs = pairs;
+        std::swap(src, dst);
+    }
+    if (src != data.data()) data.swap(buffer);
+}
+
+} // namespace gomarky
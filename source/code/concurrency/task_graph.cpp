@@ -0,0 +1,443 @@
+#include "concurrency/task_graph.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <stdexcept>
+#include <unordered_set>
+#include <utility>
+
+namespace gomarky
+{
+
+struct TaskGraph::Edge
+{
+    Node* target;
+    Edge* next;
+
+    /// Stands in for the successor list once its task finished, so late links can tell.
+    static Edge closed;
+};
+
+TaskGraph::Edge TaskGraph::Edge::closed{nullptr, nullptr};
+
+struct TaskGraph::Node
+{
+    TaskId      id;
+    std::string name;
+    Body        body;
+    Node*       parent = nullptr; ///< task whose context added this one
+
+    std::atomic<int>       inputs{0};      ///< unfinished inputs, plus one while the parent's body runs
+    std::atomic<int>       outstanding{1}; ///< the body plus children that have not finished
+    std::atomic<Edge*>     successors{nullptr};
+    std::atomic<bool>      poisoned{false}; ///< an input or the parent did not succeed
+    std::atomic<bool>      child_failed{false};
+    std::atomic<bool>      cancel_requested{false};
+    std::atomic<TaskState> state{TaskState::Pending};
+
+    std::vector<Node*> children; ///< added by the running body, released when it returns
+    bool               has_deadline = false;
+    Clock::duration    deadline{};
+    std::exception_ptr error;
+
+    // Timeline, for Stats(). `trigger` is the input whose completion made the task ready and
+    // `last_child` the child whose completion finished it.
+    Node*             trigger    = nullptr;
+    Node*             last_child = nullptr;
+    Clock::time_point ready;
+    Clock::time_point start;
+    Clock::time_point body_end;
+    Clock::time_point finish;
+};
+
+// Context ---------------------------------------------------------------------------------------
+
+TaskGraph::TaskId TaskGraph::Context::Id() const { return static_cast<Node*>(m_node)->id; }
+
+bool TaskGraph::Context::Cancelled() const { return m_graph.ShouldStop(static_cast<Node*>(m_node)); }
+
+TaskGraph::TaskId TaskGraph::Context::Add(std::string name, Body body)
+{
+    Node* parent = static_cast<Node*>(m_node);
+    Node* child  = m_graph.Create(std::move(name), std::move(body), parent, 1);
+    parent->outstanding.fetch_add(1, std::memory_order_relaxed);
+    parent->children.push_back(child);
+    return child->id;
+}
+
+void TaskGraph::Context::Precede(TaskId before, TaskId after)
+{
+    Node* target = m_graph.ChildFor(static_cast<Node*>(m_node), after);
+    Node* source = m_graph.NodeFor(before);
+    // Another running task may be linking at the same time; one at a time, a check that passes
+    // still holds when the edge goes in.
+    std::lock_guard<std::mutex> lock(m_graph.m_link_mutex);
+    if (m_graph.Downstream(target, source)) throw std::logic_error("TaskGraph: the link would make a cycle");
+    m_graph.Link(source, target);
+}
+
+void TaskGraph::Context::SetDeadline(TaskId task, Clock::duration since_start)
+{
+    // Children do not start before this body returns, so nothing reads the deadline yet.
+    Node* node         = m_graph.ChildFor(static_cast<Node*>(m_node), task);
+    node->deadline     = since_start;
+    node->has_deadline = true;
+}
+
+// Statistics ------------------------------------------------------------------------------------
+
+TaskGraph::Clock::duration TaskGraph::Statistics::CriticalPathRunning() const
+{
+    Clock::duration total{};
+    for (const auto& step : critical_path) total += step.running;
+    return total;
+}
+
+std::string TaskGraph::Statistics::Format() const
+{
+    using Milliseconds = std::chrono::duration<double, std::milli>;
+    std::string text;
+    char        line[256];
+    for (const auto& step : critical_path)
+    {
+        std::snprintf(line, sizeof(line), "  %-32s queued %9.3f ms  ran %9.3f ms\n", step.name.c_str(),
+                      Milliseconds(step.queued).count(), Milliseconds(step.running).count());
+        text += line;
+    }
+    std::snprintf(line, sizeof(line), "%zu tasks: wall %.3f ms, busy %.3f ms, critical path ran %.3f ms\n", tasks,
+                  Milliseconds(wall).count(), Milliseconds(busy).count(), Milliseconds(CriticalPathRunning()).count());
+    return line + text;
+}
+
+// TaskGraph -------------------------------------------------------------------------------------
+
+TaskGraph::TaskGraph(WorkerPool& pool) : m_pool(pool) {}
+
+TaskGraph::~TaskGraph()
+{
+    if (m_started.load()) Wait();
+    // Edges of a graph that never ran are still linked.
+    for (auto& node : m_nodes)
+    {
+        Edge* edge = node->successors.load(std::memory_order_relaxed);
+        while (edge && edge != &Edge::closed)
+        {
+            Edge* next = edge->next;
+            delete edge;
+            edge = next;
+        }
+    }
+}
+
+TaskGraph::TaskId TaskGraph::Add(std::string name, Body body)
+{
+    if (m_started.load()) throw std::logic_error("TaskGraph: use Context::Add once the graph runs");
+    return Create(std::move(name), std::move(body), nullptr, 0)->id;
+}
+
+void TaskGraph::Precede(TaskId before, TaskId after)
+{
+    if (m_started.load()) throw std::logic_error("TaskGraph: use Context::Precede once the graph runs");
+    Link(NodeFor(before), NodeFor(after));
+}
+
+void TaskGraph::SetDeadline(TaskId task, Clock::duration since_start)
+{
+    if (m_started.load()) throw std::logic_error("TaskGraph: use Context::SetDeadline once the graph runs");
+    Node* node         = NodeFor(task);
+    node->deadline     = since_start;
+    node->has_deadline = true;
+}
+
+void TaskGraph::Run()
+{
+    if (m_started.load()) throw std::logic_error("TaskGraph: Run() called twice");
+
+    // Collect the roots before posting any, since finishing tasks make more tasks input-free.
+    std::vector<Node*> roots;
+    {
+        std::lock_guard<std::mutex> lock(m_nodes_mutex);
+        std::vector<int>   inputs(m_nodes.size());
+        std::vector<Node*> order;
+        for (auto& node : m_nodes)
+        {
+            inputs[node->id] = node->inputs.load(std::memory_order_relaxed);
+            if (inputs[node->id] == 0) order.push_back(node.get());
+        }
+        roots = order;
+        for (size_t i = 0; i < order.size(); ++i)
+        {
+            for (Edge* edge = order[i]->successors.load(std::memory_order_relaxed); edge; edge = edge->next)
+            {
+                if (--inputs[edge->target->id] == 0) order.push_back(edge->target);
+            }
+        }
+        if (order.size() != m_nodes.size()) throw std::logic_error("TaskGraph: the graph has a cycle");
+    }
+
+    m_start = Clock::now();
+    m_started.store(true);
+    if (roots.empty())
+    {
+        std::lock_guard<std::mutex> lock(m_done_mutex);
+        m_end      = m_start;
+        m_finished = true;
+        return;
+    }
+    for (Node* root : roots)
+    {
+        root->ready = m_start;
+        m_pool.Post([this, root] { Execute(root); });
+    }
+}
+
+void TaskGraph::Wait()
+{
+    std::unique_lock<std::mutex> lock(m_done_mutex);
+    m_done.wait(lock, [this] { return m_finished; });
+}
+
+void TaskGraph::Cancel() { m_cancelled.store(true); }
+
+void TaskGraph::Cancel(TaskId task) { NodeFor(task)->cancel_requested.store(true); }
+
+TaskGraph::TaskState TaskGraph::State(TaskId task) const { return NodeFor(task)->state.load(); }
+
+std::exception_ptr TaskGraph::Error(TaskId task) const
+{
+    Node* node = NodeFor(task);
+    return node->state.load() == TaskState::Failed ? node->error : nullptr;
+}
+
+size_t TaskGraph::Size() const
+{
+    std::lock_guard<std::mutex> lock(m_nodes_mutex);
+    return m_nodes.size();
+}
+
+TaskGraph::Statistics TaskGraph::Stats() const
+{
+    std::lock_guard<std::mutex> lock(m_nodes_mutex);
+    Statistics                  stats;
+    stats.tasks = m_nodes.size();
+    stats.wall  = m_end - m_start;
+
+    Node* last = nullptr;
+    for (const auto& node : m_nodes)
+    {
+        stats.busy += node->body_end - node->start;
+        if (!last || node->finish > last->finish) last = node.get();
+    }
+
+    // Walk back from the task that finished last. A task that ended by waiting for its children
+    // hands over to the child that finished last; a task released by its parent's body continues
+    // with that body, without descending into the parent's children again.
+    bool  from_child = false;
+    Node* node       = last;
+    while (node)
+    {
+        if (!from_child && node->last_child && node->last_child->finish > node->body_end)
+        {
+            node = node->last_child;
+            continue;
+        }
+        stats.critical_path.push_back({node->id, node->name, node->start - node->ready, node->body_end - node->start});
+        from_child = node->trigger && node->trigger == node->parent;
+        node       = node->trigger;
+    }
+    std::reverse(stats.critical_path.begin(), stats.critical_path.end());
+    return stats;
+}
+
+TaskGraph::Node* TaskGraph::NodeFor(TaskId task) const
+{
+    std::lock_guard<std::mutex> lock(m_nodes_mutex);
+    if (task >= m_nodes.size()) throw std::out_of_range("TaskGraph: unknown task");
+    return m_nodes[task].get();
+}
+
+TaskGraph::Node* TaskGraph::ChildFor(const Node* parent, TaskId task) const
+{
+    Node* node = NodeFor(task);
+    if (std::find(parent->children.begin(), parent->children.end(), node) == parent->children.end())
+    {
+        throw std::logic_error("TaskGraph: a running task can only change tasks it added");
+    }
+    return node;
+}
+
+bool TaskGraph::Downstream(Node* from, const Node* node) const
+{
+    // Everything waiting for an unfinished task is unfinished too, so none of the successor
+    // lists walked here is closed and freed meanwhile.
+    std::vector<Node*>        stack{from};
+    std::unordered_set<Node*> seen{from};
+    while (!stack.empty())
+    {
+        Node* current = stack.back();
+        stack.pop_back();
+        if (current == node) return true;
+        auto visit = [&stack, &seen](Node* next) {
+            if (next && seen.insert(next).second) stack.push_back(next);
+        };
+        visit(current->parent);
+        Edge* edge = current->successors.load(std::memory_order_acquire);
+        for (; edge && edge != &Edge::closed; edge = edge->next) visit(edge->target);
+    }
+    return false;
+}
+
+TaskGraph::Node* TaskGraph::Create(std::string name, Body body, Node* parent, int holds)
+{
+    std::unique_ptr<Node> node(new Node);
+    node->name   = std::move(name);
+    node->body   = std::move(body);
+    node->parent = parent;
+    node->inputs.store(holds, std::memory_order_relaxed);
+    m_unfinished.fetch_add(1, std::memory_order_relaxed);
+
+    std::lock_guard<std::mutex> lock(m_nodes_mutex);
+    node->id = static_cast<TaskId>(m_nodes.size());
+    m_nodes.push_back(std::move(node));
+    return m_nodes.back().get();
+}
+
+void TaskGraph::Link(Node* before, Node* after)
+{
+    // Count the input first: `after` is either not running yet or still held by its parent, so
+    // taking the count back below cannot make it ready.
+    after->inputs.fetch_add(1, std::memory_order_relaxed);
+    Edge* edge = new Edge{after, nullptr};
+    Edge* head = before->successors.load(std::memory_order_acquire);
+    do
+    {
+        if (head == &Edge::closed)
+        {
+            delete edge;
+            after->inputs.fetch_sub(1, std::memory_order_relaxed);
+            if (before->state.load() != TaskState::Succeeded || before->child_failed.load()) after->poisoned.store(true);
+            return;
+        }
+        edge->next = head;
+    } while (!before->successors.compare_exchange_weak(head, edge, std::memory_order_release, std::memory_order_acquire));
+}
+
+bool TaskGraph::ShouldStop(const Node* node) const
+{
+    return m_cancelled.load(std::memory_order_relaxed) || node->cancel_requested.load(std::memory_order_relaxed) ||
+           (node->has_deadline && Clock::now() > m_start + node->deadline);
+}
+
+void TaskGraph::Execute(Node* node)
+{
+    while (node) node = RunBody(node);
+}
+
+TaskGraph::Node* TaskGraph::RunBody(Node* node)
+{
+    node->start = Clock::now();
+    TaskState outcome;
+    if (node->poisoned.load() || m_cancelled.load() || node->cancel_requested.load())
+    {
+        outcome = TaskState::Cancelled;
+    }
+    else if (node->has_deadline && node->start > m_start + node->deadline)
+    {
+        outcome = TaskState::DeadlineMissed;
+    }
+    else
+    {
+        node->state.store(TaskState::Running);
+        try
+        {
+            Context context(*this, node);
+            node->body(context);
+            outcome = TaskState::Succeeded;
+        }
+        catch (...)
+        {
+            node->error = std::current_exception();
+            outcome     = TaskState::Failed;
+        }
+        if (outcome == TaskState::Succeeded)
+        {
+            if (node->cancel_requested.load() || m_cancelled.load()) outcome = TaskState::Cancelled;
+            else if (node->has_deadline && Clock::now() > m_start + node->deadline) outcome = TaskState::DeadlineMissed;
+        }
+    }
+    node->body_end = Clock::now();
+    node->body     = nullptr; // drop captured state as early as possible
+    node->state.store(outcome);
+
+    std::vector<Node*> ready;
+    for (Node* child : node->children)
+    {
+        if (outcome != TaskState::Succeeded) child->poisoned.store(true);
+        Release(child, node, ready);
+    }
+    node->children.clear();
+    node->children.shrink_to_fit();
+    if (node->outstanding.fetch_sub(1, std::memory_order_acq_rel) == 1) Finish(node, ready);
+
+    // Once Finish() has counted the last task out the graph may already be gone, so only
+    // `ready` is touched from here on; it is empty in that case.
+    if (ready.empty()) return nullptr;
+    for (size_t i = 1; i < ready.size(); ++i)
+    {
+        Node* next = ready[i];
+        m_pool.Post([this, next] { Execute(next); });
+    }
+    return ready.front();
+}
+
+void TaskGraph::Finish(Node* node, std::vector<Node*>& ready)
+{
+    while (node)
+    {
+        node->finish = Clock::now();
+        const bool ok = node->state.load() == TaskState::Succeeded && !node->child_failed.load();
+
+        Edge* edge = node->successors.exchange(&Edge::closed, std::memory_order_acq_rel);
+        while (edge)
+        {
+            Edge* next = edge->next;
+            if (!ok) edge->target->poisoned.store(true);
+            Release(edge->target, node, ready);
+            delete edge;
+            edge = next;
+        }
+
+        // A parent finishes with its last child. Settle it before counting this task out, so the
+        // graph cannot look finished while the parent is still pending.
+        Node* parent = node->parent;
+        Node* next   = nullptr;
+        if (parent)
+        {
+            if (!ok) parent->child_failed.store(true);
+            if (parent->outstanding.fetch_sub(1, std::memory_order_acq_rel) == 1)
+            {
+                parent->last_child = node;
+                next               = parent;
+            }
+        }
+        if (m_unfinished.fetch_sub(1, std::memory_order_acq_rel) == 1)
+        {
+            std::lock_guard<std::mutex> lock(m_done_mutex);
+            m_end      = Clock::now();
+            m_finished = true;
+            m_done.notify_all();
+            return;
+        }
+        node = next;
+    }
+}
+
+void TaskGraph::Release(Node* node, Node* trigger, std::vector<Node*>& ready)
+{
+    if (node->inputs.fetch_sub(1, std::memory_order_acq_rel) != 1) return;
+    node->trigger = trigger;
+    node->ready   = Clock::now();
+    ready.push_back(node);
+}
+
+} // namespace gomarky
@@ -0,0 +1,166 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "concurrency/worker_pool.h"
+
+namespace gomarky
+{
+
+/// Runs a DAG of tasks on a WorkerPool, each task as soon as all of its inputs have finished.
+///
+/// Every task keeps an atomic count of unfinished inputs and a lock-free list of the tasks
+/// waiting on it, so finishing a task costs one decrement per successor and no lock. One of the
+/// successors it readies continues on the same thread; the rest are posted to the pool.
+///
+/// The graph can be built up front with Add() and Precede(), and grown while it runs: a running
+/// task can add tasks through its Context. Those are released when the adding task's body
+/// returns, and the adding task only counts as finished, for its own successors, once they have.
+///
+/// A task that fails, is cancelled or misses its deadline cancels everything downstream of it.
+/// Running tasks are never interrupted; long ones should poll Context::Cancelled().
+class TaskGraph
+{
+public:
+    using TaskId = uint32_t;
+    using Clock  = std::chrono::steady_clock;
+
+    enum class TaskState
+    {
+        Pending,
+        Running,
+        Succeeded,
+        Failed,         ///< the body threw; see Error()
+        Cancelled,      ///< skipped because of Cancel() or a failed input
+        DeadlineMissed, ///< not started, or not finished, by its deadline
+    };
+
+    class Context;
+    using Body = std::function<void(Context&)>;
+
+    /// What a running task sees of the graph.
+    class Context
+    {
+    public:
+        TaskId Id() const;
+
+        /// True once the task, or the whole graph, was cancelled or the task's deadline passed.
+        bool Cancelled() const;
+
+        /// Add a task that starts after this task's body returns and its own inputs are done.
+        TaskId Add(std::string name, Body body);
+
+        /// Make `after`, which must have been added through this context, wait for `before`.
+        /// `before` can be any task; one that already finished does not hold `after` back. Throws
+        /// std::logic_error when `before` itself waits for `after`, such as this task or anything
+        /// downstream of it, since neither could ever finish.
+        void Precede(TaskId before, TaskId after);
+
+        /// Same as TaskGraph::SetDeadline, for a task added through this context.
+        void SetDeadline(TaskId task, Clock::duration since_start);
+
+    private:
+        friend class TaskGraph;
+        Context(TaskGraph& graph, void* node) : m_graph(graph), m_node(node) {}
+
+        TaskGraph& m_graph;
+        void*      m_node;
+    };
+
+    /// One step of the critical path: how long the task waited for a worker once it was ready,
+    /// and how long its body ran.
+    struct CriticalStep
+    {
+        TaskId          task;
+        std::string     name;
+        Clock::duration queued;
+        Clock::duration running;
+    };
+
+    struct Statistics
+    {
+        Clock::duration           wall{};        ///< Run() until the last task finished
+        Clock::duration           busy{};        ///< sum of all task bodies
+        std::vector<CriticalStep> critical_path; ///< the chain of tasks that held up the end
+        size_t                    tasks = 0;
+
+        Clock::duration CriticalPathRunning() const;
+        /// One line per critical step plus a summary, for logs.
+        std::string Format() const;
+    };
+
+    explicit TaskGraph(WorkerPool& pool = WorkerPool::Global());
+    ~TaskGraph();
+
+    TaskGraph(const TaskGraph&) = delete;
+    TaskGraph& operator=(const TaskGraph&) = delete;
+
+    /// Build the graph before Run().
+    TaskId Add(std::string name, Body body);
+    void   Precede(TaskId before, TaskId after);
+
+    /// Give a task until `since_start` after Run() to finish; call before Run(). A task still waiting for a worker
+    /// then is skipped; one that finishes late is marked DeadlineMissed.
+    void SetDeadline(TaskId task, Clock::duration since_start);
+
+    /// Start every task without inputs. Returns immediately; call once.
+    void Run();
+
+    /// Block until every task has finished or been skipped. Do not call from a task of this graph.
+    void Wait();
+
+    /// Skip everything not started yet and ask running tasks to stop.
+    void Cancel();
+
+    /// Skip `task` if it has not started, or ask it to stop, and cancel everything downstream.
+    void Cancel(TaskId task);
+
+    TaskState          State(TaskId task) const;
+    std::exception_ptr Error(TaskId task) const;
+    size_t             Size() const;
+
+    /// Timings of a finished run.
+    Statistics Stats() const;
+
+private:
+    struct Node;
+    struct Edge;
+
+    Node* NodeFor(TaskId task) const;
+    Node* ChildFor(const Node* parent, TaskId task) const;
+    /// Whether `node` waits for `from`: it follows it, or is the parent of such a task.
+    bool  Downstream(Node* from, const Node* node) const;
+    Node* Create(std::string name, Body body, Node* parent, int holds);
+    void  Link(Node* before, Node* after);
+    void  Execute(Node* node);
+    Node* RunBody(Node* node);
+    void  Finish(Node* node, std::vector<Node*>& ready);
+    void  Release(Node* node, Node* trigger, std::vector<Node*>& ready);
+    bool  ShouldStop(const Node* node) const;
+
+    WorkerPool&                        m_pool;
+    mutable std::mutex                 m_nodes_mutex;
+    std::vector<std::unique_ptr<Node>> m_nodes;
+    std::mutex                         m_link_mutex; ///< orders the cycle checks of running tasks
+    std::atomic<bool>                  m_cancelled{false};
+    std::atomic<bool>                  m_started{false};
+    Clock::time_point                  m_start;
+    Clock::time_point                  m_end; ///< guarded by m_done_mutex
+
+    std::atomic<size_t>     m_unfinished{0};
+    std::mutex              m_done_mutex;
+    std::condition_variable m_done;
+    bool                    m_finished = false; ///< guarded by m_done_mutex
+};
+
+} // namespace gomarky
@@ -0,0 +1,210 @@
+#include "concurrency/worker_pool.h"
+
+#include "system/cpu_topology.h"
+
+#include <algorithm>
+#include <atomic>
+#include <map>
+#include <stdexcept>
+
+namespace gomarky
+{
+
+namespace
+{
+
+thread_local const WorkerPool* t_current_pool   = nullptr;
+thread_local int               t_current_worker = -1;
+
+} // namespace
+
+WorkerPool::WorkerPool(size_t threads)
+{
+    if (threads == 0) threads = std::max(1u, std::thread::hardware_concurrency());
+    m_workers.resize(threads);
+    m_queues.resize(1);
+    Start(threads);
+}
+
+WorkerPool::WorkerPool(size_t threads, const CpuTopology& topology)
+{
+    std::vector<int>       order;
+    const std::vector<int> allowed = AllowedCpus(topology);
+    for (int cpu : topology.PlacementOrder())
+    {
+        if (std::find(allowed.begin(), allowed.end(), cpu) != allowed.end()) order.push_back(cpu);
+    }
+    if (threads == 0) threads = std::max<size_t>(1, order.size());
+    m_workers.resize(threads);
+
+    // Domains are numbered densely over the L3 caches the workers actually occupy.
+    std::map<int, size_t> domains;
+    for (size_t i = 0; i < threads && !order.empty(); ++i)
+    {
+        const CpuTopology::Cpu* cpu = topology.Find(order[i % order.size()]);
+        m_workers[i].cpu            = cpu->id;
+        m_workers[i].node           = cpu->node;
+        m_workers[i].domain         = domains.emplace(cpu->l3, domains.size()).first->second;
+    }
+    m_queues.resize(std::max<size_t>(1, domains.size()));
+    Start(threads);
+}
+
+void WorkerPool::Start(size_t threads)
+{
+    m_threads.reserve(threads);
+    for (size_t i = 0; i < threads; ++i)
+    {
+        m_threads.emplace_back([this, i] { WorkerLoop(i); });
+    }
+}
+
+WorkerPool::~WorkerPool()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stopping = true;
+    }
+    m_wakeup.notify_all();
+    for (auto& thread : m_threads)
+    {
+        thread.join();
+    }
+}
+
+WorkerPool& WorkerPool::Global()
+{
+    static WorkerPool pool;
+    return pool;
+}
+
+bool WorkerPool::IsWorkerThread() const { return t_current_pool == this; }
+
+int WorkerPool::CurrentWorker() const { return IsWorkerThread() ? t_current_worker : -1; }
+
+void WorkerPool::Post(Task task)
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        const size_t domain = IsWorkerThread() ? m_workers[t_current_worker].domain
+                                               : m_next_domain++ % m_queues.size();
+        m_queues[domain].push_back(std::move(task));
+        ++m_queued;
+    }
+    m_wakeup.notify_one();
+}
+
+WorkerPool::Task WorkerPool::Take(size_t domain)
+{
+    for (size_t i = 0; i < m_queues.size(); ++i)
+    {
+        auto& queue = m_queues[(domain + i) % m_queues.size()];
+        if (queue.empty()) continue;
+        if (i != 0) m_steals.fetch_add(1, std::memory_order_relaxed);
+        Task task = std::move(queue.front());
+        queue.pop_front();
+        --m_queued;
+        return task;
+    }
+    return Task();
+}
+
+void WorkerPool::WorkerLoop(size_t index)
+{
+    t_current_pool   = this;
+    t_current_worker = static_cast<int>(index);
+    if (m_workers[index].cpu >= 0) PinCurrentThread(m_workers[index].cpu);
+    for (;;)
+    {
+        Task task;
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_wakeup.wait(lock, [this] { return m_stopping || m_queued != 0; });
+            // Drain what is queued before honouring a stop request.
+            if (m_queued == 0) return;
+            task = Take(m_workers[index].domain);
+        }
+        task();
+    }
+}
+
+void WorkerPool::ParallelFor(size_t count, size_t grain, const std::function<void(size_t, size_t)>& body)
+{
+    if (count == 0) return;
+    grain               = std::max<size_t>(grain, 1);
+    const size_t chunks = (count + grain - 1) / grain;
+    if (chunks == 1)
+    {
+        body(0, count);
+        return;
+    }
+
+    struct Shared
+    {
+        std::atomic<size_t>     next{0};
+        std::atomic<size_t>     done{0};
+        std::mutex              mutex;
+        std::condition_variable finished;
+    };
+    auto shared = std::make_shared<Shared>();
+
+    // Helpers that start after every chunk was claimed simply find nothing to do, which is what
+    // keeps nested calls from deadlocking when all workers are already busy.
+    auto run = [shared, chunks, count, grain, &body] {
+        for (size_t chunk; (chunk = shared->next.fetch_add(1)) < chunks;)
+        {
+            const size_t begin = chunk * grain;
+            body(begin, std::min(count, begin + grain));
+            if (shared->done.fetch_add(1) + 1 == chunks)
+            {
+                std::lock_guard<std::mutex> lock(shared->mutex);
+                shared->finished.notify_all();
+            }
+        }
+    };
+
+    const size_t helpers = std::min(chunks - 1, Size());
+    for (size_t i = 0; i < helpers; ++i)
+    {
+        Post(run);
+    }
+    run();
+
+    std::unique_lock<std::mutex> lock(shared->mutex);
+    shared->finished.wait(lock, [&] { return shared->done.load() == chunks; });
+}
+
+void WorkerPool::RunOnEachWorker(const std::function<void(size_t)>& fn)
+{
+    if (IsWorkerThread()) throw std::logic_error("RunOnEachWorker called from a worker");
+
+    struct Shared
+    {
+        size_t                  arrived = 0;
+        size_t                  done    = 0;
+        std::mutex              mutex;
+        std::condition_variable changed;
+    };
+    Shared       shared;
+    const size_t workers = Size();
+
+    // Every task holds its worker until all of them have started, so no worker can run two.
+    for (size_t i = 0; i < workers; ++i)
+    {
+        Post([&shared, &fn, workers] {
+            {
+                std::unique_lock<std::mutex> lock(shared.mutex);
+                if (++shared.arrived == workers) shared.changed.notify_all();
+                shared.changed.wait(lock, [&] { return shared.arrived == workers; });
+            }
+            fn(static_cast<size_t>(t_current_worker));
+            std::lock_guard<std::mutex> lock(shared.mutex);
+            if (++shared.done == workers) shared.changed.notify_all();
+        });
+    }
+
+    std::unique_lock<std::mutex> lock(shared.mutex);
+    shared.changed.wait(lock, [&] { return shared.done == workers; });
+}
+
+} // namespace gomarky
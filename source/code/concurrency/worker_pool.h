@@ -0,0 +1,102 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+namespace gomarky
+{
+
+class CpuTopology;
+
+/// Fixed-size pool of worker threads fed from FIFO queues, one per L3 domain the workers run in.
+class WorkerPool
+{
+public:
+    using Task = std::function<void()>;
+
+    /// `threads == 0` means one thread per hardware thread. Workers are not pinned and share a
+    /// single queue.
+    explicit WorkerPool(size_t threads = 0);
+
+    /// Pin worker i to the i-th CPU of `topology.PlacementOrder()` this process may use. Workers
+    /// sharing an L3 domain share a queue; tasks posted from a worker stay in its domain, and an
+    /// idle worker only steals from other domains once its own queue is empty.
+    WorkerPool(size_t threads, const CpuTopology& topology);
+    ~WorkerPool();
+
+    WorkerPool(const WorkerPool&) = delete;
+    WorkerPool& operator=(const WorkerPool&) = delete;
+
+    /// Process-wide pool shared by the engines that do not get one injected.
+    static WorkerPool& Global();
+
+    size_t Size() const { return m_threads.size(); }
+
+    /// True when called from one of this pool's threads.
+    bool IsWorkerThread() const;
+
+    /// Index of the calling worker in [0, Size()), -1 outside this pool.
+    int CurrentWorker() const;
+
+    /// CPU worker `worker` is pinned to, -1 when unpinned.
+    int WorkerCpu(size_t worker) const { return m_workers[worker].cpu; }
+
+    /// NUMA node of that CPU, 0 when unpinned.
+    int WorkerNode(size_t worker) const { return m_workers[worker].node; }
+
+    /// Tasks a worker took from another domain's queue.
+    size_t Steals() const { return m_steals.load(std::memory_order_relaxed); }
+
+    void Post(Task task);
+
+    template<typename F>
+    std::future<typename std::result_of<F()>::type> Submit(F f)
+    {
+        using R   = typename std::result_of<F()>::type;
+        auto task = std::make_shared<std::packaged_task<R()>>(std::move(f));
+        auto fut  = task->get_future();
+        Post([task] { (*task)(); });
+        return fut;
+    }
+
+    /// Run `body(begin, end)` over [0, count) split into chunks of at least `grain` items.
+    /// The calling thread works on chunks too, so this is safe to call from inside a task.
+    void ParallelFor(size_t count, size_t grain, const std::function<void(size_t, size_t)>& body);
+
+    /// Run `fn(worker)` exactly once on every worker, e.g. to first-touch per-worker memory on
+    /// the worker's own node. Blocks until all have returned; must not be called from a worker.
+    void RunOnEachWorker(const std::function<void(size_t)>& fn);
+
+private:
+    struct Worker
+    {
+        int    cpu    = -1;
+        int    node   = 0;
+        size_t domain = 0;
+    };
+
+    void Start(size_t threads);
+    void WorkerLoop(size_t index);
+    Task Take(size_t domain);
+
+    std::vector<std::thread>      m_threads;
+    std::vector<Worker>           m_workers;
+    std::vector<std::deque<Task>> m_queues; ///< one per domain
+    size_t                        m_queued      = 0;
+    size_t                        m_next_domain = 0; ///< round robin for posts from outside
+    std::atomic<size_t>           m_steals{0};
+    std::mutex                    m_mutex;
+    std::condition_variable       m_wakeup;
+    bool                          m_stopping = false;
+};
+
+} // namespace gomarky
@@ -0,0 +1,131 @@
+#include "events/event_bus.h"
+
+#include <algorithm>
+#include <stdexcept>
+
+namespace gomarky
+{
+
+constexpr size_t EventBus::kDefaultCapacity;
+constexpr size_t EventBus::kDefaultDrainLimit;
+constexpr size_t EventBus::kMaxEventTypes;
+
+EventBus::EventBus()
+{
+    for (auto& topic : m_topics) topic.store(nullptr, std::memory_order_relaxed);
+}
+
+EventBus::~EventBus() = default;
+
+size_t EventBus::NextTypeId()
+{
+    static std::atomic<size_t> next{0};
+    const size_t id = next.fetch_add(1, std::memory_order_relaxed);
+    if (id >= kMaxEventTypes) throw std::length_error("EventBus: too many event types");
+    return id;
+}
+
+void EventBus::Attach(size_t type, std::unique_ptr<Channel> channel)
+{
+    std::lock_guard<std::mutex> lock(m_subscribe_mutex);
+
+    Topic* topic = m_topics[type].load(std::memory_order_relaxed);
+    if (!topic)
+    {
+        m_owned_topics.emplace_back(new Topic);
+        topic = m_owned_topics.back().get();
+        m_topics[type].store(topic, std::memory_order_release);
+    }
+
+    Channel* raw = channel.get();
+    m_owned_channels.push_back(std::move(channel));
+
+    // Links are set before the release stores, so readers that see the new head see a complete list.
+    raw->topic = topic;
+    raw->next_in_topic.store(topic->head.load(std::memory_order_relaxed), std::memory_order_relaxed);
+    raw->next_in_bus = m_channels.load(std::memory_order_relaxed);
+    topic->head.store(raw, std::memory_order_release);
+    m_channels.store(raw, std::memory_order_release);
+}
+
+void EventBus::Notify()
+{
+    // Only the publish that flips the flag wakes the consumer; the rest join the pending batch.
+    // The fence orders the ring push before the flag load, pairing with the one in Drain().
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (m_wake_pending.load(std::memory_order_relaxed)) return;
+    if (m_wake_pending.exchange(true, std::memory_order_acq_rel)) return;
+    m_wakeups.fetch_add(1, std::memory_order_relaxed);
+    if (m_wakeup) m_wakeup();
+}
+
+size_t EventBus::Drain(size_t max)
+{
+    // Clear the flag before looking at the rings: a message pushed after a ring was checked then
+    // finds the flag down and schedules another drain instead of being stranded.
+    m_wake_pending.store(false, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+
+    size_t total     = 0;
+    bool   cancelled = false;
+    for (Channel* channel = m_channels.load(std::memory_order_acquire); channel && total < max;
+         channel          = channel->next_in_bus)
+    {
+        if (!channel->active.load(std::memory_order_acquire))
+        {
+            cancelled = true;
+            continue;
+        }
+        total += channel->Drain(max - total);
+    }
+    if (cancelled || !m_retired.empty()) Reclaim(cancelled);
+    if (total >= max) Notify();
+    return total;
+}
+
+void EventBus::Reclaim(bool unlink)
+{
+    if (unlink)
+    {
+        // Attach pushes onto the same lists, so unlinking holds its mutex. Publishers may still be
+        // walking through an unlinked channel; its own link stays intact until it is freed.
+        std::lock_guard<std::mutex> lock(m_subscribe_mutex);
+        Channel*                    previous = nullptr;
+        for (Channel* channel = m_channels.load(std::memory_order_relaxed); channel;)
+        {
+            Channel* const next = channel->next_in_bus;
+            if (channel->active.load(std::memory_order_acquire))
+            {
+                previous = channel;
+                channel  = next;
+                continue;
+            }
+
+            if (previous) previous->next_in_bus = next;
+            else m_channels.store(next, std::memory_order_release);
+
+            std::atomic<Channel*>* link = &channel->topic->head;
+            while (link->load(std::memory_order_relaxed) != channel)
+            {
+                link = &link->load(std::memory_order_relaxed)->next_in_topic;
+            }
+            link->store(channel->next_in_topic.load(std::memory_order_relaxed), std::memory_order_seq_cst);
+
+            const auto owned = std::find_if(m_owned_channels.begin(), m_owned_channels.end(),
+                                            [channel](const std::unique_ptr<Channel>& c) { return c.get() == channel; });
+            m_retired.push_back(std::move(*owned));
+            m_owned_channels.erase(owned);
+            channel = next;
+        }
+    }
+
+    // A publisher that arrives after the unlink can no longer reach the channel, so once nobody
+    // is publishing its type the channel is gone for good.
+    m_retired.erase(std::remove_if(m_retired.begin(), m_retired.end(),
+                                   [](const std::unique_ptr<Channel>& channel) {
+                                       return channel->topic->publishers.load(std::memory_order_seq_cst) == 0;
+                                   }),
+                    m_retired.end());
+}
+
+} // namespace gomarky
@@ -0,0 +1,226 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+#include "concurrent/mpmc_ring.h"
+#include "concurrent/spsc_ring.h"
+
+namespace gomarky
+{
+
+/// Typed publish/subscribe bus for high-rate cross-thread messages.
+///
+/// Every subscription owns a bounded ring, so publishing is a copy into preallocated storage with
+/// no lock and no allocation. Handlers run on the consumer thread from Drain(), which empties all
+/// rings in batches. The wakeup callback fires once per batch: only the first publish after a
+/// drain calls it, and everything published until the drain runs rides along.
+///
+/// Cancelled subscriptions are unlinked by Drain() and their rings freed by a later drain, once no
+/// publisher of their event type is still walking the list they were on.
+class EventBus
+{
+public:
+    /// Who publishes a given event type. Single picks the cheaper SPSC ring and is only valid
+    /// when one thread at a time publishes that type.
+    enum class Producers
+    {
+        Single,
+        Multiple
+    };
+
+    static constexpr size_t kDefaultCapacity   = 4096;
+    static constexpr size_t kDefaultDrainLimit = 65536;
+    static constexpr size_t kMaxEventTypes     = 128;
+
+private:
+    struct Topic;
+
+    struct Channel
+    {
+        virtual ~Channel() = default;
+        virtual size_t Drain(size_t max) = 0;
+
+        std::atomic<bool>     active{true};
+        Topic*                topic = nullptr;
+        std::atomic<Channel*> next_in_topic{nullptr}; ///< publishers walk it without a lock
+        Channel*              next_in_bus = nullptr;  ///< only the draining thread walks it
+    };
+
+public:
+    /// Keeps a handler subscribed; destroying or cancelling it stops delivery. Messages still queued
+    /// for it are discarded. Must not outlive the bus.
+    class Subscription
+    {
+    public:
+        Subscription() = default;
+        ~Subscription() { Cancel(); }
+        Subscription(Subscription&& other) noexcept : m_channel(other.m_channel) { other.m_channel = nullptr; }
+        Subscription& operator=(Subscription&& other) noexcept
+        {
+            if (this != &other)
+            {
+                Cancel();
+                m_channel       = other.m_channel;
+                other.m_channel = nullptr;
+            }
+            return *this;
+        }
+        Subscription(const Subscription&) = delete;
+        Subscription& operator=(const Subscription&) = delete;
+
+        void Cancel()
+        {
+            if (m_channel) m_channel->active.store(false, std::memory_order_release);
+            m_channel = nullptr;
+        }
+        bool Active() const { return m_channel != nullptr; }
+
+    private:
+        friend class EventBus;
+        explicit Subscription(Channel* channel) : m_channel(channel) {}
+
+        Channel* m_channel = nullptr;
+    };
+
+    EventBus();
+    ~EventBus();
+
+    EventBus(const EventBus&) = delete;
+    EventBus& operator=(const EventBus&) = delete;
+
+    /// Called from a publishing thread when a batch starts. Set it before anything is published.
+    void SetWakeup(std::function<void()> wakeup) { m_wakeup = std::move(wakeup); }
+
+    /// Deliver every `Event` published from now on to `handler(const Event&)` on the draining thread.
+    template<typename Event, typename Handler>
+    Subscription Subscribe(Handler handler, Producers producers = Producers::Multiple,
+                           size_t capacity = kDefaultCapacity)
+    {
+        std::unique_ptr<Channel> channel(new TypedChannel<Event, Handler>(std::move(handler), producers, capacity));
+        Channel* raw = channel.get();
+        Attach(TypeId<Event>(), std::move(channel));
+        return Subscription(raw);
+    }
+
+    /// Copy `event` into every active subscriber's ring. Returns false when at least one ring was
+    /// full; those copies are dropped and counted instead of blocking the publisher.
+    template<typename Event>
+    bool Publish(const Event& event)
+    {
+        Topic* topic = m_topics[TypeId<Event>()].load(std::memory_order_acquire);
+        if (!topic) return true;
+
+        // The links are read seq_cst after announcing this publisher, so a drain that unlinked a
+        // channel and then finds no publisher in the topic knows none can still reach it.
+        PublisherScope scope(*topic);
+        bool           delivered = false;
+        bool           complete  = true;
+        for (Channel* channel = topic->head.load(std::memory_order_seq_cst); channel;
+             channel          = channel->next_in_topic.load(std::memory_order_seq_cst))
+        {
+            if (!channel->active.load(std::memory_order_relaxed)) continue;
+            if (static_cast<TypedChannelBase<Event>*>(channel)->Push(event))
+            {
+                delivered = true;
+            }
+            else
+            {
+                complete = false;
+                m_dropped.fetch_add(1, std::memory_order_relaxed);
+            }
+        }
+        if (delivered) Notify();
+        return complete;
+    }
+
+    /// Consumer side: run handlers for up to `max` queued messages and return how many ran. If the
+    /// limit cut the batch short the wakeup fires again so the rest is picked up on the next turn.
+    size_t Drain(size_t max = kDefaultDrainLimit);
+
+    uint64_t Dropped() const { return m_dropped.load(std::memory_order_relaxed); }
+    uint64_t Wakeups() const { return m_wakeups.load(std::memory_order_relaxed); }
+
+private:
+    struct Topic
+    {
+        std::atomic<Channel*> head{nullptr};
+        std::atomic<uint32_t> publishers{0}; ///< publishers walking the list right now
+    };
+
+    struct PublisherScope
+    {
+        explicit PublisherScope(Topic& t) : topic(t) { topic.publishers.fetch_add(1, std::memory_order_seq_cst); }
+        ~PublisherScope() { topic.publishers.fetch_sub(1, std::memory_order_release); }
+
+        Topic& topic;
+    };
+
+    template<typename Event>
+    struct TypedChannelBase : Channel
+    {
+        TypedChannelBase(Producers producers, size_t capacity)
+        {
+            if (producers == Producers::Single) single.reset(new SpscRing<Event>(capacity));
+            else multiple.reset(new MpscRing<Event>(capacity));
+        }
+
+        bool Push(const Event& event) { return single ? single->TryPush(event) : multiple->TryPush(event); }
+
+        std::unique_ptr<SpscRing<Event>> single;
+        std::unique_ptr<MpscRing<Event>> multiple;
+    };
+
+    template<typename Event, typename Handler>
+    struct TypedChannel final : TypedChannelBase<Event>
+    {
+        TypedChannel(Handler h, Producers producers, size_t capacity)
+            : TypedChannelBase<Event>(producers, capacity), handler(std::move(h))
+        {
+        }
+
+        size_t Drain(size_t max) override
+        {
+            auto consume = [this](Event& event) { handler(static_cast<const Event&>(event)); };
+            return this->single ? this->single->ConsumeBatch(consume, max) : this->multiple->ConsumeBatch(consume, max);
+        }
+
+        Handler handler;
+    };
+
+    static size_t NextTypeId();
+
+    template<typename Event>
+    static size_t TypeId()
+    {
+        static const size_t id = NextTypeId();
+        return id;
+    }
+
+    void Attach(size_t type, std::unique_ptr<Channel> channel);
+    void Notify();
+    /// Unlink cancelled channels and free the ones no publisher can reach any more. Drain only.
+    void Reclaim(bool unlink);
+
+    std::atomic<Topic*>       m_topics[kMaxEventTypes];
+    std::atomic<Channel*>     m_channels{nullptr};
+    std::atomic<bool>         m_wake_pending{false};
+    std::function<void()>     m_wakeup;
+    std::atomic<uint64_t>     m_dropped{0};
+    std::atomic<uint64_t>     m_wakeups{0};
+
+    // Subscribing is rare, so it serializes on a mutex; publishers never take it. Topics are only
+    // freed with the bus so that publishers can find them without locking.
+    std::mutex                            m_subscribe_mutex;
+    std::vector<std::unique_ptr<Topic>>   m_owned_topics;
+    std::vector<std::unique_ptr<Channel>> m_owned_channels;
+    std::vector<std::unique_ptr<Channel>> m_retired; ///< unlinked, freed once their topic is idle
+};
+
+} // namespace gomarky
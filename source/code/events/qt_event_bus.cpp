@@ -0,0 +1,16 @@
+#include "events/qt_event_bus.h"
+
+#include <QCoreApplication>
+
+namespace gomarky
+{
+
+void DrainOnEventLoop(EventBus& bus, QObject* receiver)
+{
+    if (!receiver) receiver = QCoreApplication::instance();
+    bus.SetWakeup([&bus, receiver] {
+        QMetaObject::invokeMethod(receiver, [&bus] { bus.Drain(); }, Qt::QueuedConnection);
+    });
+}
+
+} // namespace gomarky
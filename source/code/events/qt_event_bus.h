@@ -0,0 +1,15 @@
+#pragma once
+
+#include <QObject>
+
+#include "events/event_bus.h"
+
+namespace gomarky
+{
+
+/// Drain `bus` on the event loop `receiver` lives in: the first message of a batch posts one
+/// queued call, and everything published until it runs is handled together. Both the bus and the
+/// receiver (the application object by default) must outlive the publishers.
+void DrainOnEventLoop(EventBus& bus, QObject* receiver = nullptr);
+
+} // namespace gomarky
@@ -0,0 +1,625 @@
+#include "image/image_kernels.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstring>
+#include <vector>
+
+#include "concurrency/worker_pool.h"
+#include "image/resize_coefficients.h"
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#include <immintrin.h>
+#define GM_IMAGE_KERNELS_X86 1
+#else
+#define GM_IMAGE_KERNELS_X86 0
+#endif
+
+namespace gomarky
+{
+
+namespace
+{
+
+std::atomic<int> g_max_level{static_cast<int>(SimdLevel::Avx2)};
+
+SimdLevel DetectSimdLevel()
+{
+#if GM_IMAGE_KERNELS_X86
+    if (__builtin_cpu_supports("avx2")) return SimdLevel::Avx2;
+    if (__builtin_cpu_supports("sse2")) return SimdLevel::Sse2;
+#endif
+    return SimdLevel::Scalar;
+}
+
+// Rows per task so that each one touches roughly 64k pixels.
+size_t RowGrain(int width) { return std::max<size_t>(1, size_t(65536) / size_t(std::max(1, width))); }
+
+uint32_t* PixelRow(ImageView image, int y) { return reinterpret_cast<uint32_t*>(image.Row(y)); }
+
+//------------------------------------------------------------------------------------------------
+// Premultiply / unpremultiply
+
+uint32_t PremultiplyPixel(uint32_t pixel)
+{
+    const uint32_t a   = pixel >> 24;
+    uint32_t       out = a << 24;
+    for (int shift = 0; shift < 24; shift += 8)
+    {
+        const uint32_t t = ((pixel >> shift) & 0xff) * a + 128;
+        out |= ((t + (t >> 8)) >> 8) << shift;
+    }
+    return out;
+}
+
+struct InverseAlphaTable
+{
+    uint32_t values[256];
+
+    InverseAlphaTable()
+    {
+        values[0] = 0;
+        for (uint32_t a = 1; a < 256; ++a) values[a] = ((255u << 16) + a / 2) / a;
+    }
+};
+
+const InverseAlphaTable& InverseAlpha()
+{
+    static const InverseAlphaTable table;
+    return table;
+}
+
+uint32_t UnpremultiplyPixel(uint32_t pixel, const uint32_t* inverse_table)
+{
+    const uint32_t a       = pixel >> 24;
+    const uint32_t inverse = inverse_table[a];
+    uint32_t       out     = a << 24;
+    for (int shift = 0; shift < 24; shift += 8)
+    {
+        const uint32_t value = (((pixel >> shift) & 0xff) * inverse + 0x8000) >> 16;
+        out |= std::min(value, 255u) << shift;
+    }
+    return out;
+}
+
+//------------------------------------------------------------------------------------------------
+// Box blur, scalar
+
+// Fixed-point reciprocal of the window size, shared by every path so results match exactly.
+uint32_t BoxMultiplier(int radius)
+{
+    const uint32_t diameter = uint32_t(2 * radius + 1);
+    return (65536 + diameter / 2) / diameter;
+}
+
+uint32_t BoxAverage(uint32_t sum, uint32_t mul) { return std::min<uint32_t>((sum * mul + 0x8000) >> 16, 255); }
+
+void BoxRowScalar(const uint32_t* src, uint32_t* dst, int width, int radius, uint32_t mul)
+{
+    uint32_t sum[4] = {};
+    auto     add    = [&](int x, int sign) {
+        const uint32_t pixel = src[std::max(0, std::min(x, width - 1))];
+        for (int c = 0; c < 4; ++c) sum[c] += uint32_t(sign) * ((pixel >> (8 * c)) & 0xff);
+    };
+    for (int k = -radius; k <= radius; ++k) add(k, 1);
+    for (int x = 0; x < width; ++x)
+    {
+        uint32_t out = 0;
+        for (int c = 0; c < 4; ++c) out |= BoxAverage(sum[c], mul) << (8 * c);
+        dst[x] = out;
+        add(x + radius + 1, 1);
+        add(x - radius, -1);
+    }
+}
+
+// Vertical pass over bytes [begin, end) of every row, keeping one running sum per byte.
+void BoxColumnsScalar(ImageView src, ImageView dst, size_t begin, size_t end, int radius, uint32_t mul,
+                      std::vector<uint32_t>& sums)
+{
+    sums.assign(end - begin, 0);
+    auto row = [&](int y) { return src.Row(std::max(0, std::min(y, src.height - 1))) + begin; };
+    for (int k = -radius; k <= radius; ++k)
+    {
+        const uint8_t* in = row(k);
+        for (size_t i = 0; i < sums.size(); ++i) sums[i] += in[i];
+    }
+    for (int y = 0; y < src.height; ++y)
+    {
+        uint8_t*       out      = dst.Row(y) + begin;
+        const uint8_t* incoming = row(y + radius + 1);
+        const uint8_t* outgoing = row(y - radius);
+        for (size_t i = 0; i < sums.size(); ++i)
+        {
+            out[i] = static_cast<uint8_t>(BoxAverage(sums[i], mul));
+            sums[i] += uint32_t(incoming[i]) - uint32_t(outgoing[i]);
+        }
+    }
+}
+
+//------------------------------------------------------------------------------------------------
+// Resize, scalar
+
+uint32_t RoundWeighted(int32_t sum)
+{
+    const int bits = ResizeCoefficients::kWeightBits;
+    return uint32_t(std::max(0, std::min((sum + (1 << (bits - 1))) >> bits, 255)));
+}
+
+void ResizeRowScalar(const uint32_t* src, uint32_t* dst, const ResizeCoefficients& coefficients, int width)
+{
+    for (int x = 0; x < width; ++x)
+    {
+        const uint32_t* in      = src + coefficients.first[size_t(x)];
+        const int16_t*  weights = coefficients.Weights(x);
+        int32_t         sum[4]  = {};
+        for (int k = 0; k < coefficients.taps; ++k)
+        {
+            for (int c = 0; c < 4; ++c) sum[c] += weights[k] * int32_t((in[k] >> (8 * c)) & 0xff);
+        }
+        dst[x] = RoundWeighted(sum[0]) | RoundWeighted(sum[1]) << 8 | RoundWeighted(sum[2]) << 16 | RoundWeighted(sum[3]) << 24;
+    }
+}
+
+// One output row of the vertical pass over bytes [begin, bytes).
+void ResizeColumnsScalar(const uint8_t* const* rows, const int16_t* weights, int taps, uint8_t* out,
+                         size_t begin, size_t bytes)
+{
+    for (size_t i = begin; i < bytes; ++i)
+    {
+        int32_t sum = 0;
+        for (int k = 0; k < taps; ++k) sum += weights[k] * int32_t(rows[k][i]);
+        out[i] = static_cast<uint8_t>(RoundWeighted(sum));
+    }
+}
+
+//------------------------------------------------------------------------------------------------
+// SSE2 / AVX2 paths. Each function handles the bulk and leaves tails to the scalar code above.
+
+#if GM_IMAGE_KERNELS_X86
+
+// Premultiply 8 16-bit channels (two pixels), keeping the alpha lanes as they are.
+inline __m128i Premultiply16(__m128i x, __m128i alpha_mask, __m128i round)
+{
+    const __m128i a = _mm_shufflehi_epi16(_mm_shufflelo_epi16(x, 0xff), 0xff);
+    __m128i       t = _mm_add_epi16(_mm_mullo_epi16(x, a), round);
+    t               = _mm_srli_epi16(_mm_add_epi16(t, _mm_srli_epi16(t, 8)), 8);
+    return _mm_or_si128(_mm_andnot_si128(alpha_mask, t), _mm_and_si128(alpha_mask, x));
+}
+
+int PremultiplySse2(uint32_t* pixels, int count)
+{
+    const __m128i zero       = _mm_setzero_si128();
+    const __m128i alpha_mask = _mm_set_epi16(-1, 0, 0, 0, -1, 0, 0, 0);
+    const __m128i round      = _mm_set1_epi16(128);
+    int           i          = 0;
+    for (; i + 4 <= count; i += 4)
+    {
+        __m128i* p  = reinterpret_cast<__m128i*>(pixels + i);
+        __m128i  v  = _mm_loadu_si128(p);
+        __m128i  lo = Premultiply16(_mm_unpacklo_epi8(v, zero), alpha_mask, round);
+        __m128i  hi = Premultiply16(_mm_unpackhi_epi8(v, zero), alpha_mask, round);
+        _mm_storeu_si128(p, _mm_packus_epi16(lo, hi));
+    }
+    return i;
+}
+
+__attribute__((target("avx2"))) inline __m256i Premultiply16Avx2(__m256i x, __m256i alpha_mask, __m256i round)
+{
+    const __m256i a = _mm256_shufflehi_epi16(_mm256_shufflelo_epi16(x, 0xff), 0xff);
+    __m256i       t = _mm256_add_epi16(_mm256_mullo_epi16(x, a), round);
+    t               = _mm256_srli_epi16(_mm256_add_epi16(t, _mm256_srli_epi16(t, 8)), 8);
+    return _mm256_blendv_epi8(t, x, alpha_mask);
+}
+
+__attribute__((target("avx2"))) int PremultiplyAvx2(uint32_t* pixels, int count)
+{
+    const __m256i zero       = _mm256_setzero_si256();
+    const __m256i alpha_mask = _mm256_set_epi16(-1, 0, 0, 0, -1, 0, 0, 0, -1, 0, 0, 0, -1, 0, 0, 0);
+    const __m256i round      = _mm256_set1_epi16(128);
+    int           i          = 0;
+    for (; i + 8 <= count; i += 8)
+    {
+        __m256i* p  = reinterpret_cast<__m256i*>(pixels + i);
+        __m256i  v  = _mm256_loadu_si256(p);
+        __m256i  lo = Premultiply16Avx2(_mm256_unpacklo_epi8(v, zero), alpha_mask, round);
+        __m256i  hi = Premultiply16Avx2(_mm256_unpackhi_epi8(v, zero), alpha_mask, round);
+        _mm256_storeu_si256(p, _mm256_packus_epi16(lo, hi));
+    }
+    return i;
+}
+
+// Unpremultiply two pixels: one 32-bit lane per channel, the reciprocal gathered by alpha.
+__attribute__((target("avx2"))) inline void Unpremultiply2Avx2(uint32_t* pixels, const uint32_t* table)
+{
+    const __m256i c       = _mm256_cvtepu8_epi32(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(pixels)));
+    const __m256i a       = _mm256_shuffle_epi32(c, 0xff);
+    const __m256i inverse = _mm256_i32gather_epi32(reinterpret_cast<const int*>(table), a, 4);
+    __m256i r = _mm256_srli_epi32(_mm256_add_epi32(_mm256_mullo_epi32(c, inverse), _mm256_set1_epi32(0x8000)), 16);
+    r         = _mm256_min_epu32(r, _mm256_set1_epi32(255));
+    r         = _mm256_blend_epi32(r, c, 0x88); // alpha lanes pass through
+    const __m256i words = _mm256_packus_epi32(r, r);
+    const __m256i bytes = _mm256_packus_epi16(words, words);
+    pixels[0]           = uint32_t(_mm256_extract_epi32(bytes, 0));
+    pixels[1]           = uint32_t(_mm256_extract_epi32(bytes, 4));
+}
+
+__attribute__((target("avx2"))) int UnpremultiplyAvx2(uint32_t* pixels, int count, const uint32_t* table)
+{
+    int i = 0;
+    for (; i + 2 <= count; i += 2)
+    {
+        // Fully opaque pairs are common and need no work.
+        if ((pixels[i] & pixels[i + 1]) >> 24 == 0xff) continue;
+        Unpremultiply2Avx2(pixels + i, table);
+    }
+    return i;
+}
+
+// 32-bit lane multiply for SSE2, which only has the even-lane 32x32->64 multiply.
+inline __m128i MulLo32Sse2(__m128i a, __m128i b)
+{
+    const __m128i even = _mm_mul_epu32(a, b);
+    const __m128i odd  = _mm_mul_epu32(_mm_srli_si128(a, 4), _mm_srli_si128(b, 4));
+    return _mm_unpacklo_epi32(_mm_shuffle_epi32(even, _MM_SHUFFLE(0, 0, 2, 0)), _mm_shuffle_epi32(odd, _MM_SHUFFLE(0, 0, 2, 0)));
+}
+
+inline __m128i WidenPixel(uint32_t pixel)
+{
+    const __m128i zero = _mm_setzero_si128();
+    return _mm_unpacklo_epi16(_mm_unpacklo_epi8(_mm_cvtsi32_si128(int(pixel)), zero), zero);
+}
+
+// Four 32-bit sums -> four saturated bytes. Sums are at most 256 after the shift, so the signed
+// 32->16 pack cannot overflow and the final unsigned pack does the clamping.
+inline uint32_t NarrowPixel(__m128i v)
+{
+    v = _mm_packs_epi32(v, v);
+    return uint32_t(_mm_cvtsi128_si32(_mm_packus_epi16(v, v)));
+}
+
+// Horizontal box pass keeping the four channel sums of the window in one register.
+void BoxRowSse2(const uint32_t* src, uint32_t* dst, int width, int radius, uint32_t mul)
+{
+    const __m128i mulv  = _mm_set1_epi32(int(mul));
+    const __m128i round = _mm_set1_epi32(0x8000);
+    auto          at    = [&](int x) { return WidenPixel(src[std::max(0, std::min(x, width - 1))]); };
+    __m128i       sum   = _mm_setzero_si128();
+    for (int k = -radius; k <= radius; ++k) sum = _mm_add_epi32(sum, at(k));
+    for (int x = 0; x < width; ++x)
+    {
+        dst[x] = NarrowPixel(_mm_srli_epi32(_mm_add_epi32(MulLo32Sse2(sum, mulv), round), 16));
+        sum    = _mm_sub_epi32(_mm_add_epi32(sum, at(x + radius + 1)), at(x - radius));
+    }
+}
+
+// Vertical box pass, four bytes per step. Returns how many bytes of [begin, end) were done.
+size_t BoxColumnsSse2(ImageView src, ImageView dst, size_t begin, size_t end, int radius, uint32_t mul,
+                      std::vector<uint32_t>& sums)
+{
+    const size_t bytes = (end - begin) & ~size_t(3);
+    sums.assign(bytes, 0);
+    const __m128i mulv  = _mm_set1_epi32(int(mul));
+    const __m128i round = _mm_set1_epi32(0x8000);
+    auto          row   = [&](int y) { return src.Row(std::max(0, std::min(y, src.height - 1))) + begin; };
+    auto          load  = [](const uint8_t* p) {
+        uint32_t v;
+        std::memcpy(&v, p, 4);
+        return WidenPixel(v);
+    };
+
+    for (int k = -radius; k <= radius; ++k)
+    {
+        const uint8_t* in = row(k);
+        for (size_t i = 0; i < bytes; i += 4)
+        {
+            __m128i* s = reinterpret_cast<__m128i*>(&sums[i]);
+            _mm_storeu_si128(s, _mm_add_epi32(_mm_loadu_si128(s), load(in + i)));
+        }
+    }
+    for (int y = 0; y < src.height; ++y)
+    {
+        uint8_t*       out      = dst.Row(y) + begin;
+        const uint8_t* incoming = row(y + radius + 1);
+        const uint8_t* outgoing = row(y - radius);
+        for (size_t i = 0; i < bytes; i += 4)
+        {
+            __m128i*       s     = reinterpret_cast<__m128i*>(&sums[i]);
+            const __m128i  sum   = _mm_loadu_si128(s);
+            const uint32_t value = NarrowPixel(_mm_srli_epi32(_mm_add_epi32(MulLo32Sse2(sum, mulv), round), 16));
+            std::memcpy(out + i, &value, 4);
+            _mm_storeu_si128(s, _mm_sub_epi32(_mm_add_epi32(sum, load(incoming + i)), load(outgoing + i)));
+        }
+    }
+    return bytes;
+}
+
+// Vertical box pass, eight bytes per step.
+__attribute__((target("avx2"))) size_t BoxColumnsAvx2(ImageView src, ImageView dst, size_t begin, size_t end,
+                                                      int radius, uint32_t mul, std::vector<uint32_t>& sums)
+{
+    const size_t bytes = (end - begin) & ~size_t(7);
+    sums.assign(bytes, 0);
+    const __m256i mulv    = _mm256_set1_epi32(int(mul));
+    const __m256i round   = _mm256_set1_epi32(0x8000);
+    const __m256i gather  = _mm256_setr_epi32(0, 4, 1, 1, 1, 1, 1, 1);
+    auto          row     = [&](int y) { return src.Row(std::max(0, std::min(y, src.height - 1))) + begin; };
+
+    for (int k = -radius; k <= radius; ++k)
+    {
+        const uint8_t* in = row(k);
+        for (size_t i = 0; i < bytes; i += 8)
+        {
+            __m256i*      s = reinterpret_cast<__m256i*>(&sums[i]);
+            const __m256i v = _mm256_cvtepu8_epi32(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(in + i)));
+            _mm256_storeu_si256(s, _mm256_add_epi32(_mm256_loadu_si256(s), v));
+        }
+    }
+    for (int y = 0; y < src.height; ++y)
+    {
+        uint8_t*       out      = dst.Row(y) + begin;
+        const uint8_t* incoming = row(y + radius + 1);
+        const uint8_t* outgoing = row(y - radius);
+        for (size_t i = 0; i < bytes; i += 8)
+        {
+            __m256i*      s   = reinterpret_cast<__m256i*>(&sums[i]);
+            const __m256i sum = _mm256_loadu_si256(s);
+            __m256i       avg = _mm256_srli_epi32(_mm256_add_epi32(_mm256_mullo_epi32(sum, mulv), round), 16);
+            avg               = _mm256_packus_epi32(avg, avg);
+            avg               = _mm256_packus_epi16(avg, avg);
+            // Bytes 0-3 of each 128-bit lane hold the results, bring them together.
+            avg = _mm256_permutevar8x32_epi32(avg, gather);
+            _mm_storel_epi64(reinterpret_cast<__m128i*>(out + i), _mm256_castsi256_si128(avg));
+
+            const __m256i in  = _mm256_cvtepu8_epi32(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(incoming + i)));
+            const __m256i old = _mm256_cvtepu8_epi32(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(outgoing + i)));
+            _mm256_storeu_si256(s, _mm256_sub_epi32(_mm256_add_epi32(sum, in), old));
+        }
+    }
+    return bytes;
+}
+
+// Horizontal resize pass: taps are consumed in pairs with pmaddwd, which multiplies the
+// interleaved channels of two pixels by their two weights and adds the products.
+void ResizeRowSse2(const uint32_t* src, uint32_t* dst, const ResizeCoefficients& coefficients, int width)
+{
+    const __m128i zero  = _mm_setzero_si128();
+    const __m128i round = _mm_set1_epi32(1 << (ResizeCoefficients::kWeightBits - 1));
+    const int     taps  = coefficients.taps;
+    for (int x = 0; x < width; ++x)
+    {
+        const uint32_t* in      = src + coefficients.first[size_t(x)];
+        const int16_t*  weights = coefficients.Weights(x);
+        __m128i         sum     = _mm_setzero_si128();
+        for (int k = 0; k < taps; k += 2)
+        {
+            const bool     pair = k + 1 < taps;
+            const uint32_t w0   = uint16_t(weights[k]);
+            const uint32_t w1   = pair ? uint16_t(weights[k + 1]) : 0;
+            const __m128i  p    = _mm_unpacklo_epi8(_mm_cvtsi32_si128(int(in[k])), _mm_cvtsi32_si128(int(in[pair ? k + 1 : k])));
+            sum = _mm_add_epi32(sum, _mm_madd_epi16(_mm_unpacklo_epi8(p, zero), _mm_set1_epi32(int(w0 | w1 << 16))));
+        }
+        dst[x] = NarrowPixel(_mm_srai_epi32(_mm_add_epi32(sum, round), ResizeCoefficients::kWeightBits));
+    }
+}
+
+// Vertical resize pass for one output row, 16 bytes per step. Returns the bytes done.
+size_t ResizeColumnsSse2(const uint8_t* const* rows, const int16_t* weights, int taps, uint8_t* out, size_t bytes)
+{
+    const __m128i zero  = _mm_setzero_si128();
+    const __m128i round = _mm_set1_epi32(1 << (ResizeCoefficients::kWeightBits - 1));
+    size_t        i     = 0;
+    for (; i + 16 <= bytes; i += 16)
+    {
+        __m128i acc[4] = {zero, zero, zero, zero};
+        for (int k = 0; k < taps; k += 2)
+        {
+            const bool    pair = k + 1 < taps;
+            const __m128i w    = _mm_set1_epi32(int(uint32_t(uint16_t(weights[k])) | uint32_t(pair ? uint16_t(weights[k + 1]) : 0) << 16));
+            const __m128i a    = _mm_loadu_si128(reinterpret_cast<const __m128i*>(rows[k] + i));
+            const __m128i b    = _mm_loadu_si128(reinterpret_cast<const __m128i*>(rows[pair ? k + 1 : k] + i));
+            const __m128i lo   = _mm_unpacklo_epi8(a, b);
+            const __m128i hi   = _mm_unpackhi_epi8(a, b);
+            acc[0]             = _mm_add_epi32(acc[0], _mm_madd_epi16(_mm_unpacklo_epi8(lo, zero), w));
+            acc[1]             = _mm_add_epi32(acc[1], _mm_madd_epi16(_mm_unpackhi_epi8(lo, zero), w));
+            acc[2]             = _mm_add_epi32(acc[2], _mm_madd_epi16(_mm_unpacklo_epi8(hi, zero), w));
+            acc[3]             = _mm_add_epi32(acc[3], _mm_madd_epi16(_mm_unpackhi_epi8(hi, zero), w));
+        }
+        for (auto& a : acc) a = _mm_srai_epi32(_mm_add_epi32(a, round), ResizeCoefficients::kWeightBits);
+        const __m128i packed = _mm_packus_epi16(_mm_packs_epi32(acc[0], acc[1]), _mm_packs_epi32(acc[2], acc[3]));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(out + i), packed);
+    }
+    return i;
+}
+
+// Same as the SSE2 version on 32 bytes. Unpack and pack both work within 128-bit lanes, so the
+// bytes come out in their original order without a permute.
+__attribute__((target("avx2"))) size_t ResizeColumnsAvx2(const uint8_t* const* rows, const int16_t* weights, int taps,
+                                                         uint8_t* out, size_t bytes)
+{
+    const __m256i zero  = _mm256_setzero_si256();
+    const __m256i round = _mm256_set1_epi32(1 << (ResizeCoefficients::kWeightBits - 1));
+    size_t        i     = 0;
+    for (; i + 32 <= bytes; i += 32)
+    {
+        __m256i acc[4] = {zero, zero, zero, zero};
+        for (int k = 0; k < taps; k += 2)
+        {
+            const bool    pair = k + 1 < taps;
+            const __m256i w    = _mm256_set1_epi32(int(uint32_t(uint16_t(weights[k])) | uint32_t(pair ? uint16_t(weights[k + 1]) : 0) << 16));
+            const __m256i a    = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(rows[k] + i));
+            const __m256i b    = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(rows[pair ? k + 1 : k] + i));
+            const __m256i lo   = _mm256_unpacklo_epi8(a, b);
+            const __m256i hi   = _mm256_unpackhi_epi8(a, b);
+            acc[0]             = _mm256_add_epi32(acc[0], _mm256_madd_epi16(_mm256_unpacklo_epi8(lo, zero), w));
+            acc[1]             = _mm256_add_epi32(acc[1], _mm256_madd_epi16(_mm256_unpackhi_epi8(lo, zero), w));
+            acc[2]             = _mm256_add_epi32(acc[2], _mm256_madd_epi16(_mm256_unpacklo_epi8(hi, zero), w));
+            acc[3]             = _mm256_add_epi32(acc[3], _mm256_madd_epi16(_mm256_unpackhi_epi8(hi, zero), w));
+        }
+        for (auto& a : acc) a = _mm256_srai_epi32(_mm256_add_epi32(a, round), ResizeCoefficients::kWeightBits);
+        const __m256i packed = _mm256_packus_epi16(_mm256_packs_epi32(acc[0], acc[1]), _mm256_packs_epi32(acc[2], acc[3]));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(out + i), packed);
+    }
+    return i;
+}
+
+#endif // GM_IMAGE_KERNELS_X86
+
+template<typename RowFunction>
+void ForEachRow(ImageView image, WorkerPool& pool, RowFunction function)
+{
+    pool.ParallelFor(size_t(image.height), RowGrain(image.width), [&](size_t begin, size_t end) {
+        for (size_t y = begin; y < end; ++y) function(PixelRow(image, int(y)));
+    });
+}
+
+// Vertical passes split the row into stripes narrow enough for their running sums to stay in L1.
+constexpr size_t kStripeBytes = 1024;
+
+} // namespace
+
+SimdLevel ActiveSimdLevel()
+{
+    static const SimdLevel detected = DetectSimdLevel();
+    return std::min(detected, static_cast<SimdLevel>(g_max_level.load(std::memory_order_relaxed)));
+}
+
+void SetMaxSimdLevel(SimdLevel level) { g_max_level.store(static_cast<int>(level), std::memory_order_relaxed); }
+
+void Premultiply(ImageView image, WorkerPool& pool)
+{
+    if (image.IsEmpty()) return;
+    const SimdLevel level = ActiveSimdLevel();
+    ForEachRow(image, pool, [&](uint32_t* row) {
+        int x = 0;
+#if GM_IMAGE_KERNELS_X86
+        if (level == SimdLevel::Avx2) x = PremultiplyAvx2(row, image.width);
+        else if (level == SimdLevel::Sse2) x = PremultiplySse2(row, image.width);
+#endif
+        for (; x < image.width; ++x) row[x] = PremultiplyPixel(row[x]);
+    });
+}
+
+void Unpremultiply(ImageView image, WorkerPool& pool)
+{
+    if (image.IsEmpty()) return;
+    const SimdLevel level = ActiveSimdLevel();
+    const uint32_t* table = InverseAlpha().values;
+    ForEachRow(image, pool, [&](uint32_t* row) {
+        int x = 0;
+#if GM_IMAGE_KERNELS_X86
+        // There is no SSE2 path: the per-pixel reciprocal needs a gather and 32-bit multiplies.
+        if (level == SimdLevel::Avx2) x = UnpremultiplyAvx2(row, image.width, table);
+#endif
+        for (; x < image.width; ++x) row[x] = UnpremultiplyPixel(row[x], table);
+    });
+}
+
+void BoxBlur(ImageView image, int radius, WorkerPool& pool)
+{
+    if (radius <= 0 || image.IsEmpty()) return;
+    const SimdLevel level = ActiveSimdLevel();
+    const uint32_t  mul   = BoxMultiplier(radius);
+
+    // Horizontal pass into a scratch image, vertical pass back into `image`.
+    std::vector<uint32_t> scratch(size_t(image.width) * size_t(image.height));
+    ImageView             temp{reinterpret_cast<uint8_t*>(scratch.data()), image.width, image.height,
+                   ptrdiff_t(image.width) * 4};
+
+    pool.ParallelFor(size_t(image.height), RowGrain(image.width), [&](size_t begin, size_t end) {
+        for (size_t y = begin; y < end; ++y)
+        {
+#if GM_IMAGE_KERNELS_X86
+            if (level != SimdLevel::Scalar)
+            {
+                BoxRowSse2(PixelRow(image, int(y)), PixelRow(temp, int(y)), image.width, radius, mul);
+                continue;
+            }
+#endif
+            BoxRowScalar(PixelRow(image, int(y)), PixelRow(temp, int(y)), image.width, radius, mul);
+        }
+    });
+
+    const size_t row_bytes = size_t(image.width) * 4;
+    const size_t stripes   = (row_bytes + kStripeBytes - 1) / kStripeBytes;
+    pool.ParallelFor(stripes, 1, [&](size_t first, size_t last) {
+        std::vector<uint32_t> sums;
+        for (size_t stripe = first; stripe < last; ++stripe)
+        {
+            const size_t begin = stripe * kStripeBytes;
+            const size_t end   = std::min(row_bytes, begin + kStripeBytes);
+            size_t       done  = 0;
+#if GM_IMAGE_KERNELS_X86
+            if (level == SimdLevel::Avx2) done = BoxColumnsAvx2(temp, image, begin, end, radius, mul, sums);
+            else if (level == SimdLevel::Sse2) done = BoxColumnsSse2(temp, image, begin, end, radius, mul, sums);
+#endif
+            if (begin + done < end) BoxColumnsScalar(temp, image, begin + done, end, radius, mul, sums);
+        }
+    });
+}
+
+void GaussianBoxRadii(double sigma, int radii[3])
+{
+    // Widths of three box filters whose convolution has the requested variance.
+    const int    passes = 3;
+    const double ideal  = std::sqrt(12 * sigma * sigma / passes + 1);
+    int          lower  = static_cast<int>(std::floor(ideal));
+    if (lower % 2 == 0) --lower;
+    const int upper = lower + 2;
+    const int count = static_cast<int>(std::lround((12 * sigma * sigma - passes * lower * lower - 4 * passes * lower - 3 * passes) /
+                                                   (-4.0 * lower - 4)));
+    for (int i = 0; i < passes; ++i) radii[i] = ((i < count ? lower : upper) - 1) / 2;
+}
+
+void GaussianBlur(ImageView image, double sigma, WorkerPool& pool)
+{
+    if (sigma <= 0) return;
+    int radii[3];
+    GaussianBoxRadii(sigma, radii);
+    for (int radius : radii) BoxBlur(image, radius, pool);
+}
+
+void Resize(ImageView source, ImageView destination, ResizeFilter filter, WorkerPool& pool)
+{
+    if (source.IsEmpty() || destination.IsEmpty()) return;
+    const SimdLevel level      = ActiveSimdLevel();
+    const auto      horizontal = ComputeResizeCoefficients(source.width, destination.width, filter);
+    const auto      vertical   = ComputeResizeCoefficients(source.height, destination.height, filter);
+
+    std::vector<uint32_t> scratch(size_t(destination.width) * size_t(source.height));
+    ImageView             temp{reinterpret_cast<uint8_t*>(scratch.data()), destination.width, source.height,
+                   ptrdiff_t(destination.width) * 4};
+
+    pool.ParallelFor(size_t(source.height), RowGrain(destination.width), [&](size_t begin, size_t end) {
+        for (size_t y = begin; y < end; ++y)
+        {
+#if GM_IMAGE_KERNELS_X86
+            if (level != SimdLevel::Scalar)
+            {
+                ResizeRowSse2(PixelRow(source, int(y)), PixelRow(temp, int(y)), horizontal, destination.width);
+                continue;
+            }
+#endif
+            ResizeRowScalar(PixelRow(source, int(y)), PixelRow(temp, int(y)), horizontal, destination.width);
+        }
+    });
+
+    const size_t row_bytes = size_t(destination.width) * 4;
+    pool.ParallelFor(size_t(destination.height), RowGrain(destination.width), [&](size_t begin, size_t end) {
+        std::vector<const uint8_t*> rows(size_t(vertical.taps));
+        for (size_t y = begin; y < end; ++y)
+        {
+            for (int k = 0; k < vertical.taps; ++k) rows[size_t(k)] = temp.Row(vertical.first[y] + k);
+            const int16_t* weights = vertical.Weights(int(y));
+            uint8_t*       out     = destination.Row(int(y));
+            size_t         done    = 0;
+#if GM_IMAGE_KERNELS_X86
+            if (level == SimdLevel::Avx2) done = ResizeColumnsAvx2(rows.data(), weights, vertical.taps, out, row_bytes);
+            else if (level == SimdLevel::Sse2) done = ResizeColumnsSse2(rows.data(), weights, vertical.taps, out, row_bytes);
+#endif
+            ResizeColumnsScalar(rows.data(), weights, vertical.taps, out, done, row_bytes);
+        }
+    });
+}
+
+} // namespace gomarky
@@ -0,0 +1,52 @@
+#pragma once
+
+#include "image/image_view.h"
+
+namespace gomarky
+{
+
+class WorkerPool;
+
+// Image processing kernels over premultiplied ARGB32 buffers.
+//
+// Every kernel has a scalar implementation plus SSE2 and/or AVX2 paths picked at runtime, and
+// splits its work across the pool by rows (or column stripes for vertical passes). All paths use
+// the same fixed-point arithmetic, so results are bit-identical whichever one runs; see
+// image_reference.h for the straightforward definitions they are tested against.
+
+enum class SimdLevel
+{
+    Scalar,
+    Sse2,
+    Avx2,
+};
+
+/// Best level supported by this CPU, capped by SetMaxSimdLevel().
+SimdLevel ActiveSimdLevel();
+
+/// Cap the level used by the kernels, to compare paths in tests and benchmarks.
+void SetMaxSimdLevel(SimdLevel level);
+
+void Premultiply(ImageView image, WorkerPool& pool);
+void Unpremultiply(ImageView image, WorkerPool& pool);
+
+/// Box blur of the given radius in both directions, edges are clamped. Operates in place.
+void BoxBlur(ImageView image, int radius, WorkerPool& pool);
+
+/// Gaussian blur approximated by three successive box blurs.
+void GaussianBlur(ImageView image, double sigma, WorkerPool& pool);
+
+/// Box radii of the three passes GaussianBlur uses for `sigma`.
+void GaussianBoxRadii(double sigma, int radii[3]);
+
+enum class ResizeFilter
+{
+    Box,      ///< area average, best for large downscales
+    Triangle, ///< bilinear
+    Lanczos3, ///< sharpest, may ring on hard edges
+};
+
+/// Resample `source` into `destination` using a separable filter. The views must not overlap.
+void Resize(ImageView source, ImageView destination, ResizeFilter filter, WorkerPool& pool);
+
+} // namespace gomarky
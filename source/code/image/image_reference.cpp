@@ -0,0 +1,165 @@
+#include "image/image_reference.h"
+
+#include <algorithm>
+#include <cstring>
+#include <vector>
+
+#include "image/resize_coefficients.h"
+
+namespace gomarky
+{
+namespace reference
+{
+
+namespace
+{
+
+uint32_t& Pixel(ImageView image, int x, int y) { return reinterpret_cast<uint32_t*>(image.Row(y))[x]; }
+
+int Channel(uint32_t pixel, int channel) { return (pixel >> (8 * channel)) & 0xff; }
+
+// Round c * a / 255 to nearest.
+int MultiplyDiv255(int c, int a)
+{
+    const int t = c * a + 128;
+    return (t + (t >> 8)) >> 8;
+}
+
+} // namespace
+
+void Premultiply(ImageView image)
+{
+    for (int y = 0; y < image.height; ++y)
+    {
+        for (int x = 0; x < image.width; ++x)
+        {
+            uint32_t& pixel = Pixel(image, x, y);
+            const int a     = Channel(pixel, 3);
+            uint32_t  out   = uint32_t(a) << 24;
+            for (int c = 0; c < 3; ++c) out |= uint32_t(MultiplyDiv255(Channel(pixel, c), a)) << (8 * c);
+            pixel = out;
+        }
+    }
+}
+
+void Unpremultiply(ImageView image)
+{
+    for (int y = 0; y < image.height; ++y)
+    {
+        for (int x = 0; x < image.width; ++x)
+        {
+            uint32_t& pixel = Pixel(image, x, y);
+            const int a     = Channel(pixel, 3);
+            // 16.16 reciprocal of a / 255, the same one Qt uses.
+            const uint32_t inverse = a == 0 ? 0 : ((255u << 16) + uint32_t(a) / 2) / uint32_t(a);
+            uint32_t       out     = uint32_t(a) << 24;
+            for (int c = 0; c < 3; ++c)
+            {
+                const uint32_t value = (uint32_t(Channel(pixel, c)) * inverse + 0x8000) >> 16;
+                out |= std::min(value, 255u) << (8 * c);
+            }
+            pixel = out;
+        }
+    }
+}
+
+void BoxBlur(ImageView image, int radius)
+{
+    if (radius <= 0 || image.IsEmpty()) return;
+
+    const uint32_t diameter = uint32_t(2 * radius + 1);
+    const uint32_t mul      = (65536 + diameter / 2) / diameter;
+    auto           average  = [mul](uint32_t sum) { return std::min<uint32_t>((sum * mul + 0x8000) >> 16, 255); };
+
+    std::vector<uint32_t> horizontal(size_t(image.width) * size_t(image.height));
+    for (int y = 0; y < image.height; ++y)
+    {
+        for (int x = 0; x < image.width; ++x)
+        {
+            uint32_t out = 0;
+            for (int c = 0; c < 4; ++c)
+            {
+                uint32_t sum = 0;
+                for (int k = -radius; k <= radius; ++k)
+                {
+                    sum += uint32_t(Channel(Pixel(image, std::max(0, std::min(x + k, image.width - 1)), y), c));
+                }
+                out |= average(sum) << (8 * c);
+            }
+            horizontal[size_t(y) * size_t(image.width) + size_t(x)] = out;
+        }
+    }
+
+    for (int y = 0; y < image.height; ++y)
+    {
+        for (int x = 0; x < image.width; ++x)
+        {
+            uint32_t out = 0;
+            for (int c = 0; c < 4; ++c)
+            {
+                uint32_t sum = 0;
+                for (int k = -radius; k <= radius; ++k)
+                {
+                    const int row = std::max(0, std::min(y + k, image.height - 1));
+                    sum += uint32_t(Channel(horizontal[size_t(row) * size_t(image.width) + size_t(x)], c));
+                }
+                out |= average(sum) << (8 * c);
+            }
+            Pixel(image, x, y) = out;
+        }
+    }
+}
+
+void Resize(ImageView source, ImageView destination, ResizeFilter filter)
+{
+    if (source.IsEmpty() || destination.IsEmpty()) return;
+
+    const auto horizontal = ComputeResizeCoefficients(source.width, destination.width, filter);
+    const auto vertical   = ComputeResizeCoefficients(source.height, destination.height, filter);
+    const int  bits       = ResizeCoefficients::kWeightBits;
+    auto       round      = [bits](int32_t sum) {
+        return uint32_t(std::max(0, std::min((sum + (1 << (bits - 1))) >> bits, 255)));
+    };
+
+    // Horizontal pass first, rounded back to 8 bits per channel.
+    std::vector<uint32_t> pass(size_t(destination.width) * size_t(source.height));
+    for (int y = 0; y < source.height; ++y)
+    {
+        for (int x = 0; x < destination.width; ++x)
+        {
+            uint32_t out = 0;
+            for (int c = 0; c < 4; ++c)
+            {
+                int32_t sum = 0;
+                for (int k = 0; k < horizontal.taps; ++k)
+                {
+                    sum += horizontal.Weights(x)[k] * Channel(Pixel(source, horizontal.first[size_t(x)] + k, y), c);
+                }
+                out |= round(sum) << (8 * c);
+            }
+            pass[size_t(y) * size_t(destination.width) + size_t(x)] = out;
+        }
+    }
+
+    for (int y = 0; y < destination.height; ++y)
+    {
+        for (int x = 0; x < destination.width; ++x)
+        {
+            uint32_t out = 0;
+            for (int c = 0; c < 4; ++c)
+            {
+                int32_t sum = 0;
+                for (int k = 0; k < vertical.taps; ++k)
+                {
+                    const int row = vertical.first[size_t(y)] + k;
+                    sum += vertical.Weights(y)[k] * Channel(pass[size_t(row) * size_t(destination.width) + size_t(x)], c);
+                }
+                out |= round(sum) << (8 * c);
+            }
+            Pixel(destination, x, y) = out;
+        }
+    }
+}
+
+} // namespace reference
+} // namespace gomarky
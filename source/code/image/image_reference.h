@@ -0,0 +1,19 @@
+#pragma once
+
+#include "image/image_kernels.h"
+
+namespace gomarky
+{
+namespace reference
+{
+
+// Single-threaded, unvectorized definitions of the image kernels, written for clarity rather
+// than speed. The optimized kernels must produce exactly the same bytes.
+
+void Premultiply(ImageView image);
+void Unpremultiply(ImageView image);
+void BoxBlur(ImageView image, int radius);
+void Resize(ImageView source, ImageView destination, ResizeFilter filter);
+
+} // namespace reference
+} // namespace gomarky
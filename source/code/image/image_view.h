@@ -0,0 +1,22 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace gomarky
+{
+
+/// Non-owning view of a 32-bit-per-pixel image, e.g. the bits of a QImage.
+/// Pixels are 0xAARRGGBB words in native byte order, like QImage::Format_ARGB32(_Premultiplied).
+struct ImageView
+{
+    uint8_t*  data   = nullptr;
+    int       width  = 0;
+    int       height = 0;
+    ptrdiff_t stride = 0; ///< bytes from one row to the next
+
+    uint8_t* Row(int y) const { return data + y * stride; }
+    bool     IsEmpty() const { return data == nullptr || width <= 0 || height <= 0; }
+};
+
+} // namespace gomarky
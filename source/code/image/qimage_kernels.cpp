@@ -0,0 +1,63 @@
+#include "image/qimage_kernels.h"
+
+#include "concurrency/worker_pool.h"
+
+namespace gomarky
+{
+
+namespace
+{
+
+ImageView ViewOf(QImage& image)
+{
+    return {image.bits(), image.width(), image.height(), static_cast<ptrdiff_t>(image.bytesPerLine())};
+}
+
+} // namespace
+
+ImageView PremultipliedView(QImage& image, WorkerPool& pool)
+{
+    switch (image.format())
+    {
+    case QImage::Format_ARGB32_Premultiplied:
+    case QImage::Format_RGB32: // alpha is always 0xff, which is already premultiplied
+        break;
+    case QImage::Format_ARGB32:
+        // Same layout, so premultiply the pixels where they are instead of converting.
+        Premultiply(ViewOf(image), pool);
+        image.reinterpretAsFormat(QImage::Format_ARGB32_Premultiplied);
+        break;
+    default: image = image.convertToFormat(QImage::Format_ARGB32_Premultiplied); break;
+    }
+    return ViewOf(image);
+}
+
+QImage ScaleImage(const QImage& image, const QSize& size, ResizeFilter filter, WorkerPool& pool)
+{
+    if (image.isNull() || size.isEmpty()) return QImage();
+
+    QImage    source = image; // shallow copy, only detached if a conversion is needed
+    ImageView input  = source.format() == QImage::Format_ARGB32_Premultiplied || source.format() == QImage::Format_RGB32
+                          ? ImageView{const_cast<uchar*>(source.constBits()), source.width(), source.height(),
+                                     static_cast<ptrdiff_t>(source.bytesPerLine())}
+                          : PremultipliedView(source, pool);
+
+    QImage result(size, source.format());
+    Resize(input, ViewOf(result), filter, pool);
+    return result;
+}
+
+QImage ScaleImage(const QImage& image, const QSize& size, ResizeFilter filter)
+{
+    return ScaleImage(image, size, filter, WorkerPool::Global());
+}
+
+void BlurImage(QImage& image, double sigma, WorkerPool& pool)
+{
+    if (image.isNull()) return;
+    GaussianBlur(PremultipliedView(image, pool), sigma, pool);
+}
+
+void BlurImage(QImage& image, double sigma) { BlurImage(image, sigma, WorkerPool::Global()); }
+
+} // namespace gomarky
@@ -0,0 +1,27 @@
+#pragma once
+
+#include <QImage>
+#include <QSize>
+
+#include "image/image_kernels.h"
+
+namespace gomarky
+{
+
+class WorkerPool;
+
+// QImage front-ends for the image kernels. They work directly on the QImage's pixel buffer;
+// the only copies are Qt's own detach of a shared image and the conversion of formats the kernels
+// cannot read (anything that is not 32-bit ARGB/RGB).
+
+/// View over the pixels of `image`, converted in place to premultiplied ARGB32 if needed.
+ImageView PremultipliedView(QImage& image, WorkerPool& pool);
+
+/// High-quality resize, a multithreaded replacement for QImage::scaled(SmoothTransformation).
+QImage ScaleImage(const QImage& image, const QSize& size, ResizeFilter filter, WorkerPool& pool);
+QImage ScaleImage(const QImage& image, const QSize& size, ResizeFilter filter = ResizeFilter::Triangle);
+
+void BlurImage(QImage& image, double sigma, WorkerPool& pool);
+void BlurImage(QImage& image, double sigma);
+
+} // namespace gomarky
@@ -0,0 +1,103 @@
+#include "image/resize_coefficients.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace gomarky
+{
+
+constexpr int ResizeCoefficients::kWeightBits;
+
+namespace
+{
+
+const double kPi = 3.14159265358979323846;
+
+double Support(ResizeFilter filter)
+{
+    switch (filter)
+    {
+    case ResizeFilter::Box: return 0.5;
+    case ResizeFilter::Triangle: return 1.0;
+    case ResizeFilter::Lanczos3: return 3.0;
+    }
+    return 1.0;
+}
+
+double Sinc(double x)
+{
+    if (std::abs(x) < 1e-8) return 1.0;
+    x *= kPi;
+    return std::sin(x) / x;
+}
+
+double Evaluate(ResizeFilter filter, double x)
+{
+    switch (filter)
+    {
+    case ResizeFilter::Box: return (x >= -0.5 && x < 0.5) ? 1.0 : 0.0;
+    case ResizeFilter::Triangle: return std::max(0.0, 1.0 - std::abs(x));
+    case ResizeFilter::Lanczos3: return std::abs(x) < 3.0 ? Sinc(x) * Sinc(x / 3.0) : 0.0;
+    }
+    return 0.0;
+}
+
+} // namespace
+
+ResizeCoefficients ComputeResizeCoefficients(int input_size, int output_size, ResizeFilter filter)
+{
+    ResizeCoefficients result;
+    if (input_size <= 0 || output_size <= 0) return result;
+
+    // When downscaling the filter is stretched to cover every input sample.
+    const double scale   = double(input_size) / output_size;
+    const double stretch = std::max(1.0, scale);
+    const double support = Support(filter) * stretch;
+
+    result.taps = std::min(input_size, static_cast<int>(std::ceil(2 * support)) + 1);
+    result.first.resize(static_cast<size_t>(output_size));
+    result.weights.assign(static_cast<size_t>(output_size * result.taps), 0);
+
+    std::vector<double> window(static_cast<size_t>(result.taps));
+    for (int o = 0; o < output_size; ++o)
+    {
+        const double center = (o + 0.5) * scale;
+        const int    lo     = static_cast<int>(std::floor(center - support));
+        const int    hi     = static_cast<int>(std::ceil(center + support));
+        const int    first  = std::max(0, std::min(lo, input_size - result.taps));
+        result.first[static_cast<size_t>(o)] = first;
+
+        std::fill(window.begin(), window.end(), 0.0);
+        double total = 0;
+        for (int i = lo; i <= hi; ++i)
+        {
+            const double weight = Evaluate(filter, (i + 0.5 - center) / stretch);
+            if (weight == 0) continue;
+            const int clamped = std::max(0, std::min(i, input_size - 1));
+            window[static_cast<size_t>(clamped - first)] += weight;
+            total += weight;
+        }
+        if (total == 0)
+        {
+            // Can only happen for degenerate box filters; fall back to the nearest sample.
+            const int nearest = std::max(0, std::min(static_cast<int>(center), input_size - 1));
+            window[static_cast<size_t>(nearest - first)] = total = 1.0;
+        }
+
+        // Round to fixed point, then give the rounding error to the largest weight so that the
+        // weights sum to exactly one and flat areas stay flat.
+        int16_t* weights = result.weights.data() + o * result.taps;
+        int      sum     = 0;
+        int      largest = 0;
+        for (int k = 0; k < result.taps; ++k)
+        {
+            weights[k] = static_cast<int16_t>(std::lround(window[static_cast<size_t>(k)] / total * (1 << ResizeCoefficients::kWeightBits)));
+            sum += weights[k];
+            if (std::abs(weights[k]) > std::abs(weights[largest])) largest = k;
+        }
+        weights[largest] = static_cast<int16_t>(weights[largest] + (1 << ResizeCoefficients::kWeightBits) - sum);
+    }
+    return result;
+}
+
+} // namespace gomarky
@@ -0,0 +1,27 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "image/image_kernels.h"
+
+namespace gomarky
+{
+
+/// Fixed-point weights for one axis of a separable resize.
+/// Output sample `o` reads the `taps` input samples starting at `first[o]`, all in range; taps
+/// that would fall outside the image have been folded onto the edge sample.
+struct ResizeCoefficients
+{
+    static constexpr int kWeightBits = 14; ///< weights of one output sum to 1 << kWeightBits
+
+    int                  taps = 0;
+    std::vector<int>     first;
+    std::vector<int16_t> weights; ///< `taps` weights per output sample
+
+    const int16_t* Weights(int output) const { return weights.data() + output * taps; }
+};
+
+ResizeCoefficients ComputeResizeCoefficients(int input_size, int output_size, ResizeFilter filter);
+
+} // namespace gomarky
@@ -0,0 +1,744 @@
+#include "io/async_file_io.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <stdexcept>
+#include <system_error>
+#include <utility>
+
+#include "concurrency/worker_pool.h"
+
+#if defined(_WIN32)
+#define NOMINMAX
+#include <io.h>
+#include <windows.h>
+#else
+#include <unistd.h>
+#endif
+
+#if defined(__linux__) && defined(__has_include)
+#if __has_include(<linux/io_uring.h>)
+#include <linux/io_uring.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <sys/uio.h>
+#if defined(SYS_io_uring_setup) && defined(SYS_io_uring_enter) && defined(SYS_io_uring_register)
+#define GM_IO_URING 1
+#endif
+#endif
+#endif
+
+#if !defined(GM_IO_URING)
+#define GM_IO_URING 0
+#endif
+
+#if defined(__SANITIZE_THREAD__)
+#define GM_TSAN 1
+#elif defined(__has_feature)
+#if __has_feature(thread_sanitizer)
+#define GM_TSAN 1
+#endif
+#endif
+
+#if defined(GM_TSAN)
+extern "C" void __tsan_acquire(void* address);
+extern "C" void __tsan_release(void* address);
+#endif
+
+namespace gomarky
+{
+
+namespace
+{
+
+constexpr size_t kBufferAlignment = 4096; ///< enough for O_DIRECT
+constexpr size_t kMaxTransfer     = size_t(1) << 30; ///< per kernel call; the rest is requested again
+
+enum class OperationKind
+{
+    Read,
+    Write,
+    Sync,
+};
+
+size_t BufferStride(size_t size) { return (size + kBufferAlignment - 1) / kBufferAlignment * kBufferAlignment; }
+
+#if GM_IO_URING
+// An operation passes from the submitting thread to the completion thread through the kernel,
+// which orders the two queues in a way ThreadSanitizer cannot see; these tell it.
+void HandOver(void* operation)
+{
+#if defined(GM_TSAN)
+    __tsan_release(operation);
+#else
+    (void)operation;
+#endif
+}
+
+void TakeOver(void* operation)
+{
+#if defined(GM_TSAN)
+    __tsan_acquire(operation);
+#else
+    (void)operation;
+#endif
+}
+#endif
+
+} // namespace
+
+struct AsyncFileIo::Operation
+{
+    OperationKind    kind   = OperationKind::Read;
+    int              fd     = -1;
+    uint64_t         offset = 0;
+    char*            data   = nullptr;
+    size_t           size   = 0;
+    IoBuffer         buffer; ///< set for requests through a registered buffer
+    Completion       done;
+    BufferCompletion buffer_done;
+    IoResult         result;
+#if GM_IO_URING
+    iovec vector;
+#endif
+};
+
+struct AsyncFileIo::Delivery
+{
+    std::vector<Operation*> operations;
+    std::atomic<bool>       claimed{false}; ///< by the dispatched task, or by the destructor
+};
+
+namespace
+{
+
+// The blocking version of an operation, for the thread pool backend.
+IoResult Transfer(OperationKind kind, int fd, uint64_t offset, char* data, size_t size)
+{
+    IoResult result;
+#if defined(_WIN32)
+    const HANDLE handle = reinterpret_cast<HANDLE>(_get_osfhandle(fd));
+    if (handle == INVALID_HANDLE_VALUE)
+    {
+        result.error = EBADF;
+        return result;
+    }
+    if (kind == OperationKind::Sync)
+    {
+        if (!FlushFileBuffers(handle)) result.error = EIO;
+        return result;
+    }
+    while (result.bytes < size)
+    {
+        const uint64_t position = offset + result.bytes;
+        OVERLAPPED     at       = {};
+        at.Offset               = static_cast<DWORD>(position);
+        at.OffsetHigh           = static_cast<DWORD>(position >> 32);
+        const DWORD chunk       = static_cast<DWORD>(std::min(size - result.bytes, kMaxTransfer));
+        DWORD       moved       = 0;
+        const BOOL  ok          = kind == OperationKind::Read
+                                      ? ReadFile(handle, data + result.bytes, chunk, &moved, &at)
+                                      : WriteFile(handle, data + result.bytes, chunk, &moved, &at);
+        if (!ok)
+        {
+            if (GetLastError() != ERROR_HANDLE_EOF) result.error = EIO;
+            break;
+        }
+        if (moved == 0) break;
+        result.bytes += moved;
+    }
+#else
+    if (kind == OperationKind::Sync)
+    {
+        if (fsync(fd) != 0) result.error = errno;
+        return result;
+    }
+    while (result.bytes < size)
+    {
+        const off_t   position = static_cast<off_t>(offset + result.bytes);
+        const ssize_t moved    = kind == OperationKind::Read
+                                     ? pread(fd, data + result.bytes, size - result.bytes, position)
+                                     : pwrite(fd, data + result.bytes, size - result.bytes, position);
+        if (moved < 0)
+        {
+            if (errno == EINTR) continue;
+            result.error = errno;
+            break;
+        }
+        if (moved == 0) break;
+        result.bytes += static_cast<size_t>(moved);
+    }
+#endif
+    return result;
+}
+
+} // namespace
+
+#if GM_IO_URING
+
+// A raw io_uring, driven through the system calls since liburing is not a dependency. The
+// kernel and this process share the ring indices, hence the acquire loads and release stores.
+struct AsyncFileIo::Ring
+{
+    int            fd         = -1;
+    unsigned       sq_entries = 0;
+    unsigned       sq_mask    = 0;
+    unsigned*      sq_head    = nullptr;
+    unsigned*      sq_tail    = nullptr;
+    unsigned*      sq_array   = nullptr;
+    io_uring_sqe*  sqes       = nullptr;
+    unsigned       cq_mask    = 0;
+    unsigned*      cq_head    = nullptr;
+    unsigned*      cq_tail    = nullptr;
+    io_uring_cqe*  cqes       = nullptr;
+    void*          sq_map     = nullptr;
+    size_t         sq_size    = 0;
+    void*          cq_map     = nullptr;
+    size_t         cq_size    = 0;
+    size_t         sqes_size  = 0;
+
+    ~Ring()
+    {
+        if (sqes) munmap(sqes, sqes_size);
+        if (cq_map && cq_map != sq_map) munmap(cq_map, cq_size);
+        if (sq_map) munmap(sq_map, sq_size);
+        if (fd >= 0) close(fd);
+    }
+
+    int Enter(unsigned submit, unsigned wait, unsigned flags)
+    {
+        return static_cast<int>(syscall(SYS_io_uring_enter, fd, submit, wait, flags, nullptr, 0));
+    }
+
+    // nullptr when the kernel has no io_uring or does not let this process use it.
+    static std::unique_ptr<Ring> Create(unsigned entries)
+    {
+        io_uring_params params;
+        std::memset(&params, 0, sizeof(params));
+        std::unique_ptr<Ring> ring(new Ring());
+        ring->fd = static_cast<int>(syscall(SYS_io_uring_setup, entries, &params));
+        if (ring->fd < 0) return nullptr;
+
+        ring->sq_size = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+        ring->cq_size = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+        bool single_mapping = false;
+#if defined(IORING_FEAT_SINGLE_MMAP)
+        single_mapping = (params.features & IORING_FEAT_SINGLE_MMAP) != 0;
+#endif
+        if (single_mapping) ring->sq_size = ring->cq_size = std::max(ring->sq_size, ring->cq_size);
+
+        ring->sq_map = mmap(nullptr, ring->sq_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring->fd,
+                            IORING_OFF_SQ_RING);
+        if (ring->sq_map == MAP_FAILED)
+        {
+            ring->sq_map = nullptr;
+            return nullptr;
+        }
+        ring->cq_map = single_mapping ? ring->sq_map
+                                      : mmap(nullptr, ring->cq_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                                             ring->fd, IORING_OFF_CQ_RING);
+        if (ring->cq_map == MAP_FAILED)
+        {
+            ring->cq_map = nullptr;
+            return nullptr;
+        }
+        ring->sqes_size = params.sq_entries * sizeof(io_uring_sqe);
+        void* sqes = mmap(nullptr, ring->sqes_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring->fd,
+                          IORING_OFF_SQES);
+        if (sqes == MAP_FAILED) return nullptr;
+        ring->sqes = static_cast<io_uring_sqe*>(sqes);
+
+        char* sq         = static_cast<char*>(ring->sq_map);
+        char* cq         = static_cast<char*>(ring->cq_map);
+        ring->sq_entries = params.sq_entries;
+        ring->sq_mask    = *reinterpret_cast<unsigned*>(sq + params.sq_off.ring_mask);
+        ring->sq_head    = reinterpret_cast<unsigned*>(sq + params.sq_off.head);
+        ring->sq_tail    = reinterpret_cast<unsigned*>(sq + params.sq_off.tail);
+        ring->sq_array   = reinterpret_cast<unsigned*>(sq + params.sq_off.array);
+        ring->cq_mask    = *reinterpret_cast<unsigned*>(cq + params.cq_off.ring_mask);
+        ring->cq_head    = reinterpret_cast<unsigned*>(cq + params.cq_off.head);
+        ring->cq_tail    = reinterpret_cast<unsigned*>(cq + params.cq_off.tail);
+        ring->cqes       = reinterpret_cast<io_uring_cqe*>(cq + params.cq_off.cqes);
+        return ring;
+    }
+};
+
+#else
+
+struct AsyncFileIo::Ring
+{
+};
+
+#endif
+
+AsyncFileIo::IoBuffer::IoBuffer(IoBuffer&& other) noexcept { *this = std::move(other); }
+
+AsyncFileIo::IoBuffer& AsyncFileIo::IoBuffer::operator=(IoBuffer&& other) noexcept
+{
+    if (this == &other) return *this;
+    if (m_owner) m_owner->ReleaseBuffer(m_index);
+    m_owner          = other.m_owner;
+    m_data           = other.m_data;
+    m_capacity       = other.m_capacity;
+    m_index          = other.m_index;
+    other.m_owner    = nullptr;
+    other.m_data     = nullptr;
+    other.m_capacity = 0;
+    return *this;
+}
+
+AsyncFileIo::IoBuffer::~IoBuffer()
+{
+    if (m_owner) m_owner->ReleaseBuffer(m_index);
+}
+
+AsyncFileIo::Batch::Batch(AsyncFileIo& io) : m_io(io) { m_io.m_batch_depth.fetch_add(1); }
+
+AsyncFileIo::Batch::~Batch()
+{
+    if (m_io.m_batch_depth.fetch_sub(1) != 1) return;
+    std::lock_guard<std::mutex> lock(m_io.m_submit_mutex);
+    m_io.Flush();
+}
+
+AsyncFileIo::AsyncFileIo(const Options& options) : m_options(options)
+{
+    if (m_options.queue_depth == 0 || m_options.buffer_size == 0)
+    {
+        throw std::invalid_argument("async file I/O needs a queue depth and a buffer size");
+    }
+
+    m_buffer_memory = static_cast<char*>(
+        operator new(BufferStride(m_options.buffer_size) * m_options.buffer_count + kBufferAlignment));
+    for (size_t i = m_options.buffer_count; i-- > 0;) m_free_buffers.push_back(static_cast<unsigned>(i));
+
+#if GM_IO_URING
+    if (!m_options.force_thread_pool) m_ring = Ring::Create(m_options.queue_depth);
+    if (m_ring && m_options.buffer_count)
+    {
+        // Pinned once here instead of on every request; the memlock limit may refuse it.
+        std::vector<iovec> vectors(m_options.buffer_count);
+        for (size_t i = 0; i < vectors.size(); ++i)
+        {
+            vectors[i].iov_base = BufferData(static_cast<unsigned>(i));
+            vectors[i].iov_len  = BufferStride(m_options.buffer_size);
+        }
+        m_registered = syscall(SYS_io_uring_register, m_ring->fd, IORING_REGISTER_BUFFERS, vectors.data(),
+                               static_cast<unsigned>(vectors.size())) == 0;
+    }
+    if (m_ring) m_completion_thread = std::thread([this] { CompletionLoop(); });
+#endif
+    if (!m_ring) m_fallback.reset(new WorkerPool(std::max<size_t>(1, m_options.fallback_threads)));
+}
+
+AsyncFileIo::~AsyncFileIo()
+{
+    {
+        // Requests that completions make from here on are cancelled. Set under the lock that
+        // counts requests in flight, so Drain waits for every one that got past the check.
+        std::lock_guard<std::mutex> lock(m_flight_mutex);
+        m_stopping = true;
+    }
+    Drain();
+#if GM_IO_URING
+    if (m_ring)
+    {
+        // A no-op without user data tells the completion thread to stop.
+        {
+            std::lock_guard<std::mutex> lock(m_submit_mutex);
+            const unsigned tail = *m_ring->sq_tail;
+            const unsigned index = tail & m_ring->sq_mask;
+            std::memset(&m_ring->sqes[index], 0, sizeof(io_uring_sqe));
+            m_ring->sqes[index].opcode = IORING_OP_NOP;
+            m_ring->sq_array[index]    = index;
+            __atomic_store_n(m_ring->sq_tail, tail + 1, __ATOMIC_RELEASE);
+            ++m_unsubmitted;
+            Flush();
+        }
+        m_completion_thread.join();
+    }
+#endif
+
+    // Completions still queued in the dispatcher run here, and the ones it is running are waited
+    // for, since both return their buffers to this object. Those may cancel further requests,
+    // which adds batches until the last completion finished.
+    for (;;)
+    {
+        std::shared_ptr<Delivery> unclaimed;
+        {
+            std::unique_lock<std::mutex> lock(m_delivery_mutex);
+            if (m_deliveries.empty()) break;
+            for (const auto& delivery : m_deliveries)
+            {
+                if (!delivery->claimed.exchange(true, std::memory_order_acq_rel))
+                {
+                    unclaimed = delivery;
+                    break;
+                }
+            }
+            if (!unclaimed)
+            {
+                m_delivery_finished.wait(lock);
+                continue;
+            }
+        }
+        Complete(*unclaimed);
+    }
+    // Only now: completions running on its threads were still using it.
+    m_fallback.reset();
+    operator delete(m_buffer_memory);
+}
+
+const char* AsyncFileIo::BackendName() const
+{
+    return GetBackend() == Backend::IoUring ? "io_uring" : "thread pool";
+}
+
+AsyncFileIo::IoBuffer AsyncFileIo::AcquireBuffer()
+{
+    std::unique_lock<std::mutex> lock(m_buffer_mutex);
+    if (m_options.buffer_count == 0) throw std::logic_error("async file I/O was created without buffers");
+    if (m_free_buffers.empty())
+    {
+        // The buffers may be held by requests of an unfinished batch.
+        lock.unlock();
+        {
+            std::lock_guard<std::mutex> submit(m_submit_mutex);
+            Flush();
+        }
+        lock.lock();
+        m_buffer_returned.wait(lock, [this] { return !m_free_buffers.empty(); });
+    }
+
+    IoBuffer buffer;
+    buffer.m_owner    = this;
+    buffer.m_index    = m_free_buffers.back();
+    buffer.m_data     = BufferData(buffer.m_index);
+    buffer.m_capacity = m_options.buffer_size;
+    m_free_buffers.pop_back();
+    return buffer;
+}
+
+char* AsyncFileIo::BufferData(unsigned index) const
+{
+    const uintptr_t base = reinterpret_cast<uintptr_t>(m_buffer_memory);
+    const uintptr_t aligned = (base + kBufferAlignment - 1) & ~uintptr_t(kBufferAlignment - 1);
+    return reinterpret_cast<char*>(aligned) + index * BufferStride(m_options.buffer_size);
+}
+
+void AsyncFileIo::ReleaseBuffer(unsigned index)
+{
+    {
+        std::lock_guard<std::mutex> lock(m_buffer_mutex);
+        m_free_buffers.push_back(index);
+    }
+    m_buffer_returned.notify_one();
+}
+
+void AsyncFileIo::Read(int fd, uint64_t offset, void* data, size_t size, Completion done)
+{
+    Operation* operation = new Operation();
+    operation->kind      = OperationKind::Read;
+    operation->fd        = fd;
+    operation->offset    = offset;
+    operation->data      = static_cast<char*>(data);
+    operation->size      = size;
+    operation->done      = std::move(done);
+    Start(operation);
+}
+
+void AsyncFileIo::Write(int fd, uint64_t offset, const void* data, size_t size, Completion done)
+{
+    Operation* operation = new Operation();
+    operation->kind      = OperationKind::Write;
+    operation->fd        = fd;
+    operation->offset    = offset;
+    operation->data      = static_cast<char*>(const_cast<void*>(data));
+    operation->size      = size;
+    operation->done      = std::move(done);
+    Start(operation);
+}
+
+void AsyncFileIo::Read(int fd, uint64_t offset, IoBuffer buffer, size_t size, BufferCompletion done)
+{
+    if (buffer.m_owner != this || size > buffer.Capacity())
+    {
+        throw std::invalid_argument("not a buffer of this async file I/O, or too small");
+    }
+    Operation* operation   = new Operation();
+    operation->kind        = OperationKind::Read;
+    operation->fd          = fd;
+    operation->offset      = offset;
+    operation->data        = buffer.Data();
+    operation->size        = size;
+    operation->buffer      = std::move(buffer);
+    operation->buffer_done = std::move(done);
+    Start(operation);
+}
+
+void AsyncFileIo::Write(int fd, uint64_t offset, IoBuffer buffer, size_t size, BufferCompletion done)
+{
+    if (buffer.m_owner != this || size > buffer.Capacity())
+    {
+        throw std::invalid_argument("not a buffer of this async file I/O, or too small");
+    }
+    Operation* operation   = new Operation();
+    operation->kind        = OperationKind::Write;
+    operation->fd          = fd;
+    operation->offset      = offset;
+    operation->data        = buffer.Data();
+    operation->size        = size;
+    operation->buffer      = std::move(buffer);
+    operation->buffer_done = std::move(done);
+    Start(operation);
+}
+
+void AsyncFileIo::Sync(int fd, Completion done)
+{
+    Operation* operation = new Operation();
+    operation->kind      = OperationKind::Sync;
+    operation->fd        = fd;
+    operation->done      = std::move(done);
+    Start(operation);
+}
+
+void AsyncFileIo::Drain()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_submit_mutex);
+        Flush();
+    }
+    std::unique_lock<std::mutex> lock(m_flight_mutex);
+    m_flight_changed.wait(lock, [this] { return m_in_flight == 0; });
+}
+
+void AsyncFileIo::Start(Operation* operation)
+{
+    {
+        std::unique_lock<std::mutex> lock(m_flight_mutex);
+        if (m_stopping)
+        {
+            // From a completion while the destructor runs: the backend is on its way out.
+            lock.unlock();
+            operation->result.error = ECANCELED;
+            std::vector<Operation*> cancelled(1, operation);
+            Dispatch(cancelled);
+            return;
+        }
+
+        // Completions that start the next request must not wait for their own completion thread.
+        const bool on_completion_thread = m_ring ? std::this_thread::get_id() == m_completion_thread.get_id()
+                                                 : m_fallback->IsWorkerThread();
+        if (m_in_flight >= m_options.queue_depth && !on_completion_thread)
+        {
+            lock.unlock();
+            {
+                std::lock_guard<std::mutex> submit(m_submit_mutex);
+                Flush();
+            }
+            lock.lock();
+            m_flight_changed.wait(lock, [this] { return m_in_flight < m_options.queue_depth; });
+        }
+        ++m_in_flight;
+    }
+
+    if (!m_ring)
+    {
+        m_fallback->Post([this, operation] { RunBlocking(operation); });
+        return;
+    }
+
+    std::lock_guard<std::mutex> lock(m_submit_mutex);
+    Submit(operation);
+    if (m_batch_depth.load() == 0) Flush();
+}
+
+void AsyncFileIo::Submit(Operation* operation)
+{
+#if GM_IO_URING
+    unsigned tail = *m_ring->sq_tail;
+    if (tail - __atomic_load_n(m_ring->sq_head, __ATOMIC_ACQUIRE) >= m_ring->sq_entries)
+    {
+        // Only reachable past the queue depth, from the completion thread.
+        Flush();
+    }
+
+    // Continues where a short transfer stopped; sqe.len only holds 32 bits, and the kernel moves
+    // less than 2 GB per call anyway.
+    const size_t   done   = operation->result.bytes;
+    char* const    data   = operation->data + done;
+    const size_t   length = std::min(operation->size - done, kMaxTransfer);
+    const unsigned index  = tail & m_ring->sq_mask;
+    io_uring_sqe&  sqe    = m_ring->sqes[index];
+    std::memset(&sqe, 0, sizeof(sqe));
+    sqe.fd        = operation->fd;
+    sqe.off       = operation->offset + done;
+    sqe.user_data = reinterpret_cast<uint64_t>(operation);
+    if (operation->kind == OperationKind::Sync)
+    {
+        sqe.opcode = IORING_OP_FSYNC;
+    }
+    else if (operation->buffer.Valid() && m_registered)
+    {
+        sqe.opcode    = operation->kind == OperationKind::Read ? IORING_OP_READ_FIXED : IORING_OP_WRITE_FIXED;
+        sqe.addr      = reinterpret_cast<uint64_t>(data);
+        sqe.len       = static_cast<uint32_t>(length);
+        sqe.buf_index = static_cast<uint16_t>(operation->buffer.m_index);
+    }
+    else
+    {
+        // READV and WRITEV work on every kernel with io_uring, READ and WRITE only since 5.6.
+        operation->vector.iov_base = data;
+        operation->vector.iov_len  = length;
+        sqe.opcode = operation->kind == OperationKind::Read ? IORING_OP_READV : IORING_OP_WRITEV;
+        sqe.addr   = reinterpret_cast<uint64_t>(&operation->vector);
+        sqe.len    = 1;
+    }
+    m_ring->sq_array[index] = index;
+    HandOver(operation);
+    __atomic_store_n(m_ring->sq_tail, tail + 1, __ATOMIC_RELEASE);
+    ++m_unsubmitted;
+#else
+    (void)operation;
+#endif
+}
+
+void AsyncFileIo::Flush()
+{
+#if GM_IO_URING
+    while (m_ring && m_unsubmitted)
+    {
+        const int submitted = m_ring->Enter(m_unsubmitted, 0, 0);
+        if (submitted >= 0)
+        {
+            m_unsubmitted -= static_cast<unsigned>(submitted);
+            continue;
+        }
+        if (errno == EINTR || errno == EAGAIN || errno == EBUSY)
+        {
+            std::this_thread::yield();
+            continue;
+        }
+        throw std::system_error(errno, std::generic_category(), "io_uring_enter");
+    }
+#endif
+}
+
+void AsyncFileIo::CompletionLoop()
+{
+#if GM_IO_URING
+    std::vector<Operation*> completed;
+    std::vector<Operation*> unfinished;
+    for (;;)
+    {
+        unsigned       head = *m_ring->cq_head;
+        const unsigned tail = __atomic_load_n(m_ring->cq_tail, __ATOMIC_ACQUIRE);
+        if (head == tail)
+        {
+            m_ring->Enter(0, 1, IORING_ENTER_GETEVENTS);
+            continue;
+        }
+
+        bool stop = false;
+        for (; head != tail; ++head)
+        {
+            const io_uring_cqe& cqe = m_ring->cqes[head & m_ring->cq_mask];
+            if (!cqe.user_data)
+            {
+                stop = true;
+                continue;
+            }
+            Operation* operation = reinterpret_cast<Operation*>(cqe.user_data);
+            TakeOver(operation);
+            if (cqe.res < 0)
+            {
+                operation->result.error = -cqe.res;
+            }
+            else if (operation->kind != OperationKind::Sync)
+            {
+                // Short, but neither at the end of the file nor failed: ask for the rest, as the
+                // thread pool's loop does.
+                operation->result.bytes += static_cast<size_t>(cqe.res);
+                if (cqe.res > 0 && operation->result.bytes < operation->size)
+                {
+                    unfinished.push_back(operation);
+                    continue;
+                }
+            }
+            completed.push_back(operation);
+        }
+        __atomic_store_n(m_ring->cq_head, head, __ATOMIC_RELEASE);
+        if (!unfinished.empty())
+        {
+            std::lock_guard<std::mutex> lock(m_submit_mutex);
+            for (Operation* operation : unfinished) Submit(operation);
+            Flush();
+            unfinished.clear();
+        }
+        if (!completed.empty()) Deliver(completed);
+        if (stop) return;
+    }
+#endif
+}
+
+void AsyncFileIo::RunBlocking(Operation* operation)
+{
+    operation->result = Transfer(operation->kind, operation->fd, operation->offset, operation->data, operation->size);
+    std::vector<Operation*> completed(1, operation);
+    Deliver(completed);
+}
+
+void AsyncFileIo::Deliver(std::vector<Operation*>& completed)
+{
+    const size_t count = completed.size();
+    Dispatch(completed);
+    {
+        std::lock_guard<std::mutex> lock(m_flight_mutex);
+        m_in_flight -= count;
+    }
+    m_flight_changed.notify_all();
+}
+
+void AsyncFileIo::Dispatch(std::vector<Operation*>& completed)
+{
+    auto delivery = std::make_shared<Delivery>();
+    delivery->operations.swap(completed);
+    {
+        // The destructor may be waiting for the batches to run out, and has to run this one.
+        std::lock_guard<std::mutex> lock(m_delivery_mutex);
+        m_deliveries.push_back(delivery);
+        m_delivery_finished.notify_all();
+    }
+
+    // The task may run after Drain returned. It only touches `this` once it has claimed the
+    // batch, which keeps the destructor waiting; a batch the destructor claimed already ran.
+    Task task = [this, delivery] {
+        if (!delivery->claimed.exchange(true, std::memory_order_acq_rel)) Complete(*delivery);
+    };
+    if (m_dispatcher) m_dispatcher(std::move(task));
+    else task();
+}
+
+void AsyncFileIo::Complete(Delivery& delivery)
+{
+    for (Operation* operation : delivery.operations)
+    {
+        if (operation->buffer_done) operation->buffer_done(operation->result, std::move(operation->buffer));
+        else if (operation->done) operation->done(operation->result);
+        delete operation;
+    }
+
+    // Notified under the lock: once the destructor sees the list empty it frees the mutex.
+    std::lock_guard<std::mutex> lock(m_delivery_mutex);
+    m_deliveries.erase(std::find_if(m_deliveries.begin(), m_deliveries.end(),
+                                    [&delivery](const std::shared_ptr<Delivery>& d) { return d.get() == &delivery; }));
+    m_delivery_finished.notify_all();
+}
+
+void CompleteOnWorkerPool(AsyncFileIo& io, WorkerPool& pool)
+{
+    io.SetDispatcher([&pool](AsyncFileIo::Task task) { pool.Post(std::move(task)); });
+}
+
+} // namespace gomarky
@@ -0,0 +1,190 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace gomarky
+{
+
+class WorkerPool;
+
+/// Outcome of one asynchronous read, write or sync.
+struct IoResult
+{
+    size_t bytes = 0; ///< fewer than asked for only at end of file or after an error
+    int    error = 0; ///< errno value, 0 on success
+
+    bool Ok() const { return error == 0; }
+};
+
+/// Asynchronous positional reads and writes on file descriptors, so snapshots, logs and exports
+/// do not block the thread that issues them.
+///
+/// On Linux the requests go to an io_uring: requests made inside a Batch are submitted with a
+/// single system call, and reads and writes through an IoBuffer use buffers registered with the
+/// kernel once, saving the page pinning of every call. Where io_uring is missing (older kernels,
+/// other systems, seccomp filters) the same requests run as blocking calls on a small pool of
+/// I/O threads, which stays out of the way of the compute WorkerPool.
+///
+/// Reads and writes transfer everything asked for unless they reach the end of the file or fail,
+/// with either backend: the pieces a kernel call leaves over are requested again.
+///
+/// Completions run through the dispatcher, on the completion thread when none is set. The ones
+/// that complete together are handed to the dispatcher as one task. Tasks the dispatcher has not
+/// started by the time the AsyncFileIo is destroyed run in the destructor instead, and the ones it
+/// is running are waited for, so the dispatcher may stop at any time but must not destroy the
+/// AsyncFileIo from inside a completion. Requests those completions make once the destructor has
+/// started fail with ECANCELED.
+class AsyncFileIo
+{
+public:
+    enum class Backend
+    {
+        IoUring,
+        ThreadPool,
+    };
+
+    struct Options
+    {
+        unsigned queue_depth       = 64;  ///< requests in flight before callers wait
+        size_t   buffer_count      = 32;  ///< registered buffers handed out by AcquireBuffer
+        size_t   buffer_size       = size_t(256) << 10;
+        size_t   fallback_threads  = 4;
+        bool     force_thread_pool = false;
+    };
+
+    using Task       = std::function<void()>;
+    using Dispatcher = std::function<void(Task)>;
+    using Completion = std::function<void(IoResult)>;
+
+    class IoBuffer;
+    using BufferCompletion = std::function<void(IoResult, IoBuffer)>;
+
+    /// One of the registered buffers. Returns to the pool when destroyed; must not outlive the
+    /// AsyncFileIo it came from.
+    class IoBuffer
+    {
+    public:
+        IoBuffer() = default;
+        IoBuffer(IoBuffer&& other) noexcept;
+        IoBuffer& operator=(IoBuffer&& other) noexcept;
+        IoBuffer(const IoBuffer&) = delete;
+        IoBuffer& operator=(const IoBuffer&) = delete;
+        ~IoBuffer();
+
+        char*  Data() const { return m_data; }
+        size_t Capacity() const { return m_capacity; }
+        bool   Valid() const { return m_data != nullptr; }
+
+    private:
+        friend class AsyncFileIo;
+
+        AsyncFileIo* m_owner    = nullptr;
+        char*        m_data     = nullptr;
+        size_t       m_capacity = 0;
+        unsigned     m_index    = 0;
+    };
+
+    /// Requests made while a Batch is alive are submitted together when the outermost one ends.
+    class Batch
+    {
+    public:
+        explicit Batch(AsyncFileIo& io);
+        Batch(const Batch&) = delete;
+        Batch& operator=(const Batch&) = delete;
+        ~Batch();
+
+    private:
+        AsyncFileIo& m_io;
+    };
+
+    explicit AsyncFileIo(const Options& options);
+    AsyncFileIo() : AsyncFileIo(Options()) {}
+    AsyncFileIo(const AsyncFileIo&) = delete;
+    AsyncFileIo& operator=(const AsyncFileIo&) = delete;
+
+    /// Waits for every request in flight and for the completions being run.
+    ~AsyncFileIo();
+
+    Backend     GetBackend() const { return m_ring ? Backend::IoUring : Backend::ThreadPool; }
+    const char* BackendName() const;
+    /// Whether the IoBuffers are registered with the kernel.
+    bool RegisteredBuffers() const { return m_registered; }
+
+    /// Where completions run. Set it before the first request.
+    void SetDispatcher(Dispatcher dispatcher) { m_dispatcher = std::move(dispatcher); }
+
+    /// A registered buffer; waits while all of them are in use.
+    IoBuffer AcquireBuffer();
+
+    /// Read or write `size` bytes at `offset`. The memory must stay valid until `done` runs.
+    void Read(int fd, uint64_t offset, void* data, size_t size, Completion done);
+    void Write(int fd, uint64_t offset, const void* data, size_t size, Completion done);
+
+    /// The same through a registered buffer, which is handed back with the result.
+    void Read(int fd, uint64_t offset, IoBuffer buffer, size_t size, BufferCompletion done);
+    void Write(int fd, uint64_t offset, IoBuffer buffer, size_t size, BufferCompletion done);
+
+    /// fsync `fd`. Only covers writes that had completed when it was requested, so issue it from
+    /// the completion of the last write.
+    void Sync(int fd, Completion done);
+
+    /// Wait until every request made so far has completed and its completion was dispatched.
+    /// Must not be called from a completion.
+    void Drain();
+
+private:
+    struct Ring;
+    struct Operation;
+    struct Delivery;
+
+    void  Start(Operation* operation);
+    void  Submit(Operation* operation);
+    void  Deliver(std::vector<Operation*>& completed);
+    void  Dispatch(std::vector<Operation*>& completed);
+    void  Complete(Delivery& delivery);
+    void  RunBlocking(Operation* operation);
+    void  Flush();
+    void  CompletionLoop();
+    char* BufferData(unsigned index) const;
+    void  ReleaseBuffer(unsigned index);
+
+    const Options m_options;
+    Dispatcher    m_dispatcher;
+
+    std::unique_ptr<Ring>       m_ring;
+    std::unique_ptr<WorkerPool> m_fallback;
+    std::thread                 m_completion_thread;
+    bool                        m_registered = false;
+
+    char*                   m_buffer_memory = nullptr;
+    std::vector<unsigned>   m_free_buffers;
+    std::mutex              m_buffer_mutex;
+    std::condition_variable m_buffer_returned;
+
+    std::mutex              m_submit_mutex; ///< guards the submission queue
+    std::atomic<int>        m_batch_depth{0};
+    unsigned                m_unsubmitted = 0;
+
+    std::mutex              m_flight_mutex;
+    std::condition_variable m_flight_changed;
+    size_t                  m_in_flight = 0;
+    bool                    m_stopping  = false; ///< the destructor started; guarded by m_flight_mutex
+
+    // Batches handed to the dispatcher whose completions have not finished running.
+    std::mutex                             m_delivery_mutex;
+    std::condition_variable                m_delivery_finished;
+    std::vector<std::shared_ptr<Delivery>> m_deliveries;
+};
+
+/// Run the completions of `io` on `pool`, which must outlive it.
+void CompleteOnWorkerPool(AsyncFileIo& io, WorkerPool& pool);
+
+} // namespace gomarky
@@ -0,0 +1,16 @@
+#include "io/qt_async_file_io.h"
+
+#include <QCoreApplication>
+
+namespace gomarky
+{
+
+void CompleteOnEventLoop(AsyncFileIo& io, QObject* receiver)
+{
+    if (!receiver) receiver = QCoreApplication::instance();
+    io.SetDispatcher([receiver](AsyncFileIo::Task task) {
+        QMetaObject::invokeMethod(receiver, std::move(task), Qt::QueuedConnection);
+    });
+}
+
+} // namespace gomarky
@@ -0,0 +1,14 @@
+#pragma once
+
+#include <QObject>
+
+#include "io/async_file_io.h"
+
+namespace gomarky
+{
+
+/// Run the completions of `io` on the event loop `receiver` lives in (the application object by
+/// default), one queued call per batch of completions. The receiver must outlive `io`.
+void CompleteOnEventLoop(AsyncFileIo& io, QObject* receiver = nullptr);
+
+} // namespace gomarky
@@ -0,0 +1,156 @@
+#include "layout/layout_host.h"
+
+#include <algorithm>
+
+#include <QCoreApplication>
+#include <QEvent>
+#include <QWidget>
+
+namespace gomarky
+{
+
+namespace
+{
+
+const char* const kHostProperty = "gomarkyLayoutHost";
+
+LayoutTree::Size HintOf(const QWidget* widget)
+{
+    if (widget->isHidden()) return LayoutTree::Size();
+    const QSize hint = widget->sizeHint().expandedTo(widget->minimumSize()).boundedTo(widget->maximumSize());
+    return LayoutTree::Size{std::max(0, hint.width()), std::max(0, hint.height())};
+}
+
+} // namespace
+
+LayoutHost::LayoutHost(QWidget* container, LayoutTree::Kind root_kind)
+    : QObject(container), m_container(container), m_tree(root_kind)
+{
+    m_widgets.resize(1);
+    container->setProperty(kHostProperty, QVariant::fromValue(static_cast<QObject*>(this)));
+    container->installEventFilter(this);
+}
+
+LayoutHost::NodeId LayoutHost::AddContainer(NodeId parent, LayoutTree::Kind kind, LayoutTree::Slot slot)
+{
+    const NodeId id = m_tree.AddContainer(parent, kind, slot);
+    m_widgets.resize(m_tree.NodeCount());
+    SchedulePass();
+    return id;
+}
+
+LayoutHost::NodeId LayoutHost::AddWidget(NodeId parent, QWidget* widget, LayoutTree::Slot slot)
+{
+    if (widget->parentWidget() != m_container) widget->setParent(m_container);
+    const NodeId id = m_tree.AddLeaf(parent, HintOf(widget), slot);
+    m_widgets.resize(m_tree.NodeCount());
+    m_widgets[id] = widget;
+    m_nodes.insert(widget, id);
+    // Hiding or showing changes the space a widget takes.
+    widget->installEventFilter(this);
+    connect(widget, &QObject::destroyed, this, [this, widget] {
+        const NodeId node = m_nodes.take(widget);
+        m_dirty.remove(widget);
+        m_tree.SetLeafHint(node, LayoutTree::Size());
+        SchedulePass();
+    });
+    if (m_container->isVisible() && widget->isHidden() && !widget->testAttribute(Qt::WA_WState_ExplicitShowHide))
+    {
+        widget->show();
+    }
+    SchedulePass();
+    return id;
+}
+
+void LayoutHost::SetSpacing(NodeId container, int spacing, int margin)
+{
+    m_tree.SetSpacing(container, spacing, margin);
+    SchedulePass();
+}
+
+void LayoutHost::InvalidateWidget(QWidget* widget)
+{
+    if (!m_nodes.contains(widget)) return;
+    m_dirty.insert(widget);
+    SchedulePass();
+}
+
+void LayoutHost::NotifySizeHintChanged(QWidget* widget)
+{
+    QWidget* parent = widget->parentWidget();
+    if (!parent) return;
+    if (auto* host = qobject_cast<LayoutHost*>(parent->property(kHostProperty).value<QObject*>()))
+    {
+        host->InvalidateWidget(widget);
+    }
+}
+
+void LayoutHost::Activate()
+{
+    m_pass_posted = false;
+    RunPass();
+}
+
+QSize LayoutHost::SizeHint() const
+{
+    const LayoutTree::Size hint = m_tree.Hint(LayoutTree::kRoot);
+    return QSize(hint.width, hint.height);
+}
+
+bool LayoutHost::eventFilter(QObject* watched, QEvent* event)
+{
+    if (watched == m_container)
+    {
+        switch (event->type())
+        {
+        case QEvent::LayoutRequest:
+            // A child called updateGeometry() without telling us which: measure everything.
+            if (!m_pass_posted && m_dirty.isEmpty()) m_remeasure_all = true;
+            m_pass_posted = false;
+            RunPass();
+            break;
+        case QEvent::Resize: RunPass(); break;
+        default: break;
+        }
+        return false;
+    }
+
+    if (event->type() == QEvent::ShowToParent || event->type() == QEvent::HideToParent)
+    {
+        InvalidateWidget(static_cast<QWidget*>(watched));
+    }
+    return false;
+}
+
+void LayoutHost::SchedulePass()
+{
+    if (m_pass_posted) return;
+    m_pass_posted = true;
+    // LayoutRequest is compressed by Qt, so this never queues more than one pass per turn.
+    QCoreApplication::postEvent(m_container, new QEvent(QEvent::LayoutRequest));
+}
+
+void LayoutHost::RunPass()
+{
+    if (m_remeasure_all)
+    {
+        for (auto it = m_nodes.cbegin(); it != m_nodes.cend(); ++it) m_tree.SetLeafHint(it.value(), HintOf(it.key()));
+        m_remeasure_all = false;
+    }
+    else
+    {
+        for (QWidget* widget : m_dirty) m_tree.SetLeafHint(m_nodes.value(widget), HintOf(widget));
+    }
+    m_dirty.clear();
+
+    const QRect rect = m_container->contentsRect();
+    const auto  changes = m_tree.Arrange(LayoutTree::Rect{rect.x(), rect.y(), rect.width(), rect.height()});
+    for (const auto& change : changes)
+    {
+        QWidget* widget = m_widgets[change.node];
+        if (widget) widget->setGeometry(change.rect.x, change.rect.y, change.rect.width, change.rect.height);
+    }
+    m_last_pass_changes = static_cast<int>(changes.size());
+}
+
+} // namespace gomarky
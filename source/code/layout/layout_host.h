@@ -0,0 +1,75 @@
+#pragma once
+
+#include <vector>
+
+#include <QHash>
+#include <QObject>
+#include <QPointer>
+#include <QSet>
+#include <QSize>
+
+#include "layout/layout_tree.h"
+
+class QWidget;
+
+namespace gomarky
+{
+
+/// Lays out the child widgets of a container with a LayoutTree instead of a QLayout.
+///
+/// Size hint changes are collected and applied in a single pass per event-loop turn, driven by
+/// the container's (compressed) LayoutRequest event, so any number of text updates within a frame
+/// cost one pass. Widgets that report changes through NotifySizeHintChanged are re-measured
+/// alone. Other widgets still work: a LayoutRequest nobody reported re-measures every widget,
+/// but an unreported change landing in the same turn as a reported one is only picked up later.
+class LayoutHost : public QObject
+{
+    Q_OBJECT
+
+public:
+    using NodeId = LayoutTree::NodeId;
+
+    explicit LayoutHost(QWidget* container, LayoutTree::Kind root_kind = LayoutTree::Kind::Column);
+
+    NodeId AddContainer(NodeId parent, LayoutTree::Kind kind, LayoutTree::Slot slot = LayoutTree::Slot());
+
+    /// Reparent `widget` into the container and lay it out under `parent`.
+    NodeId AddWidget(NodeId parent, QWidget* widget, LayoutTree::Slot slot = LayoutTree::Slot());
+
+    void SetSpacing(NodeId container, int spacing, int margin = 0);
+
+    /// Queue `widget` for re-measuring in the next pass.
+    void InvalidateWidget(QWidget* widget);
+
+    /// For widgets whose size hint changed: finds the host laying them out, if any, and queues
+    /// them there. Costs a property lookup on the parent, not a scan of its children.
+    static void NotifySizeHintChanged(QWidget* widget);
+
+    /// Run the pending pass now instead of waiting for the event loop.
+    void Activate();
+
+    QSize SizeHint() const;
+
+    LayoutTree& Tree() { return m_tree; }
+
+    /// Widgets moved or resized by the last pass.
+    int LastPassChanges() const { return m_last_pass_changes; }
+
+protected:
+    bool eventFilter(QObject* watched, QEvent* event) override;
+
+private:
+    void SchedulePass();
+    void RunPass();
+
+    QWidget*                       m_container;
+    LayoutTree                     m_tree;
+    QHash<QWidget*, NodeId>        m_nodes;
+    std::vector<QPointer<QWidget>> m_widgets; ///< by node id, null for containers
+    QSet<QWidget*>                 m_dirty;
+    bool                           m_remeasure_all     = false;
+    bool                           m_pass_posted       = false;
+    int                            m_last_pass_changes = 0;
+};
+
+} // namespace gomarky
@@ -0,0 +1,322 @@
+#include "layout/layout_tree.h"
+
+#include <algorithm>
+
+namespace gomarky
+{
+
+namespace
+{
+
+int MaxOf(const std::multiset<int>& values) { return values.empty() ? 0 : *values.rbegin(); }
+
+int Gaps(size_t count, int spacing) { return count > 1 ? static_cast<int>(count - 1) * spacing : 0; }
+
+// Split `available` over tracks with preferred sizes `sizes` (summing to `total`), in place.
+// Spare space goes to the tracks by weight (evenly when no weights are given), missing space is
+// taken from every track in proportion to its size.
+void Distribute(std::vector<int>& sizes, int64_t total, int available, const std::vector<int>* weights)
+{
+    if (sizes.empty()) return;
+    if (available < total)
+    {
+        for (int& size : sizes) size = total > 0 ? static_cast<int>(int64_t(size) * available / total) : 0;
+        return;
+    }
+
+    const int64_t extra        = available - total;
+    int64_t       weight_total = 0;
+    if (weights)
+    {
+        for (int weight : *weights) weight_total += weight;
+        if (weight_total == 0) return; // nothing stretches, the space stays unused
+    }
+    else
+    {
+        weight_total = static_cast<int64_t>(sizes.size());
+    }
+
+    int64_t given = 0;
+    size_t  last  = 0;
+    for (size_t i = 0; i < sizes.size(); ++i)
+    {
+        const int weight = weights ? (*weights)[i] : 1;
+        if (weight <= 0) continue;
+        const int64_t share = extra * weight / weight_total;
+        sizes[i] += static_cast<int>(share);
+        given += share;
+        last = i;
+    }
+    sizes[last] += static_cast<int>(extra - given);
+}
+
+} // namespace
+
+LayoutTree::LayoutTree(Kind root_kind)
+{
+    Node root;
+    root.kind = root_kind;
+    m_nodes.push_back(root);
+}
+
+LayoutTree::NodeId LayoutTree::AddContainer(NodeId parent, Kind kind, Slot slot)
+{
+    return AddNode(parent, kind, Size(), slot);
+}
+
+LayoutTree::NodeId LayoutTree::AddLeaf(NodeId parent, Size hint, Slot slot)
+{
+    return AddNode(parent, Kind::Leaf, hint, slot);
+}
+
+LayoutTree::NodeId LayoutTree::AddNode(NodeId parent, Kind kind, Size hint, Slot slot)
+{
+    const NodeId id = static_cast<NodeId>(m_nodes.size());
+    Node         node;
+    node.kind        = kind;
+    node.parent      = parent;
+    node.slot        = slot;
+    node.slot.row    = std::max(0, slot.row);
+    node.slot.column = std::max(0, slot.column);
+    node.hint        = hint;
+    m_nodes.push_back(node);
+
+    Node& container = m_nodes[parent];
+    container.children.push_back(id);
+    if (container.kind == Kind::Grid)
+    {
+        const size_t columns = static_cast<size_t>(node.slot.column) + 1;
+        const size_t rows    = static_cast<size_t>(node.slot.row) + 1;
+        if (container.column_widths.size() < columns) container.column_widths.resize(columns);
+        if (container.row_heights.size() < rows) container.row_heights.resize(rows);
+    }
+    Propagate(id, Size(), true);
+    return id;
+}
+
+void LayoutTree::SetSpacing(NodeId container, int spacing, int margin)
+{
+    Node& node   = m_nodes[container];
+    node.spacing = std::max(0, spacing);
+    node.margin  = std::max(0, margin);
+    MarkArrangeDirty(container);
+
+    const Size old_hint = node.hint;
+    node.hint           = ContainerHint(node);
+    if (node.hint != old_hint && container != kRoot) Propagate(container, old_hint, false);
+}
+
+void LayoutTree::SetLeafHint(NodeId leaf, Size hint)
+{
+    Node& node = m_nodes[leaf];
+    if (node.hint == hint) return;
+    const Size old_hint = node.hint;
+    node.hint           = hint;
+    Propagate(leaf, old_hint, false);
+}
+
+void LayoutTree::Propagate(NodeId id, Size old_hint, bool added)
+{
+    while (id != kRoot)
+    {
+        const Node&  child     = m_nodes[id];
+        const NodeId parent_id = child.parent;
+        Node&        parent    = m_nodes[parent_id];
+        if (UpdateAggregates(parent, child, old_hint, child.hint, added)) MarkArrangeDirty(parent_id);
+        added = false;
+
+        const Size parent_old = parent.hint;
+        parent.hint           = ContainerHint(parent);
+        if (parent.hint == parent_old) return;
+        id       = parent_id;
+        old_hint = parent_old;
+    }
+}
+
+bool LayoutTree::UpdateAggregates(Node& parent, const Node& child, Size old_hint, Size new_hint, bool added)
+{
+    switch (parent.kind)
+    {
+    case Kind::Row:
+    case Kind::Column:
+    {
+        const bool row       = parent.kind == Kind::Row;
+        const int  old_main  = row ? old_hint.width : old_hint.height;
+        const int  new_main  = row ? new_hint.width : new_hint.height;
+        const int  old_cross = row ? old_hint.height : old_hint.width;
+        const int  new_cross = row ? new_hint.height : new_hint.width;
+        if (!added)
+        {
+            parent.main_sum -= old_main;
+            parent.cross.erase(parent.cross.find(old_cross));
+        }
+        parent.main_sum += new_main;
+        parent.cross.insert(new_cross);
+        // Children always span the whole cross axis, so only main-axis changes move anything.
+        return added || old_main != new_main;
+    }
+    case Kind::Grid:
+    {
+        auto&     widths     = parent.column_widths[static_cast<size_t>(child.slot.column)];
+        auto&     heights    = parent.row_heights[static_cast<size_t>(child.slot.row)];
+        const int old_width  = MaxOf(widths);
+        const int old_height = MaxOf(heights);
+        if (!added)
+        {
+            widths.erase(widths.find(old_hint.width));
+            heights.erase(heights.find(old_hint.height));
+        }
+        widths.insert(new_hint.width);
+        heights.insert(new_hint.height);
+        const int new_width  = MaxOf(widths);
+        const int new_height = MaxOf(heights);
+        parent.width_sum += new_width - old_width;
+        parent.height_sum += new_height - old_height;
+        // Cells are sized by their track, so a change inside the track extents moves nothing.
+        return added || new_width != old_width || new_height != old_height;
+    }
+    case Kind::Leaf: break;
+    }
+    return false;
+}
+
+LayoutTree::Size LayoutTree::ContainerHint(const Node& node) const
+{
+    Size hint;
+    switch (node.kind)
+    {
+    case Kind::Row:
+        hint.width  = static_cast<int>(node.main_sum) + Gaps(node.children.size(), node.spacing);
+        hint.height = MaxOf(node.cross);
+        break;
+    case Kind::Column:
+        hint.width  = MaxOf(node.cross);
+        hint.height = static_cast<int>(node.main_sum) + Gaps(node.children.size(), node.spacing);
+        break;
+    case Kind::Grid:
+        hint.width  = static_cast<int>(node.width_sum) + Gaps(node.column_widths.size(), node.spacing);
+        hint.height = static_cast<int>(node.height_sum) + Gaps(node.row_heights.size(), node.spacing);
+        break;
+    case Kind::Leaf: return node.hint;
+    }
+    hint.width += 2 * node.margin;
+    hint.height += 2 * node.margin;
+    return hint;
+}
+
+void LayoutTree::MarkArrangeDirty(NodeId id)
+{
+    m_nodes[id].arrange_dirty = true;
+    // Record the path so Arrange() can find this node without scanning siblings.
+    while (id != kRoot)
+    {
+        Node& node = m_nodes[id];
+        if (node.in_dirty_list) break;
+        node.in_dirty_list = true;
+        m_nodes[node.parent].dirty_children.push_back(id);
+        id = node.parent;
+    }
+}
+
+std::vector<LayoutTree::GeometryChange> LayoutTree::Arrange(const Rect& root)
+{
+    std::vector<GeometryChange> changes;
+    m_last_visits = 0;
+    ArrangeNode(kRoot, root, changes);
+    return changes;
+}
+
+void LayoutTree::ArrangeNode(NodeId id, const Rect& rect, std::vector<GeometryChange>& changes)
+{
+    ++m_last_visits;
+    Node&      node  = m_nodes[id];
+    const bool moved = !node.placed || node.rect != rect;
+    node.rect        = rect;
+    node.placed      = true;
+    if (node.kind == Kind::Leaf)
+    {
+        if (moved) changes.push_back({id, rect});
+        return;
+    }
+
+    std::vector<NodeId> dirty;
+    dirty.swap(node.dirty_children);
+    for (NodeId child : dirty) m_nodes[child].in_dirty_list = false;
+
+    if (!moved && !node.arrange_dirty)
+    {
+        // Placement of the children is unchanged, only descend where work is pending.
+        for (NodeId child : dirty) ArrangeNode(child, m_nodes[child].rect, changes);
+        return;
+    }
+
+    node.arrange_dirty = false;
+    std::vector<Rect> rects(node.children.size());
+    if (node.kind == Kind::Grid) PlaceGrid(node, rects);
+    else PlaceBox(node, rects);
+
+    for (size_t i = 0; i < node.children.size(); ++i)
+    {
+        const Node& child = m_nodes[node.children[i]];
+        if (child.placed && child.rect == rects[i] && !child.arrange_dirty && child.dirty_children.empty()) continue;
+        ArrangeNode(node.children[i], rects[i], changes);
+    }
+}
+
+void LayoutTree::PlaceBox(const Node& node, std::vector<Rect>& rects) const
+{
+    const bool row = node.kind == Kind::Row;
+    const Rect inner{node.rect.x + node.margin, node.rect.y + node.margin, std::max(0, node.rect.width - 2 * node.margin),
+                     std::max(0, node.rect.height - 2 * node.margin)};
+    const int  main   = row ? inner.width : inner.height;
+    const int  usable = std::max(0, main - Gaps(node.children.size(), node.spacing));
+
+    std::vector<int> sizes(node.children.size());
+    std::vector<int> stretch(node.children.size());
+    for (size_t i = 0; i < node.children.size(); ++i)
+    {
+        const Node& child = m_nodes[node.children[i]];
+        sizes[i]          = row ? child.hint.width : child.hint.height;
+        stretch[i]        = std::max(0, child.slot.stretch);
+    }
+    Distribute(sizes, node.main_sum, usable, &stretch);
+
+    int position = row ? inner.x : inner.y;
+    for (size_t i = 0; i < sizes.size(); ++i)
+    {
+        rects[i] = row ? Rect{position, inner.y, sizes[i], inner.height} : Rect{inner.x, position, inner.width, sizes[i]};
+        position += sizes[i] + node.spacing;
+    }
+}
+
+void LayoutTree::PlaceGrid(const Node& node, std::vector<Rect>& rects) const
+{
+    auto tracks = [&node](const std::vector<std::multiset<int>>& extents, int64_t total, int start, int length,
+                          std::vector<int>& offsets, std::vector<int>& sizes) {
+        sizes.resize(extents.size());
+        for (size_t i = 0; i < extents.size(); ++i) sizes[i] = MaxOf(extents[i]);
+        const int usable = std::max(0, length - 2 * node.margin - Gaps(extents.size(), node.spacing));
+        Distribute(sizes, total, usable, nullptr);
+        offsets.resize(extents.size());
+        int position = start + node.margin;
+        for (size_t i = 0; i < sizes.size(); ++i)
+        {
+            offsets[i] = position;
+            position += sizes[i] + node.spacing;
+        }
+    };
+
+    std::vector<int> column_x, column_width, row_y, row_height;
+    tracks(node.column_widths, node.width_sum, node.rect.x, node.rect.width, column_x, column_width);
+    tracks(node.row_heights, node.height_sum, node.rect.y, node.rect.height, row_y, row_height);
+
+    for (size_t i = 0; i < node.children.size(); ++i)
+    {
+        const Slot&  slot   = m_nodes[node.children[i]].slot;
+        const size_t column = static_cast<size_t>(slot.column);
+        const size_t row    = static_cast<size_t>(slot.row);
+        rects[i]            = Rect{column_x[column], row_y[row], column_width[column], row_height[row]};
+    }
+}
+
+} // namespace gomarky
@@ -0,0 +1,145 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <set>
+#include <vector>
+
+namespace gomarky
+{
+
+/// Incremental layout engine over a tree of rows, columns, grids and leaves.
+///
+/// Every container keeps running aggregates of its children's size hints (sums, and sorted
+/// multisets for the maxima), so a changed leaf hint is folded into its ancestors in
+/// O(depth * log children), stopping at the first ancestor whose own hint is unaffected.
+/// Containers whose arrangement changed are recorded along the path to the root, and Arrange()
+/// only revisits those paths. A cell of a large grid whose hint changes without changing its
+/// row or column extent therefore costs O(depth) and moves nothing.
+///
+/// Hints are preferred sizes. Spare space goes to stretched children of rows and columns and is
+/// spread evenly over the tracks of a grid; missing space shrinks children proportionally.
+class LayoutTree
+{
+public:
+    using NodeId = uint32_t;
+
+    static constexpr NodeId kRoot = 0;
+
+    enum class Kind
+    {
+        Leaf,
+        Row,    ///< children left to right
+        Column, ///< children top to bottom
+        Grid,
+    };
+
+    struct Size
+    {
+        int width  = 0;
+        int height = 0;
+
+        bool operator==(const Size& other) const { return width == other.width && height == other.height; }
+        bool operator!=(const Size& other) const { return !(*this == other); }
+    };
+
+    struct Rect
+    {
+        int x      = 0;
+        int y      = 0;
+        int width  = 0;
+        int height = 0;
+
+        bool operator==(const Rect& other) const
+        {
+            return x == other.x && y == other.y && width == other.width && height == other.height;
+        }
+        bool operator!=(const Rect& other) const { return !(*this == other); }
+    };
+
+    /// Where a child goes in its parent: `stretch` for rows and columns, `row`/`column` for grids.
+    /// Value-initialized to all zeros.
+    struct Slot
+    {
+        int stretch;
+        int row;
+        int column;
+    };
+
+    struct GeometryChange
+    {
+        NodeId node;
+        Rect   rect;
+    };
+
+    explicit LayoutTree(Kind root_kind = Kind::Column);
+
+    NodeId AddContainer(NodeId parent, Kind kind, Slot slot = Slot());
+    NodeId AddLeaf(NodeId parent, Size hint, Slot slot = Slot());
+
+    /// Set spacing between children and the margin around them; containers only.
+    void SetSpacing(NodeId container, int spacing, int margin = 0);
+
+    /// Report a leaf's new size hint. Cheap when it did not change.
+    void SetLeafHint(NodeId leaf, Size hint);
+
+    Size Hint(NodeId node) const { return m_nodes[node].hint; }
+    Rect Geometry(NodeId node) const { return m_nodes[node].rect; }
+    Kind NodeKind(NodeId node) const { return m_nodes[node].kind; }
+    size_t NodeCount() const { return m_nodes.size(); }
+
+    /// True when Arrange() has work to do for an unchanged root rect.
+    bool NeedsArrange() const { return m_nodes[kRoot].arrange_dirty || !m_nodes[kRoot].dirty_children.empty(); }
+
+    /// Lay the tree out in `root` and return the leaves whose rect changed.
+    std::vector<GeometryChange> Arrange(const Rect& root);
+
+    /// Nodes visited by the last Arrange(), to check that updates stay local.
+    size_t LastArrangeVisits() const { return m_last_visits; }
+
+private:
+    struct Node
+    {
+        Kind                kind;
+        NodeId              parent = kRoot;
+        Slot                slot;
+        Size                hint;
+        Rect                rect;
+        bool                placed        = false; ///< rect was assigned at least once
+        bool                arrange_dirty = false; ///< children must be re-placed
+        bool                in_dirty_list = false; ///< listed in the parent's dirty_children
+        std::vector<NodeId> children;
+        std::vector<NodeId> dirty_children; ///< children with pending work, when not arrange_dirty
+        int                 spacing = 0;
+        int                 margin  = 0;
+
+        // Rows and columns: sum of the children's main-axis hints, multiset of cross-axis hints.
+        int64_t            main_sum = 0;
+        std::multiset<int> cross;
+
+        // Grids: per track multisets of the hints of the children in it, and the sums of the maxima.
+        std::vector<std::multiset<int>> column_widths;
+        std::vector<std::multiset<int>> row_heights;
+        int64_t                         width_sum  = 0;
+        int64_t                         height_sum = 0;
+    };
+
+    NodeId AddNode(NodeId parent, Kind kind, Size hint, Slot slot);
+
+    /// Fold the change of `id`'s hint from `old_hint` into its ancestors, as far as it reaches.
+    void Propagate(NodeId id, Size old_hint, bool added);
+
+    /// Fold a child's hint change into `parent`'s aggregates; returns true when the placement of
+    /// the parent's children is affected.
+    bool UpdateAggregates(Node& parent, const Node& child, Size old_hint, Size new_hint, bool added);
+    Size ContainerHint(const Node& node) const;
+    void MarkArrangeDirty(NodeId node);
+    void ArrangeNode(NodeId id, const Rect& rect, std::vector<GeometryChange>& changes);
+    void PlaceBox(const Node& node, std::vector<Rect>& rects) const;
+    void PlaceGrid(const Node& node, std::vector<Rect>& rects) const;
+
+    std::vector<Node> m_nodes;
+    size_t            m_last_visits = 0;
+};
+
+} // namespace gomarky
@@ -0,0 +1,513 @@
+#include "metrics/hdr_histogram.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <stdexcept>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+namespace gomarky
+{
+
+namespace
+{
+
+constexpr uint32_t kMagic = 0x48445231; // "HDR1"
+
+std::atomic<uint64_t> g_next_recorder_id{1};
+std::atomic<uint64_t> g_destroyed_recorders{0};
+
+// Ids of the recorders alive, for threads pruning their caches of recorders destroyed since.
+struct LiveRecorders
+{
+    std::mutex                   mutex;
+    std::unordered_set<uint64_t> ids;
+};
+
+LiveRecorders& Live()
+{
+    static LiveRecorders live;
+    return live;
+}
+
+void PutVarint(std::string& out, uint64_t value)
+{
+    while (value >= 0x80)
+    {
+        out += static_cast<char>((value & 0x7f) | 0x80);
+        value >>= 7;
+    }
+    out += static_cast<char>(value);
+}
+
+uint64_t GetVarint(const std::string& data, size_t& position)
+{
+    uint64_t value = 0;
+    for (int shift = 0; shift < 64; shift += 7)
+    {
+        if (position >= data.size()) throw std::invalid_argument("HdrHistogram: truncated data");
+        const auto byte = static_cast<unsigned char>(data[position++]);
+        value |= uint64_t(byte & 0x7f) << shift;
+        if (!(byte & 0x80)) return value;
+    }
+    throw std::invalid_argument("HdrHistogram: malformed varint");
+}
+
+uint64_t ZigZag(int64_t value) { return (static_cast<uint64_t>(value) << 1) ^ static_cast<uint64_t>(value >> 63); }
+int64_t  UnZigZag(uint64_t value) { return static_cast<int64_t>(value >> 1) ^ -static_cast<int64_t>(value & 1); }
+
+} // namespace
+
+HdrHistogram::HdrHistogram(uint64_t lowest, uint64_t highest, int significant_digits)
+    : m_lowest(lowest), m_highest(highest), m_digits(significant_digits)
+{
+    if (lowest < 1 || highest < 2 * lowest || significant_digits < 1 || significant_digits > 5)
+    {
+        throw std::invalid_argument("HdrHistogram: invalid range or precision");
+    }
+
+    // The sub-buckets must resolve one unit at the top of the first bucket: 2 * 10^digits of them.
+    uint64_t single_unit_resolution = 2;
+    for (int i = 0; i < significant_digits; ++i) single_unit_resolution *= 10;
+    int sub_bucket_count_magnitude = 0;
+    while ((uint64_t(1) << sub_bucket_count_magnitude) < single_unit_resolution) ++sub_bucket_count_magnitude;
+
+    m_unit_magnitude                  = 63 - CountLeadingZeros(lowest);
+    m_sub_bucket_half_count_magnitude = std::max(sub_bucket_count_magnitude, 1) - 1;
+    // The sub-bucket mask and the leading zero count base need both to fit in 63 bits.
+    if (m_unit_magnitude + m_sub_bucket_half_count_magnitude > 61)
+    {
+        throw std::invalid_argument("HdrHistogram: lowest value too large for the precision");
+    }
+    const int sub_bucket_count        = 1 << (m_sub_bucket_half_count_magnitude + 1);
+    m_sub_bucket_half_count           = sub_bucket_count / 2;
+    m_sub_bucket_mask                 = uint64_t(sub_bucket_count - 1) << m_unit_magnitude;
+    m_leading_zero_count_base         = 64 - m_unit_magnitude - m_sub_bucket_half_count_magnitude - 1;
+
+    int      buckets     = 1;
+    uint64_t untrackable = uint64_t(sub_bucket_count) << m_unit_magnitude;
+    while (untrackable <= highest)
+    {
+        if (untrackable > (UINT64_MAX >> 1))
+        {
+            ++buckets;
+            break;
+        }
+        untrackable <<= 1;
+        ++buckets;
+    }
+    m_counts_length = static_cast<size_t>(buckets + 1) * m_sub_bucket_half_count;
+    m_counts.reset(new std::atomic<uint64_t>[m_counts_length]);
+    Reset();
+}
+
+HdrHistogram::HdrHistogram(HdrHistogram&& other)
+    : m_lowest(other.m_lowest),
+      m_highest(other.m_highest),
+      m_digits(other.m_digits),
+      m_unit_magnitude(other.m_unit_magnitude),
+      m_sub_bucket_half_count_magnitude(other.m_sub_bucket_half_count_magnitude),
+      m_sub_bucket_half_count(other.m_sub_bucket_half_count),
+      m_sub_bucket_mask(other.m_sub_bucket_mask),
+      m_leading_zero_count_base(other.m_leading_zero_count_base),
+      m_counts_length(other.m_counts_length),
+      m_counts(std::move(other.m_counts)),
+      m_total(other.m_total.load(std::memory_order_relaxed)),
+      m_min(other.m_min.load(std::memory_order_relaxed)),
+      m_max(other.m_max.load(std::memory_order_relaxed))
+{
+}
+
+HdrHistogram& HdrHistogram::operator=(HdrHistogram&& other)
+{
+    m_lowest                          = other.m_lowest;
+    m_highest                         = other.m_highest;
+    m_digits                          = other.m_digits;
+    m_unit_magnitude                  = other.m_unit_magnitude;
+    m_sub_bucket_half_count_magnitude = other.m_sub_bucket_half_count_magnitude;
+    m_sub_bucket_half_count           = other.m_sub_bucket_half_count;
+    m_sub_bucket_mask                 = other.m_sub_bucket_mask;
+    m_leading_zero_count_base         = other.m_leading_zero_count_base;
+    m_counts_length                   = other.m_counts_length;
+    m_counts                          = std::move(other.m_counts);
+    m_total.store(other.m_total.load(std::memory_order_relaxed), std::memory_order_relaxed);
+    m_min.store(other.m_min.load(std::memory_order_relaxed), std::memory_order_relaxed);
+    m_max.store(other.m_max.load(std::memory_order_relaxed), std::memory_order_relaxed);
+    return *this;
+}
+
+void HdrHistogram::Add(const HdrHistogram& other)
+{
+    if (other.m_lowest != m_lowest || other.m_highest != m_highest || other.m_digits != m_digits)
+    {
+        throw std::invalid_argument("HdrHistogram: cannot add histograms with different layouts");
+    }
+    // Totals are rebuilt from the counts actually read, so they agree even if `other` is being
+    // recorded into meanwhile.
+    uint64_t added = 0;
+    for (size_t i = 0; i < m_counts_length; ++i)
+    {
+        const uint64_t count = other.m_counts[i].load(std::memory_order_relaxed);
+        if (!count) continue;
+        Bump(m_counts[i], count);
+        added += count;
+    }
+    Bump(m_total, added);
+    if (added)
+    {
+        const uint64_t min = other.m_min.load(std::memory_order_relaxed);
+        const uint64_t max = other.m_max.load(std::memory_order_relaxed);
+        if (min < m_min.load(std::memory_order_relaxed)) m_min.store(min, std::memory_order_relaxed);
+        if (max > m_max.load(std::memory_order_relaxed)) m_max.store(max, std::memory_order_relaxed);
+    }
+}
+
+void HdrHistogram::Reset()
+{
+    for (size_t i = 0; i < m_counts_length; ++i) m_counts[i].store(0, std::memory_order_relaxed);
+    m_total.store(0, std::memory_order_relaxed);
+    m_min.store(UINT64_MAX, std::memory_order_relaxed);
+    m_max.store(0, std::memory_order_relaxed);
+}
+
+uint64_t HdrHistogram::Min() const { return TotalCount() ? m_min.load(std::memory_order_relaxed) : 0; }
+
+double HdrHistogram::Mean() const
+{
+    const uint64_t total = TotalCount();
+    if (!total) return 0.0;
+    double sum = 0;
+    for (size_t i = 0; i < m_counts_length; ++i)
+    {
+        const uint64_t count = m_counts[i].load(std::memory_order_relaxed);
+        if (count) sum += double(count) * double(MedianEquivalent(ValueFromIndex(i)));
+    }
+    return sum / double(total);
+}
+
+double HdrHistogram::StdDev() const
+{
+    const uint64_t total = TotalCount();
+    if (!total) return 0.0;
+    const double mean = Mean();
+    double       sum  = 0;
+    for (size_t i = 0; i < m_counts_length; ++i)
+    {
+        const uint64_t count = m_counts[i].load(std::memory_order_relaxed);
+        if (!count) continue;
+        const double deviation = double(MedianEquivalent(ValueFromIndex(i))) - mean;
+        sum += double(count) * deviation * deviation;
+    }
+    return std::sqrt(sum / double(total));
+}
+
+uint64_t HdrHistogram::ValueAtPercentile(double percentile) const
+{
+    const uint64_t total = TotalCount();
+    if (!total) return 0;
+    percentile            = std::min(std::max(percentile, 0.0), 100.0);
+    const uint64_t wanted = std::max<uint64_t>(1, static_cast<uint64_t>(percentile / 100.0 * double(total) + 0.5));
+    uint64_t       seen   = 0;
+    for (size_t i = 0; i < m_counts_length; ++i)
+    {
+        seen += m_counts[i].load(std::memory_order_relaxed);
+        if (seen >= wanted) return std::min(HighestEquivalent(ValueFromIndex(i)), Max());
+    }
+    return Max();
+}
+
+uint64_t HdrHistogram::ValueFromIndex(size_t index) const
+{
+    int bucket     = static_cast<int>(index >> m_sub_bucket_half_count_magnitude) - 1;
+    int sub_bucket = static_cast<int>(index & (m_sub_bucket_half_count - 1)) + m_sub_bucket_half_count;
+    if (bucket < 0)
+    {
+        sub_bucket -= m_sub_bucket_half_count;
+        bucket = 0;
+    }
+    return uint64_t(sub_bucket) << (bucket + m_unit_magnitude);
+}
+
+uint64_t HdrHistogram::EquivalentRange(uint64_t value) const
+{
+    const int bucket     = m_leading_zero_count_base - CountLeadingZeros(value | m_sub_bucket_mask);
+    const int sub_bucket = static_cast<int>(value >> (bucket + m_unit_magnitude));
+    const int adjusted   = sub_bucket >= 2 * m_sub_bucket_half_count ? bucket + 1 : bucket;
+    return uint64_t(1) << (m_unit_magnitude + adjusted);
+}
+
+uint64_t HdrHistogram::LowestEquivalent(uint64_t value) const
+{
+    const int bucket     = m_leading_zero_count_base - CountLeadingZeros(value | m_sub_bucket_mask);
+    const int sub_bucket = static_cast<int>(value >> (bucket + m_unit_magnitude));
+    return uint64_t(sub_bucket) << (bucket + m_unit_magnitude);
+}
+
+uint64_t HdrHistogram::HighestEquivalent(uint64_t value) const
+{
+    return LowestEquivalent(value) + EquivalentRange(value) - 1;
+}
+
+uint64_t HdrHistogram::MedianEquivalent(uint64_t value) const
+{
+    return LowestEquivalent(value) + EquivalentRange(value) / 2;
+}
+
+std::string HdrHistogram::Serialize() const
+{
+    std::string out;
+    PutVarint(out, kMagic);
+    PutVarint(out, static_cast<uint64_t>(m_digits));
+    PutVarint(out, m_lowest);
+    PutVarint(out, m_highest);
+    PutVarint(out, Min());
+    PutVarint(out, Max());
+
+    // Trailing empty counts are dropped altogether.
+    size_t length = m_counts_length;
+    while (length && !m_counts[length - 1].load(std::memory_order_relaxed)) --length;
+    PutVarint(out, length);
+    for (size_t i = 0; i < length;)
+    {
+        const uint64_t count = m_counts[i].load(std::memory_order_relaxed);
+        if (count)
+        {
+            PutVarint(out, ZigZag(static_cast<int64_t>(count)));
+            ++i;
+            continue;
+        }
+        const size_t start = i;
+        while (i < length && !m_counts[i].load(std::memory_order_relaxed)) ++i;
+        PutVarint(out, ZigZag(-static_cast<int64_t>(i - start)));
+    }
+    return out;
+}
+
+HdrHistogram HdrHistogram::Deserialize(const std::string& data)
+{
+    size_t position = 0;
+    if (GetVarint(data, position) != kMagic) throw std::invalid_argument("HdrHistogram: bad magic");
+    const uint64_t digits  = GetVarint(data, position);
+    const uint64_t lowest  = GetVarint(data, position);
+    const uint64_t highest = GetVarint(data, position);
+    if (digits > 5) throw std::invalid_argument("HdrHistogram: invalid range or precision");
+    HdrHistogram histogram(lowest, highest, static_cast<int>(digits));
+    const uint64_t min    = GetVarint(data, position);
+    const uint64_t max    = GetVarint(data, position);
+    const uint64_t length = GetVarint(data, position);
+    if (length > histogram.m_counts_length) throw std::invalid_argument("HdrHistogram: too many counts");
+
+    uint64_t total = 0;
+    for (size_t i = 0; i < length;)
+    {
+        const int64_t value = UnZigZag(GetVarint(data, position));
+        if (value > 0)
+        {
+            histogram.m_counts[i++].store(static_cast<uint64_t>(value), std::memory_order_relaxed);
+            total += static_cast<uint64_t>(value);
+        }
+        else
+        {
+            if (value == 0 || static_cast<uint64_t>(-value) > length - i)
+            {
+                throw std::invalid_argument("HdrHistogram: malformed counts");
+            }
+            i += static_cast<size_t>(-value);
+        }
+    }
+    if (position != data.size()) throw std::invalid_argument("HdrHistogram: trailing data");
+    histogram.m_total.store(total, std::memory_order_relaxed);
+    if (total)
+    {
+        histogram.m_min.store(min, std::memory_order_relaxed);
+        histogram.m_max.store(max, std::memory_order_relaxed);
+    }
+    return histogram;
+}
+
+HdrRecorder::HdrRecorder(uint64_t lowest, uint64_t highest, int significant_digits)
+    : m_id(g_next_recorder_id.fetch_add(1, std::memory_order_relaxed)),
+      m_lowest(lowest),
+      m_highest(highest),
+      m_digits(significant_digits)
+{
+    // Validate the parameters up front rather than on some thread's first Record().
+    HdrHistogram validate(lowest, highest, significant_digits);
+
+    LiveRecorders&              live = Live();
+    std::lock_guard<std::mutex> lock(live.mutex);
+    live.ids.insert(m_id);
+}
+
+HdrRecorder::~HdrRecorder()
+{
+    {
+        LiveRecorders&              live = Live();
+        std::lock_guard<std::mutex> lock(live.mutex);
+        live.ids.erase(m_id);
+    }
+    g_destroyed_recorders.fetch_add(1, std::memory_order_release);
+
+    for (Shard* shard = m_shards.load(std::memory_order_acquire); shard;)
+    {
+        Shard* next = shard->next;
+        delete shard;
+        shard = next;
+    }
+}
+
+HdrHistogram& HdrRecorder::ThisThread()
+{
+    // Recorder ids are never reused, so entries left behind by destroyed recorders are never
+    // matched again; they are pruned when a new entry is added. The last hit is checked first
+    // since a thread usually records into one.
+    struct Entry
+    {
+        uint64_t      id;
+        HdrHistogram* histogram;
+    };
+    thread_local std::vector<Entry> entries;
+    thread_local Entry              last{0, nullptr};
+    thread_local uint64_t           destroyed_seen = 0;
+
+    if (last.id == m_id) return *last.histogram;
+    for (const Entry& entry : entries)
+    {
+        if (entry.id != m_id) continue;
+        last = entry;
+        return *entry.histogram;
+    }
+    const uint64_t destroyed = g_destroyed_recorders.load(std::memory_order_acquire);
+    if (destroyed != destroyed_seen)
+    {
+        LiveRecorders&              live = Live();
+        std::lock_guard<std::mutex> lock(live.mutex);
+        entries.erase(std::remove_if(entries.begin(), entries.end(),
+                                     [&live](const Entry& entry) { return !live.ids.count(entry.id); }),
+                      entries.end());
+        destroyed_seen = destroyed;
+    }
+    entries.push_back({m_id, &AddShard()});
+    last = entries.back();
+    return *last.histogram;
+}
+
+HdrHistogram& HdrRecorder::AddShard()
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    Shard*                      shard = new Shard{HdrHistogram(m_lowest, m_highest, m_digits), nullptr};
+    shard->next                       = m_shards.load(std::memory_order_relaxed);
+    m_shards.store(shard, std::memory_order_release);
+    return shard->shard;
+}
+
+HdrHistogram HdrRecorder::Snapshot() const
+{
+    HdrHistogram merged(m_lowest, m_highest, m_digits);
+    for (const Shard* shard = m_shards.load(std::memory_order_acquire); shard; shard = shard->next)
+    {
+        merged.Add(shard->shard);
+    }
+    return merged;
+}
+
+namespace
+{
+
+struct PercentileRow
+{
+    uint64_t value;
+    double   percentile;
+    uint64_t total_count;
+};
+
+// Rows at 0%, 50%, 75%, 87.5%... each halving of the distance to 100% split into
+// `ticks_per_half` steps, until the maximum is reached, then one row at 100%.
+std::vector<PercentileRow> PercentileRows(const HdrHistogram& histogram, int ticks_per_half)
+{
+    std::vector<PercentileRow> rows;
+    const uint64_t             total = histogram.TotalCount();
+    if (!total) return rows;
+    ticks_per_half = std::max(ticks_per_half, 1);
+    for (int half = 0;; ++half)
+    {
+        for (int tick = 0; tick < ticks_per_half; ++tick)
+        {
+            const double percentile = 100.0 * (1.0 - std::pow(0.5, half + double(tick) / ticks_per_half));
+            const double remaining  = 100.0 - percentile;
+            if (remaining * double(total) < 100.0 || rows.size() > 1000)
+            {
+                rows.push_back({histogram.Max(), 100.0, total});
+                return rows;
+            }
+            const uint64_t value = histogram.ValueAtPercentile(percentile);
+            const uint64_t count = static_cast<uint64_t>(std::max(1.0, std::ceil(percentile / 100.0 * double(total))));
+            rows.push_back({value, percentile, std::min(count, total)});
+        }
+    }
+}
+
+} // namespace
+
+std::string FormatPercentiles(const HdrHistogram& histogram, int ticks_per_half, double scale)
+{
+    std::string out = "       Value     Percentile TotalCount 1/(1-Percentile)\n\n";
+    char        line[128];
+    for (const auto& row : PercentileRows(histogram, ticks_per_half))
+    {
+        if (row.percentile < 100.0)
+        {
+            std::snprintf(line, sizeof(line), "%12.3f %14.12f %10llu %14.2f\n", double(row.value) / scale,
+                          row.percentile / 100.0, static_cast<unsigned long long>(row.total_count),
+                          1.0 / (1.0 - row.percentile / 100.0));
+        }
+        else
+        {
+            std::snprintf(line, sizeof(line), "%12.3f %14.12f %10llu\n", double(row.value) / scale, 1.0,
+                          static_cast<unsigned long long>(row.total_count));
+        }
+        out += line;
+    }
+    std::snprintf(line, sizeof(line), "#[Mean = %12.3f, StdDeviation = %12.3f]\n#[Max = %12.3f, Total count = %12llu]\n",
+                  histogram.Mean() / scale, histogram.StdDev() / scale, double(histogram.Max()) / scale,
+                  static_cast<unsigned long long>(histogram.TotalCount()));
+    out += line;
+    return out;
+}
+
+std::string FormatPercentilesCsv(const HdrHistogram& histogram, int ticks_per_half, double scale)
+{
+    std::string out = "value,percentile,total_count,inverted_percentile\n";
+    char        line[128];
+    for (const auto& row : PercentileRows(histogram, ticks_per_half))
+    {
+        if (row.percentile < 100.0)
+        {
+            std::snprintf(line, sizeof(line), "%.3f,%.12f,%llu,%.2f\n", double(row.value) / scale,
+                          row.percentile / 100.0, static_cast<unsigned long long>(row.total_count),
+                          1.0 / (1.0 - row.percentile / 100.0));
+        }
+        else
+        {
+            std::snprintf(line, sizeof(line), "%.3f,1.0,%llu,Infinity\n", double(row.value) / scale,
+                          static_cast<unsigned long long>(row.total_count));
+        }
+        out += line;
+    }
+    return out;
+}
+
+std::string FormatSummary(const HdrHistogram& histogram, double scale)
+{
+    char text[256];
+    std::snprintf(text, sizeof(text), "count=%llu min=%g p50=%g p90=%g p99=%g p99.9=%g max=%g",
+                  static_cast<unsigned long long>(histogram.TotalCount()), double(histogram.Min()) / scale,
+                  double(histogram.ValueAtPercentile(50)) / scale, double(histogram.ValueAtPercentile(90)) / scale,
+                  double(histogram.ValueAtPercentile(99)) / scale, double(histogram.ValueAtPercentile(99.9)) / scale,
+                  double(histogram.Max()) / scale);
+    return text;
+}
+
+} // namespace gomarky
@@ -0,0 +1,162 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+
+namespace gomarky
+{
+
+/// High dynamic range histogram: values in [lowest, highest] are kept to `significant_digits`
+/// decimal digits of precision in a fixed number of counts, whatever their distribution.
+///
+/// Buckets double in width, each split into 2 * 10^digits linear sub-buckets (rounded up to a
+/// power of two), so recording is a count-leading-zeros, two shifts and an increment.
+///
+/// One thread records; any thread may read, Add() or Serialize() concurrently and sees a
+/// slightly stale but consistent-enough view. Use HdrRecorder to record from many threads.
+class HdrHistogram
+{
+public:
+    /// Throws std::invalid_argument unless 1 <= lowest, 2 * lowest <= highest and
+    /// 1 <= significant_digits <= 5.
+    HdrHistogram(uint64_t lowest, uint64_t highest, int significant_digits);
+
+    HdrHistogram(HdrHistogram&& other);
+    HdrHistogram& operator=(HdrHistogram&& other);
+
+    uint64_t Lowest() const { return m_lowest; }
+    uint64_t Highest() const { return m_highest; }
+    int      SignificantDigits() const { return m_digits; }
+    /// Memory held by the counts.
+    size_t   Footprint() const { return m_counts_length * sizeof(uint64_t); }
+
+    /// Values above Highest() are counted as Highest().
+    void Record(uint64_t value, uint64_t count = 1)
+    {
+        if (value > m_highest) value = m_highest;
+        Bump(m_counts[CountsIndex(value)], count);
+        Bump(m_total, count);
+        if (value < m_min.load(std::memory_order_relaxed)) m_min.store(value, std::memory_order_relaxed);
+        if (value > m_max.load(std::memory_order_relaxed)) m_max.store(value, std::memory_order_relaxed);
+    }
+
+    /// Add every count of `other`, which must have the same lowest, highest and precision
+    /// (std::invalid_argument otherwise). Reads `other` without locking.
+    void Add(const HdrHistogram& other);
+    void Reset();
+
+    uint64_t TotalCount() const { return m_total.load(std::memory_order_relaxed); }
+    /// 0 when empty.
+    uint64_t Min() const;
+    uint64_t Max() const { return m_max.load(std::memory_order_relaxed); }
+    double   Mean() const;
+    double   StdDev() const;
+
+    /// Smallest recorded value v such that `percentile` percent of the values are <= v, reported
+    /// as the highest value equivalent to it at this precision. 0 when empty.
+    uint64_t ValueAtPercentile(double percentile) const;
+
+    /// Values that map to the same count as `value` share one of these ranges.
+    uint64_t LowestEquivalent(uint64_t value) const;
+    uint64_t HighestEquivalent(uint64_t value) const;
+
+    /// Compact encoding: the parameters, then the counts as zigzag LEB128 varints with runs of
+    /// empty counts collapsed into one negative number.
+    std::string Serialize() const;
+    /// Throws std::invalid_argument on malformed input.
+    static HdrHistogram Deserialize(const std::string& data);
+
+private:
+    static void Bump(std::atomic<uint64_t>& slot, uint64_t amount)
+    {
+        // Single writer, so a plain load and store is enough and much cheaper than an RMW.
+        slot.store(slot.load(std::memory_order_relaxed) + amount, std::memory_order_relaxed);
+    }
+
+    static int CountLeadingZeros(uint64_t value)
+    {
+#if defined(__GNUC__)
+        return __builtin_clzll(value);
+#else
+        int count = 0;
+        for (uint64_t bit = uint64_t(1) << 63; !(value & bit); bit >>= 1) ++count;
+        return count;
+#endif
+    }
+
+    size_t CountsIndex(uint64_t value) const
+    {
+        const int bucket     = m_leading_zero_count_base - CountLeadingZeros(value | m_sub_bucket_mask);
+        const int sub_bucket = static_cast<int>(value >> (bucket + m_unit_magnitude));
+        return (static_cast<size_t>(bucket + 1) << m_sub_bucket_half_count_magnitude) +
+               (sub_bucket - m_sub_bucket_half_count);
+    }
+    uint64_t ValueFromIndex(size_t index) const;
+    uint64_t EquivalentRange(uint64_t value) const;
+    uint64_t MedianEquivalent(uint64_t value) const;
+
+    uint64_t m_lowest;
+    uint64_t m_highest;
+    int      m_digits;
+    int      m_unit_magnitude;
+    int      m_sub_bucket_half_count_magnitude;
+    int      m_sub_bucket_half_count;
+    uint64_t m_sub_bucket_mask;
+    int      m_leading_zero_count_base;
+    size_t   m_counts_length;
+
+    std::unique_ptr<std::atomic<uint64_t>[]> m_counts;
+    std::atomic<uint64_t>                    m_total{0};
+    std::atomic<uint64_t>                    m_min{UINT64_MAX};
+    std::atomic<uint64_t>                    m_max{0};
+};
+
+/// Records into one HdrHistogram per calling thread, so Record() never contends, and merges
+/// them on demand without stopping the recorders.
+class HdrRecorder
+{
+public:
+    HdrRecorder(uint64_t lowest, uint64_t highest, int significant_digits);
+    ~HdrRecorder();
+
+    HdrRecorder(const HdrRecorder&) = delete;
+    HdrRecorder& operator=(const HdrRecorder&) = delete;
+
+    void Record(uint64_t value, uint64_t count = 1) { ThisThread().Record(value, count); }
+
+    /// The calling thread's histogram, created on its first use.
+    HdrHistogram& ThisThread();
+
+    /// Everything recorded so far, by any thread (including threads that have exited).
+    HdrHistogram Snapshot() const;
+
+private:
+    struct Shard
+    {
+        HdrHistogram shard;
+        Shard*       next;
+    };
+
+    HdrHistogram& AddShard();
+
+    const uint64_t      m_id; ///< never reused, unlike the address, so per-thread caches stay valid
+    const uint64_t      m_lowest;
+    const uint64_t      m_highest;
+    const int           m_digits;
+    std::atomic<Shard*> m_shards{nullptr};
+    std::mutex          m_mutex; ///< serializes AddShard
+};
+
+/// HdrHistogram-style percentile distribution: "Value Percentile TotalCount 1/(1-Percentile)"
+/// with `ticks_per_half` rows per halving of the remaining distance to 100%. Values are divided
+/// by `scale`, e.g. 1000 to print nanoseconds as microseconds.
+std::string FormatPercentiles(const HdrHistogram& histogram, int ticks_per_half = 5, double scale = 1.0);
+/// The same rows as CSV, with a "value,percentile,total_count,inverted_percentile" header.
+std::string FormatPercentilesCsv(const HdrHistogram& histogram, int ticks_per_half = 5, double scale = 1.0);
+/// "count=100 min=3 p50=12 p90=40 p99=95 p99.9=99 max=99".
+std::string FormatSummary(const HdrHistogram& histogram, double scale = 1.0);
+
+} // namespace gomarky
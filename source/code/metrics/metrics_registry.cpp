@@ -0,0 +1,72 @@
+#include "metrics/metrics_registry.h"
+
+#include <algorithm>
+
+namespace gomarky
+{
+
+MetricsRegistry& MetricsRegistry::Global()
+{
+    // Leaked so that metrics can still be bumped from static destructors.
+    static MetricsRegistry* registry = new MetricsRegistry;
+    return *registry;
+}
+
+Counter& MetricsRegistry::GetCounter(const std::string& name)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    auto&                       slot = m_counters[name];
+    if (!slot) slot.reset(new Counter);
+    return *slot;
+}
+
+Gauge& MetricsRegistry::GetGauge(const std::string& name)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    auto&                       slot = m_gauges[name];
+    if (!slot) slot.reset(new Gauge);
+    return *slot;
+}
+
+HdrRecorder& MetricsRegistry::GetHistogram(const std::string& name)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    auto&                       slot = m_histograms[name];
+    if (!slot) slot.reset(new HdrRecorder(1, uint64_t(3600) * 1000000000, 2));
+    return *slot;
+}
+
+std::vector<MetricSample> MetricsRegistry::Snapshot() const
+{
+    std::vector<MetricSample> samples;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        samples.reserve(m_counters.size() + m_gauges.size());
+        for (const auto& counter : m_counters)
+        {
+            samples.push_back({counter.first, MetricSample::Kind::Counter, static_cast<int64_t>(counter.second->Value())});
+        }
+        for (const auto& gauge : m_gauges)
+        {
+            samples.push_back({gauge.first, MetricSample::Kind::Gauge, gauge.second->Value()});
+        }
+    }
+    std::stable_sort(samples.begin(), samples.end(),
+                     [](const MetricSample& a, const MetricSample& b) { return a.name < b.name; });
+    return samples;
+}
+
+std::string MetricsRegistry::Format() const
+{
+    std::string out;
+    for (const auto& sample : Snapshot()) out += sample.name + ' ' + std::to_string(sample.value) + '\n';
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    for (const auto& histogram : m_histograms)
+    {
+        out += histogram.first + ' ' + FormatSummary(histogram.second->Snapshot()) + '\n';
+    }
+    return out;
+}
+
+} // namespace gomarky
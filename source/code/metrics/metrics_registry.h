@@ -0,0 +1,80 @@
+#pragma once
+
+#include "metrics/hdr_histogram.h"
+
+#include <atomic>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace gomarky
+{
+
+/// Monotonic count, cheap enough to bump on hot paths from any thread.
+class Counter
+{
+public:
+    void     Add(uint64_t amount = 1) { m_value.fetch_add(amount, std::memory_order_relaxed); }
+    uint64_t Value() const { return m_value.load(std::memory_order_relaxed); }
+
+private:
+    std::atomic<uint64_t> m_value{0};
+};
+
+/// Current level of something, like bytes held by a cache.
+class Gauge
+{
+public:
+    void    Set(int64_t value) { m_value.store(value, std::memory_order_relaxed); }
+    void    Add(int64_t delta) { m_value.fetch_add(delta, std::memory_order_relaxed); }
+    int64_t Value() const { return m_value.load(std::memory_order_relaxed); }
+
+private:
+    std::atomic<int64_t> m_value{0};
+};
+
+struct MetricSample
+{
+    enum class Kind
+    {
+        Counter,
+        Gauge,
+    };
+
+    std::string name;
+    Kind        kind;
+    int64_t     value;
+};
+
+/// Named counters, gauges and latency histograms shared by the engines, looked up once and then updated lock-free.
+class MetricsRegistry
+{
+public:
+    /// Process-wide registry used by the engines that do not get one injected.
+    static MetricsRegistry& Global();
+
+    /// The metric called `name`, created on first use. References stay valid for the lifetime of
+    /// the registry, so callers keep them instead of looking them up again.
+    Counter& GetCounter(const std::string& name);
+    Gauge&   GetGauge(const std::string& name);
+
+    /// Latency histogram of nanoseconds from 1 ns to an hour, to 2 significant digits.
+    HdrRecorder& GetHistogram(const std::string& name);
+
+    /// Every counter and gauge, ordered by name.
+    std::vector<MetricSample> Snapshot() const;
+    /// One "name value" line per metric, in Snapshot() order, then one "name count=... p50=..."
+    /// line per histogram.
+    std::string Format() const;
+
+private:
+    mutable std::mutex                                  m_mutex;
+    std::map<std::string, std::unique_ptr<Counter>>     m_counters;
+    std::map<std::string, std::unique_ptr<Gauge>>       m_gauges;
+    std::map<std::string, std::unique_ptr<HdrRecorder>> m_histograms;
+};
+
+} // namespace gomarky
@@ -0,0 +1,249 @@
+#include "metrics/perf_counters.h"
+
+#include "metrics/metrics_registry.h"
+
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+
+#if defined(__linux__)
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+namespace gomarky
+{
+
+PerfSample& PerfSample::operator+=(const PerfSample& other)
+{
+    cycles += other.cycles;
+    instructions += other.instructions;
+    cache_misses += other.cache_misses;
+    branch_misses += other.branch_misses;
+    return *this;
+}
+
+PerfSample PerfSample::operator-(const PerfSample& other) const
+{
+    PerfSample delta;
+    delta.cycles        = cycles - other.cycles;
+    delta.instructions  = instructions - other.instructions;
+    delta.cache_misses  = cache_misses - other.cache_misses;
+    delta.branch_misses = branch_misses - other.branch_misses;
+    return delta;
+}
+
+namespace
+{
+
+uint64_t* Field(PerfSample& sample, int event)
+{
+    uint64_t* fields[] = {&sample.cycles, &sample.instructions, &sample.cache_misses, &sample.branch_misses};
+    return fields[event];
+}
+
+#if defined(__linux__)
+
+const uint64_t kEventConfigs[] = {PERF_COUNT_HW_CPU_CYCLES, PERF_COUNT_HW_INSTRUCTIONS, PERF_COUNT_HW_CACHE_MISSES,
+                                  PERF_COUNT_HW_BRANCH_MISSES};
+
+// User space only, so that counts do not depend on what the kernel did on our behalf. The leader
+// starts disabled and the whole group is enabled at once.
+int OpenEvent(uint64_t config, int leader)
+{
+    perf_event_attr attr;
+    std::memset(&attr, 0, sizeof(attr));
+    attr.size           = sizeof(attr);
+    attr.type           = PERF_TYPE_HARDWARE;
+    attr.config         = config;
+    attr.disabled       = leader < 0;
+    attr.exclude_kernel = 1;
+    attr.exclude_hv     = 1;
+    attr.read_format    = PERF_FORMAT_GROUP;
+    unsigned long flags = 0;
+#if defined(PERF_FLAG_FD_CLOEXEC)
+    flags = PERF_FLAG_FD_CLOEXEC;
+#endif
+    return static_cast<int>(syscall(SYS_perf_event_open, &attr, 0, -1, leader, flags));
+}
+
+#if defined(__x86_64__) || defined(__i386__)
+inline uint64_t Rdpmc(uint32_t counter)
+{
+    uint32_t low, high;
+    asm volatile("rdpmc" : "=a"(low), "=d"(high) : "c"(counter));
+    return uint64_t(high) << 32 | low;
+}
+#endif
+
+#endif
+
+} // namespace
+
+PerfCounters::PerfCounters()
+{
+#if defined(__linux__)
+    m_fds[0] = OpenEvent(kEventConfigs[0], -1);
+    if (m_fds[0] < 0)
+    {
+        m_error = std::string("perf_event_open: ") + std::strerror(errno);
+        return;
+    }
+    for (int event = 1; event < kEvents; ++event) m_fds[event] = OpenEvent(kEventConfigs[event], m_fds[0]);
+
+#if defined(__x86_64__) || defined(__i386__)
+    // rdpmc needs the first page of every event: it holds the hardware counter index, and the
+    // kernel only grants user-space rdpmc through cap_user_rdpmc.
+    m_rdpmc              = true;
+    const long page_size = sysconf(_SC_PAGESIZE);
+    for (int event = 0; event < kEvents; ++event)
+    {
+        if (m_fds[event] < 0) continue;
+        void* page = mmap(nullptr, page_size, PROT_READ, MAP_SHARED, m_fds[event], 0);
+        if (page == MAP_FAILED)
+        {
+            m_rdpmc = false;
+            continue;
+        }
+        m_pages[event] = page;
+        m_rdpmc        = m_rdpmc && static_cast<perf_event_mmap_page*>(page)->cap_user_rdpmc;
+    }
+#endif
+
+    ioctl(m_fds[0], PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+    ioctl(m_fds[0], PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+#else
+    m_error = "hardware counters are only supported on Linux";
+#endif
+}
+
+PerfCounters::~PerfCounters()
+{
+#if defined(__linux__)
+    const long page_size = sysconf(_SC_PAGESIZE);
+    for (int event = 0; event < kEvents; ++event)
+    {
+        if (m_pages[event]) munmap(m_pages[event], page_size);
+        if (m_fds[event] >= 0) close(m_fds[event]);
+    }
+#endif
+}
+
+PerfCounters& PerfCounters::ThisThread()
+{
+    thread_local PerfCounters counters;
+    return counters;
+}
+
+PerfSample PerfCounters::Read() const
+{
+    PerfSample sample;
+    if (!Available()) return sample;
+    if (m_rdpmc && ReadRdpmc(sample)) return sample;
+    ReadGroup(sample);
+    return sample;
+}
+
+bool PerfCounters::ReadRdpmc(PerfSample& sample) const
+{
+#if defined(__linux__) && (defined(__x86_64__) || defined(__i386__))
+    for (int event = 0; event < kEvents; ++event)
+    {
+        if (m_fds[event] < 0) continue;
+        auto*    page = static_cast<volatile perf_event_mmap_page*>(m_pages[event]);
+        uint32_t sequence;
+        uint64_t count;
+        // The kernel bumps `lock` around every update of the page, e.g. when the thread migrates.
+        do
+        {
+            sequence = page->lock;
+            asm volatile("" ::: "memory");
+            const uint32_t index = page->index;
+            const uint16_t width = page->pmc_width;
+            if (index == 0 || width == 0) return false; // not on a hardware counter right now
+            const int      shift = 64 - width;
+            const int64_t  pmc   = static_cast<int64_t>(Rdpmc(index - 1) << shift) >> shift;
+            count                = static_cast<uint64_t>(page->offset + pmc);
+            asm volatile("" ::: "memory");
+        } while (page->lock != sequence);
+        *Field(sample, event) = count;
+    }
+    return true;
+#else
+    (void)sample;
+    return false;
+#endif
+}
+
+bool PerfCounters::ReadGroup(PerfSample& sample) const
+{
+#if defined(__linux__)
+    // PERF_FORMAT_GROUP: the number of events, then one value per event in creation order.
+    uint64_t values[1 + kEvents] = {};
+    if (read(m_fds[0], values, sizeof(values)) < static_cast<ssize_t>(sizeof(uint64_t))) return false;
+    uint64_t next = 1;
+    for (int event = 0; event < kEvents && next <= values[0]; ++event)
+    {
+        if (m_fds[event] >= 0) *Field(sample, event) = values[next++];
+    }
+    return true;
+#else
+    (void)sample;
+    return false;
+#endif
+}
+
+PerfZone::PerfZone(const std::string& name, MetricsRegistry& registry)
+    : m_name(name),
+      m_calls(registry.GetCounter("perf." + name + ".calls")),
+      m_cycles(registry.GetCounter("perf." + name + ".cycles")),
+      m_instructions(registry.GetCounter("perf." + name + ".instructions")),
+      m_cache_misses(registry.GetCounter("perf." + name + ".cache_misses")),
+      m_branch_misses(registry.GetCounter("perf." + name + ".branch_misses"))
+{
+}
+
+PerfZone::PerfZone(const std::string& name)
+    : PerfZone(name, MetricsRegistry::Global())
+{
+}
+
+PerfZone::Scope::Scope(PerfZone& zone) : m_zone(zone), m_start(PerfCounters::ThisThread().Read()) {}
+
+PerfZone::Scope::~Scope()
+{
+    const PerfSample delta = PerfCounters::ThisThread().Read() - m_start;
+    m_zone.m_calls.Add();
+    m_zone.m_cycles.Add(delta.cycles);
+    m_zone.m_instructions.Add(delta.instructions);
+    m_zone.m_cache_misses.Add(delta.cache_misses);
+    m_zone.m_branch_misses.Add(delta.branch_misses);
+}
+
+PerfSample PerfZone::Total() const
+{
+    PerfSample total;
+    total.cycles        = m_cycles.Value();
+    total.instructions  = m_instructions.Value();
+    total.cache_misses  = m_cache_misses.Value();
+    total.branch_misses = m_branch_misses.Value();
+    return total;
+}
+
+uint64_t PerfZone::Calls() const { return m_calls.Value(); }
+
+std::string PerfZone::Format() const
+{
+    const PerfSample total = Total();
+    const double     calls = Calls() ? double(Calls()) : 1.0;
+    char             text[256];
+    std::snprintf(text, sizeof(text), "%s: %llu calls, IPC %.2f, %.2f cache misses/call, %.2f branch misses/call",
+                  m_name.c_str(), static_cast<unsigned long long>(Calls()), total.Ipc(),
+                  double(total.cache_misses) / calls, double(total.branch_misses) / calls);
+    return text;
+}
+
+} // namespace gomarky
@@ -0,0 +1,128 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+
+namespace gomarky
+{
+
+class Counter;
+class MetricsRegistry;
+
+/// Hardware counts over some stretch of one thread's execution.
+struct PerfSample
+{
+    uint64_t cycles        = 0;
+    uint64_t instructions  = 0;
+    uint64_t cache_misses  = 0; ///< last-level cache misses
+    uint64_t branch_misses = 0;
+
+    /// Instructions per cycle, 0 when no cycles were counted.
+    double Ipc() const { return cycles ? double(instructions) / double(cycles) : 0.0; }
+
+    PerfSample& operator+=(const PerfSample& other);
+    PerfSample  operator-(const PerfSample& other) const;
+};
+
+/// Cycle, instruction, cache-miss and branch-miss counters of the calling thread, opened as one
+/// perf_event_open group so that all four cover exactly the same instructions.
+///
+/// Reads use rdpmc through the group's mmap pages where the kernel allows it (no system call),
+/// otherwise a read() of the group. Where counters are not permitted (perf_event_paranoid,
+/// containers, virtual machines without a PMU, other systems) Available() is false and every
+/// read returns zeros; events the CPU lacks read as zero while the others keep working.
+class PerfCounters
+{
+public:
+    PerfCounters();
+    ~PerfCounters();
+
+    PerfCounters(const PerfCounters&) = delete;
+    PerfCounters& operator=(const PerfCounters&) = delete;
+
+    /// The calling thread's counters, opened on first use. Only valid on that thread.
+    static PerfCounters& ThisThread();
+
+    bool Available() const { return m_fds[0] >= 0; }
+    /// True when reads go through rdpmc instead of a system call.
+    bool UsesRdpmc() const { return m_rdpmc; }
+
+    /// Counts since the counters were opened.
+    PerfSample Read() const;
+
+    /// Why the counters are unavailable, empty when they are.
+    const std::string& Error() const { return m_error; }
+
+private:
+    static constexpr int kEvents = 4;
+
+    bool ReadRdpmc(PerfSample& sample) const;
+    bool ReadGroup(PerfSample& sample) const;
+
+    int         m_fds[kEvents]   = {-1, -1, -1, -1};
+    void*       m_pages[kEvents] = {};
+    bool        m_rdpmc          = false;
+    std::string m_error;
+};
+
+/// Adds the counts between construction and destruction to `total`.
+class PerfScope
+{
+public:
+    explicit PerfScope(PerfSample& total, PerfCounters& counters = PerfCounters::ThisThread())
+        : m_total(total), m_counters(counters), m_start(counters.Read())
+    {
+    }
+    ~PerfScope() { m_total += m_counters.Read() - m_start; }
+
+    PerfScope(const PerfScope&) = delete;
+    PerfScope& operator=(const PerfScope&) = delete;
+
+private:
+    PerfSample&   m_total;
+    PerfCounters& m_counters;
+    PerfSample    m_start;
+};
+
+/// A named instrumented region. Every pass through a PerfZone::Scope adds one call and its counts
+/// to the registry counters "perf.<name>.calls", ".cycles", ".instructions", ".cache_misses" and
+/// ".branch_misses", so zones show up in MetricsRegistry snapshots next to the other metrics.
+///
+/// Declare zones once (typically as function statics) and open scopes on the hot path.
+class PerfZone
+{
+public:
+    explicit PerfZone(const std::string& name, MetricsRegistry& registry);
+    explicit PerfZone(const std::string& name);
+
+    class Scope
+    {
+    public:
+        explicit Scope(PerfZone& zone);
+        ~Scope();
+
+        Scope(const Scope&) = delete;
+        Scope& operator=(const Scope&) = delete;
+
+    private:
+        PerfZone&  m_zone;
+        PerfSample m_start;
+    };
+
+    /// Totals recorded so far.
+    PerfSample Total() const;
+    uint64_t   Calls() const;
+
+    /// "name: 12 calls, IPC 1.85, 0.3 cache misses/call, 2.1 branch misses/call".
+    std::string Format() const;
+
+private:
+    std::string m_name;
+    Counter&    m_calls;
+    Counter&    m_cycles;
+    Counter&    m_instructions;
+    Counter&    m_cache_misses;
+    Counter&    m_branch_misses;
+};
+
+} // namespace gomarky
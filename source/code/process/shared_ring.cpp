@@ -0,0 +1,347 @@
+#include "process/shared_ring.h"
+
+#include <cerrno>
+#include <chrono>
+#include <new>
+#include <stdexcept>
+#include <system_error>
+#include <utility>
+
+#if defined(__linux__)
+#include <poll.h>
+#include <sys/eventfd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+namespace gomarky
+{
+
+namespace
+{
+
+constexpr uint64_t kMagic       = 0x676d2d72696e6731; // "gm-ring1"
+constexpr size_t   kHeaderBytes = 4096;
+constexpr size_t   kMinCapacity = 4096;
+constexpr size_t   kMaxCapacity = size_t(1) << 30;
+constexpr uint32_t kWrap        = 0xffffffff; ///< record size marking the unused tail of the buffer
+
+struct Record
+{
+    uint32_t size;
+    uint32_t tag;
+};
+
+size_t RecordBytes(size_t size) { return sizeof(Record) + ((size + 7) & ~size_t(7)); }
+
+#if defined(__linux__)
+[[noreturn]] void ThrowErrno(const char* what) { throw std::system_error(errno, std::generic_category(), what); }
+#endif
+
+} // namespace
+
+// Each side's counter shares a cache line with the flag only that side writes.
+struct SharedRing::Header
+{
+    uint64_t magic;
+    uint64_t capacity;
+    alignas(64) std::atomic<uint64_t> head;             ///< bytes ever committed
+    std::atomic<uint32_t>             producer_waiting; ///< producer sleeps on the writable eventfd
+    alignas(64) std::atomic<uint64_t> tail;             ///< bytes ever released
+    std::atomic<uint32_t>             consumer_waiting; ///< consumer sleeps on the readable eventfd
+};
+
+SharedRing::SharedRing(SharedRing&& other) noexcept { *this = std::move(other); }
+
+SharedRing& SharedRing::operator=(SharedRing&& other) noexcept
+{
+    if (this == &other) return *this;
+    Reset();
+    m_header      = other.m_header;
+    m_data        = other.m_data;
+    m_capacity    = other.m_capacity;
+    m_mapped      = other.m_mapped;
+    m_memory_fd   = other.m_memory_fd;
+    m_readable_fd = other.m_readable_fd;
+    m_writable_fd = other.m_writable_fd;
+    m_position    = other.m_position;
+    m_pending     = other.m_pending;
+    m_wanted      = other.m_wanted;
+    m_sleeps      = other.m_sleeps;
+    other.m_header      = nullptr;
+    other.m_data        = nullptr;
+    other.m_capacity    = 0;
+    other.m_mapped      = 0;
+    other.m_memory_fd   = -1;
+    other.m_readable_fd = -1;
+    other.m_writable_fd = -1;
+    return *this;
+}
+
+SharedRing::~SharedRing() { Reset(); }
+
+void SharedRing::Reset()
+{
+#if defined(__linux__)
+    if (m_header) munmap(m_header, m_mapped);
+    for (int fd : {m_memory_fd, m_readable_fd, m_writable_fd})
+    {
+        if (fd >= 0) close(fd);
+    }
+#endif
+    m_header      = nullptr;
+    m_data        = nullptr;
+    m_memory_fd   = -1;
+    m_readable_fd = -1;
+    m_writable_fd = -1;
+}
+
+SharedRing SharedRing::Create(size_t capacity)
+{
+#if defined(__linux__)
+    if (capacity > kMaxCapacity) throw std::invalid_argument("shared ring capacity is limited to 1 GB");
+    size_t size = kMinCapacity;
+    while (size < capacity) size <<= 1;
+
+    // Through syscall() because older C libraries have no memfd_create wrapper.
+    constexpr unsigned kCloseOnExec = 1; // MFD_CLOEXEC
+    SharedRing ring;
+    ring.m_memory_fd = static_cast<int>(syscall(SYS_memfd_create, "gomarky-ring", kCloseOnExec));
+    if (ring.m_memory_fd < 0) ThrowErrno("memfd_create");
+    ring.m_readable_fd = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+    ring.m_writable_fd = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+    if (ring.m_readable_fd < 0 || ring.m_writable_fd < 0) ThrowErrno("eventfd");
+    if (ftruncate(ring.m_memory_fd, static_cast<off_t>(kHeaderBytes + size)) != 0) ThrowErrno("ftruncate");
+
+    void* memory = mmap(nullptr, kHeaderBytes + size, PROT_READ | PROT_WRITE, MAP_SHARED, ring.m_memory_fd, 0);
+    if (memory == MAP_FAILED) ThrowErrno("mmap");
+    ring.m_mapped   = kHeaderBytes + size;
+    ring.m_header   = new (memory) Header();
+    ring.m_data     = static_cast<char*>(memory) + kHeaderBytes;
+    ring.m_capacity = size;
+    ring.m_header->magic    = kMagic;
+    ring.m_header->capacity = size;
+    return ring;
+#else
+    (void)capacity;
+    throw std::runtime_error("shared memory rings are only implemented on Linux");
+#endif
+}
+
+SharedRing SharedRing::Attach(int memory_fd, int readable_fd, int writable_fd)
+{
+#if defined(__linux__)
+    SharedRing ring;
+    ring.m_memory_fd   = memory_fd;
+    ring.m_readable_fd = readable_fd;
+    ring.m_writable_fd = writable_fd;
+
+    struct stat info;
+    if (fstat(memory_fd, &info) != 0) ThrowErrno("fstat");
+    const size_t mapped = static_cast<size_t>(info.st_size);
+    if (mapped <= kHeaderBytes) throw std::invalid_argument("not a shared ring");
+    void* memory = mmap(nullptr, mapped, PROT_READ | PROT_WRITE, MAP_SHARED, memory_fd, 0);
+    if (memory == MAP_FAILED) ThrowErrno("mmap");
+    ring.m_mapped = mapped;
+    ring.m_header = static_cast<Header*>(memory);
+    if (ring.m_header->magic != kMagic || ring.m_header->capacity != mapped - kHeaderBytes)
+    {
+        throw std::invalid_argument("not a shared ring");
+    }
+    ring.m_data     = static_cast<char*>(memory) + kHeaderBytes;
+    ring.m_capacity = mapped - kHeaderBytes;
+    // The consumer picks up wherever the ring currently is.
+    ring.m_position = ring.m_header->tail.load(std::memory_order_acquire);
+    return ring;
+#else
+    (void)memory_fd;
+    (void)readable_fd;
+    (void)writable_fd;
+    throw std::runtime_error("shared memory rings are only implemented on Linux");
+#endif
+}
+
+void SharedRing::Descriptors(int fds[3]) const
+{
+    fds[0] = m_memory_fd;
+    fds[1] = m_readable_fd;
+    fds[2] = m_writable_fd;
+}
+
+size_t SharedRing::MaxMessage() const
+{
+    // Anything up to half the buffer fits even when it has to skip the tail end.
+    return m_capacity ? m_capacity / 2 - sizeof(Record) : 0;
+}
+
+void* SharedRing::TryReserve(size_t size)
+{
+    if (size > MaxMessage()) throw std::invalid_argument("message larger than the shared ring allows");
+
+    const size_t   need       = RecordBytes(size);
+    const uint64_t head       = m_header->head.load(std::memory_order_relaxed);
+    const uint64_t tail       = m_header->tail.load(std::memory_order_acquire);
+    const size_t   offset     = static_cast<size_t>(head & (m_capacity - 1));
+    const size_t   contiguous = m_capacity - offset;
+    const size_t   skip       = contiguous < need ? contiguous : 0;
+    if (head + skip + need - tail > m_capacity) return nullptr;
+
+    if (skip)
+    {
+        // Not published until Commit moves the head past it.
+        reinterpret_cast<Record*>(m_data + offset)->size = kWrap;
+    }
+    m_position = head + skip;
+    m_pending  = need;
+
+    Record* record = reinterpret_cast<Record*>(m_data + (m_position & (m_capacity - 1)));
+    record->size   = static_cast<uint32_t>(size);
+    return record + 1;
+}
+
+void* SharedRing::Reserve(size_t size, int timeout_ms)
+{
+    if (void* memory = TryReserve(size)) return memory;
+    m_wanted = size;
+    if (!Wait(m_writable_fd, m_header->producer_waiting, &SharedRing::Writable, timeout_ms)) return nullptr;
+    return TryReserve(size);
+}
+
+void SharedRing::Commit(uint32_t tag)
+{
+    Record* record = reinterpret_cast<Record*>(m_data + (m_position & (m_capacity - 1)));
+    Commit(tag, record->size);
+}
+
+void SharedRing::Commit(uint32_t tag, size_t size)
+{
+    Record* record = reinterpret_cast<Record*>(m_data + (m_position & (m_capacity - 1)));
+    if (RecordBytes(size) > m_pending) throw std::invalid_argument("commit larger than the reservation");
+    record->size = static_cast<uint32_t>(size);
+    record->tag  = tag;
+    m_header->head.store(m_position + RecordBytes(size), std::memory_order_release);
+    m_pending = 0;
+    Wake(m_readable_fd, m_header->consumer_waiting);
+}
+
+bool SharedRing::TryPeek(Message& message)
+{
+    for (;;)
+    {
+        // The producer may be another, untrusted process: every field is read once and checked
+        // against what an honest producer could have written before it is used.
+        const uint64_t head      = m_header->head.load(std::memory_order_acquire);
+        const uint64_t available = head - m_position;
+        if (available == 0) return false;
+        if (available > m_capacity) throw std::runtime_error("shared ring head out of range");
+
+        const size_t                 offset = static_cast<size_t>(m_position & (m_capacity - 1));
+        const size_t                 to_end = m_capacity - offset;
+        const volatile Record* const record = reinterpret_cast<const volatile Record*>(m_data + offset);
+        const uint32_t               size   = record->size;
+        const uint32_t               tag    = record->tag;
+        if (size == kWrap)
+        {
+            if (to_end > available) throw std::runtime_error("shared ring wrap marker out of range");
+            m_position += to_end;
+            m_header->tail.store(m_position, std::memory_order_release);
+            continue;
+        }
+        if (size > MaxMessage() || RecordBytes(size) > available || RecordBytes(size) > to_end)
+        {
+            throw std::runtime_error("shared ring record out of range");
+        }
+        message.data = m_data + offset + sizeof(Record);
+        message.size = size;
+        message.tag  = tag;
+        m_pending    = RecordBytes(size);
+        return true;
+    }
+}
+
+bool SharedRing::Peek(Message& message, int timeout_ms)
+{
+    if (TryPeek(message)) return true;
+    if (!Wait(m_readable_fd, m_header->consumer_waiting, &SharedRing::Readable, timeout_ms)) return false;
+    return TryPeek(message);
+}
+
+void SharedRing::Release()
+{
+    m_position += m_pending;
+    m_pending = 0;
+    m_header->tail.store(m_position, std::memory_order_release);
+    Wake(m_writable_fd, m_header->producer_waiting);
+}
+
+bool SharedRing::Readable() { return m_header->head.load(std::memory_order_acquire) != m_position; }
+
+bool SharedRing::Writable()
+{
+    const size_t   need       = RecordBytes(m_wanted);
+    const uint64_t head       = m_header->head.load(std::memory_order_relaxed);
+    const uint64_t tail       = m_header->tail.load(std::memory_order_acquire);
+    const size_t   contiguous = m_capacity - static_cast<size_t>(head & (m_capacity - 1));
+    const size_t   skip       = contiguous < need ? contiguous : 0;
+    return head + skip + need - tail <= m_capacity;
+}
+
+// The sleeper raises its flag and re-checks before sleeping, the other side publishes and then
+// checks the flag; with a full fence on both sides one of them always sees the other.
+bool SharedRing::Wait(int fd, std::atomic<uint32_t>& waiting, bool (SharedRing::*ready)(), int timeout_ms)
+{
+#if defined(__linux__)
+    using Clock         = std::chrono::steady_clock;
+    const auto deadline = Clock::now() + std::chrono::milliseconds(timeout_ms < 0 ? 0 : timeout_ms);
+    for (;;)
+    {
+        waiting.store(1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if ((this->*ready)())
+        {
+            waiting.store(0, std::memory_order_relaxed);
+            return true;
+        }
+
+        int remaining = -1;
+        if (timeout_ms >= 0)
+        {
+            const auto left = std::chrono::duration_cast<std::chrono::milliseconds>(deadline - Clock::now());
+            remaining       = left.count() > 0 ? static_cast<int>(left.count()) : 0;
+        }
+        ++m_sleeps;
+        pollfd entry = {fd, POLLIN, 0};
+        const int polled = poll(&entry, 1, remaining);
+        waiting.store(0, std::memory_order_relaxed);
+        if (polled > 0)
+        {
+            uint64_t count = 0;
+            (void)!read(fd, &count, sizeof(count));
+        }
+        if ((this->*ready)()) return true;
+        if (polled == 0 || (polled < 0 && errno != EINTR)) return false;
+    }
+#else
+    (void)fd;
+    (void)waiting;
+    (void)ready;
+    (void)timeout_ms;
+    return false;
+#endif
+}
+
+void SharedRing::Wake(int fd, std::atomic<uint32_t>& waiting)
+{
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (!waiting.load(std::memory_order_relaxed)) return;
+#if defined(__linux__)
+    const uint64_t one = 1;
+    (void)!write(fd, &one, sizeof(one));
+#else
+    (void)fd;
+#endif
+}
+
+} // namespace gomarky
@@ -0,0 +1,103 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+namespace gomarky
+{
+
+/// Single-producer single-consumer ring of variable-sized messages in memory shared between
+/// two processes.
+///
+/// The ring lives in a memfd mapped by both sides, so a message is written once by the producer
+/// and read in place by the consumer; nothing goes through a socket or a pipe. Each direction
+/// has an eventfd the blocked side sleeps on, and it is only written when the other side has
+/// announced it is about to sleep, so a busy ring costs no system calls.
+///
+/// Messages never wrap around the end of the buffer; the largest one is MaxMessage() bytes.
+/// Only available on Linux; elsewhere Create and Attach throw std::runtime_error.
+class SharedRing
+{
+public:
+    /// One message, pointing into the shared buffer until Release.
+    struct Message
+    {
+        const void* data = nullptr;
+        size_t      size = 0;
+        uint32_t    tag  = 0;
+    };
+
+    SharedRing() = default;
+    SharedRing(SharedRing&& other) noexcept;
+    SharedRing& operator=(SharedRing&& other) noexcept;
+    SharedRing(const SharedRing&) = delete;
+    SharedRing& operator=(const SharedRing&) = delete;
+    ~SharedRing();
+
+    /// A new ring of at least `capacity` bytes (rounded up to a power of two) with its own
+    /// memfd and eventfds. All three are close-on-exec; see Descriptors.
+    static SharedRing Create(size_t capacity);
+
+    /// Map the ring another process created. Takes ownership of the descriptors.
+    static SharedRing Attach(int memory_fd, int readable_fd, int writable_fd);
+
+    /// The memfd and the eventfds signalled when the ring becomes readable and writable, in the
+    /// order Attach takes them.
+    void Descriptors(int fds[3]) const;
+
+    bool   Valid() const { return m_header != nullptr; }
+    size_t Capacity() const { return m_capacity; }
+    size_t MaxMessage() const;
+
+    // Producer side.
+
+    /// Room for a `size`-byte message, or nullptr when the consumer has not freed enough yet.
+    /// Nothing is visible to the consumer before Commit.
+    void* TryReserve(size_t size);
+
+    /// Like TryReserve, but sleeps up to `timeout_ms` (-1: forever) for room.
+    void* Reserve(size_t size, int timeout_ms);
+
+    /// Publish the message from the last reservation, optionally shrunk to `size` bytes.
+    void Commit(uint32_t tag);
+    void Commit(uint32_t tag, size_t size);
+
+    // Consumer side.
+
+    /// The oldest unreleased message, if any. Throws std::runtime_error when the producer left
+    /// the ring in a state it could not have reached by following the protocol.
+    bool TryPeek(Message& message);
+
+    /// Like TryPeek, but sleeps up to `timeout_ms` (-1: forever) for a message.
+    bool Peek(Message& message, int timeout_ms);
+
+    /// Hand the space of the peeked message back to the producer.
+    void Release();
+
+    /// How often either side had to go to sleep; a measure of how often the eventfds were used.
+    uint64_t Sleeps() const { return m_sleeps; }
+
+private:
+    struct Header;
+
+    void   Reset();
+    bool   Wait(int fd, std::atomic<uint32_t>& waiting, bool (SharedRing::*ready)(), int timeout_ms);
+    bool   Readable();
+    bool   Writable();
+    void   Wake(int fd, std::atomic<uint32_t>& waiting);
+
+    Header*  m_header      = nullptr;
+    char*    m_data        = nullptr;
+    size_t   m_capacity    = 0;
+    size_t   m_mapped      = 0;
+    int      m_memory_fd   = -1;
+    int      m_readable_fd = -1;
+    int      m_writable_fd = -1;
+    uint64_t m_position    = 0; ///< producer: start of the reservation, consumer: read position
+    size_t   m_pending     = 0; ///< bytes of the reserved or peeked record
+    size_t   m_wanted      = 0; ///< message size the producer is waiting to reserve
+    uint64_t m_sleeps      = 0;
+};
+
+} // namespace gomarky
@@ -0,0 +1,83 @@
+#include "process/worker_main.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <exception>
+#include <stdexcept>
+
+#if defined(__linux__)
+#include <signal.h>
+#include <sys/prctl.h>
+#endif
+
+namespace gomarky
+{
+
+namespace
+{
+
+void SendError(SharedRing& ring, const char* message)
+{
+    const size_t size   = std::min(std::strlen(message), ring.MaxMessage());
+    void*        memory = ring.Reserve(size, -1);
+    std::memcpy(memory, message, size);
+    ring.Commit(detail::kWorkerError);
+}
+
+} // namespace
+
+void* WorkerReply::Allocate(size_t size)
+{
+    if (m_allocated) throw std::logic_error("a worker reply can only be allocated once");
+    void* memory = m_ring.Reserve(size, -1);
+    m_allocated  = true;
+    return memory;
+}
+
+bool IsWorkerProcess() { return std::getenv(detail::kWorkerDescriptors) != nullptr; }
+
+int RunWorker(const WorkerHandler& handler)
+{
+    const char* variable = std::getenv(detail::kWorkerDescriptors);
+    int         fds[6];
+    if (!variable || std::sscanf(variable, "%d,%d,%d,%d,%d,%d", &fds[0], &fds[1], &fds[2], &fds[3], &fds[4],
+                                 &fds[5]) != 6)
+    {
+        std::fprintf(stderr, "%s is not set, this is not a worker process\n", detail::kWorkerDescriptors);
+        return 2;
+    }
+
+#if defined(__linux__)
+    // Already asked for between fork and exec; repeated in case the executable was wrapped.
+    prctl(PR_SET_PDEATHSIG, SIGKILL);
+#endif
+    SharedRing requests  = SharedRing::Attach(fds[0], fds[1], fds[2]);
+    SharedRing responses = SharedRing::Attach(fds[3], fds[4], fds[5]);
+
+    for (;;)
+    {
+        SharedRing::Message request;
+        if (!requests.Peek(request, -1)) continue;
+        if (request.tag == detail::kWorkerStop) return 0;
+
+        WorkerReply reply(responses);
+        try
+        {
+            handler(request.data, request.size, reply);
+        }
+        catch (const std::exception& error)
+        {
+            // A half-written response is dropped by reserving over it.
+            requests.Release();
+            SendError(responses, error.what());
+            continue;
+        }
+        requests.Release();
+        if (!reply.m_allocated) responses.Reserve(0, -1);
+        responses.Commit(detail::kWorkerResponse);
+    }
+}
+
+} // namespace gomarky
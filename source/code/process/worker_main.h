@@ -0,0 +1,59 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+
+#include "process/shared_ring.h"
+
+namespace gomarky
+{
+
+/// Where a worker handler writes its response: straight into the response ring.
+class WorkerReply
+{
+public:
+    explicit WorkerReply(SharedRing& ring) : m_ring(ring) {}
+
+    /// `size` bytes for the response, at most once per request. Without it the response is
+    /// empty.
+    void* Allocate(size_t size);
+
+    size_t MaxSize() const { return m_ring.MaxMessage(); }
+
+private:
+    friend int RunWorker(const std::function<void(const void*, size_t, WorkerReply&)>& handler);
+
+    SharedRing& m_ring;
+    bool        m_allocated = false;
+};
+
+/// Handles one request, read in place from shared memory.
+using WorkerHandler = std::function<void(const void* request, size_t size, WorkerReply& reply)>;
+
+/// True in a process started by WorkerProcess.
+bool IsWorkerProcess();
+
+/// Serve requests from the parent until it asks to stop; returns the exit code for main. A
+/// handler that throws fails its request and the worker carries on. The worker is killed when
+/// the parent dies.
+int RunWorker(const WorkerHandler& handler);
+
+namespace detail
+{
+
+/// Message tags on the rings between WorkerProcess and RunWorker.
+enum WorkerTag : uint32_t
+{
+    kWorkerRequest  = 1,
+    kWorkerResponse = 2,
+    kWorkerError    = 3, ///< the payload is the exception message
+    kWorkerStop     = 4,
+};
+
+/// Environment variable with the six ring descriptors a worker inherits.
+constexpr const char* kWorkerDescriptors = "GM_WORKER_FDS";
+
+} // namespace detail
+
+} // namespace gomarky
@@ -0,0 +1,334 @@
+#include "process/worker_process.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <stdexcept>
+#include <system_error>
+#include <utility>
+
+#include "process/worker_main.h"
+
+#if defined(__linux__)
+#include <fcntl.h>
+#include <signal.h>
+#include <sys/prctl.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+extern char** environ;
+#endif
+
+namespace gomarky
+{
+
+namespace
+{
+
+// How long a caller sleeps on a ring before checking whether the worker is still alive, which
+// bounds how late a crash is noticed.
+constexpr int kPollMs = 10;
+
+// A worker that lived this long is considered healthy again and restarts without backoff.
+constexpr std::chrono::seconds kStableUptime{1};
+
+} // namespace
+
+const char* ToString(WorkerStatus status)
+{
+    switch (status)
+    {
+    case WorkerStatus::Ok: return "ok";
+    case WorkerStatus::Failed: return "failed";
+    case WorkerStatus::Crashed: return "crashed";
+    case WorkerStatus::TimedOut: return "timed out";
+    case WorkerStatus::Unavailable: return "unavailable";
+    }
+    return "?";
+}
+
+WorkerProcess::WorkerProcess(Options options) : m_options(std::move(options))
+{
+    if (m_options.command.empty()) throw std::invalid_argument("a worker process needs a command");
+    std::lock_guard<std::mutex> lock(m_mutex);
+    Spawn();
+    m_max_message = m_requests.MaxMessage();
+}
+
+WorkerProcess::~WorkerProcess()
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    Stop();
+}
+
+WorkerStatus WorkerProcess::Call(size_t size, const Writer& write, const Reader& read)
+{
+    if (size > m_max_message) throw std::invalid_argument("worker request larger than its ring allows");
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (!EnsureRunning()) return WorkerStatus::Unavailable;
+
+    const Clock::time_point deadline = Clock::now() + m_options.timeout;
+    WorkerStatus            status   = WorkerStatus::Ok;
+
+    void* request = nullptr;
+    while (!(request = m_requests.Reserve(size, kPollMs)))
+    {
+        if (!KeepWaiting(deadline, status)) return status;
+    }
+    write(request);
+    m_requests.Commit(detail::kWorkerRequest);
+
+    SharedRing::Message response;
+    try
+    {
+        while (!m_responses.Peek(response, kPollMs))
+        {
+            if (!KeepWaiting(deadline, status)) return status;
+        }
+    }
+    catch (const std::runtime_error& error)
+    {
+        // A worker that scribbles over its ring is as broken as one that crashed.
+        Kill();
+        m_last_error = std::string("worker corrupted its response ring: ") + error.what();
+        MarkDown();
+        return WorkerStatus::Crashed;
+    }
+
+    struct ReleaseOnExit
+    {
+        SharedRing& ring;
+        ~ReleaseOnExit() { ring.Release(); }
+    } release{m_responses};
+
+    if (response.tag == detail::kWorkerError)
+    {
+        m_last_error.assign(static_cast<const char*>(response.data), response.size);
+        return WorkerStatus::Failed;
+    }
+    read(response.data, response.size);
+    return WorkerStatus::Ok;
+}
+
+void WorkerProcess::Supervise()
+{
+    std::unique_lock<std::mutex> lock(m_mutex, std::try_to_lock);
+    if (!lock.owns_lock()) return;
+    if (m_pid > 0 && !Alive()) MarkDown();
+    if (m_pid <= 0) EnsureRunning();
+}
+
+int WorkerProcess::Pid() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_pid;
+}
+
+std::string WorkerProcess::LastError() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_last_error;
+}
+
+bool WorkerProcess::EnsureRunning()
+{
+    if (m_pid > 0) return true;
+    if (Clock::now() < m_restart_at) return false;
+    try
+    {
+        Spawn();
+    }
+    catch (const std::system_error& error)
+    {
+        // Out of processes or descriptors: back off as if it had crashed.
+        m_last_error = error.what();
+        m_started    = Clock::now();
+        MarkDown();
+        return false;
+    }
+    m_restarts.fetch_add(1, std::memory_order_relaxed);
+    return true;
+}
+
+void WorkerProcess::Spawn()
+{
+#if defined(__linux__)
+    SharedRing requests  = SharedRing::Create(m_options.ring_bytes);
+    SharedRing responses = SharedRing::Create(m_options.ring_bytes);
+    int        fds[6];
+    requests.Descriptors(fds);
+    responses.Descriptors(fds + 3);
+
+    // Everything the child needs is prepared before fork, after it only async-signal-safe calls
+    // are allowed.
+    char variable[128];
+    std::snprintf(variable, sizeof(variable), "%s=%d,%d,%d,%d,%d,%d", detail::kWorkerDescriptors, fds[0], fds[1],
+                  fds[2], fds[3], fds[4], fds[5]);
+    const size_t prefix = std::strlen(detail::kWorkerDescriptors) + 1;
+
+    std::vector<char*> argv;
+    for (const auto& argument : m_options.command) argv.push_back(const_cast<char*>(argument.c_str()));
+    argv.push_back(nullptr);
+    std::vector<char*> envp;
+    for (char** entry = environ; *entry; ++entry)
+    {
+        if (std::strncmp(*entry, variable, prefix) != 0) envp.push_back(*entry);
+    }
+    envp.push_back(variable);
+    envp.push_back(nullptr);
+
+    const pid_t parent = getpid();
+    const pid_t pid    = fork();
+    if (pid < 0) throw std::system_error(errno, std::generic_category(), "fork");
+    if (pid == 0)
+    {
+        // Never outlive the application, even when it is killed.
+        prctl(PR_SET_PDEATHSIG, SIGKILL);
+        if (getppid() != parent) _exit(1);
+        for (int fd : fds) fcntl(fd, F_SETFD, 0);
+        execve(argv[0], argv.data(), envp.data());
+        _exit(127);
+    }
+
+    m_requests  = std::move(requests);
+    m_responses = std::move(responses);
+    m_pid       = pid;
+    m_started   = Clock::now();
+#else
+    throw std::runtime_error("worker processes are only implemented on Linux");
+#endif
+}
+
+bool WorkerProcess::Alive()
+{
+    if (m_pid <= 0) return false;
+#if defined(__linux__)
+    int         status = 0;
+    const pid_t result = waitpid(m_pid, &status, WNOHANG);
+    if (result == 0) return true;
+
+    char text[96];
+    if (result == m_pid && WIFSIGNALED(status))
+    {
+        std::snprintf(text, sizeof(text), "worker %d killed by signal %d (%s)", m_pid, WTERMSIG(status),
+                      strsignal(WTERMSIG(status)));
+    }
+    else if (result == m_pid)
+    {
+        std::snprintf(text, sizeof(text), "worker %d exited with code %d", m_pid, WEXITSTATUS(status));
+    }
+    else
+    {
+        std::snprintf(text, sizeof(text), "worker %d vanished", m_pid);
+    }
+    m_last_error = text;
+#endif
+    m_pid = -1;
+    return false;
+}
+
+bool WorkerProcess::KeepWaiting(Clock::time_point deadline, WorkerStatus& status)
+{
+    if (!Alive())
+    {
+        MarkDown();
+        status = WorkerStatus::Crashed;
+        return false;
+    }
+    if (Clock::now() >= deadline)
+    {
+        Kill();
+        m_last_error = "worker did not respond in time";
+        MarkDown();
+        status = WorkerStatus::TimedOut;
+        return false;
+    }
+    return true;
+}
+
+void WorkerProcess::MarkDown()
+{
+    const Clock::time_point now = Clock::now();
+    m_consecutive_crashes       = now - m_started < kStableUptime ? m_consecutive_crashes + 1 : 0;
+
+    auto delay = m_options.restart_delay * (1 << std::min(m_consecutive_crashes, 16));
+    if (delay > m_options.max_restart_delay) delay = m_options.max_restart_delay;
+    m_restart_at = now + delay;
+
+    // Whatever the worker left in the rings is lost with it; the restart gets fresh ones.
+    m_requests  = SharedRing();
+    m_responses = SharedRing();
+    m_crashes.fetch_add(1, std::memory_order_relaxed);
+}
+
+void WorkerProcess::Kill()
+{
+    if (m_pid <= 0) return;
+#if defined(__linux__)
+    kill(m_pid, SIGKILL);
+    waitpid(m_pid, nullptr, 0);
+#endif
+    m_pid = -1;
+}
+
+void WorkerProcess::Stop()
+{
+    if (m_pid <= 0) return;
+    if (m_requests.TryReserve(0)) m_requests.Commit(detail::kWorkerStop);
+    for (int i = 0; i < 100 && Alive(); ++i) std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    Kill();
+}
+
+WorkerSupervisor::WorkerSupervisor(const WorkerProcess::Options& options, size_t workers,
+                                   std::chrono::milliseconds interval)
+{
+    if (workers == 0) throw std::invalid_argument("a worker supervisor needs at least one worker");
+    for (size_t i = 0; i < workers; ++i) m_workers.emplace_back(new WorkerProcess(options));
+    m_thread = std::thread([this, interval] { Loop(interval); });
+}
+
+WorkerSupervisor::~WorkerSupervisor()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stopping = true;
+    }
+    m_wake.notify_all();
+    m_thread.join();
+}
+
+WorkerStatus WorkerSupervisor::Call(size_t size, const WorkerProcess::Writer& write,
+                                    const WorkerProcess::Reader& read)
+{
+    const size_t index = m_next.fetch_add(1, std::memory_order_relaxed) % m_workers.size();
+    return m_workers[index]->Call(size, write, read);
+}
+
+uint64_t WorkerSupervisor::Crashes() const
+{
+    uint64_t total = 0;
+    for (const auto& worker : m_workers) total += worker->Crashes();
+    return total;
+}
+
+uint64_t WorkerSupervisor::Restarts() const
+{
+    uint64_t total = 0;
+    for (const auto& worker : m_workers) total += worker->Restarts();
+    return total;
+}
+
+void WorkerSupervisor::Loop(std::chrono::milliseconds interval)
+{
+    std::unique_lock<std::mutex> lock(m_mutex);
+    while (!m_stopping)
+    {
+        lock.unlock();
+        for (const auto& worker : m_workers) worker->Supervise();
+        lock.lock();
+        m_wake.wait_for(lock, interval, [this] { return m_stopping; });
+    }
+}
+
+} // namespace gomarky
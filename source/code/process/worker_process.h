@@ -0,0 +1,134 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "process/shared_ring.h"
+
+namespace gomarky
+{
+
+enum class WorkerStatus
+{
+    Ok,
+    Failed,      ///< the handler threw; see WorkerProcess::LastError
+    Crashed,     ///< the worker died while handling the request
+    TimedOut,    ///< no response in time, the worker was killed
+    Unavailable, ///< the worker is down and waiting to be restarted
+};
+
+const char* ToString(WorkerStatus status);
+
+/// A child process running requests for this one, so that a crash in the code it runs cannot
+/// take the application down with it.
+///
+/// The child is `command` executed with two SharedRings, one per direction; requests are
+/// written straight into shared memory by the caller and responses read from it in place. The
+/// executable has to call RunWorker (process/worker_main.h).
+///
+/// When the child dies it is restarted after `restart_delay`, doubled for every crash that
+/// follows a restart within a second, up to `max_restart_delay`. Requests in flight fail with
+/// Crashed and later ones with Unavailable until then. Linux only; elsewhere the constructor
+/// throws std::runtime_error.
+class WorkerProcess
+{
+public:
+    struct Options
+    {
+        std::vector<std::string>  command; ///< absolute path of the executable, then its arguments
+        size_t                    ring_bytes = size_t(8) << 20;
+        std::chrono::milliseconds timeout{30000};
+        std::chrono::milliseconds restart_delay{50};
+        std::chrono::milliseconds max_restart_delay{5000};
+    };
+
+    /// Fills the request in place; it gets exactly the size passed to Call.
+    using Writer = std::function<void(void* request)>;
+    /// Reads the response in place; the memory is only valid during the call.
+    using Reader = std::function<void(const void* response, size_t size)>;
+
+    explicit WorkerProcess(Options options);
+    WorkerProcess(const WorkerProcess&) = delete;
+    WorkerProcess& operator=(const WorkerProcess&) = delete;
+
+    /// Asks the worker to exit and kills it if it has not within a second.
+    ~WorkerProcess();
+
+    /// Run one request. Callers are served one at a time.
+    WorkerStatus Call(size_t size, const Writer& write, const Reader& read);
+
+    /// Notice a worker that died while idle and restart it once its delay has passed. Does
+    /// nothing if a call is in progress.
+    void Supervise();
+
+    /// Largest request or response.
+    size_t MaxMessage() const { return m_max_message; }
+
+    int         Pid() const;
+    uint64_t    Crashes() const { return m_crashes.load(std::memory_order_relaxed); }
+    uint64_t    Restarts() const { return m_restarts.load(std::memory_order_relaxed); }
+    std::string LastError() const;
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    bool EnsureRunning();
+    void Spawn();
+    bool Alive();
+    bool KeepWaiting(Clock::time_point deadline, WorkerStatus& status);
+    void MarkDown();
+    void Kill();
+    void Stop();
+
+    const Options         m_options;
+    size_t                m_max_message = 0;
+    mutable std::mutex    m_mutex;
+    SharedRing            m_requests;
+    SharedRing            m_responses;
+    int                   m_pid = -1;
+    Clock::time_point     m_started;
+    Clock::time_point     m_restart_at;
+    int                   m_consecutive_crashes = 0;
+    std::string           m_last_error;
+    std::atomic<uint64_t> m_crashes{0};
+    std::atomic<uint64_t> m_restarts{0};
+};
+
+/// A fixed set of WorkerProcesses with a thread that restarts the ones that died while idle,
+/// so that a crash is repaired before the next request rather than by it.
+class WorkerSupervisor
+{
+public:
+    WorkerSupervisor(const WorkerProcess::Options& options, size_t workers,
+                     std::chrono::milliseconds interval = std::chrono::milliseconds(20));
+    ~WorkerSupervisor();
+
+    /// Run one request on the next worker in turn.
+    WorkerStatus Call(size_t size, const WorkerProcess::Writer& write, const WorkerProcess::Reader& read);
+
+    size_t         Size() const { return m_workers.size(); }
+    WorkerProcess& Worker(size_t index) { return *m_workers[index]; }
+    uint64_t       Crashes() const;
+    uint64_t       Restarts() const;
+
+private:
+    void Loop(std::chrono::milliseconds interval);
+
+    std::vector<std::unique_ptr<WorkerProcess>> m_workers;
+    std::atomic<size_t>                         m_next{0};
+    std::mutex                                  m_mutex;
+    std::condition_variable                     m_wake;
+    bool                                        m_stopping = false;
+    std::thread                                 m_thread;
+};
+
+} // namespace gomarky
@@ -0,0 +1,34 @@
+#include "reactive/qt_reactive.h"
+
+#include <QCoreApplication>
+#include <QtGlobal>
+
+namespace gomarky
+{
+
+void FlushOnEventLoop(ReactiveContext& context)
+{
+    context.SetScheduler([&context] {
+        QMetaObject::invokeMethod(QCoreApplication::instance(),
+                                  [&context] {
+                                      // An exception cannot go through the event loop.
+                                      if (!context.TryFlush())
+                                      {
+                                          qWarning("Reactive effects did not settle and were dropped; they keep "
+                                                   "changing their own inputs");
+                                      }
+                                  },
+                                  Qt::QueuedConnection);
+    });
+}
+
+RepaintBinding::RepaintBinding(QWidget* widget, ReactiveContext& context)
+    : m_widget(widget), m_observer(
+                            [this] {
+                                if (m_widget) m_widget->update();
+                            },
+                            context)
+{
+}
+
+} // namespace gomarky
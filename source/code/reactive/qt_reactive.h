@@ -0,0 +1,36 @@
+#pragma once
+
+#include <utility>
+
+#include <QPointer>
+#include <QWidget>
+
+#include "reactive/reactive.h"
+
+namespace gomarky
+{
+
+/// Batch a context's changes per event-loop turn: the first change posts one Flush() to the
+/// event loop, and everything set until it runs propagates together. Effects that never settle
+/// are dropped with a warning rather than throwing into the event loop.
+void FlushOnEventLoop(ReactiveContext& context = ReactiveContext::Default());
+
+/// Repaints a widget when a value read by its last paint changed. Call Paint() from paintEvent;
+/// computed values it reads are only evaluated when the widget actually paints.
+class RepaintBinding
+{
+public:
+    explicit RepaintBinding(QWidget* widget, ReactiveContext& context = ReactiveContext::Default());
+
+    template<typename F>
+    void Paint(F&& paint)
+    {
+        m_observer.Track(std::forward<F>(paint));
+    }
+
+private:
+    QPointer<QWidget> m_widget;
+    Observer          m_observer;
+};
+
+} // namespace gomarky
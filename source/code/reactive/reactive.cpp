@@ -0,0 +1,207 @@
+#include "reactive/reactive.h"
+
+#include <algorithm>
+#include <stdexcept>
+
+namespace gomarky
+{
+
+namespace
+{
+
+// Effects writing to values they depend on could otherwise keep each other running forever.
+constexpr int kMaxFlushRounds = 100;
+
+void EraseOne(std::vector<ReactiveNode*>& nodes, ReactiveNode* node)
+{
+    auto it = std::find(nodes.begin(), nodes.end(), node);
+    if (it == nodes.end()) return;
+    *it = nodes.back();
+    nodes.pop_back();
+}
+
+} // namespace
+
+ReactiveContext& ReactiveContext::Default()
+{
+    static ReactiveContext context;
+    return context;
+}
+
+ReactiveContext::Batch::Batch(ReactiveContext& context) : m_context(context) { ++m_context.m_batch_depth; }
+
+ReactiveContext::Batch::~Batch()
+{
+    if (--m_context.m_batch_depth == 0 && !m_context.m_pending.empty()) m_context.RequestFlush();
+}
+
+void ReactiveContext::Schedule(ReactiveNode* node)
+{
+    if (node->m_scheduled) return;
+    node->m_scheduled = true;
+    m_pending.push_back(node);
+}
+
+void ReactiveContext::Unschedule(ReactiveNode* node)
+{
+    if (!node->m_scheduled) return;
+    node->m_scheduled = false;
+    m_pending.erase(std::remove(m_pending.begin(), m_pending.end(), node), m_pending.end());
+}
+
+void ReactiveContext::RequestFlush()
+{
+    if (m_batch_depth > 0 || m_flushing || m_pending.empty()) return;
+    if (!m_scheduler)
+    {
+        Flush();
+        return;
+    }
+    if (m_flush_requested) return;
+    m_flush_requested = true;
+    m_scheduler();
+}
+
+void ReactiveContext::Flush()
+{
+    if (!Settle()) throw std::runtime_error("reactive effects did not settle, they keep changing their own inputs");
+}
+
+bool ReactiveContext::TryFlush()
+{
+    if (Settle()) return true;
+    // Left Clean, the dropped sinks are scheduled again by the next change of what they read.
+    for (ReactiveNode* node : m_pending)
+    {
+        node->m_scheduled = false;
+        node->m_state     = ReactiveNode::State::Clean;
+    }
+    m_pending.clear();
+    return false;
+}
+
+bool ReactiveContext::Settle()
+{
+    m_flush_requested = false;
+    if (m_flushing) return true;
+    m_flushing = true;
+
+    struct Reset
+    {
+        bool& flag;
+        ~Reset() { flag = false; }
+    } reset{m_flushing};
+
+    for (int round = 0; !m_pending.empty(); ++round)
+    {
+        if (round == kMaxFlushRounds) return false;
+        // Lowest first: by the time a sink runs, everything below it has settled.
+        std::vector<ReactiveNode*> pending;
+        pending.swap(m_pending);
+        std::stable_sort(pending.begin(), pending.end(),
+                         [](const ReactiveNode* a, const ReactiveNode* b) { return a->m_height < b->m_height; });
+        for (size_t i = 0; i < pending.size(); ++i)
+        {
+            ReactiveNode* node = pending[i];
+            // A sink destroyed by an earlier one in this round removed itself from m_pending only.
+            if (!node->m_scheduled) continue;
+            node->m_scheduled = false;
+            node->OnFlush();
+        }
+    }
+    return true;
+}
+
+ReactiveNode::ReactiveNode(ReactiveContext& context, State state) : m_context(context), m_state(state) {}
+
+ReactiveNode::~ReactiveNode()
+{
+    m_context.Unschedule(this);
+    UnlinkSources();
+    for (ReactiveNode* observer : m_observers) EraseOne(observer->m_sources, this);
+}
+
+ReactiveNode::Tracking::Tracking(ReactiveNode& node) : m_node(node), m_previous(node.m_context.m_tracking)
+{
+    m_node.UnlinkSources();
+    m_node.m_context.m_tracking = &m_node;
+}
+
+ReactiveNode::Tracking::~Tracking()
+{
+    m_node.m_context.m_tracking = m_previous;
+    uint32_t height             = 0;
+    for (const ReactiveNode* source : m_node.m_sources) height = std::max(height, source->m_height + 1);
+    m_node.m_height = height;
+}
+
+void ReactiveNode::UnlinkSources()
+{
+    for (ReactiveNode* source : m_sources) EraseOne(source->m_observers, this);
+    m_sources.clear();
+}
+
+void ReactiveNode::TrackRead()
+{
+    ReactiveNode* reader = m_context.m_tracking;
+    if (!reader || reader == this) return;
+    if (std::find(reader->m_sources.begin(), reader->m_sources.end(), this) != reader->m_sources.end()) return;
+    reader->m_sources.push_back(this);
+    m_observers.push_back(reader);
+}
+
+void ReactiveNode::UpdateIfNecessary()
+{
+    if (m_state == State::Check)
+    {
+        // Sources that really changed mark this node Dirty while they update.
+        for (size_t i = 0; i < m_sources.size() && m_state == State::Check; ++i) m_sources[i]->UpdateIfNecessary();
+        if (m_state == State::Check) m_state = State::Clean;
+    }
+    if (m_state == State::Dirty)
+    {
+        m_state = State::Clean;
+        Recompute();
+    }
+}
+
+void ReactiveNode::NotifyChanged()
+{
+    for (ReactiveNode* observer : m_observers) observer->Mark(State::Dirty);
+    m_context.RequestFlush();
+}
+
+void ReactiveNode::Mark(State state)
+{
+    const bool was_clean = m_state == State::Clean;
+    if (state > m_state) m_state = state;
+    if (was_clean && IsSink()) m_context.Schedule(this);
+    // Observers still clean need to hear about it even when this node was already stale:
+    // an Observer does not pull, so stale nodes can sit below a clean one.
+    for (ReactiveNode* observer : m_observers)
+    {
+        if (observer->m_state == State::Clean) observer->Mark(State::Check);
+    }
+}
+
+Effect::Effect(std::function<void()> run, ReactiveContext& context)
+    : ReactiveNode(context, State::Dirty), m_run(std::move(run))
+{
+    UpdateIfNecessary();
+}
+
+void Effect::Recompute() { Evaluate(m_run); }
+
+Observer::Observer(std::function<void()> invalidated, ReactiveContext& context)
+    : ReactiveNode(context, State::Clean), m_invalidated(std::move(invalidated))
+{
+}
+
+void Observer::OnFlush()
+{
+    if (m_state == State::Clean) return;
+    m_state = State::Clean;
+    m_invalidated();
+}
+
+} // namespace gomarky
@@ -0,0 +1,254 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <utility>
+#include <vector>
+
+namespace gomarky
+{
+
+class ReactiveNode;
+
+/// Owns the propagation state shared by a set of reactive values.
+///
+/// Property::Set only marks what depends on it as stale; nothing is recomputed at that point.
+/// Computed values are recomputed when read, at most once per change. Effects and observers are
+/// queued and run together on Flush(), lowest in the dependency graph first, so a diamond
+/// A -> (B, C) -> D makes D run once. Without a scheduler, Flush() happens at the end of the
+/// outermost Batch, or right after a Set() outside of one. With a scheduler (for example one
+/// posting to the Qt event loop) every change until the scheduled Flush() is batched together.
+/// Not thread-safe: all values of a context belong to one thread.
+class ReactiveContext
+{
+public:
+    using Scheduler = std::function<void()>;
+
+    ReactiveContext() = default;
+    ReactiveContext(const ReactiveContext&) = delete;
+    ReactiveContext& operator=(const ReactiveContext&) = delete;
+
+    /// Context used by reactive values that are not given one.
+    static ReactiveContext& Default();
+
+    /// `schedule` is called once when a flush becomes necessary; it must call Flush() later.
+    void SetScheduler(Scheduler schedule) { m_scheduler = std::move(schedule); }
+
+    /// Run the effects and observers whose dependencies changed. Throws std::runtime_error when
+    /// effects keep changing their own inputs and never settle.
+    void Flush();
+
+    /// Flush() for callers that cannot let an exception through, like the event loop: effects
+    /// that never settle are dropped until their inputs change again, and false is returned.
+    bool TryFlush();
+
+    /// Defers the flush until the outermost Batch ends.
+    class Batch
+    {
+    public:
+        explicit Batch(ReactiveContext& context = ReactiveContext::Default());
+        ~Batch();
+
+        Batch(const Batch&) = delete;
+        Batch& operator=(const Batch&) = delete;
+
+    private:
+        ReactiveContext& m_context;
+    };
+
+    /// Computed and effect evaluations so far, to check that work is not repeated.
+    uint64_t Evaluations() const { return m_evaluations; }
+
+private:
+    friend class ReactiveNode;
+
+    void Schedule(ReactiveNode* node);
+    void Unschedule(ReactiveNode* node);
+    void RequestFlush();
+    /// Flush() without the throw; false when pending sinks remain after the last round.
+    bool Settle();
+
+    Scheduler                  m_scheduler;
+    ReactiveNode*              m_tracking = nullptr; ///< node whose evaluation is recording reads
+    std::vector<ReactiveNode*> m_pending;
+    int                        m_batch_depth     = 0;
+    bool                       m_flush_requested = false;
+    bool                       m_flushing        = false;
+    uint64_t                   m_evaluations     = 0;
+};
+
+/// Vertex of the dependency graph. Edges are recorded while a node evaluates: every value it
+/// reads becomes a source, and the sources are recorded again on each evaluation.
+class ReactiveNode
+{
+public:
+    ReactiveNode(const ReactiveNode&) = delete;
+    ReactiveNode& operator=(const ReactiveNode&) = delete;
+
+    /// 0 for properties, otherwise one more than the highest source.
+    uint32_t Height() const { return m_height; }
+
+protected:
+    enum class State
+    {
+        Clean,
+        Check, ///< a transitive source changed, a direct one may have
+        Dirty, ///< a direct source changed
+    };
+
+    explicit ReactiveNode(ReactiveContext& context, State state);
+    virtual ~ReactiveNode();
+
+    /// Make the node being evaluated depend on this one.
+    void TrackRead();
+
+    /// Bring the node up to date, evaluating its sources first where needed.
+    void UpdateIfNecessary();
+
+    /// Mark dependents after this node's value changed.
+    void NotifyChanged();
+
+    /// Run `fn` with this node recording its reads as its new sources.
+    template<typename F>
+    void Evaluate(F&& fn)
+    {
+        Tracking tracking(*this);
+        ++m_context.m_evaluations;
+        fn();
+    }
+
+    /// Recompute the value; called when Dirty.
+    virtual void Recompute() {}
+
+    /// Effects and observers are queued for the next flush when they become stale.
+    virtual bool IsSink() const { return false; }
+
+    /// Called by Flush() for queued sinks.
+    virtual void OnFlush() { UpdateIfNecessary(); }
+
+    ReactiveContext& m_context;
+    State            m_state;
+
+private:
+    friend class ReactiveContext;
+
+    class Tracking
+    {
+    public:
+        explicit Tracking(ReactiveNode& node);
+        ~Tracking();
+
+    private:
+        ReactiveNode& m_node;
+        ReactiveNode* m_previous;
+    };
+
+    void Mark(State state);
+    void UnlinkSources();
+
+    std::vector<ReactiveNode*> m_sources;
+    std::vector<ReactiveNode*> m_observers;
+    uint32_t                   m_height    = 0;
+    bool                       m_scheduled = false;
+};
+
+/// Writable value.
+template<typename T>
+class Property : public ReactiveNode
+{
+public:
+    explicit Property(T value = T(), ReactiveContext& context = ReactiveContext::Default())
+        : ReactiveNode(context, State::Clean), m_value(std::move(value))
+    {
+    }
+
+    const T& Get()
+    {
+        TrackRead();
+        return m_value;
+    }
+
+    /// Assigning an equal value is not a change.
+    void Set(T value)
+    {
+        if (value == m_value) return;
+        m_value = std::move(value);
+        NotifyChanged();
+    }
+
+private:
+    T m_value;
+};
+
+/// Value derived from other reactive values, recomputed lazily when read after they changed.
+/// A recomputation producing an equal value does not propagate any further.
+template<typename T>
+class Computed : public ReactiveNode
+{
+public:
+    explicit Computed(std::function<T()> compute, ReactiveContext& context = ReactiveContext::Default())
+        : ReactiveNode(context, State::Dirty), m_compute(std::move(compute))
+    {
+    }
+
+    const T& Get()
+    {
+        // Update before linking to the reader: a first evaluation must not mark the reader stale.
+        UpdateIfNecessary();
+        TrackRead();
+        return m_value;
+    }
+
+private:
+    void Recompute() override
+    {
+        T value;
+        Evaluate([&] { value = m_compute(); });
+        if (m_has_value && value == m_value) return;
+        m_value     = std::move(value);
+        m_has_value = true;
+        NotifyChanged();
+    }
+
+    std::function<T()> m_compute;
+    T                  m_value     = T();
+    bool               m_has_value = false;
+};
+
+/// Side effect that runs now, then again in every flush after something it read changed.
+class Effect : public ReactiveNode
+{
+public:
+    explicit Effect(std::function<void()> run, ReactiveContext& context = ReactiveContext::Default());
+
+private:
+    void Recompute() override;
+    bool IsSink() const override { return true; }
+
+    std::function<void()> m_run;
+};
+
+/// Gets told, once per flush, that something read by its last Track() may have changed, without
+/// anything being recomputed. Suits consumers that re-read lazily, like a widget repainting.
+class Observer : public ReactiveNode
+{
+public:
+    explicit Observer(std::function<void()> invalidated, ReactiveContext& context = ReactiveContext::Default());
+
+    /// Run `fn` and record what it reads as what this observer watches.
+    template<typename F>
+    void Track(F&& fn)
+    {
+        Evaluate(std::forward<F>(fn));
+        m_state = State::Clean;
+    }
+
+private:
+    bool IsSink() const override { return true; }
+    void OnFlush() override;
+
+    std::function<void()> m_invalidated;
+};
+
+} // namespace gomarky
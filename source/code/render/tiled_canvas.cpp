@@ -0,0 +1,118 @@
+#include "render/tiled_canvas.h"
+
+#include <algorithm>
+
+#include <QPainter>
+
+#include "concurrency/worker_pool.h"
+
+namespace gomarky
+{
+
+TiledCanvas::TiledCanvas(QSize size, int tile_size) : m_tile_size(std::max(16, tile_size))
+{
+    Resize(size);
+}
+
+void TiledCanvas::Resize(QSize size)
+{
+    const QSize old_size    = m_size;
+    const int   old_columns = m_columns;
+    const int   old_rows    = m_rows;
+
+    m_size    = size.expandedTo(QSize(0, 0));
+    m_columns = (m_size.width() + m_tile_size - 1) / m_tile_size;
+    m_rows    = (m_size.height() + m_tile_size - 1) / m_tile_size;
+    if (m_size == old_size) return;
+
+    std::vector<Tile> tiles(static_cast<size_t>(m_columns * m_rows));
+    for (int row = 0; row < m_rows; ++row)
+    {
+        for (int column = 0; column < m_columns; ++column)
+        {
+            Tile& tile = tiles[static_cast<size_t>(row * m_columns + column)];
+            tile.rect  = QRect(column * m_tile_size, row * m_tile_size, m_tile_size, m_tile_size)
+                            .intersected(QRect(QPoint(0, 0), m_size));
+
+            // A tile covering the same pixels as before keeps them; new tiles and edge tiles that
+            // grew or shrank are painted again.
+            if (row >= old_rows || column >= old_columns) continue;
+            Tile& old = m_tiles[static_cast<size_t>(row * old_columns + column)];
+            if (old.rect == tile.rect) tile = std::move(old);
+        }
+    }
+    m_tiles = std::move(tiles);
+}
+
+void TiledCanvas::SetPaintFunction(PaintFunction paint)
+{
+    m_paint = std::move(paint);
+    InvalidateAll();
+}
+
+void TiledCanvas::Invalidate(const QRect& rect)
+{
+    const QRect clipped = rect.intersected(QRect(QPoint(0, 0), m_size));
+    if (clipped.isEmpty()) return;
+    for (int row = clipped.top() / m_tile_size; row <= clipped.bottom() / m_tile_size; ++row)
+    {
+        for (int column = clipped.left() / m_tile_size; column <= clipped.right() / m_tile_size; ++column)
+        {
+            m_tiles[static_cast<size_t>(row * m_columns + column)].dirty = true;
+        }
+    }
+}
+
+void TiledCanvas::InvalidateAll()
+{
+    for (auto& tile : m_tiles) tile.dirty = true;
+}
+
+size_t TiledCanvas::DirtyTileCount() const
+{
+    return static_cast<size_t>(std::count_if(m_tiles.begin(), m_tiles.end(), [](const Tile& tile) { return tile.dirty; }));
+}
+
+void TiledCanvas::RenderTile(Tile& tile) const
+{
+    if (tile.image.size() != tile.rect.size())
+    {
+        tile.image = QImage(tile.rect.size(), QImage::Format_ARGB32_Premultiplied);
+    }
+    tile.image.fill(Qt::transparent);
+
+    QPainter painter(&tile.image);
+    painter.translate(-tile.rect.topLeft());
+    painter.setClipRect(tile.rect);
+    if (m_paint) m_paint(painter, tile.rect);
+    tile.dirty = false;
+}
+
+size_t TiledCanvas::Render(WorkerPool& pool)
+{
+    std::vector<Tile*> dirty;
+    for (auto& tile : m_tiles)
+    {
+        if (tile.dirty) dirty.push_back(&tile);
+    }
+    pool.ParallelFor(dirty.size(), 1, [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; ++i) RenderTile(*dirty[i]);
+    });
+    return dirty.size();
+}
+
+void TiledCanvas::Composite(QPainter& painter, const QRect& exposed) const
+{
+    const QRect clipped = exposed.intersected(QRect(QPoint(0, 0), m_size));
+    if (clipped.isEmpty()) return;
+    for (int row = clipped.top() / m_tile_size; row <= clipped.bottom() / m_tile_size; ++row)
+    {
+        for (int column = clipped.left() / m_tile_size; column <= clipped.right() / m_tile_size; ++column)
+        {
+            const Tile& tile = m_tiles[static_cast<size_t>(row * m_columns + column)];
+            painter.drawImage(tile.rect.topLeft(), tile.image);
+        }
+    }
+}
+
+} // namespace gomarky
@@ -0,0 +1,70 @@
+#pragma once
+
+#include <cstddef>
+#include <functional>
+#include <vector>
+
+#include <QImage>
+#include <QRect>
+#include <QSize>
+
+class QPainter;
+
+namespace gomarky
+{
+
+class WorkerPool;
+
+/// Software render surface split into fixed-size tiles.
+///
+/// Each tile owns its QImage and is painted by its own QPainter, so dirty tiles can be rendered
+/// concurrently on a WorkerPool. Tiles that were not invalidated keep their pixels between frames
+/// and are only blitted by Composite(). The default 128 px tile is 64 KiB of ARGB32, which keeps a
+/// tile in L2 while it is being painted.
+class TiledCanvas
+{
+public:
+    /// Paints the part of the canvas inside `clip`, in canvas coordinates.
+    /// Called from several worker threads at once, so it must only read shared state.
+    using PaintFunction = std::function<void(QPainter& painter, const QRect& clip)>;
+
+    explicit TiledCanvas(QSize size = QSize(), int tile_size = 128);
+
+    /// Tiles that cover the same pixels at the new size keep them; only new tiles and partial
+    /// edge tiles become dirty. Call InvalidateAll() as well when the scene depends on the size.
+    void  Resize(QSize size);
+    QSize Size() const { return m_size; }
+    int   TileSize() const { return m_tile_size; }
+    void  SetPaintFunction(PaintFunction paint);
+
+    void Invalidate(const QRect& rect);
+    void InvalidateAll();
+
+    /// Render every dirty tile on `pool` and wait for them. Returns the number of tiles rendered.
+    size_t Render(WorkerPool& pool);
+
+    /// Draw the tiles intersecting `exposed` (canvas coordinates) with `painter`. GUI thread only.
+    void Composite(QPainter& painter, const QRect& exposed) const;
+
+    size_t TileCount() const { return m_tiles.size(); }
+    size_t DirtyTileCount() const;
+
+private:
+    struct Tile
+    {
+        QRect  rect;
+        QImage image;
+        bool   dirty = true;
+    };
+
+    void RenderTile(Tile& tile) const;
+
+    QSize             m_size;
+    int               m_tile_size;
+    int               m_columns = 0;
+    int               m_rows    = 0;
+    std::vector<Tile> m_tiles;
+    PaintFunction     m_paint;
+};
+
+} // namespace gomarky
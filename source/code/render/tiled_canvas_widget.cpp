@@ -0,0 +1,46 @@
+#include "render/tiled_canvas_widget.h"
+
+#include <QPaintEvent>
+#include <QPainter>
+#include <QResizeEvent>
+
+#include "concurrency/worker_pool.h"
+
+namespace gomarky
+{
+
+TiledCanvasWidget::TiledCanvasWidget(QWidget* parent) : TiledCanvasWidget(WorkerPool::Global(), parent) {}
+
+TiledCanvasWidget::TiledCanvasWidget(WorkerPool& pool, QWidget* parent) : QWidget(parent), m_pool(pool)
+{
+    setAttribute(Qt::WA_OpaquePaintEvent);
+}
+
+void TiledCanvasWidget::SetPaintFunction(TiledCanvas::PaintFunction paint)
+{
+    m_canvas.SetPaintFunction(std::move(paint));
+    update();
+}
+
+void TiledCanvasWidget::InvalidateCanvas(const QRect& rect)
+{
+    m_canvas.Invalidate(rect);
+    update(rect);
+}
+
+void TiledCanvasWidget::paintEvent(QPaintEvent* event)
+{
+    m_canvas.Render(m_pool);
+
+    QPainter painter(this);
+    painter.fillRect(event->rect(), palette().window());
+    m_canvas.Composite(painter, event->rect());
+}
+
+void TiledCanvasWidget::resizeEvent(QResizeEvent* event)
+{
+    m_canvas.Resize(event->size());
+    QWidget::resizeEvent(event);
+}
+
+} // namespace gomarky
@@ -0,0 +1,39 @@
+#pragma once
+
+#include <QWidget>
+
+#include "render/tiled_canvas.h"
+
+namespace gomarky
+{
+
+class WorkerPool;
+
+/// Widget showing a TiledCanvas the size of the widget.
+/// Dirty tiles are rendered on the pool at the start of each paint event and then composited
+/// on the GUI thread; clean tiles are reused as they are.
+class TiledCanvasWidget : public QWidget
+{
+    Q_OBJECT
+
+public:
+    explicit TiledCanvasWidget(QWidget* parent = nullptr);
+    TiledCanvasWidget(WorkerPool& pool, QWidget* parent = nullptr);
+
+    void SetPaintFunction(TiledCanvas::PaintFunction paint);
+
+    /// Mark part of the canvas for re-rendering and schedule a repaint of it.
+    void InvalidateCanvas(const QRect& rect);
+
+    const TiledCanvas& Canvas() const { return m_canvas; }
+
+protected:
+    void paintEvent(QPaintEvent* event) override;
+    void resizeEvent(QResizeEvent* event) override;
+
+private:
+    WorkerPool& m_pool;
+    TiledCanvas m_canvas;
+};
+
+} // namespace gomarky
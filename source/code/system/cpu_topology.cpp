@@ -0,0 +1,282 @@
+#include "system/cpu_topology.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <map>
+#include <new>
+#include <set>
+#include <thread>
+#include <tuple>
+#include <utility>
+
+#if defined(__linux__)
+#include <dirent.h>
+#include <pthread.h>
+#include <sched.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+namespace gomarky
+{
+
+namespace
+{
+
+bool ReadLine(const std::string& path, std::string& line)
+{
+    std::ifstream in(path);
+    return in && std::getline(in, line);
+}
+
+bool ReadInt(const std::string& path, int& value)
+{
+    std::string line;
+    if (!ReadLine(path, line)) return false;
+    char* end = nullptr;
+    const long parsed = std::strtol(line.c_str(), &end, 10);
+    if (end == line.c_str()) return false;
+    value = static_cast<int>(parsed);
+    return true;
+}
+
+std::vector<std::string> ListDirectory(const std::string& path)
+{
+    std::vector<std::string> names;
+#if defined(__linux__)
+    if (DIR* dir = opendir(path.c_str()))
+    {
+        while (dirent* entry = readdir(dir)) names.push_back(entry->d_name);
+        closedir(dir);
+    }
+#else
+    (void)path;
+#endif
+    return names;
+}
+
+// "node3" -> 3, anything else -> -1.
+int NumberAfter(const std::string& name, const std::string& prefix)
+{
+    if (name.size() <= prefix.size() || name.compare(0, prefix.size(), prefix) != 0) return -1;
+    for (size_t i = prefix.size(); i < name.size(); ++i)
+    {
+        if (name[i] < '0' || name[i] > '9') return -1;
+    }
+    return std::atoi(name.c_str() + prefix.size());
+}
+
+} // namespace
+
+std::vector<int> ParseCpuList(const std::string& text)
+{
+    std::vector<int> cpus;
+    const char*      p = text.c_str();
+    while (*p)
+    {
+        char*      end   = nullptr;
+        const long first = std::strtol(p, &end, 10);
+        if (end == p) break;
+        long last = first;
+        p         = end;
+        if (*p == '-')
+        {
+            last = std::strtol(p + 1, &end, 10);
+            if (end == p + 1) break;
+            p = end;
+        }
+        for (long cpu = first; cpu <= last; ++cpu) cpus.push_back(static_cast<int>(cpu));
+        if (*p != ',') break;
+        ++p;
+    }
+    return cpus;
+}
+
+CpuTopology CpuTopology::Discover(const std::string& sysfs_root)
+{
+    const std::string cpu_root = sysfs_root + "/cpu";
+
+    std::string      online;
+    std::vector<int> ids;
+    if (ReadLine(cpu_root + "/online", online)) ids = ParseCpuList(online);
+    if (ids.empty())
+    {
+        for (const auto& name : ListDirectory(cpu_root))
+        {
+            const int id = NumberAfter(name, "cpu");
+            if (id >= 0) ids.push_back(id);
+        }
+        std::sort(ids.begin(), ids.end());
+    }
+    if (ids.empty()) return Flat(static_cast<int>(std::max(1u, std::thread::hardware_concurrency())));
+
+    CpuTopology                       topology;
+    std::map<std::pair<int, int>, int> cores;  // (package, core_id) -> dense index
+    std::map<std::string, int>         caches; // shared_cpu_list of the L3 -> dense index
+    std::set<int>                      packages;
+    std::set<int>                      nodes;
+    for (int id : ids)
+    {
+        const std::string dir = cpu_root + "/cpu" + std::to_string(id);
+        Cpu               cpu;
+        cpu.id      = id;
+        int core_id = id;
+        ReadInt(dir + "/topology/physical_package_id", cpu.package);
+        ReadInt(dir + "/topology/core_id", core_id);
+        cpu.package = std::max(cpu.package, 0);
+
+        std::string siblings_text;
+        ReadLine(dir + "/topology/thread_siblings_list", siblings_text);
+        const std::vector<int> siblings = ParseCpuList(siblings_text);
+        cpu.sibling = static_cast<int>(std::count_if(siblings.begin(), siblings.end(), [id](int s) { return s < id; }));
+
+        // The last-level cache shared with other cores; without one, the package stands in.
+        std::string l3_key = "package " + std::to_string(cpu.package);
+        for (const auto& name : ListDirectory(dir + "/cache"))
+        {
+            int level = 0;
+            if (NumberAfter(name, "index") < 0 || !ReadInt(dir + "/cache/" + name + "/level", level) || level != 3)
+            {
+                continue;
+            }
+            std::string shared;
+            if (ReadLine(dir + "/cache/" + name + "/shared_cpu_list", shared)) l3_key = "l3 " + shared;
+        }
+
+        for (const auto& name : ListDirectory(dir))
+        {
+            const int node = NumberAfter(name, "node");
+            if (node >= 0) cpu.node = node;
+        }
+
+        cpu.core = cores.emplace(std::make_pair(cpu.package, core_id), static_cast<int>(cores.size())).first->second;
+        cpu.l3   = caches.emplace(l3_key, static_cast<int>(caches.size())).first->second;
+        packages.insert(cpu.package);
+        nodes.insert(cpu.node);
+        topology.m_cpus.push_back(cpu);
+    }
+    topology.m_cores      = static_cast<int>(cores.size());
+    topology.m_packages   = static_cast<int>(packages.size());
+    topology.m_l3_domains = static_cast<int>(caches.size());
+    topology.m_nodes      = static_cast<int>(nodes.size());
+    return topology;
+}
+
+CpuTopology CpuTopology::Flat(int cpus)
+{
+    CpuTopology topology;
+    for (int id = 0; id < cpus; ++id)
+    {
+        Cpu cpu;
+        cpu.id   = id;
+        cpu.core = id;
+        topology.m_cpus.push_back(cpu);
+    }
+    topology.m_cores      = cpus;
+    topology.m_packages   = 1;
+    topology.m_l3_domains = 1;
+    topology.m_nodes      = 1;
+    return topology;
+}
+
+const CpuTopology::Cpu* CpuTopology::Find(int cpu) const
+{
+    auto it = std::lower_bound(m_cpus.begin(), m_cpus.end(), cpu, [](const Cpu& c, int id) { return c.id < id; });
+    return it != m_cpus.end() && it->id == cpu ? &*it : nullptr;
+}
+
+std::vector<int> CpuTopology::PlacementOrder() const
+{
+    std::vector<Cpu> sorted = m_cpus;
+    std::sort(sorted.begin(), sorted.end(), [](const Cpu& a, const Cpu& b) {
+        return std::tie(a.sibling, a.l3, a.core, a.id) < std::tie(b.sibling, b.l3, b.core, b.id);
+    });
+    std::vector<int> order;
+    for (const auto& cpu : sorted) order.push_back(cpu.id);
+    return order;
+}
+
+std::string CpuTopology::Describe() const
+{
+    char text[160];
+    std::snprintf(text, sizeof(text), "%d packages, %d cores, %zu threads, %d L3 domains, %d nodes", m_packages,
+                  m_cores, m_cpus.size(), m_l3_domains, m_nodes);
+    return text;
+}
+
+std::vector<int> AllowedCpus(const CpuTopology& topology)
+{
+    std::vector<int> allowed;
+#if defined(__linux__)
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    if (sched_getaffinity(0, sizeof(set), &set) == 0)
+    {
+        for (const auto& cpu : topology.Cpus())
+        {
+            if (cpu.id < CPU_SETSIZE && CPU_ISSET(cpu.id, &set)) allowed.push_back(cpu.id);
+        }
+        if (!allowed.empty()) return allowed;
+    }
+#endif
+    for (const auto& cpu : topology.Cpus()) allowed.push_back(cpu.id);
+    return allowed;
+}
+
+bool PinCurrentThread(int cpu)
+{
+#if defined(__linux__)
+    if (cpu < 0 || cpu >= CPU_SETSIZE) return false;
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(cpu, &set);
+    return pthread_setaffinity_np(pthread_self(), sizeof(set), &set) == 0;
+#else
+    (void)cpu;
+    return false;
+#endif
+}
+
+void* AllocateOnNode(size_t bytes, int node)
+{
+    if (bytes == 0) return nullptr;
+#if defined(__linux__)
+    void* memory = mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (memory == MAP_FAILED) throw std::bad_alloc();
+#if defined(SYS_mbind)
+    // MPOL_PREFERRED rather than MPOL_BIND: better remote pages than an allocation failure.
+    constexpr int kPreferred = 1;
+    constexpr int kMaxNodes  = 1024;
+    if (node >= 0 && node < kMaxNodes)
+    {
+        unsigned long mask[kMaxNodes / (8 * sizeof(unsigned long))] = {};
+        mask[node / (8 * sizeof(unsigned long))] |= 1ul << (node % (8 * sizeof(unsigned long)));
+        syscall(SYS_mbind, memory, bytes, kPreferred, mask, kMaxNodes, 0);
+    }
+#else
+    (void)node;
+#endif
+    return memory;
+#else
+    (void)node;
+    void* memory = std::calloc(1, bytes);
+    if (!memory) throw std::bad_alloc();
+    return memory;
+#endif
+}
+
+void FreeOnNode(void* memory, size_t bytes)
+{
+    if (!memory) return;
+#if defined(__linux__)
+    munmap(memory, bytes);
+#else
+    (void)bytes;
+    std::free(memory);
+#endif
+}
+
+} // namespace gomarky
@@ -0,0 +1,70 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+namespace gomarky
+{
+
+/// Which hardware threads share a core, a last-level cache and a memory node.
+///
+/// Read from sysfs on Linux. Whatever cannot be read degrades to the simplest answer: one
+/// package, one L3 domain and one node, with a core per hardware thread.
+class CpuTopology
+{
+public:
+    struct Cpu
+    {
+        int id      = 0; ///< logical CPU number, as used for affinity
+        int core    = 0; ///< dense index of the physical core, shared by SMT siblings
+        int package = 0;
+        int l3      = 0; ///< dense index of the group of CPUs sharing a last-level cache
+        int node    = 0; ///< NUMA node
+        int sibling = 0; ///< 0 for the first hardware thread of its core, 1 for the second...
+    };
+
+    /// Topology of this machine, or of a copy of sysfs under `sysfs_root` (for tests).
+    static CpuTopology Discover(const std::string& sysfs_root = "/sys/devices/system");
+
+    /// `cpus` independent CPUs on one node.
+    static CpuTopology Flat(int cpus);
+
+    const std::vector<Cpu>& Cpus() const { return m_cpus; }
+    const Cpu*              Find(int cpu) const;
+
+    int CoreCount() const { return m_cores; }
+    int L3Count() const { return m_l3_domains; }
+    int NodeCount() const { return m_nodes; }
+
+    /// CPUs in the order workers should take them: every physical core before any second SMT
+    /// thread, and the cores of one L3 domain next to each other, so that a pool of N workers
+    /// spans as few caches as possible without doubling up on cores.
+    std::vector<int> PlacementOrder() const;
+
+    /// "2 packages, 32 cores, 64 threads, 4 L3 domains, 2 nodes".
+    std::string Describe() const;
+
+private:
+    std::vector<Cpu> m_cpus; ///< sorted by id
+    int              m_cores      = 0;
+    int              m_packages   = 0;
+    int              m_l3_domains = 0;
+    int              m_nodes      = 0;
+};
+
+/// Parse a sysfs CPU list such as "0-3,8,10-11".
+std::vector<int> ParseCpuList(const std::string& text);
+
+/// CPUs this process may run on; every CPU of `topology` where affinity is not supported.
+std::vector<int> AllowedCpus(const CpuTopology& topology);
+
+/// Restrict the calling thread to `cpu`. False where unsupported or refused.
+bool PinCurrentThread(int cpu);
+
+/// Memory whose pages are placed on NUMA node `node` where the kernel supports it. Elsewhere the
+/// pages land wherever they are first touched, so touch them from a thread on that node. Zeroed.
+void* AllocateOnNode(size_t bytes, int node);
+void  FreeOnNode(void* memory, size_t bytes);
+
+} // namespace gomarky
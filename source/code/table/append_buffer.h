@@ -0,0 +1,95 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <iterator>
+#include <memory>
+#include <vector>
+
+namespace gomarky
+{
+
+/// Contiguous array that only grows at the end, whose copies share their storage: a copy costs
+/// O(1) and keeps seeing exactly the elements it was made with.
+///
+/// Appending writes into the spare capacity of shared storage when no other copy wrote there
+/// first; elements below any copy's size are never written again. Otherwise the elements are
+/// moved to fresh storage of at least twice the size, so appends stay amortized O(1) however
+/// many copies are taken. A copy can therefore be read on another thread while the original
+/// keeps growing, which is how table snapshots reach background work. Appending to two copies
+/// at once is not safe.
+template<typename T>
+class AppendBuffer
+{
+public:
+    size_t Size() const { return m_size; }
+    bool   Empty() const { return m_size == 0; }
+    size_t Capacity() const { return m_storage ? m_storage->capacity() : 0; }
+
+    const T* Data() const { return m_storage ? m_storage->data() : nullptr; }
+    const T& operator[](size_t index) const { return (*m_storage)[index]; }
+    const T* begin() const { return Data(); }
+    const T* end() const { return Data() + m_size; }
+
+    void PushBack(T value)
+    {
+        Own(m_size + 1);
+        m_storage->push_back(std::move(value));
+        ++m_size;
+    }
+
+    template<typename It>
+    void Append(It first, It last)
+    {
+        const size_t count = static_cast<size_t>(std::distance(first, last));
+        Own(m_size + count);
+        m_storage->insert(m_storage->end(), first, last);
+        m_size += count;
+    }
+
+    void Reserve(size_t size)
+    {
+        if (size <= Capacity()) return;
+        Own(size);
+        m_storage->reserve(size);
+    }
+
+    /// Replace the contents with `count` copies of `value`.
+    void Assign(size_t count, const T& value)
+    {
+        m_storage = std::make_shared<std::vector<T>>(count, value);
+        m_size    = count;
+    }
+
+private:
+    // Make the storage safe to append up to `size` elements to.
+    void Own(size_t size)
+    {
+        if (!m_storage)
+        {
+            m_storage = std::make_shared<std::vector<T>>();
+            m_storage->reserve(size);
+            return;
+        }
+        if (m_storage.use_count() == 1)
+        {
+            // Pairs with the release of the last other copy, whose reads must be over before the
+            // storage is reallocated or overwritten.
+            std::atomic_thread_fence(std::memory_order_acquire);
+            m_storage->erase(m_storage->begin() + static_cast<std::ptrdiff_t>(m_size), m_storage->end());
+            return;
+        }
+        if (m_storage->size() == m_size && size <= m_storage->capacity()) return;
+
+        auto storage = std::make_shared<std::vector<T>>();
+        storage->reserve(std::max(size, 2 * m_size));
+        storage->insert(storage->end(), begin(), end());
+        m_storage = std::move(storage);
+    }
+
+    std::shared_ptr<std::vector<T>> m_storage;
+    size_t                          m_size = 0;
+};
+
+} // namespace gomarky
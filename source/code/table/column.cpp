@@ -0,0 +1,76 @@
+#include "table/column.h"
+
+#include <vector>
+
+namespace gomarky
+{
+
+size_t StringColumn::MemoryUsage() const
+{
+    size_t bytes = m_codes.Capacity() * sizeof(uint32_t) + m_validity.MemoryUsage();
+    for (const auto& value : m_dictionary)
+    {
+        // Dictionary entries are counted twice: once in the table and once as lookup keys.
+        bytes += 2 * (sizeof(std::string) + value.capacity()) + sizeof(uint32_t);
+    }
+    return bytes;
+}
+
+std::unique_ptr<Column> StringColumn::Share() const
+{
+    auto copy          = std::make_unique<StringColumn>(m_name);
+    copy->m_validity   = m_validity;
+    copy->m_codes      = m_codes;
+    copy->m_dictionary = m_dictionary;
+    return copy;
+}
+
+uint32_t StringColumn::Encode(const std::string& value)
+{
+    if (m_lookup.size() != m_dictionary.Size())
+    {
+        // A shared copy starts without the lookup; entries are distinct, so sizes tell.
+        m_lookup.clear();
+        for (uint32_t code = 0; code < m_dictionary.Size(); ++code) m_lookup.emplace(m_dictionary[code], code);
+    }
+    auto it = m_lookup.find(value);
+    if (it == m_lookup.end())
+    {
+        it = m_lookup.emplace(value, static_cast<uint32_t>(m_dictionary.Size())).first;
+        m_dictionary.PushBack(value);
+    }
+    return it->second;
+}
+
+void StringColumn::Append(const std::string& value)
+{
+    m_codes.PushBack(Encode(value));
+    m_validity.Append(true);
+}
+
+void StringColumn::AppendNull()
+{
+    // Nulls share code 0 so the codes array stays dense; the bitmap tells them apart.
+    if (m_dictionary.Empty()) Encode(std::string());
+    m_codes.PushBack(0);
+    m_validity.Append(false);
+}
+
+void StringColumn::Reserve(size_t rows)
+{
+    m_codes.Reserve(rows);
+    m_validity.Reserve(rows);
+}
+
+void StringColumn::AppendFrom(const StringColumn& other)
+{
+    // Look every distinct value up once, then the codes are a table lookup per row.
+    std::vector<uint32_t> remap(other.m_dictionary.Size());
+    for (size_t code = 0; code < remap.size(); ++code) remap[code] = Encode(other.m_dictionary[code]);
+
+    m_codes.Reserve(m_codes.Size() + other.m_codes.Size());
+    for (uint32_t code : other.m_codes) m_codes.PushBack(remap[code]);
+    m_validity.AppendFrom(other.m_validity);
+}
+
+} // namespace gomarky
@@ -0,0 +1,128 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <unordered_map>
+
+#include "table/append_buffer.h"
+#include "table/null_bitmap.h"
+
+namespace gomarky
+{
+
+enum class ColumnType
+{
+    Int64,
+    Double,
+    String,
+};
+
+class Column
+{
+public:
+    explicit Column(std::string name) : m_name(std::move(name)) {}
+    virtual ~Column() = default;
+
+    virtual ColumnType Type() const = 0;
+    virtual size_t     MemoryUsage() const = 0;
+    /// Copy that shares this column's storage (see AppendBuffer), O(1).
+    virtual std::unique_ptr<Column> Share() const = 0;
+
+    const std::string& Name() const { return m_name; }
+    size_t             Size() const { return m_validity.Size(); }
+    bool               IsNull(size_t row) const { return !m_validity.IsValid(row); }
+    const NullBitmap&  Validity() const { return m_validity; }
+
+protected:
+    std::string m_name;
+    NullBitmap  m_validity;
+};
+
+/// Contiguous column of a fixed-width arithmetic type.
+/// Null slots hold a zero so that sum kernels can ignore the bitmap entirely.
+template<typename T, ColumnType kType>
+class NumericColumn : public Column
+{
+public:
+    using ValueType = T;
+
+    using Column::Column;
+
+    ColumnType Type() const override { return kType; }
+
+    size_t MemoryUsage() const override
+    {
+        return m_values.Capacity() * sizeof(T) + m_validity.MemoryUsage();
+    }
+
+    std::unique_ptr<Column> Share() const override { return std::make_unique<NumericColumn>(*this); }
+
+    void Append(T value)
+    {
+        m_values.PushBack(value);
+        m_validity.Append(true);
+    }
+
+    void AppendNull()
+    {
+        m_values.PushBack(T());
+        m_validity.Append(false);
+    }
+
+    void Reserve(size_t rows)
+    {
+        m_values.Reserve(rows);
+        m_validity.Reserve(rows);
+    }
+
+    /// Append every row of `other`.
+    void AppendFrom(const NumericColumn& other)
+    {
+        m_values.Append(other.m_values.begin(), other.m_values.end());
+        m_validity.AppendFrom(other.m_validity);
+    }
+
+    T        Value(size_t row) const { return m_values[row]; }
+    const T* Data() const { return m_values.Data(); }
+
+private:
+    AppendBuffer<T> m_values;
+};
+
+using Int64Column  = NumericColumn<int64_t, ColumnType::Int64>;
+using DoubleColumn = NumericColumn<double, ColumnType::Double>;
+
+/// Dictionary-encoded string column: every row stores a 32-bit code into a table of
+/// distinct values, which also gives group-by a dense key space for free.
+class StringColumn : public Column
+{
+public:
+    using Column::Column;
+
+    ColumnType              Type() const override { return ColumnType::String; }
+    size_t                  MemoryUsage() const override;
+    std::unique_ptr<Column> Share() const override;
+
+    void Append(const std::string& value);
+    void AppendNull();
+    void Reserve(size_t rows);
+    /// Append every row of `other`, translating its codes into this dictionary.
+    void AppendFrom(const StringColumn& other);
+
+    const std::string& Value(size_t row) const { return m_dictionary[m_codes[row]]; }
+    uint32_t           Code(size_t row) const { return m_codes[row]; }
+    const uint32_t*    Codes() const { return m_codes.Data(); }
+
+    const AppendBuffer<std::string>& Dictionary() const { return m_dictionary; }
+
+private:
+    uint32_t Encode(const std::string& value);
+
+    AppendBuffer<uint32_t>                    m_codes;
+    AppendBuffer<std::string>                 m_dictionary;
+    std::unordered_map<std::string, uint32_t> m_lookup; ///< not shared; rebuilt on the first append to a copy
+};
+
+} // namespace gomarky
@@ -0,0 +1,118 @@
+#include "table/column_table.h"
+
+#include <algorithm>
+#include <stdexcept>
+
+namespace gomarky
+{
+
+template<typename ColumnT>
+ColumnT& ColumnTable::Add(const std::string& name)
+{
+    if (IndexOf(name) >= 0) throw std::invalid_argument("duplicate column name: " + name);
+    auto column = std::make_unique<ColumnT>(name);
+    auto& ref   = *column;
+    m_columns.push_back(std::move(column));
+    return ref;
+}
+
+Int64Column&  ColumnTable::AddInt64Column(const std::string& name) { return Add<Int64Column>(name); }
+DoubleColumn& ColumnTable::AddDoubleColumn(const std::string& name) { return Add<DoubleColumn>(name); }
+StringColumn& ColumnTable::AddStringColumn(const std::string& name) { return Add<StringColumn>(name); }
+
+size_t ColumnTable::RowCount() const
+{
+    size_t rows = 0;
+    for (const auto& column : m_columns)
+    {
+        rows = std::max(rows, column->Size());
+    }
+    return rows;
+}
+
+int ColumnTable::IndexOf(const std::string& name) const
+{
+    for (size_t i = 0; i < m_columns.size(); ++i)
+    {
+        if (m_columns[i]->Name() == name) return static_cast<int>(i);
+    }
+    return -1;
+}
+
+bool ColumnTable::CanAppend(const ColumnTable& rows) const
+{
+    if (m_columns.empty()) return true;
+    if (rows.m_columns.size() != m_columns.size()) return false;
+    for (size_t i = 0; i < m_columns.size(); ++i)
+    {
+        if (m_columns[i]->Type() != rows.m_columns[i]->Type()) return false;
+    }
+    return true;
+}
+
+void ColumnTable::AppendRows(const ColumnTable& rows)
+{
+    if (!CanAppend(rows)) throw std::invalid_argument("appended rows have different columns");
+    if (m_columns.empty())
+    {
+        for (const auto& column : rows.m_columns)
+        {
+            switch (column->Type())
+            {
+            case ColumnType::Int64: AddInt64Column(column->Name()); break;
+            case ColumnType::Double: AddDoubleColumn(column->Name()); break;
+            case ColumnType::String: AddStringColumn(column->Name()); break;
+            }
+        }
+    }
+
+    for (size_t i = 0; i < m_columns.size(); ++i)
+    {
+        const Column& from = *rows.m_columns[i];
+        switch (from.Type())
+        {
+        case ColumnType::Int64:
+            static_cast<Int64Column&>(*m_columns[i]).AppendFrom(static_cast<const Int64Column&>(from));
+            break;
+        case ColumnType::Double:
+            static_cast<DoubleColumn&>(*m_columns[i]).AppendFrom(static_cast<const DoubleColumn&>(from));
+            break;
+        case ColumnType::String:
+            static_cast<StringColumn&>(*m_columns[i]).AppendFrom(static_cast<const StringColumn&>(from));
+            break;
+        }
+    }
+}
+
+std::unique_ptr<ColumnTable> ColumnTable::Share() const
+{
+    auto copy = std::make_unique<ColumnTable>();
+    copy->m_columns.reserve(m_columns.size());
+    for (const auto& column : m_columns) copy->m_columns.push_back(column->Share());
+    return copy;
+}
+
+void ColumnTable::Reserve(size_t rows)
+{
+    for (auto& column : m_columns)
+    {
+        switch (column->Type())
+        {
+        case ColumnType::Int64: static_cast<Int64Column&>(*column).Reserve(rows); break;
+        case ColumnType::Double: static_cast<DoubleColumn&>(*column).Reserve(rows); break;
+        case ColumnType::String: static_cast<StringColumn&>(*column).Reserve(rows); break;
+        }
+    }
+}
+
+size_t ColumnTable::MemoryUsage() const
+{
+    size_t bytes = 0;
+    for (const auto& column : m_columns)
+    {
+        bytes += column->MemoryUsage();
+    }
+    return bytes;
+}
+
+} // namespace gomarky
@@ -0,0 +1,53 @@
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "table/column.h"
+
+namespace gomarky
+{
+
+/// In-memory table stored column by column.
+/// Columns are filled independently; the table is consistent once they all have the same size.
+class ColumnTable
+{
+public:
+    Int64Column&  AddInt64Column(const std::string& name);
+    DoubleColumn& AddDoubleColumn(const std::string& name);
+    StringColumn& AddStringColumn(const std::string& name);
+
+    size_t RowCount() const;
+    size_t ColumnCount() const { return m_columns.size(); }
+
+    const Column& At(size_t index) const { return *m_columns[index]; }
+    Column&       At(size_t index) { return *m_columns[index]; }
+
+    /// Index of the column called `name`, or -1.
+    int IndexOf(const std::string& name) const;
+
+    /// Whether `rows` has the same column types in the same order, or this table has no columns.
+    bool CanAppend(const ColumnTable& rows) const;
+
+    /// Append the rows of `rows`; throws std::invalid_argument unless CanAppend(rows).
+    /// An empty table takes the columns of `rows` first, so this also copies a table.
+    void AppendRows(const ColumnTable& rows);
+
+    /// Copy that shares the column storage instead of copying it, in O(columns). Rows appended
+    /// to either table afterwards stay out of the other, and the copy can be read on another
+    /// thread while this table keeps growing.
+    std::unique_ptr<ColumnTable> Share() const;
+
+    void   Reserve(size_t rows);
+    size_t MemoryUsage() const;
+
+private:
+    template<typename ColumnT>
+    ColumnT& Add(const std::string& name);
+
+    std::vector<std::unique_ptr<Column>> m_columns;
+};
+
+} // namespace gomarky
@@ -0,0 +1,119 @@
+#include "table/column_table_model.h"
+
+#include <limits>
+#include <stdexcept>
+
+namespace gomarky
+{
+
+namespace
+{
+
+// Qt models are int-indexed; clamp rather than wrap for oversized tables.
+int ClampRows(size_t rows)
+{
+    return rows > size_t(std::numeric_limits<int>::max()) ? std::numeric_limits<int>::max()
+                                                          : static_cast<int>(rows);
+}
+
+} // namespace
+
+ColumnTableModel::ColumnTableModel(std::shared_ptr<const ColumnTable> table, QObject* parent)
+    : QAbstractTableModel(parent), m_table(std::move(table))
+{
+}
+
+void ColumnTableModel::SetTable(std::shared_ptr<const ColumnTable> table)
+{
+    beginResetModel();
+    m_table = std::move(table);
+    m_growing.reset();
+    endResetModel();
+}
+
+void ColumnTableModel::AppendRows(std::unique_ptr<ColumnTable> rows)
+{
+    if (!rows || rows->ColumnCount() == 0) return;
+    if (!m_table || m_table->ColumnCount() == 0)
+    {
+        // The columns change as well, so this is a reset rather than an insertion.
+        beginResetModel();
+        m_growing = std::move(rows);
+        m_table   = m_growing;
+        endResetModel();
+        return;
+    }
+    if (!m_table->CanAppend(*rows)) throw std::invalid_argument("appended rows have different columns");
+    const size_t added = rows->RowCount();
+    if (added == 0) return;
+
+    // A table handed in from outside may be read elsewhere, so the model grows its own copy,
+    // which shares the storage rather than duplicating it.
+    if (!m_growing)
+    {
+        m_growing = m_table->Share();
+        m_table   = m_growing;
+    }
+
+    const int  first  = rowCount();
+    const int  last   = ClampRows(m_table->RowCount() + added) - 1;
+    const bool notify = last >= first;
+    if (notify) beginInsertRows(QModelIndex(), first, last);
+    m_growing->AppendRows(*rows);
+    if (notify) endInsertRows();
+}
+
+std::shared_ptr<const ColumnTable> ColumnTableModel::SharedTable() const
+{
+    if (!m_growing) return m_table;
+    return m_growing->Share();
+}
+
+int ColumnTableModel::rowCount(const QModelIndex& parent) const
+{
+    if (parent.isValid() || !m_table) return 0;
+    return ClampRows(m_table->RowCount());
+}
+
+int ColumnTableModel::columnCount(const QModelIndex& parent) const
+{
+    if (parent.isValid() || !m_table) return 0;
+    return static_cast<int>(m_table->ColumnCount());
+}
+
+QVariant ColumnTableModel::data(const QModelIndex& index, int role) const
+{
+    if (!index.isValid() || !m_table) return QVariant();
+
+    const Column& column = m_table->At(static_cast<size_t>(index.column()));
+    const size_t  row    = static_cast<size_t>(index.row());
+    if (row >= column.Size()) return QVariant();
+
+    if (role == Qt::TextAlignmentRole)
+    {
+        return column.Type() == ColumnType::String ? int(Qt::AlignLeft | Qt::AlignVCenter)
+                                                   : int(Qt::AlignRight | Qt::AlignVCenter);
+    }
+    if (role != Qt::DisplayRole && role != Qt::EditRole) return QVariant();
+    if (column.IsNull(row)) return QVariant();
+
+    switch (column.Type())
+    {
+    case ColumnType::Int64:
+        return QVariant::fromValue<qlonglong>(static_cast<const Int64Column&>(column).Value(row));
+    case ColumnType::Double: return static_cast<const DoubleColumn&>(column).Value(row);
+    case ColumnType::String:
+        return QString::fromStdString(static_cast<const StringColumn&>(column).Value(row));
+    }
+    return QVariant();
+}
+
+QVariant ColumnTableModel::headerData(int section, Qt::Orientation orientation, int role) const
+{
+    if (role != Qt::DisplayRole || !m_table) return QVariant();
+    if (orientation == Qt::Vertical) return section + 1;
+    if (section < 0 || size_t(section) >= m_table->ColumnCount()) return QVariant();
+    return QString::fromStdString(m_table->At(static_cast<size_t>(section)).Name());
+}
+
+} // namespace gomarky
@@ -0,0 +1,48 @@
+#pragma once
+
+#include <memory>
+
+#include <QAbstractTableModel>
+
+#include "table/column_table.h"
+
+namespace gomarky
+{
+
+/// Read-only Qt model over a ColumnTable.
+/// Nothing is converted up front: views only ask for the cells they paint, and each of those is
+/// turned into a QVariant on demand straight from the column storage.
+class ColumnTableModel : public QAbstractTableModel
+{
+    Q_OBJECT
+
+public:
+    explicit ColumnTableModel(std::shared_ptr<const ColumnTable> table, QObject* parent = nullptr);
+
+    /// Swap the underlying table, e.g. after a bulk load finished on another thread.
+    void SetTable(std::shared_ptr<const ColumnTable> table);
+
+    /// Add rows at the end, e.g. what a followed file grew by; views see rows inserted rather than
+    /// a reset. The table grows in place, in time proportional to the rows added: snapshots from
+    /// SharedTable() share its storage but not its row count, so they never change.
+    /// A model without columns takes `rows` as its table.
+    /// Throws std::invalid_argument when the columns do not match.
+    void AppendRows(std::unique_ptr<ColumnTable> rows);
+
+    /// The current table; for the GUI thread, it changes as rows are appended.
+    const ColumnTable& Table() const { return *m_table; }
+    /// An immutable snapshot of the current table that can be read on any thread, O(columns).
+    std::shared_ptr<const ColumnTable> SharedTable() const;
+
+    int      rowCount(const QModelIndex& parent = QModelIndex()) const override;
+    int      columnCount(const QModelIndex& parent = QModelIndex()) const override;
+    QVariant data(const QModelIndex& index, int role = Qt::DisplayRole) const override;
+    QVariant headerData(int section, Qt::Orientation orientation,
+                        int role = Qt::DisplayRole) const override;
+
+private:
+    std::shared_ptr<const ColumnTable> m_table;
+    std::shared_ptr<ColumnTable>       m_growing; ///< m_table once AppendRows changed it, never shared
+};
+
+} // namespace gomarky
@@ -0,0 +1,271 @@
+#include "table/column_table_proxy_model.h"
+
+#include <numeric>
+
+#include <QCoreApplication>
+#include <QPointer>
+
+#include "concurrency/worker_pool.h"
+#include "table/column_table_model.h"
+
+namespace gomarky
+{
+
+namespace
+{
+
+// Batches of appended rows landing in more places than this reset the view instead.
+constexpr size_t kMaxInsertRuns = 32;
+
+} // namespace
+
+ColumnTableProxyModel::ColumnTableProxyModel(ColumnTableModel* source, QObject* parent)
+    : ColumnTableProxyModel(source, WorkerPool::Global(), parent)
+{
+}
+
+ColumnTableProxyModel::ColumnTableProxyModel(ColumnTableModel* source, WorkerPool& pool, QObject* parent)
+    : QAbstractProxyModel(parent), m_source(source), m_pool(pool)
+{
+    setSourceModel(source);
+    connect(source, &QAbstractItemModel::modelAboutToBeReset, this, &ColumnTableProxyModel::beginResetModel);
+    connect(source, &QAbstractItemModel::modelReset, this, [this] {
+        OnSourceReset();
+        endResetModel();
+    });
+    connect(source, &QAbstractItemModel::rowsInserted, this, &ColumnTableProxyModel::OnSourceRowsInserted);
+    OnSourceReset();
+}
+
+void ColumnTableProxyModel::OnSourceReset()
+{
+    // The old mapping may point past the end of the new table, so switch to the identity
+    // mapping right away and refine it in the background.
+    auto ordering  = std::make_shared<Ordering>();
+    ordering->rows = AllRows(m_source->Table());
+    ordering->inverse.assign(ordering->rows.begin(), ordering->rows.end());
+    m_ordering     = std::move(ordering);
+    m_published    = ++m_requested;
+    m_stale        = false;
+
+    if (m_filter || m_sort.column >= 0) Schedule(false, false);
+}
+
+void ColumnTableProxyModel::OnSourceRowsInserted(const QModelIndex& parent, int first, int last)
+{
+    if (parent.isValid()) return;
+    const bool appended = last + 1 == m_source->rowCount();
+    if (IsBusy())
+    {
+        // Let the request in flight finish rather than superseding it, or a table that grows
+        // faster than it can be sorted would never show a result. Appended rows are merged into
+        // its result; rows inserted anywhere else renumber the others and need a new request.
+        if (!appended) m_stale = true;
+        return;
+    }
+    if (!appended || size_t(first) != m_ordering->inverse.size())
+    {
+        Schedule(false, false);
+        return;
+    }
+    InsertAppended(static_cast<size_t>(last) + 1);
+}
+
+void ColumnTableProxyModel::InsertAppended(size_t end)
+{
+    const size_t first = m_ordering->inverse.size();
+    if (end <= first) return;
+
+    // Only the new rows are filtered and sorted; the mapping already holds the others in order.
+    const ColumnTable& table = m_source->Table();
+    RowIds             added(end - first);
+    std::iota(added.begin(), added.end(), static_cast<uint32_t>(first));
+    if (m_filter) added = FilterRows(table, m_filter, added, m_pool);
+    std::vector<size_t> positions;
+    if (m_sort.column >= 0)
+    {
+        SortRows(table, m_sort, added, m_pool);
+        positions = InsertPositions(table, m_sort, m_ordering->rows, added);
+    }
+    else
+    {
+        positions.assign(added.size(), m_ordering->rows.size());
+    }
+
+    // A request that started from the current mapping may still hold it, in which case it is copied.
+    if (m_ordering.use_count() > 1) m_ordering = std::make_shared<Ordering>(*m_ordering);
+    RowIds&               rows    = m_ordering->rows;
+    std::vector<int32_t>& inverse = m_ordering->inverse;
+    inverse.resize(end, -1);
+
+    size_t runs = 0;
+    for (size_t i = 0; i < positions.size(); ++i) runs += i == 0 || positions[i] != positions[i - 1];
+    if (runs > kMaxInsertRuns)
+    {
+        // Each insertion shifts the rows after it, so past a few runs a single reset over the
+        // merged rows is cheaper, for the view as well.
+        beginResetModel();
+        RowIds merged;
+        merged.reserve(rows.size() + added.size());
+        for (size_t i = 0, from = 0; i <= added.size(); ++i)
+        {
+            const size_t to = i < added.size() ? positions[i] : rows.size();
+            merged.insert(merged.end(), rows.begin() + from, rows.begin() + to);
+            if (i < added.size()) merged.push_back(added[i]);
+            from = to;
+        }
+        rows.swap(merged);
+        for (size_t row = positions.front(); row < rows.size(); ++row) inverse[rows[row]] = int32_t(row);
+        endResetModel();
+        return;
+    }
+
+    for (size_t i = 0; i < added.size();)
+    {
+        size_t next = i + 1;
+        while (next < added.size() && positions[next] == positions[i]) ++next;
+        // The rows inserted by earlier runs come before this one as well.
+        const size_t at = positions[i] + i;
+        beginInsertRows(QModelIndex(), static_cast<int>(at), static_cast<int>(at + next - i) - 1);
+        rows.insert(rows.begin() + at, added.begin() + i, added.begin() + next);
+        for (size_t row = at; row < rows.size(); ++row) inverse[rows[row]] = int32_t(row);
+        endInsertRows();
+        i = next;
+    }
+}
+
+void ColumnTableProxyModel::SetFilter(RowPredicate predicate, FilterChange change)
+{
+    const bool had_filter = static_cast<bool>(m_filter);
+    m_filter              = std::move(predicate);
+    // Dropping the filter is always a widening change.
+    Schedule(change == FilterChange::Narrow && had_filter && m_filter, false);
+}
+
+void ColumnTableProxyModel::sort(int column, Qt::SortOrder order)
+{
+    m_sort.column    = column;
+    m_sort.ascending = order == Qt::AscendingOrder;
+    Schedule(false, true);
+}
+
+void ColumnTableProxyModel::Schedule(bool narrow, bool sort_only)
+{
+    // The published rows are only a valid starting point when nothing else is in flight:
+    // otherwise they may have been produced by a filter or sort that is about to be replaced.
+    const bool reuse = !IsBusy() && (narrow || sort_only);
+
+    // Taken now; rows appended from here on are merged into the result when it is published.
+    const uint64_t                     generation = ++m_requested;
+    std::shared_ptr<const ColumnTable> table      = m_source->SharedTable();
+    std::shared_ptr<const Ordering>    previous   = m_ordering;
+    auto                               filter     = m_filter;
+    auto                               spec       = m_sort;
+    auto&                              pool       = m_pool;
+    QPointer<ColumnTableProxyModel>    guard(this);
+    m_stale = false;
+
+    m_pool.Post([=, &pool] {
+        auto ordering = std::make_shared<Ordering>();
+        if (reuse && sort_only)
+        {
+            ordering->rows = previous->rows;
+            SortRows(*table, spec, ordering->rows, pool);
+        }
+        else if (reuse && narrow)
+        {
+            // Filtering keeps the candidates' order, so the current sort still holds.
+            ordering->rows = FilterRows(*table, filter, previous->rows, pool);
+        }
+        else
+        {
+            ordering->rows = filter ? FilterRows(*table, filter, AllRows(*table), pool) : AllRows(*table);
+            if (spec.column >= 0) SortRows(*table, spec, ordering->rows, pool);
+        }
+
+        ordering->inverse.assign(table->RowCount(), -1);
+        int32_t*        inverse = ordering->inverse.data();
+        const uint32_t* rows    = ordering->rows.data();
+        pool.ParallelFor(ordering->rows.size(), 1 << 16, [inverse, rows](size_t begin, size_t end) {
+            for (size_t i = begin; i < end; ++i) inverse[rows[i]] = static_cast<int32_t>(i);
+        });
+
+        const bool rows_changed = !(reuse && sort_only);
+        QMetaObject::invokeMethod(QCoreApplication::instance(),
+                                  [guard, generation, ordering, rows_changed] {
+                                      if (guard) guard->Publish(generation, ordering, rows_changed);
+                                  },
+                                  Qt::QueuedConnection);
+    });
+}
+
+void ColumnTableProxyModel::Publish(uint64_t generation, std::shared_ptr<Ordering> ordering, bool rows_changed)
+{
+    if (generation != m_requested) return; // superseded, a newer result is on its way
+
+    if (rows_changed)
+    {
+        beginResetModel();
+        m_ordering  = std::move(ordering);
+        m_published = generation;
+        endResetModel();
+    }
+    else
+    {
+        // Same rows in a new order: move persistent indexes instead of resetting the view.
+        emit layoutAboutToBeChanged({}, QAbstractItemModel::VerticalSortHint);
+        const QModelIndexList old_indexes = persistentIndexList();
+        QModelIndexList       new_indexes;
+        new_indexes.reserve(old_indexes.size());
+        for (const QModelIndex& old_index : old_indexes)
+        {
+            const uint32_t source_row = m_ordering->rows[static_cast<size_t>(old_index.row())];
+            new_indexes.append(createIndex(ordering->inverse[source_row], old_index.column()));
+        }
+        m_ordering  = std::move(ordering);
+        m_published = generation;
+        changePersistentIndexList(old_indexes, new_indexes);
+        emit layoutChanged({}, QAbstractItemModel::VerticalSortHint);
+    }
+    // Rows appended since the request took its snapshot are merged in, unless it is outdated
+    // anyway.
+    if (m_stale) Schedule(false, false);
+    else InsertAppended(static_cast<size_t>(m_source->rowCount()));
+    emit OrderingPublished();
+}
+
+QModelIndex ColumnTableProxyModel::mapToSource(const QModelIndex& proxy_index) const
+{
+    if (!proxy_index.isValid()) return QModelIndex();
+    const uint32_t source_row = m_ordering->rows[static_cast<size_t>(proxy_index.row())];
+    return m_source->index(static_cast<int>(source_row), proxy_index.column());
+}
+
+QModelIndex ColumnTableProxyModel::mapFromSource(const QModelIndex& source_index) const
+{
+    if (!source_index.isValid()) return QModelIndex();
+    const size_t source_row = static_cast<size_t>(source_index.row());
+    if (source_row >= m_ordering->inverse.size()) return QModelIndex();
+    const int32_t row = m_ordering->inverse[source_row];
+    return row < 0 ? QModelIndex() : createIndex(row, source_index.column());
+}
+
+QModelIndex ColumnTableProxyModel::index(int row, int column, const QModelIndex& parent) const
+{
+    if (!hasIndex(row, column, parent)) return QModelIndex();
+    return createIndex(row, column);
+}
+
+QModelIndex ColumnTableProxyModel::parent(const QModelIndex&) const { return QModelIndex(); }
+
+int ColumnTableProxyModel::rowCount(const QModelIndex& parent) const
+{
+    return parent.isValid() ? 0 : static_cast<int>(m_ordering->rows.size());
+}
+
+int ColumnTableProxyModel::columnCount(const QModelIndex& parent) const
+{
+    return parent.isValid() ? 0 : m_source->columnCount();
+}
+
+} // namespace gomarky
@@ -0,0 +1,84 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include <QAbstractProxyModel>
+
+#include "table/row_order.h"
+
+namespace gomarky
+{
+
+class ColumnTableModel;
+class WorkerPool;
+
+/// Sort/filter proxy for ColumnTableModel that does its work off the GUI thread.
+///
+/// Sorting and filtering run on a WorkerPool against the immutable table snapshot. The view keeps
+/// using the previous mapping until the new one is complete, which is then swapped in at once on
+/// the GUI thread. Results of requests that were superseded in the meantime are dropped.
+///
+/// Rows appended to the source are filtered and sorted on their own and merged into the mapping,
+/// showing up as inserted rows; rows appended while a request is in flight are merged into its
+/// result. Only other changes to the source start over from the whole table.
+class ColumnTableProxyModel : public QAbstractProxyModel
+{
+    Q_OBJECT
+
+public:
+    enum class FilterChange
+    {
+        Replace, ///< unrelated to the current filter, every row is rescanned
+        Narrow,  ///< only rows matching the current filter can match, only those are rescanned
+    };
+
+    explicit ColumnTableProxyModel(ColumnTableModel* source, QObject* parent = nullptr);
+    ColumnTableProxyModel(ColumnTableModel* source, WorkerPool& pool, QObject* parent = nullptr);
+
+    /// An empty predicate removes the filter.
+    void SetFilter(RowPredicate predicate, FilterChange change = FilterChange::Replace);
+
+    /// True while a sort or filter request has not been published yet.
+    bool IsBusy() const { return m_requested != m_published; }
+
+    void sort(int column, Qt::SortOrder order = Qt::AscendingOrder) override;
+
+    QModelIndex mapToSource(const QModelIndex& proxy_index) const override;
+    QModelIndex mapFromSource(const QModelIndex& source_index) const override;
+    QModelIndex index(int row, int column, const QModelIndex& parent = QModelIndex()) const override;
+    QModelIndex parent(const QModelIndex& child) const override;
+    int         rowCount(const QModelIndex& parent = QModelIndex()) const override;
+    int         columnCount(const QModelIndex& parent = QModelIndex()) const override;
+
+signals:
+    /// Emitted on the GUI thread each time a new ordering replaced the visible one.
+    void OrderingPublished();
+
+private:
+    struct Ordering
+    {
+        RowIds               rows;    ///< proxy row -> source row
+        std::vector<int32_t> inverse; ///< source row -> proxy row, -1 when filtered out
+    };
+
+    void OnSourceReset();
+    void OnSourceRowsInserted(const QModelIndex& parent, int first, int last);
+    /// Merge the source rows from the end of the mapping up to `end` into it.
+    void InsertAppended(size_t end);
+    void Schedule(bool narrow, bool sort_only);
+    void Publish(uint64_t generation, std::shared_ptr<Ordering> ordering, bool rows_changed);
+
+    ColumnTableModel*         m_source;
+    WorkerPool&               m_pool;
+    std::shared_ptr<Ordering> m_ordering;
+    SortSpec                  m_sort;
+    RowPredicate              m_filter;
+    uint64_t                  m_requested = 0;
+    uint64_t                  m_published = 0;
+    bool                      m_stale     = false; ///< the request in flight missed more than appends
+};
+
+} // namespace gomarky
@@ -0,0 +1,209 @@
+#include "table/delimited_parser.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+
+namespace gomarky
+{
+
+namespace
+{
+
+bool IsDigit(char c) { return c >= '0' && c <= '9'; }
+
+// Digits with an optional sign. Scanned first so that strtoll never sees spaces or hex.
+bool ParseInt64(const std::string& field, int64_t& value)
+{
+    size_t i = field.size() > 1 && (field[0] == '-' || field[0] == '+') ? 1 : 0;
+    if (i == field.size()) return false;
+    for (size_t j = i; j < field.size(); ++j)
+    {
+        if (!IsDigit(field[j])) return false;
+    }
+    errno = 0;
+    const long long parsed = std::strtoll(field.c_str(), nullptr, 10);
+    if (errno == ERANGE) return false;
+    value = parsed;
+    return true;
+}
+
+// digits [. digits] [e [+-] digits], so that strtod never sees hex, inf or nan either.
+bool ParseDouble(const std::string& field, double& value)
+{
+    size_t i = 0;
+    if (i < field.size() && (field[i] == '-' || field[i] == '+')) ++i;
+    size_t digits = 0;
+    for (; i < field.size() && IsDigit(field[i]); ++i) ++digits;
+    if (i < field.size() && field[i] == '.')
+    {
+        for (++i; i < field.size() && IsDigit(field[i]); ++i) ++digits;
+    }
+    if (digits == 0) return false;
+    if (i < field.size() && (field[i] == 'e' || field[i] == 'E'))
+    {
+        ++i;
+        if (i < field.size() && (field[i] == '-' || field[i] == '+')) ++i;
+        if (i == field.size() || !IsDigit(field[i])) return false;
+        while (i < field.size() && IsDigit(field[i])) ++i;
+    }
+    if (i != field.size()) return false;
+    value = std::strtod(field.c_str(), nullptr);
+    return true;
+}
+
+} // namespace
+
+DelimitedParser::DelimitedParser(char delimiter, bool header) : m_delimiter(delimiter), m_header(header) {}
+
+void DelimitedParser::Parse(const char* text, size_t size)
+{
+    const char* end = text + size;
+    while (text < end)
+    {
+        const char* newline = static_cast<const char*>(std::memchr(text, '\n', size_t(end - text)));
+        const char* line_end = newline ? newline : end;
+        size_t      length   = size_t(line_end - text);
+        if (length && text[length - 1] == '\r') --length;
+
+        if (length)
+        {
+            SplitFields(text, length);
+            if (m_header && m_names.empty())
+            {
+                m_names.assign(m_fields.begin(), m_fields.begin() + static_cast<std::ptrdiff_t>(m_field_count));
+            }
+            else
+            {
+                if (m_types.empty()) Infer();
+                AppendRow();
+            }
+        }
+        text = newline ? newline + 1 : end;
+    }
+}
+
+void DelimitedParser::SplitFields(const char* line, size_t size)
+{
+    m_field_count   = 0;
+    const char* end = line + size;
+    const char* p   = line;
+    for (;;)
+    {
+        if (m_field_count == m_fields.size()) m_fields.emplace_back();
+        std::string& field = m_fields[m_field_count++];
+        field.clear();
+
+        if (p < end && *p == '"')
+        {
+            for (++p; p < end; ++p)
+            {
+                if (*p != '"') field += *p;
+                else if (p + 1 < end && p[1] == '"') field += *p++;
+                else break;
+            }
+            // Anything between the closing quote and the delimiter is dropped.
+            while (p < end && *p != m_delimiter) ++p;
+        }
+        else
+        {
+            const char* stop = static_cast<const char*>(std::memchr(p, m_delimiter, size_t(end - p)));
+            if (!stop) stop = end;
+            field.assign(p, stop);
+            p = stop;
+        }
+
+        if (p >= end) break;
+        ++p; // delimiter
+    }
+}
+
+void DelimitedParser::Infer()
+{
+    // Columns the header names but the first row lacks are strings; extra fields get numbered.
+    const size_t count = std::max(m_names.size(), m_field_count);
+    for (size_t i = m_names.size(); i < count; ++i) m_names.push_back("column" + std::to_string(i + 1));
+
+    int64_t as_int    = 0;
+    double  as_double = 0;
+    for (size_t i = 0; i < count; ++i)
+    {
+        const std::string* field = i < m_field_count ? &m_fields[i] : nullptr;
+        if (field && ParseInt64(*field, as_int)) m_types.push_back(ColumnType::Int64);
+        else if (field && ParseDouble(*field, as_double)) m_types.push_back(ColumnType::Double);
+        else m_types.push_back(ColumnType::String);
+    }
+}
+
+void DelimitedParser::NewBatch()
+{
+    m_rows = std::make_unique<ColumnTable>();
+    m_columns.clear();
+    for (size_t i = 0; i < m_types.size(); ++i)
+    {
+        // Blank and repeated header names would make the columns ambiguous, number them.
+        std::string name = m_names[i].empty() ? "column" + std::to_string(i + 1) : m_names[i];
+        while (m_rows->IndexOf(name) >= 0) name += "_" + std::to_string(i + 1);
+        switch (m_types[i])
+        {
+        case ColumnType::Int64: m_columns.push_back(&m_rows->AddInt64Column(name)); break;
+        case ColumnType::Double: m_columns.push_back(&m_rows->AddDoubleColumn(name)); break;
+        case ColumnType::String: m_columns.push_back(&m_rows->AddStringColumn(name)); break;
+        }
+    }
+}
+
+void DelimitedParser::AppendRow()
+{
+    if (!m_rows) NewBatch();
+
+    int64_t as_int    = 0;
+    double  as_double = 0;
+    for (size_t i = 0; i < m_columns.size(); ++i)
+    {
+        const std::string* field = i < m_field_count ? &m_fields[i] : nullptr;
+        switch (m_types[i])
+        {
+        case ColumnType::Int64:
+        {
+            auto& column = static_cast<Int64Column&>(*m_columns[i]);
+            if (field && ParseInt64(*field, as_int)) column.Append(as_int);
+            else column.AppendNull();
+            break;
+        }
+        case ColumnType::Double:
+        {
+            auto& column = static_cast<DoubleColumn&>(*m_columns[i]);
+            if (field && ParseDouble(*field, as_double)) column.Append(as_double);
+            else column.AppendNull();
+            break;
+        }
+        case ColumnType::String:
+        {
+            auto& column = static_cast<StringColumn&>(*m_columns[i]);
+            if (field) column.Append(*field);
+            else column.AppendNull();
+            break;
+        }
+        }
+    }
+}
+
+std::unique_ptr<ColumnTable> DelimitedParser::TakeRows()
+{
+    if (!m_rows && HasColumns()) NewBatch();
+    if (!m_rows) return std::make_unique<ColumnTable>();
+    m_columns.clear();
+    return std::move(m_rows);
+}
+
+void DelimitedParser::Reset()
+{
+    m_names.clear();
+    m_types.clear();
+    m_rows.reset();
+    m_columns.clear();
+}
+
+} // namespace gomarky
@@ -0,0 +1,53 @@
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "table/column_table.h"
+
+namespace gomarky
+{
+
+/// Incremental parser for delimited text (CSV, TSV, ...), fed whole lines a chunk at a time so a
+/// growing file is parsed once, as it grows.
+///
+/// Column names come from the first line, or are numbered when there is no header. Column types
+/// are taken from the first data row: integers, then floating point, otherwise strings. Later
+/// values that do not parse as their column's type, and missing fields, become nulls. Fields may
+/// be double-quoted with "" for a quote, but not span lines.
+class DelimitedParser
+{
+public:
+    explicit DelimitedParser(char delimiter = ',', bool header = true);
+
+    /// Parse the complete lines in `text`. A final line without a line break is parsed as well.
+    void Parse(const char* text, size_t size);
+
+    /// The rows parsed since the last call, with the full set of columns (possibly no rows).
+    std::unique_ptr<ColumnTable> TakeRows();
+
+    /// Forget the header and column types, e.g. when the file was replaced.
+    void Reset();
+
+    bool HasColumns() const { return !m_types.empty(); }
+
+private:
+    void SplitFields(const char* line, size_t size);
+    void Infer();
+    void AppendRow();
+    void NewBatch();
+
+    const char m_delimiter;
+    const bool m_header;
+
+    std::vector<std::string>     m_names;
+    std::vector<ColumnType>      m_types;
+    std::unique_ptr<ColumnTable> m_rows;
+    std::vector<Column*>         m_columns; ///< columns of m_rows
+    std::vector<std::string>     m_fields;  ///< fields of the current line, reused
+    size_t                       m_field_count = 0;
+};
+
+} // namespace gomarky
@@ -0,0 +1,378 @@
+#include "table/kernels.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <limits>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#include <immintrin.h>
+#define GM_TABLE_KERNELS_X86 1
+#else
+#define GM_TABLE_KERNELS_X86 0
+#endif
+
+namespace gomarky
+{
+
+namespace
+{
+
+std::atomic<bool> g_simd_enabled{true};
+
+bool UseAvx2()
+{
+#if GM_TABLE_KERNELS_X86
+    static const bool supported = __builtin_cpu_supports("avx2");
+    return supported && g_simd_enabled.load(std::memory_order_relaxed);
+#else
+    return false;
+#endif
+}
+
+size_t PopCount(uint64_t word)
+{
+#if defined(__GNUC__)
+    return static_cast<size_t>(__builtin_popcountll(word));
+#else
+    size_t count = 0;
+    for (; word; word &= word - 1) ++count;
+    return count;
+#endif
+}
+
+constexpr size_t kBlock = 64;
+
+// NaN has no place in an ordering, so Min and Max skip it the way they skip nulls.
+bool IsNaN(double value) { return std::isnan(value); }
+bool IsNaN(int64_t) { return false; }
+
+// Where a running minimum (maximum) starts: a value every other one replaces, which for floating
+// point is infinity rather than the largest finite value, so that columns of infinities come out
+// the same as in the scalar path.
+template<typename T>
+T MinSeed()
+{
+    return std::numeric_limits<T>::has_infinity ? std::numeric_limits<T>::infinity()
+                                                : std::numeric_limits<T>::max();
+}
+
+template<typename T>
+T MaxSeed()
+{
+    return std::numeric_limits<T>::has_infinity ? -std::numeric_limits<T>::infinity()
+                                                : std::numeric_limits<T>::lowest();
+}
+
+// Walk the column in 64-row blocks matching the validity words. Fully valid blocks are handed to
+// `dense` so they can be vectorized, anything else goes row by row through `sparse`.
+template<typename T, typename Dense, typename Sparse>
+void ForEachBlock(const T* values, const NullBitmap& validity, size_t size, Dense dense, Sparse sparse)
+{
+    for (size_t base = 0; base < size; base += kBlock)
+    {
+        const size_t   length = std::min(kBlock, size - base);
+        const uint64_t word   = validity.Word(base / kBlock);
+        if (length == kBlock && word == ~uint64_t(0))
+        {
+            dense(values + base);
+            continue;
+        }
+        for (size_t i = 0; i < length; ++i)
+        {
+            if ((word >> i) & 1) sparse(values[base + i]);
+        }
+    }
+}
+
+template<typename T>
+T SumScalar(const T* values, size_t size)
+{
+    T acc[4] = {};
+    size_t i = 0;
+    for (; i + 4 <= size; i += 4)
+    {
+        acc[0] += values[i];
+        acc[1] += values[i + 1];
+        acc[2] += values[i + 2];
+        acc[3] += values[i + 3];
+    }
+    for (; i < size; ++i) acc[0] += values[i];
+    return (acc[0] + acc[1]) + (acc[2] + acc[3]);
+}
+
+template<typename T, typename Less>
+bool ReduceScalar(const T* values, const NullBitmap& validity, size_t size, T& out, Less less)
+{
+    bool found = false;
+    T    best  = T();
+    auto visit = [&](T value) {
+        if (IsNaN(value)) return;
+        if (!found || less(value, best)) best = value;
+        found = true;
+    };
+    ForEachBlock(values, validity, size,
+                 [&](const T* block) {
+                     for (size_t i = 0; i < kBlock; ++i) visit(block[i]);
+                 },
+                 visit);
+    if (found) out = best;
+    return found;
+}
+
+#if GM_TABLE_KERNELS_X86
+
+__attribute__((target("avx2"))) double SumAvx2(const double* values, size_t size)
+{
+    __m256d a = _mm256_setzero_pd();
+    __m256d b = _mm256_setzero_pd();
+    size_t  i = 0;
+    for (; i + 8 <= size; i += 8)
+    {
+        a = _mm256_add_pd(a, _mm256_loadu_pd(values + i));
+        b = _mm256_add_pd(b, _mm256_loadu_pd(values + i + 4));
+    }
+    alignas(32) double lanes[4];
+    _mm256_store_pd(lanes, _mm256_add_pd(a, b));
+    double sum = (lanes[0] + lanes[1]) + (lanes[2] + lanes[3]);
+    for (; i < size; ++i) sum += values[i];
+    return sum;
+}
+
+__attribute__((target("avx2"))) int64_t SumAvx2(const int64_t* values, size_t size)
+{
+    __m256i a = _mm256_setzero_si256();
+    __m256i b = _mm256_setzero_si256();
+    size_t  i = 0;
+    for (; i + 8 <= size; i += 8)
+    {
+        a = _mm256_add_epi64(a, _mm256_loadu_si256(reinterpret_cast<const __m256i*>(values + i)));
+        b = _mm256_add_epi64(b, _mm256_loadu_si256(reinterpret_cast<const __m256i*>(values + i + 4)));
+    }
+    alignas(32) int64_t lanes[4];
+    _mm256_store_si256(reinterpret_cast<__m256i*>(lanes), _mm256_add_epi64(a, b));
+    int64_t sum = lanes[0] + lanes[1] + lanes[2] + lanes[3];
+    for (; i < size; ++i) sum += values[i];
+    return sum;
+}
+
+// Reduce one fully valid 64-row block into `acc`; false when it held nothing but NaN.
+// _mm256_min_pd/_mm256_max_pd return their second operand when either is NaN, so NaN lanes are
+// replaced by the accumulator first and never reach them.
+__attribute__((target("avx2"))) bool MinBlockAvx2(const double* block, __m256d& acc)
+{
+    __m256d ordered_any = _mm256_setzero_pd();
+    for (size_t i = 0; i < kBlock; i += 4)
+    {
+        const __m256d v       = _mm256_loadu_pd(block + i);
+        const __m256d ordered = _mm256_cmp_pd(v, v, _CMP_ORD_Q);
+        acc                   = _mm256_min_pd(acc, _mm256_blendv_pd(acc, v, ordered));
+        ordered_any           = _mm256_or_pd(ordered_any, ordered);
+    }
+    return _mm256_movemask_pd(ordered_any) != 0;
+}
+
+__attribute__((target("avx2"))) bool MaxBlockAvx2(const double* block, __m256d& acc)
+{
+    __m256d ordered_any = _mm256_setzero_pd();
+    for (size_t i = 0; i < kBlock; i += 4)
+    {
+        const __m256d v       = _mm256_loadu_pd(block + i);
+        const __m256d ordered = _mm256_cmp_pd(v, v, _CMP_ORD_Q);
+        acc                   = _mm256_max_pd(acc, _mm256_blendv_pd(acc, v, ordered));
+        ordered_any           = _mm256_or_pd(ordered_any, ordered);
+    }
+    return _mm256_movemask_pd(ordered_any) != 0;
+}
+
+// AVX2 has no 64-bit integer min/max, so compare and blend.
+__attribute__((target("avx2"))) bool MinBlockAvx2(const int64_t* block, __m256i& acc)
+{
+    for (size_t i = 0; i < kBlock; i += 4)
+    {
+        const __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(block + i));
+        acc             = _mm256_blendv_epi8(acc, v, _mm256_cmpgt_epi64(acc, v));
+    }
+    return true;
+}
+
+__attribute__((target("avx2"))) bool MaxBlockAvx2(const int64_t* block, __m256i& acc)
+{
+    for (size_t i = 0; i < kBlock; i += 4)
+    {
+        const __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(block + i));
+        acc             = _mm256_blendv_epi8(acc, v, _mm256_cmpgt_epi64(v, acc));
+    }
+    return true;
+}
+
+__attribute__((target("avx2"))) __m256d Broadcast(double value) { return _mm256_set1_pd(value); }
+__attribute__((target("avx2"))) __m256i Broadcast(int64_t value) { return _mm256_set1_epi64x(value); }
+
+__attribute__((target("avx2"))) void StoreLanes(__m256d v, double* lanes) { _mm256_storeu_pd(lanes, v); }
+__attribute__((target("avx2"))) void StoreLanes(__m256i v, int64_t* lanes)
+{
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(lanes), v);
+}
+
+// Everything touching vector registers stays inside avx2-targeted functions so that no __m256
+// value ever crosses into code compiled for the baseline ISA.
+template<typename T, bool kMin>
+__attribute__((target("avx2"))) bool ReduceAvx2(const T* values, const NullBitmap& validity,
+                                                size_t size, T& out)
+{
+    const T identity = kMin ? MinSeed<T>() : MaxSeed<T>();
+    auto    acc      = Broadcast(identity);
+    T       best     = identity;
+    bool    found    = false;
+    for (size_t base = 0; base < size; base += kBlock)
+    {
+        const size_t   length = std::min(kBlock, size - base);
+        const uint64_t word   = validity.Word(base / kBlock);
+        if (length == kBlock && word == ~uint64_t(0))
+        {
+            const bool any = kMin ? MinBlockAvx2(values + base, acc) : MaxBlockAvx2(values + base, acc);
+            found          = found || any;
+            continue;
+        }
+        for (size_t i = 0; i < length; ++i)
+        {
+            if (!((word >> i) & 1)) continue;
+            const T value = values[base + i];
+            if (IsNaN(value)) continue;
+            if (kMin ? value < best : value > best) best = value;
+            found = true;
+        }
+    }
+    if (!found) return false;
+    T lanes[4];
+    StoreLanes(acc, lanes);
+    for (T lane : lanes)
+    {
+        if (kMin ? lane < best : lane > best) best = lane;
+    }
+    out = best;
+    return true;
+}
+
+#endif
+
+template<typename ColumnT>
+bool MinImpl(const ColumnT& column, typename ColumnT::ValueType& out)
+{
+    using T = typename ColumnT::ValueType;
+    auto less = [](T a, T b) { return a < b; };
+#if GM_TABLE_KERNELS_X86
+    if (UseAvx2())
+    {
+        return ReduceAvx2<T, true>(column.Data(), column.Validity(), column.Size(), out);
+    }
+#endif
+    return ReduceScalar(column.Data(), column.Validity(), column.Size(), out, less);
+}
+
+template<typename ColumnT>
+bool MaxImpl(const ColumnT& column, typename ColumnT::ValueType& out)
+{
+    using T = typename ColumnT::ValueType;
+    auto greater = [](T a, T b) { return a > b; };
+#if GM_TABLE_KERNELS_X86
+    if (UseAvx2())
+    {
+        return ReduceAvx2<T, false>(column.Data(), column.Validity(), column.Size(), out);
+    }
+#endif
+    return ReduceScalar(column.Data(), column.Validity(), column.Size(), out, greater);
+}
+
+template<typename ColumnT>
+typename ColumnT::ValueType SumImpl(const ColumnT& column)
+{
+    // Null slots are stored as zero, so the bitmap can be ignored here.
+#if GM_TABLE_KERNELS_X86
+    if (UseAvx2()) return SumAvx2(column.Data(), column.Size());
+#endif
+    return SumScalar(column.Data(), column.Size());
+}
+
+template<typename ColumnT>
+GroupByResult<typename ColumnT::ValueType> GroupByImpl(const StringColumn& keys, const ColumnT& values)
+{
+    using T = typename ColumnT::ValueType;
+
+    const size_t groups = keys.Dictionary().Size();
+    GroupByResult<T> result;
+    result.sum.assign(groups, T());
+    result.min.assign(groups, MinSeed<T>());
+    result.max.assign(groups, MaxSeed<T>());
+    result.count.assign(groups, 0);
+
+    const size_t    size  = std::min(keys.Size(), values.Size());
+    const uint32_t* codes = keys.Codes();
+    const T*        data  = values.Data();
+    T*              sum   = result.sum.data();
+    T*              min   = result.min.data();
+    T*              max   = result.max.data();
+    size_t*         count = result.count.data();
+
+    // Dictionary codes are dense, so groups live in flat arrays instead of a hash map.
+    // This stays scalar: lanes of one vector can hit the same group, and AVX2 has neither
+    // conflict detection nor scatters to resolve that, so a vector version would store lane by
+    // lane anyway. The loop is bound by the random access into the group arrays, not arithmetic.
+    // NaN rows are skipped like nulls, as in Min and Max, so a group's count is what its min and
+    // max were taken over.
+    for (size_t base = 0; base < size; base += kBlock)
+    {
+        const size_t   length = std::min(kBlock, size - base);
+        const uint64_t word   = keys.Validity().Word(base / kBlock) & values.Validity().Word(base / kBlock);
+        for (size_t i = 0; i < length; ++i)
+        {
+            if (!((word >> i) & 1)) continue;
+            const uint32_t code  = codes[base + i];
+            const T        value = data[base + i];
+            if (IsNaN(value)) continue;
+            sum[code] += value;
+            min[code] = std::min(min[code], value);
+            max[code] = std::max(max[code], value);
+            ++count[code];
+        }
+    }
+    return result;
+}
+
+} // namespace
+
+int64_t Sum(const Int64Column& column) { return SumImpl(column); }
+double  Sum(const DoubleColumn& column) { return SumImpl(column); }
+
+bool Min(const Int64Column& column, int64_t& out) { return MinImpl(column, out); }
+bool Min(const DoubleColumn& column, double& out) { return MinImpl(column, out); }
+bool Max(const Int64Column& column, int64_t& out) { return MaxImpl(column, out); }
+bool Max(const DoubleColumn& column, double& out) { return MaxImpl(column, out); }
+
+size_t Count(const Column& column)
+{
+    const NullBitmap& validity = column.Validity();
+    if (!validity.HasNulls()) return validity.Size();
+
+    size_t count = 0;
+    for (size_t i = 0, words = (validity.Size() + 63) / 64; i < words; ++i)
+    {
+        count += PopCount(validity.Word(i));
+    }
+    return count;
+}
+
+GroupByResult<int64_t> GroupBy(const StringColumn& keys, const Int64Column& values)
+{
+    return GroupByImpl(keys, values);
+}
+
+GroupByResult<double> GroupBy(const StringColumn& keys, const DoubleColumn& values)
+{
+    return GroupByImpl(keys, values);
+}
+
+void SetTableKernelsSimdEnabled(bool enabled) { g_simd_enabled.store(enabled, std::memory_order_relaxed); }
+
+} // namespace gomarky
@@ -0,0 +1,46 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "table/column.h"
+
+namespace gomarky
+{
+
+// Aggregation kernels over numeric columns. Null rows are skipped.
+// On x86 with GCC/Clang the kernels pick an AVX2 path at runtime, otherwise a scalar loop is used.
+
+int64_t Sum(const Int64Column& column);
+double  Sum(const DoubleColumn& column);
+
+/// Return false (and leave `out` untouched) when the column has no valid rows.
+/// NaN values are skipped like nulls, on every code path.
+bool Min(const Int64Column& column, int64_t& out);
+bool Min(const DoubleColumn& column, double& out);
+bool Max(const Int64Column& column, int64_t& out);
+bool Max(const DoubleColumn& column, double& out);
+
+/// Number of non-null rows.
+size_t Count(const Column& column);
+
+/// Per-key aggregates, indexed by the key column's dictionary code.
+/// Rows with a null or NaN value are left out; keys that only appear on such rows have a count of
+/// 0, and their min and max are meaningless.
+template<typename T>
+struct GroupByResult
+{
+    std::vector<T>      sum;
+    std::vector<T>      min;
+    std::vector<T>      max;
+    std::vector<size_t> count;
+};
+
+GroupByResult<int64_t> GroupBy(const StringColumn& keys, const Int64Column& values);
+GroupByResult<double>  GroupBy(const StringColumn& keys, const DoubleColumn& values);
+
+/// Disable the vectorized paths, used to compare them against the scalar reference.
+void SetTableKernelsSimdEnabled(bool enabled);
+
+} // namespace gomarky
@@ -0,0 +1,79 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+#include "table/append_buffer.h"
+
+namespace gomarky
+{
+
+/// Validity bitmap, one bit per row (1 = value present).
+/// Storage is only allocated once the first null is appended, so columns without nulls
+/// pay nothing for it. The last, partly filled word is kept aside until it is full, so stored
+/// words never change and copies can share them.
+class NullBitmap
+{
+public:
+    void Append(bool valid)
+    {
+        if (!valid && !m_materialized) Materialize();
+        if (m_materialized)
+        {
+            if (valid) m_last |= uint64_t(1) << (m_size & 63);
+            else ++m_null_count;
+            if ((m_size & 63) == 63)
+            {
+                m_words.PushBack(m_last);
+                m_last = 0;
+            }
+        }
+        ++m_size;
+    }
+
+    /// Append the rows of `other`, word by word when neither side has nulls.
+    void AppendFrom(const NullBitmap& other)
+    {
+        if (!m_materialized && !other.m_materialized)
+        {
+            m_size += other.m_size;
+            return;
+        }
+        for (size_t row = 0; row < other.m_size; ++row) Append(other.IsValid(row));
+    }
+
+    bool IsValid(size_t row) const { return !m_materialized || ((Stored(row >> 6) >> (row & 63)) & 1); }
+
+    bool HasNulls() const { return m_null_count != 0; }
+    size_t NullCount() const { return m_null_count; }
+    size_t Size() const { return m_size; }
+
+    /// Validity word covering rows [64 * index, 64 * index + 63]; all ones when there are no nulls.
+    uint64_t Word(size_t index) const { return m_materialized ? Stored(index) : ~uint64_t(0); }
+
+    size_t MemoryUsage() const { return m_words.Capacity() * sizeof(uint64_t); }
+
+    void Reserve(size_t rows)
+    {
+        if (m_materialized) m_words.Reserve(rows / 64);
+    }
+
+private:
+    uint64_t Stored(size_t index) const { return index < m_words.Size() ? m_words[index] : m_last; }
+
+    void Materialize()
+    {
+        // Every row appended so far was valid.
+        m_words.Assign(m_size / 64, ~uint64_t(0));
+        m_last         = (uint64_t(1) << (m_size & 63)) - 1;
+        m_materialized = true;
+    }
+
+    AppendBuffer<uint64_t> m_words; ///< full words only
+    uint64_t               m_last         = 0;
+    size_t                 m_size         = 0;
+    size_t                 m_null_count   = 0;
+    bool                   m_materialized = false;
+};
+
+} // namespace gomarky
@@ -0,0 +1,174 @@
+#include "table/row_order.h"
+
+#include <algorithm>
+#include <cmath>
+#include <numeric>
+
+#include "concurrency/parallel_sort.h"
+#include "concurrency/worker_pool.h"
+
+namespace gomarky
+{
+
+namespace
+{
+
+constexpr size_t kFilterGrain = 1 << 16;
+
+// Rows without a value, nulls and whatever `missing` holds for, sort last in both directions;
+// `less` is only asked about rows that have one, so it can stay a strict weak ordering.
+template<typename Less, typename Missing>
+auto RowsBefore(const NullBitmap& validity, bool ascending, Less less, Missing missing)
+{
+    return [&validity, ascending, less, missing](uint32_t a, uint32_t b) {
+        const bool a_valid = validity.IsValid(a) && !missing(a);
+        const bool b_valid = validity.IsValid(b) && !missing(b);
+        if (!a_valid || !b_valid) return a_valid && !b_valid;
+        return ascending ? less(a, b) : less(b, a);
+    };
+}
+
+template<typename Less, typename Missing>
+void SortByColumn(const Column& column, bool ascending, Less less, Missing missing, bool has_missing,
+                  RowIds& rows, WorkerPool& pool)
+{
+    const NullBitmap& validity = column.Validity();
+    if (!validity.HasNulls() && !has_missing)
+    {
+        if (ascending) ParallelStableSort(rows, less, pool);
+        else ParallelStableSort(rows, [&](uint32_t a, uint32_t b) { return less(b, a); }, pool);
+        return;
+    }
+    ParallelStableSort(rows, RowsBefore(validity, ascending, less, missing), pool);
+}
+
+// Calls `order(less, missing, has_missing)` with how `column` compares the values of `rows`,
+// `missing` telling which rows have none besides nulls and `has_missing` whether any of `rows` do.
+template<typename Order>
+void ByColumn(const Column& column, const RowIds& rows, Order order)
+{
+    switch (column.Type())
+    {
+    case ColumnType::Int64:
+    {
+        const int64_t* values = static_cast<const Int64Column&>(column).Data();
+        order([values](uint32_t a, uint32_t b) { return values[a] < values[b]; },
+              [](uint32_t) { return false; }, false);
+        break;
+    }
+    case ColumnType::Double:
+    {
+        // NaN compares false with everything, which breaks the ordering the sort relies on;
+        // it goes last with the nulls instead.
+        const double* values = static_cast<const DoubleColumn&>(column).Data();
+        auto          is_nan = [values](uint32_t row) { return std::isnan(values[row]); };
+        order([values](uint32_t a, uint32_t b) { return values[a] < values[b]; }, is_nan,
+              std::any_of(rows.begin(), rows.end(), is_nan));
+        break;
+    }
+    case ColumnType::String:
+    {
+        const auto& strings = static_cast<const StringColumn&>(column);
+        const auto& dict    = strings.Dictionary();
+        if (dict.Size() > rows.size())
+        {
+            // Fewer rows than distinct values, e.g. a batch of appended rows: ranking the whole
+            // dictionary would cost more than comparing the strings.
+            order([&strings](uint32_t a, uint32_t b) { return strings.Value(a) < strings.Value(b); },
+                  [](uint32_t) { return false; }, false);
+            break;
+        }
+
+        // Rank the dictionary once so that row comparisons are integer compares.
+        std::vector<uint32_t> sorted(dict.Size());
+        std::iota(sorted.begin(), sorted.end(), 0);
+        std::sort(sorted.begin(), sorted.end(),
+                  [&dict](uint32_t a, uint32_t b) { return dict[a] < dict[b]; });
+        std::vector<uint32_t> rank(dict.Size());
+        for (uint32_t i = 0; i < sorted.size(); ++i) rank[sorted[i]] = i;
+
+        const uint32_t* codes = strings.Codes();
+        const uint32_t* ranks = rank.data();
+        order([codes, ranks](uint32_t a, uint32_t b) { return ranks[codes[a]] < ranks[codes[b]]; },
+              [](uint32_t) { return false; }, false);
+        break;
+    }
+    }
+}
+
+} // namespace
+
+void SortRows(const ColumnTable& table, const SortSpec& spec, RowIds& rows, WorkerPool& pool)
+{
+    if (spec.column < 0 || size_t(spec.column) >= table.ColumnCount())
+    {
+        // Back to source order; row ids are their own key.
+        ParallelStableSort(rows, std::less<uint32_t>(), pool);
+        return;
+    }
+
+    const Column& column = table.At(static_cast<size_t>(spec.column));
+    ByColumn(column, rows, [&](auto less, auto missing, bool has_missing) {
+        SortByColumn(column, spec.ascending, less, missing, has_missing, rows, pool);
+    });
+}
+
+std::vector<size_t> InsertPositions(const ColumnTable& table, const SortSpec& spec, const RowIds& rows,
+                                    const RowIds& added)
+{
+    std::vector<size_t> positions(added.size());
+    // Each row goes after the rows that compare equal, which precede it in the table; the search
+    // for the next one starts where the previous one ended up.
+    auto place = [&](auto before) {
+        auto from = rows.begin();
+        for (size_t i = 0; i < added.size(); ++i)
+        {
+            from         = std::upper_bound(from, rows.end(), added[i], before);
+            positions[i] = static_cast<size_t>(from - rows.begin());
+        }
+    };
+
+    if (spec.column < 0 || size_t(spec.column) >= table.ColumnCount())
+    {
+        place(std::less<uint32_t>());
+        return positions;
+    }
+    const Column& column = table.At(static_cast<size_t>(spec.column));
+    ByColumn(column, added, [&](auto less, auto missing, bool) {
+        place(RowsBefore(column.Validity(), spec.ascending, less, missing));
+    });
+    return positions;
+}
+
+RowIds FilterRows(const ColumnTable& table, const RowPredicate& predicate, const RowIds& candidates,
+                  WorkerPool& pool)
+{
+    if (!predicate) return candidates;
+
+    // Each chunk filters into its own buffer; concatenating them in chunk order keeps the order.
+    const size_t        chunks = (candidates.size() + kFilterGrain - 1) / kFilterGrain;
+    std::vector<RowIds> partial(chunks);
+    pool.ParallelFor(candidates.size(), kFilterGrain, [&](size_t begin, size_t end) {
+        RowIds& out = partial[begin / kFilterGrain];
+        for (size_t i = begin; i < end; ++i)
+        {
+            if (predicate(table, candidates[i])) out.push_back(candidates[i]);
+        }
+    });
+
+    size_t total = 0;
+    for (const auto& part : partial) total += part.size();
+    RowIds result;
+    result.reserve(total);
+    for (const auto& part : partial) result.insert(result.end(), part.begin(), part.end());
+    return result;
+}
+
+RowIds AllRows(const ColumnTable& table)
+{
+    RowIds rows(table.RowCount());
+    std::iota(rows.begin(), rows.end(), 0u);
+    return rows;
+}
+
+} // namespace gomarky
@@ -0,0 +1,42 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+#include "table/column_table.h"
+
+namespace gomarky
+{
+
+class WorkerPool;
+
+using RowIds       = std::vector<uint32_t>;
+using RowPredicate = std::function<bool(const ColumnTable&, uint32_t row)>;
+
+struct SortSpec
+{
+    int  column    = -1; ///< -1 keeps the source order
+    bool ascending = true;
+};
+
+/// Stable parallel sort of `rows` by one column. Nulls, and NaN in double columns, always sort last.
+void SortRows(const ColumnTable& table, const SortSpec& spec, RowIds& rows, WorkerPool& pool);
+
+/// Where the rows of `added` go among `rows`, both sorted by SortRows with `spec`: added[i] ends
+/// up after the first result[i] rows of `rows` (non-decreasing). With every row of `added` after
+/// those of `rows` in the table, inserting there gives what sorting them all would.
+/// O(added * log(rows)), so a batch of appended rows costs what it adds rather than the table.
+std::vector<size_t> InsertPositions(const ColumnTable& table, const SortSpec& spec, const RowIds& rows,
+                                    const RowIds& added);
+
+/// Keep the rows of `candidates` for which `predicate` holds, preserving their order.
+/// Narrowing a filter only needs the rows that matched the previous one as candidates.
+RowIds FilterRows(const ColumnTable& table, const RowPredicate& predicate, const RowIds& candidates,
+                  WorkerPool& pool);
+
+/// Identity mapping over every row of the table.
+RowIds AllRows(const ColumnTable& table);
+
+} // namespace gomarky
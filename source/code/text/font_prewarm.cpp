@@ -0,0 +1,180 @@
+#include "text/font_prewarm.h"
+
+#include <algorithm>
+
+#include <QCoreApplication>
+#include <QCryptographicHash>
+#include <QDataStream>
+#include <QDateTime>
+#include <QDir>
+#include <QDirIterator>
+#include <QFile>
+#include <QFileInfo>
+#include <QPointer>
+#include <QRawFont>
+#include <QSaveFile>
+#include <QStandardPaths>
+
+#include "concurrency/worker_pool.h"
+
+namespace gomarky
+{
+
+namespace
+{
+
+// Qt does not say which file a QFont resolved to, so file mtimes cannot be checked one by one.
+// Like fontconfig's own cache, use the mtimes of the font directories instead: installing,
+// removing or replacing a font file changes its directory's mtime. The resolved font's 'head'
+// table (checksum and modification date) is part of the stamp as well.
+QByteArray FontDirectoriesStamp()
+{
+    QStringList roots = QStandardPaths::standardLocations(QStandardPaths::FontsLocation);
+#if defined(Q_OS_LINUX)
+    roots << QStringLiteral("/usr/share/fonts") << QStringLiteral("/usr/local/share/fonts")
+          << QDir::homePath() + QStringLiteral("/.local/share/fonts") << QDir::homePath() + QStringLiteral("/.fonts");
+#endif
+    roots.removeDuplicates();
+
+    QStringList entries;
+    for (const QString& root : roots)
+    {
+        const QFileInfo info(root);
+        if (!info.isDir()) continue;
+        entries << root + QLatin1Char(':') + QString::number(info.lastModified().toMSecsSinceEpoch());
+        QDirIterator it(root, QDir::Dirs | QDir::NoDotAndDotDot, QDirIterator::Subdirectories);
+        while (it.hasNext())
+        {
+            it.next();
+            entries << it.filePath() + QLatin1Char(':') + QString::number(it.fileInfo().lastModified().toMSecsSinceEpoch());
+        }
+    }
+    std::sort(entries.begin(), entries.end());
+    return QCryptographicHash::hash(entries.join(QLatin1Char('\n')).toUtf8(), QCryptographicHash::Sha1);
+}
+
+QByteArray AtlasStamp(const QFont& font, const QRawFont& raw, const QString& characters, const QByteArray& directories)
+{
+    QByteArray  stamp;
+    QDataStream stream(&stamp, QIODevice::WriteOnly);
+    stream << QByteArray(qVersion()) << font.toString() << int(font.hintingPreference()) << raw.familyName()
+           << raw.styleName() << raw.pixelSize() << characters << raw.fontTable("head") << directories;
+    return stamp;
+}
+
+QString AtlasFileName(const QString& directory, const QRawFont& raw, const QString& characters)
+{
+    QCryptographicHash hash(QCryptographicHash::Sha1);
+    hash.addData(raw.familyName().toUtf8());
+    hash.addData(raw.styleName().toUtf8());
+    hash.addData(QByteArray::number(raw.pixelSize()));
+    hash.addData(characters.toUtf8());
+    return directory + QLatin1Char('/') + QString::fromLatin1(hash.result().toHex()) + QStringLiteral(".atlas");
+}
+
+FontPrewarm::Result Prewarm(const QFont& font, const QString& characters, const QString& directory,
+                            std::shared_future<QByteArray> directories_stamp)
+{
+    FontPrewarm::Result result;
+    result.font = font;
+
+    // The expensive font database lookup, overlapping the directory walk.
+    const QRawFont raw = QRawFont::fromFont(font);
+    if (!raw.isValid()) return result;
+
+    const QByteArray stamp = AtlasStamp(font, raw, characters, directories_stamp.get());
+    const QString    path  = AtlasFileName(directory, raw, characters);
+
+    auto  atlas = std::make_shared<GlyphAtlas>();
+    QFile file(path);
+    if (file.open(QIODevice::ReadOnly) && GlyphAtlas::Load(file, stamp, *atlas))
+    {
+        result.atlas      = std::move(atlas);
+        result.from_cache = true;
+        return result;
+    }
+    file.close();
+
+    *atlas = GlyphAtlas::Build(raw, characters);
+    if (!atlas->IsEmpty() && QDir().mkpath(directory))
+    {
+        // A failed write only costs the next run a rebuild.
+        QSaveFile output(path);
+        if (output.open(QIODevice::WriteOnly) && atlas->Save(output, stamp)) output.commit();
+    }
+    result.atlas = std::move(atlas);
+    return result;
+}
+
+} // namespace
+
+FontPrewarm::FontPrewarm() : FontPrewarm(WorkerPool::Global()) {}
+
+FontPrewarm::FontPrewarm(WorkerPool& pool) : m_pool(pool) {}
+
+FontPrewarm::~FontPrewarm()
+{
+    // The tasks use the font database, which must outlive them, and the notifications the
+    // application object.
+    Wait();
+    for (auto& notification : m_notifications) notification.wait();
+}
+
+QString FontPrewarm::DefaultCharacters()
+{
+    QString characters;
+    for (char c = 0x20; c < 0x7f; ++c) characters += QLatin1Char(c);
+    return characters;
+}
+
+QString FontPrewarm::DefaultCacheDirectory()
+{
+    return QStandardPaths::writableLocation(QStandardPaths::CacheLocation) + QStringLiteral("/glyph-atlases");
+}
+
+void FontPrewarm::Start(const QList<QFont>& fonts, const QString& characters, const QString& cache_directory)
+{
+    m_started = true;
+
+    // Walking the font directories is shared by all fonts, so do it once in its own task.
+    auto directories = m_pool.Submit([] { return FontDirectoriesStamp(); }).share();
+    for (const QFont& font : fonts)
+    {
+        auto prewarm = m_pool.Submit(
+            [font, characters, cache_directory, directories] { return Prewarm(font, characters, cache_directory, directories); });
+        m_pending.push_back(prewarm.share());
+    }
+}
+
+const std::vector<FontPrewarm::Result>& FontPrewarm::Wait()
+{
+    for (auto& pending : m_pending) m_results.push_back(pending.get());
+    m_pending.clear();
+    return m_results;
+}
+
+std::shared_ptr<const GlyphAtlas> FontPrewarm::Atlas(const QFont& font)
+{
+    for (const Result& result : Wait())
+    {
+        if (result.font == font) return result.atlas;
+    }
+    return nullptr;
+}
+
+void FontPrewarm::WhenReady(QObject* receiver, std::function<void()> ready)
+{
+    // A worker does the waiting; the prewarm tasks were posted before it, so they never queue
+    // behind it.
+    QPointer<QObject> guard(receiver);
+    m_notifications.push_back(m_pool.Submit([pending = m_pending, guard, ready] {
+        for (const auto& result : pending) result.wait();
+        QMetaObject::invokeMethod(QCoreApplication::instance(),
+                                  [guard, ready] {
+                                      if (guard) ready();
+                                  },
+                                  Qt::QueuedConnection);
+    }));
+}
+
+} // namespace gomarky
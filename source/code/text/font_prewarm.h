@@ -0,0 +1,72 @@
+#pragma once
+
+#include <functional>
+#include <future>
+#include <memory>
+#include <vector>
+
+#include <QFont>
+#include <QList>
+#include <QString>
+
+#include "text/glyph_atlas.h"
+
+class QObject;
+
+namespace gomarky
+{
+
+class WorkerPool;
+
+/// Opt-in startup stage that gets fonts ready while the widgets are still being built.
+///
+/// Resolving the first font makes Qt populate its font database (a fontconfig scan, which is
+/// slow with many fonts installed). Doing it on a worker overlaps that with widget construction.
+/// Each font's glyph atlas is then read from the on-disk cache, or rasterized and written to it.
+/// Cached atlases are discarded when the font, Qt, or the installed font directories change.
+class FontPrewarm
+{
+public:
+    struct Result
+    {
+        QFont                             font;
+        std::shared_ptr<const GlyphAtlas> atlas;
+        bool                              from_cache = false;
+    };
+
+    FontPrewarm();
+    explicit FontPrewarm(WorkerPool& pool);
+    ~FontPrewarm();
+
+    FontPrewarm(const FontPrewarm&) = delete;
+    FontPrewarm& operator=(const FontPrewarm&) = delete;
+
+    /// Printable ASCII, which covers the UI's own strings.
+    static QString DefaultCharacters();
+    static QString DefaultCacheDirectory();
+
+    /// Must be called after the QGuiApplication was created.
+    void Start(const QList<QFont>& fonts, const QString& characters,
+               const QString& cache_directory = DefaultCacheDirectory());
+
+    bool IsStarted() const { return m_started; }
+
+    /// Block until every font is done.
+    const std::vector<Result>& Wait();
+
+    /// Blocks like Wait. Null when `font` was not prewarmed or could not be resolved.
+    std::shared_ptr<const GlyphAtlas> Atlas(const QFont& font);
+
+    /// Call `ready` on the GUI thread once every font is done, where Wait and Atlas no longer
+    /// block. Skipped when `receiver` is destroyed first. Call after Start().
+    void WhenReady(QObject* receiver, std::function<void()> ready);
+
+private:
+    WorkerPool&                      m_pool;
+    std::vector<std::shared_future<Result>> m_pending;
+    std::vector<std::future<void>>          m_notifications; ///< WhenReady tasks, joined on destruction
+    std::vector<Result>                     m_results;
+    bool                                    m_started = false;
+};
+
+} // namespace gomarky
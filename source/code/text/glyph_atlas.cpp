@@ -0,0 +1,223 @@
+#include "text/glyph_atlas.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <vector>
+
+#include <QDataStream>
+#include <QGlyphRun>
+#include <QIODevice>
+#include <QPainter>
+#include <QRawFont>
+
+namespace gomarky
+{
+
+namespace
+{
+
+constexpr quint32 kMagic      = 0x474d4741; // "GMGA"
+constexpr quint32 kVersion    = 1;
+constexpr int     kAtlasWidth = 512;
+constexpr int     kPadding    = 1;
+
+struct RasterizedGlyph
+{
+    ushort            character;
+    GlyphAtlas::Glyph glyph;
+    QImage            mask;
+};
+
+// Paint the glyph through QPainter rather than QRawFont::alphaMapForGlyph: the placement of the
+// painted image relative to the pen position is then known exactly.
+QImage RasterizeGlyph(const QRawFont& font, quint32 index, QPoint& offset)
+{
+    const QRectF bounds = font.boundingRect(index);
+    const QPoint origin(kPadding - static_cast<int>(std::floor(bounds.left())),
+                        kPadding - static_cast<int>(std::floor(bounds.top())));
+    const QSize  size(static_cast<int>(std::ceil(bounds.right())) + origin.x() + kPadding,
+                      static_cast<int>(std::ceil(bounds.bottom())) + origin.y() + kPadding);
+    offset = -origin;
+    if (size.width() <= 0 || size.height() <= 0 || bounds.isEmpty()) return QImage();
+
+    QImage image(size, QImage::Format_ARGB32_Premultiplied);
+    image.fill(Qt::transparent);
+    QGlyphRun run;
+    run.setRawFont(font);
+    run.setGlyphIndexes({index});
+    run.setPositions({QPointF(0, 0)});
+    QPainter painter(&image);
+    painter.setPen(Qt::black);
+    painter.drawGlyphRun(origin, run);
+    painter.end();
+    return image.convertToFormat(QImage::Format_Alpha8);
+}
+
+} // namespace
+
+GlyphAtlas GlyphAtlas::Build(const QRawFont& font, const QString& characters)
+{
+    GlyphAtlas atlas;
+    if (!font.isValid()) return atlas;
+    atlas.m_ascent  = font.ascent();
+    atlas.m_descent = font.descent();
+
+    std::vector<RasterizedGlyph> rasterized;
+    for (QChar character : characters)
+    {
+        if (character.isSurrogate() || atlas.m_glyphs.contains(character.unicode())) continue;
+        const QVector<quint32> indexes = font.glyphIndexesForString(QString(character));
+        if (indexes.size() != 1 || indexes[0] == 0) continue;
+
+        RasterizedGlyph entry;
+        entry.character                 = character.unicode();
+        entry.glyph.advance             = font.advancesForGlyphIndexes(indexes).value(0).x();
+        entry.mask                      = RasterizeGlyph(font, indexes[0], entry.glyph.offset);
+        atlas.m_glyphs[entry.character] = entry.glyph; // spaces have an advance but no mask
+        if (!entry.mask.isNull()) rasterized.push_back(std::move(entry));
+    }
+
+    // Shelf packing, tallest first so rows waste little height.
+    std::sort(rasterized.begin(), rasterized.end(),
+              [](const RasterizedGlyph& a, const RasterizedGlyph& b) { return a.mask.height() > b.mask.height(); });
+    int x = 0, y = 0, row_height = 0;
+    for (RasterizedGlyph& entry : rasterized)
+    {
+        if (x + entry.mask.width() > kAtlasWidth)
+        {
+            x = 0;
+            y += row_height;
+            row_height = 0;
+        }
+        entry.glyph.source = QRect(QPoint(x, y), entry.mask.size());
+        x += entry.mask.width();
+        row_height = std::max(row_height, entry.mask.height());
+    }
+
+    atlas.m_mask = QImage(kAtlasWidth, std::max(1, y + row_height), QImage::Format_Alpha8);
+    atlas.m_mask.fill(0);
+    for (const RasterizedGlyph& entry : rasterized)
+    {
+        const QRect& source = entry.glyph.source;
+        for (int row = 0; row < source.height(); ++row)
+        {
+            std::memcpy(atlas.m_mask.scanLine(source.y() + row) + source.x(), entry.mask.constScanLine(row),
+                        static_cast<size_t>(source.width()));
+        }
+        atlas.m_glyphs[entry.character] = entry.glyph;
+    }
+    return atlas;
+}
+
+bool GlyphAtlas::Save(QIODevice& device, const QByteArray& stamp) const
+{
+    QDataStream stream(&device);
+    stream.setVersion(QDataStream::Qt_5_0);
+    stream << kMagic << kVersion << stamp << m_ascent << m_descent << quint32(m_glyphs.size());
+    for (auto it = m_glyphs.begin(); it != m_glyphs.end(); ++it)
+    {
+        stream << it.key() << it->source << it->offset << it->advance;
+    }
+    // Raw rows instead of PNG: decoding has to be cheaper than rasterizing again.
+    stream << qint32(m_mask.width()) << qint32(m_mask.height());
+    for (int row = 0; row < m_mask.height(); ++row)
+    {
+        stream.writeRawData(reinterpret_cast<const char*>(m_mask.constScanLine(row)), m_mask.width());
+    }
+    return stream.status() == QDataStream::Ok;
+}
+
+bool GlyphAtlas::Load(QIODevice& device, const QByteArray& stamp, GlyphAtlas& atlas)
+{
+    QDataStream stream(&device);
+    stream.setVersion(QDataStream::Qt_5_0);
+    quint32    magic = 0, version = 0, count = 0;
+    QByteArray stored_stamp;
+    stream >> magic >> version >> stored_stamp;
+    if (stream.status() != QDataStream::Ok || magic != kMagic || version != kVersion || stored_stamp != stamp)
+    {
+        return false;
+    }
+
+    GlyphAtlas loaded;
+    stream >> loaded.m_ascent >> loaded.m_descent >> count;
+    for (quint32 i = 0; i < count && stream.status() == QDataStream::Ok; ++i)
+    {
+        ushort character = 0;
+        Glyph  glyph;
+        stream >> character >> glyph.source >> glyph.offset >> glyph.advance;
+        loaded.m_glyphs.insert(character, glyph);
+    }
+
+    qint32 width = 0, height = 0;
+    stream >> width >> height;
+    if (stream.status() != QDataStream::Ok || width <= 0 || height <= 0 || width > 1 << 14 || height > 1 << 14)
+    {
+        return false;
+    }
+    loaded.m_mask = QImage(width, height, QImage::Format_Alpha8);
+    for (int row = 0; row < height; ++row)
+    {
+        if (stream.readRawData(reinterpret_cast<char*>(loaded.m_mask.scanLine(row)), width) != width) return false;
+    }
+    for (const Glyph& glyph : loaded.m_glyphs)
+    {
+        if (!glyph.source.isEmpty() && !loaded.m_mask.rect().contains(glyph.source)) return false;
+    }
+    atlas = std::move(loaded);
+    return true;
+}
+
+const GlyphAtlas::Glyph* GlyphAtlas::Find(QChar character) const
+{
+    auto it = m_glyphs.constFind(character.unicode());
+    return it == m_glyphs.constEnd() ? nullptr : &*it;
+}
+
+bool GlyphAtlas::Covers(const QString& text) const
+{
+    return std::all_of(text.begin(), text.end(), [this](QChar character) { return Find(character) != nullptr; });
+}
+
+qreal GlyphAtlas::Width(const QString& text) const
+{
+    qreal width = 0;
+    for (QChar character : text)
+    {
+        if (const Glyph* glyph = Find(character)) width += glyph->advance;
+    }
+    return width;
+}
+
+void GlyphAtlas::Draw(QPainter& painter, const QPointF& baseline, const QString& text, const QColor& color) const
+{
+    auto tinted = m_tinted.find(color.rgba());
+    if (tinted == m_tinted.end())
+    {
+        QImage image(m_mask.size(), QImage::Format_ARGB32_Premultiplied);
+        image.fill(color);
+        QPainter mask_painter(&image);
+        mask_painter.setCompositionMode(QPainter::CompositionMode_DestinationIn);
+        mask_painter.drawImage(0, 0, m_mask);
+        mask_painter.end();
+        tinted = m_tinted.insert(color.rgba(), image);
+    }
+
+    // Glyphs were rasterized at integer positions, so snap the pen the same way Qt does
+    // without subpixel positioning.
+    qreal pen = baseline.x();
+    for (QChar character : text)
+    {
+        const Glyph* glyph = Find(character);
+        if (!glyph) continue;
+        if (!glyph->source.isEmpty())
+        {
+            const QPoint target(qRound(pen) + glyph->offset.x(), qRound(baseline.y()) + glyph->offset.y());
+            painter.drawImage(target, *tinted, glyph->source);
+        }
+        pen += glyph->advance;
+    }
+}
+
+} // namespace gomarky
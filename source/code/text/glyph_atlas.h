@@ -0,0 +1,62 @@
+#pragma once
+
+#include <QColor>
+#include <QHash>
+#include <QImage>
+#include <QPoint>
+#include <QRect>
+#include <QString>
+
+class QIODevice;
+class QPainter;
+class QRawFont;
+
+namespace gomarky
+{
+
+/// Pre-rasterized glyphs of one font at one pixel size, packed into a single alpha mask.
+///
+/// Covers a fixed set of characters, one glyph per UTF-16 code unit, laid out left to right
+/// without shaping. Enough for plain UI labels in Latin scripts; anything else is drawn by Qt.
+/// Atlases can be written to disk so later runs skip rasterization entirely.
+class GlyphAtlas
+{
+public:
+    struct Glyph
+    {
+        QRect  source;  ///< in the mask
+        QPoint offset;  ///< of the mask rect's top-left from the pen position on the baseline
+        qreal  advance = 0;
+    };
+
+    /// Rasterize `characters` of `font`. Characters the font has no glyph for are left out.
+    static GlyphAtlas Build(const QRawFont& font, const QString& characters);
+
+    /// Read an atlas written by Save. Fails when the file is damaged or its `stamp` differs.
+    static bool Load(QIODevice& device, const QByteArray& stamp, GlyphAtlas& atlas);
+    bool        Save(QIODevice& device, const QByteArray& stamp) const;
+
+    bool         IsEmpty() const { return m_glyphs.isEmpty(); }
+    const Glyph* Find(QChar character) const;
+
+    /// True when every character of `text` is in the atlas.
+    bool Covers(const QString& text) const;
+
+    qreal Ascent() const { return m_ascent; }
+    qreal Descent() const { return m_descent; }
+    qreal Width(const QString& text) const;
+
+    /// Draw one line of text starting at `baseline`. Characters not in the atlas are skipped.
+    void Draw(QPainter& painter, const QPointF& baseline, const QString& text, const QColor& color) const;
+
+    const QImage& Mask() const { return m_mask; }
+
+private:
+    QImage                      m_mask; ///< Format_Alpha8
+    QHash<ushort, Glyph>        m_glyphs;
+    qreal                       m_ascent  = 0;
+    qreal                       m_descent = 0;
+    mutable QHash<QRgb, QImage> m_tinted; ///< mask filled with a color, by color
+};
+
+} // namespace gomarky
@@ -0,0 +1,61 @@
+#include "text/glyph_atlas_label.h"
+
+#include <QPainter>
+#include <QStyle>
+
+namespace gomarky
+{
+
+GlyphAtlasLabel::GlyphAtlasLabel(const QString& text, QWidget* parent) : QLabel(text, parent) {}
+
+void GlyphAtlasLabel::SetAtlas(std::shared_ptr<const GlyphAtlas> atlas)
+{
+    m_atlas = std::move(atlas);
+    update();
+}
+
+namespace
+{
+
+// Whether drawing glyphs one after another reproduces the text: no script that joins or reorders
+// characters, and no combining marks that would need positioning.
+bool NeedsShaping(const QString& text)
+{
+    for (const QChar character : text)
+    {
+        const QChar::Script script = character.script();
+        if (script != QChar::Script_Common && script != QChar::Script_Latin) return true;
+        if (character.isMark()) return true;
+    }
+    return false;
+}
+
+} // namespace
+
+bool GlyphAtlasLabel::CanUseAtlas() const
+{
+    if (!m_atlas || m_atlas->IsEmpty() || devicePixelRatioF() != 1.0) return false;
+    if (pixmap() && !pixmap()->isNull()) return false;
+    if (textFormat() == Qt::RichText || (textFormat() == Qt::AutoText && Qt::mightBeRichText(text()))) return false;
+    return !text().contains(QLatin1Char('\n')) && !NeedsShaping(text()) && m_atlas->Covers(text());
+}
+
+void GlyphAtlasLabel::paintEvent(QPaintEvent* event)
+{
+    if (!CanUseAtlas())
+    {
+        QLabel::paintEvent(event);
+        return;
+    }
+
+    QPainter painter(this);
+    drawFrame(&painter);
+
+    const QRect  contents = contentsRect().adjusted(margin(), margin(), -margin(), -margin());
+    const QSizeF text_size(m_atlas->Width(text()), m_atlas->Ascent() + m_atlas->Descent());
+    const QRect  text_rect = QStyle::alignedRect(layoutDirection(), alignment(), text_size.toSize(), contents);
+    const QColor color     = palette().color(foregroundRole());
+    m_atlas->Draw(painter, QPointF(text_rect.left(), text_rect.top() + m_atlas->Ascent()), text(), color);
+}
+
+} // namespace gomarky
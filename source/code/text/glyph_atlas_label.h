@@ -0,0 +1,36 @@
+#pragma once
+
+#include <memory>
+
+#include <QLabel>
+
+#include "text/glyph_atlas.h"
+
+namespace gomarky
+{
+
+/// QLabel that draws single-line plain text from a pre-rasterized GlyphAtlas.
+/// Glyphs are placed by their advances, without shaping or kerning, so pairs the font kerns come
+/// out a little wider than QLabel draws them. Falls back to QLabel's own painting for text that
+/// needs shaping (anything but Latin letters and common punctuation), rich text, several lines,
+/// missing characters, pixmaps, or a device pixel ratio other than 1.
+class GlyphAtlasLabel : public QLabel
+{
+    Q_OBJECT
+
+public:
+    explicit GlyphAtlasLabel(const QString& text, QWidget* parent = nullptr);
+
+    /// The atlas must have been built for this label's font.
+    void SetAtlas(std::shared_ptr<const GlyphAtlas> atlas);
+
+protected:
+    void paintEvent(QPaintEvent* event) override;
+
+private:
+    bool CanUseAtlas() const;
+
+    std::shared_ptr<const GlyphAtlas> m_atlas;
+};
+
+} // namespace gomarky
@@ -0,0 +1,139 @@
+#include "text/static_text_label.h"
+
+#include <algorithm>
+#include <cmath>
+
+#include <QEvent>
+#include <QPainter>
+#include <QStyle>
+
+#include "layout/layout_host.h"
+
+namespace gomarky
+{
+
+StaticTextLabel::StaticTextLabel(const QString& text, QWidget* parent)
+    : StaticTextLabel(text, TextLayoutCache::Global(), parent)
+{
+}
+
+StaticTextLabel::StaticTextLabel(const QString& text, TextLayoutCache& cache, QWidget* parent)
+    : QWidget(parent), m_cache(cache), m_text(text)
+{
+    setSizePolicy(QSizePolicy::Preferred, QSizePolicy::Preferred);
+}
+
+void StaticTextLabel::SetText(const QString& text)
+{
+    if (text == m_text) return;
+    m_text = text;
+    Relayout();
+}
+
+void StaticTextLabel::SetTextFormat(Qt::TextFormat format)
+{
+    m_format = format;
+    Relayout();
+}
+
+void StaticTextLabel::SetAlignment(Qt::Alignment alignment)
+{
+    m_alignment = alignment;
+    update();
+}
+
+void StaticTextLabel::SetWordWrap(bool wrap)
+{
+    m_word_wrap = wrap;
+    QSizePolicy policy = sizePolicy();
+    policy.setHeightForWidth(wrap);
+    setSizePolicy(policy);
+    Relayout();
+}
+
+void StaticTextLabel::SetMargin(int margin)
+{
+    m_margin = margin;
+    Relayout();
+}
+
+void StaticTextLabel::Relayout()
+{
+    m_layout.reset();
+    updateGeometry();
+    LayoutHost::NotifySizeHintChanged(this);
+    update();
+}
+
+TextLayoutCache::Layout StaticTextLabel::LayoutFor(int width) const
+{
+    const qreal ratio = devicePixelRatioF();
+    if (width < 0)
+    {
+        if (m_layout && m_layout_ratio == ratio) return m_layout;
+        m_layout       = LayoutFor(std::max(0, contentsRect().width() - 2 * m_margin));
+        m_layout_ratio = ratio;
+        return m_layout;
+    }
+    return m_cache.Find(m_text, font(), m_word_wrap ? qreal(width) : qreal(-1), ratio, m_format);
+}
+
+QSize StaticTextLabel::sizeHint() const
+{
+    // Unwrapped, the natural size; wrapped, the natural width capped like QLabel does.
+    const QSizeF natural = m_cache.Find(m_text, font(), -1, devicePixelRatioF(), m_format)->size();
+    QSize        size(static_cast<int>(std::ceil(natural.width())), static_cast<int>(std::ceil(natural.height())));
+    if (m_word_wrap && size.width() > 80 * fontMetrics().averageCharWidth())
+    {
+        size.setWidth(80 * fontMetrics().averageCharWidth());
+        size.setHeight(heightForWidth(size.width() + 2 * m_margin) - 2 * m_margin);
+    }
+    const QMargins margins = contentsMargins();
+    return size + QSize(2 * m_margin + margins.left() + margins.right(), 2 * m_margin + margins.top() + margins.bottom());
+}
+
+QSize StaticTextLabel::minimumSizeHint() const
+{
+    if (!m_word_wrap) return sizeHint();
+    const int word = 10 * fontMetrics().averageCharWidth();
+    return QSize(word + 2 * m_margin, heightForWidth(word + 2 * m_margin));
+}
+
+int StaticTextLabel::heightForWidth(int width) const
+{
+    if (!m_word_wrap) return QWidget::heightForWidth(width);
+    const QMargins margins = contentsMargins();
+    const int      content = width - margins.left() - margins.right() - 2 * m_margin;
+    const qreal    height  = LayoutFor(std::max(content, 1))->size().height();
+    return static_cast<int>(std::ceil(height)) + 2 * m_margin + margins.top() + margins.bottom();
+}
+
+void StaticTextLabel::paintEvent(QPaintEvent*)
+{
+    if (m_text.isEmpty()) return;
+
+    const TextLayoutCache::Layout layout = LayoutFor(-1);
+    const QRect                   area   = contentsRect().adjusted(m_margin, m_margin, -m_margin, -m_margin);
+    const QRect                   text   = QStyle::alignedRect(layoutDirection(), m_alignment,
+                                                               layout->size().toSize(), area);
+    QPainter painter(this);
+    painter.setFont(font());
+    painter.setPen(palette().color(foregroundRole()));
+    painter.setClipRect(area);
+    painter.drawStaticText(text.topLeft(), *layout);
+}
+
+void StaticTextLabel::changeEvent(QEvent* event)
+{
+    // The font is part of the cache key, so re-fetching is all a font change needs.
+    if (event->type() == QEvent::FontChange) Relayout();
+    QWidget::changeEvent(event);
+}
+
+void StaticTextLabel::resizeEvent(QResizeEvent* event)
+{
+    if (m_word_wrap) m_layout.reset();
+    QWidget::resizeEvent(event);
+}
+
+} // namespace gomarky
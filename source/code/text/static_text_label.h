@@ -0,0 +1,54 @@
+#pragma once
+
+#include <QWidget>
+
+#include "text/text_layout_cache.h"
+
+namespace gomarky
+{
+
+/// Lightweight label for text that rarely changes, such as dashboard captions.
+/// The shaped layout comes from a TextLayoutCache, so repaints only draw glyphs and labels showing
+/// the same text share one layout. Plain or rich text, optionally word-wrapped.
+class StaticTextLabel : public QWidget
+{
+    Q_OBJECT
+
+public:
+    explicit StaticTextLabel(const QString& text = QString(), QWidget* parent = nullptr);
+    StaticTextLabel(const QString& text, TextLayoutCache& cache, QWidget* parent = nullptr);
+
+    const QString& Text() const { return m_text; }
+    void           SetText(const QString& text);
+
+    void SetTextFormat(Qt::TextFormat format);
+    void SetAlignment(Qt::Alignment alignment);
+    void SetWordWrap(bool wrap);
+    void SetMargin(int margin);
+
+    QSize sizeHint() const override;
+    QSize minimumSizeHint() const override;
+    bool  hasHeightForWidth() const override { return m_word_wrap; }
+    int   heightForWidth(int width) const override;
+
+protected:
+    void paintEvent(QPaintEvent* event) override;
+    void changeEvent(QEvent* event) override;
+    void resizeEvent(QResizeEvent* event) override;
+
+private:
+    /// Layout for the given content width, or for the current one when `width` is negative.
+    TextLayoutCache::Layout LayoutFor(int width) const;
+    void                    Relayout();
+
+    TextLayoutCache&                m_cache;
+    QString                         m_text;
+    Qt::TextFormat                  m_format    = Qt::PlainText;
+    Qt::Alignment                   m_alignment = Qt::AlignLeft | Qt::AlignVCenter;
+    bool                            m_word_wrap = false;
+    int                             m_margin    = 0;
+    mutable TextLayoutCache::Layout m_layout; ///< for the current width, font and pixel ratio
+    mutable qreal                   m_layout_ratio = 0;
+};
+
+} // namespace gomarky
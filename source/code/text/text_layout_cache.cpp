@@ -0,0 +1,62 @@
+#include "text/text_layout_cache.h"
+
+#include <cmath>
+
+#include <QGuiApplication>
+#include <QTransform>
+
+namespace gomarky
+{
+
+namespace
+{
+
+int ToFixed(qreal value) { return value < 0 ? -1 : static_cast<int>(std::lround(value * 64)); }
+
+// QStaticText does not report its size, so estimate it from what it stores per glyph
+// (index, position, and the item it belongs to) plus the text and a fixed overhead.
+size_t EstimateBytes(const QString& text)
+{
+    return 256 + static_cast<size_t>(text.size()) * (sizeof(QChar) + 48);
+}
+
+} // namespace
+
+TextLayoutCache::TextLayoutCache(size_t budget_bytes) : m_cache(budget_bytes) {}
+
+TextLayoutCache& TextLayoutCache::Global()
+{
+    // Never destroyed: layouts hold font engines, which must not outlive the application.
+    static TextLayoutCache* cache = [] {
+        auto* instance = new TextLayoutCache();
+        // An added or removed application font may change what a font key resolves to.
+        QObject::connect(qGuiApp, &QGuiApplication::fontDatabaseChanged, [instance] { instance->Clear(); });
+        return instance;
+    }();
+    return *cache;
+}
+
+TextLayoutCache::Layout TextLayoutCache::Find(const QString& text, const QFont& font, qreal width,
+                                              qreal device_pixel_ratio, Qt::TextFormat format)
+{
+    Key key{text, font.key(), ToFixed(width), ToFixed(device_pixel_ratio), format};
+    if (Layout* cached = m_cache.Find(key))
+    {
+        ++m_hits;
+        return *cached;
+    }
+    ++m_misses;
+
+    auto layout = std::make_shared<QStaticText>(text);
+    layout->setTextFormat(format);
+    layout->setTextWidth(width);
+    layout->prepare(QTransform(), font);
+
+    Layout shared = std::move(layout);
+    m_cache.Insert(std::move(key), shared, EstimateBytes(text));
+    return shared;
+}
+
+void TextLayoutCache::Clear() { m_cache.Clear(); }
+
+} // namespace gomarky
@@ -0,0 +1,77 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+#include <QFont>
+#include <QStaticText>
+#include <QString>
+
+#include "assets/byte_lru_cache.h"
+
+namespace gomarky
+{
+
+/// Shaped text layouts shared by every widget that shows the same text.
+///
+/// Layouts are QStaticText objects prepared for a font, keyed by text, font, wrap width, device
+/// pixel ratio and text format. Since the font and ratio are part of the key, a font or DPI
+/// change simply stops hitting the old entries, which then age out of the byte budget; changes
+/// to the font database clear the cache. GUI thread only.
+class TextLayoutCache
+{
+public:
+    using Layout = std::shared_ptr<const QStaticText>;
+
+    static constexpr size_t kDefaultBudget = size_t(8) << 20;
+
+    explicit TextLayoutCache(size_t budget_bytes = kDefaultBudget);
+
+    /// Shared by the widgets that do not get a cache injected.
+    static TextLayoutCache& Global();
+
+    /// The layout of `text`, shaped now on a miss. `width < 0` lays out a single unwrapped line.
+    Layout Find(const QString& text, const QFont& font, qreal width = -1, qreal device_pixel_ratio = 1,
+                Qt::TextFormat format = Qt::PlainText);
+
+    void Clear();
+
+    void   SetBudget(size_t budget_bytes) { m_cache.SetBudget(budget_bytes); }
+    size_t UsedBytes() const { return m_cache.UsedBytes(); }
+    size_t Size() const { return m_cache.Size(); }
+
+    uint64_t Hits() const { return m_hits; }
+    uint64_t Misses() const { return m_misses; }
+
+private:
+    struct Key
+    {
+        QString        text;
+        QString        font;
+        int            width;              ///< in 1/64 px, -1 when unwrapped
+        int            device_pixel_ratio; ///< in 1/64
+        Qt::TextFormat format;
+
+        bool operator==(const Key& other) const
+        {
+            return width == other.width && device_pixel_ratio == other.device_pixel_ratio && format == other.format &&
+                   text == other.text && font == other.font;
+        }
+    };
+
+    struct KeyHash
+    {
+        size_t operator()(const Key& key) const
+        {
+            const uint seed = uint(key.width) * 31u + uint(key.device_pixel_ratio) * 7u + uint(key.format);
+            return qHash(key.text, qHash(key.font, seed));
+        }
+    };
+
+    ByteLruCache<Key, Layout, KeyHash> m_cache;
+    uint64_t                           m_hits   = 0;
+    uint64_t                           m_misses = 0;
+};
+
+} // namespace gomarky
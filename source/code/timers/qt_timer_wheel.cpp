@@ -0,0 +1,63 @@
+#include "timers/qt_timer_wheel.h"
+
+#include <algorithm>
+#include <climits>
+#include <utility>
+
+namespace gomarky
+{
+
+QtTimerWheel::QtTimerWheel(uint32_t tick_ms) : m_wheel(tick_ms)
+{
+    m_clock.start();
+    m_timer.setSingleShot(true);
+    m_timer.setTimerType(Qt::PreciseTimer); // the wheel's ticks already provide the coarsening
+    QObject::connect(&m_timer, &QTimer::timeout, [this] { OnTimeout(); });
+}
+
+QtTimerWheel::TimerId QtTimerWheel::Schedule(uint64_t delay_ms, TimerWheel::Callback callback)
+{
+    const TimerId timer = m_wheel.Schedule(delay_ms + Lag(), std::move(callback));
+    Arm(m_wheel.Deadline(timer));
+    return timer;
+}
+
+QtTimerWheel::TimerId QtTimerWheel::ScheduleRepeating(uint64_t interval_ms, TimerWheel::Callback callback)
+{
+    // The first period absorbs the lag; later ones are counted from the previous expiry.
+    const TimerId timer = m_wheel.ScheduleRepeating(interval_ms, std::move(callback));
+    m_wheel.Restart(timer, interval_ms + Lag());
+    Arm(m_wheel.Deadline(timer));
+    return timer;
+}
+
+bool QtTimerWheel::Restart(TimerId timer, uint64_t delay_ms)
+{
+    if (!m_wheel.Restart(timer, delay_ms + Lag())) return false;
+    Arm(m_wheel.Deadline(timer));
+    return true;
+}
+
+uint64_t QtTimerWheel::Lag() const
+{
+    const uint64_t now = static_cast<uint64_t>(m_clock.elapsed());
+    return now > m_wheel.Now() ? now - m_wheel.Now() : 0;
+}
+
+void QtTimerWheel::Arm(uint64_t deadline_ms)
+{
+    if (deadline_ms >= m_armed) return;
+    m_armed             = deadline_ms;
+    const uint64_t now  = static_cast<uint64_t>(m_clock.elapsed());
+    const uint64_t wait = deadline_ms > now ? deadline_ms - now : 0;
+    m_timer.start(static_cast<int>(std::min<uint64_t>(wait, INT_MAX)));
+}
+
+void QtTimerWheel::OnTimeout()
+{
+    m_armed = UINT64_MAX;
+    m_wheel.Advance(static_cast<uint64_t>(m_clock.elapsed()));
+    Arm(m_wheel.NextWakeup());
+}
+
+} // namespace gomarky
@@ -0,0 +1,43 @@
+#pragma once
+
+#include <cstdint>
+
+#include <QElapsedTimer>
+#include <QTimer>
+
+#include "timers/timer_wheel.h"
+
+namespace gomarky
+{
+
+/// A TimerWheel on the event loop: one QTimer, armed for the wheel's next wakeup, stands in for
+/// any number of timers. Arming or cancelling a timer never touches the event dispatcher unless
+/// the new timer is due before everything already armed.
+class QtTimerWheel
+{
+public:
+    using TimerId = TimerWheel::TimerId;
+
+    /// Lives on, and fires callbacks on, the thread that creates it.
+    explicit QtTimerWheel(uint32_t tick_ms = 1);
+
+    TimerId Schedule(uint64_t delay_ms, TimerWheel::Callback callback);
+    TimerId ScheduleRepeating(uint64_t interval_ms, TimerWheel::Callback callback);
+    bool    Restart(TimerId timer, uint64_t delay_ms);
+    bool    Cancel(TimerId timer) { return m_wheel.Cancel(timer); }
+    bool    Pending(TimerId timer) const { return m_wheel.Pending(timer); }
+    size_t  Size() const { return m_wheel.Size(); }
+
+private:
+    // Milliseconds the wheel is behind the clock; added to delays so they count from now.
+    uint64_t Lag() const;
+    void     Arm(uint64_t deadline_ms);
+    void     OnTimeout();
+
+    QElapsedTimer m_clock;
+    TimerWheel    m_wheel;
+    QTimer        m_timer;
+    uint64_t      m_armed = UINT64_MAX; ///< wheel time the QTimer is set for
+};
+
+} // namespace gomarky
@@ -0,0 +1,285 @@
+#include "timers/timer_wheel.h"
+
+#include <algorithm>
+#include <utility>
+
+namespace gomarky
+{
+
+constexpr TimerWheel::TimerId TimerWheel::kInvalidTimer;
+constexpr int                 TimerWheel::kLevels;
+constexpr int                 TimerWheel::kSlotBits;
+constexpr int                 TimerWheel::kSlots;
+constexpr uint32_t            TimerWheel::kNone;
+constexpr uint16_t            TimerWheel::kExpiring;
+constexpr uint16_t            TimerWheel::kOverflow;
+constexpr uint16_t            TimerWheel::kFree;
+constexpr uint16_t            TimerWheel::kListCount;
+
+namespace
+{
+
+int CountTrailingZeros(uint64_t word)
+{
+#if defined(__GNUC__)
+    return __builtin_ctzll(word);
+#else
+    int count = 0;
+    for (; !(word & 1); word >>= 1) ++count;
+    return count;
+#endif
+}
+
+// Bits of `occupied` strictly above `digit`.
+uint64_t SlotsAfter(uint64_t occupied, uint64_t digit)
+{
+    return digit + 1 >= 64 ? 0 : occupied & (~uint64_t(0) << (digit + 1));
+}
+
+} // namespace
+
+TimerWheel::TimerWheel(uint32_t tick_ms, uint64_t now_ms) : m_tick_ms(std::max<uint32_t>(tick_ms, 1))
+{
+    m_tick   = now_ms / m_tick_ms;
+    m_target = m_tick;
+    std::fill(std::begin(m_heads), std::end(m_heads), kNone);
+}
+
+TimerWheel::TimerId TimerWheel::Schedule(uint64_t delay_ms, Callback callback)
+{
+    return Add(DelayTicks(delay_ms), 0, std::move(callback));
+}
+
+TimerWheel::TimerId TimerWheel::ScheduleRepeating(uint64_t interval_ms, Callback callback)
+{
+    const uint64_t interval = DelayTicks(interval_ms);
+    return Add(interval, interval, std::move(callback));
+}
+
+bool TimerWheel::Restart(TimerId timer, uint64_t delay_ms)
+{
+    const uint32_t index = Find(timer);
+    if (index == kNone) return false;
+    Unlink(index);
+    m_nodes[index].deadline = m_tick + DelayTicks(delay_ms);
+    Place(index);
+    return true;
+}
+
+bool TimerWheel::Cancel(TimerId timer)
+{
+    const uint32_t index = Find(timer);
+    if (index == kNone) return false;
+    Unlink(index);
+    Release(index);
+    return true;
+}
+
+bool TimerWheel::Pending(TimerId timer) const { return Find(timer) != kNone; }
+
+uint64_t TimerWheel::Deadline(TimerId timer) const
+{
+    const uint32_t index = Find(timer);
+    return index == kNone ? UINT64_MAX : m_nodes[index].deadline * m_tick_ms;
+}
+
+size_t TimerWheel::Advance(uint64_t now_ms)
+{
+    m_target = std::max(m_tick, now_ms / m_tick_ms);
+    size_t fired = 0;
+    while (m_tick < m_target)
+    {
+        const uint64_t next = NextEventTick();
+        if (next > m_target)
+        {
+            m_tick = m_target;
+            break;
+        }
+        m_tick = next;
+        fired += FireTick();
+    }
+    return fired;
+}
+
+uint64_t TimerWheel::NextWakeup() const
+{
+    const uint64_t tick = NextEventTick();
+    return tick == UINT64_MAX ? tick : tick * m_tick_ms;
+}
+
+uint64_t TimerWheel::DelayTicks(uint64_t delay_ms) const
+{
+    return std::max<uint64_t>((delay_ms + m_tick_ms - 1) / m_tick_ms, 1);
+}
+
+TimerWheel::TimerId TimerWheel::Add(uint64_t delay_ticks, uint64_t interval_ticks, Callback callback)
+{
+    uint32_t index = m_free;
+    if (index != kNone)
+    {
+        m_free = m_nodes[index].next;
+    }
+    else
+    {
+        index = static_cast<uint32_t>(m_nodes.size());
+        m_nodes.emplace_back();
+    }
+    Node& node    = m_nodes[index];
+    node.deadline = m_tick + delay_ticks;
+    node.interval = interval_ticks;
+    node.callback = std::move(callback);
+    Place(index);
+    ++m_size;
+    return (TimerId(node.version) << 32) | (index + 1);
+}
+
+uint32_t TimerWheel::Find(TimerId timer) const
+{
+    const uint32_t index = static_cast<uint32_t>(timer) - 1;
+    if (index >= m_nodes.size()) return kNone;
+    const Node& node = m_nodes[index];
+    return node.list != kFree && node.version == static_cast<uint32_t>(timer >> 32) ? index : kNone;
+}
+
+void TimerWheel::Place(uint32_t index)
+{
+    // The coarsest level whose higher digits match the present: the timer's digit there is still
+    // ahead of the wheel's, so the slot will be reached before the deadline passes.
+    const uint64_t deadline = m_nodes[index].deadline;
+    for (int level = 0; level < kLevels; ++level)
+    {
+        const int shift = kSlotBits * (level + 1);
+        if ((deadline >> shift) == (m_tick >> shift))
+        {
+            const uint64_t digit = (deadline >> (kSlotBits * level)) & (kSlots - 1);
+            Link(index, static_cast<uint16_t>(level * kSlots + digit));
+            return;
+        }
+    }
+    Link(index, kOverflow);
+}
+
+void TimerWheel::Link(uint32_t index, uint16_t list)
+{
+    Node& node = m_nodes[index];
+    node.list  = list;
+    node.prev  = kNone;
+    node.next  = m_heads[list];
+    if (node.next != kNone) m_nodes[node.next].prev = index;
+    m_heads[list] = index;
+    if (list < kLevels * kSlots) m_occupied[list / kSlots] |= uint64_t(1) << (list % kSlots);
+}
+
+void TimerWheel::Unlink(uint32_t index)
+{
+    Node&          node = m_nodes[index];
+    const uint16_t list = node.list;
+    if (node.prev != kNone) m_nodes[node.prev].next = node.next;
+    else m_heads[list] = node.next;
+    if (node.next != kNone) m_nodes[node.next].prev = node.prev;
+    if (m_heads[list] == kNone && list < kLevels * kSlots)
+    {
+        m_occupied[list / kSlots] &= ~(uint64_t(1) << (list % kSlots));
+    }
+}
+
+void TimerWheel::Release(uint32_t index)
+{
+    Node& node = m_nodes[index];
+    ++node.version;
+    node.list     = kFree;
+    node.callback = nullptr;
+    node.next     = m_free;
+    m_free        = index;
+    --m_size;
+}
+
+void TimerWheel::Cascade(uint16_t list)
+{
+    uint32_t index = m_heads[list];
+    m_heads[list]  = kNone;
+    if (list < kLevels * kSlots) m_occupied[list / kSlots] &= ~(uint64_t(1) << (list % kSlots));
+    while (index != kNone)
+    {
+        const uint32_t next = m_nodes[index].next;
+        Place(index);
+        index = next;
+    }
+}
+
+uint64_t TimerWheel::NextEventTick() const
+{
+    uint64_t next = UINT64_MAX;
+    for (int level = 0; level < kLevels; ++level)
+    {
+        const int      shift = kSlotBits * level;
+        const uint64_t ahead = SlotsAfter(m_occupied[level], (m_tick >> shift) & (kSlots - 1));
+        if (!ahead) continue;
+        // Level 0 slots fire at their tick; coarser slots are redistributed when their range starts.
+        const int      group = shift + kSlotBits;
+        const uint64_t tick  = ((m_tick >> group) << group) + (uint64_t(CountTrailingZeros(ahead)) << shift);
+        next                 = std::min(next, tick);
+    }
+    if (m_heads[kOverflow] != kNone)
+    {
+        const int top = kSlotBits * kLevels;
+        next          = std::min(next, ((m_tick >> top) + 1) << top);
+    }
+    return next;
+}
+
+size_t TimerWheel::FireTick()
+{
+    // Redistribute from the top down, so a timer cascading two levels lands in a slot that is
+    // itself cascaded (or fired) later in this same tick.
+    for (int level = kLevels; level >= 1; --level)
+    {
+        const int shift = kSlotBits * level;
+        if (m_tick & ((uint64_t(1) << shift) - 1)) continue;
+        if (level == kLevels) Cascade(kOverflow);
+        else Cascade(static_cast<uint16_t>(level * kSlots + ((m_tick >> shift) & (kSlots - 1))));
+    }
+
+    // Move the due slot aside first, so callbacks can add timers to the wheel and cancel ones
+    // that are about to fire.
+    const uint16_t slot  = static_cast<uint16_t>(m_tick & (kSlots - 1));
+    uint32_t       index = m_heads[slot];
+    m_heads[slot]        = kNone;
+    m_occupied[0] &= ~(uint64_t(1) << slot);
+    while (index != kNone)
+    {
+        const uint32_t next = m_nodes[index].next;
+        Link(index, kExpiring);
+        index = next;
+    }
+
+    size_t fired = 0;
+    while ((index = m_heads[kExpiring]) != kNone)
+    {
+        Unlink(index);
+        Node&          node     = m_nodes[index];
+        Callback       callback = std::move(node.callback);
+        const uint64_t interval = node.interval;
+        TimerId        id       = kInvalidTimer;
+        if (interval)
+        {
+            // Keep repeating timers armed while their callback runs so that it can cancel or
+            // restart them. Periods that already passed are skipped.
+            node.deadline += interval;
+            if (node.deadline <= m_target) node.deadline += ((m_target - node.deadline) / interval + 1) * interval;
+            id = (TimerId(node.version) << 32) | (index + 1);
+            Place(index);
+        }
+        else
+        {
+            Release(index);
+        }
+        ++fired;
+        if (callback) callback();
+        // The slab may have grown, and the timer may be gone, so look it up again.
+        if (interval && Find(id) != kNone && !m_nodes[index].callback) m_nodes[index].callback = std::move(callback);
+    }
+    return fired;
+}
+
+} // namespace gomarky
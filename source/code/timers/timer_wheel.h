@@ -0,0 +1,107 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+namespace gomarky
+{
+
+/// Hierarchical timer wheel: thousands of timeouts for the cost of one clock.
+///
+/// Time advances in ticks of a fixed number of milliseconds, and every timer due in the same tick
+/// fires in the same Advance() call. Six levels of 64 slots each cover 2^36 ticks; a timer sits in
+/// the coarsest slot that still tells it apart from the present, and is pushed one level down
+/// whenever the wheel reaches that slot. Arming, restarting and cancelling are O(1) list
+/// operations on a slab of nodes, and per-level occupancy bitmaps let Advance() jump straight over
+/// idle stretches.
+///
+/// The wheel does not read a clock itself; whoever drives it passes the current time to Advance()
+/// (see QtTimerWheel). Callbacks run inside Advance() and may arm, restart and cancel timers,
+/// including their own.
+class TimerWheel
+{
+public:
+    using TimerId  = uint64_t;
+    using Callback = std::function<void()>;
+
+    static constexpr TimerId kInvalidTimer = 0;
+
+    explicit TimerWheel(uint32_t tick_ms = 1, uint64_t now_ms = 0);
+
+    /// Fire `callback` once, `delay_ms` from Now(), rounded up to whole ticks and at least one tick.
+    TimerId Schedule(uint64_t delay_ms, Callback callback);
+
+    /// Fire `callback` every `interval_ms`, first `interval_ms` from Now(). Periods missed because
+    /// Advance() came late are skipped, so a repeating timer fires at most once per Advance().
+    TimerId ScheduleRepeating(uint64_t interval_ms, Callback callback);
+
+    /// Move a pending timer to `delay_ms` from Now(), e.g. to restart a debounce. For repeating
+    /// timers only the next expiry moves. False if the timer already fired or was cancelled.
+    bool Restart(TimerId timer, uint64_t delay_ms);
+
+    /// False if the timer already fired or was cancelled.
+    bool Cancel(TimerId timer);
+
+    bool Pending(TimerId timer) const;
+
+    /// When a pending timer is due, in milliseconds; UINT64_MAX if it is not pending.
+    uint64_t Deadline(TimerId timer) const;
+
+    /// Move the clock to `now_ms` and run every callback due by then, tick by tick; timers sharing
+    /// a tick run in no particular order. Returns the number of callbacks run. Not reentrant.
+    size_t Advance(uint64_t now_ms);
+
+    /// When the next Advance() may have something to do: the earliest deadline, or the earlier
+    /// moment at which a coarse slot has to be redistributed. UINT64_MAX when nothing is armed.
+    uint64_t NextWakeup() const;
+
+    /// The time of the last tick reached, in milliseconds.
+    uint64_t Now() const { return m_tick * m_tick_ms; }
+    uint32_t TickMilliseconds() const { return m_tick_ms; }
+    size_t   Size() const { return m_size; }
+
+private:
+    static constexpr int      kLevels    = 6;
+    static constexpr int      kSlotBits  = 6;
+    static constexpr int      kSlots     = 1 << kSlotBits;
+    static constexpr uint32_t kNone      = UINT32_MAX;
+    static constexpr uint16_t kExpiring  = kLevels * kSlots;     ///< list of a slot being fired
+    static constexpr uint16_t kOverflow  = kLevels * kSlots + 1; ///< beyond the top level
+    static constexpr uint16_t kFree      = kLevels * kSlots + 2;
+    static constexpr uint16_t kListCount = kLevels * kSlots + 2;
+
+    struct Node
+    {
+        uint64_t deadline = 0; ///< in ticks
+        uint64_t interval = 0; ///< in ticks, 0 for one-shot timers
+        uint32_t prev     = kNone;
+        uint32_t next     = kNone;
+        uint32_t version  = 1; ///< bumped on release so stale ids stop matching
+        uint16_t list     = kFree;
+        Callback callback;
+    };
+
+    uint64_t DelayTicks(uint64_t delay_ms) const;
+    TimerId  Add(uint64_t delay_ticks, uint64_t interval_ticks, Callback callback);
+    uint32_t Find(TimerId timer) const;
+    void     Place(uint32_t index);
+    void     Link(uint32_t index, uint16_t list);
+    void     Unlink(uint32_t index);
+    void     Release(uint32_t index);
+    void     Cascade(uint16_t list);
+    uint64_t NextEventTick() const;
+    size_t   FireTick();
+
+    uint32_t          m_tick_ms;
+    uint64_t          m_tick   = 0;
+    uint64_t          m_target = 0; ///< tick the running Advance() stops at
+    size_t            m_size   = 0;
+    std::vector<Node> m_nodes;
+    uint32_t          m_free = kNone;
+    uint32_t          m_heads[kListCount];
+    uint64_t          m_occupied[kLevels] = {}; ///< bit per non-empty slot
+};
+
+} // namespace gomarky
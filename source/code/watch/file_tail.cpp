@@ -0,0 +1,180 @@
+#include "watch/file_tail.h"
+
+#include <algorithm>
+#include <cstring>
+
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+
+#if defined(_WIN32)
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
+
+namespace gomarky
+{
+
+namespace
+{
+
+constexpr size_t kTailBytes = 64;
+
+#if defined(_WIN32)
+using StatBuffer = struct _stat64;
+int  StatPath(const std::string& path, StatBuffer& buffer) { return _stat64(path.c_str(), &buffer); }
+int  StatFile(int fd, StatBuffer& buffer) { return _fstat64(fd, &buffer); }
+int  OpenRead(const std::string& path) { return _open(path.c_str(), _O_RDONLY | _O_BINARY); }
+void CloseFile(int fd) { _close(fd); }
+// Windows has no inode numbers in stat; the creation time tells a replacement apart instead.
+uint64_t FileId(const StatBuffer& buffer) { return static_cast<uint64_t>(buffer.st_ctime); }
+#else
+using StatBuffer = struct stat;
+int  StatPath(const std::string& path, StatBuffer& buffer) { return stat(path.c_str(), &buffer); }
+int  StatFile(int fd, StatBuffer& buffer) { return fstat(fd, &buffer); }
+int  OpenRead(const std::string& path) { return open(path.c_str(), O_RDONLY | O_CLOEXEC); }
+void CloseFile(int fd) { close(fd); }
+uint64_t FileId(const StatBuffer& buffer) { return static_cast<uint64_t>(buffer.st_ino); }
+#endif
+
+} // namespace
+
+FileTail::FileTail(std::string path, size_t chunk_size)
+    : m_path(std::move(path)), m_chunk_size(std::max<size_t>(chunk_size, 4096))
+{
+}
+
+FileTail::~FileTail() { Close(); }
+
+bool FileTail::Open(Identity& identity)
+{
+    m_fd = OpenRead(m_path);
+    if (m_fd < 0) return false;
+    StatBuffer buffer;
+    if (StatFile(m_fd, buffer) != 0)
+    {
+        Close();
+        return false;
+    }
+    identity.device = static_cast<uint64_t>(buffer.st_dev);
+    identity.file   = FileId(buffer);
+    return true;
+}
+
+void FileTail::Close()
+{
+    if (m_fd >= 0) CloseFile(m_fd);
+    m_fd = -1;
+}
+
+int64_t FileTail::ReadAt(uint64_t offset, char* data, size_t size) const
+{
+#if defined(_WIN32)
+    // Only one thread polls, so seeking the shared file position is fine.
+    if (_lseeki64(m_fd, static_cast<__int64>(offset), SEEK_SET) < 0) return -1;
+    return _read(m_fd, data, static_cast<unsigned>(std::min<size_t>(size, 1u << 30)));
+#else
+    return pread(m_fd, data, size, static_cast<off_t>(offset));
+#endif
+}
+
+bool FileTail::StillSameContent() const
+{
+    // A file truncated and written again past the old size keeps growing as far as its size goes,
+    // but the bytes before the offset change.
+    if (m_tail.empty()) return true;
+    char         current[kTailBytes];
+    const size_t size = m_tail.size();
+    return ReadAt(m_offset - size, current, size) == static_cast<int64_t>(size) &&
+           std::memcmp(current, m_tail.data(), size) == 0;
+}
+
+void FileTail::Rewind()
+{
+    m_offset = 0;
+    m_buffer.clear();
+    m_tail.clear();
+}
+
+FileTail::Update FileTail::Poll(const LineSink& sink, const std::function<void()>& restart)
+{
+    Update update;
+    auto   start_over = [&] {
+        Rewind();
+        update.restarted = true;
+        if (restart) restart();
+    };
+
+    StatBuffer named;
+    if (StatPath(m_path, named) != 0)
+    {
+        Close();
+        if (m_offset > 0) start_over();
+        update.missing = true;
+        return update;
+    }
+
+    // Another file under the same name, e.g. after rotation: follow the name.
+    const Identity current{static_cast<uint64_t>(named.st_dev), FileId(named)};
+    bool           replaced = false;
+    if (m_fd >= 0 && current != m_identity)
+    {
+        Close();
+        replaced = true;
+    }
+    if (m_fd < 0)
+    {
+        Identity identity;
+        if (!Open(identity))
+        {
+            if (m_offset > 0) start_over();
+            update.missing = true;
+            return update;
+        }
+        replaced   = replaced || (m_offset > 0 && identity != m_identity);
+        m_identity = identity;
+    }
+
+    StatBuffer opened;
+    if (StatFile(m_fd, opened) != 0) return update;
+    const uint64_t size = static_cast<uint64_t>(opened.st_size);
+    if (replaced || size < m_offset || !StillSameContent()) start_over();
+
+    while (m_offset < size)
+    {
+        const size_t held = m_buffer.size();
+        const size_t want = static_cast<size_t>(std::min<uint64_t>(m_chunk_size, size - m_offset));
+        m_buffer.resize(held + want);
+        const int64_t got = ReadAt(m_offset, m_buffer.data() + held, want);
+        if (got <= 0)
+        {
+            m_buffer.resize(held);
+            break;
+        }
+        m_buffer.resize(held + static_cast<size_t>(got));
+        m_offset += static_cast<uint64_t>(got);
+        update.bytes += static_cast<uint64_t>(got);
+
+        // Everything up to the last line break goes out; the rest waits for the next chunk.
+        size_t complete = m_buffer.size();
+        while (complete > held && m_buffer[complete - 1] != '\n') --complete;
+        if (complete > held)
+        {
+            if (sink) sink(m_buffer.data(), complete);
+            m_buffer.erase(m_buffer.begin(), m_buffer.begin() + static_cast<std::ptrdiff_t>(complete));
+        }
+    }
+
+    if (update.bytes)
+    {
+        m_tail.resize(static_cast<size_t>(std::min<uint64_t>(kTailBytes, m_offset)));
+        if (ReadAt(m_offset - m_tail.size(), m_tail.data(), m_tail.size()) != static_cast<int64_t>(m_tail.size()))
+        {
+            m_tail.clear();
+        }
+    }
+    return update;
+}
+
+} // namespace gomarky
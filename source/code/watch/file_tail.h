@@ -0,0 +1,70 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+
+namespace gomarky
+{
+
+/// Reads a file that other programs append to, one piece at a time: every Poll reads only what
+/// was added since the previous one, so following a large log costs what it grows by.
+///
+/// Reading starts over from the beginning when the file was truncated, rewritten or replaced by
+/// another one (log rotation, an editor saving through a temporary file). Not thread safe.
+class FileTail
+{
+public:
+    struct Update
+    {
+        bool     restarted = false; ///< reading started over from the beginning of the file
+        bool     missing   = false; ///< the file does not exist right now
+        uint64_t bytes     = 0;     ///< bytes read by this call
+    };
+
+    /// Complete lines, each with its line break, several at a time.
+    using LineSink = std::function<void(const char* text, size_t size)>;
+
+    explicit FileTail(std::string path, size_t chunk_size = size_t(1) << 20);
+    FileTail(const FileTail&) = delete;
+    FileTail& operator=(const FileTail&) = delete;
+    ~FileTail();
+
+    /// Hand the lines appended since the last call to `sink`. A last line without a line break
+    /// is held back until it is complete. `restart` runs before the lines of a file that is read
+    /// from the beginning again, and when the file disappears.
+    Update Poll(const LineSink& sink, const std::function<void()>& restart = {});
+
+    const std::string& Path() const { return m_path; }
+    /// Bytes of the file consumed so far, including a held back partial line.
+    uint64_t Offset() const { return m_offset; }
+
+private:
+    struct Identity
+    {
+        uint64_t device = 0;
+        uint64_t file   = 0;
+
+        bool operator==(const Identity& other) const { return device == other.device && file == other.file; }
+        bool operator!=(const Identity& other) const { return !(*this == other); }
+    };
+
+    bool    Open(Identity& identity);
+    void    Close();
+    int64_t ReadAt(uint64_t offset, char* data, size_t size) const;
+    bool    StillSameContent() const;
+    void    Rewind();
+
+    const std::string m_path;
+    const size_t      m_chunk_size;
+
+    int               m_fd = -1;
+    Identity          m_identity;
+    uint64_t          m_offset = 0;
+    std::vector<char> m_buffer;  ///< partial last line, then the chunk being read
+    std::vector<char> m_tail;    ///< last bytes before m_offset, to notice a rewrite of the same size
+};
+
+} // namespace gomarky
@@ -0,0 +1,477 @@
+#include "watch/file_watcher.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <cstdlib>
+#include <memory>
+#include <system_error>
+#include <utility>
+#include <vector>
+
+#include <sys/stat.h>
+#include <sys/types.h>
+
+#include "concurrency/worker_pool.h"
+
+#if defined(__linux__)
+#include <poll.h>
+#include <sys/eventfd.h>
+#include <sys/inotify.h>
+#include <unistd.h>
+#endif
+
+namespace gomarky
+{
+
+namespace
+{
+
+#if defined(__linux__)
+constexpr uint32_t kReplacedMask = IN_CREATE | IN_MOVED_TO;
+constexpr uint32_t kRemovedMask  = IN_DELETE | IN_MOVED_FROM;
+constexpr uint32_t kWatchMask    = IN_MODIFY | kReplacedMask | kRemovedMask | IN_MOVE_SELF | IN_ONLYDIR;
+#endif
+
+void SplitPath(const std::string& path, std::string& directory, std::string& name)
+{
+    const size_t slash = path.find_last_of("/\\");
+    if (slash == std::string::npos)
+    {
+        directory = ".";
+        name      = path;
+        return;
+    }
+    directory = slash == 0 ? path.substr(0, 1) : path.substr(0, slash);
+    name      = path.substr(slash + 1);
+}
+
+// inotify keeps one watch per directory however it is spelled, so directories are keyed by their
+// real path. A directory that does not resolve is left for inotify_add_watch to report.
+std::string RealDirectory(const std::string& directory)
+{
+#if defined(__linux__)
+    std::unique_ptr<char, void (*)(void*)> resolved(realpath(directory.c_str(), nullptr), std::free);
+    if (resolved) return resolved.get();
+#endif
+    return directory;
+}
+
+} // namespace
+
+/// Shared with dispatched callbacks, which may still be queued after Unwatch or the watcher itself.
+struct FileWatcher::Subscription
+{
+    std::atomic<bool> active{true};
+    Callback          callback;
+};
+
+FileWatcher::FileWatcher(const Options& options) : m_options(options)
+{
+#if defined(__linux__)
+    if (!m_options.force_polling)
+    {
+        m_inotify = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+        if (m_inotify >= 0)
+        {
+            m_wake = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+            if (m_wake < 0)
+            {
+                close(m_inotify);
+                m_inotify = -1;
+            }
+        }
+    }
+#endif
+    m_thread = std::thread([this] { Loop(); });
+}
+
+FileWatcher::~FileWatcher()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stop = true;
+    }
+    Wake();
+    m_thread.join();
+#if defined(__linux__)
+    if (m_inotify >= 0) close(m_inotify);
+    if (m_wake >= 0) close(m_wake);
+#endif
+}
+
+std::string FileWatcher::LastError() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_last_error;
+}
+
+const char* FileWatcher::BackendName() const
+{
+    switch (GetBackend())
+    {
+    case Backend::Inotify: return "inotify";
+    case Backend::Polling: return "polling";
+    }
+    return "";
+}
+
+FileWatcher::Snapshot FileWatcher::Stat(const std::string& path)
+{
+    Snapshot snapshot;
+#if defined(_WIN32)
+    struct _stat64 buffer;
+    if (_stat64(path.c_str(), &buffer) != 0) return snapshot;
+    snapshot.file = static_cast<uint64_t>(buffer.st_ctime); // no inode numbers on Windows
+#else
+    struct stat buffer;
+    if (stat(path.c_str(), &buffer) != 0) return snapshot;
+    snapshot.file = static_cast<uint64_t>(buffer.st_ino);
+#endif
+    snapshot.exists = true;
+    snapshot.device = static_cast<uint64_t>(buffer.st_dev);
+    snapshot.size   = static_cast<uint64_t>(buffer.st_size);
+    snapshot.mtime  = static_cast<int64_t>(buffer.st_mtime);
+    return snapshot;
+}
+
+uint64_t FileWatcher::Watch(const std::string& path, Callback callback)
+{
+    Entry entry;
+    entry.path                   = path;
+    entry.subscription           = std::make_shared<Subscription>();
+    entry.subscription->callback = std::move(callback);
+    SplitPath(path, entry.directory, entry.name);
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (m_inotify >= 0)
+    {
+        entry.directory = RealDirectory(entry.directory);
+        AddDirectory(entry.directory);
+    }
+    else if (!m_snapshots.count(path)) m_snapshots[path] = Stat(path);
+
+    const uint64_t id = m_next_id++;
+    m_entries.emplace(id, std::move(entry));
+    return id;
+}
+
+void FileWatcher::Unwatch(uint64_t id)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    auto it = m_entries.find(id);
+    if (it == m_entries.end()) return;
+    it->second.subscription->active = false;
+
+    const std::string path      = it->second.path;
+    const std::string directory = it->second.directory;
+    m_entries.erase(it);
+    if (m_inotify >= 0) RemoveDirectory(directory);
+
+    const bool still_watched =
+        std::any_of(m_entries.begin(), m_entries.end(),
+                    [&path](const std::pair<const uint64_t, Entry>& entry) { return entry.second.path == path; });
+    if (!still_watched)
+    {
+        m_snapshots.erase(path);
+        m_pending.erase(path);
+    }
+}
+
+void FileWatcher::AddDirectory(const std::string& directory)
+{
+#if defined(__linux__)
+    if (m_directory_users[directory]++ > 0) return;
+    const int wd = inotify_add_watch(m_inotify, directory.c_str(), kWatchMask);
+    if (wd < 0)
+    {
+        const int error = errno;
+        m_directory_users.erase(directory);
+        throw std::system_error(error, std::generic_category(), "inotify_add_watch " + directory);
+    }
+    m_directories[directory] = wd;
+    m_watch_directories[wd]  = directory;
+#else
+    (void)directory;
+#endif
+}
+
+void FileWatcher::RemoveDirectory(const std::string& directory)
+{
+#if defined(__linux__)
+    auto users = m_directory_users.find(directory);
+    if (users == m_directory_users.end() || --users->second > 0) return;
+    m_directory_users.erase(users);
+    m_lost_directories.erase(directory);
+    auto wd = m_directories.find(directory);
+    if (wd == m_directories.end()) return; // the directory went away already
+    inotify_rm_watch(m_inotify, wd->second);
+    m_watch_directories.erase(wd->second);
+    m_directories.erase(wd);
+#else
+    (void)directory;
+#endif
+}
+
+void FileWatcher::RearmDirectories()
+{
+#if defined(__linux__)
+    for (auto it = m_lost_directories.begin(); it != m_lost_directories.end();)
+    {
+        const int wd = inotify_add_watch(m_inotify, it->c_str(), kWatchMask);
+        if (wd < 0)
+        {
+            ++it;
+            continue;
+        }
+        m_directories[*it]      = wd;
+        m_watch_directories[wd] = *it;
+
+        // Whatever was created in the directory before the watch came back went unseen.
+        for (const auto& entry : m_entries)
+        {
+            if (entry.second.directory == *it && Stat(entry.second.path).exists)
+            {
+                Record(entry.second.path, false, true, false);
+            }
+        }
+        it = m_lost_directories.erase(it);
+    }
+#endif
+}
+
+void FileWatcher::FallBackToPolling(int error, const char* what)
+{
+#if defined(__linux__)
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_last_error = std::system_error(error, std::generic_category(), what).what();
+    close(m_inotify);
+    m_inotify = -1;
+    m_directories.clear();
+    m_watch_directories.clear();
+    m_directory_users.clear();
+    m_lost_directories.clear();
+    for (const auto& entry : m_entries)
+    {
+        if (!m_snapshots.count(entry.second.path)) m_snapshots[entry.second.path] = Stat(entry.second.path);
+    }
+#else
+    (void)error;
+    (void)what;
+#endif
+}
+
+void FileWatcher::Wake()
+{
+#if defined(__linux__)
+    if (m_wake >= 0)
+    {
+        const uint64_t one = 1;
+        if (write(m_wake, &one, sizeof(one)) < 0)
+        {
+            // The counter is only full when the thread is about to wake anyway.
+        }
+    }
+#endif
+    // The polling backend waits here, also after falling back from inotify.
+    m_changed.notify_all();
+}
+
+void FileWatcher::Loop()
+{
+#if defined(__linux__)
+    while (m_inotify >= 0)
+    {
+        int timeout = -1;
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            if (m_stop) return;
+            RearmDirectories();
+            if (!m_lost_directories.empty()) timeout = static_cast<int>(m_options.poll_interval.count());
+            for (const auto& pending : m_pending)
+            {
+                const auto wait = std::chrono::duration_cast<std::chrono::milliseconds>(
+                    pending.second.deadline - Clock::now() + std::chrono::microseconds(999));
+                const int ms = static_cast<int>(std::max<int64_t>(0, wait.count()));
+                timeout      = timeout < 0 ? ms : std::min(timeout, ms);
+            }
+        }
+
+        pollfd fds[2] = {{m_inotify, POLLIN, 0}, {m_wake, POLLIN, 0}};
+        if (poll(fds, 2, timeout) < 0)
+        {
+            if (errno == EINTR) continue;
+            FallBackToPolling(errno, "poll");
+            break;
+        }
+        if (fds[1].revents & POLLIN)
+        {
+            uint64_t count = 0;
+            if (read(m_wake, &count, sizeof(count)) < 0)
+            {
+                // Nothing to do, the wakeup itself was the message.
+            }
+        }
+        if (fds[0].revents & (POLLERR | POLLNVAL))
+        {
+            FallBackToPolling(EIO, "inotify");
+            break;
+        }
+        if (fds[0].revents & POLLIN) ReadEvents();
+        DeliverDue(false);
+    }
+#endif
+
+    // Polling backend. Each round already spans the interval, so changes go out right away.
+    std::unique_lock<std::mutex> lock(m_mutex);
+    while (!m_stop)
+    {
+        lock.unlock();
+        PollFiles();
+        DeliverDue(true);
+        lock.lock();
+        m_changed.wait_for(lock, m_options.poll_interval, [this] { return m_stop; });
+    }
+}
+
+void FileWatcher::ReadEvents()
+{
+#if defined(__linux__)
+    alignas(inotify_event) char buffer[16 * 1024];
+    for (;;)
+    {
+        const ssize_t size = read(m_inotify, buffer, sizeof(buffer));
+        if (size < 0 && errno == EINTR) continue;
+        if (size <= 0) return; // EAGAIN once the queue is empty
+
+        std::lock_guard<std::mutex> lock(m_mutex);
+        for (ssize_t offset = 0; offset < size;)
+        {
+            const auto* event = reinterpret_cast<const inotify_event*>(buffer + offset);
+            offset += static_cast<ssize_t>(sizeof(inotify_event) + event->len);
+
+            if (event->mask & IN_Q_OVERFLOW)
+            {
+                // Events were lost; have every watcher check its file.
+                for (const auto& entry : m_entries) Record(entry.second.path, true, false, false);
+                continue;
+            }
+            auto directory = m_watch_directories.find(event->wd);
+            if (directory == m_watch_directories.end()) continue;
+            if (event->mask & IN_MOVE_SELF)
+            {
+                // The watch follows the directory to its new name; drop it and wait for the old
+                // name to come back. The IN_IGNORED that follows does the rest.
+                inotify_rm_watch(m_inotify, event->wd);
+                continue;
+            }
+            if (event->mask & IN_IGNORED)
+            {
+                // The directory was removed, or its file system unmounted. Its files are watched
+                // again once it reappears.
+                if (m_directory_users.count(directory->second)) m_lost_directories.insert(directory->second);
+                for (const auto& entry : m_entries)
+                {
+                    if (entry.second.directory == directory->second) Record(entry.second.path, false, false, true);
+                }
+                m_directories.erase(directory->second);
+                m_watch_directories.erase(directory);
+                continue;
+            }
+            if (!event->len) continue;
+
+            const std::string name(event->name);
+            for (const auto& entry : m_entries)
+            {
+                if (entry.second.name != name || entry.second.directory != directory->second) continue;
+                Record(entry.second.path, (event->mask & IN_MODIFY) != 0, (event->mask & kReplacedMask) != 0,
+                       (event->mask & kRemovedMask) != 0);
+            }
+        }
+    }
+#endif
+}
+
+void FileWatcher::PollFiles()
+{
+    std::vector<std::string> paths;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        for (const auto& snapshot : m_snapshots) paths.push_back(snapshot.first);
+    }
+
+    std::vector<Snapshot> current;
+    current.reserve(paths.size());
+    for (const auto& path : paths) current.push_back(Stat(path));
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    for (size_t i = 0; i < paths.size(); ++i)
+    {
+        auto it = m_snapshots.find(paths[i]);
+        if (it == m_snapshots.end()) continue; // unwatched meanwhile
+        const Snapshot& before = it->second;
+        const Snapshot& after  = current[i];
+
+        const bool other    = before.device != after.device || before.file != after.file;
+        const bool removed  = before.exists && !after.exists;
+        const bool replaced = after.exists && (!before.exists || other);
+        const bool modified = after.exists && !replaced &&
+                              (before.size != after.size || before.mtime != after.mtime);
+        if (removed || replaced || modified) Record(paths[i], modified, replaced, removed);
+        it->second = after;
+    }
+}
+
+void FileWatcher::Record(const std::string& path, bool modified, bool replaced, bool removed)
+{
+    auto it = m_pending.find(path);
+    if (it == m_pending.end())
+    {
+        it                     = m_pending.emplace(path, Pending()).first;
+        it->second.change.path = path;
+        it->second.deadline    = Clock::now() + m_options.coalesce;
+    }
+    FileChange& change = it->second.change;
+    change.modified    = change.modified || modified;
+    change.replaced    = change.replaced || replaced;
+    change.removed     = change.removed || removed;
+}
+
+void FileWatcher::DeliverDue(bool all)
+{
+    std::vector<Task> tasks;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        const auto                  now = Clock::now();
+        for (auto it = m_pending.begin(); it != m_pending.end();)
+        {
+            if (!all && it->second.deadline > now)
+            {
+                ++it;
+                continue;
+            }
+            const FileChange change = it->second.change;
+            for (const auto& entry : m_entries)
+            {
+                if (entry.second.path != change.path) continue;
+                std::shared_ptr<Subscription> subscription = entry.second.subscription;
+                tasks.push_back([subscription, change] {
+                    if (subscription->active) subscription->callback(change);
+                });
+            }
+            it = m_pending.erase(it);
+        }
+    }
+    for (auto& task : tasks)
+    {
+        if (m_dispatcher) m_dispatcher(std::move(task));
+        else task();
+    }
+}
+
+void NotifyOnWorkerPool(FileWatcher& watcher, WorkerPool& pool)
+{
+    watcher.SetDispatcher([&pool](FileWatcher::Task task) { pool.Post(std::move(task)); });
+}
+
+} // namespace gomarky
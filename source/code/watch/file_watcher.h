@@ -0,0 +1,150 @@
+#pragma once
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <atomic>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <string>
+#include <thread>
+
+namespace gomarky
+{
+
+class WorkerPool;
+
+/// What happened to a watched file since the last notification. Bursts of events are folded
+/// into one notification, so several flags can be set.
+struct FileChange
+{
+    std::string path;
+    bool        modified = false; ///< written to: appended, truncated or rewritten
+    bool        replaced = false; ///< another file took the name: created, renamed over, rotated
+    bool        removed  = false; ///< the name went away
+};
+
+/// Tells interested parties when files change, so open documents and data files can follow
+/// edits made by other programs without being re-read on a timer.
+///
+/// On Linux the watcher uses inotify on the parent directory of each file, which keeps working
+/// across rotation and save-by-rename. The directory has to exist when Watch is called; when it
+/// is removed or moved away later, it is watched again once it reappears. Elsewhere, when inotify
+/// is unavailable, or when it fails while running, the files are polled with stat instead.
+///
+/// Events for a path are collected for the coalescing window after the first one and then
+/// delivered as one FileChange, so a writer appending line by line costs one notification per
+/// window rather than one per write. Callbacks run through the dispatcher, on the watcher thread
+/// when none is set.
+class FileWatcher
+{
+public:
+    enum class Backend
+    {
+        Inotify,
+        Polling,
+    };
+
+    struct Options
+    {
+        std::chrono::milliseconds coalesce{50};       ///< how long events are collected per notification
+        std::chrono::milliseconds poll_interval{500}; ///< for the polling backend
+        bool                      force_polling = false;
+    };
+
+    using Callback   = std::function<void(const FileChange&)>;
+    using Task       = std::function<void()>;
+    using Dispatcher = std::function<void(Task)>;
+
+    explicit FileWatcher(const Options& options);
+    FileWatcher() : FileWatcher(Options()) {}
+    FileWatcher(const FileWatcher&) = delete;
+    FileWatcher& operator=(const FileWatcher&) = delete;
+    ~FileWatcher();
+
+    Backend     GetBackend() const { return m_inotify >= 0 ? Backend::Inotify : Backend::Polling; }
+    const char* BackendName() const;
+    /// Why inotify was given up for polling while running; empty if it was not.
+    std::string LastError() const;
+
+    /// Where callbacks run. Set it before the first Watch.
+    void SetDispatcher(Dispatcher dispatcher) { m_dispatcher = std::move(dispatcher); }
+
+    /// Call `callback` whenever the file at `path` changes; it does not need to exist yet.
+    /// Returns an id for Unwatch.
+    uint64_t Watch(const std::string& path, Callback callback);
+
+    /// No callback for `id` starts after this returns; one that already started may still be
+    /// running on another thread.
+    void Unwatch(uint64_t id);
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    struct Subscription;
+
+    struct Entry
+    {
+        std::string                   path;
+        std::string                   directory;
+        std::string                   name;
+        std::shared_ptr<Subscription> subscription;
+    };
+
+    struct Pending
+    {
+        FileChange        change;
+        Clock::time_point deadline;
+    };
+
+    struct Snapshot
+    {
+        bool     exists = false;
+        uint64_t device = 0;
+        uint64_t file   = 0;
+        uint64_t size   = 0;
+        int64_t  mtime  = 0;
+    };
+
+    static Snapshot Stat(const std::string& path);
+
+    void Loop();
+    void ReadEvents();
+    void PollFiles();
+    void Record(const std::string& path, bool modified, bool replaced, bool removed);
+    void DeliverDue(bool all);
+    void Wake();
+    void AddDirectory(const std::string& directory);
+    void RemoveDirectory(const std::string& directory);
+    void RearmDirectories();
+    void FallBackToPolling(int error, const char* what);
+
+    const Options m_options;
+    Dispatcher    m_dispatcher;
+
+    std::atomic<int> m_inotify{-1};
+    int              m_wake = -1;
+
+    mutable std::mutex              m_mutex;
+    std::condition_variable         m_changed; ///< wakes the polling backend
+    std::map<uint64_t, Entry>       m_entries;
+    std::map<std::string, Pending>  m_pending;           ///< by path
+    std::map<std::string, Snapshot> m_snapshots;         ///< by path, polling backend only
+    std::map<std::string, int>      m_directories;       ///< real directory path -> watch descriptor
+    std::map<int, std::string>      m_watch_directories; ///< watch descriptor -> directory
+    std::map<std::string, size_t>   m_directory_users;   ///< entries per directory
+    std::set<std::string>           m_lost_directories;  ///< watched directories that went away
+    std::string                     m_last_error;
+    uint64_t                        m_next_id = 1;
+    bool                            m_stop    = false;
+
+    std::thread m_thread;
+};
+
+/// Run the callbacks of `watcher` on `pool`, which must outlive it.
+void NotifyOnWorkerPool(FileWatcher& watcher, WorkerPool& pool);
+
+} // namespace gomarky
@@ -0,0 +1,26 @@
+#include "watch/table_tail.h"
+
+namespace gomarky
+{
+
+TableTail::TableTail(std::string path, char delimiter, bool header)
+    : m_file(std::move(path)), m_parser(delimiter, header)
+{
+}
+
+TableTail::Update TableTail::Poll()
+{
+    Update update;
+    const FileTail::Update read = m_file.Poll(
+        [this](const char* text, size_t size) { m_parser.Parse(text, size); },
+        [this] {
+            // Rows parsed before the restart belong to the old contents.
+            m_parser.Reset();
+        });
+    update.reloaded = read.restarted;
+    update.bytes    = read.bytes;
+    update.rows     = m_parser.TakeRows();
+    return update;
+}
+
+} // namespace gomarky
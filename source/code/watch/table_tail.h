@@ -0,0 +1,38 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <string>
+
+#include "table/column_table.h"
+#include "table/delimited_parser.h"
+#include "watch/file_tail.h"
+
+namespace gomarky
+{
+
+/// A delimited text file followed as a table: each Poll reads and parses only the lines appended
+/// since the previous one. When the file was truncated or replaced, it is parsed again from the
+/// start and the update says so. Not thread safe; poll from one thread at a time.
+class TableTail
+{
+public:
+    struct Update
+    {
+        bool                         reloaded = false; ///< `rows` replace everything read before
+        std::unique_ptr<ColumnTable> rows;             ///< new rows, possibly none
+        uint64_t                     bytes = 0;        ///< bytes read from the file
+    };
+
+    explicit TableTail(std::string path, char delimiter = ',', bool header = true);
+
+    Update Poll();
+
+    const std::string& Path() const { return m_file.Path(); }
+
+private:
+    FileTail        m_file;
+    DelimitedParser m_parser;
+};
+
+} // namespace gomarky
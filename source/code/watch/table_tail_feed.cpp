@@ -0,0 +1,81 @@
+#include "watch/table_tail_feed.h"
+
+#include <QCoreApplication>
+#include <QPointer>
+
+#include "concurrency/worker_pool.h"
+#include "table/column_table_model.h"
+#include "watch/file_watcher.h"
+
+namespace gomarky
+{
+
+TableTailFeed::TableTailFeed(std::unique_ptr<TableTail> tail, ColumnTableModel* model, FileWatcher& watcher,
+                             QObject* parent)
+    : TableTailFeed(std::move(tail), model, watcher, WorkerPool::Global(), parent)
+{
+}
+
+TableTailFeed::TableTailFeed(std::unique_ptr<TableTail> tail, ColumnTableModel* model, FileWatcher& watcher,
+                             WorkerPool& pool, QObject* parent)
+    : QObject(parent), m_model(model), m_watcher(watcher), m_pool(pool), m_tail(std::move(tail))
+{
+    // Until the first rows arrive and bring their columns along.
+    m_model->SetTable(std::make_shared<const ColumnTable>());
+
+    // The watcher calls back on its own thread; the guard is only looked at on the GUI thread.
+    QPointer<TableTailFeed> guard(this);
+    m_watch = m_watcher.Watch(m_tail->Path(), [guard](const FileChange&) {
+        QMetaObject::invokeMethod(QCoreApplication::instance(),
+                                  [guard] {
+                                      if (guard) guard->Refresh();
+                                  },
+                                  Qt::QueuedConnection);
+    });
+    Refresh();
+}
+
+TableTailFeed::~TableTailFeed() { m_watcher.Unwatch(m_watch); }
+
+void TableTailFeed::Refresh()
+{
+    if (m_reading)
+    {
+        m_stale = true;
+        return;
+    }
+    m_reading = true;
+    m_stale   = false;
+
+    std::shared_ptr<TableTail> tail = m_tail; // a read in flight keeps it alive
+    QPointer<TableTailFeed>    guard(this);
+    m_pool.Post([tail, guard] {
+        auto update = std::make_shared<TableTail::Update>(tail->Poll());
+        QMetaObject::invokeMethod(QCoreApplication::instance(),
+                                  [guard, update] {
+                                      if (guard) guard->Apply(update);
+                                  },
+                                  Qt::QueuedConnection);
+    });
+}
+
+void TableTailFeed::Apply(std::shared_ptr<TableTail::Update> update)
+{
+    m_reading        = false;
+    const auto count = static_cast<qint64>(update->rows->RowCount());
+    if (update->reloaded)
+    {
+        m_model->SetTable(std::make_shared<const ColumnTable>());
+        m_model->AppendRows(std::move(update->rows));
+        emit Reloaded();
+    }
+    else if (count > 0)
+    {
+        m_model->AppendRows(std::move(update->rows));
+        emit RowsAppended(count);
+    }
+
+    if (m_stale) Refresh();
+}
+
+} // namespace gomarky
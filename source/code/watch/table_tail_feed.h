@@ -0,0 +1,60 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+
+#include <QObject>
+
+#include "watch/table_tail.h"
+
+namespace gomarky
+{
+
+class ColumnTableModel;
+class FileWatcher;
+class WorkerPool;
+
+/// Keeps a ColumnTableModel in step with a delimited text file that other programs append to.
+///
+/// Changes reported by the FileWatcher make the TableTail read and parse the new lines on the
+/// WorkerPool; the rows are then appended to the model on the GUI thread, so views see rows
+/// inserted instead of a reset and following a large log costs what it grows by. When the file
+/// is truncated or replaced, it is read again from the start and the model reset. One read is
+/// in flight at a time, changes reported meanwhile are picked up by one more read after it.
+///
+/// The model shows the file and nothing else while the feed is alive; it starts out empty. The
+/// directory of the file must exist.
+class TableTailFeed : public QObject
+{
+    Q_OBJECT
+
+public:
+    TableTailFeed(std::unique_ptr<TableTail> tail, ColumnTableModel* model, FileWatcher& watcher,
+                  QObject* parent = nullptr);
+    TableTailFeed(std::unique_ptr<TableTail> tail, ColumnTableModel* model, FileWatcher& watcher,
+                  WorkerPool& pool, QObject* parent = nullptr);
+    ~TableTailFeed() override;
+
+    /// Read what the file grew by now. Runs on its own for every change the watcher reports,
+    /// and once on construction.
+    void Refresh();
+
+signals:
+    /// Emitted on the GUI thread after `count` rows were appended to the model.
+    void RowsAppended(qint64 count);
+    /// Emitted on the GUI thread after the file was read again from the start.
+    void Reloaded();
+
+private:
+    void Apply(std::shared_ptr<TableTail::Update> update);
+
+    ColumnTableModel*          m_model;
+    FileWatcher&               m_watcher;
+    WorkerPool&                m_pool;
+    std::shared_ptr<TableTail> m_tail;
+    uint64_t                   m_watch   = 0;
+    bool                       m_reading = false;
+    bool                       m_stale   = false; ///< a change was reported while reading
+};
+
+} // namespace gomarky
@@ -0,0 +1,96 @@
+#define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
+#include "doctest.h"
+
+#include "budget.h"
+
+#include <events/event_bus.h>
+#include <foo.h>
+#include <metrics/hdr_histogram.h>
+#include <timers/timer_wheel.h>
+
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+// Every operator new of the process goes through here so that the tests can count them.
+namespace
+{
+
+std::atomic<uint64_t> g_allocations{0};
+
+} // namespace
+
+void* operator new(std::size_t size)
+{
+    g_allocations.fetch_add(1, std::memory_order_relaxed);
+    if (void* memory = std::malloc(size ? size : 1)) return memory;
+    throw std::bad_alloc();
+}
+
+void operator delete(void* memory) noexcept { std::free(memory); }
+void operator delete(void* memory, std::size_t) noexcept { std::free(memory); }
+
+using namespace gomarky;
+using budget::Budget;
+
+namespace
+{
+
+constexpr int kCalls = 10000;
+
+// Allocations per call of `fn`, after one warm-up call.
+template<typename F>
+double AllocationsPerCall(F fn)
+{
+    fn();
+    const uint64_t before = g_allocations.load();
+    for (int i = 0; i < kCalls; ++i) fn();
+    return double(g_allocations.load() - before) / kCalls;
+}
+
+Budget Allocations(const char* metric, double limit)
+{
+    return {metric, Budget::Direction::AtMost, limit, "allocations/call", 0.0, false};
+}
+
+struct Tick
+{
+    int value;
+};
+
+} // namespace
+
+TEST_CASE("foo() does not allocate")
+{
+    CHECK(budget::Check(Allocations("foo.allocations", 0), 3, [] { return AllocationsPerCall([] { foo(); }); }));
+}
+
+TEST_CASE("Recording a latency does not allocate")
+{
+    HdrRecorder recorder(1, 3600000000000ull, 3);
+    uint64_t    value = 1;
+    CHECK(budget::Check(Allocations("hdr_recorder.record.allocations", 0), 3, [&] {
+        return AllocationsPerCall([&] { recorder.Record(value = value * 7 % 1000003); });
+    }));
+}
+
+TEST_CASE("Publishing and draining events does not allocate")
+{
+    EventBus bus;
+    int      sum          = 0;
+    auto     subscription = bus.Subscribe<Tick>([&](const Tick& tick) { sum += tick.value; });
+    CHECK(budget::Check(Allocations("event_bus.publish.allocations", 0), 3, [&] {
+        return AllocationsPerCall([&] {
+            bus.Publish(Tick{1});
+            bus.Drain();
+        });
+    }));
+}
+
+TEST_CASE("Scheduling and cancelling a timer reuses its slot")
+{
+    TimerWheel wheel;
+    CHECK(budget::Check(Allocations("timer_wheel.schedule_cancel.allocations", 0), 3, [&] {
+        return AllocationsPerCall([&] { wheel.Cancel(wheel.Schedule(100, [] {})); });
+    }));
+}
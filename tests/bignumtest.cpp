@@ -0,0 +1,134 @@
+#define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
+#include "doctest.h"
+
+#include <calc/big_decimal.h>
+#include <calc/big_integer.h>
+#include <calc/exact_evaluation.h>
+#include <calc/expression.h>
+
+#include <random>
+#include <string>
+
+using namespace gomarky;
+
+using Algorithm = BigInteger::MultiplyAlgorithm;
+
+namespace
+{
+
+BigInteger Random(std::mt19937& rng, size_t limbs)
+{
+    std::vector<BigInteger::Limb> values(limbs);
+    for (auto& value : values) value = rng();
+    values.back() |= 1; // keep the requested size
+    return BigInteger::FromLimbs(values, rng() & 1);
+}
+
+std::string RandomDigits(std::mt19937& rng, size_t count)
+{
+    std::string digits(1, char('1' + rng() % 9));
+    while (digits.size() < count) digits += char('0' + rng() % 10);
+    return digits;
+}
+
+} // namespace
+
+TEST_CASE("Integers round-trip through decimal text")
+{
+    CHECK(BigInteger().ToString() == "0");
+    CHECK(BigInteger(-42).ToString() == "-42");
+    CHECK(BigInteger(INT64_MIN).ToString() == "-9223372036854775808");
+    CHECK(BigInteger::FromString("-000123").ToString() == "-123");
+    CHECK_THROWS_AS(BigInteger::FromString("12a"), std::invalid_argument);
+    CHECK_THROWS_AS(BigInteger::FromString("-"), std::invalid_argument);
+
+    std::mt19937 rng(7);
+    for (size_t count : {9, 10, 431, 433, 5000, 40000})
+    {
+        const std::string digits = RandomDigits(rng, count);
+        CHECK(BigInteger::FromString(digits).ToString() == digits);
+        CHECK(BigInteger::FromString("-" + digits).ToString() == "-" + digits);
+    }
+    CHECK(BigInteger::Pow10(1000).ToString() == "1" + std::string(1000, '0'));
+}
+
+TEST_CASE("Every multiplication algorithm agrees")
+{
+    CHECK(BigInteger::FromString("123456789012345678901234567890") * BigInteger(-987654321) ==
+          BigInteger::FromString("-121932631124828532112482853211126352690"));
+
+    std::mt19937 rng(1);
+    for (auto sizes : {std::make_pair(1, 1), std::make_pair(39, 41), std::make_pair(200, 200), std::make_pair(700, 90),
+                       std::make_pair(2000, 1999), std::make_pair(3000, 1)})
+    {
+        const BigInteger a        = Random(rng, sizes.first);
+        const BigInteger b        = Random(rng, sizes.second);
+        const BigInteger expected = BigInteger::Multiply(a, b, Algorithm::Schoolbook);
+        CHECK(BigInteger::Multiply(a, b, Algorithm::Karatsuba) == expected);
+        CHECK(BigInteger::Multiply(a, b, Algorithm::Ntt) == expected);
+        CHECK(BigInteger::Multiply(a, a, Algorithm::Ntt) == BigInteger::Multiply(a, a, Algorithm::Schoolbook));
+        CHECK(a * b == expected);
+    }
+}
+
+TEST_CASE("Division satisfies a = q * b + r on both the long and the Newton path")
+{
+    BigInteger q;
+    BigInteger r;
+    BigInteger::DivMod(-7, 2, q, r);
+    CHECK(q == -3);
+    CHECK(r == -1);
+    CHECK_THROWS_AS(BigInteger(1) / BigInteger(), std::domain_error);
+
+    std::mt19937 rng(3);
+    for (auto sizes : {std::make_pair(5, 1), std::make_pair(60, 20), std::make_pair(300, 150), std::make_pair(3000, 1200),
+                       std::make_pair(4000, 3900), std::make_pair(150, 300)})
+    {
+        const BigInteger a = Random(rng, sizes.first);
+        const BigInteger b = Random(rng, sizes.second);
+        BigInteger::DivMod(a, b, q, r);
+        CHECK(q * b + r == a);
+        CHECK(r.Abs() < b.Abs());
+        CHECK((r.IsZero() || r.IsNegative() == a.IsNegative()));
+    }
+
+    // Exact multiples and off-by-one neighbours are where a reciprocal estimate is most likely off.
+    const BigInteger b = Random(rng, 500).Abs();
+    const BigInteger m = Random(rng, 700).Abs();
+    CHECK((m * b) / b == m);
+    CHECK((m * b - 1) / b == m - 1);
+    CHECK(BigInteger::Sqrt(m * m) == m);
+    CHECK(BigInteger::Sqrt(m * m - 1) == m - 1);
+}
+
+TEST_CASE("Decimals are exact where they can be and rounded where they cannot")
+{
+    CHECK(BigDecimal::FromString("1.50").ToString() == "1.50");
+    CHECK(BigDecimal::FromString("1.50").Normalized().ToString() == "1.5");
+    CHECK(BigDecimal::FromString("-.5e-2").ToString() == "-0.005");
+    CHECK(BigDecimal::FromString("12e3").ToString() == "12000");
+    CHECK_THROWS_AS(BigDecimal::FromString("1.2.3"), std::invalid_argument);
+
+    const BigDecimal sum = BigDecimal::FromString("0.1") + BigDecimal::FromString("0.2");
+    CHECK(sum == BigDecimal::FromString("0.3"));
+    CHECK((BigDecimal::FromString("1.5") * BigDecimal::FromString("-0.25")).ToString() == "-0.375");
+    CHECK(BigDecimal::Divide(2, 3, 5).ToString() == "0.66667");
+    CHECK(BigDecimal::Divide(-1, 8, 2).ToString() == "-0.13");
+    CHECK(BigDecimal::Sqrt(2, 20).ToString() == "1.41421356237309504880");
+    CHECK(BigDecimal::FromString("2.5").Rescale(0) == 3);
+    CHECK(BigDecimal::FromString("-2.5").Rescale(0) == -3);
+    CHECK(BigDecimal::FromString("1.25").Rescale(1).ToString() == "1.3");
+}
+
+TEST_CASE("Expressions evaluate exactly from their literal text")
+{
+    CHECK(EvaluateExact(Expression::Parse("0.1 + 0.2 - 0.3"), {}).IsZero());
+    CHECK(EvaluateExact(Expression::Parse("2 ^ 100"), {}).ToString() == "1267650600228229401496703205376");
+    CHECK(EvaluateExact(Expression::Parse("1 / 3"), {}, 10).ToString() == "0.3333333333");
+    CHECK(EvaluateExact(Expression::Parse("2 ^ -2 + 7.5 % 2"), {}).Normalized().ToString() == "1.75");
+    CHECK(EvaluateExact(Expression::Parse("max(x, 1e-3) * round(2.5)"), {BigDecimal::FromString("0.0001")}).ToString() ==
+          "0.003");
+    CHECK_THROWS_AS(EvaluateExact(Expression::Parse("1 / 0"), {}), std::domain_error);
+    CHECK_THROWS_AS(EvaluateExact(Expression::Parse("2 ^ 0.5"), {}), std::domain_error);
+    CHECK_THROWS_AS(Expression::Parse("0x10"), ExpressionError);
+}
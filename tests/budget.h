@@ -0,0 +1,86 @@
+#pragma once
+
+// Performance budgets for the tests labeled "budget" (see BP_BUILD_BUDGET_TESTS).
+//
+// A budget is a limit on one measurement: at most N milliseconds or bytes, or at least N items
+// per second. The measurement is repeated and its median compared with the limit, allowing a
+// noise margin calibrated from the spread of the runs (a few median absolute deviations relative
+// to the median), but never less than the budget's minimum margin nor more than its maximum, so
+// runs noisy enough to hide any regression cannot pass every budget. Deterministic measurements
+// such as allocation counts have no spread and get exactly their minimum margin.
+//
+// Time based limits are multiplied (or throughput floors divided) by GM_BUDGET_SCALE when it is
+// set, so slow or shared CI machines can loosen them without editing the budgets.
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+namespace budget
+{
+
+struct Budget
+{
+    enum class Direction
+    {
+        AtMost,
+        AtLeast,
+    };
+
+    const char* metric;
+    Direction   direction;
+    double      limit;
+    const char* unit;
+    double      min_margin = 0.05; ///< fraction of the limit
+    bool        scalable   = true; ///< affected by GM_BUDGET_SCALE
+    double      max_margin = 0.25; ///< fraction of the limit, however noisy the runs
+};
+
+inline double Scale()
+{
+    const char*  text  = std::getenv("GM_BUDGET_SCALE");
+    const double scale = text ? std::atof(text) : 1.0;
+    return scale > 0 ? scale : 1.0;
+}
+
+inline double Median(std::vector<double> values)
+{
+    std::sort(values.begin(), values.end());
+    const size_t middle = values.size() / 2;
+    return values.size() % 2 ? values[middle] : (values[middle - 1] + values[middle]) / 2;
+}
+
+/// Run `measure` `runs` times, print a one line verdict and return whether the budget holds.
+template<typename Measure>
+bool Check(const Budget& budget, int runs, Measure measure)
+{
+    std::vector<double> samples;
+    for (int i = 0; i < std::max(runs, 1); ++i) samples.push_back(measure());
+
+    const double        median = Median(samples);
+    std::vector<double> deviations;
+    for (double sample : samples) deviations.push_back(std::abs(sample - median));
+    // 1.4826 * MAD estimates the standard deviation of normally distributed noise.
+    const double spread = 1.4826 * Median(deviations);
+
+    double limit = budget.limit;
+    if (budget.scalable) limit = budget.direction == Budget::Direction::AtMost ? limit * Scale() : limit / Scale();
+    // The runs' relative noise, applied to the limit.
+    const double noise   = median != 0 ? 3 * spread / std::abs(median) : 0;
+    const double ceiling = std::max(budget.min_margin, budget.max_margin);
+    const double margin  = std::min(std::max(budget.min_margin, noise), ceiling) * std::abs(limit);
+    const bool   ok      = budget.direction == Budget::Direction::AtMost ? median <= limit + margin
+                                                                         : median >= limit - margin;
+
+    std::printf("budget %s: median %.4g %s over %zu runs (spread %.3g), %s %.4g %s with margin %.3g: %s\n",
+                budget.metric, median, budget.unit, samples.size(), spread,
+                budget.direction == Budget::Direction::AtMost ? "at most" : "at least", limit, budget.unit, margin,
+                ok ? "ok" : "OVER BUDGET");
+    std::fflush(stdout);
+    return ok;
+}
+
+} // namespace budget
@@ -0,0 +1,75 @@
+#define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
+#include "doctest.h"
+
+#include <assets/byte_lru_cache.h>
+
+#include <string>
+
+using namespace gomarky;
+
+TEST_CASE("Entries are evicted by total cost, least recently used first")
+{
+    ByteLruCache<std::string, int> cache(100);
+    CHECK(cache.Insert("a", 1, 40));
+    CHECK(cache.Insert("b", 2, 40));
+    CHECK(cache.UsedBytes() == 80);
+
+    REQUIRE(cache.Find("a") != nullptr); // "b" is now the oldest
+    CHECK(cache.Insert("c", 3, 40));
+    CHECK(cache.Contains("a"));
+    CHECK_FALSE(cache.Contains("b"));
+    CHECK(cache.Contains("c"));
+    CHECK(cache.UsedBytes() == 80);
+
+    // A single large entry can push out several small ones.
+    CHECK(cache.Insert("d", 4, 90));
+    CHECK(cache.Size() == 1);
+    CHECK(*cache.Find("d") == 4);
+}
+
+TEST_CASE("Replacing an entry updates its cost")
+{
+    ByteLruCache<std::string, int> cache(100);
+    cache.Insert("a", 1, 60);
+    cache.Insert("a", 2, 10);
+    CHECK(cache.Size() == 1);
+    CHECK(cache.UsedBytes() == 10);
+    CHECK(*cache.Find("a") == 2);
+
+    CHECK(cache.Remove("a"));
+    CHECK_FALSE(cache.Remove("a"));
+    CHECK(cache.UsedBytes() == 0);
+}
+
+TEST_CASE("Entries larger than the budget are rejected")
+{
+    ByteLruCache<std::string, int> cache(100);
+    cache.Insert("a", 1, 50);
+    CHECK_FALSE(cache.Insert("huge", 2, 101));
+    CHECK(cache.Contains("a"));
+    CHECK(cache.UsedBytes() == 50);
+}
+
+TEST_CASE("Shrinking the budget evicts down to it")
+{
+    ByteLruCache<int, int> cache(100);
+    for (int i = 0; i < 10; ++i) cache.Insert(i, i, 10);
+    cache.SetBudget(35);
+    CHECK(cache.Size() == 3);
+    CHECK(cache.Contains(9));
+    CHECK(cache.Contains(7));
+    CHECK_FALSE(cache.Contains(6));
+}
+
+TEST_CASE("RemoveIf drops matching entries and evictions are counted")
+{
+    ByteLruCache<int, int> cache(50);
+    for (int i = 0; i < 8; ++i) cache.Insert(i, i * 10, 10);
+    CHECK(cache.Evictions() == 3);
+
+    CHECK(cache.RemoveIf([](int key, int value) { return key % 2 == 0 || value == 50; }) == 3);
+    CHECK(cache.Size() == 2);
+    CHECK(cache.UsedBytes() == 20);
+    CHECK(cache.Contains(3));
+    CHECK(cache.Contains(7));
+}
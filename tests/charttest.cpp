@@ -0,0 +1,89 @@
+#define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
+#include "doctest.h"
+
+#include <chart/downsample.h>
+#include <chart/minmax_pyramid.h>
+
+#include <algorithm>
+#include <cmath>
+#include <random>
+
+using namespace gomarky;
+
+namespace
+{
+
+MinMaxPyramid MakeSeries(size_t samples)
+{
+    MinMaxPyramid series;
+    std::mt19937  rng(3);
+    for (size_t i = 0; i < samples; ++i)
+    {
+        series.Append(double(i), std::sin(i * 0.01) * 100 + double(rng() % 1000) / 100.0);
+    }
+    return series;
+}
+
+} // namespace
+
+TEST_CASE("Pyramid summaries match a brute-force scan for arbitrary ranges")
+{
+    // Sizes around powers of the fanout exercise level creation and partial top nodes.
+    for (size_t samples : {1u, 8u, 9u, 64u, 65u, 5000u})
+    {
+        const MinMaxPyramid series = MakeSeries(samples);
+        std::mt19937        rng(11);
+        for (int trial = 0; trial < 200; ++trial)
+        {
+            size_t begin = rng() % samples, end = rng() % (samples + 1);
+            if (begin > end) std::swap(begin, end);
+            const auto summary = series.Summarize(begin, end);
+            REQUIRE(summary.count == end - begin);
+            if (begin == end) continue;
+
+            double min = series.Y(begin), max = series.Y(begin), sum = 0;
+            for (size_t i = begin; i < end; ++i)
+            {
+                min = std::min(min, series.Y(i));
+                max = std::max(max, series.Y(i));
+                sum += series.Y(i);
+            }
+            CHECK(summary.min == min);
+            CHECK(summary.max == max);
+            CHECK(series.Y(summary.argmin) == min);
+            CHECK(series.Y(summary.argmax) == max);
+            CHECK(std::abs(summary.sum - sum) < 1e-6 * std::max(1.0, std::abs(sum)));
+        }
+    }
+}
+
+TEST_CASE("Downsampling keeps the bucket count and the extremes")
+{
+    const MinMaxPyramid series = MakeSeries(1000000);
+    const auto          result = Downsample(series, 0, 999999, 800);
+
+    CHECK(result.bands.size() == 800);
+    CHECK(result.line.size() <= 800 + 2);
+    CHECK(std::is_sorted(result.line.begin(), result.line.end(),
+                         [](const ChartPoint& a, const ChartPoint& b) { return a.x < b.x; }));
+
+    const auto all     = series.Summarize(0, series.Size());
+    double     band_lo = result.bands[0].min, band_hi = result.bands[0].max;
+    for (const auto& band : result.bands)
+    {
+        band_lo = std::min(band_lo, band.min);
+        band_hi = std::max(band_hi, band.max);
+    }
+    CHECK(band_lo == all.min);
+    CHECK(band_hi == all.max);
+}
+
+TEST_CASE("Zoomed-in ranges return raw samples with one neighbour on each side")
+{
+    const MinMaxPyramid series = MakeSeries(1000);
+    const auto          result = Downsample(series, 100, 199.5, 800);
+    CHECK(result.bands.empty());
+    REQUIRE(result.line.size() == 102);
+    CHECK(result.line.front().x == 99);
+    CHECK(result.line.back().x == 200);
+}
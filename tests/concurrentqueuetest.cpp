@@ -0,0 +1,325 @@
+#define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
+#include "doctest.h"
+
+#include <concurrent/blocking_queue.h>
+#include <concurrent/mpmc_ring.h>
+#include <concurrent/mpsc_queue.h>
+#include <concurrent/spsc_ring.h>
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <thread>
+#include <vector>
+
+using namespace gomarky;
+
+// These are meant to be run under ThreadSanitizer as well (see the USE_TSAN CI job), so the
+// stress cases keep their counts small enough for an instrumented single-core run.
+
+namespace
+{
+
+struct Item
+{
+    uint32_t producer;
+    uint32_t sequence;
+};
+
+/// Counts live instances so tests can check that queues destroy what they still hold.
+struct Tracked
+{
+    static std::atomic<int> live;
+
+    Tracked() { ++live; }
+    Tracked(const Tracked&) { ++live; }
+    Tracked& operator=(const Tracked&) = default;
+    ~Tracked() { --live; }
+};
+std::atomic<int> Tracked::live{0};
+
+struct Outcome
+{
+    uint64_t received = 0;
+    uint64_t checksum = 0;
+    bool     ordered  = true;
+};
+
+// Every producer pushes `count` items; consumers check that each producer's items reach them in
+// order and that, together, they received everything exactly once.
+template<typename Push, typename Pop>
+Outcome Stress(uint32_t producers, uint32_t consumers, uint32_t count, Push push, Pop pop)
+{
+    std::atomic<uint64_t>    remaining{uint64_t(producers) * count};
+    std::vector<Outcome>     outcomes(consumers);
+    std::vector<std::thread> threads;
+    for (uint32_t p = 0; p < producers; ++p)
+    {
+        threads.emplace_back([=, &push] {
+            for (uint32_t i = 0; i < count; ++i) push(Item{p, i});
+        });
+    }
+    for (uint32_t c = 0; c < consumers; ++c)
+    {
+        threads.emplace_back([&, c] {
+            std::vector<int64_t> last(producers, -1);
+            Outcome&             outcome = outcomes[c];
+            Item                 item;
+            while (remaining.load() > 0)
+            {
+                if (!pop(item)) continue;
+                remaining.fetch_sub(1);
+                outcome.ordered = outcome.ordered && int64_t(item.sequence) > last[item.producer];
+                last[item.producer] = item.sequence;
+                outcome.checksum += uint64_t(item.producer) * count + item.sequence;
+                ++outcome.received;
+            }
+        });
+    }
+    for (auto& thread : threads) thread.join();
+
+    Outcome total;
+    for (const auto& outcome : outcomes)
+    {
+        total.received += outcome.received;
+        total.checksum += outcome.checksum;
+        total.ordered = total.ordered && outcome.ordered;
+    }
+    return total;
+}
+
+uint64_t ExpectedChecksum(uint32_t producers, uint32_t count)
+{
+    const uint64_t n = uint64_t(producers) * count;
+    return n * (n - 1) / 2;
+}
+
+// Spin on a non-blocking queue, yielding so that a single core still makes progress.
+template<typename Queue>
+Outcome SpinStress(Queue& queue, uint32_t producers, uint32_t consumers, uint32_t count)
+{
+    return Stress(
+        producers, consumers, count,
+        [&queue](Item item) {
+            while (!queue.TryPush(item)) std::this_thread::yield();
+        },
+        [&queue](Item& item) {
+            if (queue.TryPop(item)) return true;
+            std::this_thread::yield();
+            return false;
+        });
+}
+
+template<typename Queue>
+Outcome BlockingStress(BlockingQueue<Queue>& queue, uint32_t producers, uint32_t consumers, uint32_t count)
+{
+    // Blocking pops cannot notice that the last item went elsewhere, so each consumer pops its
+    // exact share instead of watching a shared counter.
+    const uint64_t           share = uint64_t(producers) * count / consumers;
+    std::vector<Outcome>     outcomes(consumers);
+    std::vector<std::thread> threads;
+    for (uint32_t p = 0; p < producers; ++p)
+    {
+        threads.emplace_back([=, &queue] {
+            for (uint32_t i = 0; i < count; ++i) queue.Push(Item{p, i});
+        });
+    }
+    for (uint32_t c = 0; c < consumers; ++c)
+    {
+        threads.emplace_back([&, c] {
+            std::vector<int64_t> last(producers, -1);
+            Outcome&             outcome = outcomes[c];
+            Item                 item;
+            for (uint64_t i = 0; i < share; ++i)
+            {
+                queue.Pop(item);
+                outcome.ordered = outcome.ordered && int64_t(item.sequence) > last[item.producer];
+                last[item.producer] = item.sequence;
+                outcome.checksum += uint64_t(item.producer) * count + item.sequence;
+                ++outcome.received;
+            }
+        });
+    }
+    for (auto& thread : threads) thread.join();
+
+    Outcome total;
+    for (const auto& outcome : outcomes)
+    {
+        total.received += outcome.received;
+        total.checksum += outcome.checksum;
+        total.ordered = total.ordered && outcome.ordered;
+    }
+    return total;
+}
+
+} // namespace
+
+TEST_CASE("The SPSC ring is bounded and keeps order")
+{
+    SpscRing<std::unique_ptr<int>> ring(3);
+    CHECK(ring.Capacity() == 4);
+    for (int i = 0; i < 4; ++i) CHECK(ring.TryPush(std::unique_ptr<int>(new int(i))));
+    std::unique_ptr<int> rejected(new int(4));
+    CHECK_FALSE(ring.TryPush(std::move(rejected)));
+    CHECK(rejected); // a failed push leaves its argument alone
+
+    std::unique_ptr<int> out;
+    CHECK(ring.TryPop(out));
+    CHECK(*out == 0);
+
+    std::vector<int> seen;
+    CHECK(ring.ConsumeBatch([&](std::unique_ptr<int>& item) { seen.push_back(*item); }, 2) == 2);
+    CHECK(seen == (std::vector<int>{1, 2}));
+    CHECK(ring.TryPush(std::unique_ptr<int>(new int(5)))); // leftovers are destroyed with the ring
+}
+
+TEST_CASE("Bounded rings destroy the items they still hold")
+{
+    {
+        MpmcRing<Tracked> mpmc(4);
+        MpscRing<Tracked> mpsc(4);
+        SpscRing<Tracked> spsc(4);
+        Tracked           item;
+        for (int i = 0; i < 3; ++i)
+        {
+            CHECK(mpmc.TryPush(item));
+            CHECK(mpsc.TryPush(item));
+            CHECK(spsc.TryPush(item));
+        }
+        CHECK(mpmc.TryPush(item));
+        CHECK_FALSE(mpmc.TryPush(item));
+        CHECK(mpmc.TryPop(item));
+        CHECK(Tracked::live == 1 + 3 + 3 + 3);
+    }
+    CHECK(Tracked::live == 0);
+}
+
+TEST_CASE("The MPSC queue is unbounded and frees its nodes")
+{
+    {
+        MpscQueue<std::unique_ptr<int>> queue;
+        std::unique_ptr<int>            out;
+        CHECK_FALSE(queue.TryPop(out));
+        for (int i = 0; i < 1000; ++i) CHECK(queue.TryPush(std::unique_ptr<int>(new int(i))));
+        for (int i = 0; i < 500; ++i)
+        {
+            CHECK(queue.TryPop(out));
+            CHECK(*out == i);
+        }
+    }
+    {
+        MpscQueue<Tracked> queue;
+        queue.TryPush(Tracked());
+        queue.TryPush(Tracked());
+    }
+    CHECK(Tracked::live == 0);
+}
+
+TEST_CASE("Rings survive many producers and consumers")
+{
+    constexpr uint32_t kCount = 20000;
+    SUBCASE("spsc")
+    {
+        SpscRing<Item> ring(64);
+        const Outcome  outcome = SpinStress(ring, 1, 1, kCount);
+        CHECK(outcome.ordered);
+        CHECK(outcome.received == kCount);
+        CHECK(outcome.checksum == ExpectedChecksum(1, kCount));
+    }
+    SUBCASE("mpsc ring")
+    {
+        MpscRing<Item> ring(64);
+        const Outcome  outcome = SpinStress(ring, 4, 1, kCount);
+        CHECK(outcome.ordered);
+        CHECK(outcome.checksum == ExpectedChecksum(4, kCount));
+    }
+    SUBCASE("mpsc queue")
+    {
+        MpscQueue<Item> queue;
+        const Outcome   outcome = SpinStress(queue, 4, 1, kCount);
+        CHECK(outcome.ordered);
+        CHECK(outcome.checksum == ExpectedChecksum(4, kCount));
+    }
+    SUBCASE("mpmc")
+    {
+        MpmcRing<Item> ring(64);
+        const Outcome  outcome = SpinStress(ring, 3, 3, kCount);
+        CHECK(outcome.ordered);
+        CHECK(outcome.received == 3 * kCount);
+        CHECK(outcome.checksum == ExpectedChecksum(3, kCount));
+    }
+}
+
+TEST_CASE("Blocking wrappers sleep and wake on both sides")
+{
+    // Tiny capacities make producers and consumers both go to sleep regularly.
+    constexpr uint32_t kCount = 10000;
+    SUBCASE("spsc")
+    {
+        BlockingQueue<SpscRing<Item>> queue(2);
+        const Outcome                 outcome = BlockingStress(queue, 1, 1, kCount);
+        CHECK(outcome.ordered);
+        CHECK(outcome.checksum == ExpectedChecksum(1, kCount));
+    }
+    SUBCASE("mpsc queue")
+    {
+        BlockingQueue<MpscQueue<Item>> queue;
+        const Outcome                  outcome = BlockingStress(queue, 3, 1, kCount);
+        CHECK(outcome.ordered);
+        CHECK(outcome.checksum == ExpectedChecksum(3, kCount));
+    }
+    SUBCASE("mpmc")
+    {
+        BlockingQueue<MpmcRing<Item>> queue(4);
+        const Outcome                 outcome = BlockingStress(queue, 2, 2, kCount);
+        CHECK(outcome.ordered);
+        CHECK(outcome.received == 2 * kCount);
+        CHECK(outcome.checksum == ExpectedChecksum(2, kCount));
+    }
+}
+
+TEST_CASE("A blocking wrapper leaves a rejected item alone")
+{
+    BlockingQueue<SpscRing<std::unique_ptr<int>>> queue(2);
+    for (int i = 0; i < 2; ++i) CHECK(queue.TryPush(std::unique_ptr<int>(new int(i))));
+    std::unique_ptr<int> rejected(new int(2));
+    CHECK_FALSE(queue.TryPush(std::move(rejected)));
+    CHECK(rejected);
+
+    std::unique_ptr<int> out;
+    queue.Pop(out);
+    CHECK(*out == 0);
+    CHECK(queue.TryPush(std::move(rejected)));
+    CHECK_FALSE(rejected);
+}
+
+TEST_CASE("An event count never loses a notification")
+{
+    EventCount            event;
+    std::atomic<uint32_t> value{0};
+    constexpr uint32_t    kRounds = 2000;
+
+    std::thread waiter([&] {
+        for (uint32_t round = 1; round <= kRounds; ++round)
+        {
+            while (value.load() < round)
+            {
+                const EventCount::Key key = event.PrepareWait();
+                if (value.load() >= round)
+                {
+                    event.CancelWait();
+                    break;
+                }
+                event.Wait(key);
+            }
+        }
+    });
+    for (uint32_t round = 1; round <= kRounds; ++round)
+    {
+        value.store(round);
+        event.NotifyAll();
+        if (round % 64 == 0) std::this_thread::yield();
+    }
+    waiter.join();
+    CHECK(value.load() == kRounds);
+}
@@ -0,0 +1,184 @@
+#define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
+#include "doctest.h"
+
+#include <concurrency/worker_pool.h>
+#include <system/cpu_topology.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <mutex>
+#include <set>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#if defined(__linux__)
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+using namespace gomarky;
+
+TEST_CASE("CPU lists are parsed like sysfs writes them")
+{
+    CHECK(ParseCpuList("0-3,8,10-11\n") == std::vector<int>{0, 1, 2, 3, 8, 10, 11});
+    CHECK(ParseCpuList("5") == std::vector<int>{5});
+    CHECK(ParseCpuList("").empty());
+    CHECK(ParseCpuList("garbage").empty());
+}
+
+#if defined(__linux__)
+
+namespace
+{
+
+void MakeDirectories(const std::string& path)
+{
+    for (size_t slash = path.find('/', 1); slash != std::string::npos; slash = path.find('/', slash + 1))
+    {
+        mkdir(path.substr(0, slash).c_str(), 0755);
+    }
+    mkdir(path.c_str(), 0755);
+}
+
+void WriteFile(const std::string& path, const std::string& text)
+{
+    MakeDirectories(path.substr(0, path.rfind('/')));
+    std::ofstream(path) << text << "\n";
+}
+
+// Two packages of two cores with two hardware threads each; one L3 and one node per package.
+// Numbered like Linux does: cpu0-3 are the first threads, cpu4-7 their SMT siblings.
+std::string MakeFakeSysfs()
+{
+    char root[] = "/tmp/cputopologytestXXXXXX";
+    REQUIRE(mkdtemp(root));
+    const std::string cpu_root = std::string(root) + "/cpu";
+    WriteFile(cpu_root + "/online", "0-7");
+    for (int id = 0; id < 8; ++id)
+    {
+        const int         package = (id % 4) / 2;
+        const int         first   = id % 4;
+        const std::string dir     = cpu_root + "/cpu" + std::to_string(id);
+        WriteFile(dir + "/topology/physical_package_id", std::to_string(package));
+        WriteFile(dir + "/topology/core_id", std::to_string(first % 2));
+        WriteFile(dir + "/topology/thread_siblings_list", std::to_string(first) + "," + std::to_string(first + 4));
+        WriteFile(dir + "/cache/index0/level", "1");
+        WriteFile(dir + "/cache/index0/shared_cpu_list", std::to_string(first) + "," + std::to_string(first + 4));
+        WriteFile(dir + "/cache/index3/level", "3");
+        WriteFile(dir + "/cache/index3/shared_cpu_list", package == 0 ? "0-1,4-5" : "2-3,6-7");
+        MakeDirectories(dir + "/node" + std::to_string(package));
+    }
+    return root;
+}
+
+} // namespace
+
+TEST_CASE("Cores, siblings, L3 domains and nodes are read from sysfs")
+{
+    const CpuTopology topology = CpuTopology::Discover(MakeFakeSysfs());
+
+    REQUIRE(topology.Cpus().size() == 8);
+    CHECK(topology.CoreCount() == 4);
+    CHECK(topology.L3Count() == 2);
+    CHECK(topology.NodeCount() == 2);
+    CHECK(topology.Describe() == "2 packages, 4 cores, 8 threads, 2 L3 domains, 2 nodes");
+
+    const CpuTopology::Cpu* first  = topology.Find(1);
+    const CpuTopology::Cpu* second = topology.Find(5);
+    REQUIRE(first);
+    REQUIRE(second);
+    CHECK(first->core == second->core);
+    CHECK(first->sibling == 0);
+    CHECK(second->sibling == 1);
+    CHECK(topology.Find(2)->l3 != first->l3);
+    CHECK(topology.Find(2)->node == 1);
+    CHECK(topology.Find(9) == nullptr);
+}
+
+TEST_CASE("Placement fills physical cores one L3 domain at a time")
+{
+    const CpuTopology topology = CpuTopology::Discover(MakeFakeSysfs());
+    CHECK(topology.PlacementOrder() == std::vector<int>{0, 1, 2, 3, 4, 5, 6, 7});
+}
+
+#endif
+
+TEST_CASE("A flat topology is one domain in CPU order")
+{
+    const CpuTopology flat = CpuTopology::Flat(3);
+    CHECK(flat.CoreCount() == 3);
+    CHECK(flat.L3Count() == 1);
+    CHECK(flat.PlacementOrder() == std::vector<int>{0, 1, 2});
+}
+
+TEST_CASE("A missing sysfs degrades to a flat topology")
+{
+    const CpuTopology topology = CpuTopology::Discover("/nonexistent");
+    CHECK(topology.Cpus().size() >= 1);
+    CHECK(topology.L3Count() == 1);
+    CHECK(topology.NodeCount() == 1);
+}
+
+TEST_CASE("Memory allocated on a node is zeroed and writable")
+{
+    const size_t bytes  = 1 << 20;
+    auto*        memory = static_cast<unsigned char*>(AllocateOnNode(bytes, 0));
+    REQUIRE(memory);
+    CHECK(std::all_of(memory, memory + bytes, [](unsigned char c) { return c == 0; }));
+    std::fill(memory, memory + bytes, 0xab);
+    FreeOnNode(memory, bytes);
+    CHECK(AllocateOnNode(0, 0) == nullptr);
+}
+
+TEST_CASE("A pool built from the topology runs every task and knows its workers")
+{
+    const CpuTopology topology = CpuTopology::Discover();
+    WorkerPool        pool(4, topology);
+    REQUIRE(pool.Size() == 4);
+    CHECK(pool.CurrentWorker() == -1);
+
+    std::atomic<int>  sum{0};
+    std::atomic<bool> inside{true};
+    for (int i = 1; i <= 1000; ++i)
+    {
+        pool.Post([&, i] {
+            const int worker = pool.CurrentWorker();
+            if (worker < 0 || worker >= 4) inside = false;
+            sum += i;
+        });
+    }
+    std::atomic<size_t> items{0};
+    pool.ParallelFor(10000, 100, [&](size_t begin, size_t end) { items += end - begin; });
+    CHECK(items == 10000);
+    pool.Submit([] {}).get();
+    while (sum != 500500) std::this_thread::yield();
+    CHECK(inside);
+
+    const std::vector<int> allowed = AllowedCpus(topology);
+    for (size_t i = 0; i < pool.Size(); ++i)
+    {
+        CHECK(std::find(allowed.begin(), allowed.end(), pool.WorkerCpu(i)) != allowed.end());
+    }
+}
+
+TEST_CASE("RunOnEachWorker visits every worker exactly once")
+{
+    WorkerPool pool(4);
+    CHECK(pool.WorkerCpu(0) == -1);
+
+    std::mutex            mutex;
+    std::multiset<size_t> seen;
+    pool.RunOnEachWorker([&](size_t worker) {
+        CHECK(pool.CurrentWorker() == static_cast<int>(worker));
+        std::lock_guard<std::mutex> lock(mutex);
+        seen.insert(worker);
+    });
+    CHECK(seen == std::multiset<size_t>{0, 1, 2, 3});
+
+    pool.Submit([&] { CHECK_THROWS_AS(pool.RunOnEachWorker([](size_t) {}), std::logic_error); }).get();
+}
@@ -0,0 +1,184 @@
+#define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
+#include "doctest.h"
+
+#include <events/event_bus.h>
+
+#include <atomic>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace gomarky;
+
+namespace
+{
+
+struct Tick
+{
+    int      producer;
+    uint32_t sequence;
+};
+
+struct Note
+{
+    std::string text;
+};
+
+} // namespace
+
+TEST_CASE("Events reach the subscribers of their type only")
+{
+    EventBus bus;
+    std::vector<uint32_t>    ticks;
+    std::vector<std::string> notes;
+    auto tick_sub = bus.Subscribe<Tick>([&](const Tick& tick) { ticks.push_back(tick.sequence); }, EventBus::Producers::Single);
+    auto note_sub = bus.Subscribe<Note>([&](const Note& note) { notes.push_back(note.text); });
+
+    CHECK(bus.Publish(Tick{0, 1}));
+    CHECK(bus.Publish(Note{"hello"}));
+    CHECK(bus.Publish(Tick{0, 2}));
+    CHECK(ticks.empty()); // nothing runs until the consumer drains
+
+    CHECK(bus.Drain() == 3);
+    CHECK(ticks == (std::vector<uint32_t>{1, 2}));
+    CHECK(notes == (std::vector<std::string>{"hello"}));
+    CHECK(bus.Publish(3.5)); // a type nobody listens to is fine
+}
+
+TEST_CASE("One wakeup covers a whole batch")
+{
+    EventBus bus;
+    int      wakeups = 0;
+    bus.SetWakeup([&] { ++wakeups; });
+    int  received = 0;
+    auto sub      = bus.Subscribe<Tick>([&](const Tick&) { ++received; });
+
+    for (uint32_t i = 0; i < 100; ++i) bus.Publish(Tick{0, i});
+    CHECK(wakeups == 1);
+    CHECK(bus.Drain() == 100);
+
+    bus.Publish(Tick{0, 100});
+    CHECK(wakeups == 2);
+
+    // A drain cut short by its limit asks to be scheduled again.
+    for (uint32_t i = 0; i < 9; ++i) bus.Publish(Tick{0, i});
+    CHECK(wakeups == 2);
+    CHECK(bus.Drain(4) == 4);
+    CHECK(wakeups == 3);
+    CHECK(bus.Drain() == 6);
+    CHECK(received == 110);
+    CHECK(bus.Wakeups() == 3);
+}
+
+TEST_CASE("Full rings drop instead of blocking")
+{
+    EventBus bus;
+    int      slow = 0;
+    int      fast = 0;
+    auto     a    = bus.Subscribe<Tick>([&](const Tick&) { ++slow; }, EventBus::Producers::Multiple, 2);
+    auto     b    = bus.Subscribe<Tick>([&](const Tick&) { ++fast; }, EventBus::Producers::Multiple, 16);
+
+    CHECK(bus.Publish(Tick{0, 0}));
+    CHECK(bus.Publish(Tick{0, 1}));
+    CHECK_FALSE(bus.Publish(Tick{0, 2}));
+    CHECK(bus.Dropped() == 1);
+    bus.Drain();
+    CHECK(slow == 2);
+    CHECK(fast == 3);
+}
+
+TEST_CASE("Cancelled subscriptions stop receiving")
+{
+    EventBus bus;
+    int      received = 0;
+    auto     sub      = bus.Subscribe<Tick>([&](const Tick&) { ++received; });
+    bus.Publish(Tick{0, 0});
+    bus.Drain();
+
+    EventBus::Subscription moved = std::move(sub);
+    CHECK_FALSE(sub.Active());
+    bus.Publish(Tick{0, 1});
+    moved.Cancel();
+    bus.Publish(Tick{0, 2});
+    bus.Drain();
+    CHECK(received == 1);
+}
+
+TEST_CASE("Cancelled subscriptions are freed by the next drain, even under load")
+{
+    EventBus         bus;
+    std::atomic<bool> stop{false};
+    std::vector<std::thread> producers;
+    for (int p = 0; p < 2; ++p)
+    {
+        producers.emplace_back([&bus, &stop, p] {
+            for (uint32_t i = 0; !stop.load(std::memory_order_relaxed); ++i) bus.Publish(Tick{p, i});
+        });
+    }
+
+    auto handler_state = std::make_shared<int>(0);
+    auto kept          = bus.Subscribe<Tick>([handler_state](const Tick&) {});
+    for (int round = 0; round < 200; ++round)
+    {
+        auto sub = bus.Subscribe<Tick>([handler_state](const Tick&) {}, EventBus::Producers::Multiple, 64);
+        bus.Drain();
+        sub.Cancel();
+        bus.Drain();
+    }
+    stop = true;
+    for (auto& thread : producers) thread.join();
+    bus.Drain();
+    CHECK(handler_state.use_count() == 2); // ours and the one still subscribed
+
+    kept.Cancel();
+    bus.Drain();
+    CHECK(handler_state.use_count() == 1);
+}
+
+TEST_CASE("Many publishers and a draining consumer lose nothing")
+{
+    constexpr int      kProducers = 4;
+    constexpr uint32_t kCount     = 20000;
+
+    EventBus         bus;
+    std::atomic<int>  wakeups{0};
+    bus.SetWakeup([&] { wakeups.fetch_add(1); });
+    std::vector<uint32_t> next(kProducers, 0);
+    bool                  ordered  = true;
+    size_t                received = 0;
+    auto sub = bus.Subscribe<Tick>(
+        [&](const Tick& tick) {
+            ordered = ordered && tick.sequence == next[tick.producer]++;
+            ++received;
+        },
+        EventBus::Producers::Multiple, 256);
+
+    std::vector<std::thread> producers;
+    for (int p = 0; p < kProducers; ++p)
+    {
+        producers.emplace_back([&bus, p] {
+            for (uint32_t i = 0; i < kCount;)
+            {
+                if (bus.Publish(Tick{p, i})) ++i;
+                else std::this_thread::yield();
+            }
+        });
+    }
+
+    // Drain only when woken, the way an event loop would.
+    int handled = 0;
+    while (received < kProducers * kCount)
+    {
+        if (wakeups.load() == handled)
+        {
+            std::this_thread::yield();
+            continue;
+        }
+        ++handled;
+        bus.Drain();
+    }
+    for (auto& thread : producers) thread.join();
+    CHECK(ordered);
+    CHECK(received == kProducers * kCount);
+}
@@ -0,0 +1,137 @@
+#define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
+#include "doctest.h"
+
+#include <calc/expression.h>
+#include <calc/expression_cache.h>
+#include <concurrency/worker_pool.h>
+#include <metrics/metrics_registry.h>
+
+#include <atomic>
+#include <string>
+
+using namespace gomarky;
+
+TEST_CASE("Canonical forms ignore spelling but not meaning")
+{
+    auto text = [](const char* source) { return Expression::Parse(source).CanonicalForm()->text; };
+    CHECK(text("b*a + 1") == text("1 + a * b"));
+    CHECK(text("(x)") == text("x"));
+    CHECK(text("1e2 * y") == text("y * 100"));
+    CHECK(text("a - b") != text("b - a"));
+    CHECK(text("a / b") != text("b / a"));
+    CHECK(text("sum(a, b)") != text("sum(b, a)"));
+
+    // 1e999 overflows to infinity, which must not read as a reference named inf.
+    CHECK(text("1e999 + x") != text("inf + x"));
+    CHECK(text("1e999") == text("2e999"));
+
+    const auto canonical = Expression::Parse("z * a + m").CanonicalForm();
+    CHECK(canonical->names == (std::vector<std::string>{"a", "m", "z"}));
+    CHECK(canonical->order == (std::vector<uint32_t>{1, 2, 0}));
+}
+
+TEST_CASE("Results are reused for equal expressions and bindings")
+{
+    MetricsRegistry metrics;
+    ExpressionCache cache(metrics, "test");
+
+    const auto first  = Expression::Parse("x * y + 1");
+    const auto second = Expression::Parse("1 + y*x"); // references in the other order
+    CHECK(cache.Evaluate(first, {2, 3}) == 7);
+    CHECK(cache.Evaluate(second, {3, 2}) == 7);
+    CHECK(cache.Hits() == 1);
+    CHECK(cache.Evaluate(second, {2, 3}) == 7); // y = 2, x = 3 is a different binding
+    CHECK(cache.Misses() == 2);
+    CHECK(cache.Size() == 2);
+
+    CHECK(metrics.GetCounter("test.hits").Value() == 1);
+    CHECK(metrics.GetCounter("test.misses").Value() == 2);
+    CHECK(metrics.GetGauge("test.bytes").Value() == static_cast<int64_t>(cache.UsedBytes()));
+}
+
+TEST_CASE("Caches sharing a name add to the metrics but count their own hits")
+{
+    MetricsRegistry metrics;
+    ExpressionCache first(metrics, "test");
+    ExpressionCache second(metrics, "test");
+    const auto      expression = Expression::Parse("x + 1");
+    first.Evaluate(expression, {1});
+    first.Evaluate(expression, {1});
+    second.Evaluate(expression, {1});
+
+    CHECK(first.Hits() == 1);
+    CHECK(first.Misses() == 1);
+    CHECK(second.Hits() == 0);
+    CHECK(second.Misses() == 1);
+    CHECK(metrics.GetCounter("test.hits").Value() == 1);
+    CHECK(metrics.GetCounter("test.misses").Value() == 2);
+}
+
+TEST_CASE("Changing a variable invalidates the expressions reading it")
+{
+    MetricsRegistry metrics;
+    ExpressionCache cache(metrics, "test");
+    cache.Evaluate(Expression::Parse("rate * 2"), {1.5});
+    cache.Evaluate(Expression::Parse("rate + base"), {10, 1.5});
+    cache.Evaluate(Expression::Parse("base - 1"), {10});
+
+    CHECK(cache.Invalidate("rate") == 2);
+    CHECK(cache.Size() == 1);
+    CHECK(cache.Invalidate("rate") == 0);
+    CHECK(metrics.GetCounter("test.invalidations").Value() == 2);
+
+    cache.Clear();
+    CHECK(cache.Size() == 0);
+    CHECK(metrics.GetGauge("test.bytes").Value() == 0);
+}
+
+TEST_CASE("The byte budget evicts least recently used results")
+{
+    MetricsRegistry metrics;
+    ExpressionCache cache(metrics, "test", 4 * 1024, 1);
+    const auto      expression = Expression::Parse("v + 1");
+    for (int i = 0; i < 1000; ++i) cache.Evaluate(expression, {double(i)});
+    CHECK(cache.UsedBytes() <= 4 * 1024);
+    CHECK(cache.Size() < 1000);
+    CHECK(metrics.GetCounter("test.evictions").Value() == 1000 - cache.Size());
+
+    cache.Evaluate(expression, {999});
+    CHECK(cache.Hits() == 1);
+    cache.Evaluate(expression, {0.0});
+    CHECK(cache.Hits() == 1);
+}
+
+TEST_CASE("Shards can be hit from many threads at once")
+{
+    MetricsRegistry   metrics;
+    ExpressionCache   cache(metrics, "test");
+    WorkerPool        pool(4);
+    const auto        expression = Expression::Parse("a * a - b");
+    std::atomic<bool> wrong{false};
+    pool.ParallelFor(20000, 100, [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; ++i)
+        {
+            const double a = double(i % 100);
+            if (cache.Evaluate(expression, {a, 1}) != a * a - 1) wrong = true;
+        }
+    });
+    CHECK_FALSE(wrong.load());
+    CHECK(cache.Hits() + cache.Misses() == 20000);
+    CHECK(cache.Size() == 100);
+}
+
+TEST_CASE("The registry hands out stable metrics and snapshots them by name")
+{
+    MetricsRegistry metrics;
+    Counter&        counter = metrics.GetCounter("b.count");
+    counter.Add(3);
+    CHECK(&metrics.GetCounter("b.count") == &counter);
+    metrics.GetGauge("a.level").Set(-2);
+
+    const auto samples = metrics.Snapshot();
+    REQUIRE(samples.size() == 2);
+    CHECK(samples[0].name == "a.level");
+    CHECK(samples[0].kind == MetricSample::Kind::Gauge);
+    CHECK(samples[1].value == 3);
+    CHECK(metrics.Format() == "a.level -2\nb.count 3\n");
+}
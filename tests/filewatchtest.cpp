@@ -0,0 +1,337 @@
+#define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
+#include "doctest.h"
+
+#include <watch/file_tail.h>
+#include <watch/file_watcher.h>
+#include <watch/table_tail.h>
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#if !defined(_WIN32)
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+using namespace gomarky;
+
+#if !defined(_WIN32)
+
+namespace
+{
+
+// A fresh directory, removed with whatever is left in it when it goes out of scope.
+struct TempDirectory
+{
+    std::string path;
+
+    TempDirectory()
+    {
+        char name[] = "/tmp/gomarky-watch-XXXXXX";
+        REQUIRE(mkdtemp(name) != nullptr);
+        path = name;
+    }
+    ~TempDirectory()
+    {
+        for (const char* file : {"data.csv", "data.csv.1", "other.csv", "data.tmp"})
+        {
+            std::remove((path + "/" + file).c_str());
+        }
+        rmdir(path.c_str());
+    }
+
+    std::string File(const char* name) const { return path + "/" + name; }
+};
+
+void Write(const std::string& path, const std::string& text, const char* mode = "ab")
+{
+    FILE* file = std::fopen(path.c_str(), mode);
+    REQUIRE(file != nullptr);
+    std::fwrite(text.data(), 1, text.size(), file);
+    std::fclose(file);
+}
+
+// Collects the lines handed out by one Poll.
+std::string Lines(FileTail& tail, FileTail::Update* update = nullptr)
+{
+    std::string lines;
+    const auto  result = tail.Poll([&lines](const char* text, size_t size) { lines.append(text, size); });
+    if (update) *update = result;
+    return lines;
+}
+
+// Changes delivered by a FileWatcher, waited for from the test thread.
+struct Changes
+{
+    std::mutex              mutex;
+    std::condition_variable arrived;
+    std::vector<FileChange> received;
+
+    void Add(const FileChange& change)
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        received.push_back(change);
+        arrived.notify_all();
+    }
+
+    bool WaitFor(size_t count, std::chrono::milliseconds timeout = std::chrono::milliseconds(5000))
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        return arrived.wait_for(lock, timeout, [&] { return received.size() >= count; });
+    }
+
+    std::vector<FileChange> Take()
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        return std::move(received);
+    }
+};
+
+} // namespace
+
+TEST_CASE("Only appended bytes are read and partial lines are held back")
+{
+    TempDirectory directory;
+    const auto    path = directory.File("data.csv");
+    FileTail      tail(path, 4096);
+
+    FileTail::Update update;
+    CHECK(Lines(tail, &update).empty());
+    CHECK(update.missing);
+
+    Write(path, "one\ntwo\nthr");
+    CHECK(Lines(tail, &update) == "one\ntwo\n");
+    CHECK_FALSE(update.restarted);
+    CHECK(update.bytes == 11);
+
+    Write(path, "ee\nfour\n");
+    CHECK(Lines(tail, &update) == "three\nfour\n");
+    CHECK(update.bytes == 8);
+    CHECK(tail.Offset() == 19);
+
+    CHECK(Lines(tail, &update).empty());
+    CHECK(update.bytes == 0);
+
+    // Lines longer than a chunk come out whole.
+    const std::string longer(10000, 'x');
+    Write(path, longer + "\nend\n");
+    CHECK(Lines(tail) == longer + "\nend\n");
+}
+
+TEST_CASE("Truncation, rewrites and replacement start over")
+{
+    TempDirectory directory;
+    const auto    path = directory.File("data.csv");
+    FileTail      tail(path);
+
+    Write(path, "a,1\nb,2\n");
+    CHECK(Lines(tail) == "a,1\nb,2\n");
+
+    FileTail::Update update;
+    Write(path, "c\n", "wb"); // truncated to a smaller size
+    CHECK(Lines(tail, &update) == "c\n");
+    CHECK(update.restarted);
+
+    Write(path, "d,4\ne,5\nf,6\n", "wb"); // truncated and rewritten past the old size
+    CHECK(Lines(tail, &update) == "d,4\ne,5\nf,6\n");
+    CHECK(update.restarted);
+
+    // Rotation: the old file is renamed away and a new one takes its name.
+    REQUIRE(std::rename(path.c_str(), directory.File("data.csv.1").c_str()) == 0);
+    Write(path, "g,7\n");
+    CHECK(Lines(tail, &update) == "g,7\n");
+    CHECK(update.restarted);
+
+    bool restarted = false;
+    REQUIRE(std::remove(path.c_str()) == 0);
+    update = tail.Poll({}, [&restarted] { restarted = true; });
+    CHECK(update.missing);
+    CHECK(update.restarted);
+    CHECK(restarted);
+}
+
+TEST_CASE("A tailed table parses the new lines and reloads after truncation")
+{
+    TempDirectory directory;
+    const auto    path = directory.File("data.csv");
+    TableTail     table(path);
+
+    Write(path, "time,value,host\n1,0.5,alpha\n2,1.5,be");
+    auto update = table.Poll();
+    CHECK_FALSE(update.reloaded);
+    REQUIRE(update.rows->RowCount() == 1);
+    CHECK(update.rows->At(2).Name() == "host");
+
+    ColumnTable all;
+    all.AppendRows(*update.rows);
+
+    Write(path, "ta\n3,2.5,gamma\n");
+    update = table.Poll();
+    CHECK_FALSE(update.reloaded);
+    REQUIRE(update.rows->RowCount() == 2);
+    REQUIRE(all.CanAppend(*update.rows));
+    all.AppendRows(*update.rows);
+    CHECK(all.RowCount() == 3);
+    CHECK(static_cast<const StringColumn&>(all.At(2)).Value(1) == "beta");
+    CHECK(static_cast<const Int64Column&>(all.At(0)).Value(2) == 3);
+
+    update = table.Poll();
+    CHECK(update.rows->RowCount() == 0);
+    CHECK(update.rows->ColumnCount() == 3);
+
+    // A new header after truncation brings new columns.
+    Write(path, "name\nomega\n", "wb");
+    update = table.Poll();
+    CHECK(update.reloaded);
+    REQUIRE(update.rows->ColumnCount() == 1);
+    CHECK(update.rows->At(0).Name() == "name");
+    CHECK(update.rows->RowCount() == 1);
+}
+
+TEST_CASE("Bursts of writes are coalesced into one notification")
+{
+    for (bool polling : {false, true})
+    {
+        TempDirectory          directory;
+        const auto             path = directory.File("data.csv");
+        FileWatcher::Options   options;
+        options.coalesce      = std::chrono::milliseconds(200);
+        options.poll_interval = std::chrono::milliseconds(50);
+        options.force_polling = polling;
+        FileWatcher watcher(options);
+#if defined(__linux__)
+        CHECK(watcher.GetBackend() == (polling ? FileWatcher::Backend::Polling : FileWatcher::Backend::Inotify));
+#endif
+        Changes changes;
+        Changes others;
+        watcher.Watch(path, [&changes](const FileChange& change) { changes.Add(change); });
+        watcher.Watch(directory.File("other.csv"), [&others](const FileChange& change) { others.Add(change); });
+        std::this_thread::sleep_for(std::chrono::milliseconds(100));
+
+        Write(path, "header\n");
+        if (polling) std::this_thread::sleep_for(std::chrono::milliseconds(150));
+        for (int i = 0; i < 100; ++i) Write(path, std::to_string(i) + "\n");
+        REQUIRE(changes.WaitFor(1));
+        if (!polling)
+        {
+            // The writes all fell in the first window.
+            std::this_thread::sleep_for(std::chrono::milliseconds(300));
+            const auto received = changes.Take();
+            REQUIRE(received.size() == 1);
+            CHECK(received[0].path == path);
+            CHECK(received[0].replaced); // created
+            CHECK(received[0].modified);
+        }
+        else
+        {
+            changes.WaitFor(2, std::chrono::milliseconds(300));
+            const auto received = changes.Take();
+            CHECK(received.size() <= 2);
+            CHECK(received.front().replaced);
+        }
+        CHECK(others.Take().empty());
+
+        // Rotation shows as a replacement of the watched name.
+        REQUIRE(std::rename(path.c_str(), directory.File("data.csv.1").c_str()) == 0);
+        Write(path, "header\n");
+        REQUIRE(changes.WaitFor(1));
+        std::this_thread::sleep_for(std::chrono::milliseconds(300));
+        bool replaced = false;
+        for (const auto& change : changes.Take()) replaced = replaced || change.replaced;
+        CHECK(replaced);
+    }
+}
+
+TEST_CASE("A watched directory that goes away is watched again when it comes back")
+{
+    for (bool polling : {false, true})
+    {
+        TempDirectory        directory;
+        const auto           path = directory.File("data.csv");
+        FileWatcher::Options options;
+        options.coalesce      = std::chrono::milliseconds(10);
+        options.poll_interval = std::chrono::milliseconds(50);
+        options.force_polling = polling;
+        FileWatcher watcher(options);
+
+        Changes changes;
+        watcher.Watch(path, [&changes](const FileChange& change) { changes.Add(change); });
+        Write(path, "x\n");
+        REQUIRE(changes.WaitFor(1));
+        changes.Take();
+
+        REQUIRE(std::remove(path.c_str()) == 0);
+        REQUIRE(rmdir(directory.path.c_str()) == 0);
+        REQUIRE(changes.WaitFor(1));
+        std::this_thread::sleep_for(std::chrono::milliseconds(100));
+        bool removed = false;
+        for (const auto& change : changes.Take()) removed = removed || change.removed;
+        CHECK(removed);
+
+        REQUIRE(mkdir(directory.path.c_str(), 0700) == 0);
+        Write(path, "y\n");
+        REQUIRE(changes.WaitFor(1));
+        std::this_thread::sleep_for(std::chrono::milliseconds(100));
+        bool replaced = false;
+        for (const auto& change : changes.Take()) replaced = replaced || change.replaced;
+        CHECK(replaced);
+        CHECK(watcher.LastError().empty());
+
+        // And it keeps reporting from there on.
+        Write(path, "z\n");
+        CHECK(changes.WaitFor(1));
+    }
+}
+
+TEST_CASE("Files in one directory spelled two ways share its watch")
+{
+    TempDirectory        directory;
+    const auto           path  = directory.File("data.csv");
+    const std::string    other = directory.path + "/../" + directory.path.substr(5) + "/other.csv";
+    FileWatcher::Options options;
+    options.coalesce = std::chrono::milliseconds(10);
+    FileWatcher watcher(options);
+
+    Changes changes;
+    Changes others;
+    watcher.Watch(path, [&changes](const FileChange& change) { changes.Add(change); });
+    const uint64_t id = watcher.Watch(other, [&others](const FileChange& change) { others.Add(change); });
+    Write(path, "x\n");
+    Write(directory.File("other.csv"), "x\n");
+    REQUIRE(changes.WaitFor(1));
+    REQUIRE(others.WaitFor(1));
+    CHECK(others.Take().front().path == other);
+    changes.Take();
+
+    // Dropping the second spelling keeps the watch the first one relies on.
+    watcher.Unwatch(id);
+    Write(path, "y\n");
+    CHECK(changes.WaitFor(1));
+    CHECK(watcher.LastError().empty());
+}
+
+TEST_CASE("Unwatched files are no longer reported")
+{
+    TempDirectory        directory;
+    const auto           path = directory.File("data.csv");
+    FileWatcher::Options options;
+    options.coalesce = std::chrono::milliseconds(10);
+    FileWatcher watcher(options);
+
+    Changes        changes;
+    const uint64_t id = watcher.Watch(path, [&changes](const FileChange& change) { changes.Add(change); });
+    Write(path, "x\n");
+    REQUIRE(changes.WaitFor(1));
+    changes.Take();
+
+    watcher.Unwatch(id);
+    Write(path, "y\n");
+    CHECK_FALSE(changes.WaitFor(1, std::chrono::milliseconds(200)));
+}
+
+#endif
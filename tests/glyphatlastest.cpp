@@ -0,0 +1,121 @@
+#define DOCTEST_CONFIG_IMPLEMENT
+#include "doctest.h"
+
+#include <text/glyph_atlas.h>
+
+#include <cstdlib>
+
+#include <QBuffer>
+#include <QGlyphRun>
+#include <QGuiApplication>
+#include <QPainter>
+#include <QRawFont>
+
+using namespace gomarky;
+
+namespace
+{
+
+QRect InkBounds(const QImage& image)
+{
+    QRect bounds;
+    for (int y = 0; y < image.height(); ++y)
+    {
+        for (int x = 0; x < image.width(); ++x)
+        {
+            if (image.pixel(x, y) != qRgb(255, 255, 255)) bounds |= QRect(x, y, 1, 1);
+        }
+    }
+    return bounds;
+}
+
+GlyphAtlas BuildAsciiAtlas()
+{
+    QFont font;
+    font.setPixelSize(16);
+    return GlyphAtlas::Build(QRawFont::fromFont(font), QStringLiteral("Hello World!"));
+}
+
+} // namespace
+
+TEST_CASE("Atlases survive a save and load with the same stamp only")
+{
+    const GlyphAtlas atlas = BuildAsciiAtlas();
+    REQUIRE_FALSE(atlas.IsEmpty());
+    CHECK(atlas.Covers(QStringLiteral("Hello")));
+    CHECK_FALSE(atlas.Covers(QStringLiteral("Hex")));
+    REQUIRE(atlas.Find(QLatin1Char(' ')) != nullptr);
+    CHECK(atlas.Find(QLatin1Char(' '))->source.isEmpty()); // advance only
+
+    QBuffer buffer;
+    buffer.open(QIODevice::WriteOnly);
+    REQUIRE(atlas.Save(buffer, "stamp"));
+    buffer.close();
+
+    GlyphAtlas loaded;
+    buffer.open(QIODevice::ReadOnly);
+    REQUIRE(GlyphAtlas::Load(buffer, "stamp", loaded));
+    buffer.close();
+    CHECK(loaded.Mask() == atlas.Mask());
+    CHECK(loaded.Width(QStringLiteral("Hello World!")) == atlas.Width(QStringLiteral("Hello World!")));
+    CHECK(loaded.Ascent() == atlas.Ascent());
+
+    buffer.open(QIODevice::ReadOnly);
+    CHECK_FALSE(GlyphAtlas::Load(buffer, "other stamp", loaded));
+    buffer.close();
+
+    QByteArray truncated = buffer.data();
+    truncated.chop(100);
+    QBuffer truncated_buffer(&truncated);
+    truncated_buffer.open(QIODevice::ReadOnly);
+    CHECK_FALSE(GlyphAtlas::Load(truncated_buffer, "stamp", loaded));
+}
+
+TEST_CASE("Text drawn from the atlas lands where Qt would draw it")
+{
+    QFont font;
+    font.setPixelSize(16);
+    font.setHintingPreference(QFont::PreferNoHinting);
+    const QRawFont   raw   = QRawFont::fromFont(font);
+    const GlyphAtlas atlas = GlyphAtlas::Build(raw, QStringLiteral("Hi"));
+    REQUIRE(atlas.Covers(QStringLiteral("Hi")));
+
+    QImage from_atlas(64, 32, QImage::Format_ARGB32_Premultiplied);
+    from_atlas.fill(Qt::white);
+    {
+        QPainter painter(&from_atlas);
+        atlas.Draw(painter, QPointF(4, 20), QStringLiteral("Hi"), Qt::black);
+    }
+
+    QImage from_qt(64, 32, QImage::Format_ARGB32_Premultiplied);
+    from_qt.fill(Qt::white);
+    {
+        QGlyphRun run;
+        run.setRawFont(raw);
+        run.setGlyphIndexes(raw.glyphIndexesForString(QStringLiteral("Hi")));
+        QVector<QPointF> positions{QPointF(0, 0)};
+        positions.append(QPointF(qRound(atlas.Width(QStringLiteral("H"))), 0));
+        run.setPositions(positions);
+        QPainter painter(&from_qt);
+        painter.setPen(Qt::black);
+        painter.drawGlyphRun(QPointF(4, 20), run);
+    }
+    // Blending differs slightly from Qt's glyph blitting, so compare placement, not pixels.
+    const QRect atlas_ink = InkBounds(from_atlas);
+    const QRect qt_ink    = InkBounds(from_qt);
+    REQUIRE_FALSE(qt_ink.isEmpty());
+    CHECK(std::abs(atlas_ink.left() - qt_ink.left()) <= 1);
+    CHECK(std::abs(atlas_ink.top() - qt_ink.top()) <= 1);
+    CHECK(std::abs(atlas_ink.right() - qt_ink.right()) <= 1);
+    CHECK(std::abs(atlas_ink.bottom() - qt_ink.bottom()) <= 1);
+}
+
+int main(int argc, char** argv)
+{
+    qputenv("QT_QPA_PLATFORM", "offscreen");
+    QGuiApplication app(argc, argv);
+
+    doctest::Context context;
+    context.applyCommandLine(argc, argv);
+    return context.run();
+}
@@ -0,0 +1,165 @@
+#define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
+#include "doctest.h"
+
+#include <metrics/hdr_histogram.h>
+#include <metrics/metrics_registry.h>
+
+#include <algorithm>
+#include <cmath>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace gomarky;
+
+TEST_CASE("Percentiles stay within the configured precision")
+{
+    HdrHistogram          histogram(1, 3600000000ull, 3);
+    std::vector<uint64_t> values;
+    std::mt19937_64       random(7);
+    for (int i = 0; i < 100000; ++i)
+    {
+        // Log-uniform over nine decades, like real latencies.
+        const uint64_t value = static_cast<uint64_t>(std::pow(10.0, std::uniform_real_distribution<double>(0, 9)(random)));
+        values.push_back(value);
+        histogram.Record(value);
+    }
+    std::sort(values.begin(), values.end());
+
+    CHECK(histogram.TotalCount() == values.size());
+    CHECK(histogram.Min() == values.front());
+    CHECK(histogram.Max() == values.back());
+    for (double percentile : {1.0, 25.0, 50.0, 90.0, 99.0, 99.9, 100.0})
+    {
+        const size_t rank     = std::max<size_t>(1, size_t(percentile / 100.0 * values.size() + 0.5));
+        const double expected = double(values[rank - 1]);
+        const double actual   = double(histogram.ValueAtPercentile(percentile));
+        CHECK(std::abs(actual - expected) <= expected * 1e-3 + 1);
+    }
+}
+
+TEST_CASE("Equivalent ranges and clamping")
+{
+    HdrHistogram histogram(1, 1000000, 2);
+    CHECK(histogram.LowestEquivalent(10) == 10);
+    CHECK(histogram.HighestEquivalent(10) == 10);
+    CHECK(histogram.LowestEquivalent(100000) <= 100000);
+    CHECK(histogram.HighestEquivalent(100000) >= 100000);
+    CHECK(histogram.HighestEquivalent(100000) - histogram.LowestEquivalent(100000) < 1000);
+
+    histogram.Record(5000000);
+    CHECK(histogram.Max() == 1000000);
+    CHECK(HdrHistogram(1, 1000, 1).ValueAtPercentile(50) == 0);
+
+    CHECK_THROWS_AS(HdrHistogram(0, 100, 2), std::invalid_argument);
+    CHECK_THROWS_AS(HdrHistogram(10, 15, 2), std::invalid_argument);
+    CHECK_THROWS_AS(HdrHistogram(1, 100, 6), std::invalid_argument);
+    CHECK_THROWS_AS(HdrHistogram(uint64_t(1) << 60, UINT64_MAX, 1), std::invalid_argument);
+    CHECK_NOTHROW(HdrHistogram(uint64_t(1) << 40, uint64_t(1) << 50, 3));
+}
+
+TEST_CASE("Serialization round-trips compactly")
+{
+    HdrHistogram histogram(1, 3600000000ull, 3);
+    for (uint64_t value = 1; value < 1000000; value = value * 3 / 2 + 1) histogram.Record(value, value % 7 + 1);
+
+    const std::string data = histogram.Serialize();
+    CHECK(data.size() < 1000);
+    CHECK(data.size() * 20 < histogram.Footprint());
+
+    const HdrHistogram copy = HdrHistogram::Deserialize(data);
+    CHECK(copy.TotalCount() == histogram.TotalCount());
+    CHECK(copy.Min() == histogram.Min());
+    CHECK(copy.Max() == histogram.Max());
+    for (double percentile : {10.0, 50.0, 99.0}) CHECK(copy.ValueAtPercentile(percentile) == histogram.ValueAtPercentile(percentile));
+    CHECK(copy.Serialize() == data);
+
+    CHECK_THROWS_AS(HdrHistogram::Deserialize(""), std::invalid_argument);
+    CHECK_THROWS_AS(HdrHistogram::Deserialize(data.substr(0, data.size() - 1)), std::invalid_argument);
+    CHECK_THROWS_AS(HdrHistogram::Deserialize(data + 'x'), std::invalid_argument);
+}
+
+TEST_CASE("Adding requires matching layouts")
+{
+    HdrHistogram a(1, 100000, 2);
+    HdrHistogram b(1, 100000, 2);
+    a.Record(10);
+    b.Record(20, 3);
+    a.Add(b);
+    CHECK(a.TotalCount() == 4);
+    CHECK(a.Min() == 10);
+    CHECK(a.Max() == 20);
+    CHECK(a.ValueAtPercentile(50) == 20);
+    CHECK(a.Mean() == doctest::Approx(17.5));
+
+    a.Reset();
+    CHECK(a.TotalCount() == 0);
+    CHECK(a.Min() == 0);
+    CHECK_THROWS_AS(a.Add(HdrHistogram(1, 100000, 3)), std::invalid_argument);
+}
+
+TEST_CASE("Recorders merge per-thread histograms while threads record")
+{
+    HdrRecorder              recorder(1, 1000000000, 3);
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 4; ++t)
+    {
+        threads.emplace_back([&recorder, t] {
+            for (uint64_t i = 1; i <= 10000; ++i) recorder.Record(i * (t + 1));
+        });
+    }
+    for (int i = 0; i < 10; ++i) CHECK(recorder.Snapshot().TotalCount() <= 40000);
+    for (auto& thread : threads) thread.join();
+
+    const HdrHistogram merged = recorder.Snapshot();
+    CHECK(merged.TotalCount() == 40000);
+    CHECK(merged.Min() == 1);
+    CHECK(merged.Max() == 40000);
+    CHECK(&recorder.ThisThread() == &recorder.ThisThread());
+
+    // A second recorder on the same thread gets its own histogram.
+    HdrRecorder other(1, 1000, 1);
+    other.Record(5);
+    CHECK(other.Snapshot().TotalCount() == 1);
+    CHECK(recorder.Snapshot().TotalCount() == 40000);
+
+    // Threads outliving many recorders forget the destroyed ones.
+    for (int i = 0; i < 1000; ++i)
+    {
+        HdrRecorder temporary(1, 1000, 1);
+        temporary.Record(7);
+        other.Record(7);
+        CHECK(temporary.Snapshot().TotalCount() == 1);
+    }
+    CHECK(other.Snapshot().TotalCount() == 1001);
+}
+
+TEST_CASE("Exporters list percentiles up to the maximum")
+{
+    HdrHistogram histogram(1, 100000, 3);
+    for (uint64_t value = 1; value <= 1000; ++value) histogram.Record(value);
+
+    const std::string text = FormatPercentiles(histogram, 5, 1.0);
+    CHECK(text.find("Value     Percentile TotalCount") != std::string::npos);
+    CHECK(text.find("1000.000 1.000000000000       1000") != std::string::npos);
+    CHECK(text.find("#[Max =     1000.000, Total count =         1000]") != std::string::npos);
+
+    const std::string csv = FormatPercentilesCsv(histogram);
+    CHECK(csv.find("value,percentile,total_count,inverted_percentile\n1.000,0.000000000000,1,1.00\n") == 0);
+    CHECK(csv.find("500.000,0.500000000000,500,2.00\n") != std::string::npos);
+    CHECK(csv.find("1000.000,1.0,1000,Infinity\n") != std::string::npos);
+
+    CHECK(FormatSummary(histogram) == "count=1000 min=1 p50=500 p90=900 p99=990 p99.9=999 max=1000");
+    CHECK(FormatSummary(histogram, 1000.0).find("p50=0.5 ") != std::string::npos);
+}
+
+TEST_CASE("The registry hands out named latency histograms")
+{
+    MetricsRegistry registry;
+    HdrRecorder&    dispatch = registry.GetHistogram("event.dispatch_ns");
+    CHECK(&dispatch == &registry.GetHistogram("event.dispatch_ns"));
+    dispatch.Record(1200);
+    CHECK(registry.Format() == "event.dispatch_ns count=1 min=1200 p50=1200 p90=1200 p99=1200 p99.9=1200 max=1200\n");
+}
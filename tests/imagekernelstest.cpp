@@ -0,0 +1,138 @@
+#define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
+#include "doctest.h"
+
+#include <concurrency/worker_pool.h>
+#include <image/image_kernels.h>
+#include <image/image_reference.h>
+
+#include <random>
+#include <vector>
+
+using namespace gomarky;
+
+namespace
+{
+
+// Owns the pixels behind an ImageView; odd sizes and padded rows make sure tails are exercised.
+struct TestImage
+{
+    int                  width;
+    int                  height;
+    int                  stride_pixels;
+    std::vector<uint32_t> pixels;
+
+    TestImage(int w, int h, uint32_t seed) : width(w), height(h), stride_pixels(w + 3), pixels(size_t(stride_pixels * h))
+    {
+        std::mt19937 rng(seed);
+        for (auto& pixel : pixels) pixel = rng();
+    }
+
+    // Valid premultiplied content: no channel above alpha.
+    void MakePremultiplied()
+    {
+        for (auto& pixel : pixels)
+        {
+            const uint32_t a = pixel >> 24;
+            uint32_t       out = a << 24;
+            for (int shift = 0; shift < 24; shift += 8) out |= ((((pixel >> shift) & 0xff) * a) / 255) << shift;
+            pixel = out;
+        }
+    }
+
+    ImageView View() { return {reinterpret_cast<uint8_t*>(pixels.data()), width, height, ptrdiff_t(stride_pixels) * 4}; }
+
+    bool SamePixels(const TestImage& other) const
+    {
+        for (int y = 0; y < height; ++y)
+        {
+            for (int x = 0; x < width; ++x)
+            {
+                if (pixels[size_t(y * stride_pixels + x)] != other.pixels[size_t(y * other.stride_pixels + x)]) return false;
+            }
+        }
+        return true;
+    }
+};
+
+const SimdLevel kLevels[] = {SimdLevel::Scalar, SimdLevel::Sse2, SimdLevel::Avx2};
+
+} // namespace
+
+TEST_CASE("Premultiply and unpremultiply match the reference on every path")
+{
+    WorkerPool pool(3);
+    for (SimdLevel level : kLevels)
+    {
+        SetMaxSimdLevel(level);
+        TestImage image(131, 37, 1), expected = image;
+        Premultiply(image.View(), pool);
+        reference::Premultiply(expected.View());
+        CHECK(image.SamePixels(expected));
+
+        TestImage premultiplied(131, 37, 2);
+        premultiplied.MakePremultiplied();
+        TestImage expected_unpremultiplied = premultiplied;
+        Unpremultiply(premultiplied.View(), pool);
+        reference::Unpremultiply(expected_unpremultiplied.View());
+        CHECK(premultiplied.SamePixels(expected_unpremultiplied));
+    }
+    SetMaxSimdLevel(SimdLevel::Avx2);
+}
+
+TEST_CASE("Box blur matches the reference on every path")
+{
+    WorkerPool pool(3);
+    for (SimdLevel level : kLevels)
+    {
+        SetMaxSimdLevel(level);
+        for (int radius : {1, 4, 40})
+        {
+            TestImage image(301, 53, 3), expected = image;
+            BoxBlur(image.View(), radius, pool);
+            reference::BoxBlur(expected.View(), radius);
+            CHECK(image.SamePixels(expected));
+        }
+    }
+    SetMaxSimdLevel(SimdLevel::Avx2);
+}
+
+TEST_CASE("Resize matches the reference on every path and filter")
+{
+    WorkerPool pool(3);
+    for (SimdLevel level : kLevels)
+    {
+        SetMaxSimdLevel(level);
+        for (ResizeFilter filter : {ResizeFilter::Box, ResizeFilter::Triangle, ResizeFilter::Lanczos3})
+        {
+            TestImage source(257, 121, 4);
+            source.MakePremultiplied();
+            for (auto size : {std::make_pair(64, 30), std::make_pair(503, 250), std::make_pair(1, 1)})
+            {
+                TestImage result(size.first, size.second, 5), expected = result;
+                Resize(source.View(), result.View(), filter, pool);
+                reference::Resize(source.View(), expected.View(), filter);
+                CHECK(result.SamePixels(expected));
+            }
+        }
+    }
+    SetMaxSimdLevel(SimdLevel::Avx2);
+}
+
+TEST_CASE("Resizing a flat image keeps it flat")
+{
+    WorkerPool pool(2);
+    TestImage  source(100, 100, 6), result(37, 211, 7);
+    for (auto& pixel : source.pixels) pixel = 0xff336699;
+    Resize(source.View(), result.View(), ResizeFilter::Lanczos3, pool);
+    CHECK(result.pixels[0] == 0xff336699);
+    CHECK(result.pixels[size_t(36 * result.stride_pixels + 36)] == 0xff336699);
+}
+
+TEST_CASE("Gaussian radii approximate the requested sigma")
+{
+    int radii[3];
+    GaussianBoxRadii(2.0, radii);
+    double variance = 0;
+    for (int r : radii) variance += ((2.0 * r + 1) * (2.0 * r + 1) - 1) / 12.0;
+    CHECK(std::abs(variance - 4.0) < 1.0);
+}
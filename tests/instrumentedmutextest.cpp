@@ -0,0 +1,132 @@
+#define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
+#include "doctest.h"
+
+#include <concurrency/instrumented_mutex.h>
+#include <metrics/metrics_registry.h>
+
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <shared_mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace gomarky;
+
+namespace
+{
+
+const LockProfiler::SiteReport* Find(const std::vector<LockProfiler::SiteReport>& reports, const std::string& name)
+{
+    for (const auto& report : reports)
+    {
+        if (report.name == name) return &report;
+    }
+    return nullptr;
+}
+
+// Hold `mutex` for `ms` while another thread blocks on it.
+template<typename Mutex, typename Lock>
+void Contend(Mutex& mutex, int ms, Lock lock_from_other_thread)
+{
+    std::atomic<bool> held{false};
+    std::thread       holder([&] {
+        std::lock_guard<Mutex> lock(mutex);
+        held = true;
+        std::this_thread::sleep_for(std::chrono::milliseconds(ms));
+    });
+    while (!held) std::this_thread::yield();
+    lock_from_other_thread();
+    holder.join();
+}
+
+} // namespace
+
+TEST_CASE("Uncontended acquisitions are counted without waits")
+{
+    LockProfiler::Reset();
+    InstrumentedMutex mutex(GM_LOCK_SITE("test.quiet"));
+    for (int i = 0; i < 1000; ++i)
+    {
+        std::lock_guard<InstrumentedMutex> lock(mutex);
+    }
+    CHECK(mutex.try_lock());
+    mutex.unlock();
+
+    const auto  reports = LockProfiler::Report();
+    const auto* quiet   = Find(reports, "test.quiet");
+    REQUIRE(quiet);
+    CHECK(quiet->acquisitions == 1001);
+    CHECK(quiet->contended == 0);
+    CHECK(quiet->wait_ns == 0);
+    CHECK(quiet->line > 0);
+    CHECK(LockProfiler::Format().find("test.quiet") == std::string::npos);
+}
+
+TEST_CASE("Waits and holds are attributed to the call site")
+{
+    LockProfiler::Reset();
+    InstrumentedMutex mutex(GM_LOCK_SITE("test.declared"));
+    Contend(mutex, 20, [&] { SiteLockGuard<InstrumentedMutex> lock(mutex, GM_LOCK_SITE("test.waiter")); });
+
+    const auto  reports  = LockProfiler::Report();
+    const auto* declared = Find(reports, "test.declared");
+    const auto* waiter   = Find(reports, "test.waiter");
+    REQUIRE(declared);
+    REQUIRE(waiter);
+    CHECK(declared->contended == 0);
+    CHECK(declared->mean_hold_ns > 10e6); // the first acquisition is always sampled
+    CHECK(waiter->contended == 1);
+    CHECK(waiter->wait_ns > 5e6);
+    CHECK(reports.front().name == "test.waiter");
+
+    const std::string text = LockProfiler::Format(1);
+    CHECK(text.find("test.waiter (") == 0);
+    CHECK(text.find("1 of 1 acquisitions contended") != std::string::npos);
+}
+
+TEST_CASE("Shared mutexes count shared and exclusive waits")
+{
+    LockProfiler::Reset();
+    InstrumentedSharedMutex mutex(GM_LOCK_SITE("test.shared"));
+    {
+        std::shared_lock<InstrumentedSharedMutex> a(mutex);
+        std::shared_lock<InstrumentedSharedMutex> b(mutex);
+        CHECK(mutex.try_lock_shared());
+        mutex.unlock_shared();
+        CHECK_FALSE(mutex.try_lock());
+    }
+    Contend(mutex, 10, [&] { std::shared_lock<InstrumentedSharedMutex> lock(mutex); });
+
+    const auto  reports = LockProfiler::Report();
+    const auto* shared  = Find(reports, "test.shared");
+    REQUIRE(shared);
+    CHECK(shared->acquisitions == 5);
+    CHECK(shared->contended == 1);
+}
+
+TEST_CASE("Counts survive many threads and are published as gauges")
+{
+    LockProfiler::Reset();
+    InstrumentedMutex        mutex(GM_LOCK_SITE("test.busy"));
+    int                      value = 0;
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 4; ++t)
+    {
+        threads.emplace_back([&] {
+            for (int i = 0; i < 10000; ++i)
+            {
+                std::lock_guard<InstrumentedMutex> lock(mutex);
+                ++value;
+            }
+        });
+    }
+    for (auto& thread : threads) thread.join();
+    CHECK(value == 40000);
+
+    MetricsRegistry registry;
+    LockProfiler::Publish(registry);
+    CHECK(registry.GetGauge("lock.test.busy.acquisitions").Value() == 40000);
+    CHECK(registry.GetGauge("lock.test.busy.contended").Value() >= 0);
+}
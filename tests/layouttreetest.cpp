@@ -0,0 +1,96 @@
+#define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
+#include "doctest.h"
+
+#include <layout/layout_tree.h>
+
+#include <vector>
+
+using namespace gomarky;
+
+using Rect = LayoutTree::Rect;
+using Size = LayoutTree::Size;
+
+TEST_CASE("Rows distribute spare space by stretch and shrink proportionally")
+{
+    LayoutTree tree(LayoutTree::Kind::Row);
+    tree.SetSpacing(LayoutTree::kRoot, 10, 5);
+    const auto a = tree.AddLeaf(LayoutTree::kRoot, Size{100, 20});
+    const auto b = tree.AddLeaf(LayoutTree::kRoot, Size{50, 40}, LayoutTree::Slot{1, 0, 0});
+    CHECK(tree.Hint(LayoutTree::kRoot) == (Size{170, 50}));
+
+    CHECK(tree.Arrange(Rect{0, 0, 300, 60}).size() == 2);
+    CHECK(tree.Geometry(a) == (Rect{5, 5, 100, 50}));
+    CHECK(tree.Geometry(b) == (Rect{115, 5, 180, 50}));
+
+    tree.Arrange(Rect{0, 0, 90, 60}); // 70 usable for 150 preferred
+    CHECK(tree.Geometry(a).width == 46);
+    CHECK(tree.Geometry(b).width == 23);
+}
+
+TEST_CASE("Grid tracks follow the largest cell and hints fold upwards")
+{
+    LayoutTree tree(LayoutTree::Kind::Column);
+    const auto grid = tree.AddContainer(LayoutTree::kRoot, LayoutTree::Kind::Grid);
+    tree.SetSpacing(grid, 2);
+    std::vector<LayoutTree::NodeId> cells;
+    for (int row = 0; row < 3; ++row)
+    {
+        for (int column = 0; column < 4; ++column)
+        {
+            cells.push_back(tree.AddLeaf(grid, Size{10 + column, 5}, LayoutTree::Slot{0, row, column}));
+        }
+    }
+    CHECK(tree.Hint(grid) == (Size{10 + 11 + 12 + 13 + 3 * 2, 3 * 5 + 2 * 2}));
+    CHECK(tree.Hint(LayoutTree::kRoot) == tree.Hint(grid));
+
+    const Size hint = tree.Hint(grid);
+    tree.Arrange(Rect{0, 0, hint.width, hint.height});
+    CHECK(tree.Geometry(cells[5]) == (Rect{12, 7, 11, 5}));
+
+    tree.SetLeafHint(cells[5], Size{30, 5});
+    CHECK(tree.Hint(LayoutTree::kRoot).width == hint.width + 19);
+    tree.SetLeafHint(cells[5], Size{11, 5});
+    CHECK(tree.Hint(LayoutTree::kRoot) == hint);
+}
+
+TEST_CASE("A cell change inside its track extents stays local")
+{
+    LayoutTree tree(LayoutTree::Kind::Column);
+    const auto header = tree.AddLeaf(LayoutTree::kRoot, Size{200, 30});
+    const auto body   = tree.AddContainer(LayoutTree::kRoot, LayoutTree::Kind::Row);
+    const auto grid   = tree.AddContainer(body, LayoutTree::Kind::Grid); // keeps its preferred width
+    std::vector<LayoutTree::NodeId> cells;
+    for (int row = 0; row < 100; ++row)
+    {
+        for (int column = 0; column < 50; ++column)
+        {
+            cells.push_back(tree.AddLeaf(grid, Size{column == 7 ? 80 : 60, 18}, LayoutTree::Slot{0, row, column}));
+        }
+    }
+    CHECK(tree.Arrange(Rect{0, 0, 4000, 2000}).size() == cells.size() + 1);
+    CHECK_FALSE(tree.NeedsArrange());
+
+    // Narrower than the widest cell of its column: nothing moves, nothing is visited.
+    const auto cell = cells[42 * 50 + 7];
+    tree.SetLeafHint(cell, Size{70, 18});
+    CHECK_FALSE(tree.NeedsArrange());
+    CHECK(tree.Arrange(Rect{0, 0, 4000, 2000}).empty());
+    CHECK(tree.LastArrangeVisits() == 1);
+
+    // Widening the column moves only that column and the ones to its right.
+    tree.SetLeafHint(cell, Size{120, 18});
+    CHECK(tree.NeedsArrange());
+    const auto changes = tree.Arrange(Rect{0, 0, 4000, 2000});
+    CHECK(changes.size() < cells.size());
+    for (const auto& change : changes)
+    {
+        const auto index = change.node - cells.front();
+        CHECK(index % 50 >= 7);
+    }
+    CHECK(tree.Geometry(header) == (Rect{0, 0, 4000, 30}));
+
+    // A second change to the same cell in the same frame folds into one pass.
+    tree.SetLeafHint(cell, Size{60, 18});
+    tree.SetLeafHint(cell, Size{120, 18});
+    CHECK(tree.Arrange(Rect{0, 0, 4000, 2000}).empty());
+}
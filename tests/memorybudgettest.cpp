@@ -0,0 +1,86 @@
+#define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
+#include "doctest.h"
+
+#include "budget.h"
+
+#include <metrics/hdr_histogram.h>
+#include <table/column_table.h>
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#if defined(_WIN32)
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#include <windows.h>
+#include <psapi.h>
+#else
+#include <sys/resource.h>
+#endif
+
+using namespace gomarky;
+using budget::Budget;
+
+namespace
+{
+
+constexpr size_t kRows = 1000000;
+
+double PeakRssMegabytes()
+{
+#if defined(_WIN32)
+    PROCESS_MEMORY_COUNTERS counters;
+    GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters));
+    return double(counters.PeakWorkingSetSize) / (1 << 20);
+#else
+    rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+#if defined(__APPLE__)
+    return double(usage.ru_maxrss) / (1 << 20); // bytes
+#else
+    return double(usage.ru_maxrss) / (1 << 10); // kilobytes
+#endif
+#endif
+}
+
+// A million rows of sales records: a region key out of a thousand, a quantity and a price.
+std::unique_ptr<ColumnTable> LoadFixture()
+{
+    std::unique_ptr<ColumnTable> table(new ColumnTable);
+    auto&                        region   = table->AddStringColumn("region");
+    auto&                        quantity = table->AddInt64Column("quantity");
+    auto&                        price    = table->AddDoubleColumn("price");
+    table->Reserve(kRows);
+    for (size_t row = 0; row < kRows; ++row)
+    {
+        region.Append("region-" + std::to_string(row * 7919 % 1000));
+        if (row % 100 == 0) quantity.AppendNull();
+        else quantity.Append(static_cast<int64_t>(row % 97));
+        price.Append(double(row % 1000) / 8);
+    }
+    return table;
+}
+
+} // namespace
+
+TEST_CASE("Loading the sales fixture stays within its peak RSS")
+{
+    // Peak RSS only grows, so the runs mostly confirm the first load leaves nothing behind.
+    const Budget budget{"fixture.sales_1m.peak_rss", Budget::Direction::AtMost, 32, "MB", 0.10, false};
+    CHECK(budget::Check(budget, 3, [] {
+        auto table = LoadFixture();
+        CHECK(table->RowCount() == kRows);
+        return PeakRssMegabytes();
+    }));
+}
+
+TEST_CASE("Per-thread latency histograms stay small")
+{
+    // The registry's histograms: one per recording thread, so their footprint multiplies.
+    const Budget budget{"metrics.histogram.footprint", Budget::Direction::AtMost, 64, "KB", 0.0, false};
+    CHECK(budget::Check(budget, 1, [] {
+        return double(HdrHistogram(1, uint64_t(3600) * 1000000000, 2).Footprint()) / 1024;
+    }));
+}
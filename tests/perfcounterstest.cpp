@@ -0,0 +1,87 @@
+#define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
+#include "doctest.h"
+
+#include <metrics/metrics_registry.h>
+#include <metrics/perf_counters.h>
+
+#include <string>
+#include <vector>
+
+using namespace gomarky;
+
+namespace
+{
+
+// Enough work for the counters to register on any machine that has them.
+uint64_t Spin(int rounds)
+{
+    volatile uint64_t x = 1;
+    for (int i = 0; i < rounds; ++i) x = x * 3 + static_cast<uint64_t>(i);
+    return x;
+}
+
+} // namespace
+
+TEST_CASE("Samples add, subtract and compute IPC")
+{
+    PerfSample a;
+    a.cycles        = 100;
+    a.instructions  = 250;
+    a.cache_misses  = 3;
+    a.branch_misses = 4;
+    CHECK(a.Ipc() == doctest::Approx(2.5));
+    CHECK(PerfSample().Ipc() == 0.0);
+
+    PerfSample b = a;
+    b += a;
+    CHECK(b.instructions == 500);
+    const PerfSample d = b - a;
+    CHECK(d.cycles == 100);
+    CHECK(d.branch_misses == 4);
+}
+
+TEST_CASE("Counters either count or report why they cannot")
+{
+    PerfCounters& counters = PerfCounters::ThisThread();
+    CHECK(&counters == &PerfCounters::ThisThread());
+
+    PerfSample total;
+    {
+        PerfScope scope(total, counters);
+        Spin(1000000);
+    }
+    if (counters.Available())
+    {
+        CHECK(counters.Error().empty());
+        CHECK(total.instructions > 1000000);
+        const PerfSample first  = counters.Read();
+        Spin(1000);
+        const PerfSample second = counters.Read();
+        CHECK(second.instructions >= first.instructions);
+    }
+    else
+    {
+        CHECK_FALSE(counters.Error().empty());
+        CHECK_FALSE(counters.UsesRdpmc());
+        CHECK(total.cycles == 0);
+        CHECK(total.instructions == 0);
+    }
+}
+
+TEST_CASE("Zones record calls and counts in the registry")
+{
+    MetricsRegistry registry;
+    PerfZone        zone("spin", registry);
+    for (int i = 0; i < 3; ++i)
+    {
+        PerfZone::Scope scope(zone);
+        Spin(100000);
+    }
+    CHECK(zone.Calls() == 3);
+    CHECK(registry.GetCounter("perf.spin.calls").Value() == 3);
+    CHECK(registry.GetCounter("perf.spin.instructions").Value() == zone.Total().instructions);
+    CHECK(zone.Format().find("spin: 3 calls, IPC") == 0);
+
+    const std::vector<MetricSample> samples = registry.Snapshot();
+    CHECK(samples.size() == 5);
+}
@@ -0,0 +1,179 @@
+#define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
+#include "doctest.h"
+
+#include <reactive/reactive.h>
+
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+using namespace gomarky;
+
+TEST_CASE("Computed values are lazy and evaluated once per change")
+{
+    ReactiveContext context;
+    Property<int>   count(1, context);
+    int             evaluations = 0;
+    Computed<int>   doubled([&] { return ++evaluations, count.Get() * 2; }, context);
+
+    CHECK(evaluations == 0);
+    CHECK(doubled.Get() == 2);
+    CHECK(doubled.Get() == 2);
+    CHECK(evaluations == 1);
+
+    count.Set(5);
+    count.Set(6);
+    CHECK(evaluations == 1); // nothing is computed until read
+    CHECK(doubled.Get() == 12);
+    CHECK(evaluations == 2);
+
+    count.Set(6); // equal value, not a change
+    doubled.Get();
+    CHECK(evaluations == 2);
+}
+
+TEST_CASE("Diamond dependencies run their effect once, after both branches")
+{
+    ReactiveContext  context;
+    Property<int>    source(1, context);
+    Computed<int>    left([&] { return source.Get() + 1; }, context);
+    Computed<int>    right([&] { return source.Get() * 10; }, context);
+    std::vector<int> seen;
+    Effect           effect([&] { seen.push_back(left.Get() + right.Get()); }, context);
+
+    REQUIRE(seen.size() == 1);
+    CHECK(seen.back() == 12);
+    source.Set(2);
+    REQUIRE(seen.size() == 2);
+    CHECK(seen.back() == 23);
+}
+
+TEST_CASE("Unchanged intermediate values stop propagation")
+{
+    ReactiveContext context;
+    Property<int>   value(3, context);
+    Computed<bool>  positive([&] { return value.Get() > 0; }, context);
+    int             runs = 0;
+    Effect          effect([&] { ++runs, positive.Get(); }, context);
+
+    value.Set(4);
+    value.Set(100);
+    CHECK(runs == 1);
+    value.Set(-1);
+    CHECK(runs == 2);
+}
+
+TEST_CASE("Changes inside a batch propagate once, through the scheduler")
+{
+    ReactiveContext context;
+    int             scheduled = 0;
+    context.SetScheduler([&] { ++scheduled; });
+
+    Property<int> a(0, context), b(0, context);
+    int           runs = 0, last = 0;
+    Effect        effect([&] { ++runs, last = a.Get() + b.Get(); }, context);
+
+    for (int i = 1; i <= 1000; ++i)
+    {
+        a.Set(i);
+        b.Set(i);
+    }
+    CHECK(scheduled == 1);
+    CHECK(runs == 1);
+    context.Flush();
+    CHECK(runs == 2);
+    CHECK(last == 2000);
+
+    {
+        ReactiveContext::Batch batch(context);
+        a.Set(1);
+        CHECK(scheduled == 1);
+    }
+    CHECK(scheduled == 2);
+    context.Flush();
+    CHECK(runs == 3);
+}
+
+TEST_CASE("Dependencies follow the branch taken by the last evaluation")
+{
+    ReactiveContext       context;
+    Property<bool>        use_name(true, context);
+    Property<std::string> name(std::string("ada"), context), id(std::string("#1"), context);
+    int                   evaluations = 0;
+    Computed<std::string> label([&] { return ++evaluations, use_name.Get() ? name.Get() : id.Get(); }, context);
+
+    CHECK(label.Get() == "ada");
+    id.Set("#2"); // not a dependency yet
+    label.Get();
+    CHECK(evaluations == 1);
+
+    use_name.Set(false);
+    CHECK(label.Get() == "#2");
+    name.Set("grace"); // no longer a dependency
+    label.Get();
+    CHECK(evaluations == 2);
+}
+
+TEST_CASE("Observers are invalidated without anything being computed")
+{
+    ReactiveContext context;
+    Property<int>   value(1, context);
+    int             evaluations = 0;
+    Computed<int>   squared([&] { return ++evaluations, value.Get() * value.Get(); }, context);
+    int             invalidations = 0;
+    Observer        repaint([&] { ++invalidations; }, context);
+
+    repaint.Track([&] { squared.Get(); });
+    CHECK(evaluations == 1);
+
+    value.Set(2);
+    CHECK(invalidations == 1);
+    CHECK(evaluations == 1); // the repaint would read it
+
+    // Still stale below the observer: later changes must reach it anyway.
+    value.Set(3);
+    CHECK(invalidations == 2);
+    repaint.Track([&] { CHECK(squared.Get() == 9); });
+    CHECK(evaluations == 2);
+}
+
+TEST_CASE("Destroyed nodes leave the graph")
+{
+    ReactiveContext context;
+    Property<int>   value(1, context);
+    int             runs = 0;
+    {
+        Effect effect([&] { ++runs, value.Get(); }, context);
+        value.Set(2);
+    }
+    value.Set(3);
+    CHECK(runs == 2);
+}
+
+TEST_CASE("Effects that never settle are dropped by TryFlush")
+{
+    ReactiveContext context;
+    context.SetScheduler([] {});
+    Property<int> counter(0, context);
+    bool          runaway = true;
+    int           runs    = 0;
+    Effect        effect(
+        [&] {
+            ++runs;
+            const int value = counter.Get();
+            if (runaway) counter.Set(value + 1);
+        },
+        context);
+
+    CHECK_THROWS_AS(context.Flush(), std::runtime_error);
+    CHECK_FALSE(context.TryFlush());
+    const int dropped_at = runs;
+    CHECK(context.TryFlush()); // nothing left pending
+    CHECK(runs == dropped_at);
+
+    // The effect runs again once its input changes.
+    runaway = false;
+    counter.Set(0);
+    CHECK(context.TryFlush());
+    CHECK(runs == dropped_at + 1);
+}
@@ -0,0 +1,179 @@
+#define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
+#include "doctest.h"
+
+#include <concurrency/parallel_sort.h>
+#include <concurrency/worker_pool.h>
+#include <table/row_order.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <limits>
+#include <numeric>
+#include <random>
+#include <string>
+#include <utility>
+
+using namespace gomarky;
+
+TEST_CASE("ParallelFor covers every index once, even when nested")
+{
+    WorkerPool                    pool(4);
+    std::vector<std::atomic<int>> hits(1000);
+    pool.ParallelFor(10, 1, [&](size_t begin, size_t end) {
+        for (size_t outer = begin; outer < end; ++outer)
+        {
+            pool.ParallelFor(100, 7, [&](size_t b, size_t e) {
+                for (size_t i = b; i < e; ++i) hits[outer * 100 + i]++;
+            });
+        }
+    });
+    CHECK(std::all_of(hits.begin(), hits.end(), [](const std::atomic<int>& h) { return h == 1; }));
+}
+
+TEST_CASE("ParallelStableSort is stable and matches std::stable_sort")
+{
+    WorkerPool                        pool(4);
+    std::mt19937                      rng(7);
+    std::vector<std::pair<int, int>> data(200003);
+    for (size_t i = 0; i < data.size(); ++i) data[i] = {int(rng() % 1000), int(i)};
+
+    auto by_key   = [](const std::pair<int, int>& a, const std::pair<int, int>& b) { return a.first < b.first; };
+    auto expected = data;
+    std::stable_sort(expected.begin(), expected.end(), by_key);
+    ParallelStableSort(data, by_key, pool, 1024);
+    CHECK(data == expected);
+}
+
+TEST_CASE("SortRows orders by column with nulls last in both directions")
+{
+    WorkerPool  pool(2);
+    ColumnTable table;
+    auto&       values = table.AddInt64Column("v");
+    auto&       names  = table.AddStringColumn("s");
+    const int   input[] = {5, -1, 3, 9, 3};
+    for (int v : input) values.Append(v);
+    values.AppendNull();
+    for (const char* s : {"pear", "apple", "fig", "apple", "kiwi", "banana"}) names.Append(s);
+
+    RowIds rows = AllRows(table);
+    SortRows(table, {0, true}, rows, pool);
+    CHECK(rows == RowIds({1, 2, 4, 0, 3, 5}));
+    SortRows(table, {0, false}, rows, pool);
+    CHECK(rows == RowIds({3, 0, 2, 4, 1, 5}));
+    SortRows(table, {1, true}, rows, pool);
+    CHECK(rows == RowIds({3, 1, 5, 2, 4, 0}));
+    SortRows(table, {-1, true}, rows, pool);
+    CHECK(rows == AllRows(table));
+}
+
+TEST_CASE("NaN sorts last with the nulls and leaves the other values ordered")
+{
+    WorkerPool  pool(4);
+    ColumnTable table;
+    auto&       values = table.AddDoubleColumn("v");
+    const double nan   = std::numeric_limits<double>::quiet_NaN();
+    std::mt19937 rng(3);
+    long         missing = 0;
+    for (uint32_t i = 0; i < 50000; ++i)
+    {
+        if (i % 7 == 0)
+            values.Append(nan);
+        else if (i % 11 == 0)
+            values.AppendNull();
+        else
+            values.Append(double(rng() % 1000));
+        missing += (i % 7 == 0 || i % 11 == 0);
+    }
+
+    for (bool ascending : {true, false})
+    {
+        RowIds rows = AllRows(table);
+        SortRows(table, {0, ascending}, rows, pool);
+        const auto first_missing = std::find_if(rows.begin(), rows.end(), [&](uint32_t row) {
+            return values.IsNull(row) || std::isnan(values.Value(row));
+        });
+        CHECK(std::distance(first_missing, rows.end()) == missing);
+        CHECK(std::all_of(first_missing, rows.end(), [&](uint32_t row) {
+            return values.IsNull(row) || std::isnan(values.Value(row));
+        }));
+        CHECK(std::is_sorted(rows.begin(), first_missing, [&](uint32_t a, uint32_t b) {
+            return ascending ? values.Value(a) < values.Value(b) : values.Value(b) < values.Value(a);
+        }));
+    }
+}
+
+TEST_CASE("Narrowing a filter from the previous matches equals a full rescan")
+{
+    WorkerPool  pool(4);
+    ColumnTable table;
+    auto&       values = table.AddInt64Column("v");
+    for (int64_t i = 0; i < 300000; ++i) values.Append((i * 7919) % 1000);
+
+    auto below = [](int64_t limit) {
+        return [limit](const ColumnTable& t, uint32_t row) {
+            return static_cast<const Int64Column&>(t.At(0)).Value(row) < limit;
+        };
+    };
+
+    RowIds wide = FilterRows(table, below(500), AllRows(table), pool);
+    CHECK(wide.size() == 150000);
+    CHECK(std::is_sorted(wide.begin(), wide.end()));
+
+    RowIds narrowed = FilterRows(table, below(100), wide, pool);
+    CHECK(narrowed == FilterRows(table, below(100), AllRows(table), pool));
+}
+
+TEST_CASE("Appended rows inserted at their positions match sorting everything")
+{
+    WorkerPool   pool(4);
+    ColumnTable  table;
+    auto&        numbers = table.AddDoubleColumn("n");
+    auto&        names   = table.AddStringColumn("s");
+    const double nan     = std::numeric_limits<double>::quiet_NaN();
+    std::mt19937 rng(11);
+    auto         append = [&](size_t count) {
+        for (size_t i = 0; i < count; ++i)
+        {
+            // Few distinct values, so there are runs of equal keys to keep stable.
+            const uint32_t value = rng() % 50;
+            if (value == 0) numbers.AppendNull();
+            else if (value == 1) numbers.Append(nan);
+            else numbers.Append(value);
+            names.Append("name" + std::to_string(rng() % 2000));
+        }
+    };
+
+    append(5000);
+    for (int column : {0, 1})
+    {
+        for (bool ascending : {true, false})
+        {
+            const SortSpec spec{column, ascending};
+            RowIds         rows = AllRows(table);
+            SortRows(table, spec, rows, pool);
+
+            const uint32_t first = static_cast<uint32_t>(table.RowCount());
+            append(300);
+            RowIds added(table.RowCount() - first);
+            std::iota(added.begin(), added.end(), first);
+            SortRows(table, spec, added, pool);
+
+            const auto positions = InsertPositions(table, spec, rows, added);
+            REQUIRE(positions.size() == added.size());
+            CHECK(std::is_sorted(positions.begin(), positions.end()));
+            RowIds merged;
+            for (size_t i = 0, from = 0; i <= added.size(); ++i)
+            {
+                const size_t to = i < added.size() ? positions[i] : rows.size();
+                merged.insert(merged.end(), rows.begin() + from, rows.begin() + to);
+                if (i < added.size()) merged.push_back(added[i]);
+                from = to;
+            }
+
+            RowIds expected = AllRows(table);
+            SortRows(table, spec, expected, pool);
+            CHECK(merged == expected);
+        }
+    }
+}
@@ -0,0 +1,122 @@
+#define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
+#include "doctest.h"
+
+#include <calc/expression.h>
+#include <calc/sheet.h>
+#include <concurrency/worker_pool.h>
+
+#include <cmath>
+#include <string>
+
+using namespace gomarky;
+
+namespace
+{
+
+std::string Name(int i) { return "c" + std::to_string(i); }
+
+} // namespace
+
+TEST_CASE("Expressions follow the usual precedence")
+{
+    CHECK(Expression::Parse("1 + 2 * 3").Evaluate({}) == 7);
+    CHECK(Expression::Parse("(1 + 2) * 3").Evaluate({}) == 9);
+    CHECK(Expression::Parse("-2 ^ 2").Evaluate({}) == -4);
+    CHECK(Expression::Parse("2 ^ 3 ^ 2").Evaluate({}) == 512);
+    CHECK(Expression::Parse("7 % 4 - 10 / 4").Evaluate({}) == doctest::Approx(0.5));
+    CHECK(Expression::Parse("max(1, sum(2, 3), abs(-4)) + min(round(2.4), sqrt(16))").Evaluate({}) == 7);
+
+    const auto expression = Expression::Parse("a * b + a");
+    REQUIRE(expression.References().size() == 2);
+    CHECK(expression.References()[0] == "a");
+    CHECK(expression.Evaluate({3, 4}) == 15);
+}
+
+TEST_CASE("Malformed expressions report where they failed")
+{
+    CHECK_THROWS_AS(Expression::Parse("1 +"), ExpressionError);
+    CHECK_THROWS_AS(Expression::Parse("(1"), ExpressionError);
+    CHECK_THROWS_AS(Expression::Parse("nope(1)"), ExpressionError);
+    CHECK_THROWS_AS(Expression::Parse("abs(1, 2)"), ExpressionError);
+    try
+    {
+        Expression::Parse("1 $ 2");
+    }
+    catch (const ExpressionError& error)
+    {
+        CHECK(error.Position() == 2);
+    }
+}
+
+TEST_CASE("Only the transitive dependents of an edit are recalculated")
+{
+    Sheet sheet;
+    sheet.SetNumber("a", 1);
+    sheet.SetNumber("b", 2);
+    sheet.SetFormula("sum", "a + b");
+    sheet.SetFormula("twice", "sum * 2");
+    sheet.SetFormula("other", "b * 10");
+    CHECK(sheet.Recalculate() == 5);
+    CHECK(sheet.Value("twice").number == 6);
+    CHECK(sheet.Value("other").number == 20);
+
+    sheet.SetNumber("a", 5);
+    CHECK(sheet.Recalculate() == 3); // a, sum, twice
+    CHECK(sheet.Value("twice").number == 14);
+    CHECK(sheet.Recalculate() == 0);
+
+    sheet.SetFormula("sum", "b");
+    sheet.SetNumber("a", 100);
+    CHECK(sheet.Recalculate() == 3); // the edge from a to sum is gone
+    CHECK(sheet.Value("twice").number == 4);
+}
+
+TEST_CASE("Undefined references, parse errors and cycles surface as cell errors")
+{
+    Sheet sheet;
+    sheet.SetFormula("x", "missing + 1");
+    sheet.SetFormula("bad", "1 +");
+    sheet.SetFormula("p", "q + 1");
+    sheet.SetFormula("q", "p + 1");
+    sheet.SetFormula("r", "q * 2");
+    sheet.SetFormula("self", "self");
+    sheet.Recalculate();
+
+    CHECK(sheet.Value("x").error == CellError::Reference);
+    CHECK(sheet.Value("bad").error == CellError::Parse);
+    CHECK_FALSE(sheet.ParseMessage("bad").empty());
+    CHECK(sheet.Value("p").error == CellError::Cycle);
+    CHECK(sheet.Value("r").error == CellError::Cycle);
+    CHECK(sheet.Value("self").error == CellError::Cycle);
+    CHECK(sheet.Value("nobody").error == CellError::Reference);
+
+    sheet.SetNumber("missing", 1);
+    sheet.SetNumber("q", 3);
+    sheet.Recalculate();
+    CHECK(sheet.Value("x").number == 2);
+    CHECK(sheet.Value("p").number == 4);
+    CHECK(sheet.Value("r").number == 6);
+
+    sheet.Remove("missing");
+    sheet.Recalculate();
+    CHECK(sheet.Value("x").error == CellError::Reference);
+}
+
+TEST_CASE("Wide levels evaluate on the pool with the same results")
+{
+    WorkerPool pool(4);
+    Sheet      sheet;
+    sheet.SetNumber("rate", 2);
+    for (int i = 0; i < 5000; ++i) sheet.SetFormula(Name(i), i == 0 ? "rate" : "rate * " + Name(i - 1) + " % 1000 + 1");
+    for (int i = 0; i < 5000; ++i) sheet.SetFormula("d" + std::to_string(i), "rate * " + std::to_string(i));
+    CHECK(sheet.Recalculate(pool) == 10001);
+
+    double expected = 2;
+    for (int i = 1; i < 5000; ++i) expected = std::fmod(2 * expected, 1000) + 1;
+    CHECK(sheet.Value(Name(4999)).number == expected);
+    CHECK(sheet.Value("d4999").number == 9998);
+
+    sheet.SetNumber(Name(4998), 7);
+    CHECK(sheet.Recalculate(pool) == 2);
+    CHECK(sheet.Value(Name(4999)).number == 15);
+}
@@ -0,0 +1,44 @@
+#define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
+#include "doctest.h"
+
+#include "budget.h"
+
+#include <QElapsedTimer>
+#include <QProcess>
+#include <QProcessEnvironment>
+#include <QTemporaryDir>
+
+// Cold start of a headless gomarky, from launch to its first painted frame, in a fresh process
+// with an empty glyph cache each time (see benchmarks/startup_bench.cpp for the warm variants).
+
+using budget::Budget;
+
+namespace
+{
+
+double ColdStartMilliseconds()
+{
+    QTemporaryDir cache_home;
+    REQUIRE(cache_home.isValid());
+
+    QProcess            process;
+    QProcessEnvironment environment = QProcessEnvironment::systemEnvironment();
+    environment.insert(QStringLiteral("XDG_CACHE_HOME"), cache_home.path());
+    environment.insert(QStringLiteral("QT_QPA_PLATFORM"), QStringLiteral("offscreen"));
+    process.setProcessEnvironment(environment);
+
+    QElapsedTimer timer;
+    timer.start();
+    process.start(QStringLiteral(GM_APP_PATH), QStringList{QStringLiteral("--quit-after-first-paint")});
+    REQUIRE(process.waitForFinished(60000));
+    REQUIRE(process.exitStatus() == QProcess::NormalExit);
+    return double(timer.nsecsElapsed()) / 1e6;
+}
+
+} // namespace
+
+TEST_CASE("Headless cold start reaches the first frame in time")
+{
+    const Budget budget{"startup.cold_first_paint", Budget::Direction::AtMost, 1000, "ms", 0.10};
+    CHECK(budget::Check(budget, 5, ColdStartMilliseconds));
+}
@@ -0,0 +1,330 @@
+#define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
+#include "doctest.h"
+
+#include <table/column_table.h>
+#include <table/delimited_parser.h>
+#include <table/kernels.h>
+
+#include <limits>
+#include <stdexcept>
+#include <string>
+
+using namespace gomarky;
+
+namespace
+{
+
+// Fills a table with rows whose aggregates are easy to compute by hand, with a null every 7th row.
+void Fill(ColumnTable& table, int rows)
+{
+    auto& ints    = table.AddInt64Column("ints");
+    auto& doubles = table.AddDoubleColumn("doubles");
+    auto& keys    = table.AddStringColumn("keys");
+    table.Reserve(rows);
+    for (int i = 0; i < rows; ++i)
+    {
+        if (i % 7 == 3) ints.AppendNull();
+        else ints.Append(i - rows / 2);
+        if (i % 7 == 3) doubles.AppendNull();
+        else doubles.Append(0.5 * i);
+        keys.Append("key" + std::to_string(i % 3));
+    }
+}
+
+} // namespace
+
+TEST_CASE("Null bitmap allocates lazily and counts nulls")
+{
+    NullBitmap bitmap;
+    for (int i = 0; i < 100; ++i) bitmap.Append(true);
+    CHECK_FALSE(bitmap.HasNulls());
+    CHECK(bitmap.MemoryUsage() == 0);
+
+    bitmap.Append(false);
+    bitmap.Append(true);
+    CHECK(bitmap.NullCount() == 1);
+    CHECK(bitmap.IsValid(99));
+    CHECK_FALSE(bitmap.IsValid(100));
+    CHECK(bitmap.IsValid(101));
+}
+
+TEST_CASE("String columns are dictionary encoded")
+{
+    ColumnTable table;
+    auto&       column = table.AddStringColumn("city");
+    column.Append("Paris");
+    column.Append("Oslo");
+    column.Append("Paris");
+    column.AppendNull();
+
+    CHECK(column.Dictionary().Size() == 2);
+    CHECK(column.Code(0) == column.Code(2));
+    CHECK(column.Value(1) == "Oslo");
+    CHECK(column.IsNull(3));
+    CHECK(Count(column) == 3);
+    CHECK_THROWS(table.AddInt64Column("city"));
+}
+
+TEST_CASE("Vectorized kernels match the scalar reference")
+{
+    ColumnTable table;
+    Fill(table, 10007);
+    const auto& ints    = static_cast<const Int64Column&>(table.At(0));
+    const auto& doubles = static_cast<const DoubleColumn&>(table.At(1));
+
+    int64_t expected_sum = 0, expected_min = 0, expected_max = 0;
+    bool    first        = true;
+    for (size_t row = 0; row < ints.Size(); ++row)
+    {
+        if (ints.IsNull(row)) continue;
+        const int64_t value = ints.Value(row);
+        expected_sum += value;
+        expected_min = first ? value : std::min(expected_min, value);
+        expected_max = first ? value : std::max(expected_max, value);
+        first        = false;
+    }
+
+    for (bool simd : {true, false})
+    {
+        SetTableKernelsSimdEnabled(simd);
+        int64_t min = 0, max = 0;
+        CHECK(Sum(ints) == expected_sum);
+        REQUIRE(Min(ints, min));
+        REQUIRE(Max(ints, max));
+        CHECK(min == expected_min);
+        CHECK(max == expected_max);
+        CHECK(Count(ints) == 10007 - 1430);
+
+        double dmin = 0, dmax = 0;
+        REQUIRE(Min(doubles, dmin));
+        REQUIRE(Max(doubles, dmax));
+        CHECK(dmin == 0.0);
+        CHECK(dmax == 0.5 * 10005); // row 10006 is null
+    }
+    SetTableKernelsSimdEnabled(true);
+}
+
+TEST_CASE("Empty and all-null columns have no min or max")
+{
+    ColumnTable table;
+    auto&       column = table.AddDoubleColumn("empty");
+    double      value  = 42;
+    CHECK_FALSE(Min(column, value));
+    column.AppendNull();
+    CHECK_FALSE(Max(column, value));
+    CHECK(value == 42);
+    CHECK(Sum(column) == 0.0);
+}
+
+TEST_CASE("Min and max skip NaN on every code path")
+{
+    const double nan = std::numeric_limits<double>::quiet_NaN();
+    ColumnTable  table;
+    auto&        column = table.AddDoubleColumn("values");
+    for (int i = 0; i < 300; ++i)
+    {
+        // NaN at the start of dense blocks, inside them and in the sparse tail.
+        if (i % 64 == 0 || i % 17 == 5) column.Append(nan);
+        else column.Append(100.0 - i);
+    }
+    column.AppendNull();
+    column.Append(nan);
+
+    auto& all_nan = table.AddDoubleColumn("nan");
+    for (int i = 0; i < 128; ++i) all_nan.Append(nan);
+
+    for (bool simd : {true, false})
+    {
+        SetTableKernelsSimdEnabled(simd);
+        double min = 0, max = 0;
+        REQUIRE(Min(column, min));
+        REQUIRE(Max(column, max));
+        CHECK(min == 100.0 - 299);
+        CHECK(max == 99.0);
+
+        double untouched = 42;
+        CHECK_FALSE(Min(all_nan, untouched));
+        CHECK_FALSE(Max(all_nan, untouched));
+        CHECK(untouched == 42);
+    }
+    SetTableKernelsSimdEnabled(true);
+}
+
+TEST_CASE("Infinities and NaN reduce the same with and without AVX2")
+{
+    const double inf = std::numeric_limits<double>::infinity();
+    const double nan = std::numeric_limits<double>::quiet_NaN();
+    ColumnTable  table;
+    auto&        positive = table.AddDoubleColumn("positive");
+    auto&        negative = table.AddDoubleColumn("negative");
+    auto&        mixed    = table.AddDoubleColumn("mixed");
+    auto&        keys     = table.AddStringColumn("keys");
+    // Dense 64-row blocks and a sparse tail.
+    for (int i = 0; i < 150; ++i)
+    {
+        positive.Append(inf);
+        negative.Append(-inf);
+        mixed.Append(i % 2 ? nan : inf);
+        keys.Append(i % 2 ? "nan" : "inf");
+    }
+
+    for (bool simd : {true, false})
+    {
+        SetTableKernelsSimdEnabled(simd);
+        double min = 0, max = 0;
+        REQUIRE(Min(positive, min));
+        REQUIRE(Max(negative, max));
+        CHECK(min == inf);
+        CHECK(max == -inf);
+        REQUIRE(Min(mixed, min));
+        REQUIRE(Max(mixed, max));
+        CHECK(min == inf);
+        CHECK(max == inf);
+    }
+    SetTableKernelsSimdEnabled(true);
+
+    const auto groups = GroupBy(keys, mixed);
+    CHECK(groups.count[keys.Code(0)] == 75);
+    CHECK(groups.min[keys.Code(0)] == inf);
+    CHECK(groups.max[keys.Code(0)] == inf);
+    CHECK(groups.count[keys.Code(1)] == 0); // NaN only
+}
+
+TEST_CASE("Group-by aggregates per dictionary code")
+{
+    ColumnTable table;
+    Fill(table, 21);
+    const auto& ints = static_cast<const Int64Column&>(table.At(0));
+    const auto& keys = static_cast<const StringColumn&>(table.At(2));
+
+    const auto groups = GroupBy(keys, ints);
+    REQUIRE(groups.count.size() == 3);
+
+    size_t  total_count = 0;
+    int64_t total_sum   = 0;
+    for (size_t code = 0; code < 3; ++code)
+    {
+        total_count += groups.count[code];
+        total_sum += groups.sum[code];
+    }
+    CHECK(total_count == Count(ints));
+    CHECK(total_sum == Sum(ints));
+    // Rows 0, 3, 6, ..., 18 share "key0" and only row 3 among them is null.
+    CHECK(groups.count[keys.Code(0)] == 6);
+    CHECK(groups.min[keys.Code(0)] == -10);
+    CHECK(groups.max[keys.Code(0)] == 8);
+}
+
+TEST_CASE("Appended rows keep nulls and translate dictionary codes")
+{
+    ColumnTable head;
+    Fill(head, 10);
+    ColumnTable tail;
+    Fill(tail, 100);
+
+    ColumnTable table;
+    table.AppendRows(head); // an empty table takes the columns first
+    REQUIRE(table.ColumnCount() == 3);
+    table.AppendRows(tail);
+    REQUIRE(table.RowCount() == 110);
+
+    const auto& ints = static_cast<const Int64Column&>(table.At(0));
+    const auto& keys = static_cast<const StringColumn&>(table.At(2));
+    CHECK(ints.IsNull(3));
+    CHECK(ints.IsNull(10 + 3));
+    CHECK_FALSE(ints.IsNull(10 + 4));
+    CHECK(ints.Value(10 + 4) == 4 - 50);
+    CHECK(keys.Dictionary().Size() == 3);
+    CHECK(keys.Value(10 + 5) == "key2");
+    CHECK(Count(ints) == 10 - 1 + 100 - 14);
+
+    ColumnTable other;
+    other.AddStringColumn("ints");
+    CHECK_FALSE(table.CanAppend(other));
+    CHECK_THROWS_AS(table.AppendRows(other), std::invalid_argument);
+    CHECK(table.RowCount() == 110);
+}
+
+TEST_CASE("Shared copies keep their rows while the original grows in place")
+{
+    ColumnTable table;
+    Fill(table, 100);
+    table.Reserve(1000);
+    ColumnTable more;
+    Fill(more, 100);
+
+    const auto  copy        = table.Share();
+    const auto& ints        = static_cast<const Int64Column&>(table.At(0));
+    const auto& copied_ints = static_cast<const Int64Column&>(copy->At(0));
+    const auto& copied_keys = static_cast<const StringColumn&>(copy->At(2));
+    CHECK(copied_ints.Data() == ints.Data());
+
+    // There is room, so the original appends into the storage it shares with the copy.
+    table.AppendRows(more);
+    table.AppendRows(more);
+    CHECK(ints.Data() == copied_ints.Data());
+    CHECK(table.RowCount() == 300);
+    CHECK(copy->RowCount() == 100);
+    CHECK(Count(copied_ints) == 100 - 14);
+    // Rows 64..99 fill part of a word the original went on filling.
+    CHECK((copied_ints.Validity().Word(1) >> 36) == 0);
+    CHECK((ints.Validity().Word(1) >> 36) != 0);
+
+    // The copy now has to move to storage of its own rather than overwrite the original's rows.
+    auto grown = copy->Share();
+    grown->AppendRows(more);
+    CHECK(static_cast<const Int64Column&>(grown->At(0)).Data() != ints.Data());
+    CHECK(grown->RowCount() == 200);
+    CHECK(static_cast<const StringColumn&>(grown->At(2)).Value(150) == "key2");
+    CHECK(ints.Value(150) == 50 - 50);
+    CHECK(ints.IsNull(100 + 3));
+    CHECK(copied_keys.Dictionary().Size() == 3);
+    CHECK(copy->RowCount() == 100);
+}
+
+TEST_CASE("Delimited text is parsed incrementally with inferred column types")
+{
+    DelimitedParser parser;
+    const std::string first = "id,price,name\r\n1,2.5,apple\n2,x,\"pear, ripe\"\n";
+    parser.Parse(first.data(), first.size());
+    auto rows = parser.TakeRows();
+    REQUIRE(rows->ColumnCount() == 3);
+    REQUIRE(rows->RowCount() == 2);
+    CHECK(rows->At(0).Type() == ColumnType::Int64);
+    CHECK(rows->At(1).Type() == ColumnType::Double);
+    CHECK(rows->At(2).Type() == ColumnType::String);
+    CHECK(rows->At(2).Name() == "name");
+    CHECK(rows->At(1).IsNull(1)); // not a number
+    CHECK(static_cast<const StringColumn&>(rows->At(2)).Value(1) == "pear, ripe");
+
+    // Later batches only hold the new rows, with the same columns.
+    const std::string second = "3,1e3,\"say \"\"hi\"\"\"\n4\n";
+    parser.Parse(second.data(), second.size());
+    auto more = parser.TakeRows();
+    REQUIRE(more->RowCount() == 2);
+    CHECK(rows->CanAppend(*more));
+    CHECK(static_cast<const DoubleColumn&>(more->At(1)).Value(0) == 1000.0);
+    CHECK(static_cast<const StringColumn&>(more->At(2)).Value(0) == "say \"hi\"");
+    CHECK(more->At(2).IsNull(1)); // missing field
+
+    CHECK(parser.TakeRows()->RowCount() == 0);
+    parser.Reset();
+    CHECK_FALSE(parser.HasColumns());
+
+    DelimitedParser tabs('\t', false);
+    const std::string text = "a\t-7\n";
+    tabs.Parse(text.data(), text.size());
+    auto numbered = tabs.TakeRows();
+    REQUIRE(numbered->ColumnCount() == 2);
+    CHECK(numbered->At(1).Name() == "column2");
+    CHECK(static_cast<const Int64Column&>(numbered->At(1)).Value(0) == -7);
+}
+
+TEST_CASE("Columns use a fraction of a QVariant per cell")
+{
+    ColumnTable table;
+    Fill(table, 100000);
+    // A QVariant alone is 16 bytes on 64-bit platforms, before any per-cell model overhead.
+    const double bytes_per_row = double(table.MemoryUsage()) / table.RowCount();
+    CHECK(bytes_per_row < 3 * 16 / 2);
+}
@@ -0,0 +1,272 @@
+#define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
+#include "doctest.h"
+
+#include <concurrency/task_graph.h>
+#include <concurrency/worker_pool.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace gomarky;
+using State = TaskGraph::TaskState;
+
+namespace
+{
+
+void Sleep(int ms) { std::this_thread::sleep_for(std::chrono::milliseconds(ms)); }
+
+} // namespace
+
+TEST_CASE("Tasks run after all of their inputs")
+{
+    WorkerPool pool(4);
+    TaskGraph  graph(pool);
+
+    std::mutex               mutex;
+    std::vector<std::string> log;
+    auto record = [&](const char* name) {
+        return [&, name](TaskGraph::Context&) {
+            std::lock_guard<std::mutex> lock(mutex);
+            log.push_back(name);
+        };
+    };
+    auto index = [&](const char* name) { return std::find(log.begin(), log.end(), name) - log.begin(); };
+
+    const auto load      = graph.Add("load", record("load"));
+    const auto parse_a   = graph.Add("parse_a", record("parse_a"));
+    const auto parse_b   = graph.Add("parse_b", record("parse_b"));
+    const auto aggregate = graph.Add("aggregate", record("aggregate"));
+    const auto render    = graph.Add("render", record("render"));
+    graph.Precede(load, parse_a);
+    graph.Precede(load, parse_b);
+    graph.Precede(parse_a, aggregate);
+    graph.Precede(parse_b, aggregate);
+    graph.Precede(aggregate, render);
+    graph.Run();
+    graph.Wait();
+
+    REQUIRE(log.size() == 5);
+    CHECK(index("load") == 0);
+    CHECK(index("aggregate") == 3);
+    CHECK(index("render") == 4);
+    for (auto task : {load, parse_a, parse_b, aggregate, render}) CHECK(graph.State(task) == State::Succeeded);
+}
+
+TEST_CASE("Wide graphs keep every worker busy")
+{
+    WorkerPool       pool(3);
+    TaskGraph        graph(pool);
+    std::atomic<int> sum{0};
+
+    const auto source = graph.Add("source", [](TaskGraph::Context&) {});
+    const auto sink   = graph.Add("sink", [&](TaskGraph::Context&) { CHECK(sum.load() == 500500); });
+    for (int i = 1; i <= 1000; ++i)
+    {
+        const auto task = graph.Add("leaf", [&sum, i](TaskGraph::Context&) { sum += i; });
+        graph.Precede(source, task);
+        graph.Precede(task, sink);
+    }
+    graph.Run();
+    graph.Wait();
+    CHECK(graph.State(sink) == State::Succeeded);
+    CHECK(graph.Size() == 1002);
+}
+
+TEST_CASE("Failures cancel everything downstream")
+{
+    WorkerPool pool(2);
+    TaskGraph  graph(pool);
+    bool       ran_after = false;
+
+    const auto ok     = graph.Add("ok", [](TaskGraph::Context&) {});
+    const auto broken = graph.Add("broken", [](TaskGraph::Context&) { throw std::runtime_error("parse error"); });
+    const auto after  = graph.Add("after", [&](TaskGraph::Context&) { ran_after = true; });
+    const auto later  = graph.Add("later", [&](TaskGraph::Context&) { ran_after = true; });
+    const auto side   = graph.Add("side", [](TaskGraph::Context&) {});
+    graph.Precede(broken, after);
+    graph.Precede(ok, after);
+    graph.Precede(after, later);
+    graph.Precede(ok, side);
+    graph.Run();
+    graph.Wait();
+
+    CHECK(graph.State(broken) == State::Failed);
+    CHECK_THROWS_AS(std::rethrow_exception(graph.Error(broken)), std::runtime_error);
+    CHECK(graph.State(after) == State::Cancelled);
+    CHECK(graph.State(later) == State::Cancelled);
+    CHECK(graph.State(side) == State::Succeeded);
+    CHECK_FALSE(ran_after);
+    CHECK_FALSE(graph.Error(ok));
+}
+
+TEST_CASE("Cancelling stops pending work and signals running tasks")
+{
+    WorkerPool        pool(2);
+    TaskGraph         graph(pool);
+    std::atomic<bool> started{false};
+    bool              saw_cancel = false;
+
+    const auto slow = graph.Add("slow", [&](TaskGraph::Context& context) {
+        started = true;
+        while (!context.Cancelled()) Sleep(1);
+        saw_cancel = true;
+    });
+    const auto next = graph.Add("next", [](TaskGraph::Context&) {});
+    graph.Precede(slow, next);
+    graph.Run();
+    while (!started) Sleep(1);
+    graph.Cancel(slow);
+    graph.Wait();
+
+    CHECK(saw_cancel);
+    CHECK(graph.State(slow) == State::Cancelled);
+    CHECK(graph.State(next) == State::Cancelled);
+}
+
+TEST_CASE("Deadlines skip late starters and flag late finishers")
+{
+    WorkerPool pool(1);
+    TaskGraph  graph(pool);
+
+    const auto blocker = graph.Add("blocker", [](TaskGraph::Context&) { Sleep(30); });
+    const auto late    = graph.Add("late", [](TaskGraph::Context&) {});
+    const auto overrun = graph.Add("overrun", [](TaskGraph::Context&) { Sleep(30); });
+    const auto after   = graph.Add("after", [](TaskGraph::Context&) {});
+    graph.Precede(blocker, late);
+    graph.Precede(overrun, after);
+    graph.SetDeadline(late, std::chrono::milliseconds(10));
+    graph.SetDeadline(overrun, std::chrono::milliseconds(40));
+    graph.Run();
+    graph.Wait();
+
+    CHECK(graph.State(blocker) == State::Succeeded);
+    CHECK(graph.State(late) == State::DeadlineMissed);
+    CHECK(graph.State(overrun) == State::DeadlineMissed); // one worker: starts at 30 ms, ends at 60
+    CHECK(graph.State(after) == State::Cancelled);
+}
+
+TEST_CASE("Running tasks can grow the graph")
+{
+    WorkerPool       pool(3);
+    TaskGraph        graph(pool);
+    std::atomic<int> parsed{0};
+    int              seen_by_render = -1;
+
+    const auto load = graph.Add("load", [&](TaskGraph::Context& context) {
+        // One parse per discovered file, all feeding a merge that also waits for "load" itself.
+        const auto merge = context.Add("merge", [&](TaskGraph::Context&) { CHECK(parsed.load() == 8); });
+        for (int i = 0; i < 8; ++i)
+        {
+            const auto parse = context.Add("parse", [&](TaskGraph::Context&) {
+                Sleep(1);
+                ++parsed;
+            });
+            context.Precede(parse, merge);
+        }
+        CHECK_THROWS_AS(context.Precede(merge, context.Id()), std::logic_error);
+    });
+    const auto render = graph.Add("render", [&](TaskGraph::Context&) { seen_by_render = parsed.load(); });
+    graph.Precede(load, render);
+    graph.Run();
+    graph.Wait();
+
+    CHECK(seen_by_render == 8); // render waited for everything load added
+    CHECK(graph.Size() == 11);
+    CHECK(graph.State(render) == State::Succeeded);
+}
+
+TEST_CASE("Links that running tasks cannot wait out are rejected")
+{
+    WorkerPool        pool(2);
+    TaskGraph         graph(pool);
+    TaskGraph::TaskId render = 0;
+
+    const auto load = graph.Add("load", [&](TaskGraph::Context& context) {
+        const auto first  = context.Add("first", [](TaskGraph::Context&) {});
+        const auto second = context.Add("second", [](TaskGraph::Context&) {});
+        context.Precede(first, second);
+        CHECK_THROWS_AS(context.Precede(second, first), std::logic_error);
+        CHECK_THROWS_AS(context.Precede(context.Id(), first), std::logic_error);
+        CHECK_THROWS_AS(context.Precede(render, first), std::logic_error); // render follows load
+        CHECK_THROWS_AS(context.SetDeadline(render, std::chrono::seconds(1)), std::logic_error);
+        context.SetDeadline(second, std::chrono::seconds(10));
+    });
+    render = graph.Add("render", [](TaskGraph::Context&) {});
+    graph.Precede(load, render);
+    graph.Run();
+    CHECK_THROWS_AS(graph.SetDeadline(render, std::chrono::seconds(1)), std::logic_error);
+    graph.Wait();
+    CHECK(graph.State(render) == State::Succeeded);
+}
+
+TEST_CASE("Failed children cancel their parent's successors")
+{
+    WorkerPool pool(2);
+    TaskGraph  graph(pool);
+
+    const auto parent = graph.Add("parent", [](TaskGraph::Context& context) {
+        context.Add("child", [](TaskGraph::Context&) { throw std::runtime_error("bad child"); });
+    });
+    const auto after = graph.Add("after", [](TaskGraph::Context&) {});
+    graph.Precede(parent, after);
+    graph.Run();
+    graph.Wait();
+    CHECK(graph.State(parent) == State::Succeeded);
+    CHECK(graph.State(after) == State::Cancelled);
+}
+
+TEST_CASE("Statistics follow the critical path")
+{
+    WorkerPool pool(4);
+    TaskGraph  graph(pool);
+
+    const auto load  = graph.Add("load", [](TaskGraph::Context&) { Sleep(5); });
+    const auto fast  = graph.Add("fast", [](TaskGraph::Context&) { Sleep(1); });
+    const auto slow  = graph.Add("slow", [](TaskGraph::Context& context) {
+        Sleep(5);
+        context.Add("slow_child", [](TaskGraph::Context&) { Sleep(20); });
+    });
+    const auto merge = graph.Add("merge", [](TaskGraph::Context&) { Sleep(2); });
+    graph.Precede(load, fast);
+    graph.Precede(load, slow);
+    graph.Precede(fast, merge);
+    graph.Precede(slow, merge);
+    graph.Run();
+    graph.Wait();
+
+    const auto stats = graph.Stats();
+    std::vector<std::string> names;
+    for (const auto& step : stats.critical_path) names.push_back(step.name);
+    CHECK(names == (std::vector<std::string>{"load", "slow", "slow_child", "merge"}));
+    CHECK(stats.tasks == 5);
+    CHECK(stats.CriticalPathRunning() >= std::chrono::milliseconds(30));
+    CHECK(stats.wall >= stats.CriticalPathRunning());
+    CHECK(stats.busy >= stats.CriticalPathRunning());
+    CHECK(stats.Format().find("slow_child") != std::string::npos);
+}
+
+TEST_CASE("Cycles and misuse are rejected")
+{
+    WorkerPool pool(1);
+    {
+        TaskGraph  graph(pool);
+        const auto a = graph.Add("a", [](TaskGraph::Context&) {});
+        const auto b = graph.Add("b", [](TaskGraph::Context&) {});
+        graph.Precede(a, b);
+        graph.Precede(b, a);
+        CHECK_THROWS_AS(graph.Run(), std::logic_error);
+    }
+    {
+        TaskGraph graph(pool);
+        graph.Run(); // empty graphs finish immediately
+        graph.Wait();
+        CHECK_THROWS_AS(graph.Add("late", [](TaskGraph::Context&) {}), std::logic_error);
+        CHECK_THROWS_AS(graph.Run(), std::logic_error);
+    }
+}
@@ -0,0 +1,69 @@
+#define DOCTEST_CONFIG_IMPLEMENT
+#include "doctest.h"
+
+#include <text/text_layout_cache.h>
+
+#include <QGuiApplication>
+
+using namespace gomarky;
+
+TEST_CASE("Layouts are shared by text, font and width")
+{
+    TextLayoutCache cache;
+    QFont           font;
+    font.setPixelSize(14);
+
+    const auto first = cache.Find(QStringLiteral("Latency"), font);
+    CHECK(cache.Find(QStringLiteral("Latency"), font) == first);
+    CHECK(cache.Hits() == 1);
+    CHECK(cache.Misses() == 1);
+    CHECK(first->size().width() > 0);
+
+    CHECK(cache.Find(QStringLiteral("Latency"), font, 40) != first);
+    CHECK(cache.Find(QStringLiteral("Latency"), font, -1, 2.0) != first);
+
+    QFont bold = font;
+    bold.setBold(true);
+    CHECK(cache.Find(QStringLiteral("Latency"), bold) != first);
+    CHECK(cache.Size() == 4);
+
+    cache.Clear();
+    CHECK(cache.Size() == 0);
+    CHECK(cache.UsedBytes() == 0);
+    CHECK(cache.Find(QStringLiteral("Latency"), font) != first);
+}
+
+TEST_CASE("Wrapping width changes the shaped size")
+{
+    TextLayoutCache cache;
+    QFont           font;
+    font.setPixelSize(14);
+    const QString text = QStringLiteral("one two three four five six seven eight");
+
+    const QSizeF line    = cache.Find(text, font)->size();
+    const QSizeF wrapped = cache.Find(text, font, line.width() / 3)->size();
+    CHECK(wrapped.height() > line.height());
+    CHECK(wrapped.width() < line.width());
+}
+
+TEST_CASE("The byte budget bounds the cache while handed out layouts stay valid")
+{
+    TextLayoutCache cache(4096);
+    QFont           font;
+    const auto      held = cache.Find(QStringLiteral("held"), font);
+    for (int i = 0; i < 200; ++i) cache.Find(QStringLiteral("value %1").arg(i), font);
+
+    CHECK(cache.UsedBytes() <= 4096);
+    CHECK(cache.Size() < 200);
+    CHECK(held->text() == QStringLiteral("held"));
+}
+
+int main(int argc, char** argv)
+{
+    qputenv("QT_QPA_PLATFORM", "offscreen");
+    QGuiApplication app(argc, argv);
+
+    doctest::Context context;
+    context.applyCommandLine(argc, argv);
+    return context.run();
+}
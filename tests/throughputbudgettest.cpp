@@ -0,0 +1,85 @@
+#define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
+#include "doctest.h"
+
+#include "budget.h"
+
+#include <concurrent/spsc_ring.h>
+#include <metrics/hdr_histogram.h>
+#include <table/column.h>
+#include <table/kernels.h>
+
+#include <chrono>
+
+// Floors are a third to a quarter of what a 2018 laptop core reaches in Release, so they only
+// trip on real regressions such as a lost vectorization or an accidental lock.
+
+using namespace gomarky;
+using budget::Budget;
+
+namespace
+{
+
+// Items per second of repeated `fn()` calls, timed over about 20 ms.
+template<typename F>
+double ItemsPerSecond(size_t items_per_call, F fn)
+{
+    using Clock = std::chrono::steady_clock;
+    fn();
+    size_t     calls = 0;
+    const auto start = Clock::now();
+    auto       now   = start;
+    do
+    {
+        fn();
+        ++calls;
+        now = Clock::now();
+    } while (now - start < std::chrono::milliseconds(20));
+    return double(calls * items_per_call) / std::chrono::duration<double>(now - start).count();
+}
+
+Budget Floor(const char* metric, double items_per_second)
+{
+    return {metric, Budget::Direction::AtLeast, items_per_second, "items/s"};
+}
+
+} // namespace
+
+TEST_CASE("SPSC ring push and pop")
+{
+    SpscRing<uint64_t> ring(1024);
+    uint64_t           sink = 0;
+    CHECK(budget::Check(Floor("spsc_ring.push_pop", 50e6), 7, [&] {
+        return ItemsPerSecond(512, [&] {
+            for (uint64_t i = 0; i < 512; ++i) ring.TryPush(i);
+            uint64_t value;
+            while (ring.TryPop(value)) sink += value;
+        });
+    }));
+    CHECK(sink > 0);
+}
+
+TEST_CASE("Summing a double column")
+{
+    DoubleColumn column("value");
+    for (int i = 0; i < 1 << 20; ++i) column.Append(i * 0.5);
+    double sink = 0;
+    CHECK(budget::Check(Floor("table.sum_double", 700e6), 7, [&] {
+        return ItemsPerSecond(column.Size(), [&] { sink += Sum(column); });
+    }));
+    CHECK(sink > 0);
+}
+
+TEST_CASE("Recording latencies")
+{
+    HdrHistogram histogram(1, uint64_t(3600) * 1000000000, 3);
+    uint64_t     state = 1;
+    CHECK(budget::Check(Floor("hdr_histogram.record", 50e6), 7, [&] {
+        return ItemsPerSecond(1024, [&] {
+            for (int i = 0; i < 1024; ++i)
+            {
+                state = state * 6364136223846793005ull + 1442695040888963407ull;
+                histogram.Record(state >> 40);
+            }
+        });
+    }));
+}
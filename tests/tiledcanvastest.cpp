@@ -0,0 +1,85 @@
+#define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
+#include "doctest.h"
+
+#include <concurrency/worker_pool.h>
+#include <render/tiled_canvas.h>
+
+#include <QPainter>
+
+using namespace gomarky;
+
+namespace
+{
+
+void PaintScene(QPainter& painter, const QRect&)
+{
+    painter.fillRect(QRect(10, 10, 250, 120), Qt::red);
+    painter.fillRect(QRect(60, 90, 30, 100), QColor(0, 128, 255, 128));
+}
+
+} // namespace
+
+TEST_CASE("Tiled rendering matches painting the whole canvas at once")
+{
+    WorkerPool  pool(3);
+    TiledCanvas canvas(QSize(300, 200), 64);
+    canvas.SetPaintFunction(&PaintScene);
+    CHECK(canvas.TileCount() == 5 * 4);
+    CHECK(canvas.Render(pool) == canvas.TileCount());
+
+    QImage reference(300, 200, QImage::Format_ARGB32_Premultiplied);
+    reference.fill(Qt::transparent);
+    {
+        QPainter painter(&reference);
+        PaintScene(painter, reference.rect());
+    }
+
+    QImage composited(300, 200, QImage::Format_ARGB32_Premultiplied);
+    composited.fill(Qt::transparent);
+    {
+        QPainter painter(&composited);
+        painter.setCompositionMode(QPainter::CompositionMode_Source);
+        canvas.Composite(painter, composited.rect());
+    }
+    CHECK(composited == reference);
+}
+
+TEST_CASE("Only invalidated tiles are rendered again")
+{
+    WorkerPool  pool(2);
+    TiledCanvas canvas(QSize(300, 200), 64);
+    canvas.SetPaintFunction(&PaintScene);
+    canvas.Render(pool);
+
+    CHECK(canvas.Render(pool) == 0);
+    canvas.Invalidate(QRect(70, 70, 10, 10));
+    CHECK(canvas.DirtyTileCount() == 1);
+    canvas.Invalidate(QRect(60, 60, 10, 10)); // straddles four tiles
+    CHECK(canvas.Render(pool) == 4);
+    canvas.Invalidate(QRect(-50, -50, 10, 10));
+    CHECK(canvas.DirtyTileCount() == 0);
+}
+
+TEST_CASE("Resizing only renders new and partial edge tiles")
+{
+    WorkerPool  pool(2);
+    TiledCanvas canvas(QSize(300, 200), 64);
+    canvas.SetPaintFunction(&PaintScene);
+    canvas.Render(pool);
+
+    // 300 x 200 is 4 x 3 whole tiles plus a partial column and row. At 400 x 200 the partial
+    // column becomes whole and two more are added; the partial row keeps its height.
+    canvas.Resize(QSize(400, 200));
+    CHECK(canvas.TileCount() == 7 * 4);
+    CHECK(canvas.DirtyTileCount() == 3 * 4);
+    canvas.Render(pool);
+
+    // Shrinking keeps the whole tiles still inside and only renders the new partial row.
+    canvas.Resize(QSize(256, 150));
+    CHECK(canvas.TileCount() == 4 * 3);
+    CHECK(canvas.DirtyTileCount() == 4);
+    canvas.Render(pool);
+
+    canvas.Resize(QSize(256, 150));
+    CHECK(canvas.DirtyTileCount() == 0);
+}
@@ -0,0 +1,201 @@
+#define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
+#include "doctest.h"
+
+#include <timers/timer_wheel.h>
+
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <random>
+#include <vector>
+
+using namespace gomarky;
+
+TEST_CASE("Timers fire once their delay has passed")
+{
+    TimerWheel            wheel;
+    std::vector<uint64_t> fired;
+    wheel.Schedule(5, [&] { fired.push_back(wheel.Now()); });
+    wheel.Schedule(0, [&] { fired.push_back(wheel.Now()); }); // still waits for the next tick
+    CHECK(wheel.Size() == 2);
+    CHECK(wheel.NextWakeup() == 1);
+    CHECK(wheel.Deadline(wheel.Schedule(7, [] {})) == 7);
+    CHECK(wheel.Advance(4) == 1);
+    CHECK(fired == (std::vector<uint64_t>{1}));
+    CHECK(wheel.Advance(5) == 1);
+    CHECK(fired == (std::vector<uint64_t>{1, 5}));
+    CHECK(wheel.Advance(7) == 1);
+    CHECK(wheel.Size() == 0);
+    CHECK(wheel.NextWakeup() == UINT64_MAX);
+    CHECK(wheel.Advance(1000000) == 0);
+}
+
+TEST_CASE("Ticks round delays up and batch expirations")
+{
+    TimerWheel wheel(10, 1000);
+    int        fired = 0;
+    for (uint64_t delay : {1, 5, 10}) wheel.Schedule(delay, [&] { ++fired; });
+    wheel.Schedule(11, [&] { ++fired; });
+    CHECK(wheel.Deadline(wheel.Schedule(25, [&] { ++fired; })) == 1030);
+    CHECK(wheel.Advance(1009) == 0);
+    CHECK(wheel.Advance(1010) == 3);
+    CHECK(wheel.Advance(1029) == 1);
+    CHECK(wheel.Advance(1030) == 1);
+    CHECK(fired == 5);
+}
+
+TEST_CASE("Cancelled and restarted timers")
+{
+    TimerWheel wheel;
+    int        fired = 0;
+    const auto a     = wheel.Schedule(10, [&] { ++fired; });
+    const auto b     = wheel.Schedule(10, [&] { fired += 10; });
+    CHECK(wheel.Cancel(a));
+    CHECK_FALSE(wheel.Cancel(a));
+    CHECK_FALSE(wheel.Pending(a));
+
+    wheel.Advance(8);
+    CHECK(wheel.Restart(b, 10)); // debounce: pushed back to 18
+    wheel.Advance(17);
+    CHECK(fired == 0);
+    wheel.Advance(18);
+    CHECK(fired == 10);
+    CHECK_FALSE(wheel.Restart(b, 1));
+    CHECK_FALSE(wheel.Cancel(TimerWheel::kInvalidTimer));
+
+    // A reused slot does not answer to the old id.
+    const auto c = wheel.Schedule(1, [] {});
+    CHECK(c != a);
+    CHECK_FALSE(wheel.Cancel(a));
+    CHECK(wheel.Pending(c));
+}
+
+TEST_CASE("Repeating timers skip missed periods")
+{
+    TimerWheel            wheel;
+    std::vector<uint64_t> fired;
+    const auto            timer = wheel.ScheduleRepeating(10, [&] { fired.push_back(wheel.Now()); });
+    wheel.Advance(10);
+    wheel.Advance(20);
+    CHECK(fired == (std::vector<uint64_t>{10, 20}));
+    CHECK(wheel.Advance(75) == 1); // 30 through 70 collapse into one call
+    CHECK(wheel.Advance(80) == 1);
+    CHECK(wheel.Pending(timer));
+    CHECK(wheel.Cancel(timer));
+    CHECK(wheel.Advance(200) == 0);
+}
+
+TEST_CASE("Callbacks can change the wheel")
+{
+    TimerWheel         wheel;
+    std::vector<int>    order;
+    TimerWheel::TimerId victim = TimerWheel::kInvalidTimer;
+    TimerWheel::TimerId self   = TimerWheel::kInvalidTimer;
+
+    wheel.Schedule(5, [&] {
+        order.push_back(1);
+        wheel.Cancel(victim);                           // due in the same tick
+        wheel.Schedule(1, [&] { order.push_back(3); }); // runs in this same Advance
+        for (int i = 0; i < 1000; ++i) wheel.Schedule(500, [] {}); // grows the slab
+    });
+    victim = wheel.Schedule(5, [&] { order.push_back(2); });
+    self   = wheel.ScheduleRepeating(3, [&] {
+        order.push_back(4);
+        wheel.Cancel(self);
+    });
+    wheel.Advance(10);
+    CHECK(order == (std::vector<int>{4, 1, 3}));
+    CHECK(wheel.Size() == 1000);
+    CHECK(wheel.Advance(505) == 1000);
+}
+
+TEST_CASE("Long delays cascade down to the exact tick")
+{
+    TimerWheel wheel(1, 123456789);
+    uint64_t   fired_at = 0;
+    // Spans several levels, including one past the top of the wheel.
+    for (uint64_t delay : {63ull, 64ull, 4095ull, 4097ull, 300000ull, 20000000ull, (1ull << 36) + 17})
+    {
+        fired_at           = 0;
+        const uint64_t due = wheel.Now() + delay;
+        wheel.Schedule(delay, [&] { fired_at = wheel.Now(); });
+        CHECK(wheel.NextWakeup() <= due);
+        wheel.Advance(due - 1);
+        CHECK(fired_at == 0);
+        wheel.Advance(due + 5);
+        CHECK(fired_at == due);
+    }
+}
+
+TEST_CASE("Matches a sorted reference under random use")
+{
+    std::mt19937_64 random(42);
+    TimerWheel      wheel(1, 1000);
+
+    std::map<TimerWheel::TimerId, uint64_t> deadlines;
+    std::vector<TimerWheel::TimerId>        ids;
+    uint64_t                                fired      = 0;
+    bool                                    on_time    = true;
+    uint64_t                                last_fired = 0;
+
+    auto delay = [&]() -> uint64_t {
+        switch (random() % 3)
+        {
+        case 0: return random() % 100;
+        case 1: return random() % 10000;
+        default: return random() % 5000000;
+        }
+    };
+
+    uint64_t now = 1000;
+    for (int step = 0; step < 20000; ++step)
+    {
+        const auto action = random() % 10;
+        if (action < 5)
+        {
+            const uint64_t d   = delay();
+            const uint64_t due = now + std::max<uint64_t>(d, 1);
+            auto           id  = std::make_shared<TimerWheel::TimerId>();
+            *id                = wheel.Schedule(d, [&, id] {
+                const uint64_t expected = deadlines[*id];
+                on_time                 = on_time && wheel.Now() == expected && expected >= last_fired;
+                last_fired              = expected;
+                deadlines.erase(*id);
+                ++fired;
+            });
+            deadlines[*id] = due;
+            ids.push_back(*id);
+        }
+        else if (action < 7 && !ids.empty())
+        {
+            const auto id = ids[random() % ids.size()];
+            CHECK(wheel.Cancel(id) == (deadlines.erase(id) == 1));
+        }
+        else if (action < 8 && !ids.empty())
+        {
+            const auto     id  = ids[random() % ids.size()];
+            const uint64_t d   = delay();
+            const bool     had = deadlines.count(id) == 1;
+            CHECK(wheel.Restart(id, d) == had);
+            if (had) deadlines[id] = now + std::max<uint64_t>(d, 1);
+        }
+        else
+        {
+            now += random() % 20000;
+            wheel.Advance(now);
+            CHECK(wheel.Now() == now);
+        }
+        if (step % 1000 == 0)
+        {
+            uint64_t earliest = UINT64_MAX;
+            for (const auto& entry : deadlines) earliest = std::min(earliest, entry.second);
+            CHECK(wheel.NextWakeup() <= earliest);
+        }
+        REQUIRE(wheel.Size() == deadlines.size());
+    }
+    now += 6000000;
+    wheel.Advance(now);
+    CHECK(on_time);
+    CHECK(deadlines.empty());
+    CHECK(fired > 0);
+}
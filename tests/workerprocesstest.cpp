@@ -0,0 +1,291 @@
+#define DOCTEST_CONFIG_IMPLEMENT
+#include "doctest.h"
+
+#include <process/shared_ring.h>
+#include <process/worker_main.h>
+#include <process/worker_process.h>
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#if defined(__linux__)
+#include <signal.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+using namespace gomarky;
+
+namespace
+{
+
+// Offset of the head counter in the ring's memfd: it starts the second cache line of the header.
+constexpr size_t kRingHeadOffset = 64;
+
+// Overwrite the head of the ring behind `memory_fd`, the way a broken worker could.
+void ScribbleOverHead(int memory_fd, uint64_t head)
+{
+#if defined(__linux__)
+    void* memory = mmap(nullptr, 4096, PROT_READ | PROT_WRITE, MAP_SHARED, memory_fd, 0);
+    if (memory == MAP_FAILED) std::abort();
+    std::memcpy(static_cast<char*>(memory) + kRingHeadOffset, &head, sizeof(head));
+    munmap(memory, 4096);
+#else
+    (void)memory_fd;
+    (void)head;
+#endif
+}
+
+// The test executable is its own worker: the first request byte picks what the worker does.
+void Handle(const void* request, size_t size, WorkerReply& reply)
+{
+    const char* bytes = static_cast<const char*>(request);
+    switch (size ? bytes[0] : 'e')
+    {
+    case 'c': std::abort();
+    case 't': throw std::runtime_error("bad input");
+    case 's': std::this_thread::sleep_for(std::chrono::seconds(5)); break;
+    case 'h':
+    {
+        // Corrupt the response ring instead of answering, and stay alive.
+        int fds[6];
+        if (std::sscanf(std::getenv(detail::kWorkerDescriptors), "%d,%d,%d,%d,%d,%d", &fds[0], &fds[1], &fds[2],
+                        &fds[3], &fds[4], &fds[5]) != 6)
+        {
+            std::abort();
+        }
+        ScribbleOverHead(fds[3], uint64_t(1) << 40);
+        std::this_thread::sleep_for(std::chrono::seconds(5));
+        break;
+    }
+    default: std::memcpy(reply.Allocate(size), request, size); break;
+    }
+}
+
+} // namespace
+
+#if defined(__linux__)
+
+namespace
+{
+
+std::string SelfPath()
+{
+    char path[4096];
+    const ssize_t length = readlink("/proc/self/exe", path, sizeof(path) - 1);
+    REQUIRE(length > 0);
+    return std::string(path, static_cast<size_t>(length));
+}
+
+WorkerProcess::Options TestOptions()
+{
+    WorkerProcess::Options options;
+    options.command       = {SelfPath(), "--worker"};
+    options.ring_bytes    = size_t(4) << 20;
+    options.restart_delay = std::chrono::milliseconds(100);
+    return options;
+}
+
+// Send `text` and return what came back, or the status when the call failed.
+std::string Echo(WorkerProcess& worker, const std::string& text, WorkerStatus& status)
+{
+    std::string response;
+    status = worker.Call(
+        text.size(), [&](void* request) { std::memcpy(request, text.data(), text.size()); },
+        [&](const void* data, size_t size) { response.assign(static_cast<const char*>(data), size); });
+    return response;
+}
+
+} // namespace
+
+TEST_CASE("A shared ring carries messages of any size between two mappings in order")
+{
+    SharedRing producer = SharedRing::Create(4096);
+    int        fds[3];
+    producer.Descriptors(fds);
+    SharedRing consumer = SharedRing::Attach(dup(fds[0]), dup(fds[1]), dup(fds[2]));
+    REQUIRE(consumer.Capacity() == producer.Capacity());
+    CHECK_THROWS_AS(producer.TryReserve(producer.MaxMessage() + 1), std::invalid_argument);
+
+    // Sizes that do not divide the buffer, so records keep landing across its end.
+    constexpr uint32_t kMessages = 20000;
+    std::thread        writer([&] {
+        for (uint32_t i = 0; i < kMessages; ++i)
+        {
+            const size_t size   = (i * 37) % 1500;
+            char*        memory = static_cast<char*>(producer.Reserve(size, -1));
+            for (size_t j = 0; j < size; ++j) memory[j] = static_cast<char>(i + j);
+            producer.Commit(i);
+        }
+    });
+
+    bool ordered = true;
+    for (uint32_t i = 0; i < kMessages; ++i)
+    {
+        SharedRing::Message message;
+        REQUIRE(consumer.Peek(message, 5000));
+        const char* bytes = static_cast<const char*>(message.data);
+        ordered           = ordered && message.tag == i && message.size == (i * 37) % 1500;
+        for (size_t j = 0; j < message.size; ++j) ordered = ordered && bytes[j] == static_cast<char>(i + j);
+        consumer.Release();
+    }
+    writer.join();
+    CHECK(ordered);
+
+    SharedRing::Message message;
+    CHECK_FALSE(consumer.TryPeek(message));
+    CHECK_FALSE(consumer.Peek(message, 10));
+}
+
+TEST_CASE("A consumer rejects records the producer could not have written")
+{
+    SharedRing producer = SharedRing::Create(4096);
+    int        fds[3];
+    producer.Descriptors(fds);
+    SharedRing          consumer = SharedRing::Attach(dup(fds[0]), dup(fds[1]), dup(fds[2]));
+    SharedRing::Message message;
+
+    // A size beyond what the head covers, and beyond the largest message.
+    char* memory = static_cast<char*>(producer.Reserve(16, -1));
+    producer.Commit(1);
+    uint32_t size = 3000;
+    std::memcpy(memory - 8, &size, sizeof(size));
+    CHECK_THROWS_AS(consumer.TryPeek(message), std::runtime_error);
+
+    size = 16;
+    std::memcpy(memory - 8, &size, sizeof(size));
+    REQUIRE(consumer.TryPeek(message));
+    CHECK(message.size == 16);
+    consumer.Release();
+
+    // A head more than a whole buffer ahead.
+    ScribbleOverHead(fds[0], uint64_t(1) << 40);
+    CHECK_THROWS_AS(consumer.TryPeek(message), std::runtime_error);
+}
+
+TEST_CASE("A worker answers requests through shared memory")
+{
+    WorkerProcess worker(TestOptions());
+    CHECK(worker.Pid() > 0);
+
+    WorkerStatus status;
+    CHECK(Echo(worker, "echo", status) == "echo");
+    CHECK(status == WorkerStatus::Ok);
+
+    const std::string large(worker.MaxMessage(), 'x');
+    CHECK(Echo(worker, large, status) == large);
+    CHECK(status == WorkerStatus::Ok);
+    CHECK_THROWS_AS(Echo(worker, large + "x", status), std::invalid_argument);
+}
+
+TEST_CASE("A handler that throws fails its request only")
+{
+    WorkerProcess worker(TestOptions());
+    const int     pid = worker.Pid();
+
+    WorkerStatus status;
+    Echo(worker, "throw", status);
+    CHECK(status == WorkerStatus::Failed);
+    CHECK(worker.LastError() == "bad input");
+
+    CHECK(Echo(worker, "echo", status) == "echo");
+    CHECK(status == WorkerStatus::Ok);
+    CHECK(worker.Pid() == pid);
+    CHECK(worker.Crashes() == 0);
+}
+
+TEST_CASE("A crashed worker fails the request in flight and is restarted after its delay")
+{
+    WorkerProcess worker(TestOptions());
+    const int     pid = worker.Pid();
+
+    WorkerStatus status;
+    Echo(worker, "crash", status);
+    CHECK(status == WorkerStatus::Crashed);
+    CHECK(worker.LastError().find("signal") != std::string::npos);
+    CHECK(worker.Crashes() == 1);
+
+    Echo(worker, "echo", status);
+    CHECK(status == WorkerStatus::Unavailable);
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(500));
+    CHECK(Echo(worker, "echo", status) == "echo");
+    CHECK(status == WorkerStatus::Ok);
+    CHECK(worker.Restarts() == 1);
+    CHECK(worker.Pid() != pid);
+}
+
+TEST_CASE("A worker that corrupts its ring is treated as crashed")
+{
+    WorkerProcess worker(TestOptions());
+    const int     pid = worker.Pid();
+
+    WorkerStatus status;
+    const auto   start = std::chrono::steady_clock::now();
+    Echo(worker, "hostile", status);
+    CHECK(status == WorkerStatus::Crashed);
+    CHECK(worker.LastError().find("corrupted") != std::string::npos);
+    CHECK(worker.Crashes() == 1);
+    CHECK(std::chrono::steady_clock::now() - start < std::chrono::seconds(2));
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(500));
+    CHECK(Echo(worker, "echo", status) == "echo");
+    CHECK(worker.Pid() != pid);
+}
+
+TEST_CASE("A worker that stops answering is killed")
+{
+    WorkerProcess::Options options = TestOptions();
+    options.timeout                = std::chrono::milliseconds(200);
+    WorkerProcess worker(options);
+
+    WorkerStatus status;
+    const auto   start = std::chrono::steady_clock::now();
+    Echo(worker, "sleep", status);
+    CHECK(status == WorkerStatus::TimedOut);
+    CHECK(std::chrono::steady_clock::now() - start < std::chrono::seconds(2));
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(500));
+    CHECK(Echo(worker, "echo", status) == "echo");
+}
+
+TEST_CASE("The supervisor restarts workers that die while idle")
+{
+    WorkerSupervisor supervisor(TestOptions(), 2);
+    const int        pid = supervisor.Worker(0).Pid();
+    REQUIRE(pid > 0);
+    kill(pid, SIGKILL);
+
+    const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+    while (supervisor.Restarts() == 0 && std::chrono::steady_clock::now() < deadline)
+    {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    CHECK(supervisor.Restarts() == 1);
+    CHECK(supervisor.Worker(0).Pid() != pid);
+
+    // Both workers answer without anyone having seen the crash.
+    for (int i = 0; i < 4; ++i)
+    {
+        WorkerStatus status;
+        CHECK(Echo(supervisor.Worker(i % 2), "echo", status) == "echo");
+        CHECK(status == WorkerStatus::Ok);
+    }
+}
+
+#endif
+
+int main(int argc, char** argv)
+{
+    if (argc > 1 && std::strcmp(argv[1], "--worker") == 0) return RunWorker(Handle);
+
+    doctest::Context context;
+    context.applyCommandLine(argc, argv);
+    return context.run();
+}